@@ -146,6 +146,7 @@ blhandler(PG_FUNCTION_ARGS)
 		.ambeginscan = blbeginscan,
 		.amrescan = blrescan,
 		.amgettuple = NULL,
+		.amgetbatch = NULL,
 		.amgetbitmap = blgetbitmap,
 		.amendscan = blendscan,
 		.ammarkpos = NULL,
@@ -0,0 +1,26 @@
+/* contrib/columnar/columnar--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION columnar" to load this file. \quit
+
+CREATE FUNCTION columnar_handler(internal)
+RETURNS table_am_handler
+AS 'MODULE_PATHNAME'
+LANGUAGE C;
+
+-- Access method
+CREATE ACCESS METHOD columnar TYPE TABLE HANDLER columnar_handler;
+COMMENT ON ACCESS METHOD columnar IS 'column-oriented table access method';
+
+CREATE FUNCTION columnar_stripe_info(IN relation regclass,
+    OUT start_block int8,
+    OUT block_count int8,
+    OUT first_row_number int8,
+    OUT row_count int8,
+    OUT chunk_group_count int4,
+    OUT stored_bytes int8,
+    OUT raw_bytes int8,
+    OUT xmin xid)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'columnar_stripe_info'
+LANGUAGE C STRICT PARALLEL SAFE;
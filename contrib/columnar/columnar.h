@@ -0,0 +1,197 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar.h
+ *	  Header for columnar table access method.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _COLUMNAR_H_
+#define _COLUMNAR_H_
+
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/tableam.h"
+#include "nodes/bitmapset.h"
+#include "nodes/pg_list.h"
+#include "storage/block.h"
+#include "storage/bufpage.h"
+#include "storage/itemptr.h"
+#include "utils/relcache.h"
+
+/*
+ * A columnar table consists of a metapage followed by stripes.  Each stripe
+ * holds the rows inserted by one transaction, up to columnar.stripe_row_limit
+ * of them, stored column by column.  Within a stripe, the values of each
+ * column are divided into chunks of columnar.chunk_group_row_limit rows; the
+ * chunks of all columns for the same rows form a chunk group.  Each chunk is
+ * compressed on its own, and the stripe header records its location and the
+ * minimum and maximum value in it, so that a scan can read just the chunks
+ * of the columns it needs, and skip the chunk groups that its quals rule
+ * out.
+ *
+ * A stripe occupies a run of consecutive pages and is written once, as a
+ * byte stream that continues from one page to the next; see
+ * columnar_storage.c.  Its header comes first.
+ */
+
+/* Metapage */
+#define COLUMNAR_METAPAGE_BLKNO		0
+#define COLUMNAR_MAGIC				0xC01A2EA1
+#define COLUMNAR_VERSION			1
+
+typedef struct ColumnarMetaPageData
+{
+	uint32		magic;
+	uint32		version;
+	BlockNumber nblocks;		/* end of the last stripe */
+	uint64		nextRowNumber;	/* first row number not yet handed out */
+} ColumnarMetaPageData;
+
+#define ColumnarPageGetMeta(page) \
+	((ColumnarMetaPageData *) PageGetContents(page))
+
+/* Bytes of a stripe stored on each of its pages */
+#define COLUMNAR_BYTES_PER_PAGE		(BLCKSZ - SizeOfPageHeaderData)
+
+/*
+ * Stripe header, followed by the chunk directory and the minimum and
+ * maximum values of the chunks.  The stripe is visible to the snapshots that
+ * see its xmin as committed; VACUUM replaces the xmin with
+ * FrozenTransactionId once it is old enough, and with InvalidTransactionId
+ * if the inserting transaction aborted.
+ */
+#define COLUMNAR_STRIPE_MAGIC		0xC01A2EA2
+
+typedef struct ColumnarStripeHeader
+{
+	uint32		magic;
+	uint32		headerSize;		/* bytes up to the first chunk */
+	BlockNumber nblocks;		/* pages occupied by the stripe */
+	TransactionId xmin;			/* inserting transaction */
+	CommandId	cid;			/* inserting command */
+	uint32		nrows;			/* number of rows */
+	uint64		firstRowNumber; /* row number of the first row */
+	uint32		chunkRows;		/* rows per chunk group */
+	uint16		ncolumns;		/* number of attributes when written */
+	uint16		nchunks;		/* number of chunk groups */
+} ColumnarStripeHeader;
+
+/* Chunk directory entry, for each column and chunk group */
+typedef struct ColumnarChunk
+{
+	uint32		offset;			/* from the start of the stripe */
+	uint32		size;			/* stored bytes */
+	uint32		rawSize;		/* bytes once decompressed */
+	uint32		minmaxOffset;	/* from the start of the stripe */
+	uint16		minSize;		/* bytes of the minimum value */
+	uint16		maxSize;		/* bytes of the maximum value */
+	uint8		compression;	/* COLUMNAR_COMPRESSION_xxx */
+	uint8		flags;			/* COLUMNAR_CHUNK_xxx */
+} ColumnarChunk;
+
+#define COLUMNAR_CHUNK_HAS_NULLS	0x01	/* null bitmap precedes values */
+#define COLUMNAR_CHUNK_ALL_NULLS	0x02	/* nothing stored at all */
+#define COLUMNAR_CHUNK_HAS_MINMAX	0x04	/* minimum and maximum stored */
+
+/* the chunk of column "col" (0-based) in chunk group "group" */
+#define ColumnarStripeChunk(hdr, col, group) \
+	(((ColumnarChunk *) ((char *) (hdr) + \
+						 MAXALIGN(sizeof(ColumnarStripeHeader)))) + \
+	 (col) * (hdr)->nchunks + (group))
+
+/* Values larger than this don't get a minimum and maximum */
+#define COLUMNAR_MAX_MINMAX_SIZE	128
+
+/* Compression methods */
+typedef enum ColumnarCompression
+{
+	COLUMNAR_COMPRESSION_NONE,
+	COLUMNAR_COMPRESSION_PGLZ,
+	COLUMNAR_COMPRESSION_LZ4,
+} ColumnarCompression;
+
+/* Row numbers are mapped to TIDs with this many rows per block number */
+#define COLUMNAR_ROWS_PER_TID_BLOCK	MaxHeapTuplesPerPage
+
+#define ColumnarRowNumberToTid(rownum, tid) \
+	ItemPointerSet((tid), \
+				   (BlockNumber) ((rownum) / COLUMNAR_ROWS_PER_TID_BLOCK), \
+				   (OffsetNumber) ((rownum) % COLUMNAR_ROWS_PER_TID_BLOCK + 1))
+
+/* GUCs */
+extern PGDLLIMPORT bool columnar_enable_custom_scan;
+extern PGDLLIMPORT int columnar_compression;
+extern PGDLLIMPORT int columnar_stripe_row_limit;
+extern PGDLLIMPORT int columnar_chunk_group_row_limit;
+
+/* columnar_tableam.c */
+extern bool IsColumnarRelation(Relation rel);
+extern const TableAmRoutine *GetColumnarTableAmRoutine(void);
+
+/* columnar_storage.c */
+extern void ColumnarReadMetaPage(Relation rel, ColumnarMetaPageData *meta);
+extern uint64 ColumnarReserveRowNumbers(Relation rel, uint32 count);
+extern void ColumnarReturnRowNumbers(Relation rel, uint64 end, uint64 newEnd);
+extern void ColumnarReadBytes(Relation rel, BlockNumber start, uint64 offset,
+							  char *dest, uint32 len);
+extern ColumnarStripeHeader *ColumnarReadStripeHeader(Relation rel,
+													  BlockNumber start);
+extern BlockNumber ColumnarWriteStripe(Relation rel, char *data, uint64 len);
+extern void ColumnarSetStripeXmin(Relation rel, BlockNumber start,
+								  TransactionId xmin);
+
+/* columnar_writer.c */
+typedef struct ColumnarWriteState ColumnarWriteState;
+
+extern ColumnarWriteState *ColumnarBeginWrite(Relation rel,
+											  TransactionId xid,
+											  CommandId cid);
+extern void ColumnarWriteRow(ColumnarWriteState *state, Relation rel,
+							 TupleTableSlot *slot);
+extern void ColumnarFlushWrite(ColumnarWriteState *state, Relation rel);
+extern void ColumnarEndWrite(ColumnarWriteState *state);
+extern void ColumnarInsertRow(Relation rel, TupleTableSlot *slot,
+							  CommandId cid);
+extern void ColumnarFlushPendingWrites(Relation rel);
+extern void ColumnarDiscardPendingWrites(Relation rel);
+extern void ColumnarRegisterXactCallbacks(void);
+
+/* columnar_reader.c */
+extern bool ColumnarStripeIsVisible(ColumnarStripeHeader *hdr,
+									Snapshot snapshot);
+extern TableScanDesc columnar_beginscan_extended(Relation rel,
+												 Snapshot snapshot,
+												 ParallelTableScanDesc pscan,
+												 uint32 flags,
+												 Bitmapset *attrs_needed,
+												 List *quals,
+												 Index scanrelid);
+extern TableScanDesc columnar_beginscan(Relation rel, Snapshot snapshot,
+										int nkeys, ScanKeyData *key,
+										ParallelTableScanDesc pscan,
+										uint32 flags);
+extern void columnar_endscan(TableScanDesc sscan);
+extern void columnar_rescan(TableScanDesc sscan, ScanKeyData *key,
+							bool set_params, bool allow_strat,
+							bool allow_sync, bool allow_pagemode);
+extern bool columnar_getnextslot(TableScanDesc sscan,
+								 ScanDirection direction,
+								 TupleTableSlot *slot);
+extern TransactionId columnar_scan_stripe_xmin(TableScanDesc sscan);
+extern int64 columnar_scan_chunk_groups_removed(TableScanDesc sscan);
+extern bool columnar_scan_analyze_next_block(TableScanDesc sscan,
+											 ReadStream *stream);
+extern bool columnar_scan_analyze_next_tuple(TableScanDesc sscan,
+											 double *liverows,
+											 double *deadrows,
+											 TupleTableSlot *slot);
+
+/* columnar_customscan.c */
+extern void ColumnarInstallPlannerHook(void);
+
+#endif
@@ -0,0 +1,334 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_customscan.c
+ *		Custom scan provider for columnar tables.
+ *
+ * The table access method interface offers no way to tell a scan which
+ * columns and conditions the query has, so sequential scans of columnar
+ * tables are planned as a ColumnarScan custom scan instead, which passes
+ * them to the scan to read only the needed columns and skip chunk groups.
+ * Columnar scans aren't parallel aware.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_customscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/sysattr.h"
+#include "access/table.h"
+#include "columnar.h"
+#include "commands/explain_format.h"
+#include "commands/explain_state.h"
+#include "executor/executor.h"
+#include "nodes/extensible.h"
+#include "optimizer/cost.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/pathnode.h"
+#include "optimizer/paths.h"
+#include "optimizer/restrictinfo.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/spccache.h"
+
+typedef struct ColumnarScanState
+{
+	CustomScanState css;
+	Bitmapset  *attrs_needed;	/* attributes to read, or NULL for all */
+	TableScanDesc scandesc;		/* started by the first fetch */
+} ColumnarScanState;
+
+static set_rel_pathlist_hook_type prev_set_rel_pathlist_hook = NULL;
+
+static void columnar_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
+									  Index rti, RangeTblEntry *rte);
+static Plan *columnar_plan_path(PlannerInfo *root, RelOptInfo *rel,
+								CustomPath *best_path, List *tlist,
+								List *clauses, List *custom_plans);
+static Node *columnar_create_scan_state(CustomScan *cscan);
+static void columnar_begin_scan(CustomScanState *node, EState *estate,
+								int eflags);
+static TupleTableSlot *columnar_exec_scan(CustomScanState *node);
+static void columnar_end_scan(CustomScanState *node);
+static void columnar_rescan_scan(CustomScanState *node);
+static void columnar_explain_scan(CustomScanState *node, List *ancestors,
+								  ExplainState *es);
+
+static const CustomPathMethods columnar_path_methods = {
+	.CustomName = "ColumnarScan",
+	.PlanCustomPath = columnar_plan_path,
+};
+
+static const CustomScanMethods columnar_scan_methods = {
+	.CustomName = "ColumnarScan",
+	.CreateCustomScanState = columnar_create_scan_state,
+};
+
+static const CustomExecMethods columnar_exec_methods = {
+	.CustomName = "ColumnarScan",
+	.BeginCustomScan = columnar_begin_scan,
+	.ExecCustomScan = columnar_exec_scan,
+	.EndCustomScan = columnar_end_scan,
+	.ReScanCustomScan = columnar_rescan_scan,
+	.ExplainCustomScan = columnar_explain_scan,
+};
+
+void
+ColumnarInstallPlannerHook(void)
+{
+	prev_set_rel_pathlist_hook = set_rel_pathlist_hook;
+	set_rel_pathlist_hook = columnar_set_rel_pathlist;
+
+	RegisterCustomScanMethods(&columnar_scan_methods);
+}
+
+/*
+ * Replace the paths of a columnar table by a ColumnarScan path.
+ */
+static void
+columnar_set_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, Index rti,
+						  RangeTblEntry *rte)
+{
+	Relation	relation;
+	TupleDesc	desc;
+	int			natts;
+	Bitmapset  *attrs = NULL;
+	List	   *needed = NIL;
+	CustomPath *cpath;
+	QualCost	qpqual_cost;
+	double		spc_seq_page_cost;
+	double		fraction;
+	Cost		cpu_per_tuple;
+
+	if (prev_set_rel_pathlist_hook)
+		prev_set_rel_pathlist_hook(root, rel, rti, rte);
+
+	if (rte->rtekind != RTE_RELATION || rte->inh || rte->tablesample != NULL)
+		return;
+
+	relation = table_open(rte->relid, NoLock);
+	if (!IsColumnarRelation(relation))
+	{
+		table_close(relation, NoLock);
+		return;
+	}
+	desc = RelationGetDescr(relation);
+
+	/* Columnar scans are not parallel aware */
+	rel->partial_pathlist = NIL;
+
+	if (!columnar_enable_custom_scan)
+	{
+		ListCell   *lc;
+
+		foreach(lc, rel->pathlist)
+			((Path *) lfirst(lc))->parallel_safe = false;
+		rel->consider_parallel = false;
+		table_close(relation, NoLock);
+		return;
+	}
+
+	/* Find the columns needed, by the target list and the quals */
+	pull_varattnos((Node *) rel->reltarget->exprs, rel->relid, &attrs);
+	foreach_node(RestrictInfo, rinfo, rel->baserestrictinfo)
+		pull_varattnos((Node *) rinfo->clause, rel->relid, &attrs);
+
+	if (!bms_is_member(InvalidAttrNumber - FirstLowInvalidHeapAttributeNumber,
+					   attrs))
+	{
+		int			attnum = -1;
+
+		while ((attnum = bms_next_member(attrs, attnum)) >= 0)
+		{
+			AttrNumber	attno = attnum + FirstLowInvalidHeapAttributeNumber;
+
+			if (attno > 0)
+				needed = lappend_int(needed, attno);
+		}
+	}
+	else
+	{
+		/* a whole-row reference needs all columns */
+		for (int attno = 1; attno <= desc->natts; attno++)
+			if (!TupleDescAttr(desc, attno - 1)->attisdropped)
+				needed = lappend_int(needed, attno);
+	}
+
+	natts = desc->natts;
+	table_close(relation, NoLock);
+
+	cpath = makeNode(CustomPath);
+	cpath->path.pathtype = T_CustomScan;
+	cpath->path.parent = rel;
+	cpath->path.pathtarget = rel->reltarget;
+	cpath->path.param_info = get_baserel_parampathinfo(root, rel,
+													   rel->lateral_relids);
+	cpath->path.parallel_aware = false;
+	cpath->path.parallel_safe = false;
+	cpath->path.parallel_workers = 0;
+	cpath->path.pathkeys = NIL;
+	cpath->path.rows = cpath->path.param_info ?
+		cpath->path.param_info->ppi_rows : rel->rows;
+	cpath->flags = CUSTOMPATH_SUPPORT_PROJECTION;
+	cpath->custom_private = list_make1(needed);
+	cpath->methods = &columnar_path_methods;
+
+	/*
+	 * Cost it like a sequential scan, except that only the share of the
+	 * pages taken by the needed columns is read.
+	 */
+	get_tablespace_page_costs(rel->reltablespace, NULL, &spc_seq_page_cost);
+	fraction = natts > 0 ? (double) Max(list_length(needed), 1) / natts : 1.0;
+	cost_qual_eval(&qpqual_cost, rel->baserestrictinfo, root);
+	if (cpath->path.param_info)
+	{
+		QualCost	param_cost;
+
+		cost_qual_eval(&param_cost, cpath->path.param_info->ppi_clauses, root);
+		qpqual_cost.startup += param_cost.startup;
+		qpqual_cost.per_tuple += param_cost.per_tuple;
+	}
+	cpu_per_tuple = cpu_tuple_cost + qpqual_cost.per_tuple;
+
+	cpath->path.disabled_nodes = 0;
+	cpath->path.startup_cost = qpqual_cost.startup +
+		rel->reltarget->cost.startup;
+	cpath->path.total_cost = cpath->path.startup_cost +
+		spc_seq_page_cost * rel->pages * fraction +
+		cpu_per_tuple * rel->tuples +
+		rel->reltarget->cost.per_tuple * cpath->path.rows;
+
+	rel->pathlist = NIL;
+	add_path(rel, &cpath->path);
+}
+
+static Plan *
+columnar_plan_path(PlannerInfo *root, RelOptInfo *rel, CustomPath *best_path,
+				   List *tlist, List *clauses, List *custom_plans)
+{
+	CustomScan *cscan = makeNode(CustomScan);
+
+	/* Reduce RestrictInfo list to bare expressions, like for a SeqScan */
+	clauses = extract_actual_clauses(clauses, false);
+
+	cscan->scan.plan.targetlist = tlist;
+	cscan->scan.plan.qual = clauses;
+	cscan->scan.scanrelid = rel->relid;
+	cscan->flags = best_path->flags;
+	cscan->custom_private = best_path->custom_private;
+	cscan->methods = &columnar_scan_methods;
+
+	return &cscan->scan.plan;
+}
+
+static Node *
+columnar_create_scan_state(CustomScan *cscan)
+{
+	ColumnarScanState *state = palloc0_object(ColumnarScanState);
+
+	NodeSetTag(state, T_CustomScanState);
+	state->css.methods = &columnar_exec_methods;
+
+	return (Node *) state;
+}
+
+static void
+columnar_begin_scan(CustomScanState *node, EState *estate, int eflags)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+	CustomScan *cscan = (CustomScan *) node->ss.ps.plan;
+
+	foreach_int(attno, (List *) linitial(cscan->custom_private))
+		state->attrs_needed = bms_add_member(state->attrs_needed, attno);
+
+	/* An empty set would mean all columns */
+	if (state->attrs_needed == NULL)
+		state->attrs_needed = bms_make_singleton(0);
+}
+
+/*
+ * Fetch the next row, starting the scan if needed.
+ */
+static TupleTableSlot *
+columnar_scan_next(ScanState *node)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+	TupleTableSlot *slot = node->ss_ScanTupleSlot;
+
+	if (state->scandesc == NULL)
+	{
+		EState	   *estate = node->ps.state;
+		CustomScan *cscan = (CustomScan *) node->ps.plan;
+		uint32		flags = SO_TYPE_SEQSCAN | SO_ALLOW_STRAT |
+			SO_ALLOW_SYNC | SO_ALLOW_PAGEMODE;
+
+		state->scandesc = columnar_beginscan_extended(node->ss_currentRelation,
+													  estate->es_snapshot,
+													  NULL,
+													  flags,
+													  state->attrs_needed,
+													  cscan->scan.plan.qual,
+													  cscan->scan.scanrelid);
+	}
+
+	if (columnar_getnextslot(state->scandesc, ForwardScanDirection, slot))
+		return slot;
+	return NULL;
+}
+
+static bool
+columnar_scan_recheck(ScanState *node, TupleTableSlot *slot)
+{
+	return true;
+}
+
+static TupleTableSlot *
+columnar_exec_scan(CustomScanState *node)
+{
+	return ExecScan(&node->ss, columnar_scan_next, columnar_scan_recheck);
+}
+
+static void
+columnar_end_scan(CustomScanState *node)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+
+	if (state->scandesc != NULL)
+		columnar_endscan(state->scandesc);
+}
+
+static void
+columnar_rescan_scan(CustomScanState *node)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+
+	if (state->scandesc != NULL)
+		columnar_rescan(state->scandesc, NULL, false, false, false, false);
+
+	ExecScanReScan(&node->ss);
+}
+
+static void
+columnar_explain_scan(CustomScanState *node, List *ancestors,
+					  ExplainState *es)
+{
+	ColumnarScanState *state = (ColumnarScanState *) node;
+	CustomScan *cscan = (CustomScan *) node->ss.ps.plan;
+	TupleDesc	desc = RelationGetDescr(node->ss.ss_currentRelation);
+	List	   *names = NIL;
+
+	foreach_int(attno, (List *) linitial(cscan->custom_private))
+		names = lappend(names,
+						NameStr(TupleDescAttr(desc, attno - 1)->attname));
+
+	ExplainPropertyList("Columnar Projected Columns", names, es);
+
+	if (es->analyze)
+		ExplainPropertyInteger("Columnar Chunk Groups Removed by Filter", NULL,
+							   state->scandesc ?
+							   columnar_scan_chunk_groups_removed(state->scandesc) : 0,
+							   es);
+}
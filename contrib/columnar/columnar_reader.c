@@ -0,0 +1,1042 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_reader.c
+ *		Scanning columnar tables.
+ *
+ * A scan visits the stripes one by one.  Of a visible stripe, it reads only
+ * the chunks of the columns the query needs, through a read stream over the
+ * pages holding them, and decodes one chunk group at a time into arrays of
+ * values from which the rows are returned.  Chunk groups whose minimum and
+ * maximum values refute the scan's quals are skipped without being read.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_reader.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/toast_compression.h"
+#include "access/transam.h"
+#include "access/tupmacs.h"
+#include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "columnar.h"
+#include "executor/instrument_node.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "optimizer/optimizer.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "storage/predicate.h"
+#include "storage/procarray.h"
+#include "storage/read_stream.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/typcache.h"
+#include "varatt.h"
+
+/* What ANALYZE makes of the rows of a stripe */
+typedef enum ColumnarAnalyzeStatus
+{
+	COLUMNAR_ANALYZE_LIVE,
+	COLUMNAR_ANALYZE_DEAD,
+	COLUMNAR_ANALYZE_IN_PROGRESS,
+} ColumnarAnalyzeStatus;
+
+/* Location of a stripe, for ANALYZE */
+typedef struct ColumnarStripeLocation
+{
+	BlockNumber start;
+	BlockNumber nblocks;
+	uint32		nrows;
+} ColumnarStripeLocation;
+
+typedef struct ColumnarScanDescData
+{
+	TableScanDescData rs_base;	/* AM independent part of the descriptor */
+
+	int			natts;			/* attributes of the relation */
+	bool	   *projected;		/* for each attribute, whether it's needed */
+	List	   *quals;			/* quals to skip chunk groups with */
+	Bitmapset  *qualattrs;		/* attributes referenced by quals */
+	Index		scanrelid;		/* varno of the table in quals */
+	Oid		   *geop;			/* for each attribute, >= operator or 0 */
+	Oid		   *leop;			/* for each attribute, <= operator or 0 */
+
+	BlockNumber endblock;		/* end of the last stripe to scan */
+	BlockNumber nextstripe;		/* start of the next stripe to scan */
+
+	/* current stripe */
+	ColumnarStripeHeader *stripe;	/* header, or NULL if none */
+	BlockNumber stripestart;	/* block it starts at */
+	bool	   *skipgroup;		/* for each chunk group, whether to skip it */
+	char	  **chunkdata;		/* stored bytes of the chunks read, by
+								 * column and chunk group */
+	MemoryContext stripecontext;	/* holds the above */
+
+	/* current chunk group */
+	int			group;			/* index, or -1 if none */
+	int			grouprows;		/* number of rows */
+	int			row;			/* next row to return */
+	Datum	  **values;			/* for each attribute, its values */
+	bool	  **isnull;			/* for each attribute, its null flags */
+	MemoryContext groupcontext; /* holds the decoded chunks */
+
+	/* blocks to read for the current stripe */
+	ReadStream *stream;
+	BufferAccessStrategy strategy;
+	BlockNumber *blocks;
+	int			nblocks;
+	int			nextblock;
+
+	int64		groupsRemoved;	/* chunk groups skipped by the quals */
+
+	/* ANALYZE */
+	ColumnarStripeLocation *locations;	/* all stripes, or NULL */
+	int			nlocations;
+	ColumnarAnalyzeStatus analyzeStatus;	/* of the current stripe */
+	uint32		analyzeRow;		/* next row of the stripe to sample */
+	uint32		analyzeEnd;		/* end of the rows to sample */
+} ColumnarScanDescData;
+
+typedef ColumnarScanDescData *ColumnarScanDesc;
+
+static BlockNumber columnar_stream_read_next(ReadStream *stream,
+											 void *callback_private_data,
+											 void *per_buffer_data);
+static void columnar_setup_quals(ColumnarScanDesc scan);
+static void columnar_reset_scan(ColumnarScanDesc scan);
+static bool columnar_next_stripe(ColumnarScanDesc scan);
+static ColumnarStripeHeader *columnar_read_stripe_header(ColumnarScanDesc scan,
+														BlockNumber start);
+static void columnar_load_stripe(ColumnarScanDesc scan, bool skipping);
+static bool columnar_chunk_group_refuted(ColumnarScanDesc scan, int group);
+static void columnar_read_chunks(ColumnarScanDesc scan);
+static void columnar_load_group(ColumnarScanDesc scan, int group);
+static void columnar_decode_chunk(ColumnarScanDesc scan, int col, int group,
+								  int nrows, Datum *values, bool *isnull);
+static void columnar_fill_slot(ColumnarScanDesc scan, TupleTableSlot *slot);
+
+/*
+ * Is a stripe visible to a snapshot?
+ */
+bool
+ColumnarStripeIsVisible(ColumnarStripeHeader *hdr, Snapshot snapshot)
+{
+	TransactionId xmin = hdr->xmin;
+
+	/* Aborted stripes are marked by VACUUM, old ones frozen */
+	if (!TransactionIdIsValid(xmin))
+		return false;
+	if (TransactionIdEquals(xmin, FrozenTransactionId))
+		return true;
+
+	if (snapshot->snapshot_type == SNAPSHOT_ANY)
+		return true;
+
+	if (TransactionIdIsCurrentTransactionId(xmin))
+	{
+		/* Our own rows are visible to later commands only */
+		if (IsMVCCSnapshot(snapshot))
+			return hdr->cid < snapshot->curcid;
+		return true;
+	}
+
+	if (IsMVCCSnapshot(snapshot))
+	{
+		if (XidInMVCCSnapshot(xmin, snapshot))
+			return false;
+		return TransactionIdDidCommit(xmin);
+	}
+
+	if (TransactionIdIsInProgress(xmin))
+		return false;
+	return TransactionIdDidCommit(xmin);
+}
+
+/*
+ * Start a scan of a columnar table.  Only the attributes in "attrs_needed"
+ * (numbered from 1) are returned; the others read as NULL.  NULL means all
+ * of them.  Chunk groups for which "quals", an implicitly-ANDed list of
+ * conditions with Vars of varno "scanrelid", can be proven false are
+ * skipped.
+ */
+TableScanDesc
+columnar_beginscan_extended(Relation rel, Snapshot snapshot,
+							ParallelTableScanDesc pscan, uint32 flags,
+							Bitmapset *attrs_needed, List *quals,
+							Index scanrelid)
+{
+	ColumnarScanDesc scan;
+	TupleDesc	desc = RelationGetDescr(rel);
+
+	if (pscan != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("parallel scans of columnar tables are not supported")));
+
+	if (snapshot && IsHistoricMVCCSnapshot(snapshot))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
+				 errmsg("cannot query non-catalog table \"%s\" during logical decoding",
+						RelationGetRelationName(rel))));
+
+	RelationIncrementReferenceCount(rel);
+
+	scan = palloc0_object(ColumnarScanDescData);
+	scan->rs_base.rs_rd = rel;
+	scan->rs_base.rs_snapshot = snapshot;
+	scan->rs_base.rs_flags = flags;
+	scan->rs_base.rs_instrument = NULL;
+
+	scan->natts = desc->natts;
+	scan->projected = palloc_array(bool, desc->natts);
+	for (int i = 0; i < desc->natts; i++)
+		scan->projected[i] = attrs_needed == NULL ||
+			bms_is_member(i + 1, attrs_needed);
+	scan->quals = quals;
+	scan->scanrelid = scanrelid;
+	if (quals != NIL)
+		columnar_setup_quals(scan);
+
+	scan->values = palloc0_array(Datum *, desc->natts);
+	scan->isnull = palloc0_array(bool *, desc->natts);
+
+	scan->stripecontext = AllocSetContextCreate(CurrentMemoryContext,
+												"columnar scan stripe",
+												ALLOCSET_DEFAULT_SIZES);
+	scan->groupcontext = AllocSetContextCreate(CurrentMemoryContext,
+											   "columnar scan chunk group",
+											   ALLOCSET_DEFAULT_SIZES);
+
+	/* See heapam's beginscan */
+	if (flags & SO_TYPE_SEQSCAN)
+	{
+		Assert(snapshot);
+		PredicateLockRelation(rel, snapshot);
+	}
+
+	columnar_reset_scan(scan);
+
+	if ((flags & SO_ALLOW_STRAT) && scan->endblock > NBuffers / 4)
+		scan->strategy = GetAccessStrategy(BAS_BULKREAD);
+
+	scan->stream = read_stream_begin_relation(READ_STREAM_DEFAULT,
+											  scan->strategy,
+											  rel,
+											  MAIN_FORKNUM,
+											  columnar_stream_read_next,
+											  scan,
+											  0);
+
+	if (flags & SO_SCAN_INSTRUMENT)
+	{
+		scan->rs_base.rs_instrument = palloc0_object(TableScanInstrumentation);
+		read_stream_enable_stats(scan->stream, &scan->rs_base.rs_instrument->io);
+	}
+
+	return (TableScanDesc) scan;
+}
+
+TableScanDesc
+columnar_beginscan(Relation rel, Snapshot snapshot, int nkeys,
+				   ScanKeyData *key, ParallelTableScanDesc pscan,
+				   uint32 flags)
+{
+	if (nkeys > 0)
+		elog(ERROR, "columnar scans do not support scan keys");
+
+	return columnar_beginscan_extended(rel, snapshot, pscan, flags,
+									   NULL, NIL, 0);
+}
+
+void
+columnar_endscan(TableScanDesc sscan)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	/* Must free the read stream before freeing the BufferAccessStrategy */
+	read_stream_end(scan->stream);
+	if (scan->strategy != NULL)
+		FreeAccessStrategy(scan->strategy);
+
+	MemoryContextDelete(scan->groupcontext);
+	MemoryContextDelete(scan->stripecontext);
+
+	RelationDecrementReferenceCount(scan->rs_base.rs_rd);
+
+	if (scan->rs_base.rs_flags & SO_TEMP_SNAPSHOT)
+		UnregisterSnapshot(scan->rs_base.rs_snapshot);
+
+	if (scan->rs_base.rs_instrument)
+		pfree(scan->rs_base.rs_instrument);
+
+	pfree(scan);
+}
+
+void
+columnar_rescan(TableScanDesc sscan, ScanKeyData *key, bool set_params,
+				bool allow_strat, bool allow_sync, bool allow_pagemode)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (set_params)
+	{
+		if (allow_strat)
+			scan->rs_base.rs_flags |= SO_ALLOW_STRAT;
+		else
+			scan->rs_base.rs_flags &= ~SO_ALLOW_STRAT;
+	}
+
+	read_stream_reset(scan->stream);
+	columnar_reset_scan(scan);
+}
+
+/*
+ * Start over from the first stripe.
+ */
+static void
+columnar_reset_scan(ColumnarScanDesc scan)
+{
+	Relation	rel = scan->rs_base.rs_rd;
+	ColumnarMetaPageData meta;
+
+	/* Make our own insertions visible */
+	ColumnarFlushPendingWrites(rel);
+
+	ColumnarReadMetaPage(rel, &meta);
+	scan->endblock = meta.nblocks;
+	scan->nextstripe = COLUMNAR_METAPAGE_BLKNO + 1;
+	scan->stripe = NULL;
+	scan->group = -1;
+	scan->grouprows = 0;
+	scan->row = 0;
+	scan->nblocks = 0;
+	scan->nextblock = 0;
+	MemoryContextReset(scan->groupcontext);
+	MemoryContextReset(scan->stripecontext);
+
+	if (scan->rs_base.rs_flags & SO_TYPE_SEQSCAN)
+		pgstat_count_heap_scan(rel);
+}
+
+bool
+columnar_getnextslot(TableScanDesc sscan, ScanDirection direction,
+					 TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (!ScanDirectionIsForward(direction))
+		elog(ERROR, "columnar scans only go forward");
+
+	for (;;)
+	{
+		if (scan->stripe != NULL && scan->row < scan->grouprows)
+		{
+			columnar_fill_slot(scan, slot);
+			scan->row++;
+			pgstat_count_heap_getnext(scan->rs_base.rs_rd);
+			return true;
+		}
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* On to the next chunk group that isn't skipped */
+		if (scan->stripe != NULL)
+		{
+			int			group = scan->group + 1;
+
+			while (group < scan->stripe->nchunks && scan->skipgroup[group])
+				group++;
+			if (group < scan->stripe->nchunks)
+			{
+				columnar_load_group(scan, group);
+				continue;
+			}
+		}
+
+		if (!columnar_next_stripe(scan))
+		{
+			ExecClearTuple(slot);
+			return false;
+		}
+	}
+}
+
+/*
+ * Xmin of the stripe holding the row last returned.
+ */
+TransactionId
+columnar_scan_stripe_xmin(TableScanDesc sscan)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	Assert(scan->stripe != NULL);
+	return scan->stripe->xmin;
+}
+
+/*
+ * Number of chunk groups skipped so far thanks to the quals.
+ */
+int64
+columnar_scan_chunk_groups_removed(TableScanDesc sscan)
+{
+	return ((ColumnarScanDesc) sscan)->groupsRemoved;
+}
+
+/*
+ * Read stream callback, returning the blocks of the current stripe that hold
+ * the chunks to read.
+ */
+static BlockNumber
+columnar_stream_read_next(ReadStream *stream, void *callback_private_data,
+						  void *per_buffer_data)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) callback_private_data;
+
+	if (scan->nextblock >= scan->nblocks)
+		return InvalidBlockNumber;
+	return scan->blocks[scan->nextblock++];
+}
+
+/*
+ * Look up the operators needed to compare the columns referenced by the
+ * quals with their minimum and maximum values.
+ */
+static void
+columnar_setup_quals(ColumnarScanDesc scan)
+{
+	TupleDesc	desc = RelationGetDescr(scan->rs_base.rs_rd);
+	int			attnum = -1;
+
+	pull_varattnos((Node *) scan->quals, scan->scanrelid, &scan->qualattrs);
+
+	scan->geop = palloc0_array(Oid, desc->natts);
+	scan->leop = palloc0_array(Oid, desc->natts);
+
+	while ((attnum = bms_next_member(scan->qualattrs, attnum)) >= 0)
+	{
+		AttrNumber	attno = attnum + FirstLowInvalidHeapAttributeNumber;
+		Form_pg_attribute att;
+		TypeCacheEntry *typentry;
+
+		if (attno <= 0 || attno > desc->natts)
+			continue;
+		att = TupleDescAttr(desc, attno - 1);
+		if (att->attisdropped)
+			continue;
+
+		/* the minimum and maximum are those of the type's btree opclass */
+		typentry = lookup_type_cache(att->atttypid, TYPECACHE_BTREE_OPFAMILY);
+		if (!OidIsValid(typentry->btree_opf) ||
+			typentry->btree_opintype != att->atttypid)
+			continue;
+
+		scan->geop[attno - 1] = get_opfamily_member(typentry->btree_opf,
+													att->atttypid,
+													att->atttypid,
+													BTGreaterEqualStrategyNumber);
+		scan->leop[attno - 1] = get_opfamily_member(typentry->btree_opf,
+													att->atttypid,
+													att->atttypid,
+													BTLessEqualStrategyNumber);
+		if (!OidIsValid(scan->geop[attno - 1]) ||
+			!OidIsValid(scan->leop[attno - 1]))
+			scan->geop[attno - 1] = scan->leop[attno - 1] = InvalidOid;
+	}
+}
+
+/*
+ * Advance to the next visible stripe with chunk groups not skipped.  Returns
+ * false at the end of the table.
+ */
+static bool
+columnar_next_stripe(ColumnarScanDesc scan)
+{
+	while (scan->nextstripe < scan->endblock)
+	{
+		ColumnarStripeHeader *hdr;
+		bool		any = false;
+
+		CHECK_FOR_INTERRUPTS();
+
+		hdr = columnar_read_stripe_header(scan, scan->nextstripe);
+		scan->nextstripe += hdr->nblocks;
+		if (!ColumnarStripeIsVisible(hdr, scan->rs_base.rs_snapshot))
+			continue;
+
+		columnar_load_stripe(scan, true);
+		for (int group = 0; group < hdr->nchunks; group++)
+			any |= !scan->skipgroup[group];
+		if (any)
+			return true;
+	}
+
+	scan->stripe = NULL;
+	return false;
+}
+
+/*
+ * Make the stripe starting at block "start" the current one, reading its
+ * header.  Its chunks are yet to be read.
+ */
+static ColumnarStripeHeader *
+columnar_read_stripe_header(ColumnarScanDesc scan, BlockNumber start)
+{
+	MemoryContext oldcontext;
+
+	MemoryContextReset(scan->groupcontext);
+	MemoryContextReset(scan->stripecontext);
+
+	oldcontext = MemoryContextSwitchTo(scan->stripecontext);
+	scan->stripe = ColumnarReadStripeHeader(scan->rs_base.rs_rd, start);
+	MemoryContextSwitchTo(oldcontext);
+
+	scan->stripestart = start;
+	scan->skipgroup = NULL;
+	scan->chunkdata = NULL;
+	scan->group = -1;
+	scan->grouprows = 0;
+	scan->row = 0;
+
+	return scan->stripe;
+}
+
+/*
+ * Read the chunks of the projected columns of the current stripe.  With
+ * "skipping", chunk groups refuted by the quals aren't read.
+ */
+static void
+columnar_load_stripe(ColumnarScanDesc scan, bool skipping)
+{
+	ColumnarStripeHeader *hdr = scan->stripe;
+	MemoryContext oldcontext;
+
+	oldcontext = MemoryContextSwitchTo(scan->stripecontext);
+
+	scan->skipgroup = palloc0_array(bool, hdr->nchunks);
+	if (skipping && scan->quals != NIL)
+	{
+		for (int group = 0; group < hdr->nchunks; group++)
+		{
+			if (columnar_chunk_group_refuted(scan, group))
+			{
+				scan->skipgroup[group] = true;
+				scan->groupsRemoved++;
+			}
+		}
+	}
+
+	for (int i = 0; i < scan->natts; i++)
+	{
+		scan->values[i] = palloc_array(Datum, hdr->chunkRows);
+		scan->isnull[i] = palloc_array(bool, hdr->chunkRows);
+	}
+
+	columnar_read_chunks(scan);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Can the quals be proven false for all rows of a chunk group, from the
+ * minimum and maximum values of its chunks?
+ */
+static bool
+columnar_chunk_group_refuted(ColumnarScanDesc scan, int group)
+{
+	TupleDesc	desc = RelationGetDescr(scan->rs_base.rs_rd);
+	ColumnarStripeHeader *hdr = scan->stripe;
+	List	   *constraints = NIL;
+	int			attnum = -1;
+
+	while ((attnum = bms_next_member(scan->qualattrs, attnum)) >= 0)
+	{
+		AttrNumber	attno = attnum + FirstLowInvalidHeapAttributeNumber;
+		Form_pg_attribute att;
+		ColumnarChunk *chunk;
+		Var		   *var;
+		NullTest   *nulltest;
+		Expr	   *ge;
+		Expr	   *le;
+		Datum		min;
+		Datum		max;
+		char	   *minmax;
+
+		if (attno <= 0 || attno > hdr->ncolumns ||
+			!OidIsValid(scan->geop[attno - 1]))
+			continue;
+
+		att = TupleDescAttr(desc, attno - 1);
+		chunk = ColumnarStripeChunk(hdr, attno - 1, group);
+		var = makeVar(scan->scanrelid, attno, att->atttypid, att->atttypmod,
+					  att->attcollation, 0);
+
+		nulltest = makeNode(NullTest);
+		nulltest->arg = (Expr *) var;
+		nulltest->nulltesttype = IS_NULL;
+		nulltest->argisrow = false;
+		nulltest->location = -1;
+
+		if (chunk->flags & COLUMNAR_CHUNK_ALL_NULLS)
+		{
+			constraints = lappend(constraints, nulltest);
+			continue;
+		}
+		if (!(chunk->flags & COLUMNAR_CHUNK_HAS_MINMAX))
+			continue;
+
+		minmax = (char *) hdr + chunk->minmaxOffset;
+		if (att->attbyval)
+		{
+			memcpy(&min, minmax, sizeof(Datum));
+			memcpy(&max, minmax + sizeof(Datum), sizeof(Datum));
+		}
+		else
+		{
+			min = PointerGetDatum(minmax);
+			max = PointerGetDatum(minmax + MAXALIGN(chunk->minSize));
+		}
+
+		ge = make_opclause(scan->geop[attno - 1], BOOLOID, false,
+						   (Expr *) var,
+						   (Expr *) makeConst(att->atttypid, att->atttypmod,
+											  att->attcollation, att->attlen,
+											  min, false, att->attbyval),
+						   InvalidOid, att->attcollation);
+		le = make_opclause(scan->leop[attno - 1], BOOLOID, false,
+						   (Expr *) var,
+						   (Expr *) makeConst(att->atttypid, att->atttypmod,
+											  att->attcollation, att->attlen,
+											  max, false, att->attbyval),
+						   InvalidOid, att->attcollation);
+
+		if (chunk->flags & COLUMNAR_CHUNK_HAS_NULLS)
+			constraints = lappend(constraints,
+								  make_orclause(list_make2(make_andclause(list_make2(ge, le)),
+														   nulltest)));
+		else
+			constraints = lappend(lappend(constraints, ge), le);
+	}
+
+	if (constraints == NIL)
+		return false;
+
+	return predicate_refuted_by(constraints, scan->quals, false);
+}
+
+/*
+ * Read the stored chunks of the projected columns in the chunk groups not
+ * skipped, through the read stream.
+ */
+static void
+columnar_read_chunks(ColumnarScanDesc scan)
+{
+	ColumnarStripeHeader *hdr = scan->stripe;
+	int			nchunks = hdr->ncolumns * hdr->nchunks;
+	int			ncols = Min(hdr->ncolumns, scan->natts);
+	Buffer		buffer = InvalidBuffer;
+	BlockNumber blkno = InvalidBlockNumber;
+
+	scan->chunkdata = palloc0_array(char *, nchunks);
+	scan->blocks = palloc_array(BlockNumber, hdr->nblocks);
+	scan->nblocks = 0;
+	scan->nextblock = 0;
+
+	/*
+	 * Chunks are laid out column by column, so going through them in that
+	 * order yields their blocks in ascending order.
+	 */
+	for (int col = 0; col < ncols; col++)
+	{
+		if (!scan->projected[col])
+			continue;
+		for (int group = 0; group < hdr->nchunks; group++)
+		{
+			ColumnarChunk *chunk = ColumnarStripeChunk(hdr, col, group);
+			BlockNumber first;
+			BlockNumber last;
+
+			if (scan->skipgroup[group] ||
+				(chunk->flags & COLUMNAR_CHUNK_ALL_NULLS))
+				continue;
+
+			first = scan->stripestart + chunk->offset / COLUMNAR_BYTES_PER_PAGE;
+			last = scan->stripestart +
+				(chunk->offset + chunk->size - 1) / COLUMNAR_BYTES_PER_PAGE;
+			if (last >= scan->stripestart + hdr->nblocks)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("stripe at block %u of columnar table \"%s\" is corrupted",
+								scan->stripestart,
+								RelationGetRelationName(scan->rs_base.rs_rd))));
+
+			for (BlockNumber b = first; b <= last; b++)
+				if (scan->nblocks == 0 || scan->blocks[scan->nblocks - 1] < b)
+					scan->blocks[scan->nblocks++] = b;
+
+			scan->chunkdata[col * hdr->nchunks + group] = palloc(chunk->size);
+		}
+	}
+
+	read_stream_reset(scan->stream);
+
+	for (int col = 0; col < ncols; col++)
+	{
+		for (int group = 0; group < hdr->nchunks; group++)
+		{
+			ColumnarChunk *chunk = ColumnarStripeChunk(hdr, col, group);
+			char	   *dest = scan->chunkdata[col * hdr->nchunks + group];
+			uint64		offset = chunk->offset;
+			uint32		len = chunk->size;
+
+			if (dest == NULL)
+				continue;
+
+			while (len > 0)
+			{
+				BlockNumber needed = scan->stripestart +
+					offset / COLUMNAR_BYTES_PER_PAGE;
+				uint32		pos = offset % COLUMNAR_BYTES_PER_PAGE;
+				uint32		n = Min(len, COLUMNAR_BYTES_PER_PAGE - pos);
+
+				if (blkno != needed)
+				{
+					if (BufferIsValid(buffer))
+						ReleaseBuffer(buffer);
+					buffer = read_stream_next_buffer(scan->stream, NULL);
+					if (!BufferIsValid(buffer))
+						elog(ERROR, "unexpected end of read stream");
+					blkno = BufferGetBlockNumber(buffer);
+					if (blkno != needed)
+						elog(ERROR, "unexpected block %u in read stream, expected %u",
+							 blkno, needed);
+				}
+
+				LockBuffer(buffer, BUFFER_LOCK_SHARE);
+				memcpy(dest, BufferGetPage(buffer) + SizeOfPageHeaderData + pos, n);
+				LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+
+				dest += n;
+				offset += n;
+				len -= n;
+			}
+		}
+	}
+
+	if (BufferIsValid(buffer))
+		ReleaseBuffer(buffer);
+}
+
+/*
+ * Decode the chunks of chunk group "group" of the current stripe.
+ */
+static void
+columnar_load_group(ColumnarScanDesc scan, int group)
+{
+	ColumnarStripeHeader *hdr = scan->stripe;
+	TupleDesc	desc = RelationGetDescr(scan->rs_base.rs_rd);
+	int			nrows;
+	MemoryContext oldcontext;
+
+	nrows = Min(hdr->chunkRows, hdr->nrows - group * hdr->chunkRows);
+
+	MemoryContextReset(scan->groupcontext);
+	oldcontext = MemoryContextSwitchTo(scan->groupcontext);
+
+	for (int col = 0; col < scan->natts; col++)
+	{
+		if (!scan->projected[col])
+			continue;
+
+		if (col < hdr->ncolumns)
+			columnar_decode_chunk(scan, col, group, nrows,
+								  scan->values[col], scan->isnull[col]);
+		else
+		{
+			/* Added after the stripe was written */
+			bool		isnull;
+			Datum		value = getmissingattr(desc, col + 1, &isnull);
+
+			for (int i = 0; i < nrows; i++)
+			{
+				scan->values[col][i] = value;
+				scan->isnull[col][i] = isnull;
+			}
+		}
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	scan->group = group;
+	scan->grouprows = nrows;
+	scan->row = 0;
+}
+
+/*
+ * Decode a chunk into arrays of values and null flags.
+ */
+static void
+columnar_decode_chunk(ColumnarScanDesc scan, int col, int group, int nrows,
+					  Datum *values, bool *isnull)
+{
+	Form_pg_attribute att = TupleDescAttr(RelationGetDescr(scan->rs_base.rs_rd),
+										  col);
+	ColumnarStripeHeader *hdr = scan->stripe;
+	ColumnarChunk *chunk = ColumnarStripeChunk(hdr, col, group);
+	char	   *stored = scan->chunkdata[col * hdr->nchunks + group];
+	char	   *raw;
+	uint8	   *bits = NULL;
+	uint32		off = 0;
+
+	if (chunk->flags & COLUMNAR_CHUNK_ALL_NULLS)
+	{
+		memset(isnull, true, sizeof(bool) * nrows);
+		return;
+	}
+
+	Assert(stored != NULL);
+
+	if (chunk->compression == COLUMNAR_COMPRESSION_NONE)
+		raw = stored;
+	else
+	{
+		varlena    *decompressed;
+
+		if (chunk->compression == COLUMNAR_COMPRESSION_LZ4)
+			decompressed = lz4_decompress_datum((varlena *) stored);
+		else if (chunk->compression == COLUMNAR_COMPRESSION_PGLZ)
+			decompressed = pglz_decompress_datum((varlena *) stored);
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("invalid compression method %d in columnar table \"%s\"",
+									 chunk->compression,
+									 RelationGetRelationName(scan->rs_base.rs_rd))));
+
+		if (VARSIZE(decompressed) - VARHDRSZ != chunk->rawSize)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed chunk of columnar table \"%s\" has wrong size",
+									 RelationGetRelationName(scan->rs_base.rs_rd))));
+
+		/* The values are aligned relative to a MAXALIGNed start */
+		raw = palloc(chunk->rawSize);
+		memcpy(raw, VARDATA(decompressed), chunk->rawSize);
+		pfree(decompressed);
+	}
+
+	if (chunk->flags & COLUMNAR_CHUNK_HAS_NULLS)
+	{
+		bits = (uint8 *) raw;
+		off = MAXALIGN((nrows + 7) / 8);
+	}
+
+	for (int i = 0; i < nrows; i++)
+	{
+		if (bits != NULL && (bits[i / 8] & (1 << (i % 8))) == 0)
+		{
+			values[i] = (Datum) 0;
+			isnull[i] = true;
+			continue;
+		}
+
+		off = att_align_nominal(off, att->attalign);
+		if (off >= chunk->rawSize)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("chunk of columnar table \"%s\" is too short",
+									 RelationGetRelationName(scan->rs_base.rs_rd))));
+		values[i] = fetchatt(att, raw + off);
+		isnull[i] = false;
+		off = att_addlength_pointer(off, att->attlen, raw + off);
+	}
+}
+
+/*
+ * Store the current row in a slot.
+ */
+static void
+columnar_fill_slot(ColumnarScanDesc scan, TupleTableSlot *slot)
+{
+	ColumnarStripeHeader *hdr = scan->stripe;
+
+	ExecClearTuple(slot);
+
+	for (int i = 0; i < slot->tts_tupleDescriptor->natts; i++)
+	{
+		if (i < scan->natts && scan->projected[i])
+		{
+			slot->tts_values[i] = scan->values[i][scan->row];
+			slot->tts_isnull[i] = scan->isnull[i][scan->row];
+		}
+		else
+		{
+			slot->tts_values[i] = (Datum) 0;
+			slot->tts_isnull[i] = true;
+		}
+	}
+
+	ExecStoreVirtualTuple(slot);
+
+	slot->tts_tableOid = RelationGetRelid(scan->rs_base.rs_rd);
+	ColumnarRowNumberToTid(hdr->firstRowNumber +
+						   (uint64) scan->group * hdr->chunkRows + scan->row,
+						   &slot->tts_tid);
+}
+
+/*
+ * Prepare to sample the rows of the next block chosen by ANALYZE.  Stripes
+ * don't have rows on any particular page, so a block stands for a share of
+ * the rows of the stripe it belongs to, proportional to its share of the
+ * stripe's pages.
+ */
+bool
+columnar_scan_analyze_next_block(TableScanDesc sscan, ReadStream *stream)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+	Relation	rel = scan->rs_base.rs_rd;
+	Buffer		buffer;
+	BlockNumber blkno;
+	ColumnarStripeLocation *loc = NULL;
+	int			lo;
+	int			hi;
+
+	buffer = read_stream_next_buffer(stream, NULL);
+	if (!BufferIsValid(buffer))
+		return false;
+	blkno = BufferGetBlockNumber(buffer);
+	ReleaseBuffer(buffer);
+
+	scan->analyzeRow = scan->analyzeEnd = 0;
+
+	/* Find out where the stripes are, the first time through */
+	if (scan->locations == NULL)
+	{
+		BlockNumber start = COLUMNAR_METAPAGE_BLKNO + 1;
+		int			maxlocations = 16;
+
+		scan->locations = MemoryContextAlloc(GetMemoryChunkContext(scan),
+											 sizeof(ColumnarStripeLocation) * maxlocations);
+		while (start < scan->endblock)
+		{
+			ColumnarStripeHeader fixed;
+
+			ColumnarReadBytes(rel, start, 0, (char *) &fixed, sizeof(fixed));
+			if (fixed.magic != COLUMNAR_STRIPE_MAGIC || fixed.nblocks == 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("stripe at block %u of columnar table \"%s\" is corrupted",
+								start, RelationGetRelationName(rel))));
+
+			if (scan->nlocations == maxlocations)
+			{
+				maxlocations *= 2;
+				scan->locations = repalloc(scan->locations,
+										   sizeof(ColumnarStripeLocation) * maxlocations);
+			}
+			scan->locations[scan->nlocations].start = start;
+			scan->locations[scan->nlocations].nblocks = fixed.nblocks;
+			scan->locations[scan->nlocations].nrows = fixed.nrows;
+			scan->nlocations++;
+
+			start += fixed.nblocks;
+		}
+	}
+
+	/* Binary search for the stripe holding the block */
+	lo = 0;
+	hi = scan->nlocations - 1;
+	while (lo <= hi)
+	{
+		int			mid = (lo + hi) / 2;
+
+		if (blkno < scan->locations[mid].start)
+			hi = mid - 1;
+		else if (blkno >= scan->locations[mid].start +
+				 scan->locations[mid].nblocks)
+			lo = mid + 1;
+		else
+		{
+			loc = &scan->locations[mid];
+			break;
+		}
+	}
+
+	/* The metapage, or pages added after the scan started */
+	if (loc == NULL)
+		return true;
+
+	if (scan->stripe == NULL || scan->stripestart != loc->start)
+	{
+		TransactionId xmin;
+
+		xmin = columnar_read_stripe_header(scan, loc->start)->xmin;
+		if (!TransactionIdIsValid(xmin))
+			scan->analyzeStatus = COLUMNAR_ANALYZE_DEAD;
+		else if (TransactionIdEquals(xmin, FrozenTransactionId) ||
+				 TransactionIdIsCurrentTransactionId(xmin))
+			scan->analyzeStatus = COLUMNAR_ANALYZE_LIVE;
+		else if (TransactionIdIsInProgress(xmin))
+			scan->analyzeStatus = COLUMNAR_ANALYZE_IN_PROGRESS;
+		else if (TransactionIdDidCommit(xmin))
+			scan->analyzeStatus = COLUMNAR_ANALYZE_LIVE;
+		else
+			scan->analyzeStatus = COLUMNAR_ANALYZE_DEAD;
+
+		if (scan->analyzeStatus == COLUMNAR_ANALYZE_LIVE)
+			columnar_load_stripe(scan, false);
+	}
+
+	scan->analyzeRow = (uint64) (blkno - loc->start) * loc->nrows /
+		loc->nblocks;
+	scan->analyzeEnd = (uint64) (blkno - loc->start + 1) * loc->nrows /
+		loc->nblocks;
+
+	return true;
+}
+
+bool
+columnar_scan_analyze_next_tuple(TableScanDesc sscan, double *liverows,
+								 double *deadrows, TupleTableSlot *slot)
+{
+	ColumnarScanDesc scan = (ColumnarScanDesc) sscan;
+
+	if (scan->analyzeRow < scan->analyzeEnd)
+	{
+		ColumnarStripeHeader *hdr = scan->stripe;
+		int			group;
+
+		switch (scan->analyzeStatus)
+		{
+			case COLUMNAR_ANALYZE_LIVE:
+				group = scan->analyzeRow / hdr->chunkRows;
+				if (group != scan->group)
+					columnar_load_group(scan, group);
+				scan->row = scan->analyzeRow - group * hdr->chunkRows;
+				columnar_fill_slot(scan, slot);
+				scan->analyzeRow++;
+				*liverows += 1;
+				return true;
+
+			case COLUMNAR_ANALYZE_DEAD:
+				*deadrows += scan->analyzeEnd - scan->analyzeRow;
+				break;
+
+			case COLUMNAR_ANALYZE_IN_PROGRESS:
+				/* not counted; see heapam_scan_analyze_next_tuple() */
+				break;
+		}
+		scan->analyzeRow = scan->analyzeEnd;
+	}
+
+	ExecClearTuple(slot);
+	return false;
+}
@@ -0,0 +1,370 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_storage.c
+ *		Page-level storage of columnar tables.
+ *
+ * The relation's first page is the metapage.  It is created by the first
+ * insertion, so that an empty relation file is a valid empty table, which
+ * also makes the init fork of an unlogged table trivial.
+ *
+ * The stripes follow the metapage.  Each is written in one go, as a byte
+ * stream that fills the pages after their page header one after another.
+ * Stripes are appended under the relation extension lock, and become
+ * visible to scans only when the metapage is updated to cover them.  Apart
+ * from the xmin in their header, which VACUUM overwrites, they are never
+ * modified afterwards.
+ *
+ * All changes are WAL-logged with generic WAL records.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_storage.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/generic_xlog.h"
+#include "columnar.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/lmgr.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+static void columnar_init_metapage(Page page);
+static Buffer columnar_lock_metapage(Relation rel);
+
+/*
+ * Fill in a new metapage.
+ */
+static void
+columnar_init_metapage(Page page)
+{
+	ColumnarMetaPageData *meta;
+
+	PageInit(page, BLCKSZ, 0);
+
+	meta = ColumnarPageGetMeta(page);
+	meta->magic = COLUMNAR_MAGIC;
+	meta->version = COLUMNAR_VERSION;
+	meta->nblocks = COLUMNAR_METAPAGE_BLKNO + 1;
+	meta->nextRowNumber = 1;
+
+	((PageHeader) page)->pd_lower += sizeof(ColumnarMetaPageData);
+}
+
+/*
+ * Complain unless a metapage is what it should be.
+ */
+static void
+columnar_check_metapage(Relation rel, ColumnarMetaPageData *meta)
+{
+	if (meta->magic != COLUMNAR_MAGIC)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("metapage of columnar table \"%s\" is corrupted",
+						RelationGetRelationName(rel))));
+	if (meta->version != COLUMNAR_VERSION)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("columnar table \"%s\" has unsupported version %u",
+						RelationGetRelationName(rel), meta->version)));
+}
+
+/*
+ * Return the metapage exclusively locked, creating it if the relation is
+ * still empty.
+ */
+static Buffer
+columnar_lock_metapage(Relation rel)
+{
+	Buffer		buffer;
+	Page		page;
+
+	/* Extends the relation only if the metapage isn't there yet */
+	buffer = ExtendBufferedRelTo(BMR_REL(rel), MAIN_FORKNUM, NULL,
+								 EB_CREATE_FORK_IF_NEEDED,
+								 COLUMNAR_METAPAGE_BLKNO + 1, RBM_NORMAL);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+	page = BufferGetPage(buffer);
+
+	if (PageIsNew(page))
+	{
+		GenericXLogState *state;
+
+		state = GenericXLogStart(rel);
+		page = GenericXLogRegisterBuffer(state, buffer,
+										 GENERIC_XLOG_FULL_IMAGE);
+		columnar_init_metapage(page);
+		GenericXLogFinish(state);
+	}
+	else
+		columnar_check_metapage(rel, ColumnarPageGetMeta(page));
+
+	return buffer;
+}
+
+/*
+ * Read the metapage of a columnar table.  A table without one is empty.
+ */
+void
+ColumnarReadMetaPage(Relation rel, ColumnarMetaPageData *meta)
+{
+	Buffer		buffer;
+	Page		page;
+
+	if (RelationGetNumberOfBlocks(rel) <= COLUMNAR_METAPAGE_BLKNO)
+	{
+		meta->magic = COLUMNAR_MAGIC;
+		meta->version = COLUMNAR_VERSION;
+		meta->nblocks = COLUMNAR_METAPAGE_BLKNO + 1;
+		meta->nextRowNumber = 1;
+		return;
+	}
+
+	buffer = ReadBuffer(rel, COLUMNAR_METAPAGE_BLKNO);
+	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buffer);
+
+	if (PageIsNew(page))
+	{
+		/* a concurrent first insertion is just creating it */
+		UnlockReleaseBuffer(buffer);
+		meta->magic = COLUMNAR_MAGIC;
+		meta->version = COLUMNAR_VERSION;
+		meta->nblocks = COLUMNAR_METAPAGE_BLKNO + 1;
+		meta->nextRowNumber = 1;
+		return;
+	}
+
+	memcpy(meta, ColumnarPageGetMeta(page), sizeof(ColumnarMetaPageData));
+	UnlockReleaseBuffer(buffer);
+
+	columnar_check_metapage(rel, meta);
+}
+
+/*
+ * Hand out "count" consecutive row numbers, returning the first.
+ *
+ * Rows get their numbers as they are inserted, so that they have a TID right
+ * away, although they reach the table only when their stripe is written.
+ */
+uint64
+ColumnarReserveRowNumbers(Relation rel, uint32 count)
+{
+	Buffer		buffer;
+	GenericXLogState *state;
+	ColumnarMetaPageData *meta;
+	uint64		first;
+
+	buffer = columnar_lock_metapage(rel);
+
+	state = GenericXLogStart(rel);
+	meta = ColumnarPageGetMeta(GenericXLogRegisterBuffer(state, buffer, 0));
+	first = meta->nextRowNumber;
+	meta->nextRowNumber += count;
+	GenericXLogFinish(state);
+
+	UnlockReleaseBuffer(buffer);
+
+	return first;
+}
+
+/*
+ * Give back the row numbers from "end" down to "newEnd", reserved but left
+ * unused by a stripe, unless somebody else has reserved more since.
+ */
+void
+ColumnarReturnRowNumbers(Relation rel, uint64 end, uint64 newEnd)
+{
+	Buffer		buffer;
+	Page		page;
+
+	Assert(newEnd <= end);
+
+	buffer = columnar_lock_metapage(rel);
+	page = BufferGetPage(buffer);
+
+	if (ColumnarPageGetMeta(page)->nextRowNumber == end && newEnd < end)
+	{
+		GenericXLogState *state;
+
+		state = GenericXLogStart(rel);
+		page = GenericXLogRegisterBuffer(state, buffer, 0);
+		ColumnarPageGetMeta(page)->nextRowNumber = newEnd;
+		GenericXLogFinish(state);
+	}
+
+	UnlockReleaseBuffer(buffer);
+}
+
+/*
+ * Read "len" bytes at "offset" in the stripe starting at block "start".
+ */
+void
+ColumnarReadBytes(Relation rel, BlockNumber start, uint64 offset,
+				  char *dest, uint32 len)
+{
+	while (len > 0)
+	{
+		BlockNumber blkno = start + offset / COLUMNAR_BYTES_PER_PAGE;
+		uint32		pos = offset % COLUMNAR_BYTES_PER_PAGE;
+		uint32		n = Min(len, COLUMNAR_BYTES_PER_PAGE - pos);
+		Buffer		buffer;
+
+		buffer = ReadBuffer(rel, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		memcpy(dest, BufferGetPage(buffer) + SizeOfPageHeaderData + pos, n);
+		UnlockReleaseBuffer(buffer);
+
+		dest += n;
+		offset += n;
+		len -= n;
+	}
+}
+
+/*
+ * Read the header of the stripe starting at block "start", including its
+ * chunk directory and the minimum and maximum values, into palloc'd memory.
+ */
+ColumnarStripeHeader *
+ColumnarReadStripeHeader(Relation rel, BlockNumber start)
+{
+	ColumnarStripeHeader fixed;
+	ColumnarStripeHeader *hdr;
+
+	ColumnarReadBytes(rel, start, 0, (char *) &fixed, sizeof(fixed));
+
+	if (fixed.magic != COLUMNAR_STRIPE_MAGIC ||
+		fixed.headerSize < MAXALIGN(sizeof(ColumnarStripeHeader)) +
+		sizeof(ColumnarChunk) * fixed.ncolumns * fixed.nchunks ||
+		!AllocSizeIsValid(fixed.headerSize) ||
+		fixed.nblocks == 0 ||
+		(uint64) fixed.headerSize >
+		(uint64) fixed.nblocks * COLUMNAR_BYTES_PER_PAGE)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("stripe at block %u of columnar table \"%s\" is corrupted",
+						start, RelationGetRelationName(rel))));
+
+	hdr = palloc(fixed.headerSize);
+	memcpy(hdr, &fixed, sizeof(fixed));
+	if (fixed.headerSize > sizeof(fixed))
+		ColumnarReadBytes(rel, start, sizeof(fixed),
+						  (char *) hdr + sizeof(fixed),
+						  fixed.headerSize - sizeof(fixed));
+
+	return hdr;
+}
+
+/*
+ * Append a stripe to the table.  "data" begins with the stripe header, whose
+ * nblocks is filled in here.  Returns the block the stripe starts at.
+ */
+BlockNumber
+ColumnarWriteStripe(Relation rel, char *data, uint64 len)
+{
+	ColumnarStripeHeader *hdr = (ColumnarStripeHeader *) data;
+	Buffer		metabuffer;
+	ColumnarMetaPageData meta;
+	BlockNumber start;
+	BlockNumber nblocks;
+	BlockNumber relblocks;
+	BlockNumber i;
+	GenericXLogState *state;
+
+	nblocks = (len + COLUMNAR_BYTES_PER_PAGE - 1) / COLUMNAR_BYTES_PER_PAGE;
+	hdr->nblocks = nblocks;
+
+	/* Make sure the metapage exists before we take the extension lock */
+	metabuffer = columnar_lock_metapage(rel);
+	UnlockReleaseBuffer(metabuffer);
+
+	/*
+	 * Stripes are appended one at a time.  Since nobody else extends the
+	 * relation meanwhile, ours begins where the last one ended.  Any pages
+	 * past that were left behind by a crash, and we can reuse them.
+	 */
+	LockRelationForExtension(rel, ExclusiveLock);
+
+	ColumnarReadMetaPage(rel, &meta);
+	start = meta.nblocks;
+	relblocks = RelationGetNumberOfBlocks(rel);
+
+	for (i = 0; i < nblocks; i += MAX_GENERIC_XLOG_PAGES)
+	{
+		Buffer		buffers[MAX_GENERIC_XLOG_PAGES];
+		int			nbuffers = Min(nblocks - i, MAX_GENERIC_XLOG_PAGES);
+
+		CHECK_FOR_INTERRUPTS();
+
+		state = GenericXLogStart(rel);
+
+		for (int j = 0; j < nbuffers; j++)
+		{
+			BlockNumber blkno = start + i + j;
+			uint64		offset = (uint64) (i + j) * COLUMNAR_BYTES_PER_PAGE;
+			uint32		n = Min(len - offset, COLUMNAR_BYTES_PER_PAGE);
+			Page		page;
+
+			if (blkno < relblocks)
+				buffers[j] = ReadBufferExtended(rel, MAIN_FORKNUM, blkno,
+												RBM_ZERO_AND_LOCK, NULL);
+			else
+				buffers[j] = ExtendBufferedRel(BMR_REL(rel), MAIN_FORKNUM,
+											   NULL,
+											   EB_SKIP_EXTENSION_LOCK |
+											   EB_LOCK_FIRST);
+			if (BufferGetBlockNumber(buffers[j]) != blkno)
+				elog(ERROR, "unexpected block %u while writing stripe at %u of \"%s\"",
+					 BufferGetBlockNumber(buffers[j]), start,
+					 RelationGetRelationName(rel));
+
+			page = GenericXLogRegisterBuffer(state, buffers[j],
+											 GENERIC_XLOG_FULL_IMAGE);
+			PageInit(page, BLCKSZ, 0);
+			memcpy(page + SizeOfPageHeaderData, data + offset, n);
+			((PageHeader) page)->pd_lower = SizeOfPageHeaderData + n;
+		}
+
+		GenericXLogFinish(state);
+
+		for (int j = 0; j < nbuffers; j++)
+			UnlockReleaseBuffer(buffers[j]);
+	}
+
+	/* Now let scans see it */
+	metabuffer = columnar_lock_metapage(rel);
+	state = GenericXLogStart(rel);
+	ColumnarPageGetMeta(GenericXLogRegisterBuffer(state, metabuffer, 0))->nblocks =
+		start + nblocks;
+	GenericXLogFinish(state);
+	UnlockReleaseBuffer(metabuffer);
+
+	UnlockRelationForExtension(rel, ExclusiveLock);
+
+	return start;
+}
+
+/*
+ * Replace the xmin of the stripe starting at block "start", for VACUUM.
+ */
+void
+ColumnarSetStripeXmin(Relation rel, BlockNumber start, TransactionId xmin)
+{
+	Buffer		buffer;
+	GenericXLogState *state;
+	Page		page;
+
+	buffer = ReadBuffer(rel, start);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+	state = GenericXLogStart(rel);
+	page = GenericXLogRegisterBuffer(state, buffer, 0);
+	((ColumnarStripeHeader *) (page + SizeOfPageHeaderData))->xmin = xmin;
+	GenericXLogFinish(state);
+
+	UnlockReleaseBuffer(buffer);
+}
@@ -0,0 +1,762 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_tableam.c
+ *		Table access method callbacks of columnar tables.
+ *
+ * Columnar tables are append-only: rows can be inserted, and read by
+ * sequential scans, but not updated, deleted, locked or fetched by TID, so
+ * they can't have indexes either.  Space taken by aborted insertions is
+ * reclaimed by VACUUM FULL.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_tableam.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/multixact.h"
+#include "access/relation.h"
+#include "access/tableam.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/pg_am_d.h"
+#include "catalog/storage.h"
+#include "catalog/storage_xlog.h"
+#include "columnar.h"
+#include "commands/progress.h"
+#include "commands/vacuum.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "storage/bufmgr.h"
+#include "storage/predicate.h"
+#include "storage/procarray.h"
+#include "storage/smgr.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/timestamp.h"
+#include "utils/tuplestore.h"
+
+PG_MODULE_MAGIC_EXT(
+					.name = "columnar",
+					.version = PG_VERSION
+);
+
+/* GUC variables */
+bool		columnar_enable_custom_scan = true;
+int			columnar_compression = COLUMNAR_COMPRESSION_PGLZ;
+int			columnar_stripe_row_limit = 150000;
+int			columnar_chunk_group_row_limit = 10000;
+
+static const struct config_enum_entry compression_options[] = {
+	{"none", COLUMNAR_COMPRESSION_NONE, false},
+	{"pglz", COLUMNAR_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", COLUMNAR_COMPRESSION_LZ4, false},
+#endif
+	{NULL, 0, false}
+};
+
+static const TableAmRoutine columnar_methods;
+
+PG_FUNCTION_INFO_V1(columnar_handler);
+PG_FUNCTION_INFO_V1(columnar_stripe_info);
+
+/*
+ * Module load callback
+ */
+void
+_PG_init(void)
+{
+	DefineCustomBoolVariable("columnar.enable_custom_scan",
+							 "Enables the planner's use of columnar scans.",
+							 "Columnar scans read only the columns a query "
+							 "needs and skip chunk groups ruled out by its "
+							 "conditions.",
+							 &columnar_enable_custom_scan,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomEnumVariable("columnar.compression",
+							 "Compression method for new chunks of columnar tables.",
+							 NULL,
+							 &columnar_compression,
+							 COLUMNAR_COMPRESSION_PGLZ,
+							 compression_options,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable("columnar.stripe_row_limit",
+							"Maximum number of rows per stripe of columnar tables.",
+							NULL,
+							&columnar_stripe_row_limit,
+							150000,
+							1000,
+							10000000,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("columnar.chunk_group_row_limit",
+							"Number of rows per chunk group of columnar tables.",
+							NULL,
+							&columnar_chunk_group_row_limit,
+							10000,
+							100,
+							100000,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	MarkGUCPrefixReserved("columnar");
+
+	ColumnarRegisterXactCallbacks();
+	ColumnarInstallPlannerHook();
+}
+
+/*
+ * Is "rel" a columnar table?
+ */
+bool
+IsColumnarRelation(Relation rel)
+{
+	return rel->rd_tableam == &columnar_methods;
+}
+
+const TableAmRoutine *
+GetColumnarTableAmRoutine(void)
+{
+	return &columnar_methods;
+}
+
+Datum
+columnar_handler(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&columnar_methods);
+}
+
+/* ------------------------------------------------------------------------
+ * Slot and scan related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static const TupleTableSlotOps *
+columnar_slot_callbacks(Relation rel)
+{
+	return &TTSOpsVirtual;
+}
+
+/*
+ * Report an operation columnar tables don't support.
+ */
+static void
+columnar_unsupported(const char *what)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("columnar tables do not support %s", what)));
+}
+
+static struct IndexFetchTableData *
+columnar_index_fetch_begin(Relation rel, uint32 flags)
+{
+	columnar_unsupported("index scans");
+	return NULL;
+}
+
+static void
+columnar_index_fetch_reset(struct IndexFetchTableData *scan)
+{
+}
+
+static void
+columnar_index_fetch_end(struct IndexFetchTableData *scan)
+{
+}
+
+static bool
+columnar_index_fetch_tuple(struct IndexFetchTableData *scan,
+						   ItemPointer tid, Snapshot snapshot,
+						   TupleTableSlot *slot, bool *call_again,
+						   bool *all_dead)
+{
+	columnar_unsupported("index scans");
+	return false;
+}
+
+static bool
+columnar_fetch_row_version(Relation rel, ItemPointer tid, Snapshot snapshot,
+						   TupleTableSlot *slot)
+{
+	columnar_unsupported("fetching rows by TID");
+	return false;
+}
+
+static bool
+columnar_tuple_tid_valid(TableScanDesc scan, ItemPointer tid)
+{
+	columnar_unsupported("fetching rows by TID");
+	return false;
+}
+
+static void
+columnar_get_latest_tid(TableScanDesc sscan, ItemPointer tid)
+{
+	columnar_unsupported("fetching rows by TID");
+}
+
+static bool
+columnar_tuple_satisfies_snapshot(Relation rel, TupleTableSlot *slot,
+								  Snapshot snapshot)
+{
+	columnar_unsupported("fetching rows by TID");
+	return false;
+}
+
+static TransactionId
+columnar_index_delete_tuples(Relation rel, TM_IndexDeleteOp *delstate)
+{
+	columnar_unsupported("indexes");
+	return InvalidTransactionId;
+}
+
+/* ------------------------------------------------------------------------
+ * Manipulations of physical tuples
+ * ------------------------------------------------------------------------
+ */
+
+static void
+columnar_tuple_insert(Relation rel, TupleTableSlot *slot, CommandId cid,
+					  uint32 options, BulkInsertStateData *bistate)
+{
+	/* See heap_insert() */
+	CheckForSerializableConflictIn(rel, NULL, InvalidBlockNumber);
+
+	ColumnarInsertRow(rel, slot, cid);
+
+	pgstat_count_heap_insert(rel, 1);
+}
+
+static void
+columnar_tuple_insert_speculative(Relation rel, TupleTableSlot *slot,
+								  CommandId cid, uint32 options,
+								  BulkInsertStateData *bistate,
+								  uint32 specToken)
+{
+	columnar_unsupported("INSERT ... ON CONFLICT");
+}
+
+static void
+columnar_tuple_complete_speculative(Relation rel, TupleTableSlot *slot,
+									uint32 specToken, bool succeeded)
+{
+	columnar_unsupported("INSERT ... ON CONFLICT");
+}
+
+static void
+columnar_multi_insert(Relation rel, TupleTableSlot **slots, int ntuples,
+					  CommandId cid, uint32 options,
+					  BulkInsertStateData *bistate)
+{
+	CheckForSerializableConflictIn(rel, NULL, InvalidBlockNumber);
+
+	for (int i = 0; i < ntuples; i++)
+		ColumnarInsertRow(rel, slots[i], cid);
+
+	pgstat_count_heap_insert(rel, ntuples);
+}
+
+static TM_Result
+columnar_tuple_delete(Relation rel, ItemPointer tid, CommandId cid,
+					  uint32 options, Snapshot snapshot, Snapshot crosscheck,
+					  bool wait, TM_FailureData *tmfd)
+{
+	columnar_unsupported("DELETE");
+	return TM_Ok;
+}
+
+static TM_Result
+columnar_tuple_update(Relation rel, ItemPointer otid, TupleTableSlot *slot,
+					  CommandId cid, uint32 options, Snapshot snapshot,
+					  Snapshot crosscheck, bool wait, TM_FailureData *tmfd,
+					  LockTupleMode *lockmode,
+					  TU_UpdateIndexes *update_indexes)
+{
+	columnar_unsupported("UPDATE");
+	return TM_Ok;
+}
+
+static TM_Result
+columnar_tuple_lock(Relation rel, ItemPointer tid, Snapshot snapshot,
+					TupleTableSlot *slot, CommandId cid, LockTupleMode mode,
+					LockWaitPolicy wait_policy, uint8 flags,
+					TM_FailureData *tmfd)
+{
+	columnar_unsupported("locking rows");
+	return TM_Ok;
+}
+
+/* ------------------------------------------------------------------------
+ * DDL related callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static void
+columnar_relation_set_new_filelocator(Relation rel,
+									  const RelFileLocator *newrlocator,
+									  char persistence,
+									  TransactionId *freezeXid,
+									  MultiXactId *minmulti)
+{
+	SMgrRelation srel;
+
+	/* See heapam_relation_set_new_filelocator() */
+	*freezeXid = RecentXmin;
+	*minmulti = GetOldestMultiXactId();
+
+	srel = RelationCreateStorage(*newrlocator, persistence, true);
+
+	/*
+	 * The init fork of an unlogged table is empty, since an empty relation
+	 * is a valid empty table; see columnar_storage.c.
+	 */
+	if (persistence == RELPERSISTENCE_UNLOGGED)
+	{
+		smgrcreate(srel, INIT_FORKNUM, false);
+		log_smgrcreate(newrlocator, INIT_FORKNUM);
+	}
+
+	smgrclose(srel);
+
+	ColumnarDiscardPendingWrites(rel);
+}
+
+static void
+columnar_relation_nontransactional_truncate(Relation rel)
+{
+	ColumnarDiscardPendingWrites(rel);
+	RelationTruncate(rel, 0);
+}
+
+static void
+columnar_relation_copy_data(Relation rel, const RelFileLocator *newrlocator)
+{
+	SMgrRelation dstrel;
+
+	/* See heapam_relation_copy_data() */
+	ColumnarFlushPendingWrites(rel);
+	FlushRelationBuffers(rel);
+
+	dstrel = RelationCreateStorage(*newrlocator, rel->rd_rel->relpersistence, true);
+
+	RelationCopyStorage(RelationGetSmgr(rel), dstrel, MAIN_FORKNUM,
+						rel->rd_rel->relpersistence);
+
+	for (ForkNumber forkNum = MAIN_FORKNUM + 1;
+		 forkNum <= MAX_FORKNUM; forkNum++)
+	{
+		if (smgrexists(RelationGetSmgr(rel), forkNum))
+		{
+			smgrcreate(dstrel, forkNum, false);
+
+			if (RelationIsPermanent(rel) ||
+				(rel->rd_rel->relpersistence == RELPERSISTENCE_UNLOGGED &&
+				 forkNum == INIT_FORKNUM))
+				log_smgrcreate(newrlocator, forkNum);
+			RelationCopyStorage(RelationGetSmgr(rel), dstrel, forkNum,
+								rel->rd_rel->relpersistence);
+		}
+	}
+
+	RelationDropStorage(rel);
+	smgrclose(dstrel);
+}
+
+/*
+ * Rewrite the table for VACUUM FULL and CLUSTER, leaving out the stripes of
+ * aborted transactions.  Other stripes keep their xmin, unless it can be
+ * frozen.
+ */
+static void
+columnar_relation_copy_for_cluster(Relation OldTable, Relation NewTable,
+								   Relation OldIndex, bool use_sort,
+								   TransactionId OldestXmin,
+								   Snapshot snapshot,
+								   TransactionId *xid_cutoff,
+								   MultiXactId *multi_cutoff,
+								   double *num_tuples,
+								   double *tups_vacuumed,
+								   double *tups_recently_dead)
+{
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	ColumnarWriteState *state = NULL;
+	TransactionId lastXmin = InvalidTransactionId;
+	TransactionId newXmin = InvalidTransactionId;
+
+	if (OldIndex != NULL)
+		columnar_unsupported("clustering on an index");
+
+	*num_tuples = 0;
+	*tups_vacuumed = 0;
+	*tups_recently_dead = 0;
+
+	pgstat_progress_update_param(PROGRESS_REPACK_PHASE,
+								 PROGRESS_REPACK_PHASE_SEQ_SCAN_HEAP);
+
+	scan = columnar_beginscan(OldTable, SnapshotAny, 0, NULL, NULL,
+							  SO_TYPE_SEQSCAN);
+	slot = table_slot_create(OldTable, NULL);
+
+	while (columnar_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		TransactionId xmin = columnar_scan_stripe_xmin(scan);
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* Work out what to do with the rows of each stripe once */
+		if (!TransactionIdEquals(xmin, lastXmin))
+		{
+			lastXmin = xmin;
+
+			if (TransactionIdEquals(xmin, FrozenTransactionId))
+				newXmin = FrozenTransactionId;
+			else if (TransactionIdIsInProgress(xmin))
+				newXmin = xmin;
+			else if (!TransactionIdDidCommit(xmin))
+				newXmin = InvalidTransactionId;
+			else if (TransactionIdPrecedes(xmin, *xid_cutoff))
+				newXmin = FrozenTransactionId;
+			else
+				newXmin = xmin;
+
+			if (state != NULL)
+			{
+				ColumnarFlushWrite(state, NewTable);
+				ColumnarEndWrite(state);
+				state = NULL;
+			}
+			if (TransactionIdIsValid(newXmin))
+				state = ColumnarBeginWrite(NewTable, newXmin, FirstCommandId);
+		}
+
+		if (state == NULL)
+		{
+			*tups_vacuumed += 1;
+			continue;
+		}
+
+		ColumnarWriteRow(state, NewTable, slot);
+		*num_tuples += 1;
+	}
+
+	if (state != NULL)
+	{
+		ColumnarFlushWrite(state, NewTable);
+		ColumnarEndWrite(state);
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	columnar_endscan(scan);
+}
+
+/*
+ * VACUUM freezes the xmin of the stripes of committed transactions older
+ * than any snapshot, and marks the stripes of aborted transactions so that
+ * they needn't be looked up again.  It doesn't reclaim any space.
+ */
+static void
+columnar_relation_vacuum(Relation rel, const VacuumParams *params,
+						 BufferAccessStrategy bstrategy)
+{
+	struct VacuumCutoffs cutoffs;
+	ColumnarMetaPageData meta;
+	BlockNumber start;
+	TransactionId newFrozenXid;
+	double		livetuples = 0;
+	TimestampTz starttime = GetCurrentTimestamp();
+
+	pgstat_progress_start_command(PROGRESS_COMMAND_VACUUM,
+								  RelationGetRelid(rel));
+
+	vacuum_get_cutoffs(rel, params, &cutoffs);
+	newFrozenXid = cutoffs.OldestXmin;
+
+	ColumnarReadMetaPage(rel, &meta);
+
+	for (start = COLUMNAR_METAPAGE_BLKNO + 1; start < meta.nblocks;)
+	{
+		ColumnarStripeHeader fixed;
+		TransactionId xmin;
+
+		vacuum_delay_point(false);
+
+		ColumnarReadBytes(rel, start, 0, (char *) &fixed, sizeof(fixed));
+		if (fixed.magic != COLUMNAR_STRIPE_MAGIC || fixed.nblocks == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("stripe at block %u of columnar table \"%s\" is corrupted",
+							start, RelationGetRelationName(rel))));
+		xmin = fixed.xmin;
+
+		if (!TransactionIdIsNormal(xmin))
+		{
+			if (TransactionIdEquals(xmin, FrozenTransactionId))
+				livetuples += fixed.nrows;
+		}
+		else if (TransactionIdPrecedes(xmin, cutoffs.OldestXmin))
+		{
+			if (TransactionIdDidCommit(xmin))
+			{
+				ColumnarSetStripeXmin(rel, start, FrozenTransactionId);
+				livetuples += fixed.nrows;
+			}
+			else
+				ColumnarSetStripeXmin(rel, start, InvalidTransactionId);
+		}
+		else
+		{
+			if (TransactionIdPrecedes(xmin, newFrozenXid))
+				newFrozenXid = xmin;
+			if (TransactionIdDidCommit(xmin))
+				livetuples += fixed.nrows;
+		}
+
+		start += fixed.nblocks;
+	}
+
+	vac_update_relstats(rel, RelationGetNumberOfBlocks(rel), livetuples,
+						0, 0, false, newFrozenXid, cutoffs.OldestMxact,
+						NULL, NULL, false);
+
+	pgstat_report_vacuum(rel, livetuples, 0, starttime);
+	pgstat_progress_end_command();
+}
+
+static double
+columnar_index_build_range_scan(Relation table_rel, Relation index_rel,
+								IndexInfo *index_info, bool allow_sync,
+								bool anyvisible, bool progress,
+								BlockNumber start_blockno,
+								BlockNumber numblocks,
+								IndexBuildCallback callback,
+								void *callback_state, TableScanDesc scan)
+{
+	columnar_unsupported("indexes");
+	return 0;
+}
+
+static void
+columnar_index_validate_scan(Relation table_rel, Relation index_rel,
+							 IndexInfo *index_info, Snapshot snapshot,
+							 ValidateIndexState *state)
+{
+	columnar_unsupported("indexes");
+}
+
+/* ------------------------------------------------------------------------
+ * Miscellaneous callbacks
+ * ------------------------------------------------------------------------
+ */
+
+static bool
+columnar_relation_needs_toast_table(Relation rel)
+{
+	/* values are detoasted and compressed in chunks */
+	return false;
+}
+
+/*
+ * Estimate the number of rows from the density seen by the last VACUUM or
+ * ANALYZE, or, failing that, from the row numbers handed out.
+ */
+static void
+columnar_estimate_rel_size(Relation rel, int32 *attr_widths,
+						   BlockNumber *pages, double *tuples,
+						   double *allvisfrac)
+{
+	BlockNumber curpages = RelationGetNumberOfBlocks(rel);
+	BlockNumber relpages = rel->rd_rel->relpages;
+	double		reltuples = rel->rd_rel->reltuples;
+
+	*pages = curpages;
+	*allvisfrac = 0;
+
+	if (curpages <= COLUMNAR_METAPAGE_BLKNO + 1)
+		*tuples = 0;
+	else if (reltuples >= 0 && relpages > 0)
+		*tuples = rint(reltuples / relpages * curpages);
+	else
+	{
+		ColumnarMetaPageData meta;
+
+		ColumnarReadMetaPage(rel, &meta);
+		*tuples = meta.nextRowNumber - 1;
+	}
+}
+
+static bool
+columnar_scan_sample_next_block(TableScanDesc scan,
+								SampleScanState *scanstate)
+{
+	columnar_unsupported("TABLESAMPLE");
+	return false;
+}
+
+static bool
+columnar_scan_sample_next_tuple(TableScanDesc scan,
+								SampleScanState *scanstate,
+								TupleTableSlot *slot)
+{
+	columnar_unsupported("TABLESAMPLE");
+	return false;
+}
+
+static const TableAmRoutine columnar_methods = {
+	.type = T_TableAmRoutine,
+
+	.slot_callbacks = columnar_slot_callbacks,
+
+	.scan_begin = columnar_beginscan,
+	.scan_end = columnar_endscan,
+	.scan_rescan = columnar_rescan,
+	.scan_getnextslot = columnar_getnextslot,
+
+	.parallelscan_estimate = table_block_parallelscan_estimate,
+	.parallelscan_initialize = table_block_parallelscan_initialize,
+	.parallelscan_reinitialize = table_block_parallelscan_reinitialize,
+
+	.index_fetch_begin = columnar_index_fetch_begin,
+	.index_fetch_reset = columnar_index_fetch_reset,
+	.index_fetch_end = columnar_index_fetch_end,
+	.index_fetch_tuple = columnar_index_fetch_tuple,
+
+	.tuple_insert = columnar_tuple_insert,
+	.tuple_insert_speculative = columnar_tuple_insert_speculative,
+	.tuple_complete_speculative = columnar_tuple_complete_speculative,
+	.multi_insert = columnar_multi_insert,
+	.tuple_delete = columnar_tuple_delete,
+	.tuple_update = columnar_tuple_update,
+	.tuple_lock = columnar_tuple_lock,
+
+	.tuple_fetch_row_version = columnar_fetch_row_version,
+	.tuple_get_latest_tid = columnar_get_latest_tid,
+	.tuple_tid_valid = columnar_tuple_tid_valid,
+	.tuple_satisfies_snapshot = columnar_tuple_satisfies_snapshot,
+	.index_delete_tuples = columnar_index_delete_tuples,
+
+	.relation_set_new_filelocator = columnar_relation_set_new_filelocator,
+	.relation_nontransactional_truncate = columnar_relation_nontransactional_truncate,
+	.relation_copy_data = columnar_relation_copy_data,
+	.relation_copy_for_cluster = columnar_relation_copy_for_cluster,
+	.relation_vacuum = columnar_relation_vacuum,
+	.scan_analyze_next_block = columnar_scan_analyze_next_block,
+	.scan_analyze_next_tuple = columnar_scan_analyze_next_tuple,
+	.index_build_range_scan = columnar_index_build_range_scan,
+	.index_validate_scan = columnar_index_validate_scan,
+
+	.relation_size = table_block_relation_size,
+	.relation_needs_toast_table = columnar_relation_needs_toast_table,
+
+	.relation_estimate_size = columnar_estimate_rel_size,
+
+	.scan_sample_next_block = columnar_scan_sample_next_block,
+	.scan_sample_next_tuple = columnar_scan_sample_next_tuple
+};
+
+/*
+ * columnar_stripe_info(regclass)
+ *
+ * Return a row for each stripe of a columnar table.
+ */
+Datum
+columnar_stripe_info(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	Relation	rel;
+	AclResult	aclresult;
+	ColumnarMetaPageData meta;
+	BlockNumber start;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	rel = relation_open(relid, AccessShareLock);
+
+	if (!IsColumnarRelation(rel))
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a columnar table",
+						RelationGetRelationName(rel))));
+
+	aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_SELECT);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult, get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+
+	ColumnarFlushPendingWrites(rel);
+	ColumnarReadMetaPage(rel, &meta);
+
+	for (start = COLUMNAR_METAPAGE_BLKNO + 1; start < meta.nblocks;)
+	{
+		ColumnarStripeHeader *hdr;
+		Datum		values[8];
+		bool		nulls[8] = {0};
+		int64		stored = 0;
+		int64		raw = 0;
+
+		CHECK_FOR_INTERRUPTS();
+
+		hdr = ColumnarReadStripeHeader(rel, start);
+		for (int i = 0; i < hdr->ncolumns * hdr->nchunks; i++)
+		{
+			ColumnarChunk *chunk = ColumnarStripeChunk(hdr, 0, 0) + i;
+
+			stored += chunk->size;
+			raw += chunk->rawSize;
+		}
+
+		values[0] = Int64GetDatum(start);
+		values[1] = Int64GetDatum(hdr->nblocks);
+		values[2] = Int64GetDatum(hdr->firstRowNumber);
+		values[3] = Int64GetDatum(hdr->nrows);
+		values[4] = Int32GetDatum(hdr->nchunks);
+		values[5] = Int64GetDatum(stored);
+		values[6] = Int64GetDatum(raw);
+		if (TransactionIdIsValid(hdr->xmin))
+			values[7] = TransactionIdGetDatum(hdr->xmin);
+		else
+			nulls[7] = true;
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc,
+							 values, nulls);
+
+		start += hdr->nblocks;
+		pfree(hdr);
+	}
+
+	relation_close(rel, AccessShareLock);
+
+	return (Datum) 0;
+}
@@ -0,0 +1,683 @@
+/*-------------------------------------------------------------------------
+ *
+ * columnar_writer.c
+ *		Building stripes of columnar tables.
+ *
+ * Inserted rows are buffered in memory, column by column, and written out as
+ * a stripe once there are columnar.stripe_row_limit of them, or at the end
+ * of the transaction.  A stripe holds rows of a single transaction and
+ * command, since its visibility is decided as a whole, so a change of
+ * either also ends the stripe.  Scans of the table write out the rows
+ * buffered for it first, so that the transaction sees its own insertions.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  contrib/columnar/columnar_writer.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/relation.h"
+#include "access/toast_compression.h"
+#include "access/tupmacs.h"
+#include "access/xact.h"
+#include "columnar.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "utils/datum.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+#include "varatt.h"
+
+/*
+ * Stripes are written out early if their values take more memory than this,
+ * so that a stripe stays well below the limit on the size of an allocation.
+ */
+#define COLUMNAR_MAX_STRIPE_BYTES	(256 * 1024 * 1024)
+
+/* Compressing chunks smaller than this isn't worth it */
+#define COLUMNAR_MIN_COMPRESS_SIZE	64
+
+struct ColumnarWriteState
+{
+	Oid			relid;			/* table being written */
+	RelFileNumber relnumber;	/* ... and its relfilenumber */
+	TransactionId xid;			/* xmin of the stripe */
+	CommandId	cid;			/* cid of the stripe */
+	SubTransactionId subid;		/* subtransaction that buffered the rows */
+	int			compression;	/* ColumnarCompression of the chunks */
+	int			maxrows;		/* rows per stripe */
+	int			chunkRows;		/* rows per chunk group */
+	int			natts;			/* number of attributes */
+	int			nrows;			/* number of buffered rows */
+	int			allocrows;		/* allocated length of the arrays */
+	Size		nbytes;			/* memory taken by by-reference values */
+	uint64		firstRowNumber; /* row number of the first row, or 0 */
+	Datum	  **values;			/* for each attribute, its values */
+	bool	  **isnull;			/* for each attribute, its null flags */
+	MemoryContext context;		/* holds this struct and the arrays */
+	MemoryContext rowcontext;	/* holds the by-reference values */
+	struct ColumnarWriteState *next;	/* next pending write, if any */
+};
+
+/* Rows inserted into columnar tables by the current transaction */
+static ColumnarWriteState *pendingWrites = NULL;
+static MemoryContext pendingWritesContext = NULL;
+
+static void columnar_reset_columns(ColumnarWriteState *state, int natts);
+static void columnar_encode_chunk(ColumnarWriteState *state,
+								  Form_pg_attribute att,
+								  TypeCacheEntry *typentry,
+								  int col, int group,
+								  ColumnarChunk *chunk,
+								  StringInfo raw, StringInfo minmax,
+								  StringInfo data);
+static void columnar_append_value(StringInfo buf, Form_pg_attribute att,
+								  Datum value);
+static Size columnar_value_size(Form_pg_attribute att, Datum value);
+static void columnar_xact_callback(XactEvent event, void *arg);
+static void columnar_subxact_callback(SubXactEvent event,
+									  SubTransactionId mySubid,
+									  SubTransactionId parentSubid,
+									  void *arg);
+
+/*
+ * Start buffering rows to be written to "rel" as stripes with the given
+ * xmin and cid.
+ */
+ColumnarWriteState *
+ColumnarBeginWrite(Relation rel, TransactionId xid, CommandId cid)
+{
+	MemoryContext context;
+	ColumnarWriteState *state;
+
+	context = AllocSetContextCreate(CurrentMemoryContext,
+									"columnar write",
+									ALLOCSET_DEFAULT_SIZES);
+	state = MemoryContextAllocZero(context, sizeof(ColumnarWriteState));
+	state->context = context;
+	state->rowcontext = AllocSetContextCreate(context,
+											  "columnar write rows",
+											  ALLOCSET_DEFAULT_SIZES);
+	state->relid = RelationGetRelid(rel);
+	state->relnumber = rel->rd_locator.relNumber;
+	state->xid = xid;
+	state->cid = cid;
+	state->subid = InvalidSubTransactionId;
+	state->compression = columnar_compression;
+	state->maxrows = columnar_stripe_row_limit;
+	state->chunkRows = Min(columnar_chunk_group_row_limit, state->maxrows);
+	columnar_reset_columns(state, RelationGetDescr(rel)->natts);
+
+	return state;
+}
+
+/*
+ * Set up the column arrays for "natts" attributes.  No rows may be buffered.
+ */
+static void
+columnar_reset_columns(ColumnarWriteState *state, int natts)
+{
+	Assert(state->nrows == 0);
+
+	if (state->values)
+	{
+		for (int i = 0; i < state->natts; i++)
+		{
+			pfree(state->values[i]);
+			pfree(state->isnull[i]);
+		}
+		pfree(state->values);
+		pfree(state->isnull);
+	}
+
+	state->natts = natts;
+	state->allocrows = Min(state->maxrows, 1024);
+	state->values = MemoryContextAlloc(state->context,
+									   sizeof(Datum *) * natts);
+	state->isnull = MemoryContextAlloc(state->context,
+									   sizeof(bool *) * natts);
+	for (int i = 0; i < natts; i++)
+	{
+		state->values[i] = MemoryContextAlloc(state->context,
+											  sizeof(Datum) * state->allocrows);
+		state->isnull[i] = MemoryContextAlloc(state->context,
+											  sizeof(bool) * state->allocrows);
+	}
+}
+
+/*
+ * Buffer the row in "slot", writing out a stripe if that fills it.  Sets the
+ * TID of the slot.
+ */
+void
+ColumnarWriteRow(ColumnarWriteState *state, Relation rel,
+				 TupleTableSlot *slot)
+{
+	TupleDesc	desc = RelationGetDescr(rel);
+	MemoryContext oldcontext;
+	int			row;
+
+	Assert(desc->natts == state->natts);
+
+	slot_getallattrs(slot);
+
+	/*
+	 * The row numbers of the whole stripe are handed out at once, and those
+	 * left over returned when it's written.
+	 */
+	if (state->firstRowNumber == 0)
+		state->firstRowNumber = ColumnarReserveRowNumbers(rel, state->maxrows);
+
+	if (state->nrows == state->allocrows)
+	{
+		state->allocrows = Min(state->allocrows * 2, state->maxrows);
+		for (int i = 0; i < state->natts; i++)
+		{
+			state->values[i] = repalloc(state->values[i],
+										sizeof(Datum) * state->allocrows);
+			state->isnull[i] = repalloc(state->isnull[i],
+										sizeof(bool) * state->allocrows);
+		}
+	}
+
+	row = state->nrows;
+	oldcontext = MemoryContextSwitchTo(state->rowcontext);
+	for (int i = 0; i < state->natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(desc, i);
+		Datum		value = slot->tts_values[i];
+
+		if (slot->tts_isnull[i] || att->attisdropped)
+		{
+			state->values[i][row] = (Datum) 0;
+			state->isnull[i][row] = true;
+			continue;
+		}
+
+		/* By-reference values are copied, varlenas detoasted */
+		if (att->attlen == -1)
+			value = PointerGetDatum(PG_DETOAST_DATUM_COPY(value));
+		else if (!att->attbyval)
+			value = datumCopy(value, false, att->attlen);
+		if (!att->attbyval)
+			state->nbytes += columnar_value_size(att, value);
+
+		state->values[i][row] = value;
+		state->isnull[i][row] = false;
+	}
+	MemoryContextSwitchTo(oldcontext);
+
+	ColumnarRowNumberToTid(state->firstRowNumber + row, &slot->tts_tid);
+	slot->tts_tableOid = RelationGetRelid(rel);
+	state->nrows++;
+
+	if (state->nrows == state->maxrows ||
+		state->nbytes >= COLUMNAR_MAX_STRIPE_BYTES)
+		ColumnarFlushWrite(state, rel);
+}
+
+/*
+ * Write out the buffered rows as a stripe.
+ */
+void
+ColumnarFlushWrite(ColumnarWriteState *state, Relation rel)
+{
+	TupleDesc	desc = RelationGetDescr(rel);
+	MemoryContext tmpcontext;
+	MemoryContext oldcontext;
+	ColumnarStripeHeader hdr;
+	ColumnarChunk *chunks;
+	Size		dirsize;
+	StringInfoData raw;
+	StringInfoData minmax;
+	StringInfoData data;
+	uint32		headerSize;
+	uint32		minmaxStart;
+	char	   *stripe;
+	uint64		len;
+
+	if (state->nrows == 0)
+		return;
+
+	Assert(desc->natts == state->natts);
+
+	tmpcontext = AllocSetContextCreate(CurrentMemoryContext,
+									   "columnar stripe",
+									   ALLOCSET_DEFAULT_SIZES);
+	oldcontext = MemoryContextSwitchTo(tmpcontext);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = COLUMNAR_STRIPE_MAGIC;
+	hdr.xmin = state->xid;
+	hdr.cid = state->cid;
+	hdr.nrows = state->nrows;
+	hdr.firstRowNumber = state->firstRowNumber;
+	hdr.chunkRows = state->chunkRows;
+	hdr.ncolumns = state->natts;
+	hdr.nchunks = (state->nrows + state->chunkRows - 1) / state->chunkRows;
+
+	dirsize = sizeof(ColumnarChunk) * hdr.ncolumns * hdr.nchunks;
+	chunks = palloc0(dirsize);
+
+	initStringInfo(&raw);
+	initStringInfo(&minmax);
+	initStringInfo(&data);
+
+	for (int col = 0; col < state->natts; col++)
+	{
+		Form_pg_attribute att = TupleDescAttr(desc, col);
+		TypeCacheEntry *typentry = NULL;
+
+		/* Keep track of minimum and maximum if the type has a btree opclass */
+		if (!att->attisdropped && att->attlen != -2)
+		{
+			typentry = lookup_type_cache(att->atttypid,
+										 TYPECACHE_CMP_PROC_FINFO);
+			if (!OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+				typentry = NULL;
+		}
+
+		for (int group = 0; group < hdr.nchunks; group++)
+		{
+			CHECK_FOR_INTERRUPTS();
+			columnar_encode_chunk(state, att, typentry, col, group,
+								  &chunks[col * hdr.nchunks + group],
+								  &raw, &minmax, &data);
+		}
+	}
+
+	/* Lay out the stripe: header, directory, minimum and maximum, chunks */
+	minmaxStart = MAXALIGN(sizeof(ColumnarStripeHeader)) + MAXALIGN(dirsize);
+	headerSize = minmaxStart + minmax.len;
+	hdr.headerSize = headerSize;
+	for (int i = 0; i < hdr.ncolumns * hdr.nchunks; i++)
+	{
+		chunks[i].offset += headerSize;
+		chunks[i].minmaxOffset += minmaxStart;
+	}
+
+	len = (uint64) headerSize + data.len;
+	if (!AllocSizeIsValid(len))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("stripe of columnar table \"%s\" is too large",
+						RelationGetRelationName(rel))));
+
+	stripe = palloc0(len);
+	memcpy(stripe, &hdr, sizeof(hdr));
+	memcpy(stripe + MAXALIGN(sizeof(ColumnarStripeHeader)), chunks, dirsize);
+	memcpy(stripe + minmaxStart, minmax.data, minmax.len);
+	memcpy(stripe + headerSize, data.data, data.len);
+
+	ColumnarWriteStripe(rel, stripe, len);
+	ColumnarReturnRowNumbers(rel, state->firstRowNumber + state->maxrows,
+							 state->firstRowNumber + state->nrows);
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextDelete(tmpcontext);
+
+	/* Start over */
+	MemoryContextReset(state->rowcontext);
+	state->nrows = 0;
+	state->nbytes = 0;
+	state->firstRowNumber = 0;
+}
+
+/*
+ * Stop writing, discarding any rows not yet written out.
+ */
+void
+ColumnarEndWrite(ColumnarWriteState *state)
+{
+	MemoryContextDelete(state->context);
+}
+
+/*
+ * Encode the values of column "col" in chunk group "group", appending them
+ * to "data", and their minimum and maximum to "minmax".  "raw" is a work
+ * buffer.  The offsets stored in the chunk are relative to the start of
+ * "data" and "minmax".
+ */
+static void
+columnar_encode_chunk(ColumnarWriteState *state, Form_pg_attribute att,
+					  TypeCacheEntry *typentry, int col, int group,
+					  ColumnarChunk *chunk, StringInfo raw,
+					  StringInfo minmax, StringInfo data)
+{
+	int			first = group * state->chunkRows;
+	int			nrows = Min(state->chunkRows, state->nrows - first);
+	Datum	   *values = state->values[col] + first;
+	bool	   *isnull = state->isnull[col] + first;
+	int			nnulls = 0;
+	Datum		min = (Datum) 0;
+	Datum		max = (Datum) 0;
+	bool		have_minmax = false;
+	char	   *stored;
+	uint32		size;
+	char		pad[MAXIMUM_ALIGNOF] = {0};
+
+	for (int i = 0; i < nrows; i++)
+		if (isnull[i])
+			nnulls++;
+
+	chunk->offset = data->len;
+	chunk->minmaxOffset = minmax->len;
+	chunk->compression = COLUMNAR_COMPRESSION_NONE;
+
+	if (nnulls == nrows)
+	{
+		chunk->flags = COLUMNAR_CHUNK_ALL_NULLS;
+		return;
+	}
+
+	/*
+	 * The raw chunk is built after a varlena header, so that it can be handed
+	 * to the compression routines as is.  It consists of a null bitmap if
+	 * there are nulls, padded to MAXALIGN, then the non-null values aligned
+	 * like in a heap tuple, relative to the start of the chunk.
+	 */
+	resetStringInfo(raw);
+	appendBinaryStringInfo(raw, pad, VARHDRSZ);
+
+	if (nnulls > 0)
+	{
+		int			nbytes = (nrows + 7) / 8;
+		char	   *bits;
+
+		chunk->flags |= COLUMNAR_CHUNK_HAS_NULLS;
+		enlargeStringInfo(raw, nbytes);
+		bits = raw->data + raw->len;
+		memset(bits, 0, nbytes);
+		for (int i = 0; i < nrows; i++)
+			if (!isnull[i])
+				bits[i / 8] |= 1 << (i % 8);
+		raw->len += nbytes;
+		appendBinaryStringInfo(raw, pad,
+							   MAXALIGN(nbytes) - nbytes);
+	}
+
+	for (int i = 0; i < nrows; i++)
+	{
+		if (isnull[i])
+			continue;
+
+		columnar_append_value(raw, att, values[i]);
+
+		if (typentry == NULL)
+			continue;
+		if (!have_minmax)
+		{
+			min = max = values[i];
+			have_minmax = true;
+		}
+		else if (DatumGetInt32(FunctionCall2Coll(&typentry->cmp_proc_finfo,
+												 att->attcollation,
+												 values[i], min)) < 0)
+			min = values[i];
+		else if (DatumGetInt32(FunctionCall2Coll(&typentry->cmp_proc_finfo,
+												 att->attcollation,
+												 values[i], max)) > 0)
+			max = values[i];
+	}
+
+	chunk->rawSize = raw->len - VARHDRSZ;
+	stored = raw->data + VARHDRSZ;
+	size = chunk->rawSize;
+
+	if (state->compression != COLUMNAR_COMPRESSION_NONE &&
+		chunk->rawSize >= COLUMNAR_MIN_COMPRESS_SIZE)
+	{
+		varlena    *compressed;
+
+		SET_VARSIZE(raw->data, raw->len);
+		if (state->compression == COLUMNAR_COMPRESSION_LZ4)
+			compressed = lz4_compress_datum((varlena *) raw->data);
+		else
+			compressed = pglz_compress_datum((varlena *) raw->data);
+
+		if (compressed != NULL && VARSIZE(compressed) < chunk->rawSize)
+		{
+			chunk->compression = state->compression;
+			stored = (char *) compressed;
+			size = VARSIZE(compressed);
+		}
+	}
+
+	chunk->size = size;
+	appendBinaryStringInfo(data, stored, size);
+
+	/* Remember the minimum and maximum, unless they're too large */
+	if (have_minmax)
+	{
+		Size		minSize = columnar_value_size(att, min);
+		Size		maxSize = columnar_value_size(att, max);
+
+		if (minSize <= COLUMNAR_MAX_MINMAX_SIZE &&
+			maxSize <= COLUMNAR_MAX_MINMAX_SIZE)
+		{
+			chunk->flags |= COLUMNAR_CHUNK_HAS_MINMAX;
+			chunk->minSize = minSize;
+			chunk->maxSize = maxSize;
+			if (att->attbyval)
+			{
+				appendBinaryStringInfo(minmax, (char *) &min, sizeof(Datum));
+				appendBinaryStringInfo(minmax, (char *) &max, sizeof(Datum));
+			}
+			else
+			{
+				appendBinaryStringInfo(minmax, DatumGetPointer(min), minSize);
+				appendBinaryStringInfo(minmax, pad,
+									   MAXALIGN(minSize) - minSize);
+				appendBinaryStringInfo(minmax, DatumGetPointer(max), maxSize);
+			}
+			appendBinaryStringInfo(minmax, pad,
+								   MAXALIGN(minmax->len) - minmax->len);
+		}
+	}
+}
+
+/*
+ * Append a non-null value to a raw chunk, after the alignment padding it
+ * needs.
+ */
+static void
+columnar_append_value(StringInfo buf, Form_pg_attribute att, Datum value)
+{
+	uint32		off = buf->len - VARHDRSZ;
+	uint32		aligned = att_align_nominal(off, att->attalign);
+	Size		size = columnar_value_size(att, value);
+
+	enlargeStringInfo(buf, (aligned - off) + size);
+	memset(buf->data + buf->len, 0, aligned - off);
+	buf->len += aligned - off;
+
+	if (att->attbyval)
+		store_att_byval(buf->data + buf->len, value, att->attlen);
+	else
+		memcpy(buf->data + buf->len, DatumGetPointer(value), size);
+	buf->len += size;
+}
+
+/*
+ * Size of a value as stored in a chunk.  (The minimum and maximum of
+ * by-value types are stored as whole Datums, however.)
+ */
+static Size
+columnar_value_size(Form_pg_attribute att, Datum value)
+{
+	if (att->attlen > 0)
+		return att->attlen;
+	if (att->attlen == -1)
+		return VARSIZE(DatumGetPointer(value));
+	return strlen(DatumGetCString(value)) + 1;
+}
+
+/*
+ * Buffer a row inserted into "rel" by the current command, to be written out
+ * by the end of the transaction.
+ */
+void
+ColumnarInsertRow(Relation rel, TupleTableSlot *slot, CommandId cid)
+{
+	TransactionId xid = GetCurrentTransactionId();
+	int			natts = RelationGetDescr(rel)->natts;
+	ColumnarWriteState *state;
+
+	for (state = pendingWrites; state != NULL; state = state->next)
+		if (state->relid == RelationGetRelid(rel))
+			break;
+
+	if (state == NULL)
+	{
+		MemoryContext oldcontext;
+
+		if (pendingWritesContext == NULL)
+			pendingWritesContext = AllocSetContextCreate(TopTransactionContext,
+														 "columnar pending writes",
+														 ALLOCSET_SMALL_SIZES);
+		oldcontext = MemoryContextSwitchTo(pendingWritesContext);
+		state = ColumnarBeginWrite(rel, xid, cid);
+		MemoryContextSwitchTo(oldcontext);
+
+		state->next = pendingWrites;
+		pendingWrites = state;
+	}
+	else
+	{
+		/* Rows buffered before a TRUNCATE in this transaction are gone */
+		if (state->relnumber != rel->rd_locator.relNumber)
+		{
+			MemoryContextReset(state->rowcontext);
+			state->nrows = 0;
+			state->nbytes = 0;
+			state->firstRowNumber = 0;
+			state->relnumber = rel->rd_locator.relNumber;
+		}
+
+		/* A stripe holds rows of a single transaction and command */
+		if (state->xid != xid || state->cid != cid || state->natts != natts)
+			ColumnarFlushWrite(state, rel);
+		state->xid = xid;
+		state->cid = cid;
+		if (state->natts != natts)
+			columnar_reset_columns(state, natts);
+	}
+
+	if (state->nrows == 0)
+		state->subid = GetCurrentSubTransactionId();
+
+	ColumnarWriteRow(state, rel, slot);
+}
+
+/*
+ * Write out the rows buffered for "rel", so that scans can see them.
+ */
+void
+ColumnarFlushPendingWrites(Relation rel)
+{
+	for (ColumnarWriteState *state = pendingWrites; state != NULL;
+		 state = state->next)
+	{
+		if (state->relid == RelationGetRelid(rel) &&
+			state->relnumber == rel->rd_locator.relNumber)
+			ColumnarFlushWrite(state, rel);
+	}
+}
+
+/*
+ * Forget the rows buffered for "rel", when it gets truncated.
+ */
+void
+ColumnarDiscardPendingWrites(Relation rel)
+{
+	for (ColumnarWriteState *state = pendingWrites; state != NULL;
+		 state = state->next)
+	{
+		if (state->relid == RelationGetRelid(rel))
+		{
+			MemoryContextReset(state->rowcontext);
+			state->nrows = 0;
+			state->nbytes = 0;
+			state->firstRowNumber = 0;
+		}
+	}
+}
+
+void
+ColumnarRegisterXactCallbacks(void)
+{
+	RegisterXactCallback(columnar_xact_callback, NULL);
+	RegisterSubXactCallback(columnar_subxact_callback, NULL);
+}
+
+/*
+ * Write out all buffered rows before commit, and forget about them at the
+ * end of the transaction.
+ */
+static void
+columnar_xact_callback(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_PRE_COMMIT:
+		case XACT_EVENT_PRE_PREPARE:
+			for (ColumnarWriteState *state = pendingWrites; state != NULL;
+				 state = state->next)
+			{
+				Relation	rel;
+
+				if (state->nrows == 0)
+					continue;
+
+				/* Nothing to do if the table has been dropped meanwhile */
+				rel = try_relation_open(state->relid, NoLock);
+				if (rel == NULL)
+					continue;
+				if (rel->rd_locator.relNumber == state->relnumber)
+					ColumnarFlushWrite(state, rel);
+				relation_close(rel, NoLock);
+			}
+			break;
+
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+			/* the memory goes away with TopTransactionContext */
+			pendingWrites = NULL;
+			pendingWritesContext = NULL;
+			break;
+
+		case XACT_EVENT_PARALLEL_PRE_COMMIT:
+			break;
+	}
+}
+
+/*
+ * Forget the rows buffered by an aborted subtransaction or its children.
+ */
+static void
+columnar_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
+						  SubTransactionId parentSubid, void *arg)
+{
+	if (event != SUBXACT_EVENT_ABORT_SUB)
+		return;
+
+	for (ColumnarWriteState *state = pendingWrites; state != NULL;
+		 state = state->next)
+	{
+		if (state->nrows > 0 && state->subid >= mySubid)
+		{
+			MemoryContextReset(state->rowcontext);
+			state->nrows = 0;
+			state->nbytes = 0;
+			state->firstRowNumber = 0;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+CREATE EXTENSION columnar;
+
+-- small stripes and chunk groups, to have a few of them
+SET columnar.stripe_row_limit = 1000;
+SET columnar.chunk_group_row_limit = 100;
+
+CREATE TABLE col_test (id int, kind text, amount numeric, note text)
+  USING columnar;
+INSERT INTO col_test
+  SELECT i, 'kind' || (i % 5), i * 1.5,
+         CASE WHEN i % 7 = 0 THEN NULL ELSE repeat('x', i % 20) END
+  FROM generate_series(1, 2500) i;
+
+SELECT count(*), sum(id), count(note), sum(amount) FROM col_test;
+SELECT first_row_number, row_count, chunk_group_count,
+       stored_bytes <= raw_bytes AS compressed
+  FROM columnar_stripe_info('col_test');
+
+-- only the needed columns are read
+EXPLAIN (COSTS OFF) SELECT sum(amount) FROM col_test WHERE kind = 'kind1';
+SELECT sum(amount) FROM col_test WHERE kind = 'kind1';
+SELECT count(*) FROM col_test WHERE note IS NULL;
+
+-- chunk groups ruled out by their minimum and maximum are skipped
+EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF, BUFFERS OFF)
+SELECT count(*) FROM col_test WHERE id BETWEEN 150 AND 250;
+SELECT min(id), max(id), count(*) FROM col_test WHERE id BETWEEN 150 AND 250;
+
+SET columnar.enable_custom_scan = off;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM col_test;
+SELECT count(*) FROM col_test WHERE id BETWEEN 150 AND 250;
+RESET columnar.enable_custom_scan;
+
+-- insertions are visible to the transaction, and go away on rollback
+BEGIN;
+INSERT INTO col_test VALUES (3000, 'new', 1, 'a');
+SELECT count(*) FROM col_test;
+SAVEPOINT s;
+INSERT INTO col_test VALUES (3001, 'new', 1, 'b');
+ROLLBACK TO SAVEPOINT s;
+SELECT id FROM col_test WHERE kind = 'new';
+ROLLBACK;
+SELECT count(*) FROM col_test;
+
+-- unsupported operations
+DELETE FROM col_test WHERE id = 1;
+CREATE INDEX ON col_test (id);
+SELECT * FROM col_test TABLESAMPLE SYSTEM (10);
+
+VACUUM col_test;
+ANALYZE col_test;
+SELECT reltuples FROM pg_class WHERE relname = 'col_test';
+
+-- the aborted stripe goes away
+VACUUM FULL col_test;
+SELECT first_row_number, row_count, chunk_group_count
+  FROM columnar_stripe_info('col_test');
+SELECT count(*), sum(id) FROM col_test;
+
+-- columns added later read as their default
+ALTER TABLE col_test ADD COLUMN extra int DEFAULT 42;
+SET columnar.compression = none;
+INSERT INTO col_test (id, extra) VALUES (5000, 1);
+SELECT count(*), sum(extra) FROM col_test;
+SELECT id, kind, amount, note, extra FROM col_test WHERE id >= 2499;
+RESET columnar.compression;
+
+TRUNCATE col_test;
+SELECT count(*) FROM col_test;
+INSERT INTO col_test (id) VALUES (1);
+SELECT * FROM col_test;
+
+DROP TABLE col_test;
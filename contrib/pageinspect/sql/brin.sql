@@ -142,3 +142,45 @@ DROP TABLE brin_parallel_test;
 RESET min_parallel_table_scan_size;
 RESET max_parallel_maintenance_workers;
 RESET maintenance_work_mem;
+
+-- ranges whose values are covered by the summary of the preceding range are
+-- merged into it, except for the last range of the table
+CREATE TABLE test3 (a int) WITH (autovacuum_enabled = false);
+INSERT INTO test3 SELECT 1 FROM generate_series(1, 5000);
+CREATE INDEX test3_a_idx ON test3 USING brin (a)
+  WITH (pages_per_range = 1, max_pages_per_range = 4);
+ANALYZE test3;
+
+CREATE TEMP VIEW test3_ranges AS
+SELECT count(*) FILTER (WHERE pages::text LIKE '(0,%') AS merged,
+       count(*) FILTER (WHERE pages::text NOT LIKE '(0,%') AS own
+  FROM brin_revmap_data(get_raw_page('test3_a_idx', 1))
+ WHERE pages <> '(0,0)';
+
+SELECT own = (relpages - 2) / 4 + 2 AS merged_by_four,
+       merged + own = relpages AS all_summarized
+  FROM test3_ranges, pg_class WHERE relname = 'test3';
+
+SELECT * FROM brin_revmap_data(get_raw_page('test3_a_idx', 1)) LIMIT 5;
+
+-- desummarizing a merged range leaves the range it was merged into alone
+SELECT brin_desummarize_range('test3_a_idx', 1);
+SELECT * FROM brin_revmap_data(get_raw_page('test3_a_idx', 1)) LIMIT 5;
+SELECT brin_summarize_range('test3_a_idx', 1);
+SELECT * FROM brin_revmap_data(get_raw_page('test3_a_idx', 1)) LIMIT 5;
+
+-- desummarizing the first range of a merged range splits it
+SELECT brin_desummarize_range('test3_a_idx', 0);
+SELECT * FROM brin_revmap_data(get_raw_page('test3_a_idx', 1)) LIMIT 5;
+SELECT brin_summarize_new_values('test3_a_idx');
+
+SELECT own = (relpages - 2) / 4 + 2 AS merged_by_four,
+       merged + own = relpages AS all_summarized
+  FROM test3_ranges, pg_class WHERE relname = 'test3';
+
+SET enable_seqscan = off;
+SELECT count(*) FROM test3 WHERE a = 1;
+SELECT count(*) FROM test3 WHERE a = 2;
+RESET enable_seqscan;
+
+DROP TABLE test3;
@@ -0,0 +1,28 @@
+/* contrib/pg_buffercache/pg_buffercache--1.7--1.8.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_buffercache UPDATE TO '1.8'" to load this file. \quit
+
+-- Function to describe the clock-sweep partitions of shared buffers.
+CREATE FUNCTION pg_buffercache_partitions(
+    OUT partition int4,
+    OUT numa_node int4,
+    OUT first_buffer int4,
+    OUT last_buffer int4,
+    OUT num_buffers int4,
+    OUT complete_passes int8,
+    OUT buffer_allocs int8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'pg_buffercache_partitions'
+LANGUAGE C PARALLEL SAFE;
+
+-- Don't want these to be available to public.
+REVOKE ALL ON FUNCTION pg_buffercache_partitions() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_buffercache_partitions() TO pg_monitor;
+
+-- Upgrade view to 1.8. format
+CREATE OR REPLACE VIEW pg_buffercache AS
+	SELECT P.* FROM pg_buffercache_pages() AS P
+	(bufferid integer, relfilenode oid, reltablespace oid, reldatabase oid,
+	 relforknumber int2, relblocknumber int8, isdirty bool, usagecount int2,
+	 pinning_backends int4, numa_node int4);
@@ -20,9 +20,10 @@
 
 
 #define NUM_BUFFERCACHE_PAGES_MIN_ELEM	8
-#define NUM_BUFFERCACHE_PAGES_ELEM	9
+#define NUM_BUFFERCACHE_PAGES_ELEM	10
 #define NUM_BUFFERCACHE_SUMMARY_ELEM 5
 #define NUM_BUFFERCACHE_USAGE_COUNTS_ELEM 4
+#define NUM_BUFFERCACHE_PARTITIONS_ELEM 7
 #define NUM_BUFFERCACHE_EVICT_ELEM 2
 #define NUM_BUFFERCACHE_EVICT_RELATION_ELEM 3
 #define NUM_BUFFERCACHE_EVICT_ALL_ELEM 3
@@ -71,6 +72,7 @@ PG_FUNCTION_INFO_V1(pg_buffercache_os_pages);
 PG_FUNCTION_INFO_V1(pg_buffercache_numa_pages);
 PG_FUNCTION_INFO_V1(pg_buffercache_summary);
 PG_FUNCTION_INFO_V1(pg_buffercache_usage_counts);
+PG_FUNCTION_INFO_V1(pg_buffercache_partitions);
 PG_FUNCTION_INFO_V1(pg_buffercache_evict);
 PG_FUNCTION_INFO_V1(pg_buffercache_evict_relation);
 PG_FUNCTION_INFO_V1(pg_buffercache_evict_all);
@@ -93,12 +95,12 @@ pg_buffercache_pages(PG_FUNCTION_ARGS)
 	int			i;
 
 	/*
-	 * To smoothly support upgrades from version 1.0 of this extension
-	 * transparently handle the (non-)existence of the pinning_backends
-	 * column. We unfortunately have to get the result type for that... - we
-	 * can't use the result type determined by the function definition without
-	 * potentially crashing when somebody uses the old (or even wrong)
-	 * function definition though.
+	 * To smoothly support upgrades from older versions of this extension
+	 * transparently handle the (non-)existence of the pinning_backends column
+	 * added in 1.1 and of the numa_node column added in 1.8. We unfortunately
+	 * have to get the result type for that... - we can't use the result type
+	 * determined by the function definition without potentially crashing
+	 * when somebody uses the old (or even wrong) function definition though.
 	 */
 	if (get_call_result_type(fcinfo, NULL, &expected_tupledesc) != TYPEFUNC_COMPOSITE)
 		elog(ERROR, "return type must be a row type");
@@ -146,6 +148,7 @@ pg_buffercache_pages(PG_FUNCTION_ARGS)
 		bool		isdirty;
 		uint16		usagecount;
 		int32		pinning_backends;
+		int			numa_node;
 		Datum		values[NUM_BUFFERCACHE_PAGES_ELEM];
 		bool		nulls[NUM_BUFFERCACHE_PAGES_ELEM];
 
@@ -177,13 +180,23 @@ pg_buffercache_pages(PG_FUNCTION_ARGS)
 
 		UnlockBufHdr(bufHdr);
 
+		numa_node = BufferGetNumaNode(i);
+
 		/* Build the tuple and add it to tuplestore */
 		values[0] = Int32GetDatum(bufferid);
 		nulls[0] = false;
 
 		/*
-		 * Set all fields except the bufferid to null if the buffer is unused
-		 * or not valid.
+		 * The NUMA node is a property of the buffer itself, known only if
+		 * shared buffers are partitioned over NUMA nodes.  Unused for callers
+		 * before 1.8, but the array is always long enough.
+		 */
+		values[9] = Int32GetDatum(numa_node);
+		nulls[9] = (numa_node < 0);
+
+		/*
+		 * Set all other fields except the bufferid to null if the buffer is
+		 * unused or not valid.
 		 */
 		if (blocknum == InvalidBlockNumber || isvalid == false)
 		{
@@ -247,9 +260,12 @@ build_buffercache_pages_tupledesc(int natts)
 	TupleDescInitEntry(tupledesc, (AttrNumber) 8, "usagecount",
 					   INT2OID, -1, 0);
 
-	if (natts == NUM_BUFFERCACHE_PAGES_ELEM)
+	if (natts > NUM_BUFFERCACHE_PAGES_MIN_ELEM)
 		TupleDescInitEntry(tupledesc, (AttrNumber) 9, "pinning_backends",
 						   INT4OID, -1, 0);
+	if (natts == NUM_BUFFERCACHE_PAGES_ELEM)
+		TupleDescInitEntry(tupledesc, (AttrNumber) 10, "numa_node",
+						   INT4OID, -1, 0);
 
 	TupleDescFinalize(tupledesc);
 
@@ -678,6 +694,50 @@ pg_buffercache_usage_counts(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Describe the clock-sweep partitions of shared buffers.
+ */
+Datum
+pg_buffercache_partitions(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	Datum		values[NUM_BUFFERCACHE_PARTITIONS_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_PARTITIONS_ELEM] = {0};
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	for (int i = 0; i < StrategyNumPartitions(); i++)
+	{
+		int			first_buffer;
+		int			num_buffers;
+		int			numa_node;
+		uint32		complete_passes;
+		uint64		num_buf_alloc;
+
+		StrategyGetPartitionInfo(i, &first_buffer, &num_buffers, &numa_node,
+								 &complete_passes, &num_buf_alloc);
+
+		values[0] = Int32GetDatum(i);
+		if (numa_node >= 0)
+		{
+			values[1] = Int32GetDatum(numa_node);
+			nulls[1] = false;
+		}
+		else
+			nulls[1] = true;
+		/* buffer IDs are 1-based, like in pg_buffercache */
+		values[2] = Int32GetDatum(first_buffer + 1);
+		values[3] = Int32GetDatum(first_buffer + num_buffers);
+		values[4] = Int32GetDatum(num_buffers);
+		values[5] = Int64GetDatum((int64) complete_passes);
+		values[6] = Int64GetDatum((int64) num_buf_alloc);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
 /*
  * Helper function to check if the user has superuser privileges.
  */
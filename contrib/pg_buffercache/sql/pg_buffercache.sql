@@ -18,6 +18,17 @@ from pg_buffercache_summary();
 
 SELECT count(*) > 0 FROM pg_buffercache_usage_counts() WHERE buffers >= 0;
 
+-- The clock-sweep partitions cover all of shared buffers
+SELECT count(*) > 0, sum(num_buffers) = (SELECT setting::bigint
+                                         FROM pg_settings
+                                         WHERE name = 'shared_buffers'),
+       min(first_buffer) = 1, bool_and(last_buffer - first_buffer + 1 = num_buffers)
+FROM pg_buffercache_partitions();
+
+-- Buffers are only placed on NUMA nodes with shared_memory_numa = partition
+SELECT count(*) = 0 FROM pg_buffercache
+WHERE numa_node IS NOT NULL AND current_setting('shared_memory_numa') <> 'partition';
+
 -- Check that the functions / views can't be accessed by default. To avoid
 -- having to create a dedicated user, use the pg_database_owner pseudo-role.
 SET ROLE pg_database_owner;
@@ -26,6 +37,7 @@ SELECT * FROM pg_buffercache_os_pages;
 SELECT * FROM pg_buffercache_pages() AS p (wrong int);
 SELECT * FROM pg_buffercache_summary();
 SELECT * FROM pg_buffercache_usage_counts();
+SELECT * FROM pg_buffercache_partitions();
 RESET role;
 
 -- Check that pg_monitor is allowed to query view / function
@@ -34,6 +46,7 @@ SELECT count(*) > 0 FROM pg_buffercache;
 SELECT count(*) > 0 FROM pg_buffercache_os_pages;
 SELECT buffers_used + buffers_unused > 0 FROM pg_buffercache_summary();
 SELECT count(*) > 0 FROM pg_buffercache_usage_counts();
+SELECT count(*) > 0 FROM pg_buffercache_partitions();
 SELECT *
 FROM pg_buffercache_pages() AS p
 	(bufferid integer, relfilenode oid, reltablespace oid, reldatabase oid,
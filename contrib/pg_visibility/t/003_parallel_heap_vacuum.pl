@@ -0,0 +1,120 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Check that VACUUM (PARALLEL_HEAP) removes all dead tuples and leaves the
+# visibility map and the free space map as a serial VACUUM does, including
+# when the dead tuples don't fit in memory at once.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+# Anything holding a snapshot, including auto-analyze of pg_proc, could stop
+# VACUUM from updating the visibility map.
+$node->append_conf(
+	'postgresql.conf', q[
+autovacuum = off
+max_parallel_maintenance_workers = 4
+]);
+$node->start;
+
+$node->safe_psql(
+	'postgres', q[
+	CREATE EXTENSION pg_visibility;
+	CREATE EXTENSION pg_freespacemap;
+	CREATE EXTENSION pageinspect;]);
+
+foreach my $with_index (1, 0)
+{
+	my $desc = $with_index ? 'with index' : 'without index';
+
+	# Two identical tables of about 64MB, which is enough for two workers
+	# with the default min_parallel_table_scan_size.
+	foreach my $table ('serial', 'parallel')
+	{
+		$node->safe_psql(
+			'postgres', qq[
+			CREATE TABLE $table (id int, filler text)
+			  WITH (autovacuum_enabled = off);
+			INSERT INTO $table
+			  SELECT g, repeat('x', 100) FROM generate_series(1, 480000) g;
+			DELETE FROM $table WHERE id % 3 = 0;]);
+		$node->safe_psql('postgres', "CREATE INDEX ON $table (id)")
+		  if $with_index;
+	}
+
+	cmp_ok(
+		$node->safe_psql(
+			'postgres', q[SELECT pg_relation_size('parallel') / 1024 / 1024]),
+		'>=', 60, "table is large enough $desc");
+
+	$node->safe_psql('postgres', 'VACUUM (PARALLEL 0) serial');
+
+	# Small enough memory for the dead tuples to need several rounds of
+	# index and heap vacuuming.
+	my ($ret, $stdout, $stderr) = $node->psql(
+		'postgres', q[
+		SET maintenance_work_mem = '64kB';
+		VACUUM (VERBOSE, PARALLEL 2, PARALLEL_HEAP) parallel;]);
+	is($ret, 0, "parallel heap vacuum succeeded $desc");
+	like(
+		$stderr,
+		qr/launched [1-9]\d* parallel vacuum workers? for table processing/,
+		"workers processed the heap $desc");
+	like($stderr, qr/index scans: (?:[2-9]|\d{2,})/,
+		"heap was processed in several rounds $desc")
+	  if $with_index;
+
+	# Every deleted tuple is gone, and no dead line pointers are left.
+	is( $node->safe_psql(
+			'postgres', q[
+			SELECT count(*) FILTER (WHERE lp_flags = 1),
+			       count(*) FILTER (WHERE lp_flags <> 1 AND lp_flags <> 0)
+			FROM generate_series(0, pg_relation_size('parallel') /
+			                        current_setting('block_size')::int - 1) blk,
+			     heap_page_items(get_raw_page('parallel', blk::int))]),
+		'320000|0',
+		"dead tuples were removed $desc");
+
+	# The visibility map is correct and all pages are all-visible.
+	is( $node->safe_psql(
+			'postgres', q[
+			SELECT (SELECT count(*) FROM pg_check_visible('parallel')),
+			       (SELECT count(*) FROM pg_visibility_map('parallel')
+			        WHERE NOT all_visible)]),
+		'0|0',
+		"visibility map is correct $desc");
+	is( $node->safe_psql(
+			'postgres', q[
+			SELECT count(*)
+			FROM pg_visibility_map('serial') s
+			  FULL JOIN pg_visibility_map('parallel') p USING (blkno)
+			WHERE s IS DISTINCT FROM p]),
+		'0',
+		"visibility map matches the one of a serial vacuum $desc");
+
+	# The free space map records the free space of every page as a serial
+	# vacuum does, and searches find it.
+	is( $node->safe_psql(
+			'postgres', q[
+			SELECT count(*)
+			FROM pg_freespace('serial') s
+			  FULL JOIN pg_freespace('parallel') p USING (blkno)
+			WHERE s.avail IS DISTINCT FROM p.avail OR p.avail = 0]),
+		'0',
+		"free space map matches the one of a serial vacuum $desc");
+	my $size =
+	  $node->safe_psql('postgres', q[SELECT pg_relation_size('parallel')]);
+	$node->safe_psql('postgres',
+		q[INSERT INTO parallel SELECT 0, 'new' FROM generate_series(1, 1000)]);
+	is($node->safe_psql('postgres', q[SELECT pg_relation_size('parallel')]),
+		$size, "free space map leads to existing pages $desc");
+
+	$node->safe_psql('postgres', 'DROP TABLE serial, parallel');
+}
+
+$node->stop;
+
+done_testing();
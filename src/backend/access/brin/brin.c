@@ -221,6 +221,7 @@ static void terminate_brin_buildstate(BrinBuildState *state);
 static void brinsummarize(Relation index, Relation heapRel, BlockNumber pageRange,
 						  bool include_partial, double *numSummarized, double *numExisting);
 static void form_and_insert_tuple(BrinBuildState *state);
+static void brin_merge_range(BrinBuildState *state, BlockNumber heapBlk);
 static void form_and_spill_tuple(BrinBuildState *state);
 static void union_tuples(BrinDesc *bdesc, BrinMemTuple *a,
 						 BrinTuple *b);
@@ -298,6 +299,7 @@ brinhandler(PG_FUNCTION_ARGS)
 		.ambeginscan = brinbeginscan,
 		.amrescan = brinrescan,
 		.amgettuple = NULL,
+		.amgetbatch = NULL,
 		.amgetbitmap = bringetbitmap,
 		.amendscan = brinendscan,
 		.ammarkpos = NULL,
@@ -355,6 +357,7 @@ brininsert(Relation idxRel, Datum *values, bool *nulls,
 	BlockNumber pagesPerRange;
 	BlockNumber origHeapBlk;
 	BlockNumber heapBlk;
+	BlockNumber tupBlk;
 	BrinInsertState *bistate = (BrinInsertState *) indexInfo->ii_AmCache;
 	BrinRevmap *revmap;
 	BrinDesc   *bdesc;
@@ -469,13 +472,19 @@ brininsert(Relation idxRel, Datum *values, bool *nulls,
 			origsz = ItemIdGetLength(lp);
 			origtup = brin_copy_tuple(brtup, origsz, NULL, NULL);
 
+			/*
+			 * If the range was merged into a preceding one, it's the summary
+			 * tuple of the latter that we update.
+			 */
+			tupBlk = brtup->bt_blkno;
+
 			/*
 			 * Before releasing the lock, check if we can attempt a same-page
 			 * update.  Another process could insert a tuple concurrently in
 			 * the same page though, so downstream we must be prepared to cope
 			 * if this turns out to not be possible after all.
 			 */
-			newtup = brin_form_tuple(bdesc, heapBlk, dtup, &newsz);
+			newtup = brin_form_tuple(bdesc, tupBlk, dtup, &newsz);
 			samepage = brin_can_do_samepage_update(buf, origsz, newsz);
 			LockBuffer(buf, BUFFER_LOCK_UNLOCK);
 
@@ -487,7 +496,7 @@ brininsert(Relation idxRel, Datum *values, bool *nulls,
 			 * inserter's are covered by the combined tuple.  It might be that
 			 * we don't need to update at all.
 			 */
-			if (!brin_doupdate(idxRel, pagesPerRange, revmap, heapBlk,
+			if (!brin_doupdate(idxRel, pagesPerRange, revmap, tupBlk,
 							   buf, off, origtup, origsz, newtup, newsz,
 							   samepage))
 			{
@@ -585,6 +594,8 @@ bringetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 	BrinMemTuple *dtup;
 	BrinTuple  *btup = NULL;
 	Size		btupsz = 0;
+	BlockNumber prevTupBlk = InvalidBlockNumber;
+	bool		prevaddrange = false;
 	ScanKey   **keys,
 			  **nullkeys;
 	int		   *nkeys,
@@ -771,6 +782,14 @@ bringetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 		{
 			addrange = true;
 		}
+		else if (btup->bt_blkno != heapBlk && btup->bt_blkno == prevTupBlk)
+		{
+			/*
+			 * The range was merged into the preceding one, whose summary
+			 * tuple we have just compared to the scan keys.
+			 */
+			addrange = prevaddrange;
+		}
 		else
 		{
 			dtup = brin_deform_tuple(bdesc, btup, dtup);
@@ -926,6 +945,12 @@ bringetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 			}
 		}
 
+		if (gottuple)
+		{
+			prevTupBlk = btup->bt_blkno;
+			prevaddrange = addrange;
+		}
+
 		/* add the pages in the range to the output bitmap, if needed */
 		if (addrange)
 		{
@@ -1259,6 +1284,18 @@ brinbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 							   state->bs_maxRangeStart);
 	}
 
+	/*
+	 * Merge the ranges that the max_pages_per_range option allows to, except
+	 * for the last range of the table, where new values usually go.
+	 */
+	if (BrinGetMaxPagesPerRange(index) > pagesPerRange)
+	{
+		for (BlockNumber heapBlk = pagesPerRange;
+			 heapBlk + pagesPerRange < state->bs_maxRangeStart;
+			 heapBlk += pagesPerRange)
+			brin_merge_range(state, heapBlk);
+	}
+
 	/* release resources */
 	idxtuples = state->bs_numtuples;
 	brinRevmapTerminate(state->bs_rmAccess);
@@ -1354,7 +1391,8 @@ brinoptions(Datum reloptions, bool validate)
 {
 	static const relopt_parse_elt tab[] = {
 		{"pages_per_range", RELOPT_TYPE_INT, offsetof(BrinOptions, pagesPerRange)},
-		{"autosummarize", RELOPT_TYPE_BOOL, offsetof(BrinOptions, autosummarize)}
+		{"autosummarize", RELOPT_TYPE_BOOL, offsetof(BrinOptions, autosummarize)},
+		{"max_pages_per_range", RELOPT_TYPE_INT, offsetof(BrinOptions, maxPagesPerRange)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate,
@@ -1892,6 +1930,7 @@ brinsummarize(Relation index, Relation heapRel, BlockNumber pageRange,
 	BrinRevmap *revmap;
 	BrinBuildState *state = NULL;
 	IndexInfo  *indexInfo = NULL;
+	BlockNumber tableNumBlocks;
 	BlockNumber heapNumBlocks;
 	BlockNumber pagesPerRange;
 	Buffer		buf;
@@ -1900,7 +1939,8 @@ brinsummarize(Relation index, Relation heapRel, BlockNumber pageRange,
 	revmap = brinRevmapInitialize(index, &pagesPerRange);
 
 	/* determine range of pages to process */
-	heapNumBlocks = RelationGetNumberOfBlocks(heapRel);
+	tableNumBlocks = RelationGetNumberOfBlocks(heapRel);
+	heapNumBlocks = tableNumBlocks;
 	if (pageRange == BRIN_ALL_BLOCKRANGES)
 		startBlk = 0;
 	else
@@ -1953,6 +1993,13 @@ brinsummarize(Relation index, Relation heapRel, BlockNumber pageRange,
 			}
 			summarize_range(indexInfo, state, heapRel, startBlk, heapNumBlocks);
 
+			/*
+			 * Merge the range into the preceding one if possible, unless it's
+			 * the last range of the table, where new values usually go.
+			 */
+			if ((uint64) startBlk + pagesPerRange < tableNumBlocks)
+				brin_merge_range(state, startBlk);
+
 			/* and re-initialize state for the next range */
 			brin_memtuple_initialize(state->bs_dtuple, state->bs_bdesc);
 
@@ -1999,6 +2046,105 @@ form_and_insert_tuple(BrinBuildState *state)
 	pfree(tup);
 }
 
+/*
+ * Merge the page range starting at heapBlk into the range preceding it, if
+ * the summary tuple of the latter already covers the values of the former,
+ * and the max_pages_per_range option of the index allows it.
+ *
+ * With this, pages_per_range sets the smallest range that a summary tuple
+ * describes.  Where values are spread the same over consecutive ranges, as
+ * happens when they are not correlated with the physical order of the table,
+ * the ranges share one summary tuple, which saves index space and scan
+ * effort while matching the same queries.  Where the spread of values
+ * narrows, as it does on tables loaded in order, ranges stay apart and keep
+ * summaries precise.  Inserting values that don't fit the summary of a
+ * merged range widens it for all of the merged range; desummarizing the
+ * first range of a merged range splits it, and the next summarization
+ * merges only the ranges that still fit.
+ */
+static void
+brin_merge_range(BrinBuildState *state, BlockNumber heapBlk)
+{
+	BlockNumber pagesPerRange = state->bs_pagesPerRange;
+	int			maxPagesPerRange = BrinGetMaxPagesPerRange(state->bs_irel);
+	BrinRevmap *revmap = state->bs_rmAccess;
+	Buffer		buf = InvalidBuffer;
+	BrinTuple  *tup;
+	BrinTuple  *headtup = NULL;
+	BrinTuple  *uniontup;
+	Size		tupsz;
+	Size		headsz;
+	Size		unionsz;
+	OffsetNumber off;
+	BlockNumber headBlk = InvalidBlockNumber;
+	BrinMemTuple *dtup;
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+
+	Assert(heapBlk % pagesPerRange == 0);
+
+	if (heapBlk == 0 || maxPagesPerRange < 2 * (int64) pagesPerRange)
+		return;
+
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"brin merge",
+								ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	/*
+	 * Get the summary tuple of the preceding range, which may be that of a
+	 * range it was merged into already.
+	 */
+	tup = brinGetTupleForHeapBlock(revmap, heapBlk - pagesPerRange, &buf,
+								   &off, &headsz, BUFFER_LOCK_SHARE);
+	if (tup != NULL)
+	{
+		headBlk = tup->bt_blkno;
+		if (!BrinTupleIsPlaceholder(tup) &&
+			(int64) heapBlk + pagesPerRange - headBlk <= maxPagesPerRange &&
+			brinRevmapCanMergeRanges(revmap, heapBlk, headBlk))
+			headtup = brin_copy_tuple(tup, headsz, NULL, NULL);
+		LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+	}
+
+	/* and the summary tuple of the range itself, if it has its own */
+	if (headtup != NULL)
+	{
+		tup = brinGetTupleForHeapBlock(revmap, heapBlk, &buf, &off, &tupsz,
+									   BUFFER_LOCK_SHARE);
+		if (tup != NULL)
+		{
+			if (tup->bt_blkno == heapBlk && !BrinTupleIsPlaceholder(tup))
+				tup = brin_copy_tuple(tup, tupsz, NULL, NULL);
+			else
+				headtup = NULL;
+			LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+		}
+		else
+			headtup = NULL;
+	}
+
+	if (BufferIsValid(buf))
+		ReleaseBuffer(buf);
+
+	/*
+	 * The range can be merged if adding its summary to that of the preceding
+	 * range leaves the latter unchanged.
+	 */
+	if (headtup != NULL)
+	{
+		dtup = brin_deform_tuple(state->bs_bdesc, headtup, NULL);
+		union_tuples(state->bs_bdesc, dtup, tup);
+		uniontup = brin_form_tuple(state->bs_bdesc, headBlk, dtup, &unionsz);
+
+		if (brin_tuples_equal(uniontup, unionsz, headtup, headsz))
+			(void) brinRevmapMergeRange(revmap, heapBlk, headBlk, tup, tupsz);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(cxt);
+}
+
 /*
  * Given a deformed tuple in the build state, convert it into the on-disk
  * format and write it to a (shared) tuplesort (the leader will insert it
@@ -8,6 +8,9 @@
  * previously recorded summary values, a new tuple is inserted into the index
  * and the revmap is updated to point to it.
  *
+ * Several consecutive page ranges can share one summary tuple, when ranges
+ * are merged into the range preceding them; see RevmapItemIsMerged.
+ *
  * The revmap is stored in the first pages of the index, immediately following
  * the metapage.  When the revmap needs to be expanded, all tuples on the
  * regular BRIN page at that block (if any) are moved out of the way.
@@ -188,7 +191,9 @@ brinSetHeapBlockItemptr(Buffer buf, BlockNumber pagesPerRange,
  * not locked.
  *
  * The output tuple offset within the buffer is returned in *off, and its size
- * is returned in *size.
+ * is returned in *size.  If the range was merged into a preceding one, the
+ * tuple returned is the summary tuple of the merged range, whose bt_blkno is
+ * that of its first range.
  */
 BrinTuple *
 brinGetTupleForHeapBlock(BrinRevmap *revmap, BlockNumber heapBlk,
@@ -202,6 +207,7 @@ brinGetTupleForHeapBlock(BrinRevmap *revmap, BlockNumber heapBlk,
 	Page		page;
 	ItemId		lp;
 	BrinTuple  *tup;
+	BlockNumber tupBlk;
 	ItemPointerData previptr;
 
 	/* normalize the heap block number to be the first page in the range */
@@ -240,6 +246,26 @@ brinGetTupleForHeapBlock(BrinRevmap *revmap, BlockNumber heapBlk,
 			PageGetContents(BufferGetPage(revmap->rm_currBuf));
 		iptr = contents->rm_tids;
 		iptr += HEAPBLK_TO_REVMAP_INDEX(revmap->rm_pagesPerRange, heapBlk);
+		tupBlk = heapBlk;
+
+		/*
+		 * If the range was merged into a preceding one, the summary tuple is
+		 * the one of the first range of the merged range.
+		 */
+		if (RevmapItemIsMerged(iptr))
+		{
+			OffsetNumber distance = RevmapItemGetMergedDistance(iptr);
+
+			if (distance > HEAPBLK_TO_REVMAP_INDEX(revmap->rm_pagesPerRange,
+												   heapBlk) ||
+				RevmapItemIsMerged(iptr - distance))
+				ereport(ERROR,
+						(errcode(ERRCODE_INDEX_CORRUPTED),
+						 errmsg_internal("corrupted BRIN index: inconsistent range map")));
+
+			iptr -= distance;
+			tupBlk = heapBlk - distance * revmap->rm_pagesPerRange;
+		}
 
 		if (!ItemPointerIsValid(iptr))
 		{
@@ -293,7 +319,7 @@ brinGetTupleForHeapBlock(BrinRevmap *revmap, BlockNumber heapBlk,
 			{
 				tup = (BrinTuple *) PageGetItem(page, lp);
 
-				if (tup->bt_blkno == heapBlk)
+				if (tup->bt_blkno == tupBlk)
 				{
 					if (size)
 						*size = ItemIdGetLength(lp);
@@ -312,9 +338,40 @@ brinGetTupleForHeapBlock(BrinRevmap *revmap, BlockNumber heapBlk,
 	return NULL;
 }
 
+/*
+ * In the given revmap buffer (locked appropriately by caller), which is used
+ * in a BRIN index of pagesPerRange pages per range, mark as unsummarized the
+ * ranges that were merged into the range starting at heapBlk.
+ *
+ * This is used both in regular operation and during WAL replay.
+ */
+void
+brinRevmapDetachMergedRanges(Buffer buf, BlockNumber pagesPerRange,
+							 BlockNumber heapBlk)
+{
+	RevmapContents *contents;
+	int			idx;
+
+	contents = (RevmapContents *) PageGetContents(BufferGetPage(buf));
+	idx = HEAPBLK_TO_REVMAP_INDEX(pagesPerRange, heapBlk);
+
+	for (int i = idx + 1; i < REVMAP_PAGE_MAXITEMS; i++)
+	{
+		ItemPointerData *iptr = &contents->rm_tids[i];
+
+		if (RevmapItemIsMerged(iptr) &&
+			i - RevmapItemGetMergedDistance(iptr) == idx)
+			ItemPointerSetInvalid(iptr);
+	}
+}
+
 /*
  * Delete an index tuple, marking a page range as unsummarized.
  *
+ * If other ranges were merged into the range, they become unsummarized too.
+ * If the range was itself merged into a preceding one, only it is detached
+ * from that range, whose summary tuple is kept.
+ *
  * Index must be locked in ShareUpdateExclusiveLock mode.
  *
  * Return false if caller should retry.
@@ -363,6 +420,42 @@ brinRevmapDesummarizeRange(Relation idxrel, BlockNumber heapBlk)
 		return true;
 	}
 
+	if (RevmapItemIsMerged(iptr))
+	{
+		/*
+		 * The range has no index tuple of its own; the summary tuple of the
+		 * range it was merged into keeps covering it, which is harmless.
+		 */
+		START_CRIT_SECTION();
+
+		ItemPointerSetInvalid(&invalidIptr);
+		brinSetHeapBlockItemptr(revmapBuf, revmap->rm_pagesPerRange, heapBlk,
+								invalidIptr);
+		MarkBufferDirty(revmapBuf);
+
+		if (RelationNeedsWAL(idxrel))
+		{
+			xl_brin_desummarize xlrec;
+			XLogRecPtr	recptr;
+
+			xlrec.pagesPerRange = revmap->rm_pagesPerRange;
+			xlrec.heapBlk = heapBlk;
+			xlrec.regOffset = InvalidOffsetNumber;
+
+			XLogBeginInsert();
+			XLogRegisterData(&xlrec, SizeOfBrinDesummarize);
+			XLogRegisterBuffer(0, revmapBuf, 0);
+			recptr = XLogInsert(RM_BRIN_ID, XLOG_BRIN_DESUMMARIZE);
+			PageSetLSN(revmapPg, recptr);
+		}
+
+		END_CRIT_SECTION();
+
+		LockBuffer(revmapBuf, BUFFER_LOCK_UNLOCK);
+		brinRevmapTerminate(revmap);
+		return true;
+	}
+
 	regBuf = ReadBuffer(idxrel, ItemPointerGetBlockNumber(iptr));
 	LockBuffer(regBuf, BUFFER_LOCK_EXCLUSIVE);
 	regPg = BufferGetPage(regBuf);
@@ -400,6 +493,7 @@ brinRevmapDesummarizeRange(Relation idxrel, BlockNumber heapBlk)
 	ItemPointerSetInvalid(&invalidIptr);
 	brinSetHeapBlockItemptr(revmapBuf, revmap->rm_pagesPerRange, heapBlk,
 							invalidIptr);
+	brinRevmapDetachMergedRanges(revmapBuf, revmap->rm_pagesPerRange, heapBlk);
 	PageIndexTupleDeleteNoCompact(regPg, regOffset);
 	/* XXX record free space in FSM? */
 
@@ -433,6 +527,126 @@ brinRevmapDesummarizeRange(Relation idxrel, BlockNumber heapBlk)
 	return true;
 }
 
+/*
+ * Merge the page range starting at heapBlk into the range starting at
+ * headBlk, whose summary tuple must already cover the values of the former:
+ * the revmap item of heapBlk is made to refer to the item of headBlk, and the
+ * summary tuple of heapBlk, which caller read as origtup, is deleted.
+ *
+ * headBlk must be the first range of the merged range that heapBlk joins,
+ * and both must be covered by the same revmap page; see
+ * brinRevmapCanMergeRanges.  Index must be locked in ShareUpdateExclusiveLock
+ * mode.
+ *
+ * Return false if either range was modified after caller read it, in which
+ * case nothing is done.
+ */
+bool
+brinRevmapMergeRange(BrinRevmap *revmap, BlockNumber heapBlk,
+					 BlockNumber headBlk, BrinTuple *origtup, Size origsz)
+{
+	Relation	idxrel = revmap->rm_irel;
+	BlockNumber pagesPerRange = revmap->rm_pagesPerRange;
+	RevmapContents *contents;
+	ItemPointerData *iptr;
+	ItemPointerData *headIptr;
+	ItemPointerData mergedIptr;
+	OffsetNumber distance;
+	Buffer		revmapBuf;
+	Buffer		regBuf;
+	Page		revmapPg;
+	Page		regPg;
+	OffsetNumber regOffset;
+	ItemId		lp;
+
+	Assert(headBlk < heapBlk);
+	Assert(brinRevmapCanMergeRanges(revmap, heapBlk, headBlk));
+
+	distance = (heapBlk - headBlk) / pagesPerRange;
+
+	revmapBuf = brinLockRevmapPageForUpdate(revmap, heapBlk);
+	revmapPg = BufferGetPage(revmapBuf);
+	contents = (RevmapContents *) PageGetContents(revmapPg);
+	iptr = contents->rm_tids + HEAPBLK_TO_REVMAP_INDEX(pagesPerRange, heapBlk);
+	headIptr = iptr - distance;
+
+	/* both ranges must still be summarized by tuples of their own */
+	if (!ItemPointerIsValid(iptr) || RevmapItemIsMerged(iptr) ||
+		!ItemPointerIsValid(headIptr) || RevmapItemIsMerged(headIptr))
+	{
+		LockBuffer(revmapBuf, BUFFER_LOCK_UNLOCK);
+		return false;
+	}
+
+	regBuf = ReadBuffer(idxrel, ItemPointerGetBlockNumber(iptr));
+	LockBuffer(regBuf, BUFFER_LOCK_EXCLUSIVE);
+	regPg = BufferGetPage(regBuf);
+	regOffset = ItemPointerGetOffsetNumber(iptr);
+
+	/*
+	 * Values inserted in the range after caller read its tuple might not be
+	 * covered by the summary tuple of headBlk; give up if there were any.
+	 */
+	if (!BRIN_IS_REGULAR_PAGE(regPg) ||
+		regOffset > PageGetMaxOffsetNumber(regPg) ||
+		!ItemIdIsNormal(lp = PageGetItemId(regPg, regOffset)) ||
+		!brin_tuples_equal((BrinTuple *) PageGetItem(regPg, lp),
+						   ItemIdGetLength(lp), origtup, origsz))
+	{
+		LockBuffer(revmapBuf, BUFFER_LOCK_UNLOCK);
+		UnlockReleaseBuffer(regBuf);
+		return false;
+	}
+
+	ItemPointerSet(&mergedIptr, BRIN_METAPAGE_BLKNO, distance);
+
+	START_CRIT_SECTION();
+
+	brinSetHeapBlockItemptr(revmapBuf, pagesPerRange, heapBlk, mergedIptr);
+	PageIndexTupleDeleteNoCompact(regPg, regOffset);
+
+	MarkBufferDirty(regBuf);
+	MarkBufferDirty(revmapBuf);
+
+	if (RelationNeedsWAL(idxrel))
+	{
+		xl_brin_merge xlrec;
+		XLogRecPtr	recptr;
+
+		xlrec.pagesPerRange = pagesPerRange;
+		xlrec.heapBlk = heapBlk;
+		xlrec.headBlk = headBlk;
+		xlrec.regOffset = regOffset;
+
+		XLogBeginInsert();
+		XLogRegisterData(&xlrec, SizeOfBrinMerge);
+		XLogRegisterBuffer(0, revmapBuf, 0);
+		XLogRegisterBuffer(1, regBuf, REGBUF_STANDARD);
+		recptr = XLogInsert(RM_BRIN_ID, XLOG_BRIN_MERGE);
+		PageSetLSN(revmapPg, recptr);
+		PageSetLSN(regPg, recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(regBuf);
+	LockBuffer(revmapBuf, BUFFER_LOCK_UNLOCK);
+
+	return true;
+}
+
+/*
+ * Can the page range starting at heapBlk be merged into the range starting
+ * at headBlk?  Only ranges covered by the same revmap page can.
+ */
+bool
+brinRevmapCanMergeRanges(BrinRevmap *revmap, BlockNumber heapBlk,
+						 BlockNumber headBlk)
+{
+	return HEAPBLK_TO_REVMAP_BLK(revmap->rm_pagesPerRange, headBlk) ==
+		HEAPBLK_TO_REVMAP_BLK(revmap->rm_pagesPerRange, heapBlk);
+}
+
 /*
  * Given a heap block number, find the corresponding physical revmap block
  * number and return it.  If the revmap page hasn't been allocated yet, return
@@ -283,6 +283,8 @@ brin_xlog_desummarize_page(XLogReaderState *record)
 
 		ItemPointerSetInvalid(&iptr);
 		brinSetHeapBlockItemptr(buffer, xlrec->pagesPerRange, xlrec->heapBlk, iptr);
+		brinRevmapDetachMergedRanges(buffer, xlrec->pagesPerRange,
+									 xlrec->heapBlk);
 
 		PageSetLSN(BufferGetPage(buffer), lsn);
 		MarkBufferDirty(buffer);
@@ -290,6 +292,10 @@ brin_xlog_desummarize_page(XLogReaderState *record)
 	if (BufferIsValid(buffer))
 		UnlockReleaseBuffer(buffer);
 
+	/* a range merged into another one has no entry of its own */
+	if (!XLogRecHasBlockRef(record, 1))
+		return;
+
 	/* remove the leftover entry from the regular page */
 	action = XLogReadBufferForRedo(record, 1, &buffer);
 	if (action == BLK_NEEDS_REDO)
@@ -305,6 +311,50 @@ brin_xlog_desummarize_page(XLogReaderState *record)
 		UnlockReleaseBuffer(buffer);
 }
 
+/*
+ * Replay a merge of a range into a preceding one
+ */
+static void
+brin_xlog_merge(XLogReaderState *record)
+{
+	XLogRecPtr	lsn = record->EndRecPtr;
+	xl_brin_merge *xlrec;
+	Buffer		buffer;
+	XLogRedoAction action;
+
+	xlrec = (xl_brin_merge *) XLogRecGetData(record);
+
+	/* Update the revmap */
+	action = XLogReadBufferForRedo(record, 0, &buffer);
+	if (action == BLK_NEEDS_REDO)
+	{
+		ItemPointerData iptr;
+
+		ItemPointerSet(&iptr, BRIN_METAPAGE_BLKNO,
+					   (xlrec->heapBlk - xlrec->headBlk) / xlrec->pagesPerRange);
+		brinSetHeapBlockItemptr(buffer, xlrec->pagesPerRange, xlrec->heapBlk, iptr);
+
+		PageSetLSN(BufferGetPage(buffer), lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+
+	/* remove the summary tuple of the merged range from the regular page */
+	action = XLogReadBufferForRedo(record, 1, &buffer);
+	if (action == BLK_NEEDS_REDO)
+	{
+		Page		regPg = BufferGetPage(buffer);
+
+		PageIndexTupleDeleteNoCompact(regPg, xlrec->regOffset);
+
+		PageSetLSN(regPg, lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+}
+
 void
 brin_redo(XLogReaderState *record)
 {
@@ -330,6 +380,9 @@ brin_redo(XLogReaderState *record)
 		case XLOG_BRIN_DESUMMARIZE:
 			brin_xlog_desummarize_page(record);
 			break;
+		case XLOG_BRIN_MERGE:
+			brin_xlog_merge(record);
+			break;
 		default:
 			elog(PANIC, "brin_redo: unknown op code %u", info);
 	}
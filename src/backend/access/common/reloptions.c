@@ -94,6 +94,10 @@
  * is only used during VACUUM, which uses a ShareUpdateExclusiveLock,
  * so the VACUUM will not be affected by in-flight changes. Changing its
  * value has no effect until the next VACUUM, so no need for stronger lock.
+ *
+ * BRIN's max_pages_per_range can be set at ShareUpdateExclusiveLock because
+ * it is only used when summarizing page ranges, which takes that lock, and
+ * merged ranges are read the same regardless of its value.
  */
 
 static relopt_bool boolRelOpts[] =
@@ -377,6 +381,14 @@ static relopt_int intRelOpts[] =
 			AccessExclusiveLock
 		}, 128, 1, 131072
 	},
+	{
+		{
+			"max_pages_per_range",
+			"Maximum number of pages that merged page ranges cover in a BRIN index",
+			RELOPT_KIND_BRIN,
+			ShareUpdateExclusiveLock
+		}, 0, 0, INT_MAX
+	},
 	{
 		{
 			"gin_pending_list_limit",
@@ -539,6 +551,16 @@ static relopt_enum_elt_def gistBufferingOptValues[] =
 	{(const char *) NULL}		/* list terminator */
 };
 
+/* values from PageCompressionMethod */
+static relopt_enum_elt_def pageCompressionOptValues[] =
+{
+	{"none", PAGE_COMPRESSION_NONE},
+	{"pglz", PAGE_COMPRESSION_PGLZ},
+	{"lz4", PAGE_COMPRESSION_LZ4},
+	{"zstd", PAGE_COMPRESSION_ZSTD},
+	{(const char *) NULL}		/* list terminator */
+};
+
 /* values from ViewOptCheckOption */
 static relopt_enum_elt_def viewCheckOptValues[] =
 {
@@ -583,6 +605,17 @@ static relopt_enum enumRelOpts[] =
 		VIEW_OPTION_CHECK_OPTION_NOT_SET,
 		gettext_noop("Valid values are \"local\" and \"cascaded\".")
 	},
+	{
+		{
+			"page_compression",
+			"Compression method of the pages of the relation, from its next rewrite",
+			RELOPT_KIND_HEAP | RELOPT_KIND_BTREE,
+			ShareUpdateExclusiveLock
+		},
+		pageCompressionOptValues,
+		PAGE_COMPRESSION_NONE,
+		gettext_noop("Valid values are \"none\", \"pglz\", \"lz4\", and \"zstd\".")
+	},
 	/* list terminator */
 	{{NULL}}
 };
@@ -2025,7 +2058,9 @@ default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 		{"vacuum_truncate", RELOPT_TYPE_TERNARY,
 		offsetof(StdRdOptions, vacuum_truncate)},
 		{"vacuum_max_eager_freeze_failure_rate", RELOPT_TYPE_REAL,
-		offsetof(StdRdOptions, vacuum_max_eager_freeze_failure_rate)}
+		offsetof(StdRdOptions, vacuum_max_eager_freeze_failure_rate)},
+		{"page_compression", RELOPT_TYPE_ENUM,
+		offsetof(StdRdOptions, page_compression)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate, kind,
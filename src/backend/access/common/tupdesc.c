@@ -200,6 +200,7 @@ CreateTemplateTupleDesc(int natts)
 	/* This will be set to the correct value by TupleDescFinalize() */
 	desc->firstNonCachedOffsetAttr = -1;
 	desc->firstNonGuaranteedAttr = -1;
+	desc->firstNonUniformAttr = 0;
 
 	return desc;
 }
@@ -512,6 +513,7 @@ TupleDescFinalize(TupleDesc tupdesc)
 {
 	int			firstNonCachedOffsetAttr = 0;
 	int			firstNonGuaranteedAttr = tupdesc->natts;
+	int			firstNonUniformAttr = -1;
 	int			off = 0;
 
 	for (int i = 0; i < tupdesc->natts; i++)
@@ -554,12 +556,34 @@ TupleDescFinalize(TupleDesc tupdesc)
 
 		cattr->attcacheoff = (int16) off;
 
+		/*
+		 * Track the leading run of byval attributes of the same width which
+		 * are laid out without padding, i.e. as a plain array of int32 or
+		 * int64 values.  slot_deform_heap_tuple() extracts these in bulk.
+		 */
+		if (firstNonUniformAttr == -1 &&
+			(!cattr->attbyval || cattr->attisdropped ||
+			 (cattr->attlen != sizeof(int32) &&
+			  cattr->attlen != sizeof(int64)) ||
+			 cattr->attlen != TupleDescCompactAttr(tupdesc, 0)->attlen ||
+			 off != i * cattr->attlen))
+			firstNonUniformAttr = i;
+
 		off += cattr->attlen;
 		firstNonCachedOffsetAttr = i + 1;
 	}
 
+	/* The run extends to the last cached attribute if nothing ended it */
+	if (firstNonUniformAttr == -1)
+		firstNonUniformAttr = firstNonCachedOffsetAttr;
+
+	/* Bulk extraction isn't worth the trouble for a single attribute */
+	if (firstNonUniformAttr < 2)
+		firstNonUniformAttr = 0;
+
 	tupdesc->firstNonCachedOffsetAttr = firstNonCachedOffsetAttr;
 	tupdesc->firstNonGuaranteedAttr = firstNonGuaranteedAttr;
+	tupdesc->firstNonUniformAttr = firstNonUniformAttr;
 }
 
 /*
@@ -83,6 +83,7 @@ ginhandler(PG_FUNCTION_ARGS)
 		.ambeginscan = ginbeginscan,
 		.amrescan = ginrescan,
 		.amgettuple = NULL,
+		.amgetbatch = NULL,
 		.amgetbitmap = gingetbitmap,
 		.amendscan = ginendscan,
 		.ammarkpos = NULL,
@@ -78,7 +78,7 @@ gisthandler(PG_FUNCTION_ARGS)
 		.amclusterable = true,
 		.ampredlocks = true,
 		.amcanparallel = false,
-		.amcanbuildparallel = false,
+		.amcanbuildparallel = true,
 		.amcaninclude = true,
 		.amusemaintenanceworkmem = false,
 		.amsummarizing = false,
@@ -103,6 +103,7 @@ gisthandler(PG_FUNCTION_ARGS)
 		.ambeginscan = gistbeginscan,
 		.amrescan = gistrescan,
 		.amgettuple = gistgettuple,
+		.amgetbatch = NULL,
 		.amgetbitmap = gistgetbitmap,
 		.amendscan = gistendscan,
 		.ammarkpos = NULL,
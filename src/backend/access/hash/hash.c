@@ -89,7 +89,7 @@ hashhandler(PG_FUNCTION_ARGS)
 		.amclusterable = false,
 		.ampredlocks = true,
 		.amcanparallel = false,
-		.amcanbuildparallel = false,
+		.amcanbuildparallel = true,
 		.amcaninclude = false,
 		.amusemaintenanceworkmem = false,
 		.amsummarizing = false,
@@ -114,6 +114,7 @@ hashhandler(PG_FUNCTION_ARGS)
 		.ambeginscan = hashbeginscan,
 		.amrescan = hashrescan,
 		.amgettuple = hashgettuple,
+		.amgetbatch = NULL,
 		.amgetbitmap = hashgetbitmap,
 		.amendscan = hashendscan,
 		.ammarkpos = NULL,
@@ -180,19 +181,33 @@ hashbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	else
 		sort_threshold = Min(sort_threshold, NLocBuffer);
 
-	if (num_buckets >= sort_threshold)
-		buildstate.spool = _h_spoolinit(heap, index, num_buckets);
-	else
-		buildstate.spool = NULL;
-
 	/* prepare to build the index */
+	buildstate.spool = NULL;
 	buildstate.indtuples = 0;
 	buildstate.heapRel = heap;
 
-	/* do the heap scan */
-	reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
-									   hashbuildCallback,
-									   &buildstate, NULL);
+	/*
+	 * A parallel build always sorts: the participants scan the heap and sort
+	 * their share of the tuples, and we then insert them all in bucket order.
+	 * If no worker can be launched, fall back to a serial build.
+	 */
+	if (indexInfo->ii_ParallelWorkers > 0)
+		buildstate.spool = _h_parallel_spool(heap, index, num_buckets,
+											 indexInfo->ii_Concurrent,
+											 indexInfo->ii_ParallelWorkers,
+											 &reltuples,
+											 &buildstate.indtuples);
+
+	if (buildstate.spool == NULL)
+	{
+		if (num_buckets >= sort_threshold)
+			buildstate.spool = _h_spoolinit(heap, index, num_buckets);
+
+		/* do the heap scan */
+		reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+										   hashbuildCallback,
+										   &buildstate, NULL);
+	}
 	pgstat_progress_update_param(PROGRESS_CREATEIDX_TUPLES_TOTAL,
 								 buildstate.indtuples);
 
@@ -13,6 +13,10 @@
  * hash code value.  That's no big problem though, since we'll still have
  * plenty of locality of access.
  *
+ * A parallel build scans the heap in the workers and the leader, each of
+ * which sorts the tuples it reads; the leader then merges the sorted runs and
+ * inserts all the tuples in the index.
+ *
  *
  * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -26,12 +30,127 @@
 #include "postgres.h"
 
 #include "access/hash.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "catalog/index.h"
 #include "commands/progress.h"
+#include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/pg_bitutils.h"
+#include "storage/condition_variable.h"
+#include "storage/proc.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/snapmgr.h"
 #include "utils/tuplesort.h"
+#include "utils/wait_event.h"
+
+/* Magic numbers for parallel state sharing */
+#define PARALLEL_KEY_HASH_SHARED		UINT64CONST(0xC000000000000001)
+#define PARALLEL_KEY_TUPLESORT			UINT64CONST(0xC000000000000002)
+#define PARALLEL_KEY_QUERY_TEXT			UINT64CONST(0xC000000000000003)
+#define PARALLEL_KEY_WAL_USAGE			UINT64CONST(0xC000000000000004)
+#define PARALLEL_KEY_BUFFER_USAGE		UINT64CONST(0xC000000000000005)
+
+/*
+ * Status for index builds performed in parallel.  This is allocated in a
+ * dynamic shared memory segment.
+ */
+typedef struct HashShared
+{
+	/*
+	 * These fields are not modified during the build.  They primarily exist
+	 * for the benefit of worker processes that need to create state
+	 * corresponding to that used by the leader.
+	 */
+	Oid			heaprelid;
+	Oid			indexrelid;
+	bool		isconcurrent;
+	int			scantuplesortstates;
+
+	/* Bucket masks, so that all participants sort the same way */
+	uint32		high_mask;
+	uint32		low_mask;
+	uint32		max_buckets;
+
+	/* Query ID, for report in worker processes */
+	int64		queryid;
+
+	/*
+	 * workersdonecv is used to monitor the progress of workers.  All parallel
+	 * participants must indicate that they are done before leader can merge
+	 * their sorted runs.
+	 */
+	ConditionVariable workersdonecv;
+
+	/* mutex protects the mutable fields that follow */
+	slock_t		mutex;
 
+	/*
+	 * Mutable state that is maintained by workers, and reported back to
+	 * leader at end of the scans.
+	 *
+	 * nparticipantsdone is number of worker processes finished.
+	 *
+	 * reltuples is the total number of input heap tuples.
+	 *
+	 * indtuples is the total number of tuples that made it into the index.
+	 */
+	int			nparticipantsdone;
+	double		reltuples;
+	double		indtuples;
+
+	/*
+	 * ParallelTableScanDescData data follows. Can't directly embed here, as
+	 * implementations of the parallel table scan desc interface might need
+	 * stronger alignment.
+	 */
+} HashShared;
+
+/*
+ * Return pointer to a HashShared's parallel table scan.
+ *
+ * c.f. shm_toc_allocate as to why BUFFERALIGN is used, rather than just
+ * MAXALIGN.
+ */
+#define ParallelTableScanFromHashShared(shared) \
+	(ParallelTableScanDesc) ((char *) (shared) + BUFFERALIGN(sizeof(HashShared)))
+
+/*
+ * Status for leader in parallel index build.
+ */
+typedef struct HashLeader
+{
+	/* parallel context itself */
+	ParallelContext *pcxt;
+
+	/*
+	 * nparticipanttuplesorts is the exact number of worker processes
+	 * successfully launched, plus one leader process if it participates as a
+	 * worker (only DISABLE_LEADER_PARTICIPATION builds avoid leader
+	 * participating as a worker).
+	 */
+	int			nparticipanttuplesorts;
+
+	/*
+	 * Leader process convenience pointers to shared state (leader avoids TOC
+	 * lookups).
+	 *
+	 * hashshared is the shared state for entire build.  sharedsort is the
+	 * shared, tuplesort-managed state passed to each process tuplesort.
+	 * snapshot is the snapshot used by the scan iff an MVCC snapshot is
+	 * required.
+	 */
+	HashShared *hashshared;
+	Sharedsort *sharedsort;
+	Snapshot	snapshot;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+} HashLeader;
 
 /*
  * Status record for spooling/sorting phase.
@@ -40,6 +159,7 @@ struct HSpool
 {
 	Tuplesortstate *sortstate;	/* state data for tuplesort.c */
 	Relation	index;
+	HashLeader *hashleader;		/* NULL unless parallel build */
 
 	/*
 	 * We sort the hash keys based on the buckets they belong to, then by the
@@ -52,12 +172,35 @@ struct HSpool
 	uint32		max_buckets;
 };
 
+/* Working state of a participant in a parallel build */
+typedef struct HashParallelBuildState
+{
+	HSpool	   *spool;
+	double		indtuples;		/* # tuples spooled */
+} HashParallelBuildState;
+
+static HSpool *_h_spoolcreate(Relation index, uint32 num_buckets);
+static void _h_begin_parallel(HSpool *hspool, Relation heap, bool isconcurrent,
+							  int request);
+static void _h_end_parallel(HashLeader *hashleader);
+static Size _h_parallel_estimate_shared(Relation heap, Snapshot snapshot);
+static double _h_parallel_heapscan(HashLeader *hashleader, double *indtuples);
+static void _h_leader_participate_as_worker(HashLeader *hashleader,
+											Relation heap, Relation index);
+static void _h_parallel_scan_and_sort(HashShared *hashshared,
+									  Sharedsort *sharedsort,
+									  Relation heap, Relation index,
+									  int sortmem, bool progress);
+static void _h_parallel_build_callback(Relation index, ItemPointer tid,
+									   Datum *values, bool *isnull,
+									   bool tupleIsAlive, void *state);
+
 
 /*
- * create and initialize a spool structure
+ * create a spool structure, without its tuplesort
  */
-HSpool *
-_h_spoolinit(Relation heap, Relation index, uint32 num_buckets)
+static HSpool *
+_h_spoolcreate(Relation index, uint32 num_buckets)
 {
 	HSpool	   *hspool = palloc0_object(HSpool);
 
@@ -75,6 +218,17 @@ _h_spoolinit(Relation heap, Relation index, uint32 num_buckets)
 	hspool->low_mask = (hspool->high_mask >> 1);
 	hspool->max_buckets = num_buckets - 1;
 
+	return hspool;
+}
+
+/*
+ * create and initialize a spool structure
+ */
+HSpool *
+_h_spoolinit(Relation heap, Relation index, uint32 num_buckets)
+{
+	HSpool	   *hspool = _h_spoolcreate(index, num_buckets);
+
 	/*
 	 * We size the sort area as maintenance_work_mem rather than work_mem to
 	 * speed index creation.  This should be OK since a single backend can't
@@ -99,6 +253,8 @@ void
 _h_spooldestroy(HSpool *hspool)
 {
 	tuplesort_end(hspool->sortstate);
+	if (hspool->hashleader)
+		_h_end_parallel(hspool->hashleader);
 	pfree(hspool);
 }
 
@@ -155,3 +311,522 @@ _h_indexbuild(HSpool *hspool, Relation heapRel)
 									 ++tups_done);
 	}
 }
+
+/*
+ * Spool all the tuples of the heap in parallel.
+ *
+ * request is the target number of parallel worker processes to launch, and
+ * isconcurrent indicates if operation is CREATE INDEX CONCURRENTLY.
+ *
+ * Returns NULL if not even a single worker process can be launched, in which
+ * case the caller should proceed with a serial index build.  Otherwise, the
+ * heap has been scanned by the time this returns, and the returned spool
+ * merges the runs sorted by all participants; it is to be passed to
+ * _h_indexbuild() and _h_spooldestroy() like any other.  *reltuples and
+ * *indtuples are set to the number of heap tuples scanned and spooled.
+ */
+HSpool *
+_h_parallel_spool(Relation heap, Relation index, uint32 num_buckets,
+				  bool isconcurrent, int request,
+				  double *reltuples, double *indtuples)
+{
+	HSpool	   *hspool = _h_spoolcreate(index, num_buckets);
+	HashLeader *hashleader;
+	SortCoordinate coordinate;
+
+	_h_begin_parallel(hspool, heap, isconcurrent, request);
+	if (hspool->hashleader == NULL)
+	{
+		pfree(hspool);
+		return NULL;
+	}
+	hashleader = hspool->hashleader;
+
+	/*
+	 * Set up the leader's tuplesort, which merges the runs sorted by the
+	 * participants (including the leader itself, as a worker).
+	 */
+	coordinate = palloc0_object(SortCoordinateData);
+	coordinate->isWorker = false;
+	coordinate->nParticipants = hashleader->nparticipanttuplesorts;
+	coordinate->sharedsort = hashleader->sharedsort;
+
+	hspool->sortstate = tuplesort_begin_index_hash(heap,
+												   index,
+												   hspool->high_mask,
+												   hspool->low_mask,
+												   hspool->max_buckets,
+												   maintenance_work_mem,
+												   coordinate,
+												   TUPLESORT_NONE);
+
+	*reltuples = _h_parallel_heapscan(hashleader, indtuples);
+
+	return hspool;
+}
+
+/*
+ * Create parallel context, and launch workers for leader.
+ *
+ * Sets hspool's HashLeader, which is used to shut down parallel mode when
+ * the spool is destroyed.  If not even a single worker process can be
+ * launched, this is never set.
+ */
+static void
+_h_begin_parallel(HSpool *hspool, Relation heap, bool isconcurrent,
+				  int request)
+{
+	ParallelContext *pcxt;
+	int			scantuplesortstates;
+	Snapshot	snapshot;
+	Size		esthashshared;
+	Size		estsort;
+	HashShared *hashshared;
+	Sharedsort *sharedsort;
+	HashLeader *hashleader = palloc0_object(HashLeader);
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	bool		leaderparticipates = true;
+	int			querylen;
+
+#ifdef DISABLE_LEADER_PARTICIPATION
+	leaderparticipates = false;
+#endif
+
+	/*
+	 * Enter parallel mode, and create context for parallel build of hash
+	 * index
+	 */
+	EnterParallelMode();
+	Assert(request > 0);
+	pcxt = CreateParallelContext("postgres", "_hash_parallel_build_main",
+								 request);
+
+	scantuplesortstates = leaderparticipates ? request + 1 : request;
+
+	/*
+	 * Prepare for scan of the base relation.  In a normal index build, we use
+	 * SnapshotAny because we must retrieve all tuples and do our own time
+	 * qual checks (because we have to index RECENTLY_DEAD tuples).  In a
+	 * concurrent build, we take a regular MVCC snapshot and index whatever's
+	 * live according to that.
+	 */
+	if (!isconcurrent)
+		snapshot = SnapshotAny;
+	else
+		snapshot = RegisterSnapshot(GetTransactionSnapshot());
+
+	/*
+	 * Estimate size for our own PARALLEL_KEY_HASH_SHARED workspace, and for
+	 * PARALLEL_KEY_TUPLESORT tuplesort workspace
+	 */
+	esthashshared = _h_parallel_estimate_shared(heap, snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, esthashshared);
+	estsort = tuplesort_estimate_shared(scantuplesortstates);
+	shm_toc_estimate_chunk(&pcxt->estimator, estsort);
+
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+	/*
+	 * Estimate space for WalUsage and BufferUsage -- PARALLEL_KEY_WAL_USAGE
+	 * and PARALLEL_KEY_BUFFER_USAGE.
+	 *
+	 * If there are no extensions loaded that care, we could skip this.  We
+	 * have no way of knowing whether anyone's looking at pgWalUsage or
+	 * pgBufferUsage, so do it unconditionally.
+	 */
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/* Finally, estimate PARALLEL_KEY_QUERY_TEXT space */
+	if (debug_query_string)
+	{
+		querylen = strlen(debug_query_string);
+		shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+	else
+		querylen = 0;			/* keep compiler quiet */
+
+	/* Everyone's had a chance to ask for space, so now create the DSM */
+	InitializeParallelDSM(pcxt);
+
+	/* If no DSM segment was available, back out (do serial build) */
+	if (pcxt->seg == NULL)
+	{
+		if (IsMVCCSnapshot(snapshot))
+			UnregisterSnapshot(snapshot);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return;
+	}
+
+	/* Store shared build state, for which we reserved space */
+	hashshared = (HashShared *) shm_toc_allocate(pcxt->toc, esthashshared);
+	/* Initialize immutable state */
+	hashshared->heaprelid = RelationGetRelid(heap);
+	hashshared->indexrelid = RelationGetRelid(hspool->index);
+	hashshared->isconcurrent = isconcurrent;
+	hashshared->scantuplesortstates = scantuplesortstates;
+	hashshared->high_mask = hspool->high_mask;
+	hashshared->low_mask = hspool->low_mask;
+	hashshared->max_buckets = hspool->max_buckets;
+	hashshared->queryid = pgstat_get_my_query_id();
+	ConditionVariableInit(&hashshared->workersdonecv);
+	SpinLockInit(&hashshared->mutex);
+
+	/* Initialize mutable state */
+	hashshared->nparticipantsdone = 0;
+	hashshared->reltuples = 0.0;
+	hashshared->indtuples = 0.0;
+
+	table_parallelscan_initialize(heap,
+								  ParallelTableScanFromHashShared(hashshared),
+								  snapshot);
+
+	/*
+	 * Store shared tuplesort-private state, for which we reserved space.
+	 * Then, initialize opaque state using tuplesort routine.
+	 */
+	sharedsort = (Sharedsort *) shm_toc_allocate(pcxt->toc, estsort);
+	tuplesort_initialize_shared(sharedsort, scantuplesortstates,
+								pcxt->seg);
+
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_HASH_SHARED, hashshared);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_TUPLESORT, sharedsort);
+
+	/* Store query string for workers */
+	if (debug_query_string)
+	{
+		char	   *sharedquery;
+
+		sharedquery = (char *) shm_toc_allocate(pcxt->toc, querylen + 1);
+		memcpy(sharedquery, debug_query_string, querylen + 1);
+		shm_toc_insert(pcxt->toc, PARALLEL_KEY_QUERY_TEXT, sharedquery);
+	}
+
+	/*
+	 * Allocate space for each worker's WalUsage and BufferUsage; no need to
+	 * initialize.
+	 */
+	walusage = shm_toc_allocate(pcxt->toc,
+								mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_WAL_USAGE, walusage);
+	bufferusage = shm_toc_allocate(pcxt->toc,
+								   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BUFFER_USAGE, bufferusage);
+
+	/* Launch workers, saving status for leader/caller */
+	LaunchParallelWorkers(pcxt);
+	hashleader->pcxt = pcxt;
+	hashleader->nparticipanttuplesorts = pcxt->nworkers_launched;
+	if (leaderparticipates)
+		hashleader->nparticipanttuplesorts++;
+	hashleader->hashshared = hashshared;
+	hashleader->sharedsort = sharedsort;
+	hashleader->snapshot = snapshot;
+	hashleader->walusage = walusage;
+	hashleader->bufferusage = bufferusage;
+
+	/* If no workers were successfully launched, back out (do serial build) */
+	if (pcxt->nworkers_launched == 0)
+	{
+		_h_end_parallel(hashleader);
+		return;
+	}
+
+	/* Save leader state now that it's clear build will be parallel */
+	hspool->hashleader = hashleader;
+
+	/* Join heap scan ourselves */
+	if (leaderparticipates)
+		_h_leader_participate_as_worker(hashleader, heap, hspool->index);
+
+	/*
+	 * Caller needs to wait for all launched workers when we return.  Make
+	 * sure that the failure-to-start case will not hang forever.
+	 */
+	WaitForParallelWorkersToAttach(pcxt);
+}
+
+/*
+ * Shut down workers, destroy parallel context, and end parallel mode.
+ */
+static void
+_h_end_parallel(HashLeader *hashleader)
+{
+	int			i;
+
+	/* Shutdown worker processes */
+	WaitForParallelWorkersToFinish(hashleader->pcxt);
+
+	/*
+	 * Next, accumulate WAL usage.  (This must wait for the workers to finish,
+	 * or we might get incomplete data.)
+	 */
+	for (i = 0; i < hashleader->pcxt->nworkers_launched; i++)
+		InstrAccumParallelQuery(&hashleader->bufferusage[i], &hashleader->walusage[i]);
+
+	/* Free last reference to MVCC snapshot, if one was used */
+	if (IsMVCCSnapshot(hashleader->snapshot))
+		UnregisterSnapshot(hashleader->snapshot);
+	DestroyParallelContext(hashleader->pcxt);
+	ExitParallelMode();
+}
+
+/*
+ * Returns size of shared memory required to store state for a parallel
+ * hash index build based on the snapshot its parallel scan will use.
+ */
+static Size
+_h_parallel_estimate_shared(Relation heap, Snapshot snapshot)
+{
+	/* c.f. shm_toc_allocate as to why BUFFERALIGN is used */
+	return add_size(BUFFERALIGN(sizeof(HashShared)),
+					table_parallelscan_estimate(heap, snapshot));
+}
+
+/*
+ * Within leader, wait for end of heap scan.
+ *
+ * When called, parallel heap scan started by _h_begin_parallel() will
+ * already be underway within worker processes (when leader participates
+ * as a worker, we should end up here just as workers are finishing).
+ *
+ * Returns the total number of heap tuples scanned, and sets *indtuples to
+ * the number of tuples spooled.
+ */
+static double
+_h_parallel_heapscan(HashLeader *hashleader, double *indtuples)
+{
+	HashShared *hashshared = hashleader->hashshared;
+	double		reltuples;
+
+	for (;;)
+	{
+		SpinLockAcquire(&hashshared->mutex);
+		if (hashshared->nparticipantsdone == hashleader->nparticipanttuplesorts)
+		{
+			reltuples = hashshared->reltuples;
+			*indtuples = hashshared->indtuples;
+			SpinLockRelease(&hashshared->mutex);
+			break;
+		}
+		SpinLockRelease(&hashshared->mutex);
+
+		ConditionVariableSleep(&hashshared->workersdonecv,
+							   WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN);
+	}
+
+	ConditionVariableCancelSleep();
+
+	return reltuples;
+}
+
+/*
+ * Within leader, participate as a parallel worker.
+ */
+static void
+_h_leader_participate_as_worker(HashLeader *hashleader, Relation heap,
+								Relation index)
+{
+	int			sortmem;
+
+	/*
+	 * Might as well use reliable figure when doling out maintenance_work_mem
+	 * (when requested number of workers were not launched, this will be
+	 * somewhat higher than it is for other workers).
+	 */
+	sortmem = maintenance_work_mem / hashleader->nparticipanttuplesorts;
+
+	/* Perform work common to all participants */
+	_h_parallel_scan_and_sort(hashleader->hashshared, hashleader->sharedsort,
+							  heap, index, sortmem, true);
+}
+
+/*
+ * Perform a worker's portion of a parallel sort.
+ *
+ * This spools the tuples of the worker's portion of the table in a tuplesort
+ * of its own, and sorts them.
+ *
+ * sortmem is the amount of working memory to use within each worker,
+ * expressed in KBs.
+ *
+ * When this returns, workers are done, and need only release resources.
+ */
+static void
+_h_parallel_scan_and_sort(HashShared *hashshared, Sharedsort *sharedsort,
+						  Relation heap, Relation index,
+						  int sortmem, bool progress)
+{
+	HashParallelBuildState buildstate;
+	HSpool	   *hspool;
+	SortCoordinate coordinate;
+	TableScanDesc scan;
+	double		reltuples;
+	IndexInfo  *indexInfo;
+
+	/* Initialize local tuplesort coordination state */
+	coordinate = palloc0_object(SortCoordinateData);
+	coordinate->isWorker = true;
+	coordinate->nParticipants = -1;
+	coordinate->sharedsort = sharedsort;
+
+	/* Begin "partial" tuplesort */
+	hspool = palloc0_object(HSpool);
+	hspool->index = index;
+	hspool->high_mask = hashshared->high_mask;
+	hspool->low_mask = hashshared->low_mask;
+	hspool->max_buckets = hashshared->max_buckets;
+	hspool->sortstate = tuplesort_begin_index_hash(heap,
+												   index,
+												   hspool->high_mask,
+												   hspool->low_mask,
+												   hspool->max_buckets,
+												   sortmem,
+												   coordinate,
+												   TUPLESORT_NONE);
+
+	buildstate.spool = hspool;
+	buildstate.indtuples = 0;
+
+	/* Join parallel scan */
+	indexInfo = BuildIndexInfo(index);
+	indexInfo->ii_Concurrent = hashshared->isconcurrent;
+
+	scan = table_beginscan_parallel(heap,
+									ParallelTableScanFromHashShared(hashshared),
+									SO_NONE);
+
+	reltuples = table_index_build_scan(heap, index, indexInfo, true, progress,
+									   _h_parallel_build_callback,
+									   &buildstate, scan);
+
+	/* sort the tuples spooled by this participant */
+	tuplesort_performsort(hspool->sortstate);
+
+	/*
+	 * Done.  Record ambuild statistics.
+	 */
+	SpinLockAcquire(&hashshared->mutex);
+	hashshared->nparticipantsdone++;
+	hashshared->reltuples += reltuples;
+	hashshared->indtuples += buildstate.indtuples;
+	SpinLockRelease(&hashshared->mutex);
+
+	/* Notify leader */
+	ConditionVariableSignal(&hashshared->workersdonecv);
+
+	_h_spooldestroy(hspool);
+}
+
+/*
+ * Per-tuple callback for table_index_build_scan in parallel builds.
+ */
+static void
+_h_parallel_build_callback(Relation index,
+						   ItemPointer tid,
+						   Datum *values,
+						   bool *isnull,
+						   bool tupleIsAlive,
+						   void *state)
+{
+	HashParallelBuildState *buildstate = (HashParallelBuildState *) state;
+	Datum		index_values[1];
+	bool		index_isnull[1];
+
+	/* convert data to a hash key; on failure, do not spool anything */
+	if (!_hash_convert_tuple(index,
+							 values, isnull,
+							 index_values, index_isnull))
+		return;
+
+	_h_spool(buildstate->spool, tid, index_values, index_isnull);
+
+	buildstate->indtuples += 1;
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void
+_hash_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+	char	   *sharedquery;
+	HashShared *hashshared;
+	Sharedsort *sharedsort;
+	Relation	heapRel;
+	Relation	indexRel;
+	LOCKMODE	heapLockmode;
+	LOCKMODE	indexLockmode;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	int			sortmem;
+
+	/*
+	 * The only possible status flag that can be set to the parallel worker is
+	 * PROC_IN_SAFE_IC.
+	 */
+	Assert((MyProc->statusFlags == 0) ||
+		   (MyProc->statusFlags == PROC_IN_SAFE_IC));
+
+	/* Set debug_query_string for individual workers first */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_KEY_QUERY_TEXT, true);
+	debug_query_string = sharedquery;
+
+	/* Report the query string from leader */
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	/* Look up hash shared state */
+	hashshared = shm_toc_lookup(toc, PARALLEL_KEY_HASH_SHARED, false);
+
+	/* Open relations using lock modes known to be obtained by index.c */
+	if (!hashshared->isconcurrent)
+	{
+		heapLockmode = ShareLock;
+		indexLockmode = AccessExclusiveLock;
+	}
+	else
+	{
+		heapLockmode = ShareUpdateExclusiveLock;
+		indexLockmode = RowExclusiveLock;
+	}
+
+	/* Track query ID */
+	pgstat_report_query_id(hashshared->queryid, false);
+
+	/* Open relations within worker */
+	heapRel = table_open(hashshared->heaprelid, heapLockmode);
+	indexRel = index_open(hashshared->indexrelid, indexLockmode);
+
+	/* Look up shared state private to tuplesort.c */
+	sharedsort = shm_toc_lookup(toc, PARALLEL_KEY_TUPLESORT, false);
+	tuplesort_attach_shared(sharedsort, seg);
+
+	/* Prepare to track buffer usage during parallel execution */
+	InstrStartParallelQuery();
+
+	/*
+	 * Might as well use reliable figure when doling out maintenance_work_mem
+	 * (when requested number of workers were not launched, this will be
+	 * somewhat higher than it is for other workers).
+	 */
+	sortmem = maintenance_work_mem / hashshared->scantuplesortstates;
+
+	_h_parallel_scan_and_sort(hashshared, sharedsort, heapRel, indexRel,
+							  sortmem, false);
+
+	/* Report WAL/buffer usage during parallel execution */
+	bufferusage = shm_toc_lookup(toc, PARALLEL_KEY_BUFFER_USAGE, false);
+	walusage = shm_toc_lookup(toc, PARALLEL_KEY_WAL_USAGE, false);
+	InstrEndParallelQuery(&bufferusage[ParallelWorkerNumber],
+						  &walusage[ParallelWorkerNumber]);
+
+	index_close(indexRel, indexLockmode);
+	table_close(heapRel, heapLockmode);
+}
@@ -19,6 +19,12 @@
 #include "storage/predicate.h"
 
 
+static BlockNumber heapam_index_fetch_next_block(ReadStream *stream,
+												 void *callback_private_data,
+												 void *per_buffer_data);
+static Buffer heapam_index_fetch_stream_buffer(IndexFetchHeapData *hscan);
+
+
 /* ------------------------------------------------------------------------
  * Index Scan Callbacks for heap AM
  * ------------------------------------------------------------------------
@@ -34,6 +40,9 @@ heapam_index_fetch_begin(Relation rel, uint32 flags)
 	hscan->xs_cbuf = InvalidBuffer;
 	hscan->xs_blk = InvalidBlockNumber;
 	hscan->xs_vmbuffer = InvalidBuffer;
+	hscan->xs_stream = NULL;
+	hscan->xs_stream_blk = InvalidBlockNumber;
+	hscan->xs_stream_paused = false;
 
 	return &hscan->xs_base;
 }
@@ -41,13 +50,34 @@ heapam_index_fetch_begin(Relation rel, uint32 flags)
 void
 heapam_index_fetch_reset(IndexFetchTableData *scan)
 {
+	IndexFetchHeapData *hscan = (IndexFetchHeapData *) scan;
+
 	/*
-	 * Resets are a no-op.
+	 * Resets are a no-op, unless we've been reading ahead.
 	 *
 	 * Deliberately avoid dropping pins now held in xs_cbuf and xs_vmbuffer.
 	 * This saves cycles during certain tight nested loop joins (it can avoid
 	 * repeated pinning and unpinning of the same buffer across rescans).
 	 */
+	if (hscan->xs_stream == NULL)
+		return;
+
+	/*
+	 * The blocks read ahead so far were chosen based on TIDs the scan isn't
+	 * going to return after all, so throw them away.  The current buffer has
+	 * to go too, so that the next fetch takes its buffer from the stream,
+	 * which will start over from the first TID of the next batch.
+	 */
+	read_stream_reset(hscan->xs_stream);
+	hscan->xs_stream_blk = InvalidBlockNumber;
+	hscan->xs_stream_paused = false;
+
+	if (BufferIsValid(hscan->xs_cbuf))
+	{
+		ReleaseBuffer(hscan->xs_cbuf);
+		hscan->xs_cbuf = InvalidBuffer;
+	}
+	hscan->xs_blk = InvalidBlockNumber;
 }
 
 void
@@ -55,6 +85,10 @@ heapam_index_fetch_end(IndexFetchTableData *scan)
 {
 	IndexFetchHeapData *hscan = (IndexFetchHeapData *) scan;
 
+	/* drop pins held by the read stream, if we've been reading ahead */
+	if (hscan->xs_stream)
+		read_stream_end(hscan->xs_stream);
+
 	/* drop pin if there's a pinned heap page */
 	if (BufferIsValid(hscan->xs_cbuf))
 		ReleaseBuffer(hscan->xs_cbuf);
@@ -252,7 +286,10 @@ heapam_index_fetch_tuple(struct IndexFetchTableData *scan,
 		if (BufferIsValid(hscan->xs_cbuf))
 			ReleaseBuffer(hscan->xs_cbuf);
 
-		hscan->xs_cbuf = ReadBuffer(hscan->xs_base.rel, hscan->xs_blk);
+		if (hscan->xs_base.batch != NULL)
+			hscan->xs_cbuf = heapam_index_fetch_stream_buffer(hscan);
+		else
+			hscan->xs_cbuf = ReadBuffer(hscan->xs_base.rel, hscan->xs_blk);
 
 		/*
 		 * Prune page when it is pinned for the first time
@@ -296,3 +333,89 @@ heapam_index_fetch_tuple(struct IndexFetchTableData *scan,
 
 	return got_heap_tuple;
 }
+
+/*
+ * Read stream callback for index scans.  Returns the block of the next TID in
+ * the index scan's batch that isn't on the same block as the one before it,
+ * mirroring how heapam_index_fetch_tuple() only switches buffers when the
+ * block changes.  When the batch runs out, the stream is paused until the
+ * index AM has moved on to its next batch.
+ */
+static BlockNumber
+heapam_index_fetch_next_block(ReadStream *stream,
+							  void *callback_private_data,
+							  void *per_buffer_data)
+{
+	IndexFetchHeapData *hscan = (IndexFetchHeapData *) callback_private_data;
+	IndexScanBatch batch = hscan->xs_base.batch;
+
+	while (batch->nread < batch->ntids)
+	{
+		BlockNumber blkno;
+
+		blkno = ItemPointerGetBlockNumber(&batch->tids[batch->nread++]);
+		if (blkno != hscan->xs_stream_blk)
+		{
+			hscan->xs_stream_blk = blkno;
+			return blkno;
+		}
+	}
+
+	hscan->xs_stream_paused = true;
+	return read_stream_pause(stream);
+}
+
+/*
+ * Get the buffer for hscan->xs_blk, the block of the TID the index scan
+ * returned most recently, when the index scan provides a batch of upcoming
+ * TIDs.
+ *
+ * The read stream is only started once a batch has more than one TID left,
+ * so that scans returning a single row, like unique index lookups, don't pay
+ * for it.  Once started, every buffer switch takes the next buffer from the
+ * stream, whose callback walks the same TIDs in the same order.
+ */
+static Buffer
+heapam_index_fetch_stream_buffer(IndexFetchHeapData *hscan)
+{
+	IndexScanBatch batch = hscan->xs_base.batch;
+	Buffer		buf;
+
+	Assert(batch->nreturned > 0 && batch->nreturned <= batch->ntids);
+	Assert(ItemPointerGetBlockNumber(&batch->tids[batch->nreturned - 1]) ==
+		   hscan->xs_blk);
+
+	if (hscan->xs_stream == NULL)
+	{
+		if (batch->nreturned >= batch->ntids)
+			return ReadBuffer(hscan->xs_base.rel, hscan->xs_blk);
+
+		hscan->xs_stream = read_stream_begin_relation(READ_STREAM_DEFAULT |
+													  READ_STREAM_USE_BATCHING,
+													  NULL,
+													  hscan->xs_base.rel,
+													  MAIN_FORKNUM,
+													  heapam_index_fetch_next_block,
+													  hscan,
+													  0);
+
+		/* Start reading ahead from the current TID */
+		batch->nread = batch->nreturned - 1;
+		hscan->xs_stream_blk = InvalidBlockNumber;
+		hscan->xs_stream_paused = false;
+	}
+	else if (hscan->xs_stream_paused && batch->nread < batch->ntids)
+	{
+		/* The index AM has provided a new batch */
+		read_stream_resume(hscan->xs_stream);
+		hscan->xs_stream_paused = false;
+	}
+
+	buf = read_stream_next_buffer(hscan->xs_stream, NULL);
+	if (!BufferIsValid(buf) || BufferGetBlockNumber(buf) != hscan->xs_blk)
+		elog(ERROR, "index scan read stream returned unexpected block for TID (%u,%u)",
+			 hscan->xs_blk,
+			 ItemPointerGetOffsetNumber(&batch->tids[batch->nreturned - 1]));
+
+	return buf;
+}
@@ -25,8 +25,10 @@
  * been referred to colloquially as phases for so long that they are referred
  * to as such here.
  *
- * Manually invoked VACUUMs may scan indexes during phase II in parallel. For
- * more information on this, see the comment at the top of vacuumparallel.c.
+ * Manually invoked VACUUMs may scan indexes during phase II in parallel, and
+ * process the heap during phases I and III in parallel if the relation is
+ * large enough (see "Parallel heap vacuum" below). For more information on
+ * this, see the comment at the top of vacuumparallel.c.
  *
  * In between phases, vacuum updates the freespace map (every
  * VACUUM_FSM_EVERY_PAGES).
@@ -133,6 +135,7 @@
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
+#include "access/parallel.h"
 #include "access/tidstore.h"
 #include "access/transam.h"
 #include "access/visibilitymap.h"
@@ -144,6 +147,7 @@
 #include "common/pg_prng.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
+#include "optimizer/paths.h"
 #include "pgstat.h"
 #include "portability/instr_time.h"
 #include "postmaster/autovacuum.h"
@@ -152,6 +156,7 @@
 #include "storage/latch.h"
 #include "storage/lmgr.h"
 #include "storage/read_stream.h"
+#include "storage/spin.h"
 #include "utils/injection_point.h"
 #include "utils/lsyscache.h"
 #include "utils/pg_rusage.h"
@@ -249,6 +254,132 @@ typedef enum
  */
 #define EAGER_SCAN_REGION_SIZE 4096
 
+/*
+ * Parallel heap vacuum
+ *
+ * When the table is big enough, a parallel vacuum (see vacuumparallel.c) has
+ * its parallel workers take part in both passes over the heap, along with the
+ * leader.
+ *
+ * In the first pass, the participants claim the blocks to scan chunk by
+ * chunk, each chunk being PARALLEL_VACUUM_CHUNK_SIZE blocks.  The chunks are
+ * aligned on the eager scan regions, so that each participant can manage the
+ * eager scanning of the chunks it claims locally, with the success cap
+ * shared by all.  Every participant prunes and freezes the pages of its
+ * chunks and adds their dead items to the shared TID store.  Once the TID
+ * store fills up, all participants stop scanning, leaving the rest of their
+ * current chunk for later, and the leader vacuums the indexes and the heap
+ * before launching workers again to resume the scan.
+ *
+ * In the second pass, every participant iterates over the TID store, which
+ * yields blocks in increasing order, and vacuums the blocks of the chunks it
+ * claims, see vacuum_reap_lp_read_stream_next().
+ *
+ * The participants report the counters they updated to the leader at the end
+ * of each pass, through their PHVResults.
+ */
+#define PARALLEL_VACUUM_CHUNK_SIZE	EAGER_SCAN_REGION_SIZE
+
+/*
+ * Macro to check if the heap itself is processed in parallel.  If true, so
+ * is ParallelVacuumIsActive().
+ */
+#define ParallelHeapVacuumIsActive(vacrel) ((vacrel)->phvs != NULL)
+
+/* Pass over the heap the parallel workers are launched for */
+typedef enum PHVPhase
+{
+	PHV_PHASE_SCAN_HEAP,
+	PHV_PHASE_VACUUM_HEAP,
+} PHVPhase;
+
+/*
+ * Counters of a participant, reported to the leader at the end of each pass
+ * over the heap.  See LVRelState for their meaning.
+ */
+typedef struct PHVResults
+{
+	bool		valid;			/* set by the participant, reset by leader */
+
+	BlockNumber scanned_pages;
+	BlockNumber eager_scanned_pages;
+	BlockNumber new_frozen_tuple_pages;
+	BlockNumber new_all_visible_pages;
+	BlockNumber new_all_visible_all_frozen_pages;
+	BlockNumber new_all_frozen_pages;
+	BlockNumber lpdead_item_pages;
+	BlockNumber missed_dead_pages;
+	BlockNumber nonempty_pages;
+	BlockNumber vacuumed_pages; /* # pages vacuumed in the second pass */
+
+	int64		tuples_deleted;
+	int64		tuples_frozen;
+	int64		lpdead_items;
+	int64		live_tuples;
+	int64		recently_dead_tuples;
+	int64		missed_dead_tuples;
+
+	TransactionId NewRelfrozenXid;
+	MultiXactId NewRelminMxid;
+	bool		skippedallvis;
+} PHVResults;
+
+/* Per-participant state of a parallel heap vacuum */
+typedef struct PHVParticipant
+{
+	/*
+	 * Blocks left to scan when the participant stopped scanning, to be
+	 * claimed before any new chunk.  Protected by the mutex of PHVShared.
+	 */
+	BlockNumber pending_start;
+	BlockNumber pending_end;
+
+	PHVResults	results;
+} PHVParticipant;
+
+/*
+ * State of a parallel heap vacuum shared between the leader and the workers,
+ * in the DSM segment of the parallel vacuum.
+ */
+typedef struct PHVShared
+{
+	/* Settings of the vacuum, set by the leader */
+	struct VacuumCutoffs cutoffs;
+	bool		aggressive;
+	bool		skipwithvm;
+	bool		verbose;
+	int			nindexes;
+	BlockNumber rel_pages;
+	BlockNumber eager_scan_max_fails_per_region;
+	BlockNumber eager_scan_max_successes;
+
+	/* End of the first chunk, which ends with the first eager scan region */
+	BlockNumber first_chunk_end;
+
+	/* Number of workers, not counting the leader */
+	int			nworkers;
+
+	/* Pass the workers are launched for, and whether indexes are vacuumed */
+	PHVPhase	phase;
+	bool		do_index_vacuuming;
+
+	/* Next chunk to claim, in the first and in the second pass */
+	pg_atomic_uint32 next_scan_chunk;
+	pg_atomic_uint32 next_vacuum_chunk;
+
+	/* Remaining successful eager freezes before eager scanning is disabled */
+	pg_atomic_uint32 eager_scan_remaining_successes;
+
+	/* Set when the participants are to stop scanning the heap */
+	pg_atomic_uint32 scan_stop;
+
+	/* Protects the pending ranges of the participants */
+	slock_t		mutex;
+
+	/* One per worker, then one for the leader */
+	PHVParticipant participants[FLEXIBLE_ARRAY_MEMBER];
+} PHVShared;
+
 typedef struct LVRelState
 {
 	/* Target heap relation and its indexes */
@@ -260,6 +391,13 @@ typedef struct LVRelState
 	BufferAccessStrategy bstrategy;
 	ParallelVacuumState *pvs;
 
+	/*
+	 * Parallel heap vacuum state, if the heap is processed in parallel, and
+	 * the index of our entry in its participants array.
+	 */
+	PHVShared  *phvs;
+	int			phvs_slot;
+
 	/* Aggressive VACUUM? (must set relfrozenxid >= FreezeLimit) */
 	bool		aggressive;
 	/* Use visibility map to skip? (disabled by DISABLE_PAGE_SKIPPING) */
@@ -347,7 +485,7 @@ typedef struct LVRelState
 
 	/*
 	 * Total number of planned and actually launched parallel workers for
-	 * index vacuuming and index cleanup.
+	 * index vacuuming, index cleanup and processing the heap.
 	 */
 	PVWorkerUsage worker_usage;
 
@@ -359,7 +497,13 @@ typedef struct LVRelState
 	int64		recently_dead_tuples;	/* # dead, but not yet removable */
 	int64		missed_dead_tuples; /* # removable, but not removed */
 
-	/* State maintained by heap_vac_scan_next_block() */
+	/*
+	 * State maintained by heap_vac_scan_next_block().  Only the blocks from
+	 * scan_start to scan_end are scanned: the whole relation in a serial
+	 * vacuum, the range last claimed in a parallel heap vacuum.
+	 */
+	BlockNumber scan_start;
+	BlockNumber scan_end;
 	BlockNumber current_block;	/* last block returned */
 	BlockNumber next_unskippable_block; /* next unskippable block */
 	bool		next_unskippable_eager_scanned; /* if it was eagerly scanned */
@@ -390,6 +534,9 @@ typedef struct LVRelState
 	 */
 	BlockNumber eager_scan_remaining_successes;
 
+	/* Initial eager_scan_remaining_successes (for logging only) */
+	BlockNumber eager_scan_max_successes;
+
 	/*
 	 * The maximum number of blocks which may be eagerly scanned and not
 	 * frozen before eager scanning is temporarily suspended. This is
@@ -421,14 +568,29 @@ typedef struct LVSavedErrInfo
 	VacErrPhase phase;
 } LVSavedErrInfo;
 
+/* State of vacuum_reap_lp_read_stream_next() */
+typedef struct LVReapState
+{
+	TidStoreIter *iter;
+	PHVShared  *phvs;			/* parallel heap vacuum state, or NULL */
+	int64		chunk;			/* last chunk claimed, or -1 */
+} LVReapState;
+
 
 /* non-export function prototypes */
 static void lazy_scan_heap(LVRelState *vacrel);
+static int	lazy_scan_heap_page(LVRelState *vacrel, Buffer buf,
+								bool was_eager_scanned, Buffer *vmbuffer);
+static bool heap_vac_count_eager_success(LVRelState *vacrel);
+static void lazy_scan_heap_parallel(LVRelState *vacrel);
+static void lazy_scan_heap_blocks(LVRelState *vacrel, ReadStream *stream,
+								  Buffer *vmbuffer);
 static void heap_vacuum_eager_scan_setup(LVRelState *vacrel,
 										 const VacuumParams *params);
 static BlockNumber heap_vac_scan_next_block(ReadStream *stream,
 											void *callback_private_data,
 											void *per_buffer_data);
+static bool heap_vac_claim_range(LVRelState *vacrel);
 static void find_next_unskippable_block(LVRelState *vacrel, bool *skipsallvis);
 static bool lazy_scan_new_or_empty(LVRelState *vacrel, Buffer buf,
 								   BlockNumber blkno, Page page,
@@ -443,6 +605,7 @@ static bool lazy_scan_noprune(LVRelState *vacrel, Buffer buf,
 static void lazy_vacuum(LVRelState *vacrel);
 static bool lazy_vacuum_all_indexes(LVRelState *vacrel);
 static void lazy_vacuum_heap_rel(LVRelState *vacrel);
+static BlockNumber lazy_vacuum_heap_blocks(LVRelState *vacrel);
 static void lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno,
 								  Buffer buffer, OffsetNumber *deadoffsets,
 								  int num_offsets, Buffer vmbuffer);
@@ -461,11 +624,16 @@ static bool should_attempt_truncation(LVRelState *vacrel);
 static void lazy_truncate_heap(LVRelState *vacrel);
 static BlockNumber count_nondeletable_pages(LVRelState *vacrel,
 											bool *lock_waiter_detected);
-static void dead_items_alloc(LVRelState *vacrel, int nworkers);
+static void dead_items_alloc(LVRelState *vacrel, int nworkers,
+							 bool parallel_heap);
 static void dead_items_add(LVRelState *vacrel, BlockNumber blkno, OffsetNumber *offsets,
 						   int num_offsets);
 static void dead_items_reset(LVRelState *vacrel);
 static void dead_items_cleanup(LVRelState *vacrel);
+static void parallel_heap_vacuum_init(LVRelState *vacrel);
+static void parallel_heap_vacuum_report_results(LVRelState *vacrel,
+												BlockNumber vacuumed_pages);
+static BlockNumber parallel_heap_vacuum_gather_results(LVRelState *vacrel);
 
 static bool heap_page_would_be_all_visible(Relation rel, Buffer buf,
 										   GlobalVisState *vistest,
@@ -511,6 +679,7 @@ heap_vacuum_eager_scan_setup(LVRelState *vacrel, const VacuumParams *params)
 	vacrel->eager_scan_max_fails_per_region = 0;
 	vacrel->eager_scan_remaining_fails = 0;
 	vacrel->eager_scan_remaining_successes = 0;
+	vacrel->eager_scan_max_successes = 0;
 
 	/* If eager scanning is explicitly disabled, just return. */
 	if (params->max_eager_freeze_failure_rate == 0)
@@ -575,6 +744,8 @@ heap_vacuum_eager_scan_setup(LVRelState *vacrel, const VacuumParams *params)
 		(BlockNumber) (MAX_EAGER_FREEZE_SUCCESS_RATE *
 					   (allvisible - allfrozen));
 
+	vacrel->eager_scan_max_successes = vacrel->eager_scan_remaining_successes;
+
 	/* If every all-visible page is frozen, eager scanning is disabled. */
 	if (vacrel->eager_scan_remaining_successes == 0)
 		return;
@@ -782,6 +953,8 @@ heap_vacuum_rel(Relation rel, const VacuumParams *params,
 	vacrel->worker_usage.vacuum.nplanned = 0;
 	vacrel->worker_usage.cleanup.nlaunched = 0;
 	vacrel->worker_usage.cleanup.nplanned = 0;
+	vacrel->worker_usage.table.nlaunched = 0;
+	vacrel->worker_usage.table.nplanned = 0;
 
 	/*
 	 * Get cutoffs that determine which deleted tuples are considered DEAD,
@@ -861,7 +1034,8 @@ heap_vacuum_rel(Relation rel, const VacuumParams *params,
 	 * is already dangerously old.)
 	 */
 	lazy_check_wraparound_failsafe(vacrel);
-	dead_items_alloc(vacrel, params->nworkers);
+	dead_items_alloc(vacrel, params->nworkers,
+					 (params->options & VACOPT_PARALLEL_HEAP) != 0);
 
 #ifdef USE_INJECTION_POINTS
 
@@ -1149,6 +1323,12 @@ heap_vacuum_rel(Relation rel, const VacuumParams *params,
 								 vacrel->worker_usage.cleanup.nplanned,
 								 vacrel->worker_usage.cleanup.nlaunched);
 
+			if (vacrel->worker_usage.table.nplanned > 0)
+				appendStringInfo(&buf,
+								 _("parallel workers: table processing: %d planned, %d launched in total\n"),
+								 vacrel->worker_usage.table.nplanned,
+								 vacrel->worker_usage.table.nlaunched);
+
 			for (int i = 0; i < vacrel->nindexes; i++)
 			{
 				IndexBulkDeleteResult *istat = vacrel->indstats[i];
@@ -1278,13 +1458,8 @@ heap_vacuum_rel(Relation rel, const VacuumParams *params,
 static void
 lazy_scan_heap(LVRelState *vacrel)
 {
-	ReadStream *stream;
 	BlockNumber rel_pages = vacrel->rel_pages,
-				blkno = 0,
 				next_fsm_block_to_vacuum = 0;
-	BlockNumber orig_eager_scan_success_limit =
-		vacrel->eager_scan_remaining_successes; /* for logging */
-	Buffer		vmbuffer = InvalidBuffer;
 	const int	initprog_index[] = {
 		PROGRESS_VACUUM_PHASE,
 		PROGRESS_VACUUM_TOTAL_HEAP_BLKS,
@@ -1298,267 +1473,125 @@ lazy_scan_heap(LVRelState *vacrel)
 	initprog_val[2] = vacrel->dead_items_info->max_bytes;
 	pgstat_progress_update_multi_param(3, initprog_index, initprog_val);
 
-	/* Initialize for the first heap_vac_scan_next_block() call */
+	/*
+	 * Initialize for the first heap_vac_scan_next_block() call.  A parallel
+	 * heap vacuum has no range of blocks to scan until it claims one.
+	 */
+	vacrel->scan_start = 0;
+	vacrel->scan_end = ParallelHeapVacuumIsActive(vacrel) ? 0 : rel_pages;
 	vacrel->current_block = InvalidBlockNumber;
 	vacrel->next_unskippable_block = InvalidBlockNumber;
 	vacrel->next_unskippable_eager_scanned = false;
 	vacrel->next_unskippable_vmbuffer = InvalidBuffer;
 
-	/*
-	 * Set up the read stream for vacuum's first pass through the heap.
-	 *
-	 * This could be made safe for READ_STREAM_USE_BATCHING, but only with
-	 * explicit work in heap_vac_scan_next_block.
-	 */
-	stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
-										vacrel->bstrategy,
-										vacrel->rel,
-										MAIN_FORKNUM,
-										heap_vac_scan_next_block,
-										vacrel,
-										sizeof(bool));
-
-	while (true)
+	if (ParallelHeapVacuumIsActive(vacrel))
+		lazy_scan_heap_parallel(vacrel);
+	else
 	{
-		Buffer		buf;
-		Page		page;
-		bool		was_eager_scanned = false;
-		int			ndeleted = 0;
-		bool		has_lpdead_items;
-		void	   *per_buffer_data = NULL;
-		bool		vm_page_frozen = false;
-		bool		got_cleanup_lock = false;
-
-		vacuum_delay_point(false);
+		ReadStream *stream;
+		BlockNumber blkno = 0;
+		Buffer		vmbuffer = InvalidBuffer;
 
 		/*
-		 * Regularly check if wraparound failsafe should trigger.
+		 * Set up the read stream for vacuum's first pass through the heap.
 		 *
-		 * There is a similar check inside lazy_vacuum_all_indexes(), but
-		 * relfrozenxid might start to look dangerously old before we reach
-		 * that point.  This check also provides failsafe coverage for the
-		 * one-pass strategy, and the two-pass strategy with the index_cleanup
-		 * param set to 'off'.
+		 * This could be made safe for READ_STREAM_USE_BATCHING, but only with
+		 * explicit work in heap_vac_scan_next_block.
 		 */
-		if (vacrel->scanned_pages > 0 &&
-			vacrel->scanned_pages % FAILSAFE_EVERY_PAGES == 0)
-			lazy_check_wraparound_failsafe(vacrel);
+		stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
+											vacrel->bstrategy,
+											vacrel->rel,
+											MAIN_FORKNUM,
+											heap_vac_scan_next_block,
+											vacrel,
+											sizeof(bool));
 
-		/*
-		 * Consider if we definitely have enough space to process TIDs on page
-		 * already.  If we are close to overrunning the available space for
-		 * dead_items TIDs, pause and do a cycle of vacuuming before we tackle
-		 * this page. However, let's force at least one page-worth of tuples
-		 * to be stored as to ensure we do at least some work when the memory
-		 * configured is so low that we run out before storing anything.
-		 */
-		if (vacrel->dead_items_info->num_items > 0 &&
-			TidStoreMemoryUsage(vacrel->dead_items) > vacrel->dead_items_info->max_bytes)
+		while (true)
 		{
-			/*
-			 * Before beginning index vacuuming, we release any pin we may
-			 * hold on the visibility map page.  This isn't necessary for
-			 * correctness, but we do it anyway to avoid holding the pin
-			 * across a lengthy, unrelated operation.
-			 */
-			if (BufferIsValid(vmbuffer))
-			{
-				ReleaseBuffer(vmbuffer);
-				vmbuffer = InvalidBuffer;
-			}
+			Buffer		buf;
+			void	   *per_buffer_data = NULL;
+			int			ndeleted;
 
-			/* Perform a round of index and heap vacuuming */
-			vacrel->consider_bypass_optimization = false;
-			lazy_vacuum(vacrel);
+			vacuum_delay_point(false);
 
 			/*
-			 * Vacuum the Free Space Map to make newly-freed space visible on
-			 * upper-level FSM pages. Note that blkno is the previously
-			 * processed block.
+			 * Regularly check if wraparound failsafe should trigger.
+			 *
+			 * There is a similar check inside lazy_vacuum_all_indexes(), but
+			 * relfrozenxid might start to look dangerously old before we
+			 * reach that point.  This check also provides failsafe coverage
+			 * for the one-pass strategy, and the two-pass strategy with the
+			 * index_cleanup param set to 'off'.
 			 */
-			FreeSpaceMapVacuumRange(vacrel->rel, next_fsm_block_to_vacuum,
-									blkno + 1);
-			next_fsm_block_to_vacuum = blkno;
-
-			/* Report that we are once again scanning the heap */
-			pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
-										 PROGRESS_VACUUM_PHASE_SCAN_HEAP);
-		}
-
-		buf = read_stream_next_buffer(stream, &per_buffer_data);
-
-		/* The relation is exhausted. */
-		if (!BufferIsValid(buf))
-			break;
-
-		was_eager_scanned = *((bool *) per_buffer_data);
-		CheckBufferIsPinnedOnce(buf);
-		page = BufferGetPage(buf);
-		blkno = BufferGetBlockNumber(buf);
+			if (vacrel->scanned_pages > 0 &&
+				vacrel->scanned_pages % FAILSAFE_EVERY_PAGES == 0)
+				lazy_check_wraparound_failsafe(vacrel);
 
-		vacrel->scanned_pages++;
-		if (was_eager_scanned)
-			vacrel->eager_scanned_pages++;
-
-		/* Report as block scanned, update error traceback information */
-		pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED, blkno);
-		update_vacuum_error_info(vacrel, NULL, VACUUM_ERRCB_PHASE_SCAN_HEAP,
-								 blkno, InvalidOffsetNumber);
-
-		/*
-		 * Pin the visibility map page in case we need to mark the page
-		 * all-visible.  In most cases this will be very cheap, because we'll
-		 * already have the correct page pinned anyway.
-		 */
-		visibilitymap_pin(vacrel->rel, blkno, &vmbuffer);
-
-		/*
-		 * We need a buffer cleanup lock to prune HOT chains and defragment
-		 * the page in lazy_scan_prune.  But when it's not possible to acquire
-		 * a cleanup lock right away, we may be able to settle for reduced
-		 * processing using lazy_scan_noprune.
-		 */
-		got_cleanup_lock = ConditionalLockBufferForCleanup(buf);
-
-		if (!got_cleanup_lock)
-			LockBuffer(buf, BUFFER_LOCK_SHARE);
-
-		/* Check for new or empty pages before lazy_scan_[no]prune call */
-		if (lazy_scan_new_or_empty(vacrel, buf, blkno, page, !got_cleanup_lock,
-								   vmbuffer))
-		{
-			/* Processed as new/empty page (lock and pin released) */
-			continue;
-		}
-
-		/*
-		 * If we didn't get the cleanup lock, we can still collect LP_DEAD
-		 * items in the dead_items area for later vacuuming, count live and
-		 * recently dead tuples for vacuum logging, and determine if this
-		 * block could later be truncated. If we encounter any xid/mxids that
-		 * require advancing the relfrozenxid/relminxid, we'll have to wait
-		 * for a cleanup lock and call lazy_scan_prune().
-		 */
-		if (!got_cleanup_lock &&
-			!lazy_scan_noprune(vacrel, buf, blkno, page, &has_lpdead_items))
-		{
 			/*
-			 * lazy_scan_noprune could not do all required processing.  Wait
-			 * for a cleanup lock, and call lazy_scan_prune in the usual way.
+			 * Consider if we definitely have enough space to process TIDs on
+			 * page already.  If we are close to overrunning the available
+			 * space for dead_items TIDs, pause and do a cycle of vacuuming
+			 * before we tackle this page. However, let's force at least one
+			 * page-worth of tuples to be stored as to ensure we do at least
+			 * some work when the memory configured is so low that we run out
+			 * before storing anything.
 			 */
-			Assert(vacrel->aggressive);
-			LockBuffer(buf, BUFFER_LOCK_UNLOCK);
-			LockBufferForCleanup(buf);
-			got_cleanup_lock = true;
-		}
+			if (vacrel->dead_items_info->num_items > 0 &&
+				TidStoreMemoryUsage(vacrel->dead_items) > vacrel->dead_items_info->max_bytes)
+			{
+				/*
+				 * Before beginning index vacuuming, we release any pin we may
+				 * hold on the visibility map page.  This isn't necessary for
+				 * correctness, but we do it anyway to avoid holding the pin
+				 * across a lengthy, unrelated operation.
+				 */
+				if (BufferIsValid(vmbuffer))
+				{
+					ReleaseBuffer(vmbuffer);
+					vmbuffer = InvalidBuffer;
+				}
 
-		/*
-		 * If we have a cleanup lock, we must now prune, freeze, and count
-		 * tuples. We may have acquired the cleanup lock originally, or we may
-		 * have gone back and acquired it after lazy_scan_noprune() returned
-		 * false. Either way, the page hasn't been processed yet.
-		 *
-		 * Like lazy_scan_noprune(), lazy_scan_prune() will count
-		 * recently_dead_tuples and live tuples for vacuum logging, determine
-		 * if the block can later be truncated, and accumulate the details of
-		 * remaining LP_DEAD line pointers on the page into dead_items. These
-		 * dead items include those pruned by lazy_scan_prune() as well as
-		 * line pointers previously marked LP_DEAD.
-		 */
-		if (got_cleanup_lock)
-			ndeleted = lazy_scan_prune(vacrel, buf, blkno, page,
-									   vmbuffer,
-									   &has_lpdead_items, &vm_page_frozen);
+				/* Perform a round of index and heap vacuuming */
+				vacrel->consider_bypass_optimization = false;
+				lazy_vacuum(vacrel);
 
-		/*
-		 * Count an eagerly scanned page as a failure or a success.
-		 *
-		 * Only lazy_scan_prune() freezes pages, so if we didn't get the
-		 * cleanup lock, we won't have frozen the page. However, we only count
-		 * pages that were too new to require freezing as eager freeze
-		 * failures.
-		 *
-		 * We could gather more information from lazy_scan_noprune() about
-		 * whether or not there were tuples with XIDs or MXIDs older than the
-		 * FreezeLimit or MultiXactCutoff. However, for simplicity, we simply
-		 * exclude pages skipped due to cleanup lock contention from eager
-		 * freeze algorithm caps.
-		 */
-		if (got_cleanup_lock && was_eager_scanned)
-		{
-			/* Aggressive vacuums do not eager scan. */
-			Assert(!vacrel->aggressive);
+				/*
+				 * Vacuum the Free Space Map to make newly-freed space visible
+				 * on upper-level FSM pages. Note that blkno is the previously
+				 * processed block.
+				 */
+				FreeSpaceMapVacuumRange(vacrel->rel, next_fsm_block_to_vacuum,
+										blkno + 1);
+				next_fsm_block_to_vacuum = blkno;
 
-			if (vm_page_frozen)
-			{
-				if (vacrel->eager_scan_remaining_successes > 0)
-					vacrel->eager_scan_remaining_successes--;
+				/* Report that we are once again scanning the heap */
+				pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
+											 PROGRESS_VACUUM_PHASE_SCAN_HEAP);
+			}
 
-				if (vacrel->eager_scan_remaining_successes == 0)
-				{
-					/*
-					 * Report only once that we disabled eager scanning. We
-					 * may eagerly read ahead blocks in excess of the success
-					 * or failure caps before attempting to freeze them, so we
-					 * could reach here even after disabling additional eager
-					 * scanning.
-					 */
-					if (vacrel->eager_scan_max_fails_per_region > 0)
-						ereport(vacrel->verbose ? INFO : DEBUG2,
-								(errmsg("disabling eager scanning after freezing %u eagerly scanned blocks of relation \"%s.%s.%s\"",
-										orig_eager_scan_success_limit,
-										vacrel->dbname, vacrel->relnamespace,
-										vacrel->relname)));
+			buf = read_stream_next_buffer(stream, &per_buffer_data);
 
-					/*
-					 * If we hit our success cap, permanently disable eager
-					 * scanning by setting the other eager scan management
-					 * fields to their disabled values.
-					 */
-					vacrel->eager_scan_remaining_fails = 0;
-					vacrel->next_eager_scan_region_start = InvalidBlockNumber;
-					vacrel->eager_scan_max_fails_per_region = 0;
-				}
-			}
-			else if (vacrel->eager_scan_remaining_fails > 0)
-				vacrel->eager_scan_remaining_fails--;
-		}
+			/* The relation is exhausted. */
+			if (!BufferIsValid(buf))
+				break;
 
-		/*
-		 * Now drop the buffer lock and, potentially, update the FSM.
-		 *
-		 * Our goal is to update the freespace map the last time we touch the
-		 * page. If we'll process a block in the second pass, we may free up
-		 * additional space on the page, so it is better to update the FSM
-		 * after the second pass. If the relation has no indexes, or if index
-		 * vacuuming is disabled, there will be no second heap pass; if this
-		 * particular page has no dead items, the second heap pass will not
-		 * touch this page. So, in those cases, update the FSM now.
-		 *
-		 * Note: In corner cases, it's possible to miss updating the FSM
-		 * entirely. If index vacuuming is currently enabled, we'll skip the
-		 * FSM update now. But if failsafe mode is later activated, or there
-		 * are so few dead tuples that index vacuuming is bypassed, there will
-		 * also be no opportunity to update the FSM later, because we'll never
-		 * revisit this page. Since updating the FSM is desirable but not
-		 * absolutely required, that's OK.
-		 */
-		if (vacrel->nindexes == 0
-			|| !vacrel->do_index_vacuuming
-			|| !has_lpdead_items)
-		{
-			Size		freespace = PageGetHeapFreeSpace(page);
+			blkno = BufferGetBlockNumber(buf);
 
-			UnlockReleaseBuffer(buf);
-			RecordPageWithFreeSpace(vacrel->rel, blkno, freespace);
+			/* Report as block scanned */
+			pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED,
+										 blkno);
+
+			ndeleted = lazy_scan_heap_page(vacrel, buf,
+										   *((bool *) per_buffer_data),
+										   &vmbuffer);
 
 			/*
 			 * Periodically perform FSM vacuuming to make newly-freed space
 			 * visible on upper FSM pages. This is done after vacuuming if the
-			 * table has indexes. There will only be newly-freed space if we
-			 * held the cleanup lock and lazy_scan_prune() was called.
+			 * table has indexes. There will only be newly-freed space if
+			 * lazy_scan_prune() deleted tuples.
 			 */
-			if (got_cleanup_lock && vacrel->nindexes == 0 && ndeleted > 0 &&
+			if (vacrel->nindexes == 0 && ndeleted > 0 &&
 				blkno - next_fsm_block_to_vacuum >= VACUUM_FSM_EVERY_PAGES)
 			{
 				FreeSpaceMapVacuumRange(vacrel->rel, next_fsm_block_to_vacuum,
@@ -1566,13 +1599,14 @@ lazy_scan_heap(LVRelState *vacrel)
 				next_fsm_block_to_vacuum = blkno;
 			}
 		}
-		else
-			UnlockReleaseBuffer(buf);
+
+		read_stream_end(stream);
+
+		if (BufferIsValid(vmbuffer))
+			ReleaseBuffer(vmbuffer);
 	}
 
 	vacrel->blkno = InvalidBlockNumber;
-	if (BufferIsValid(vmbuffer))
-		ReleaseBuffer(vmbuffer);
 
 	/*
 	 * Report that everything is now scanned. We never skip scanning the last
@@ -1594,30 +1628,368 @@ lazy_scan_heap(LVRelState *vacrel)
 		Max(vacrel->new_live_tuples, 0) + vacrel->recently_dead_tuples +
 		vacrel->missed_dead_tuples;
 
-	read_stream_end(stream);
+	/*
+	 * Do index vacuuming (call each index's ambulkdelete routine), then do
+	 * related heap vacuuming
+	 */
+	if (vacrel->dead_items_info->num_items > 0)
+		lazy_vacuum(vacrel);
+
+	/*
+	 * Vacuum the remainder of the Free Space Map.  We must do this whether or
+	 * not there were indexes, and whether or not we bypassed index vacuuming.
+	 * We can pass rel_pages here because we never skip scanning the last
+	 * block of the relation.
+	 */
+	if (rel_pages > next_fsm_block_to_vacuum)
+		FreeSpaceMapVacuumRange(vacrel->rel, next_fsm_block_to_vacuum, rel_pages);
+
+	/* report all blocks vacuumed */
+	pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_VACUUMED, rel_pages);
+
+	/* Do final index cleanup (call each index's amvacuumcleanup routine) */
+	if (vacrel->nindexes > 0 && vacrel->do_index_cleanup)
+		lazy_cleanup_all_indexes(vacrel);
+}
+
+/*
+ *	lazy_scan_heap_page() -- process one page during the first heap pass
+ *
+ * buf is the page's buffer as returned by the read stream, pinned but not
+ * locked, and was_eager_scanned tells if the page was eagerly scanned.
+ * *vmbuffer caches a pin on a visibility map page across calls.  Releases the
+ * buffer on return.
+ *
+ * Returns the number of tuples deleted from the page by pruning.
+ */
+static int
+lazy_scan_heap_page(LVRelState *vacrel, Buffer buf, bool was_eager_scanned,
+					Buffer *vmbuffer)
+{
+	Page		page;
+	BlockNumber blkno;
+	int			ndeleted = 0;
+	bool		has_lpdead_items;
+	bool		vm_page_frozen = false;
+	bool		got_cleanup_lock = false;
+
+	CheckBufferIsPinnedOnce(buf);
+	page = BufferGetPage(buf);
+	blkno = BufferGetBlockNumber(buf);
+
+	vacrel->scanned_pages++;
+	if (was_eager_scanned)
+		vacrel->eager_scanned_pages++;
+
+	/* Update error traceback information */
+	update_vacuum_error_info(vacrel, NULL, VACUUM_ERRCB_PHASE_SCAN_HEAP,
+							 blkno, InvalidOffsetNumber);
+
+	/*
+	 * Pin the visibility map page in case we need to mark the page
+	 * all-visible.  In most cases this will be very cheap, because we'll
+	 * already have the correct page pinned anyway.
+	 */
+	visibilitymap_pin(vacrel->rel, blkno, vmbuffer);
+
+	/*
+	 * We need a buffer cleanup lock to prune HOT chains and defragment the
+	 * page in lazy_scan_prune.  But when it's not possible to acquire a
+	 * cleanup lock right away, we may be able to settle for reduced
+	 * processing using lazy_scan_noprune.
+	 */
+	got_cleanup_lock = ConditionalLockBufferForCleanup(buf);
+
+	if (!got_cleanup_lock)
+		LockBuffer(buf, BUFFER_LOCK_SHARE);
+
+	/* Check for new or empty pages before lazy_scan_[no]prune call */
+	if (lazy_scan_new_or_empty(vacrel, buf, blkno, page, !got_cleanup_lock,
+							   *vmbuffer))
+	{
+		/* Processed as new/empty page (lock and pin released) */
+		return 0;
+	}
+
+	/*
+	 * If we didn't get the cleanup lock, we can still collect LP_DEAD items
+	 * in the dead_items area for later vacuuming, count live and recently
+	 * dead tuples for vacuum logging, and determine if this block could
+	 * later be truncated. If we encounter any xid/mxids that require
+	 * advancing the relfrozenxid/relminxid, we'll have to wait for a cleanup
+	 * lock and call lazy_scan_prune().
+	 */
+	if (!got_cleanup_lock &&
+		!lazy_scan_noprune(vacrel, buf, blkno, page, &has_lpdead_items))
+	{
+		/*
+		 * lazy_scan_noprune could not do all required processing.  Wait for a
+		 * cleanup lock, and call lazy_scan_prune in the usual way.
+		 */
+		Assert(vacrel->aggressive);
+		LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+		LockBufferForCleanup(buf);
+		got_cleanup_lock = true;
+	}
+
+	/*
+	 * If we have a cleanup lock, we must now prune, freeze, and count
+	 * tuples. We may have acquired the cleanup lock originally, or we may
+	 * have gone back and acquired it after lazy_scan_noprune() returned
+	 * false. Either way, the page hasn't been processed yet.
+	 *
+	 * Like lazy_scan_noprune(), lazy_scan_prune() will count
+	 * recently_dead_tuples and live tuples for vacuum logging, determine if
+	 * the block can later be truncated, and accumulate the details of
+	 * remaining LP_DEAD line pointers on the page into dead_items. These dead
+	 * items include those pruned by lazy_scan_prune() as well as line
+	 * pointers previously marked LP_DEAD.
+	 */
+	if (got_cleanup_lock)
+		ndeleted = lazy_scan_prune(vacrel, buf, blkno, page,
+								   *vmbuffer,
+								   &has_lpdead_items, &vm_page_frozen);
+
+	/*
+	 * Count an eagerly scanned page as a failure or a success.
+	 *
+	 * Only lazy_scan_prune() freezes pages, so if we didn't get the cleanup
+	 * lock, we won't have frozen the page. However, we only count pages that
+	 * were too new to require freezing as eager freeze failures.
+	 *
+	 * We could gather more information from lazy_scan_noprune() about
+	 * whether or not there were tuples with XIDs or MXIDs older than the
+	 * FreezeLimit or MultiXactCutoff. However, for simplicity, we simply
+	 * exclude pages skipped due to cleanup lock contention from eager freeze
+	 * algorithm caps.
+	 */
+	if (got_cleanup_lock && was_eager_scanned)
+	{
+		/* Aggressive vacuums do not eager scan. */
+		Assert(!vacrel->aggressive);
+
+		if (vm_page_frozen)
+		{
+			if (heap_vac_count_eager_success(vacrel))
+			{
+				/*
+				 * Report only once that we disabled eager scanning. We may
+				 * eagerly read ahead blocks in excess of the success or
+				 * failure caps before attempting to freeze them, so we could
+				 * reach here even after disabling additional eager scanning.
+				 */
+				if (vacrel->eager_scan_max_fails_per_region > 0)
+					ereport(vacrel->verbose ? INFO : DEBUG2,
+							(errmsg("disabling eager scanning after freezing %u eagerly scanned blocks of relation \"%s.%s.%s\"",
+									vacrel->eager_scan_max_successes,
+									vacrel->dbname, vacrel->relnamespace,
+									vacrel->relname)));
+
+				/*
+				 * If we hit our success cap, permanently disable eager
+				 * scanning by setting the other eager scan management fields
+				 * to their disabled values.
+				 */
+				vacrel->eager_scan_remaining_fails = 0;
+				vacrel->next_eager_scan_region_start = InvalidBlockNumber;
+				vacrel->eager_scan_max_fails_per_region = 0;
+			}
+		}
+		else if (vacrel->eager_scan_remaining_fails > 0)
+			vacrel->eager_scan_remaining_fails--;
+	}
+
+	/*
+	 * Now drop the buffer lock and, potentially, update the FSM.
+	 *
+	 * Our goal is to update the freespace map the last time we touch the
+	 * page. If we'll process a block in the second pass, we may free up
+	 * additional space on the page, so it is better to update the FSM after
+	 * the second pass. If the relation has no indexes, or if index vacuuming
+	 * is disabled, there will be no second heap pass; if this particular page
+	 * has no dead items, the second heap pass will not touch this page. So,
+	 * in those cases, update the FSM now.
+	 *
+	 * Note: In corner cases, it's possible to miss updating the FSM entirely.
+	 * If index vacuuming is currently enabled, we'll skip the FSM update now.
+	 * But if failsafe mode is later activated, or there are so few dead
+	 * tuples that index vacuuming is bypassed, there will also be no
+	 * opportunity to update the FSM later, because we'll never revisit this
+	 * page. Since updating the FSM is desirable but not absolutely required,
+	 * that's OK.
+	 */
+	if (vacrel->nindexes == 0
+		|| !vacrel->do_index_vacuuming
+		|| !has_lpdead_items)
+	{
+		Size		freespace = PageGetHeapFreeSpace(page);
+
+		UnlockReleaseBuffer(buf);
+		RecordPageWithFreeSpace(vacrel->rel, blkno, freespace);
+	}
+	else
+		UnlockReleaseBuffer(buf);
+
+	return ndeleted;
+}
+
+/*
+ * Count an eagerly scanned page that was set all-frozen in the VM against the
+ * cap on successful eager freezes.  Returns true if the cap is reached.
+ *
+ * In a parallel heap vacuum, the cap is shared by all the participants.  Only
+ * the one that reaches it reports that eager scanning is disabled: the others
+ * find eager scanning disabled as if they had reported it already.
+ */
+static bool
+heap_vac_count_eager_success(LVRelState *vacrel)
+{
+	if (ParallelHeapVacuumIsActive(vacrel))
+	{
+		pg_atomic_uint32 *remaining =
+			&vacrel->phvs->eager_scan_remaining_successes;
+		uint32		oldval = pg_atomic_read_u32(remaining);
+
+		while (oldval > 0)
+		{
+			if (pg_atomic_compare_exchange_u32(remaining, &oldval, oldval - 1))
+				break;
+		}
+
+		if (oldval == 0)
+			vacrel->eager_scan_max_fails_per_region = 0;
+		vacrel->eager_scan_remaining_successes = oldval > 0 ? oldval - 1 : 0;
+	}
+	else if (vacrel->eager_scan_remaining_successes > 0)
+		vacrel->eager_scan_remaining_successes--;
+
+	return vacrel->eager_scan_remaining_successes == 0;
+}
+
+/*
+ *	lazy_scan_heap_parallel() -- first heap pass of a parallel heap vacuum
+ *
+ * The leader launches workers to scan the heap along with it, until the whole
+ * relation is scanned.  Whenever the TID store fills up, the participants
+ * stop scanning, and the leader does a round of index and heap vacuuming
+ * before launching workers again.  See "Parallel heap vacuum" above.
+ */
+static void
+lazy_scan_heap_parallel(LVRelState *vacrel)
+{
+	PHVShared  *shared = vacrel->phvs;
+	ReadStream *stream;
+	Buffer		vmbuffer = InvalidBuffer;
+
+	pg_atomic_write_u32(&shared->next_scan_chunk, 0);
+	pg_atomic_write_u32(&shared->scan_stop, 0);
+
+	stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
+										vacrel->bstrategy,
+										vacrel->rel,
+										MAIN_FORKNUM,
+										heap_vac_scan_next_block,
+										vacrel,
+										sizeof(bool));
+
+	for (;;)
+	{
+		/* Scan the heap along with the workers */
+		shared->phase = PHV_PHASE_SCAN_HEAP;
+		shared->do_index_vacuuming = vacrel->do_index_vacuuming;
+		parallel_vacuum_table_begin(vacrel->pvs, &vacrel->worker_usage.table);
+		lazy_scan_heap_blocks(vacrel, stream, &vmbuffer);
+		parallel_vacuum_table_end(vacrel->pvs);
+		(void) parallel_heap_vacuum_gather_results(vacrel);
+
+		/* Done once the participants ran out of blocks to scan */
+		if (pg_atomic_read_u32(&shared->scan_stop) == 0)
+			break;
+
+		/*
+		 * The TID store is full.  Release the pin on the visibility map page
+		 * (see lazy_scan_heap()), and perform a round of index and heap
+		 * vacuuming.
+		 */
+		if (BufferIsValid(vmbuffer))
+		{
+			ReleaseBuffer(vmbuffer);
+			vmbuffer = InvalidBuffer;
+		}
+
+		vacrel->consider_bypass_optimization = false;
+		lazy_vacuum(vacrel);
+
+		/*
+		 * Vacuum the Free Space Map to make newly-freed space visible on
+		 * upper-level FSM pages.  The chunks are scanned in no particular
+		 * order, so do it for the whole relation.
+		 */
+		FreeSpaceMapVacuumRange(vacrel->rel, 0, vacrel->rel_pages);
+
+		/* Report that we are once again scanning the heap */
+		pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
+									 PROGRESS_VACUUM_PHASE_SCAN_HEAP);
+
+		/* Resume scanning where the participants stopped */
+		pg_atomic_write_u32(&shared->scan_stop, 0);
+		read_stream_reset(stream);
+	}
+
+	read_stream_end(stream);
+
+	if (BufferIsValid(vmbuffer))
+		ReleaseBuffer(vmbuffer);
+}
+
+/*
+ *	lazy_scan_heap_blocks() -- scan blocks as a participant of a parallel
+ *	heap vacuum
+ *
+ * Processes the blocks of the ranges claimed by heap_vac_scan_next_block()
+ * until the participants run out of blocks to scan, or are to stop scanning
+ * because the TID store is full.  Used by the leader and the workers alike.
+ */
+static void
+lazy_scan_heap_blocks(LVRelState *vacrel, ReadStream *stream,
+					  Buffer *vmbuffer)
+{
+	while (true)
+	{
+		Buffer		buf;
+		void	   *per_buffer_data = NULL;
+
+		vacuum_delay_point(false);
+
+		/*
+		 * Regularly check if wraparound failsafe should trigger, as in
+		 * lazy_scan_heap().  The leader does that for all participants.
+		 */
+		if (!IsParallelWorker() &&
+			vacrel->scanned_pages > 0 &&
+			vacrel->scanned_pages % FAILSAFE_EVERY_PAGES == 0)
+			lazy_check_wraparound_failsafe(vacrel);
+
+		/*
+		 * If the TID store is full, have all participants stop scanning, so
+		 * that the leader can do a round of vacuuming.  As in
+		 * lazy_scan_heap(), let's store at least one page-worth of tuples.
+		 */
+		if (vacrel->dead_items_info->num_items > 0 &&
+			TidStoreMemoryUsage(vacrel->dead_items) > vacrel->dead_items_info->max_bytes)
+			pg_atomic_write_u32(&vacrel->phvs->scan_stop, 1);
 
-	/*
-	 * Do index vacuuming (call each index's ambulkdelete routine), then do
-	 * related heap vacuuming
-	 */
-	if (vacrel->dead_items_info->num_items > 0)
-		lazy_vacuum(vacrel);
+		buf = read_stream_next_buffer(stream, &per_buffer_data);
 
-	/*
-	 * Vacuum the remainder of the Free Space Map.  We must do this whether or
-	 * not there were indexes, and whether or not we bypassed index vacuuming.
-	 * We can pass rel_pages here because we never skip scanning the last
-	 * block of the relation.
-	 */
-	if (rel_pages > next_fsm_block_to_vacuum)
-		FreeSpaceMapVacuumRange(vacrel->rel, next_fsm_block_to_vacuum, rel_pages);
+		/* No more blocks to scan for now */
+		if (!BufferIsValid(buf))
+			break;
 
-	/* report all blocks vacuumed */
-	pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_VACUUMED, rel_pages);
+		(void) lazy_scan_heap_page(vacrel, buf, *((bool *) per_buffer_data),
+								   vmbuffer);
+	}
 
-	/* Do final index cleanup (call each index's amvacuumcleanup routine) */
-	if (vacrel->nindexes > 0 && vacrel->do_index_cleanup)
-		lazy_cleanup_all_indexes(vacrel);
+	vacrel->blkno = InvalidBlockNumber;
 }
 
 /*
@@ -1643,6 +2015,10 @@ lazy_scan_heap(LVRelState *vacrel)
  * that's all-visible but not all-frozen (to ensure that we don't update
  * relfrozenxid in that case). vacrel also holds information about the next
  * unskippable block -- as bookkeeping for this function.
+ *
+ * In a parallel heap vacuum, only the blocks of the ranges claimed by this
+ * participant are returned, and InvalidBlockNumber is also returned when the
+ * participants are to stop scanning.
  */
 static BlockNumber
 heap_vac_scan_next_block(ReadStream *stream,
@@ -1652,18 +2028,45 @@ heap_vac_scan_next_block(ReadStream *stream,
 	BlockNumber next_block;
 	LVRelState *vacrel = callback_private_data;
 
+retry:
 	/* relies on InvalidBlockNumber + 1 overflowing to 0 on first call */
 	next_block = vacrel->current_block + 1;
 
-	/* Have we reached the end of the relation? */
-	if (next_block >= vacrel->rel_pages)
+	/* Have we reached the end of the range to scan? */
+	while (next_block >= vacrel->scan_end ||
+		   (ParallelHeapVacuumIsActive(vacrel) &&
+			pg_atomic_read_u32(&vacrel->phvs->scan_stop) != 0))
 	{
-		if (BufferIsValid(vacrel->next_unskippable_vmbuffer))
+		/*
+		 * Stop scanning if asked to, leaving the rest of the range for when
+		 * the scan resumes.
+		 */
+		if (next_block < vacrel->scan_end)
+		{
+			PHVParticipant *participant =
+				&vacrel->phvs->participants[vacrel->phvs_slot];
+
+			SpinLockAcquire(&vacrel->phvs->mutex);
+			Assert(participant->pending_end == participant->pending_start);
+			participant->pending_start = next_block;
+			participant->pending_end = vacrel->scan_end;
+			SpinLockRelease(&vacrel->phvs->mutex);
+
+			vacrel->scan_end = next_block;
+		}
+
+		if (!ParallelHeapVacuumIsActive(vacrel) ||
+			!heap_vac_claim_range(vacrel))
 		{
-			ReleaseBuffer(vacrel->next_unskippable_vmbuffer);
-			vacrel->next_unskippable_vmbuffer = InvalidBuffer;
+			if (BufferIsValid(vacrel->next_unskippable_vmbuffer))
+			{
+				ReleaseBuffer(vacrel->next_unskippable_vmbuffer);
+				vacrel->next_unskippable_vmbuffer = InvalidBuffer;
+			}
+			return InvalidBlockNumber;
 		}
-		return InvalidBlockNumber;
+
+		next_block = vacrel->current_block + 1;
 	}
 
 	/*
@@ -1701,6 +2104,17 @@ heap_vac_scan_next_block(ReadStream *stream,
 			next_block = vacrel->next_unskippable_block;
 			if (skipsallvis)
 				vacrel->skippedallvis = true;
+
+			/*
+			 * In a parallel heap vacuum, the rest of the range may be
+			 * skipped: claim another one.
+			 */
+			if (next_block >= vacrel->scan_end)
+			{
+				Assert(ParallelHeapVacuumIsActive(vacrel));
+				vacrel->current_block = vacrel->scan_end - 1;
+				goto retry;
+			}
 		}
 	}
 
@@ -1731,6 +2145,92 @@ heap_vac_scan_next_block(ReadStream *stream,
 	}
 }
 
+/*
+ * Claim the next range of blocks to scan in a parallel heap vacuum, and set
+ * up vacrel for heap_vac_scan_next_block() to scan it.  The ranges left over
+ * by participants that stopped scanning are claimed first, starting with our
+ * own, then the next chunk of the relation.
+ *
+ * Returns false if there are no more blocks to scan, or if the participants
+ * are to stop scanning.
+ */
+static bool
+heap_vac_claim_range(LVRelState *vacrel)
+{
+	PHVShared  *shared = vacrel->phvs;
+	int			nparticipants = shared->nworkers + 1;
+	BlockNumber start = InvalidBlockNumber;
+	BlockNumber end = InvalidBlockNumber;
+
+	/* Report the blocks of the previous range as scanned */
+	if (vacrel->scan_end > vacrel->scan_start)
+		pgstat_progress_parallel_incr_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED,
+											vacrel->scan_end - vacrel->scan_start);
+	vacrel->scan_start = vacrel->scan_end;
+
+	if (pg_atomic_read_u32(&shared->scan_stop) != 0)
+		return false;
+
+	SpinLockAcquire(&shared->mutex);
+	for (int i = 0; i < nparticipants; i++)
+	{
+		PHVParticipant *participant =
+			&shared->participants[(vacrel->phvs_slot + i) % nparticipants];
+
+		if (participant->pending_end > participant->pending_start)
+		{
+			start = participant->pending_start;
+			end = participant->pending_end;
+			participant->pending_start = participant->pending_end = 0;
+			break;
+		}
+	}
+	SpinLockRelease(&shared->mutex);
+
+	if (start == InvalidBlockNumber)
+	{
+		uint64		chunk = pg_atomic_fetch_add_u32(&shared->next_scan_chunk, 1);
+		uint64		chunk_end;
+
+		/* The first chunk may be smaller than the others, see PHVShared */
+		chunk_end = shared->first_chunk_end + chunk * PARALLEL_VACUUM_CHUNK_SIZE;
+		if (chunk > 0 &&
+			chunk_end - PARALLEL_VACUUM_CHUNK_SIZE >= vacrel->rel_pages)
+			return false;
+
+		start = chunk > 0 ? chunk_end - PARALLEL_VACUUM_CHUNK_SIZE : 0;
+		end = Min(chunk_end, vacrel->rel_pages);
+	}
+
+	vacrel->scan_start = start;
+	vacrel->scan_end = end;
+	vacrel->current_block = start - 1;
+	vacrel->next_unskippable_block = start - 1;
+	vacrel->next_unskippable_eager_scanned = false;
+
+	/*
+	 * The range lies within a single eager scan region.  Unless the success
+	 * cap was reached, tolerate the share of the region's failures that falls
+	 * in the range.
+	 */
+	if (vacrel->eager_scan_max_fails_per_region > 0 &&
+		pg_atomic_read_u32(&shared->eager_scan_remaining_successes) > 0)
+	{
+		vacrel->eager_scan_remaining_fails =
+			(uint64) vacrel->eager_scan_max_fails_per_region * (end - start) /
+			EAGER_SCAN_REGION_SIZE;
+		vacrel->next_eager_scan_region_start = end;
+	}
+	else
+	{
+		vacrel->eager_scan_remaining_fails = 0;
+		vacrel->next_eager_scan_region_start = InvalidBlockNumber;
+		vacrel->eager_scan_max_fails_per_region = 0;
+	}
+
+	return true;
+}
+
 /*
  * Find the next unskippable block in a vacuum scan using the visibility map.
  * The next unskippable block and its visibility information is updated in
@@ -1756,10 +2256,18 @@ find_next_unskippable_block(LVRelState *vacrel, bool *skipsallvis)
 
 	for (;; next_unskippable_block++)
 	{
-		uint8		mapbits = visibilitymap_get_status(vacrel->rel,
-													   next_unskippable_block,
-													   &next_unskippable_vmbuffer);
+		uint8		mapbits;
+
+		/*
+		 * In a parallel heap vacuum, the range to scan may end before the
+		 * relation does.  Caller then claims another range.
+		 */
+		if (next_unskippable_block >= vacrel->scan_end)
+			break;
 
+		mapbits = visibilitymap_get_status(vacrel->rel,
+										   next_unskippable_block,
+										   &next_unskippable_vmbuffer);
 
 		/*
 		 * At the start of each eager scan region, normal vacuums with eager
@@ -2126,7 +2634,7 @@ lazy_scan_prune(LVRelState *vacrel,
 
 	/* Can't truncate this page */
 	if (presult.hastup)
-		vacrel->nonempty_pages = blkno + 1;
+		vacrel->nonempty_pages = Max(vacrel->nonempty_pages, blkno + 1);
 
 	/* Did we find LP_DEAD items? */
 	*has_lpdead_items = (presult.lpdead_items > 0);
@@ -2343,7 +2851,7 @@ lazy_scan_noprune(LVRelState *vacrel,
 
 	/* Can't truncate this page */
 	if (hastup)
-		vacrel->nonempty_pages = blkno + 1;
+		vacrel->nonempty_pages = Max(vacrel->nonempty_pages, blkno + 1);
 
 	/* Did we find LP_DEAD items? */
 	*has_lpdead_items = (lpdead_items > 0);
@@ -2596,6 +3104,14 @@ lazy_vacuum_all_indexes(LVRelState *vacrel)
  * Gets the next block from the TID store and returns it or InvalidBlockNumber
  * if there are no further blocks to vacuum.
  *
+ * In a parallel heap vacuum, every participant iterates over the whole TID
+ * store, but only returns the blocks of the chunks it claims.  As the
+ * iteration returns blocks in increasing order, a participant that reaches
+ * a chunk past the one it holds claims chunks until it holds that chunk or a
+ * later one.  The chunks it skips while doing so have no dead items (or it
+ * would have claimed them when reaching their blocks), so every chunk with
+ * dead items is processed by exactly one participant.
+ *
  * NB: Assumed to be safe to use with READ_STREAM_USE_BATCHING.
  */
 static BlockNumber
@@ -2603,20 +3119,34 @@ vacuum_reap_lp_read_stream_next(ReadStream *stream,
 								void *callback_private_data,
 								void *per_buffer_data)
 {
-	TidStoreIter *iter = callback_private_data;
+	LVReapState *reap = callback_private_data;
 	TidStoreIterResult *iter_result;
 
-	iter_result = TidStoreIterateNext(iter);
-	if (iter_result == NULL)
-		return InvalidBlockNumber;
+	while ((iter_result = TidStoreIterateNext(reap->iter)) != NULL)
+	{
+		if (reap->phvs != NULL)
+		{
+			int64		chunk = iter_result->blkno / PARALLEL_VACUUM_CHUNK_SIZE;
+
+			while (reap->chunk < chunk)
+				reap->chunk = pg_atomic_fetch_add_u32(&reap->phvs->next_vacuum_chunk, 1);
 
-	/*
-	 * Save the TidStoreIterResult for later, so we can extract the offsets.
-	 * It is safe to copy the result, according to TidStoreIterateNext().
-	 */
-	memcpy(per_buffer_data, iter_result, sizeof(*iter_result));
+			/* Skip the blocks of chunks claimed by other participants */
+			if (reap->chunk != chunk)
+				continue;
+		}
+
+		/*
+		 * Save the TidStoreIterResult for later, so we can extract the
+		 * offsets. It is safe to copy the result, according to
+		 * TidStoreIterateNext().
+		 */
+		memcpy(per_buffer_data, iter_result, sizeof(*iter_result));
+
+		return iter_result->blkno;
+	}
 
-	return iter_result->blkno;
+	return InvalidBlockNumber;
 }
 
 /*
@@ -2639,11 +3169,8 @@ vacuum_reap_lp_read_stream_next(ReadStream *stream,
 static void
 lazy_vacuum_heap_rel(LVRelState *vacrel)
 {
-	ReadStream *stream;
-	BlockNumber vacuumed_pages = 0;
-	Buffer		vmbuffer = InvalidBuffer;
+	BlockNumber vacuumed_pages;
 	LVSavedErrInfo saved_err_info;
-	TidStoreIter *iter;
 
 	Assert(vacrel->do_index_vacuuming);
 	Assert(vacrel->do_index_cleanup);
@@ -2658,15 +3185,64 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 							 VACUUM_ERRCB_PHASE_VACUUM_HEAP,
 							 InvalidBlockNumber, InvalidOffsetNumber);
 
-	iter = TidStoreBeginIterate(vacrel->dead_items);
+	if (ParallelHeapVacuumIsActive(vacrel))
+	{
+		PHVShared  *shared = vacrel->phvs;
+
+		/* Vacuum the heap along with the workers */
+		shared->phase = PHV_PHASE_VACUUM_HEAP;
+		shared->do_index_vacuuming = vacrel->do_index_vacuuming;
+		pg_atomic_write_u32(&shared->next_vacuum_chunk, 0);
+
+		parallel_vacuum_table_begin(vacrel->pvs, &vacrel->worker_usage.table);
+		vacuumed_pages = lazy_vacuum_heap_blocks(vacrel);
+		parallel_vacuum_table_end(vacrel->pvs);
+		vacuumed_pages += parallel_heap_vacuum_gather_results(vacrel);
+	}
+	else
+		vacuumed_pages = lazy_vacuum_heap_blocks(vacrel);
+
+	/*
+	 * We set all LP_DEAD items from the first heap pass to LP_UNUSED during
+	 * the second heap pass.  No more, no less.
+	 */
+	Assert(vacrel->num_index_scans > 1 ||
+		   (vacrel->dead_items_info->num_items == vacrel->lpdead_items &&
+			vacuumed_pages == vacrel->lpdead_item_pages));
+
+	ereport(DEBUG2,
+			(errmsg("table \"%s\": removed %" PRId64 " dead item identifiers in %u pages",
+					vacrel->relname, vacrel->dead_items_info->num_items,
+					vacuumed_pages)));
+
+	/* Revert to the previous phase information for error traceback */
+	restore_vacuum_error_info(vacrel, &saved_err_info);
+}
+
+/*
+ *	lazy_vacuum_heap_blocks() -- vacuum the heap pages with dead items
+ *
+ * Does the work of lazy_vacuum_heap_rel(), for the blocks of the chunks we
+ * claim in a parallel heap vacuum.  Returns the number of pages vacuumed.
+ */
+static BlockNumber
+lazy_vacuum_heap_blocks(LVRelState *vacrel)
+{
+	ReadStream *stream;
+	BlockNumber vacuumed_pages = 0;
+	Buffer		vmbuffer = InvalidBuffer;
+	LVReapState reap;
+
+	reap.iter = TidStoreBeginIterate(vacrel->dead_items);
+	reap.phvs = vacrel->phvs;
+	reap.chunk = -1;
 
 	/*
 	 * Set up the read stream for vacuum's second pass through the heap.
 	 *
 	 * It is safe to use batchmode, as vacuum_reap_lp_read_stream_next() does
-	 * not need to wait for IO and does not perform locking. Once we support
-	 * parallelism it should still be fine, as presumably the holder of locks
-	 * would never be blocked by IO while holding the lock.
+	 * not need to wait for IO and does not perform locking.  In a parallel
+	 * heap vacuum, it only claims chunks with atomic operations.
 	 */
 	stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE |
 										READ_STREAM_USE_BATCHING,
@@ -2674,7 +3250,7 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 										vacrel->rel,
 										MAIN_FORKNUM,
 										vacuum_reap_lp_read_stream_next,
-										iter,
+										&reap,
 										sizeof(TidStoreIterResult));
 
 	while (true)
@@ -2723,27 +3299,13 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	}
 
 	read_stream_end(stream);
-	TidStoreEndIterate(iter);
+	TidStoreEndIterate(reap.iter);
 
 	vacrel->blkno = InvalidBlockNumber;
 	if (BufferIsValid(vmbuffer))
 		ReleaseBuffer(vmbuffer);
 
-	/*
-	 * We set all LP_DEAD items from the first heap pass to LP_UNUSED during
-	 * the second heap pass.  No more, no less.
-	 */
-	Assert(vacrel->num_index_scans > 1 ||
-		   (vacrel->dead_items_info->num_items == vacrel->lpdead_items &&
-			vacuumed_pages == vacrel->lpdead_item_pages));
-
-	ereport(DEBUG2,
-			(errmsg("table \"%s\": removed %" PRId64 " dead item identifiers in %u pages",
-					vacrel->relname, vacrel->dead_items_info->num_items,
-					vacuumed_pages)));
-
-	/* Revert to the previous phase information for error traceback */
-	restore_vacuum_error_info(vacrel, &saved_err_info);
+	return vacuumed_pages;
 }
 
 /*
@@ -3413,7 +3975,7 @@ count_nondeletable_pages(LVRelState *vacrel, bool *lock_waiter_detected)
  * DSM when required.
  */
 static void
-dead_items_alloc(LVRelState *vacrel, int nworkers)
+dead_items_alloc(LVRelState *vacrel, int nworkers, bool parallel_heap)
 {
 	VacDeadItemsInfo *dead_items_info;
 	int			vac_work_mem = AmAutoVacuumWorkerProcess() &&
@@ -3422,10 +3984,15 @@ dead_items_alloc(LVRelState *vacrel, int nworkers)
 
 	/*
 	 * Initialize state for a parallel vacuum.  As of now, only one worker can
-	 * be used for an index, so we invoke parallelism only if there are at
-	 * least two indexes on a table.
+	 * be used for an index, so we invoke parallelism for indexes only if
+	 * there are at least two indexes on a table.  If the PARALLEL_HEAP option
+	 * was given, the heap itself can be processed in parallel if it is large
+	 * enough, see heap_parallel_vacuum_compute_workers().
 	 */
-	if (nworkers >= 0 && vacrel->nindexes > 1 && vacrel->do_index_vacuuming)
+	if (nworkers >= 0 &&
+		((vacrel->nindexes > 1 && vacrel->do_index_vacuuming) ||
+		 (parallel_heap &&
+		  heap_parallel_vacuum_compute_workers(vacrel->rel, nworkers) > 0)))
 	{
 		/*
 		 * Since parallel workers cannot access data in temporary tables, we
@@ -3445,7 +4012,7 @@ dead_items_alloc(LVRelState *vacrel, int nworkers)
 		else
 			vacrel->pvs = parallel_vacuum_init(vacrel->rel, vacrel->indrels,
 											   vacrel->nindexes, nworkers,
-											   vac_work_mem,
+											   parallel_heap, vac_work_mem,
 											   vacrel->verbose ? INFO : DEBUG2,
 											   vacrel->bstrategy);
 
@@ -3457,6 +4024,7 @@ dead_items_alloc(LVRelState *vacrel, int nworkers)
 		{
 			vacrel->dead_items = parallel_vacuum_get_dead_items(vacrel->pvs,
 																&vacrel->dead_items_info);
+			parallel_heap_vacuum_init(vacrel);
 			return;
 		}
 	}
@@ -3487,11 +4055,17 @@ dead_items_add(LVRelState *vacrel, BlockNumber blkno, OffsetNumber *offsets,
 	};
 	int64		prog_val[2];
 
+	/* The participants of a parallel heap vacuum add items concurrently */
+	TidStoreLockExclusive(vacrel->dead_items);
 	TidStoreSetBlockOffsets(vacrel->dead_items, blkno, offsets, num_offsets);
 	vacrel->dead_items_info->num_items += num_offsets;
-
-	/* update the progress information */
 	prog_val[0] = vacrel->dead_items_info->num_items;
+	TidStoreUnlock(vacrel->dead_items);
+
+	/* update the progress information, which workers can't do */
+	if (IsParallelWorker())
+		return;
+
 	prog_val[1] = TidStoreMemoryUsage(vacrel->dead_items);
 	pgstat_progress_update_multi_param(2, prog_index, prog_val);
 }
@@ -3537,6 +4111,299 @@ dead_items_cleanup(LVRelState *vacrel)
 	/* End parallel mode */
 	parallel_vacuum_end(vacrel->pvs, vacrel->indstats);
 	vacrel->pvs = NULL;
+	vacrel->phvs = NULL;
+}
+
+/*
+ * Set up the shared state of a parallel heap vacuum, if the parallel vacuum
+ * initialized by dead_items_alloc() processes the heap too.
+ */
+static void
+parallel_heap_vacuum_init(LVRelState *vacrel)
+{
+	PHVShared  *shared;
+	int			nworkers;
+
+	shared = parallel_vacuum_get_table_state(vacrel->pvs, &nworkers);
+	if (shared == NULL)
+		return;
+
+	shared->cutoffs = vacrel->cutoffs;
+	shared->aggressive = vacrel->aggressive;
+	shared->skipwithvm = vacrel->skipwithvm;
+	shared->verbose = vacrel->verbose;
+	shared->nindexes = vacrel->nindexes;
+	shared->rel_pages = vacrel->rel_pages;
+	shared->eager_scan_max_fails_per_region =
+		vacrel->eager_scan_max_fails_per_region;
+	shared->eager_scan_max_successes = vacrel->eager_scan_max_successes;
+
+	/*
+	 * Make the first chunk end with the first eager scan region, which is
+	 * smaller than the others, so that all chunks are aligned on regions.
+	 */
+	if (vacrel->next_eager_scan_region_start != InvalidBlockNumber &&
+		vacrel->next_eager_scan_region_start > 0)
+		shared->first_chunk_end = vacrel->next_eager_scan_region_start;
+	else
+		shared->first_chunk_end = PARALLEL_VACUUM_CHUNK_SIZE;
+
+	shared->nworkers = nworkers;
+	pg_atomic_init_u32(&shared->next_scan_chunk, 0);
+	pg_atomic_init_u32(&shared->next_vacuum_chunk, 0);
+	pg_atomic_init_u32(&shared->eager_scan_remaining_successes,
+					   vacrel->eager_scan_remaining_successes);
+	pg_atomic_init_u32(&shared->scan_stop, 0);
+	SpinLockInit(&shared->mutex);
+
+	/* The leader uses the entry after the workers' */
+	vacrel->phvs = shared;
+	vacrel->phvs_slot = nworkers;
+}
+
+/*
+ * Report the counters of a parallel heap vacuum worker to the leader.
+ */
+static void
+parallel_heap_vacuum_report_results(LVRelState *vacrel,
+									BlockNumber vacuumed_pages)
+{
+	PHVResults *results = &vacrel->phvs->participants[vacrel->phvs_slot].results;
+
+	Assert(IsParallelWorker());
+
+	results->scanned_pages = vacrel->scanned_pages;
+	results->eager_scanned_pages = vacrel->eager_scanned_pages;
+	results->new_frozen_tuple_pages = vacrel->new_frozen_tuple_pages;
+	results->new_all_visible_pages = vacrel->new_all_visible_pages;
+	results->new_all_visible_all_frozen_pages =
+		vacrel->new_all_visible_all_frozen_pages;
+	results->new_all_frozen_pages = vacrel->new_all_frozen_pages;
+	results->lpdead_item_pages = vacrel->lpdead_item_pages;
+	results->missed_dead_pages = vacrel->missed_dead_pages;
+	results->nonempty_pages = vacrel->nonempty_pages;
+	results->vacuumed_pages = vacuumed_pages;
+	results->tuples_deleted = vacrel->tuples_deleted;
+	results->tuples_frozen = vacrel->tuples_frozen;
+	results->lpdead_items = vacrel->lpdead_items;
+	results->live_tuples = vacrel->live_tuples;
+	results->recently_dead_tuples = vacrel->recently_dead_tuples;
+	results->missed_dead_tuples = vacrel->missed_dead_tuples;
+	results->NewRelfrozenXid = vacrel->NewRelfrozenXid;
+	results->NewRelminMxid = vacrel->NewRelminMxid;
+	results->skippedallvis = vacrel->skippedallvis;
+	results->valid = true;
+}
+
+/*
+ * Accumulate the counters reported by the workers of a parallel heap vacuum
+ * into the leader's.  Returns the number of pages the workers vacuumed in the
+ * second pass.
+ */
+static BlockNumber
+parallel_heap_vacuum_gather_results(LVRelState *vacrel)
+{
+	PHVShared  *shared = vacrel->phvs;
+	BlockNumber vacuumed_pages = 0;
+
+	Assert(!IsParallelWorker());
+
+	for (int i = 0; i < shared->nworkers; i++)
+	{
+		PHVResults *results = &shared->participants[i].results;
+
+		/* Skip workers that were not launched */
+		if (!results->valid)
+			continue;
+
+		vacrel->scanned_pages += results->scanned_pages;
+		vacrel->eager_scanned_pages += results->eager_scanned_pages;
+		vacrel->new_frozen_tuple_pages += results->new_frozen_tuple_pages;
+		vacrel->new_all_visible_pages += results->new_all_visible_pages;
+		vacrel->new_all_visible_all_frozen_pages +=
+			results->new_all_visible_all_frozen_pages;
+		vacrel->new_all_frozen_pages += results->new_all_frozen_pages;
+		vacrel->lpdead_item_pages += results->lpdead_item_pages;
+		vacrel->missed_dead_pages += results->missed_dead_pages;
+		vacrel->nonempty_pages = Max(vacrel->nonempty_pages,
+									 results->nonempty_pages);
+		vacuumed_pages += results->vacuumed_pages;
+		vacrel->tuples_deleted += results->tuples_deleted;
+		vacrel->tuples_frozen += results->tuples_frozen;
+		vacrel->lpdead_items += results->lpdead_items;
+		vacrel->live_tuples += results->live_tuples;
+		vacrel->recently_dead_tuples += results->recently_dead_tuples;
+		vacrel->missed_dead_tuples += results->missed_dead_tuples;
+
+		if (TransactionIdPrecedes(results->NewRelfrozenXid,
+								  vacrel->NewRelfrozenXid))
+			vacrel->NewRelfrozenXid = results->NewRelfrozenXid;
+		if (MultiXactIdPrecedes(results->NewRelminMxid,
+								vacrel->NewRelminMxid))
+			vacrel->NewRelminMxid = results->NewRelminMxid;
+		if (results->skippedallvis)
+			vacrel->skippedallvis = true;
+
+		results->valid = false;
+	}
+
+	return vacuumed_pages;
+}
+
+/*
+ *	heap_parallel_vacuum_compute_workers() -- number of parallel workers for
+ *	processing the heap
+ *
+ * Tables smaller than min_parallel_table_scan_size are processed by the
+ * leader alone.  Otherwise, unless the user asked for a number of workers,
+ * the number comes from the parallel_workers storage parameter, or grows
+ * with the logarithm of the size of the table as for parallel scans.  There
+ * is no use in more workers than chunks left over by the leader.
+ */
+int
+heap_parallel_vacuum_compute_workers(Relation rel, int nworkers_requested)
+{
+	BlockNumber rel_pages = RelationGetNumberOfBlocks(rel);
+	BlockNumber nchunks;
+	int			parallel_workers;
+
+	if (rel_pages < (BlockNumber) min_parallel_table_scan_size)
+		return 0;
+
+	if (nworkers_requested > 0)
+		parallel_workers = nworkers_requested;
+	else
+	{
+		parallel_workers = RelationGetParallelWorkers(rel, -1);
+
+		if (parallel_workers < 0)
+		{
+			int			heap_parallel_threshold;
+
+			/* Same scaling as compute_parallel_worker() */
+			parallel_workers = 1;
+			heap_parallel_threshold = Max(min_parallel_table_scan_size, 1);
+			while (rel_pages >= (BlockNumber) (heap_parallel_threshold * 3))
+			{
+				parallel_workers++;
+				heap_parallel_threshold *= 3;
+				if (heap_parallel_threshold > INT_MAX / 3)
+					break;		/* avoid overflow */
+			}
+		}
+	}
+
+	/* The first chunk may be smaller than the others, count one more */
+	nchunks = rel_pages / PARALLEL_VACUUM_CHUNK_SIZE + 1;
+
+	return Min(parallel_workers, (int) nchunks - 1);
+}
+
+/*
+ *	heap_parallel_vacuum_estimate() -- size of the state of a parallel heap
+ *	vacuum shared in DSM
+ */
+Size
+heap_parallel_vacuum_estimate(Relation rel, int nworkers)
+{
+	return add_size(offsetof(PHVShared, participants),
+					mul_size(sizeof(PHVParticipant), nworkers + 1));
+}
+
+/*
+ *	heap_parallel_vacuum_worker() -- process the heap as a parallel worker
+ *
+ * Takes part in the pass over the heap the leader launched us for, as set up
+ * by the leader in the shared state.  See "Parallel heap vacuum" above.
+ */
+void
+heap_parallel_vacuum_worker(Relation rel, ParallelVacuumState *pvs,
+							void *state, BufferAccessStrategy bstrategy)
+{
+	PHVShared  *shared = (PHVShared *) state;
+	LVRelState *vacrel;
+	ErrorContextCallback errcallback;
+	BlockNumber vacuumed_pages = 0;
+
+	vacrel = palloc0_object(LVRelState);
+	vacrel->dbname = get_database_name(MyDatabaseId);
+	vacrel->relnamespace = get_namespace_name(RelationGetNamespace(rel));
+	vacrel->relname = pstrdup(RelationGetRelationName(rel));
+	vacrel->indname = NULL;
+	vacrel->phase = VACUUM_ERRCB_PHASE_UNKNOWN;
+	vacrel->verbose = shared->verbose;
+	errcallback.callback = vacuum_error_callback;
+	errcallback.arg = vacrel;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	vacrel->rel = rel;
+	vacrel->nindexes = shared->nindexes;
+	vacrel->bstrategy = bstrategy;
+	vacrel->pvs = pvs;
+	vacrel->phvs = shared;
+	vacrel->phvs_slot = ParallelWorkerNumber;
+	vacrel->aggressive = shared->aggressive;
+	vacrel->skipwithvm = shared->skipwithvm;
+	vacrel->do_index_vacuuming = shared->do_index_vacuuming;
+
+	/*
+	 * Use the leader's cutoffs.  Our own vistest is fine, as pruning removes
+	 * any deleted tuple whose xmax is < OldestXmin anyway; see
+	 * heap_vacuum_rel().
+	 */
+	vacrel->cutoffs = shared->cutoffs;
+	vacrel->vistest = GlobalVisTestFor(rel);
+	vacrel->NewRelfrozenXid = vacrel->cutoffs.OldestXmin;
+	vacrel->NewRelminMxid = vacrel->cutoffs.OldestMxact;
+
+	vacrel->dead_items = parallel_vacuum_get_dead_items(pvs,
+														&vacrel->dead_items_info);
+	vacrel->rel_pages = shared->rel_pages;
+	vacrel->blkno = InvalidBlockNumber;
+	vacrel->offnum = InvalidOffsetNumber;
+
+	/* Eager scanning is set up for each range we claim */
+	vacrel->eager_scan_max_fails_per_region =
+		shared->eager_scan_max_fails_per_region;
+	vacrel->eager_scan_max_successes = shared->eager_scan_max_successes;
+	vacrel->next_eager_scan_region_start = InvalidBlockNumber;
+
+	if (shared->phase == PHV_PHASE_SCAN_HEAP)
+	{
+		ReadStream *stream;
+		Buffer		vmbuffer = InvalidBuffer;
+
+		/* Claim a range to scan on the first heap_vac_scan_next_block() call */
+		vacrel->scan_start = vacrel->scan_end = 0;
+		vacrel->current_block = InvalidBlockNumber;
+		vacrel->next_unskippable_block = InvalidBlockNumber;
+		vacrel->next_unskippable_vmbuffer = InvalidBuffer;
+
+		stream = read_stream_begin_relation(READ_STREAM_MAINTENANCE,
+											vacrel->bstrategy,
+											vacrel->rel,
+											MAIN_FORKNUM,
+											heap_vac_scan_next_block,
+											vacrel,
+											sizeof(bool));
+		lazy_scan_heap_blocks(vacrel, stream, &vmbuffer);
+		read_stream_end(stream);
+
+		if (BufferIsValid(vmbuffer))
+			ReleaseBuffer(vmbuffer);
+	}
+	else
+	{
+		update_vacuum_error_info(vacrel, NULL, VACUUM_ERRCB_PHASE_VACUUM_HEAP,
+								 InvalidBlockNumber, InvalidOffsetNumber);
+		vacuumed_pages = lazy_vacuum_heap_blocks(vacrel);
+	}
+
+	parallel_heap_vacuum_report_results(vacrel, vacuumed_pages);
+
+	/* Pop the error context stack */
+	error_context_stack = errcallback.previous;
 }
 
 #ifdef USE_ASSERT_CHECKING
@@ -109,6 +109,8 @@ static IndexScanDesc index_beginscan_internal(Relation indexRelation,
 											  int nkeys, int norderbys, Snapshot snapshot,
 											  ParallelIndexScanDesc pscan, bool temp_snap);
 static inline void validate_relation_as_index(Relation r);
+static void index_batch_setup(IndexScanDesc scan, uint32 flags);
+static void index_batch_advance(IndexScanDesc scan, ScanDirection direction);
 
 
 /* ----------------------------------------------------------------
@@ -287,6 +289,7 @@ index_beginscan(Relation heapRelation,
 
 	/* prepare to fetch index matches from table */
 	scan->xs_heapfetch = table_index_fetch_begin(heapRelation, flags);
+	index_batch_setup(scan, flags);
 
 	return scan;
 }
@@ -378,6 +381,8 @@ index_rescan(IndexScanDesc scan,
 	/* reset table AM state for rescan */
 	if (scan->xs_heapfetch)
 		table_index_fetch_reset(scan->xs_heapfetch);
+	if (scan->xs_batch)
+		scan->xs_batch->ntids = 0;
 
 	scan->kill_prior_tuple = false; /* for safety */
 	scan->xs_heap_continue = false;
@@ -402,6 +407,11 @@ index_endscan(IndexScanDesc scan)
 		table_index_fetch_end(scan->xs_heapfetch);
 		scan->xs_heapfetch = NULL;
 	}
+	if (scan->xs_batch)
+	{
+		pfree(scan->xs_batch);
+		scan->xs_batch = NULL;
+	}
 
 	/* End the AM's scan */
 	scan->indexRelation->rd_indam->amendscan(scan);
@@ -455,6 +465,8 @@ index_restrpos(IndexScanDesc scan)
 	/* reset table AM state for restoring the marked position */
 	if (scan->xs_heapfetch)
 		table_index_fetch_reset(scan->xs_heapfetch);
+	if (scan->xs_batch)
+		scan->xs_batch->ntids = 0;
 
 	scan->kill_prior_tuple = false; /* for safety */
 	scan->xs_heap_continue = false;
@@ -542,6 +554,8 @@ index_parallelrescan(IndexScanDesc scan)
 	/* reset table AM state for rescan */
 	if (scan->xs_heapfetch)
 		table_index_fetch_reset(scan->xs_heapfetch);
+	if (scan->xs_batch)
+		scan->xs_batch->ntids = 0;
 
 	/* amparallelrescan is optional; assume no-op if not provided by AM */
 	if (scan->indexRelation->rd_indam->amparallelrescan != NULL)
@@ -584,6 +598,7 @@ index_beginscan_parallel(Relation heaprel, Relation indexrel,
 
 	/* prepare to fetch index matches from table */
 	scan->xs_heapfetch = table_index_fetch_begin(heaprel, flags);
+	index_batch_setup(scan, flags);
 
 	return scan;
 }
@@ -624,17 +639,86 @@ index_getnext_tid(IndexScanDesc scan, ScanDirection direction)
 		/* reset table AM state */
 		if (scan->xs_heapfetch)
 			table_index_fetch_reset(scan->xs_heapfetch);
+		if (scan->xs_batch)
+			scan->xs_batch->ntids = 0;
 
 		return NULL;
 	}
 	Assert(ItemPointerIsValid(&scan->xs_heaptid));
 
+	/* Keep track of where we are in the batch the table AM reads ahead in */
+	if (scan->xs_batch)
+		index_batch_advance(scan, direction);
+
 	pgstat_count_index_tuples(scan->indexRelation, 1);
 
 	/* Return the TID of the tuple we found. */
 	return &scan->xs_heaptid;
 }
 
+/*
+ * index_batch_setup - prepare to report upcoming TIDs to the table AM
+ *
+ * This is only done if the caller asked for read-ahead and the index AM can
+ * tell us which TIDs it's going to return.  The table AM finds the batch
+ * through its IndexFetchTableData.
+ */
+static void
+index_batch_setup(IndexScanDesc scan, uint32 flags)
+{
+	IndexScanBatch batch;
+
+	if ((flags & SO_INDEX_PREFETCH) == 0 ||
+		scan->indexRelation->rd_indam->amgetbatch == NULL)
+		return;
+
+	batch = palloc_object(IndexScanBatchData);
+	batch->dir = NoMovementScanDirection;
+	batch->ntids = 0;
+	batch->nreturned = 0;
+	batch->nread = 0;
+
+	scan->xs_batch = batch;
+	scan->xs_heapfetch->batch = batch;
+}
+
+/*
+ * index_batch_advance - account for a TID just returned by amgettuple
+ *
+ * If the TID is the next one in the current batch we just step over it.
+ * Otherwise the index AM has moved on to TIDs we haven't seen yet, so ask it
+ * for its new batch, which begins with the TID just returned.
+ */
+static void
+index_batch_advance(IndexScanDesc scan, ScanDirection direction)
+{
+	IndexScanBatch batch = scan->xs_batch;
+
+	if (likely(batch->nreturned < batch->ntids && batch->dir == direction))
+	{
+		Assert(ItemPointerEquals(&batch->tids[batch->nreturned],
+								 &scan->xs_heaptid));
+		batch->nreturned++;
+		return;
+	}
+
+	/*
+	 * If the scan changed direction, the table AM might have read ahead of
+	 * where we are now in the old direction.  Make it start over.
+	 */
+	if (batch->ntids > 0 && batch->dir != direction)
+		table_index_fetch_reset(scan->xs_heapfetch);
+
+	batch->dir = direction;
+	batch->ntids = scan->indexRelation->rd_indam->amgetbatch(scan, direction,
+															 batch->tids,
+															 INDEX_SCAN_BATCH_MAX_TIDS);
+	Assert(batch->ntids > 0 && batch->ntids <= INDEX_SCAN_BATCH_MAX_TIDS);
+	Assert(ItemPointerEquals(&batch->tids[0], &scan->xs_heaptid));
+	batch->nreturned = 1;
+	batch->nread = 0;
+}
+
 /* ----------------
  *		index_fetch_heap - get the scan's next heap tuple
  *
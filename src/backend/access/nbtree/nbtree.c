@@ -162,6 +162,7 @@ bthandler(PG_FUNCTION_ARGS)
 		.ambeginscan = btbeginscan,
 		.amrescan = btrescan,
 		.amgettuple = btgettuple,
+		.amgetbatch = btgetbatch,
 		.amgetbitmap = btgetbitmap,
 		.amendscan = btendscan,
 		.ammarkpos = btmarkpos,
@@ -284,6 +285,39 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 	return res;
 }
 
+/*
+ *	btgetbatch() -- report the TIDs that btgettuple will return next
+ *
+ * The batch starts with the item btgettuple just returned and extends to the
+ * last remaining item saved from the current leaf page.  This only looks at
+ * so->currPos, so the scan's position is not affected.
+ */
+int
+btgetbatch(IndexScanDesc scan, ScanDirection dir, ItemPointer tids,
+		   int maxtids)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	int			ntids = 0;
+
+	Assert(BTScanPosIsValid(so->currPos));
+	Assert(maxtids > 0);
+
+	if (ScanDirectionIsForward(dir))
+	{
+		for (int i = so->currPos.itemIndex;
+			 i <= so->currPos.lastItem && ntids < maxtids; i++)
+			tids[ntids++] = so->currPos.items[i].heapTid;
+	}
+	else
+	{
+		for (int i = so->currPos.itemIndex;
+			 i >= so->currPos.firstItem && ntids < maxtids; i--)
+			tids[ntids++] = so->currPos.items[i].heapTid;
+	}
+
+	return ntids;
+}
+
 /*
  * btgetbitmap() -- gets all matching tuples, and adds them to a bitmap
  */
@@ -21,18 +21,36 @@
 #include "executor/instrument_node.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/pg_bitutils.h"
+#include "port/simd.h"
 #include "storage/predicate.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 
 
+/*
+ * On leaf pages, _bt_binsrch_intkey() compares the last few slots of its
+ * search all at once when they number at most this many.
+ */
+#define BT_INTKEY_GATHER_MAX	16
+
+
 static inline void _bt_drop_lock_and_maybe_pin(Relation rel, BTScanOpaque so);
 static Buffer _bt_moveright(Relation rel, Relation heaprel, BTScanInsert key,
 							Buffer buf, bool forupdate, BTStack stack,
 							int access);
 static OffsetNumber _bt_binsrch(Relation rel, BTScanInsert key, Buffer buf);
+static inline int _bt_intkey_width(BTScanInsert key);
+static OffsetNumber _bt_binsrch_intkey(Relation rel, BTScanInsert key,
+									   Page page, OffsetNumber low,
+									   OffsetNumber high, int32 cmpval,
+									   int width);
 static int	_bt_binsrch_posting(BTScanInsert key, Page page,
 								OffsetNumber offnum);
+static inline int32 _bt_compare_prefix(Relation rel, BTScanInsert key,
+									   Page page, OffsetNumber offnum,
+									   int *cmpcol);
 static inline void _bt_returnitem(IndexScanDesc scan, BTScanOpaque so);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_readfirstpage(IndexScanDesc scan, OffsetNumber offnum,
@@ -336,6 +354,13 @@ _bt_moveright(Relation rel,
  * It is possible that we'll return an offset that's either past the last
  * non-pivot slot, or (in the case of a backward scan) before the first slot.
  *
+ * The search skips comparing the leading key attributes that are known to
+ * be equal to the scan key for all the tuples between the current bounds:
+ * since the tuples on the page are sorted, any attribute prefix that both
+ * bound tuples share with the scan key is shared by every tuple in between.
+ * With composite keys whose leading attributes have few distinct values,
+ * most comparisons then only look at the attributes that tell tuples apart.
+ *
  * This procedure is not responsible for walking right, it just examines
  * the given page.  _bt_binsrch() has no lock or refcount side effects
  * on the buffer.
@@ -351,6 +376,9 @@ _bt_binsrch(Relation rel,
 				high;
 	int32		result,
 				cmpval;
+	int			lowcmpcol = 1,
+				highcmpcol = 1;
+	int			width;
 
 	page = BufferGetPage(buf);
 	opaque = BTPageGetOpaque(page);
@@ -383,24 +411,45 @@ _bt_binsrch(Relation rel,
 	 * For nextkey=true (cmpval=0), the loop invariant is: all slots before
 	 * 'low' are <= scan key, all slots at or after 'high' are > scan key.
 	 *
+	 * lowcmpcol and highcmpcol are the first key attributes that the slots
+	 * just before 'low' and at 'high' were found not to be equal to the scan
+	 * key in; comparisons of the slots in between can start at the lesser of
+	 * the two.
+	 *
+	 * Scan keys on a single integer attribute take a specialized path that
+	 * compares the keys without calling the comparison function; see
+	 * _bt_binsrch_intkey().
+	 *
 	 * We can fall out when high == low.
 	 */
 	high++;						/* establish the loop invariant for high */
 
 	cmpval = key->nextkey ? 0 : 1;	/* select comparison value */
 
-	while (high > low)
+	if ((width = _bt_intkey_width(key)) != 0)
+		low = _bt_binsrch_intkey(rel, key, page, low, high, cmpval, width);
+	else
 	{
-		OffsetNumber mid = low + ((high - low) / 2);
+		while (high > low)
+		{
+			OffsetNumber mid = low + ((high - low) / 2);
+			int			cmpcol = Min(lowcmpcol, highcmpcol);
 
-		/* We have low <= mid < high, so mid points at a real slot */
+			/* We have low <= mid < high, so mid points at a real slot */
 
-		result = _bt_compare(rel, key, page, mid);
+			result = _bt_compare_prefix(rel, key, page, mid, &cmpcol);
 
-		if (result >= cmpval)
-			low = mid + 1;
-		else
-			high = mid;
+			if (result >= cmpval)
+			{
+				low = mid + 1;
+				lowcmpcol = cmpcol;
+			}
+			else
+			{
+				high = mid;
+				highcmpcol = cmpcol;
+			}
+		}
 	}
 
 	/*
@@ -449,6 +498,223 @@ _bt_binsrch(Relation rel,
 	return OffsetNumberPrev(low);
 }
 
+/*
+ * _bt_intkey_width() -- Can _bt_binsrch() search for this scan key with
+ *		_bt_binsrch_intkey()?
+ *
+ * That is possible when the scan key has a single attribute, compared with
+ * the default comparison function of int2, int4 or int8.  Returns the width
+ * of the attribute's type if so, or 0 otherwise.
+ */
+static inline int
+_bt_intkey_width(BTScanInsert key)
+{
+	ScanKey		skey = key->scankeys;
+
+	if (key->keysz != 1 || (skey->sk_flags & SK_ISNULL))
+		return 0;
+
+	switch (skey->sk_func.fn_oid)
+	{
+		case F_BTINT2CMP:
+			return sizeof(int16);
+		case F_BTINT4CMP:
+			return sizeof(int32);
+		case F_BTINT8CMP:
+			return sizeof(int64);
+	}
+
+	return 0;
+}
+
+/*
+ * Fetch the first attribute of an index tuple for _bt_binsrch_intkey().
+ *
+ * Returns false if the attribute is NULL, or was truncated away.
+ */
+static inline bool
+_bt_intkey_fetch(Relation rel, IndexTuple itup, int width, int64 *val)
+{
+	Datum		datum;
+	bool		isnull;
+
+	if (BTreeTupleGetNAtts(itup, rel) < 1)
+		return false;
+
+	datum = index_getattr(itup, 1, RelationGetDescr(rel), &isnull);
+	if (isnull)
+		return false;
+
+	if (width == sizeof(int16))
+		*val = DatumGetInt16(datum);
+	else if (width == sizeof(int32))
+		*val = DatumGetInt32(datum);
+	else
+		*val = DatumGetInt64(datum);
+
+	return true;
+}
+
+/*
+ * Like _bt_compare(), for _bt_binsrch_intkey().
+ *
+ * Only keys that differ from the scan key are compared here.  Equal keys,
+ * NULLs, truncated attributes and the "minus infinity" item of internal
+ * pages are left to _bt_compare(), which knows how to break ties with the
+ * heap TID and how to treat the rest.
+ */
+static inline int32
+_bt_compare_intkey(Relation rel, BTScanInsert key, Page page,
+				   OffsetNumber offnum, int width, int64 keyval)
+{
+	BTPageOpaque opaque = BTPageGetOpaque(page);
+	IndexTuple	itup;
+	int64		val;
+
+	if (P_ISLEAF(opaque) || offnum > P_FIRSTDATAKEY(opaque))
+	{
+		itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+
+		if (_bt_intkey_fetch(rel, itup, width, &val) && val != keyval)
+		{
+			int32		result = (keyval > val) ? 1 : -1;
+
+			if (key->scankeys->sk_flags & SK_BT_DESC)
+				INVERT_COMPARE_RESULT(result);
+
+			return result;
+		}
+	}
+
+	return _bt_compare(rel, key, page, offnum);
+}
+
+#ifndef USE_NO_SIMD
+/*
+ * Count the slots of a sorted run of leaf page keys for which _bt_compare()
+ * would return a result >= cmpval, that is the slots that the binary search
+ * of _bt_binsrch_intkey() would put before 'low'.
+ *
+ * Leaf pages have no pivot tuples between their data items, and scan keys
+ * used on them have no scantid, so the result is just the comparison of the
+ * keys.
+ */
+static int
+_bt_intkey_count(const int32 *keys, int nkeys, int32 keyval, int32 cmpval,
+				 bool desc)
+{
+	const int	nelem = sizeof(Vector32) / sizeof(int32);
+	Vector32	kv = vector32_broadcast((uint32) keyval);
+	bool		countless;
+	int			count = 0;
+	int			i;
+
+	/*
+	 * With nextkey semantics (cmpval == 0), count the slots that do not
+	 * compare greater than the scan key instead.
+	 */
+	countless = (desc == (cmpval == 0));
+
+	for (i = 0; i + nelem <= nkeys; i += nelem)
+	{
+		Vector32	vals;
+		Vector32	cmp;
+
+		vector32_load(&vals, (const uint32 *) &keys[i]);
+		cmp = countless ? vector32_gt(kv, vals) : vector32_gt(vals, kv);
+
+		/* each matching lane sets the high bits of sizeof(int32) bytes */
+		count += pg_popcount32(vector8_highbit_mask((Vector8) cmp)) /
+			sizeof(int32);
+	}
+
+	for (; i < nkeys; i++)
+		count += countless ? (keys[i] < keyval) : (keys[i] > keyval);
+
+	return cmpval == 0 ? nkeys - count : count;
+}
+#endif							/* ! USE_NO_SIMD */
+
+/*
+ * _bt_binsrch_intkey() -- _bt_binsrch() loop for integer scan keys.
+ *
+ * Searches the slots between low and high (exclusive) for the scan key,
+ * whose attribute is an integer of the given width, and returns the final
+ * value of low.  See _bt_binsrch() for the meaning of the arguments.
+ *
+ * The keys of the tuples are compared to the scan key directly, rather than
+ * through the comparison function.  Besides, once few slots are left to
+ * search on a leaf page, keys of up to 32 bits are gathered in an array and
+ * compared to the scan key at once using vector instructions, saving the
+ * last, poorly predicted, steps of the binary search.
+ */
+static OffsetNumber
+_bt_binsrch_intkey(Relation rel, BTScanInsert key, Page page,
+				   OffsetNumber low, OffsetNumber high, int32 cmpval,
+				   int width)
+{
+	ScanKey		skey = key->scankeys;
+	int64		keyval;
+#ifndef USE_NO_SIMD
+	bool		gather;
+
+	gather = P_ISLEAF(BTPageGetOpaque(page)) && width <= sizeof(int32);
+#endif
+
+	if (width == sizeof(int16))
+		keyval = DatumGetInt16(skey->sk_argument);
+	else if (width == sizeof(int32))
+		keyval = DatumGetInt32(skey->sk_argument);
+	else
+		keyval = DatumGetInt64(skey->sk_argument);
+
+	while (high > low)
+	{
+		OffsetNumber mid;
+		int32		result;
+
+#ifndef USE_NO_SIMD
+		if (gather && high - low <= BT_INTKEY_GATHER_MAX)
+		{
+			int32		keys[BT_INTKEY_GATHER_MAX];
+			OffsetNumber offnum;
+
+			for (offnum = low; offnum < high; offnum++)
+			{
+				ItemId		itemid = PageGetItemId(page, offnum);
+				IndexTuple	itup = (IndexTuple) PageGetItem(page, itemid);
+				int64		val;
+
+				if (!_bt_intkey_fetch(rel, itup, width, &val))
+					break;
+				keys[offnum - low] = (int32) val;
+			}
+
+			if (offnum == high)
+				return low + _bt_intkey_count(keys, high - low,
+											  (int32) keyval, cmpval,
+											  (skey->sk_flags & SK_BT_DESC) != 0);
+
+			/* there are NULLs in the way, finish the search one by one */
+			gather = false;
+		}
+#endif
+
+		mid = low + ((high - low) / 2);
+
+		/* We have low <= mid < high, so mid points at a real slot */
+
+		result = _bt_compare_intkey(rel, key, page, mid, width, keyval);
+
+		if (result >= cmpval)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
 /*
  *
  *	_bt_binsrch_insert() -- Cacheable, incremental leaf page binary search.
@@ -482,6 +748,8 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 				stricthigh;
 	int32		result,
 				cmpval;
+	int			lowcmpcol = 1,
+				highcmpcol = 1;
 
 	page = BufferGetPage(insertstate->buf);
 	opaque = BTPageGetOpaque(page);
@@ -521,6 +789,10 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 	 * at or after 'high' are >= scan key.  'stricthigh' is > scan key, and is
 	 * maintained to save additional search effort for caller.
 	 *
+	 * Like _bt_binsrch(), skip comparing the key attributes known to be equal
+	 * for all slots between the bounds.  Nothing is known about the bounds
+	 * restored from a previous search, so that starts from scratch.
+	 *
 	 * We can fall out when high == low.
 	 */
 	if (!insertstate->bounds_valid)
@@ -532,16 +804,21 @@ _bt_binsrch_insert(Relation rel, BTInsertState insertstate)
 	while (high > low)
 	{
 		OffsetNumber mid = low + ((high - low) / 2);
+		int			cmpcol = Min(lowcmpcol, highcmpcol);
 
 		/* We have low <= mid < high, so mid points at a real slot */
 
-		result = _bt_compare(rel, key, page, mid);
+		result = _bt_compare_prefix(rel, key, page, mid, &cmpcol);
 
 		if (result >= cmpval)
+		{
 			low = mid + 1;
+			lowcmpcol = cmpcol;
+		}
 		else
 		{
 			high = mid;
+			highcmpcol = cmpcol;
 			if (result != 0)
 				stricthigh = high;
 		}
@@ -690,6 +967,28 @@ _bt_compare(Relation rel,
 			BTScanInsert key,
 			Page page,
 			OffsetNumber offnum)
+{
+	int			cmpcol = 1;
+
+	return _bt_compare_prefix(rel, key, page, offnum, &cmpcol);
+}
+
+/*
+ *	_bt_compare_prefix() -- _bt_compare(), skipping known equal attributes.
+ *
+ * On entry, *cmpcol is the first key attribute to compare: caller knows that
+ * the tuple's attributes before it are equal to the scan key's.  On return,
+ * *cmpcol is set to the first attribute found to be unequal, or to one past
+ * the last attribute compared if all of them were equal, so that attributes
+ * before *cmpcol are known equal.  The first data item of an internal page
+ * sets it to 1.
+ */
+static inline int32
+_bt_compare_prefix(Relation rel,
+				   BTScanInsert key,
+				   Page page,
+				   OffsetNumber offnum,
+				   int *cmpcol)
 {
 	TupleDesc	itupdesc = RelationGetDescr(rel);
 	BTPageOpaque opaque = BTPageGetOpaque(page);
@@ -709,7 +1008,10 @@ _bt_compare(Relation rel,
 	 * --- see NOTE above.
 	 */
 	if (!P_ISLEAF(opaque) && offnum == P_FIRSTDATAKEY(opaque))
+	{
+		*cmpcol = 1;
 		return 1;
+	}
 
 	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
 	ntupatts = BTreeTupleGetNAtts(itup, rel);
@@ -729,8 +1031,9 @@ _bt_compare(Relation rel,
 	ncmpkey = Min(ntupatts, key->keysz);
 	Assert(key->heapkeyspace || ncmpkey == key->keysz);
 	Assert(!BTreeTupleIsPosting(itup) || key->allequalimage);
-	scankey = key->scankeys;
-	for (int i = 1; i <= ncmpkey; i++)
+	Assert(*cmpcol >= 1);
+	scankey = key->scankeys + (*cmpcol - 1);
+	for (int i = *cmpcol; i <= ncmpkey; i++)
 	{
 		Datum		datum;
 		bool		isNull;
@@ -774,10 +1077,14 @@ _bt_compare(Relation rel,
 
 		/* if the keys are unequal, return the difference */
 		if (result != 0)
+		{
+			*cmpcol = i;
 			return result;
+		}
 
 		scankey++;
 	}
+	*cmpcol = ncmpkey + 1;
 
 	/*
 	 * All non-truncated attributes (other than heap TID) were found to be
@@ -47,6 +47,7 @@
 #include "access/tableam.h"
 #include "access/xact.h"
 #include "catalog/index.h"
+#include "catalog/storage.h"
 #include "commands/progress.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
@@ -324,6 +325,16 @@ btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 		elog(ERROR, "index \"%s\" already contains data",
 			 RelationGetRelationName(index));
 
+	/*
+	 * Compress the index if asked to, as it is empty yet.  Binary upgrade
+	 * brings the files over from the old cluster as they are, see
+	 * heap_create_with_catalog().
+	 */
+	if (!IsBinaryUpgrade)
+		RelationSetStorageCompression(RelationGetSmgr(index),
+									  index->rd_rel->relpersistence,
+									  BTGetPageCompression(index));
+
 	reltuples = _bt_spools_heapscan(heap, index, &buildstate, indexInfo);
 
 	/*
@@ -68,6 +68,14 @@ brin_desc(StringInfo buf, XLogReaderState *record)
 		appendStringInfo(buf, "pagesPerRange %u, heapBlk %u, page offset %u",
 						 xlrec->pagesPerRange, xlrec->heapBlk, xlrec->regOffset);
 	}
+	else if (info == XLOG_BRIN_MERGE)
+	{
+		xl_brin_merge *xlrec = (xl_brin_merge *) rec;
+
+		appendStringInfo(buf, "pagesPerRange %u, heapBlk %u, headBlk %u, page offset %u",
+						 xlrec->pagesPerRange, xlrec->heapBlk, xlrec->headBlk,
+						 xlrec->regOffset);
+	}
 }
 
 const char *
@@ -101,6 +109,9 @@ brin_identify(uint8 info)
 		case XLOG_BRIN_DESUMMARIZE:
 			id = "DESUMMARIZE";
 			break;
+		case XLOG_BRIN_MERGE:
+			id = "MERGE";
+			break;
 	}
 
 	return id;
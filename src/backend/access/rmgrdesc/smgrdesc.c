@@ -38,6 +38,14 @@ smgr_desc(StringInfo buf, XLogReaderState *record)
 						 relpathperm(xlrec->rlocator, MAIN_FORKNUM).str,
 						 xlrec->blkno, xlrec->flags);
 	}
+	else if (info == XLOG_SMGR_COMPRESS)
+	{
+		xl_smgr_compress *xlrec = (xl_smgr_compress *) rec;
+
+		appendStringInfo(buf, "%s method %d",
+						 relpathperm(xlrec->rlocator, xlrec->forkNum).str,
+						 xlrec->method);
+	}
 }
 
 const char *
@@ -53,6 +61,9 @@ smgr_identify(uint8 info)
 		case XLOG_SMGR_TRUNCATE:
 			id = "TRUNCATE";
 			break;
+		case XLOG_SMGR_COMPRESS:
+			id = "COMPRESS";
+			break;
 	}
 
 	return id;
@@ -5,6 +5,10 @@
  *
  * All the actual insertion logic is in spgdoinsert.c.
  *
+ * SP-GiST has no bottom-up build, so a parallel build has the workers and
+ * the leader scan the heap and insert the tuples they read concurrently,
+ * relying on the same buffer locking protocol as regular insertions.
+ *
  * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -17,16 +21,121 @@
 #include "postgres.h"
 
 #include "access/genam.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
 #include "access/spgist_private.h"
+#include "access/table.h"
 #include "access/tableam.h"
+#include "access/xact.h"
 #include "access/xloginsert.h"
+#include "catalog/index.h"
+#include "executor/instrument.h"
 #include "miscadmin.h"
 #include "nodes/execnodes.h"
+#include "pgstat.h"
 #include "storage/bufmgr.h"
 #include "storage/bulk_write.h"
+#include "storage/condition_variable.h"
+#include "storage/proc.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/wait_event.h"
+
+/* Magic numbers for parallel state sharing */
+#define PARALLEL_KEY_SPGIST_SHARED		UINT64CONST(0xE000000000000001)
+#define PARALLEL_KEY_QUERY_TEXT			UINT64CONST(0xE000000000000002)
+#define PARALLEL_KEY_WAL_USAGE			UINT64CONST(0xE000000000000003)
+#define PARALLEL_KEY_BUFFER_USAGE		UINT64CONST(0xE000000000000004)
 
+/*
+ * Status for index builds performed in parallel.  This is allocated in a
+ * dynamic shared memory segment.
+ */
+typedef struct SpgShared
+{
+	/*
+	 * These fields are not modified during the build.  They primarily exist
+	 * for the benefit of worker processes that need to create state
+	 * corresponding to that used by the leader.
+	 */
+	Oid			heaprelid;
+	Oid			indexrelid;
+	bool		isconcurrent;
+
+	/* Query ID, for report in worker processes */
+	int64		queryid;
+
+	/*
+	 * workersdonecv is used to monitor the progress of workers.  All parallel
+	 * participants must indicate that they are done before leader can finish
+	 * the index.
+	 */
+	ConditionVariable workersdonecv;
+
+	/* mutex protects the mutable fields that follow */
+	slock_t		mutex;
+
+	/*
+	 * Mutable state that is maintained by workers, and reported back to
+	 * leader at end of the scans.
+	 *
+	 * nparticipantsdone is number of worker processes finished.
+	 *
+	 * reltuples is the total number of input heap tuples.
+	 *
+	 * indtuples is the total number of tuples that made it into the index.
+	 */
+	int			nparticipantsdone;
+	double		reltuples;
+	double		indtuples;
+
+	/*
+	 * ParallelTableScanDescData data follows. Can't directly embed here, as
+	 * implementations of the parallel table scan desc interface might need
+	 * stronger alignment.
+	 */
+} SpgShared;
+
+/*
+ * Return pointer to a SpgShared's parallel table scan.
+ *
+ * c.f. shm_toc_allocate as to why BUFFERALIGN is used, rather than just
+ * MAXALIGN.
+ */
+#define ParallelTableScanFromSpgShared(shared) \
+	(ParallelTableScanDesc) ((char *) (shared) + BUFFERALIGN(sizeof(SpgShared)))
+
+/*
+ * Status for leader in parallel index build.
+ */
+typedef struct SpgLeader
+{
+	/* parallel context itself */
+	ParallelContext *pcxt;
+
+	/*
+	 * nparticipants is the exact number of worker processes successfully
+	 * launched, plus one leader process if it participates as a worker (only
+	 * DISABLE_LEADER_PARTICIPATION builds avoid leader participating as a
+	 * worker).
+	 */
+	int			nparticipants;
+
+	/*
+	 * Leader process convenience pointers to shared state (leader avoids TOC
+	 * lookups).
+	 *
+	 * spgshared is the shared state for entire build.  snapshot is the
+	 * snapshot used by the scan iff an MVCC snapshot is required.
+	 */
+	SpgShared  *spgshared;
+	Snapshot	snapshot;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+} SpgLeader;
 
 typedef struct
 {
@@ -35,6 +144,15 @@ typedef struct
 	MemoryContext tmpCtx;		/* per-tuple temporary context */
 } SpGistBuildState;
 
+static SpgLeader *_spg_begin_parallel(Relation heap, Relation index,
+									  bool isconcurrent, int request);
+static void _spg_end_parallel(SpgLeader *spgleader);
+static Size _spg_parallel_estimate_shared(Relation heap, Snapshot snapshot);
+static double _spg_parallel_heapscan(SpgLeader *spgleader, int64 *indtuples);
+static void _spg_parallel_scan_and_build(SpgShared *spgshared,
+										 Relation heap, Relation index,
+										 bool progress);
+
 
 /* Callback to process one heap tuple during table_index_build_scan */
 static void
@@ -48,9 +166,10 @@ spgistBuildCallback(Relation index, ItemPointer tid, Datum *values,
 	oldCtx = MemoryContextSwitchTo(buildstate->tmpCtx);
 
 	/*
-	 * Even though no concurrent insertions can be happening, we still might
-	 * get a buffer-locking failure due to bgwriter or checkpointer taking a
-	 * lock on some buffer.  So we need to be willing to retry.  We can flush
+	 * Even when no concurrent insertions can be happening, we still might get
+	 * a buffer-locking failure due to bgwriter or checkpointer taking a lock
+	 * on some buffer; and in a parallel build, the other participants do
+	 * insert concurrently.  So we need to be willing to retry.  We can flush
 	 * any temp data when retrying.
 	 */
 	while (!spgdoinsert(index, &buildstate->spgstate, tid,
@@ -75,6 +194,7 @@ spgbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	IndexBuildResult *result;
 	double		reltuples;
 	SpGistBuildState buildstate;
+	SpgLeader  *spgleader = NULL;
 	Buffer		metabuffer,
 				rootbuffer,
 				nullbuffer;
@@ -111,27 +231,42 @@ spgbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 	UnlockReleaseBuffer(nullbuffer);
 
 	/*
-	 * Now insert all the heap data into the index
+	 * Now insert all the heap data into the index, in parallel if requested
+	 * and if at least one worker process can be launched.
 	 */
-	initSpGistState(&buildstate.spgstate, index);
-	buildstate.spgstate.isBuild = true;
-	buildstate.indtuples = 0;
+	if (indexInfo->ii_ParallelWorkers > 0)
+		spgleader = _spg_begin_parallel(heap, index,
+										indexInfo->ii_Concurrent,
+										indexInfo->ii_ParallelWorkers);
 
-	buildstate.tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
-											  "SP-GiST build temporary context",
-											  ALLOCSET_DEFAULT_SIZES);
+	if (spgleader)
+	{
+		reltuples = _spg_parallel_heapscan(spgleader, &buildstate.indtuples);
+		_spg_end_parallel(spgleader);
+	}
+	else
+	{
+		initSpGistState(&buildstate.spgstate, index);
+		buildstate.spgstate.isBuild = true;
+		buildstate.indtuples = 0;
 
-	reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
-									   spgistBuildCallback, &buildstate,
-									   NULL);
+		buildstate.tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+												  "SP-GiST build temporary context",
+												  ALLOCSET_DEFAULT_SIZES);
 
-	MemoryContextDelete(buildstate.tmpCtx);
+		reltuples = table_index_build_scan(heap, index, indexInfo, true, true,
+										   spgistBuildCallback, &buildstate,
+										   NULL);
+
+		MemoryContextDelete(buildstate.tmpCtx);
+	}
 
 	SpGistUpdateMetaPage(index);
 
 	/*
 	 * We didn't write WAL records as we built the index, so if WAL-logging is
-	 * required, write all pages to the WAL now.
+	 * required, write all pages to the WAL now.  That includes the pages
+	 * written by parallel workers, which are all done by now.
 	 */
 	if (RelationNeedsWAL(index))
 	{
@@ -217,3 +352,365 @@ spginsert(Relation index, Datum *values, bool *isnull,
 	/* return false since we've not done any unique check */
 	return false;
 }
+
+/*
+ * Create parallel context, and launch workers for leader.
+ *
+ * isconcurrent indicates if operation is CREATE INDEX CONCURRENTLY.
+ *
+ * request is the target number of parallel worker processes to launch.
+ *
+ * Returns the SpgLeader, which caller must use to wait for the end of the
+ * build and to shut down parallel mode.  The leader has done its share of
+ * the insertions by the time this returns.  If not even a single worker
+ * process can be launched, returns NULL, and caller should proceed with a
+ * serial index build.
+ */
+static SpgLeader *
+_spg_begin_parallel(Relation heap, Relation index, bool isconcurrent,
+					int request)
+{
+	ParallelContext *pcxt;
+	Snapshot	snapshot;
+	Size		estspgshared;
+	SpgShared  *spgshared;
+	SpgLeader  *spgleader = palloc0_object(SpgLeader);
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	bool		leaderparticipates = true;
+	int			querylen;
+
+#ifdef DISABLE_LEADER_PARTICIPATION
+	leaderparticipates = false;
+#endif
+
+	/*
+	 * Enter parallel mode, and create context for parallel build of spgist
+	 * index
+	 */
+	EnterParallelMode();
+	Assert(request > 0);
+	pcxt = CreateParallelContext("postgres", "_spg_parallel_build_main",
+								 request);
+
+	/*
+	 * Prepare for scan of the base relation.  In a normal index build, we use
+	 * SnapshotAny because we must retrieve all tuples and do our own time
+	 * qual checks (because we have to index RECENTLY_DEAD tuples).  In a
+	 * concurrent build, we take a regular MVCC snapshot and index whatever's
+	 * live according to that.
+	 */
+	if (!isconcurrent)
+		snapshot = SnapshotAny;
+	else
+		snapshot = RegisterSnapshot(GetTransactionSnapshot());
+
+	/*
+	 * Estimate size for our own PARALLEL_KEY_SPGIST_SHARED workspace.
+	 */
+	estspgshared = _spg_parallel_estimate_shared(heap, snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, estspgshared);
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/*
+	 * Estimate space for WalUsage and BufferUsage -- PARALLEL_KEY_WAL_USAGE
+	 * and PARALLEL_KEY_BUFFER_USAGE.
+	 *
+	 * If there are no extensions loaded that care, we could skip this.  We
+	 * have no way of knowing whether anyone's looking at pgWalUsage or
+	 * pgBufferUsage, so do it unconditionally.
+	 */
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/* Finally, estimate PARALLEL_KEY_QUERY_TEXT space */
+	if (debug_query_string)
+	{
+		querylen = strlen(debug_query_string);
+		shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+	else
+		querylen = 0;			/* keep compiler quiet */
+
+	/* Everyone's had a chance to ask for space, so now create the DSM */
+	InitializeParallelDSM(pcxt);
+
+	/* If no DSM segment was available, back out (do serial build) */
+	if (pcxt->seg == NULL)
+	{
+		if (IsMVCCSnapshot(snapshot))
+			UnregisterSnapshot(snapshot);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return NULL;
+	}
+
+	/* Store shared build state, for which we reserved space */
+	spgshared = (SpgShared *) shm_toc_allocate(pcxt->toc, estspgshared);
+	/* Initialize immutable state */
+	spgshared->heaprelid = RelationGetRelid(heap);
+	spgshared->indexrelid = RelationGetRelid(index);
+	spgshared->isconcurrent = isconcurrent;
+	spgshared->queryid = pgstat_get_my_query_id();
+	ConditionVariableInit(&spgshared->workersdonecv);
+	SpinLockInit(&spgshared->mutex);
+
+	/* Initialize mutable state */
+	spgshared->nparticipantsdone = 0;
+	spgshared->reltuples = 0.0;
+	spgshared->indtuples = 0.0;
+
+	table_parallelscan_initialize(heap,
+								  ParallelTableScanFromSpgShared(spgshared),
+								  snapshot);
+
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_SPGIST_SHARED, spgshared);
+
+	/* Store query string for workers */
+	if (debug_query_string)
+	{
+		char	   *sharedquery;
+
+		sharedquery = (char *) shm_toc_allocate(pcxt->toc, querylen + 1);
+		memcpy(sharedquery, debug_query_string, querylen + 1);
+		shm_toc_insert(pcxt->toc, PARALLEL_KEY_QUERY_TEXT, sharedquery);
+	}
+
+	/*
+	 * Allocate space for each worker's WalUsage and BufferUsage; no need to
+	 * initialize.
+	 */
+	walusage = shm_toc_allocate(pcxt->toc,
+								mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_WAL_USAGE, walusage);
+	bufferusage = shm_toc_allocate(pcxt->toc,
+								   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BUFFER_USAGE, bufferusage);
+
+	/* Launch workers, saving status for leader/caller */
+	LaunchParallelWorkers(pcxt);
+	spgleader->pcxt = pcxt;
+	spgleader->nparticipants = pcxt->nworkers_launched;
+	if (leaderparticipates)
+		spgleader->nparticipants++;
+	spgleader->spgshared = spgshared;
+	spgleader->snapshot = snapshot;
+	spgleader->walusage = walusage;
+	spgleader->bufferusage = bufferusage;
+
+	/* If no workers were successfully launched, back out (do serial build) */
+	if (pcxt->nworkers_launched == 0)
+	{
+		_spg_end_parallel(spgleader);
+		return NULL;
+	}
+
+	/* Join heap scan ourselves */
+	if (leaderparticipates)
+		_spg_parallel_scan_and_build(spgshared, heap, index, true);
+
+	/*
+	 * Caller needs to wait for all launched workers when we return.  Make
+	 * sure that the failure-to-start case will not hang forever.
+	 */
+	WaitForParallelWorkersToAttach(pcxt);
+
+	return spgleader;
+}
+
+/*
+ * Shut down workers, destroy parallel context, and end parallel mode.
+ */
+static void
+_spg_end_parallel(SpgLeader *spgleader)
+{
+	int			i;
+
+	/* Shutdown worker processes */
+	WaitForParallelWorkersToFinish(spgleader->pcxt);
+
+	/*
+	 * Next, accumulate WAL usage.  (This must wait for the workers to finish,
+	 * or we might get incomplete data.)
+	 */
+	for (i = 0; i < spgleader->pcxt->nworkers_launched; i++)
+		InstrAccumParallelQuery(&spgleader->bufferusage[i], &spgleader->walusage[i]);
+
+	/* Free last reference to MVCC snapshot, if one was used */
+	if (IsMVCCSnapshot(spgleader->snapshot))
+		UnregisterSnapshot(spgleader->snapshot);
+	DestroyParallelContext(spgleader->pcxt);
+	ExitParallelMode();
+}
+
+/*
+ * Returns size of shared memory required to store state for a parallel
+ * spgist index build based on the snapshot its parallel scan will use.
+ */
+static Size
+_spg_parallel_estimate_shared(Relation heap, Snapshot snapshot)
+{
+	/* c.f. shm_toc_allocate as to why BUFFERALIGN is used */
+	return add_size(BUFFERALIGN(sizeof(SpgShared)),
+					table_parallelscan_estimate(heap, snapshot));
+}
+
+/*
+ * Within leader, wait for end of heap scan.
+ *
+ * When called, parallel heap scan started by _spg_begin_parallel() will
+ * already be underway within worker processes (when leader participates
+ * as a worker, we should end up here just as workers are finishing).
+ *
+ * Returns the total number of heap tuples scanned, and sets *indtuples to
+ * the number of tuples inserted.
+ */
+static double
+_spg_parallel_heapscan(SpgLeader *spgleader, int64 *indtuples)
+{
+	SpgShared  *spgshared = spgleader->spgshared;
+	double		reltuples;
+
+	for (;;)
+	{
+		SpinLockAcquire(&spgshared->mutex);
+		if (spgshared->nparticipantsdone == spgleader->nparticipants)
+		{
+			reltuples = spgshared->reltuples;
+			*indtuples = (int64) spgshared->indtuples;
+			SpinLockRelease(&spgshared->mutex);
+			break;
+		}
+		SpinLockRelease(&spgshared->mutex);
+
+		ConditionVariableSleep(&spgshared->workersdonecv,
+							   WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN);
+	}
+
+	ConditionVariableCancelSleep();
+
+	return reltuples;
+}
+
+/*
+ * Perform a worker's portion of a parallel build.
+ *
+ * This inserts the tuples of the worker portion of the table in the index.
+ * The insertions are not WAL-logged, as in a serial build; the leader logs
+ * all the pages once the workers are done.
+ *
+ * When this returns, workers are done, and need only release resources.
+ */
+static void
+_spg_parallel_scan_and_build(SpgShared *spgshared, Relation heap,
+							 Relation index, bool progress)
+{
+	SpGistBuildState buildstate;
+	TableScanDesc scan;
+	double		reltuples;
+	IndexInfo  *indexInfo;
+
+	initSpGistState(&buildstate.spgstate, index);
+	buildstate.spgstate.isBuild = true;
+	buildstate.indtuples = 0;
+
+	buildstate.tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+											  "SP-GiST build temporary context",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	/* Join parallel scan */
+	indexInfo = BuildIndexInfo(index);
+	indexInfo->ii_Concurrent = spgshared->isconcurrent;
+
+	scan = table_beginscan_parallel(heap,
+									ParallelTableScanFromSpgShared(spgshared),
+									SO_NONE);
+
+	reltuples = table_index_build_scan(heap, index, indexInfo, true, progress,
+									   spgistBuildCallback, &buildstate, scan);
+
+	MemoryContextDelete(buildstate.tmpCtx);
+
+	/*
+	 * Done.  Record ambuild statistics.
+	 */
+	SpinLockAcquire(&spgshared->mutex);
+	spgshared->nparticipantsdone++;
+	spgshared->reltuples += reltuples;
+	spgshared->indtuples += buildstate.indtuples;
+	SpinLockRelease(&spgshared->mutex);
+
+	/* Notify leader */
+	ConditionVariableSignal(&spgshared->workersdonecv);
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void
+_spg_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+	char	   *sharedquery;
+	SpgShared  *spgshared;
+	Relation	heapRel;
+	Relation	indexRel;
+	LOCKMODE	heapLockmode;
+	LOCKMODE	indexLockmode;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+
+	/*
+	 * The only possible status flag that can be set to the parallel worker is
+	 * PROC_IN_SAFE_IC.
+	 */
+	Assert((MyProc->statusFlags == 0) ||
+		   (MyProc->statusFlags == PROC_IN_SAFE_IC));
+
+	/* Set debug_query_string for individual workers first */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_KEY_QUERY_TEXT, true);
+	debug_query_string = sharedquery;
+
+	/* Report the query string from leader */
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	/* Look up spgist shared state */
+	spgshared = shm_toc_lookup(toc, PARALLEL_KEY_SPGIST_SHARED, false);
+
+	/* Open relations using lock modes known to be obtained by index.c */
+	if (!spgshared->isconcurrent)
+	{
+		heapLockmode = ShareLock;
+		indexLockmode = AccessExclusiveLock;
+	}
+	else
+	{
+		heapLockmode = ShareUpdateExclusiveLock;
+		indexLockmode = RowExclusiveLock;
+	}
+
+	/* Track query ID */
+	pgstat_report_query_id(spgshared->queryid, false);
+
+	/* Open relations within worker */
+	heapRel = table_open(spgshared->heaprelid, heapLockmode);
+	indexRel = index_open(spgshared->indexrelid, indexLockmode);
+
+	/* Prepare to track buffer usage during parallel execution */
+	InstrStartParallelQuery();
+
+	_spg_parallel_scan_and_build(spgshared, heapRel, indexRel, false);
+
+	/* Report WAL/buffer usage during parallel execution */
+	bufferusage = shm_toc_lookup(toc, PARALLEL_KEY_BUFFER_USAGE, false);
+	walusage = shm_toc_lookup(toc, PARALLEL_KEY_WAL_USAGE, false);
+	InstrEndParallelQuery(&bufferusage[ParallelWorkerNumber],
+						  &walusage[ParallelWorkerNumber]);
+
+	index_close(indexRel, indexLockmode);
+	table_close(heapRel, heapLockmode);
+}
@@ -63,7 +63,7 @@ spghandler(PG_FUNCTION_ARGS)
 		.amclusterable = false,
 		.ampredlocks = false,
 		.amcanparallel = false,
-		.amcanbuildparallel = false,
+		.amcanbuildparallel = true,
 		.amcaninclude = true,
 		.amusemaintenanceworkmem = false,
 		.amsummarizing = false,
@@ -88,6 +88,7 @@ spghandler(PG_FUNCTION_ARGS)
 		.ambeginscan = spgbeginscan,
 		.amrescan = spgrescan,
 		.amgettuple = spggettuple,
+		.amgetbatch = NULL,
 		.amgetbitmap = spggetbitmap,
 		.amendscan = spgendscan,
 		.ammarkpos = NULL,
@@ -80,6 +80,11 @@ GetTableAmRoutine(Oid amhandler)
 	Assert(routine->relation_copy_data != NULL);
 	Assert(routine->relation_copy_for_cluster != NULL);
 	Assert(routine->relation_vacuum != NULL);
+	/* parallel vacuum of the table is optional, but all or nothing */
+	Assert((routine->parallel_vacuum_compute_workers == NULL) ==
+		   (routine->parallel_vacuum_estimate == NULL));
+	Assert((routine->parallel_vacuum_compute_workers == NULL) ==
+		   (routine->parallel_vacuum_worker == NULL));
 	Assert(routine->scan_analyze_next_block != NULL);
 	Assert(routine->scan_analyze_next_tuple != NULL);
 	Assert(routine->index_build_range_scan != NULL);
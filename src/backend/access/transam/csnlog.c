@@ -0,0 +1,359 @@
+/*-------------------------------------------------------------------------
+ *
+ * csnlog.c
+ *		PostgreSQL commit sequence number log manager
+ *
+ * When csn_snapshots is enabled, the pg_csn manager records for each
+ * top-level transaction the commit sequence number (CSN) at which it
+ * completed, i.e. the value of TransamVariables->xactCompletionCount right
+ * after the transaction was removed from the proc array.  A snapshot then
+ * needs nothing more than the completion count at the time it was taken:
+ * a transaction is visible to it if it completed with a CSN not above the
+ * snapshot's.  See XidInMVCCSnapshot().
+ *
+ * Entries are set whether the transaction committed or aborted; pg_xact
+ * still decides which.  Subtransactions don't get entries of their own,
+ * since they complete together with their top-level transaction, so
+ * lookups go through pg_subtrans for them.
+ *
+ * Like pg_subtrans, the log is only needed for transactions that might still
+ * be considered running by someone, so it need not survive a crash and has
+ * no XLOG interactions.  During database startup, we simply force the
+ * currently-active pages to zeroes.  The log is not maintained during
+ * recovery, where snapshots are built from KnownAssignedXids instead.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/access/transam/csnlog.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/csnlog.h"
+#include "access/slru.h"
+#include "access/transam.h"
+#include "miscadmin.h"
+#include "storage/subsystems.h"
+
+
+/*
+ * Defines for CSNLog page sizes.  A page is the same BLCKSZ as is used
+ * everywhere else in Postgres.
+ *
+ * Note: as with pg_subtrans, page numbering wraps around at
+ * 0xFFFFFFFF/CSNLOG_XACTS_PER_PAGE.  We need take no explicit notice of that
+ * fact in this module, except when comparing page numbers in TruncateCSNLog
+ * (see CSNLogPagePrecedes) and zeroing them in StartupCSNLog.
+ */
+
+/* We need eight bytes per xact */
+#define CSNLOG_XACTS_PER_PAGE (BLCKSZ / sizeof(uint64))
+
+static inline int64
+TransactionIdToPage(TransactionId xid)
+{
+	return xid / (int64) CSNLOG_XACTS_PER_PAGE;
+}
+
+#define TransactionIdToEntry(xid) ((xid) % (TransactionId) CSNLOG_XACTS_PER_PAGE)
+
+/* GUC variable */
+bool		csn_snapshots = false;
+
+static void CSNLogShmemRequest(void *arg);
+static void CSNLogShmemInit(void *arg);
+static bool CSNLogPagePrecedes(int64 page1, int64 page2);
+static int	csnlog_errdetail_for_io_error(const void *opaque_data);
+
+const ShmemCallbacks CSNLogShmemCallbacks = {
+	.request_fn = CSNLogShmemRequest,
+	.init_fn = CSNLogShmemInit,
+};
+
+/*
+ * Link to shared-memory data structures for CSNLog control
+ */
+static SlruDesc CSNLogSlruDesc;
+
+#define CSNLogCtl  (&CSNLogSlruDesc)
+
+/*
+ * Single-item cache for the last completed transaction looked up; see
+ * cachedFetchXid in transam.c.  A CSN never changes once set, so this needs
+ * no invalidation.
+ */
+static TransactionId cachedCSNXid = InvalidTransactionId;
+static uint64 cachedCSN;
+
+
+/*
+ * Record the commit sequence number of a completed top-level transaction.
+ *
+ * Called with ProcArrayLock held exclusively, so that the entry is in place
+ * before any snapshot that considers the transaction completed can be taken.
+ */
+void
+CSNLogSetCommitSeqNo(TransactionId xid, uint64 csn)
+{
+	int64		pageno = TransactionIdToPage(xid);
+	int			entryno = TransactionIdToEntry(xid);
+	int			slotno;
+	LWLock	   *lock;
+	uint64	   *ptr;
+
+	Assert(csn_snapshots);
+	Assert(TransactionIdIsNormal(xid));
+	Assert(csn != InvalidCommitSeqNo);
+
+	lock = SimpleLruGetBankLock(CSNLogCtl, pageno);
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+
+	slotno = SimpleLruReadPage(CSNLogCtl, pageno, true, &xid);
+	ptr = (uint64 *) CSNLogCtl->shared->page_buffer[slotno];
+	ptr += entryno;
+
+	Assert(*ptr == InvalidCommitSeqNo);
+	*ptr = csn;
+	CSNLogCtl->shared->page_dirty[slotno] = true;
+
+	LWLockRelease(lock);
+}
+
+/*
+ * Interrogate the commit sequence number of a transaction.
+ *
+ * Returns InvalidCommitSeqNo if the transaction hasn't completed yet, or if
+ * it is a subtransaction.
+ */
+uint64
+CSNLogGetCommitSeqNo(TransactionId xid)
+{
+	int64		pageno = TransactionIdToPage(xid);
+	int			entryno = TransactionIdToEntry(xid);
+	int			slotno;
+	uint64	   *ptr;
+	uint64		csn;
+
+	Assert(csn_snapshots);
+
+	if (!TransactionIdIsNormal(xid))
+		return InvalidCommitSeqNo;
+
+	if (TransactionIdEquals(xid, cachedCSNXid))
+		return cachedCSN;
+
+	/* lock is acquired by SimpleLruReadPage_ReadOnly */
+
+	slotno = SimpleLruReadPage_ReadOnly(CSNLogCtl, pageno, &xid);
+	ptr = (uint64 *) CSNLogCtl->shared->page_buffer[slotno];
+	ptr += entryno;
+
+	csn = *ptr;
+
+	LWLockRelease(SimpleLruGetBankLock(CSNLogCtl, pageno));
+
+	if (csn != InvalidCommitSeqNo)
+	{
+		cachedCSNXid = xid;
+		cachedCSN = csn;
+	}
+
+	return csn;
+}
+
+/*
+ * Register shared memory for CSNLog
+ */
+static void
+CSNLogShmemRequest(void *arg)
+{
+	if (!csn_snapshots)
+		return;
+
+	/* Size the buffer pool the way subtransaction_buffers is auto-tuned */
+	SimpleLruRequest(.desc = &CSNLogSlruDesc,
+					 .name = "commit_sequence_number",
+					 .Dir = "pg_csn",
+					 .long_segment_names = false,
+
+					 .nslots = SimpleLruAutotuneBuffers(512, 1024),
+
+					 .sync_handler = SYNC_HANDLER_NONE,
+					 .PagePrecedes = CSNLogPagePrecedes,
+					 .errdetail_for_io_error = csnlog_errdetail_for_io_error,
+
+					 .buffer_tranche_id = LWTRANCHE_CSNLOG_BUFFER,
+					 .bank_tranche_id = LWTRANCHE_CSNLOG_SLRU,
+		);
+}
+
+static void
+CSNLogShmemInit(void *arg)
+{
+	if (!csn_snapshots)
+		return;
+
+	SlruPagePrecedesUnitTests(CSNLogCtl, CSNLOG_XACTS_PER_PAGE);
+}
+
+/*
+ * This must be called ONCE at the end of recovery, or during startup of a
+ * standalone backend, after StartupXLOG has initialized
+ * TransamVariables->nextXid.
+ *
+ * oldestActiveXID is the oldest XID of any prepared transaction, or nextXid
+ * if there are none.
+ */
+void
+StartupCSNLog(TransactionId oldestActiveXID)
+{
+	FullTransactionId nextXid;
+	int64		startPage;
+	int64		endPage;
+	LWLock	   *prevlock = NULL;
+	LWLock	   *lock;
+
+	if (!csn_snapshots)
+		return;
+
+	/*
+	 * Since we don't expect pg_csn to be valid across crashes, we initialize
+	 * the currently-active page(s) to zeroes during startup.  Whenever we
+	 * advance into a new page, ExtendCSNLog will likewise zero the new page
+	 * without regard to whatever was previously on disk.
+	 */
+	startPage = TransactionIdToPage(oldestActiveXID);
+	nextXid = TransamVariables->nextXid;
+	endPage = TransactionIdToPage(XidFromFullTransactionId(nextXid));
+
+	/* Older transactions have no entries; see MaintainCommitSeqNo() */
+	TransamVariables->csnHorizonXid = XidFromFullTransactionId(nextXid);
+
+	for (;;)
+	{
+		lock = SimpleLruGetBankLock(CSNLogCtl, startPage);
+		if (prevlock != lock)
+		{
+			if (prevlock)
+				LWLockRelease(prevlock);
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			prevlock = lock;
+		}
+
+		(void) SimpleLruZeroPage(CSNLogCtl, startPage);
+		if (startPage == endPage)
+			break;
+
+		startPage++;
+		/* must account for wraparound */
+		if (startPage > TransactionIdToPage(MaxTransactionId))
+			startPage = 0;
+	}
+
+	LWLockRelease(lock);
+}
+
+/*
+ * Perform a checkpoint --- either during shutdown, or on-the-fly
+ */
+void
+CheckPointCSNLog(void)
+{
+	if (!csn_snapshots)
+		return;
+
+	/*
+	 * Write dirty CSNLog pages to disk.  As for pg_subtrans, this is only
+	 * done to improve the odds that the writing is done by the checkpointer
+	 * rather than by backends.
+	 */
+	SimpleLruWriteAll(CSNLogCtl, true);
+}
+
+/*
+ * Make sure that CSNLog has room for a newly-allocated XID.
+ *
+ * NB: this is called while holding XidGenLock.  We want it to be very fast
+ * most of the time; even when it's not so fast, no actual I/O need happen
+ * unless we're forced to write out a dirty page to make room in shared
+ * memory.
+ */
+void
+ExtendCSNLog(TransactionId newestXact)
+{
+	int64		pageno;
+	LWLock	   *lock;
+
+	if (!csn_snapshots)
+		return;
+
+	/*
+	 * No work except at first XID of a page.  But beware: just after
+	 * wraparound, the first XID of page zero is FirstNormalTransactionId.
+	 */
+	if (TransactionIdToEntry(newestXact) != 0 &&
+		!TransactionIdEquals(newestXact, FirstNormalTransactionId))
+		return;
+
+	pageno = TransactionIdToPage(newestXact);
+
+	lock = SimpleLruGetBankLock(CSNLogCtl, pageno);
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+
+	/* Zero the page */
+	SimpleLruZeroPage(CSNLogCtl, pageno);
+
+	LWLockRelease(lock);
+}
+
+/*
+ * Remove all CSNLog segments before the one holding the passed transaction ID
+ *
+ * oldestXact is the oldest TransactionXmin of any running transaction.  No
+ * snapshot looks up transactions older than its xmin.  This is called only
+ * during checkpoint.
+ */
+void
+TruncateCSNLog(TransactionId oldestXact)
+{
+	int64		cutoffPage;
+
+	if (!csn_snapshots)
+		return;
+
+	/* See TruncateSUBTRANS() about stepping back one transaction */
+	TransactionIdRetreat(oldestXact);
+	cutoffPage = TransactionIdToPage(oldestXact);
+
+	SimpleLruTruncate(CSNLogCtl, cutoffPage);
+}
+
+
+/*
+ * Decide whether a CSNLog page number is "older" for truncation purposes.
+ * Analogous to CLOGPagePrecedes().
+ */
+static bool
+CSNLogPagePrecedes(int64 page1, int64 page2)
+{
+	TransactionId xid1;
+	TransactionId xid2;
+
+	xid1 = ((TransactionId) page1) * CSNLOG_XACTS_PER_PAGE;
+	xid1 += FirstNormalTransactionId + 1;
+	xid2 = ((TransactionId) page2) * CSNLOG_XACTS_PER_PAGE;
+	xid2 += FirstNormalTransactionId + 1;
+
+	return (TransactionIdPrecedes(xid1, xid2) &&
+			TransactionIdPrecedes(xid1, xid2 + CSNLOG_XACTS_PER_PAGE - 1));
+}
+
+static int
+csnlog_errdetail_for_io_error(const void *opaque_data)
+{
+	TransactionId xid = *(const TransactionId *) opaque_data;
+
+	return errdetail("Could not access commit sequence number of transaction %u.", xid);
+}
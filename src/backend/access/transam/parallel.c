@@ -16,9 +16,12 @@
 
 #include "access/brin.h"
 #include "access/gin.h"
+#include "access/gist_private.h"
+#include "access/hash.h"
 #include "access/nbtree.h"
 #include "access/parallel.h"
 #include "access/session.h"
+#include "access/spgist.h"
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/index.h"
@@ -154,6 +157,15 @@ static const struct
 	{
 		"_gin_parallel_build_main", _gin_parallel_build_main
 	},
+	{
+		"_hash_parallel_build_main", _hash_parallel_build_main
+	},
+	{
+		"_gist_parallel_build_main", _gist_parallel_build_main
+	},
+	{
+		"_spg_parallel_build_main", _spg_parallel_build_main
+	},
 	{
 		"parallel_vacuum_main", parallel_vacuum_main
 	}
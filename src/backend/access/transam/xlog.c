@@ -48,6 +48,7 @@
 
 #include "access/clog.h"
 #include "access/commit_ts.h"
+#include "access/csnlog.h"
 #include "access/heaptoast.h"
 #include "access/multixact.h"
 #include "access/rewriteheap.h"
@@ -69,6 +70,7 @@
 #include "catalog/pg_database.h"
 #include "common/controldata_utils.h"
 #include "common/file_utils.h"
+#include "common/hashfn.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
@@ -154,7 +156,7 @@ int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
  * to happen concurrently, but adds some CPU overhead to flushing the WAL,
  * which needs to iterate all the locks.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+int			wal_insert_locks = 8;
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -400,29 +402,55 @@ static SessionBackupState sessionBackupState = SESSION_BACKUP_NONE;
 /*
  * Shared state data for WAL insertion.
  */
-typedef struct XLogCtlInsert
+/*
+ * An entry in the table of prev-links, see ReserveXLogInsertLocation().
+ * endpos is the end of a reserved record, as a "usable byte position", or 0
+ * if the entry is unused.  startpos is the start of the same record.
+ */
+typedef struct XLogPrevLink
 {
-	slock_t		insertpos_lck;	/* protects CurrBytePos and PrevBytePos */
+	pg_atomic_uint64 endpos;
+	uint64		startpos;
+} XLogPrevLink;
 
+/* Marks a prev-link entry that is being filled in */
+#define PREVLINK_CLAIMED	PG_UINT64_MAX
+
+/*
+ * How many times to spin waiting for a prev-link entry to be published, before
+ * falling back to sleeping PREVLINK_SLEEP_USEC at a time.
+ */
+#define PREVLINK_MAX_SPINS	1000
+#define PREVLINK_SLEEP_USEC	100L
+
+typedef struct XLogCtlInsert
+{
 	/*
 	 * CurrBytePos is the end of reserved WAL. The next record will be
-	 * inserted at that position. PrevBytePos is the start position of the
-	 * previously inserted (or rather, reserved) record - it is copied to the
-	 * prev-link of the next record. These are stored as "usable byte
-	 * positions" rather than XLogRecPtrs (see XLogBytePosToRecPtr()).
+	 * inserted at that position. It is stored as a "usable byte position"
+	 * rather than a XLogRecPtr (see XLogBytePosToRecPtr()), and advanced
+	 * with an atomic fetch-add.
 	 */
-	uint64		CurrBytePos;
-	uint64		PrevBytePos;
+	pg_atomic_uint64 CurrBytePos;
 
 	/*
-	 * Make sure the above heavily-contended spinlock and byte positions are
-	 * on their own cache line. In particular, the RedoRecPtr and full page
-	 * write variables below should be on a different cache line. They are
-	 * read on every WAL insertion, but updated rarely, and we don't want
-	 * those reads to steal the cache line containing Curr/PrevBytePos.
+	 * Make sure the above heavily-contended byte position is on its own
+	 * cache line. In particular, the RedoRecPtr and full page write variables
+	 * below should be on a different cache line. They are read on every WAL
+	 * insertion, but updated rarely, and we don't want those reads to steal
+	 * the cache line containing CurrBytePos.
 	 */
 	char		pad[PG_CACHE_LINE_SIZE];
 
+	/*
+	 * The start position of the previously reserved record, which is copied
+	 * to the prev-link of the next record, is passed on through the
+	 * PrevLinks table, see ReserveXLogInsertLocation().  PrevLinksMask is the
+	 * table size minus one.  These never change after initialization.
+	 */
+	XLogPrevLink *PrevLinks;
+	int			PrevLinksMask;
+
 	/*
 	 * fullPageWrites is the authoritative value used by all backends to
 	 * determine whether to write full-page image to WAL. This shared value,
@@ -577,6 +605,9 @@ static XLogCtlData *XLogCtl = NULL;
 /* a private copy of XLogCtl->Insert.WALInsertLocks, for convenience */
 static WALInsertLockPadded *WALInsertLocks = NULL;
 
+/* number of entries in the prev-link table, for the given number of locks */
+#define PREVLINKS_SIZE(nlocks)	pg_nextpower2_32(2 * ((nlocks) + 1))
+
 /*
  * We maintain an image of pg_control in shared memory.
  */
@@ -828,8 +859,8 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * record to the shared WAL buffer cache is a two-step process:
 	 *
 	 * 1. Reserve the right amount of space from the WAL. The current head of
-	 *	  reserved space is kept in Insert->CurrBytePos, and is protected by
-	 *	  insertpos_lck.
+	 *	  reserved space is kept in Insert->CurrBytePos, and is advanced
+	 *	  with an atomic fetch-add.
 	 *
 	 * 2. Copy the record to the reserved WAL space. This involves finding the
 	 *	  correct WAL buffer containing the reserved space, and copying the
@@ -839,7 +870,7 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
 	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * determined by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1127,6 +1158,101 @@ XLogInsertRecord(XLogRecData *rdata,
 	return EndPos;
 }
 
+/*
+ * Publish the prev-link of a record that has just been reserved, spanning the
+ * usable byte positions from startbytepos to endbytepos.  The record that is
+ * reserved next, starting at endbytepos, will pick it up with
+ * XLogPrevLinkConsume().
+ *
+ * The caller must hold a WAL insertion lock.  Each entry in the table is
+ * consumed by the inserter that reserved the following record, which holds an
+ * insertion lock while doing so, so there can be at most one entry per
+ * insertion lock plus one for the latest record at any time.  The table has
+ * room for twice that, so we always find a free entry quickly.
+ */
+static inline void
+XLogPrevLinkPublish(uint64 startbytepos, uint64 endbytepos)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	int			mask = Insert->PrevLinksMask;
+	int			idx = (int) (murmurhash64(endbytepos) & mask);
+
+	Assert(endbytepos != 0 && endbytepos != PREVLINK_CLAIMED);
+
+	for (;;)
+	{
+		XLogPrevLink *link = &Insert->PrevLinks[idx];
+		uint64		expected = 0;
+
+		if (pg_atomic_read_u64(&link->endpos) == 0 &&
+			pg_atomic_compare_exchange_u64(&link->endpos, &expected,
+										   PREVLINK_CLAIMED))
+		{
+			/* make startpos visible before endpos */
+			link->startpos = startbytepos;
+			pg_write_barrier();
+			pg_atomic_write_u64(&link->endpos, endbytepos);
+			return;
+		}
+		idx = (idx + 1) & mask;
+	}
+}
+
+/*
+ * Find the start of the record that ends at usable byte position bytepos, and
+ * remove its entry from the prev-link table.
+ *
+ * The entry may not have been published yet, if the inserter that reserved the
+ * previous record has not got around to it.  In that case, wait for it.  It
+ * publishes the entry right after reserving its record, without waiting for
+ * anything, so normally we only spin for a short while.  But it may have been
+ * descheduled in between, in which case we sleep until it gets to run again.
+ * perform_spin_delay() is not used, as it would PANIC if the wait took too
+ * long, and we're in a critical section.
+ */
+static inline uint64
+XLogPrevLinkConsume(uint64 bytepos)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	int			mask = Insert->PrevLinksMask;
+	int			home = (int) (murmurhash64(bytepos) & mask);
+	int			spins = 0;
+
+	for (;;)
+	{
+		/*
+		 * Entries are usually found at or right after their home position,
+		 * but as entries are removed in no particular order, it can be
+		 * anywhere.
+		 */
+		for (int i = 0; i <= mask; i++)
+		{
+			XLogPrevLink *link = &Insert->PrevLinks[(home + i) & mask];
+
+			if (pg_atomic_read_u64(&link->endpos) == bytepos)
+			{
+				uint64		startbytepos;
+
+				pg_read_barrier();
+				startbytepos = link->startpos;
+
+				/* we're the only consumer, so a plain write will do */
+				pg_atomic_write_u64(&link->endpos, 0);
+
+				return startbytepos;
+			}
+		}
+
+		if (spins < PREVLINK_MAX_SPINS)
+		{
+			spins++;
+			pg_spin_delay();
+		}
+		else
+			pg_usleep(PREVLINK_SLEEP_USEC);
+	}
+}
+
 /*
  * Reserves the right amount of space for a record of given size from the WAL.
  * *StartPos is set to the beginning of the reserved section, *EndPos to
@@ -1134,9 +1260,10 @@ XLogInsertRecord(XLogRecData *rdata,
  * used to set the xl_prev of this record.
  *
  * This is the performance critical part of XLogInsert that must be serialized
- * across backends. The rest can happen mostly in parallel. Try to keep this
- * section as short as possible, insertpos_lck can be heavily contended on a
- * busy system.
+ * across backends. The rest can happen mostly in parallel.  The serialized
+ * part is a single atomic fetch-add on CurrBytePos.  The prev-link is then
+ * handed over from the inserter of the previous record through the PrevLinks
+ * table, which doesn't require any serialization beyond that.
  *
  * NB: The space calculation here must match the code in CopyXLogRecordToWAL,
  * where we actually copy the record to the reserved space.
@@ -1160,24 +1287,22 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	Assert(size > SizeOfXLogRecord);
 
 	/*
-	 * The duration the spinlock needs to be held is minimized by minimizing
-	 * the calculations that have to be done while holding the lock. The
-	 * current tip of reserved WAL is kept in CurrBytePos, as a byte position
-	 * that only counts "usable" bytes in WAL, that is, it excludes all WAL
-	 * page headers. The mapping between "usable" byte positions and physical
-	 * positions (XLogRecPtrs) can be done outside the locked region, and
+	 * The current tip of reserved WAL is kept in CurrBytePos, as a byte
+	 * position that only counts "usable" bytes in WAL, that is, it excludes
+	 * all WAL page headers. The mapping between "usable" byte positions and
+	 * physical positions (XLogRecPtrs) can be done after the reservation, and
 	 * because the usable byte position doesn't include any headers, reserving
-	 * X bytes from WAL is almost as simple as "CurrBytePos += X".
+	 * X bytes from WAL is as simple as "CurrBytePos += X".
 	 */
-	SpinLockAcquire(&Insert->insertpos_lck);
-
-	startbytepos = Insert->CurrBytePos;
+	startbytepos = pg_atomic_fetch_add_u64(&Insert->CurrBytePos, size);
 	endbytepos = startbytepos + size;
-	prevbytepos = Insert->PrevBytePos;
-	Insert->CurrBytePos = endbytepos;
-	Insert->PrevBytePos = startbytepos;
 
-	SpinLockRelease(&Insert->insertpos_lck);
+	/*
+	 * Pass on our start position to the next record before waiting for our
+	 * own prev-link, so that insertions don't wait on each other in a chain.
+	 */
+	XLogPrevLinkPublish(startbytepos, endbytepos);
+	prevbytepos = XLogPrevLinkConsume(startbytepos);
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1213,25 +1338,22 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 	uint32		segleft;
 
 	/*
-	 * These calculations are a bit heavy-weight to be done while holding a
-	 * spinlock, but since we're holding all the WAL insertion locks, there
-	 * are no other inserters competing for it. GetXLogInsertRecPtr() does
-	 * compete for it, but that's not called very frequently.
+	 * Since we're holding all the WAL insertion locks, there are no other
+	 * inserters competing for CurrBytePos, so we can do these calculations
+	 * before advancing it.
 	 */
-	SpinLockAcquire(&Insert->insertpos_lck);
+	Assert(holdingAllLocks);
 
-	startbytepos = Insert->CurrBytePos;
+	startbytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 
 	ptr = XLogBytePosToEndRecPtr(startbytepos);
 	if (XLogSegmentOffset(ptr, wal_segment_size) == 0)
 	{
-		SpinLockRelease(&Insert->insertpos_lck);
 		*EndPos = *StartPos = ptr;
 		return false;
 	}
 
 	endbytepos = startbytepos + size;
-	prevbytepos = Insert->PrevBytePos;
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1243,10 +1365,10 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 		*EndPos += segleft;
 		endbytepos = XLogRecPtrToBytePos(*EndPos);
 	}
-	Insert->CurrBytePos = endbytepos;
-	Insert->PrevBytePos = startbytepos;
+	pg_atomic_write_u64(&Insert->CurrBytePos, endbytepos);
 
-	SpinLockRelease(&Insert->insertpos_lck);
+	XLogPrevLinkPublish(startbytepos, endbytepos);
+	prevbytepos = XLogPrevLinkConsume(startbytepos);
 
 	*PrevPtr = XLogBytePosToRecPtr(prevbytepos);
 
@@ -1427,7 +1549,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProcNumber % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProcNumber % wal_insert_locks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1445,7 +1567,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % wal_insert_locks;
 	}
 }
 
@@ -1463,7 +1585,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < wal_insert_locks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1489,7 +1611,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < wal_insert_locks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1517,8 +1639,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[wal_insert_locks - 1].l.lock,
+						&WALInsertLocks[wal_insert_locks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1562,10 +1684,11 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	if (upto <= inserted)
 		return inserted;
 
-	/* Read the current insert position */
-	SpinLockAcquire(&Insert->insertpos_lck);
-	bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
+	/*
+	 * Read the current insert position.  Use a barrier, so that any insertion
+	 * that reserved space before it shows up in the insertion locks below.
+	 */
+	bytepos = pg_atomic_read_membarrier_u64(&Insert->CurrBytePos);
 	reservedUpto = XLogBytePosToEndRecPtr(bytepos);
 
 	/*
@@ -1594,7 +1717,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -5323,7 +5446,10 @@ XLOGShmemRequest(void *arg)
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), wal_insert_locks + 1));
+	/* prev-link table */
+	size = add_size(size, mul_size(sizeof(XLogPrevLink),
+								   PREVLINKS_SIZE(wal_insert_locks)));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(pg_atomic_uint64), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -5398,15 +5524,26 @@ XLOGShmemInit(void *arg)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * wal_insert_locks;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		pg_atomic_init_u64(&WALInsertLocks[i].l.insertingAt, InvalidXLogRecPtr);
 		WALInsertLocks[i].l.lastImportantAt = InvalidXLogRecPtr;
 	}
 
+	/* prev-link table, initially empty */
+	XLogCtl->Insert.PrevLinks = (XLogPrevLink *) allocptr;
+	XLogCtl->Insert.PrevLinksMask = PREVLINKS_SIZE(wal_insert_locks) - 1;
+	allocptr += sizeof(XLogPrevLink) * PREVLINKS_SIZE(wal_insert_locks);
+
+	for (i = 0; i < PREVLINKS_SIZE(wal_insert_locks); i++)
+	{
+		pg_atomic_init_u64(&XLogCtl->Insert.PrevLinks[i].endpos, 0);
+		XLogCtl->Insert.PrevLinks[i].startpos = 0;
+	}
+
 	/*
 	 * Align the start of the page buffers to a full xlog block size boundary.
 	 * This simplifies some calculations in XLOG insertion. It is also
@@ -5429,7 +5566,7 @@ XLOGShmemInit(void *arg)
 	XLogCtl->data_checksum_version = ControlFile->data_checksum_version;
 	SetLocalDataChecksumState(XLogCtl->data_checksum_version);
 
-	SpinLockInit(&XLogCtl->Insert.insertpos_lck);
+	pg_atomic_init_u64(&XLogCtl->Insert.CurrBytePos, 0);
 	SpinLockInit(&XLogCtl->info_lck);
 	pg_atomic_init_u64(&XLogCtl->logInsertResult, InvalidXLogRecPtr);
 	pg_atomic_init_u64(&XLogCtl->logWriteResult, InvalidXLogRecPtr);
@@ -6447,8 +6584,9 @@ StartupXLOG(void)
 	 * previous incarnation.
 	 */
 	Insert = &XLogCtl->Insert;
-	Insert->PrevBytePos = XLogRecPtrToBytePos(endOfRecoveryInfo->lastRec);
-	Insert->CurrBytePos = XLogRecPtrToBytePos(EndOfLog);
+	pg_atomic_write_u64(&Insert->CurrBytePos, XLogRecPtrToBytePos(EndOfLog));
+	XLogPrevLinkPublish(XLogRecPtrToBytePos(endOfRecoveryInfo->lastRec),
+						XLogRecPtrToBytePos(EndOfLog));
 
 	/*
 	 * Tricky point here: lastPage contains the *last* block that the LastRec
@@ -6521,6 +6659,9 @@ StartupXLOG(void)
 	if (standbyState == STANDBY_DISABLED)
 		StartupSUBTRANS(oldestActiveXID);
 
+	/* pg_csn is not maintained during recovery, so always start it here */
+	StartupCSNLog(oldestActiveXID);
+
 	/*
 	 * Perform end of recovery actions for any SLRUs that need it.
 	 */
@@ -7060,7 +7201,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < wal_insert_locks; i++)
 	{
 		XLogRecPtr	last_important;
 
@@ -7529,7 +7670,7 @@ CreateCheckPoint(int flags)
 
 	if (shutdown)
 	{
-		XLogRecPtr	curInsert = XLogBytePosToRecPtr(Insert->CurrBytePos);
+		XLogRecPtr	curInsert = XLogBytePosToRecPtr(pg_atomic_read_u64(&Insert->CurrBytePos));
 
 		/*
 		 * Compute new REDO record ptr = location of next XLOG record.
@@ -7873,14 +8014,17 @@ CreateCheckPoint(int flags)
 		PreallocXlogFiles(recptr, checkPoint.ThisTimeLineID);
 
 	/*
-	 * Truncate pg_subtrans if possible.  We can throw away all data before
-	 * the oldest XMIN of any running transaction.  No future transaction will
-	 * attempt to reference any pg_subtrans entry older than that (see Asserts
-	 * in subtrans.c).  During recovery, though, we mustn't do this because
-	 * StartupSUBTRANS hasn't been called yet.
+	 * Truncate pg_subtrans and pg_csn if possible.  We can throw away all
+	 * data before the oldest XMIN of any running transaction.  No future
+	 * transaction will attempt to reference any entry older than that (see
+	 * Asserts in subtrans.c).  During recovery, though, we mustn't do this
+	 * because StartupSUBTRANS hasn't been called yet.
 	 */
 	if (!RecoveryInProgress())
+	{
 		TruncateSUBTRANS(GetOldestTransactionIdConsideredRunning());
+		TruncateCSNLog(GetOldestTransactionIdConsideredRunning());
+	}
 
 	/* Real work is done; log and update stats. */
 	LogCheckpointEnd(false, flags);
@@ -8061,6 +8205,7 @@ CheckPointGuts(XLogRecPtr checkPointRedo, int flags)
 	CheckPointCLOG();
 	CheckPointCommitTs();
 	CheckPointSUBTRANS();
+	CheckPointCSNLog();
 	CheckPointMultiXact();
 	CheckPointPredicate();
 	CheckPointBuffers(flags);
@@ -10098,9 +10243,7 @@ GetXLogInsertRecPtr(void)
 	XLogCtlInsert *Insert = &XLogCtl->Insert;
 	uint64		current_bytepos;
 
-	SpinLockAcquire(&Insert->insertpos_lck);
-	current_bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
+	current_bytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 
 	return XLogBytePosToRecPtr(current_bytepos);
 }
@@ -10114,9 +10257,7 @@ GetXLogInsertEndRecPtr(void)
 	XLogCtlInsert *Insert = &XLogCtl->Insert;
 	uint64		current_bytepos;
 
-	SpinLockAcquire(&Insert->insertpos_lck);
-	current_bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
+	current_bytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
 
 	return XLogBytePosToEndRecPtr(current_bytepos);
 }
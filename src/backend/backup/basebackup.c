@@ -42,7 +42,9 @@
 #include "storage/checksum.h"
 #include "storage/dsm_impl.h"
 #include "storage/ipc.h"
+#include "storage/pagecompress.h"
 #include "storage/reinit.h"
+#include "tcop/sessionpool.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/ps_status.h"
@@ -169,6 +171,9 @@ static const char *const excludeDirContents[] =
 	 */
 	PG_REPLSLOT_DIR,
 
+	/* Contents zeroed on startup, see StartupCSNLog(). */
+	"pg_csn",
+
 	/* Contents removed on startup, see dsm_cleanup_for_mmap(). */
 	PG_DYNSHMEM_DIR,
 
@@ -181,6 +186,9 @@ static const char *const excludeDirContents[] =
 	 */
 	"pg_serial",
 
+	/* Contents removed on startup, see SessionPoolShmemInit(). */
+	PG_SESSIONPOOL_DIR,
+
 	/* Contents removed on startup, see DeleteAllExportedSnapshotFiles(). */
 	"pg_snapshots",
 
@@ -1338,6 +1346,25 @@ sendDir(bbsink *sink, const char *path, int basepathlen, bool sizeonly,
 			}
 		}
 
+		/*
+		 * The data file of a compressed fork does not hold pages at block
+		 * boundaries, so it is sent whole, without checksum verification,
+		 * like its address map.
+		 */
+		if (isRelationFile && relForkNum == MAIN_FORKNUM && segno == 0)
+		{
+			char		mapFile[MAXPGPATH];
+
+			snprintf(mapFile, sizeof(mapFile), "%s/%s%s",
+					 path, de->d_name, PAGE_COMPRESS_MAP_SUFFIX);
+
+			if (lstat(mapFile, &statbuf) == 0)
+			{
+				isRelationFile = false;
+				relfilenumber = InvalidRelFileNumber;
+			}
+		}
+
 		/* Exclude temporary relations */
 		if (OidIsValid(dboid) && looks_like_temp_rel_name(de->d_name))
 		{
@@ -32,6 +32,7 @@
 #include "access/genam.h"
 #include "access/multixact.h"
 #include "access/relation.h"
+#include "access/reloptions.h"
 #include "access/table.h"
 #include "access/tableam.h"
 #include "catalog/binary_upgrade.h"
@@ -1348,6 +1349,26 @@ heap_create_with_catalog(const char *relname,
 
 	new_rel_desc->rd_rel->relrewrite = relrewrite;
 
+	/*
+	 * Compress the new storage if the page_compression option asks for it.
+	 * This is not done for binary upgrade, which brings the files over from
+	 * the old cluster as they are.
+	 */
+	if (!IsBinaryUpgrade && RELKIND_HAS_STORAGE(relkind) &&
+		reloptions != (Datum) 0)
+	{
+		StdRdOptions *options;
+
+		options = (StdRdOptions *) heap_reloptions(relkind, reloptions, false);
+		if (options != NULL)
+		{
+			RelationSetStorageCompression(RelationGetSmgr(new_rel_desc),
+										  relpersistence,
+										  options->page_compression);
+			pfree(options);
+		}
+	}
+
 	/*
 	 * Decide whether to create a pg_type entry for the relation's rowtype.
 	 * These types are made except where the use of a relation as such is an
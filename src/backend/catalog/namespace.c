@@ -50,6 +50,7 @@
 #include "storage/lmgr.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
+#include "tcop/sessionpool.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
@@ -4505,6 +4506,9 @@ InitTempTableNamespace(void)
 				(errcode(ERRCODE_READ_ONLY_SQL_TRANSACTION),
 				 errmsg("cannot create temporary tables during a parallel operation")));
 
+	/* Nor can pooled sessions, since the namespace belongs to the backend */
+	PreventInPooledSession("temporary tables");
+
 	snprintf(namespaceName, sizeof(namespaceName), "pg_temp_%d", MyProcNumber);
 
 	namespaceId = get_namespace_oid(namespaceName, true);
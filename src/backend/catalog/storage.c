@@ -199,6 +199,55 @@ log_smgrcreate(const RelFileLocator *rlocator, ForkNumber forkNum)
 	XLogInsert(RM_SMGR_ID, XLOG_SMGR_CREATE | XLR_SPECIAL_REL_UPDATE);
 }
 
+/*
+ * RelationSetStorageCompression
+ *		Make the main fork of a new relation store its pages compressed.
+ *
+ * This must be called right after RelationCreateStorage(), while the fork is
+ * still empty.  Only permanent relations are compressed, as page compression
+ * is meant for large tables, and the address maps of compressed forks are
+ * not reset along with unlogged relations; method is ignored for others.
+ *
+ * A torn write of a compressed page can't be read back at all, so crash
+ * recovery must be able to restore every page written since the last
+ * checkpoint from a full-page image, including pages that only had hint bits
+ * set.  See _mdpc_write().
+ */
+void
+RelationSetStorageCompression(SMgrRelation srel, char relpersistence,
+							  PageCompressionMethod method)
+{
+	if (relpersistence != RELPERSISTENCE_PERMANENT ||
+		method == PAGE_COMPRESSION_NONE)
+		return;
+
+	if (!XLogHintBitIsNeeded())
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("page compression requires data checksums or \"wal_log_hints\" to be enabled")));
+
+	smgrsetcompression(srel, MAIN_FORKNUM, method, false);
+	log_smgrcompress(&srel->smgr_rlocator.locator, MAIN_FORKNUM, method);
+}
+
+/*
+ * Perform XLogInsert of an XLOG_SMGR_COMPRESS record to WAL.
+ */
+void
+log_smgrcompress(const RelFileLocator *rlocator, ForkNumber forkNum,
+				 int method)
+{
+	xl_smgr_compress xlrec;
+
+	xlrec.rlocator = *rlocator;
+	xlrec.forkNum = forkNum;
+	xlrec.method = method;
+
+	XLogBeginInsert();
+	XLogRegisterData(&xlrec, sizeof(xlrec));
+	XLogInsert(RM_SMGR_ID, XLOG_SMGR_COMPRESS | XLR_SPECIAL_REL_UPDATE);
+}
+
 /*
  * RelationDropStorage
  *		Schedule unlinking of physical storage at transaction commit.
@@ -501,6 +550,11 @@ RelationCopyStorage(SMgrRelation src, SMgrRelation dst,
 	use_wal = XLogIsNeeded() &&
 		(relpersistence == RELPERSISTENCE_PERMANENT || copying_initfork);
 
+	/* Keep the main fork compressed as in the source, see smgrsetcompression() */
+	if (forkNum == MAIN_FORKNUM)
+		RelationSetStorageCompression(dst, relpersistence,
+									  smgrgetcompression(src, forkNum));
+
 	bulkstate = smgr_bulk_start_smgr(dst, forkNum, use_wal);
 
 	nblocks = smgrnblocks(src, forkNum);
@@ -1090,6 +1144,17 @@ smgr_redo(XLogReaderState *record)
 
 		FreeFakeRelcacheEntry(rel);
 	}
+	else if (info == XLOG_SMGR_COMPRESS)
+	{
+		xl_smgr_compress *xlrec = (xl_smgr_compress *) XLogRecGetData(record);
+		SMgrRelation reln;
+
+		/* As for truncation, recreate the relation if it was dropped later */
+		reln = smgropen(xlrec->rlocator, INVALID_PROC_NUMBER);
+		smgrcreate(reln, xlrec->forkNum, true);
+		smgrsetcompression(reln, xlrec->forkNum,
+						   (PageCompressionMethod) xlrec->method, true);
+	}
 	else
 		elog(PANIC, "smgr_redo: unknown op code %u", info);
 }
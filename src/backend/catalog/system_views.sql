@@ -1275,6 +1275,7 @@ SELECT
        b.extend_bytes,
        b.extend_time,
        b.hits,
+       b.remote_hits,
        b.evictions,
        b.reuses,
        b.fsyncs,
@@ -180,6 +180,7 @@
 #include "storage/lmgr.h"
 #include "storage/procsignal.h"
 #include "storage/subsystems.h"
+#include "tcop/sessionpool.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/dsa.h"
@@ -1045,6 +1046,9 @@ Async_Listen(const char *channel)
 	if (Trace_notify)
 		elog(DEBUG1, "Async_Listen(%s,%d)", channel, MyProcPid);
 
+	/* Notifications are delivered to backends, not to sessions */
+	PreventInPooledSession("LISTEN");
+
 	queue_listen(LISTEN_LISTEN, channel);
 }
 
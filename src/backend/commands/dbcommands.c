@@ -68,6 +68,8 @@
 #include "utils/lsyscache.h"
 #include "utils/pg_locale.h"
 #include "utils/relmapper.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 #include "utils/wait_event.h"
@@ -1874,6 +1876,13 @@ dropdb(const char *dbname, bool missing_ok, bool force)
 	 */
 	DropDatabaseBuffers(db_id);
 
+	/*
+	 * Likewise for the shared catalog and plan caches, lest a new database
+	 * that gets the same OID find this one's entries there.
+	 */
+	SharedCatCacheInvalidateAll();
+	SharedPlanCacheInvalidateAll();
+
 	/*
 	 * Tell checkpointer to forget any pending fsync and unlink requests for
 	 * files in the database; else the fsyncs will fail at next checkpoint, or
@@ -3432,6 +3441,10 @@ dbase_redo(XLogReaderState *record)
 		/* Drop pages for this database that are in the shared buffer cache */
 		DropDatabaseBuffers(xlrec->db_id);
 
+		/* Forget its entries in the shared catalog and plan caches too */
+		SharedCatCacheInvalidateAll();
+		SharedPlanCacheInvalidateAll();
+
 		/* Also, clean out any fsync requests that might be pending in md.c */
 		ForgetDatabaseSyncRequests(xlrec->db_id);
 
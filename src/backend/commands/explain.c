@@ -89,6 +89,8 @@ static void show_qual(List *qual, const char *qlabel,
 static void show_scan_qual(List *qual, const char *qlabel,
 						   PlanState *planstate, List *ancestors,
 						   ExplainState *es);
+static void show_bloom_filters(List *filters, PlanState *planstate,
+							   List *ancestors, ExplainState *es);
 static void show_upper_qual(List *qual, const char *qlabel,
 							PlanState *planstate, List *ancestors,
 							ExplainState *es);
@@ -126,6 +128,7 @@ static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 static void show_sort_info(SortState *sortstate, ExplainState *es);
 static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
 									   ExplainState *es);
+static void show_nestloop_info(NestLoopState *nlstate, ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
 static void show_material_info(MaterialState *mstate, ExplainState *es);
 static void show_windowagg_info(WindowAggState *winstate, ExplainState *es);
@@ -2030,6 +2033,13 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (IsA(plan, SeqScan) && ((SeqScan *) plan)->bloomFilters)
+			{
+				show_bloom_filters(((SeqScan *) plan)->bloomFilters,
+								   planstate, ancestors, es);
+				show_instrumentation_count("Rows Removed by Bloom Filters", 2,
+										   planstate, es);
+			}
 			if (IsA(plan, CteScan))
 				show_ctescan_info(castNode(CteScanState, planstate), es);
 			show_scan_io_usage((ScanState *) planstate, es);
@@ -2181,6 +2191,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 2,
 										   planstate, es);
+			show_nestloop_info(castNode(NestLoopState, planstate), es);
 			break;
 		case T_MergeJoin:
 			show_upper_qual(((MergeJoin *) plan)->mergeclauses,
@@ -2235,6 +2246,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			break;
 		case T_Sort:
 			show_sort_keys(castNode(SortState, planstate), ancestors, es);
+			if (((Sort *) plan)->numRanges > 0)
+				ExplainPropertyInteger("Key Ranges", NULL,
+									   ((Sort *) plan)->numRanges, es);
 			show_sort_info(castNode(SortState, planstate), es);
 			break;
 		case T_IncrementalSort:
@@ -2420,6 +2434,11 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			ExplainNode(((SubqueryScanState *) planstate)->subplan, ancestors,
 						"Subquery", NULL, es);
 			break;
+		case T_NestLoop:
+			if (((NestLoopState *) planstate)->nl_HashPlanState)
+				ExplainNode(((NestLoopState *) planstate)->nl_HashPlanState,
+							ancestors, "Adaptive", NULL, es);
+			break;
 		case T_CustomScan:
 			ExplainCustomChildren((CustomScanState *) planstate,
 								  ancestors, es);
@@ -2564,6 +2583,50 @@ show_scan_qual(List *qual, const char *qlabel,
 	show_qual(qual, qlabel, planstate, ancestors, useprefix, es);
 }
 
+/*
+ * Show the keys of the Bloom filters applied by a scan plan node
+ */
+static void
+show_bloom_filters(List *filters, PlanState *planstate, List *ancestors,
+				   ExplainState *es)
+{
+	List	   *context;
+	List	   *result = NIL;
+	bool		useprefix;
+
+	/* No work if no filters */
+	if (filters == NIL)
+		return;
+
+	/* Set up deparsing context */
+	context = set_deparse_context_plan(es->deparse_cxt,
+									   planstate->plan,
+									   ancestors);
+	useprefix = es->verbose;
+
+	foreach_node(HashBloomFilter, filter, filters)
+	{
+		StringInfoData buf;
+
+		initStringInfo(&buf);
+		if (list_length(filter->hashkeys) > 1)
+			appendStringInfoChar(&buf, '(');
+		foreach_ptr(Node, key, filter->hashkeys)
+		{
+			if (foreach_current_index(key) > 0)
+				appendStringInfoString(&buf, ", ");
+			appendStringInfoString(&buf,
+								   deparse_expression(key, context,
+													  useprefix, false));
+		}
+		if (list_length(filter->hashkeys) > 1)
+			appendStringInfoChar(&buf, ')');
+		result = lappend(result, buf.data);
+	}
+
+	ExplainPropertyList("Bloom Filters", result, es);
+}
+
 /*
  * Show a qualifier expression for an upper-level plan node
  */
@@ -3103,7 +3166,9 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 	if (!es->analyze)
 		return;
 
-	if (sortstate->sort_Done && sortstate->tuplesortstate != NULL)
+	/* A Parallel Sort saves the stats before ending its tuplesort */
+	if (sortstate->sort_Done &&
+		(sortstate->tuplesortstate != NULL || sortstate->sinstrument != NULL))
 	{
 		Tuplesortstate *state = (Tuplesortstate *) sortstate->tuplesortstate;
 		TuplesortInstrumentation stats;
@@ -3111,7 +3176,10 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 		const char *spaceType;
 		int64		spaceUsed;
 
-		tuplesort_get_stats(state, &stats);
+		if (state != NULL)
+			tuplesort_get_stats(state, &stats);
+		else
+			stats = *sortstate->sinstrument;
 		sortMethod = tuplesort_method_name(stats.sortMethod);
 		spaceType = tuplesort_space_type_name(stats.spaceType);
 		spaceUsed = stats.spaceUsed;
@@ -3385,6 +3453,51 @@ show_incremental_sort_info(IncrementalSortState *incrsortstate,
 	}
 }
 
+/*
+ * Show when an adaptive nestloop switches to hashing, and, in EXPLAIN
+ * ANALYZE, whether it did.
+ */
+static void
+show_nestloop_info(NestLoopState *nlstate, ExplainState *es)
+{
+	NestLoop   *plan = (NestLoop *) nlstate->js.ps.plan;
+
+	if (plan->hash_plan == NULL)
+		return;
+
+	ExplainPropertyFloat("Adaptive Threshold", "rows", plan->adaptive_rows,
+						 0, es);
+
+	if (!es->analyze)
+		return;
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainIndentText(es);
+		if (nlstate->nl_SwitchedAt > 0)
+			appendStringInfo(es->str,
+							 "Adaptive Strategy: Hash (switched at outer row %.0f)\n",
+							 nlstate->nl_SwitchedAt);
+		else if (nlstate->nl_HashTooBig)
+			appendStringInfoString(es->str,
+								   "Adaptive Strategy: Nested Loop (hash table exceeded memory)\n");
+		else
+			appendStringInfoString(es->str,
+								   "Adaptive Strategy: Nested Loop\n");
+	}
+	else
+	{
+		ExplainPropertyText("Adaptive Strategy",
+							nlstate->nl_SwitchedAt > 0 ? "Hash" : "Nested Loop",
+							es);
+		if (nlstate->nl_SwitchedAt > 0)
+			ExplainPropertyFloat("Switched At Outer Row", NULL,
+								 nlstate->nl_SwitchedAt, 0, es);
+		ExplainPropertyBool("Hash Table Exceeded Memory",
+							nlstate->nl_HashTooBig, es);
+	}
+}
+
 /*
  * Show information on hash buckets/batches.
  */
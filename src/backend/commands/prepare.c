@@ -560,6 +560,37 @@ DropAllPreparedStatements(void)
 	}
 }
 
+/*
+ * Detach the current session's prepared statements, for session pooling.
+ *
+ * The result is an opaque handle that RestorePreparedStatements() accepts.
+ * Afterwards, the backend has no prepared statements.
+ */
+void *
+SavePreparedStatements(void)
+{
+	HTAB	   *result = prepared_queries;
+
+	prepared_queries = NULL;
+	return result;
+}
+
+/*
+ * Make the prepared statements saved by SavePreparedStatements() current
+ * again, dropping whatever statements the backend has now.  NULL means none.
+ */
+void
+RestorePreparedStatements(void *saved)
+{
+	if (prepared_queries)
+	{
+		DropAllPreparedStatements();
+		hash_destroy(prepared_queries);
+	}
+
+	prepared_queries = (HTAB *) saved;
+}
+
 /*
  * Implements the 'EXPLAIN EXECUTE' utility statement.
  *
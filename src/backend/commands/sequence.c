@@ -86,6 +86,13 @@ static HTAB *seqhashtab = NULL; /* hash table for SeqTable items */
  */
 static SeqTableData *last_used_seq = NULL;
 
+/* A session's sequence state, while session pooling has put it aside */
+typedef struct SavedSequenceState
+{
+	HTAB	   *seqhashtab;
+	SeqTableData *last_used_seq;
+} SavedSequenceState;
+
 static void fill_seq_with_data(Relation rel, HeapTuple tuple);
 static void fill_seq_fork_with_data(Relation rel, HeapTuple tuple, ForkNumber forkNum);
 static Relation lock_and_open_sequence(SeqTable seq);
@@ -1913,3 +1920,45 @@ ResetSequenceCaches(void)
 
 	last_used_seq = NULL;
 }
+
+/*
+ * Session pooling support: detach the current session's sequence state, so
+ * that it can be put back with RestoreSequenceState() later.  Afterwards, the
+ * backend looks as if it had not used any sequences yet.
+ */
+void *
+SaveSequenceState(void)
+{
+	SavedSequenceState *result;
+
+	if (seqhashtab == NULL)
+		return NULL;
+
+	result = MemoryContextAlloc(TopMemoryContext, sizeof(SavedSequenceState));
+	result->seqhashtab = seqhashtab;
+	result->last_used_seq = last_used_seq;
+
+	seqhashtab = NULL;
+	last_used_seq = NULL;
+
+	return result;
+}
+
+/*
+ * Make the sequence state saved by SaveSequenceState() current again,
+ * discarding the backend's present state.  NULL means no state.
+ */
+void
+RestoreSequenceState(void *saved)
+{
+	SavedSequenceState *state = (SavedSequenceState *) saved;
+
+	ResetSequenceCaches();
+
+	if (state != NULL)
+	{
+		seqhashtab = state->seqhashtab;
+		last_used_seq = state->last_used_seq;
+		pfree(state);
+	}
+}
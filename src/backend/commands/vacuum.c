@@ -175,6 +175,7 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel)
 	int			ring_size;
 	bool		skip_database_stats = false;
 	bool		only_database_stats = false;
+	bool		parallel_heap = false;
 	MemoryContext vac_context;
 	ListCell   *lc;
 
@@ -289,6 +290,8 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel)
 			else
 				params.nworkers = nworkers;
 		}
+		else if (strcmp(opt->defname, "parallel_heap") == 0)
+			parallel_heap = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "skip_database_stats") == 0)
 			skip_database_stats = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "only_database_stats") == 0)
@@ -313,14 +316,16 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel)
 		(process_main ? VACOPT_PROCESS_MAIN : 0) |
 		(process_toast ? VACOPT_PROCESS_TOAST : 0) |
 		(skip_database_stats ? VACOPT_SKIP_DATABASE_STATS : 0) |
-		(only_database_stats ? VACOPT_ONLY_DATABASE_STATS : 0);
+		(only_database_stats ? VACOPT_ONLY_DATABASE_STATS : 0) |
+		(parallel_heap ? VACOPT_PARALLEL_HEAP : 0);
 
 	/* sanity checks on options */
 	Assert(params.options & (VACOPT_VACUUM | VACOPT_ANALYZE));
 	Assert((params.options & VACOPT_VACUUM) ||
 		   !(params.options & (VACOPT_FULL | VACOPT_FREEZE)));
 
-	if ((params.options & VACOPT_FULL) && params.nworkers > 0)
+	if ((params.options & VACOPT_FULL) &&
+		(params.nworkers > 0 || (params.options & VACOPT_PARALLEL_HEAP)))
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("VACUUM FULL cannot be performed in parallel")));
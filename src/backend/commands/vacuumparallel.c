@@ -18,6 +18,15 @@
  * the parallel context is re-initialized so that the same DSM can be used for
  * multiple passes of index bulk-deletion and index cleanup.
  *
+ * If its table access method supports it, the table itself can also be
+ * processed in parallel, in which case the number of workers is also
+ * computed from the size of the table.  The table AM gets space in the DSM
+ * segment for the state it shares between the participants, and the leader
+ * launches workers running its parallel_vacuum_worker callback between
+ * parallel_vacuum_table_begin() and parallel_vacuum_table_end() calls.  How
+ * the work is divided is up to the table AM; heap relations, for one, have
+ * both passes over the heap processed in parallel (see vacuumlazy.c).
+ *
  * For parallel autovacuum, we need to propagate cost-based vacuum delay
  * parameters from the leader to its workers, as the leader's parameters can
  * change even while processing a table (e.g., due to a config reload).
@@ -37,6 +46,7 @@
 
 #include "access/amapi.h"
 #include "access/table.h"
+#include "access/tableam.h"
 #include "access/xact.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
@@ -59,6 +69,7 @@
 #define PARALLEL_VACUUM_KEY_BUFFER_USAGE	3
 #define PARALLEL_VACUUM_KEY_WAL_USAGE		4
 #define PARALLEL_VACUUM_KEY_INDEX_STATS		5
+#define PARALLEL_VACUUM_KEY_TABLE_STATE		6
 
 /*
  * Struct for cost-based vacuum delay related parameters to share among an
@@ -148,6 +159,12 @@ typedef struct PVShared
 	/* Counter for vacuuming and cleanup */
 	pg_atomic_uint32 idx;
 
+	/*
+	 * True if the workers launched next process the table rather than its
+	 * indexes.
+	 */
+	bool		process_table;
+
 	/* DSA handle where the TidStore lives */
 	dsa_handle	dead_items_dsa_handle;
 
@@ -257,6 +274,17 @@ struct ParallelVacuumState
 	int			nindexes_parallel_cleanup;
 	int			nindexes_parallel_condcleanup;
 
+	/*
+	 * The number of workers to use to process the table, and the state the
+	 * table AM shares between them in DSM.  table_state is NULL if the table
+	 * is not processed in parallel.
+	 */
+	int			nworkers_table;
+	void	   *table_state;
+
+	/* Were workers launched before, requiring to reinitialize the DSM? */
+	bool		workers_launched;
+
 	/* Buffer access strategy used by leader process */
 	BufferAccessStrategy bstrategy;
 
@@ -281,8 +309,13 @@ static PVSharedCostParams *pv_shared_cost_params = NULL;
  */
 static uint32 shared_params_generation_local = 0;
 
-static int	parallel_vacuum_compute_workers(Relation *indrels, int nindexes, int nrequested,
-											bool *will_parallel_vacuum);
+static int	parallel_vacuum_compute_workers(Relation rel, Relation *indrels, int nindexes,
+											int nrequested, bool parallel_table,
+											bool *will_parallel_vacuum,
+											int *nworkers_table);
+static void parallel_vacuum_launch_workers(ParallelVacuumState *pvs, int nworkers,
+										   PVWorkerStats *wstats);
+static void parallel_vacuum_finish_workers(ParallelVacuumState *pvs);
 static void parallel_vacuum_process_all_indexes(ParallelVacuumState *pvs, int num_index_scans,
 												bool vacuum, PVWorkerStats *wstats);
 static void parallel_vacuum_process_safe_indexes(ParallelVacuumState *pvs);
@@ -299,12 +332,16 @@ static void parallel_vacuum_dsm_detach(dsm_segment *seg, Datum arg);
  * Try to enter parallel mode and create a parallel context.  Then initialize
  * shared memory state.
  *
+ * If parallel_table is true, workers may also be used to process the table
+ * itself, if the table AM supports that.
+ *
  * On success, return parallel vacuum state.  Otherwise return NULL.
  */
 ParallelVacuumState *
 parallel_vacuum_init(Relation rel, Relation *indrels, int nindexes,
-					 int nrequested_workers, int vac_work_mem,
-					 int elevel, BufferAccessStrategy bstrategy)
+					 int nrequested_workers, bool parallel_table,
+					 int vac_work_mem, int elevel,
+					 BufferAccessStrategy bstrategy)
 {
 	ParallelVacuumState *pvs;
 	ParallelContext *pcxt;
@@ -316,24 +353,24 @@ parallel_vacuum_init(Relation rel, Relation *indrels, int nindexes,
 	bool	   *will_parallel_vacuum;
 	Size		est_indstats_len;
 	Size		est_shared_len;
+	Size		est_table_state_len = 0;
 	int			nindexes_mwm = 0;
 	int			parallel_workers = 0;
+	int			nworkers_table = 0;
 	int			querylen;
 
-	/*
-	 * A parallel vacuum must be requested and there must be indexes on the
-	 * relation
-	 */
+	/* A parallel vacuum must be requested */
 	Assert(nrequested_workers >= 0);
-	Assert(nindexes > 0);
 
 	/*
 	 * Compute the number of parallel vacuum workers to launch
 	 */
 	will_parallel_vacuum = palloc0_array(bool, nindexes);
-	parallel_workers = parallel_vacuum_compute_workers(indrels, nindexes,
+	parallel_workers = parallel_vacuum_compute_workers(rel, indrels, nindexes,
 													   nrequested_workers,
-													   will_parallel_vacuum);
+													   parallel_table,
+													   will_parallel_vacuum,
+													   &nworkers_table);
 	if (parallel_workers <= 0)
 	{
 		/* Can't perform vacuum in parallel -- return NULL */
@@ -347,6 +384,7 @@ parallel_vacuum_init(Relation rel, Relation *indrels, int nindexes,
 	pvs->will_parallel_vacuum = will_parallel_vacuum;
 	pvs->bstrategy = bstrategy;
 	pvs->heaprel = rel;
+	pvs->nworkers_table = nworkers_table;
 
 	EnterParallelMode();
 	pcxt = CreateParallelContext("postgres", "parallel_vacuum_main",
@@ -359,6 +397,18 @@ parallel_vacuum_init(Relation rel, Relation *indrels, int nindexes,
 	shm_toc_estimate_chunk(&pcxt->estimator, est_indstats_len);
 	shm_toc_estimate_keys(&pcxt->estimator, 1);
 
+	/*
+	 * Estimate size for the table AM's shared state --
+	 * PARALLEL_VACUUM_KEY_TABLE_STATE
+	 */
+	if (nworkers_table > 0)
+	{
+		est_table_state_len = table_parallel_vacuum_estimate(rel,
+															 pcxt->nworkers);
+		shm_toc_estimate_chunk(&pcxt->estimator, est_table_state_len);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+
 	/* Estimate size for shared information -- PARALLEL_VACUUM_KEY_SHARED */
 	est_shared_len = sizeof(PVShared);
 	shm_toc_estimate_chunk(&pcxt->estimator, est_shared_len);
@@ -427,6 +477,15 @@ parallel_vacuum_init(Relation rel, Relation *indrels, int nindexes,
 	shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_INDEX_STATS, indstats);
 	pvs->indstats = indstats;
 
+	/* Prepare the table AM's shared state, initialized by the leader later */
+	if (nworkers_table > 0)
+	{
+		pvs->table_state = shm_toc_allocate(pcxt->toc, est_table_state_len);
+		MemSet(pvs->table_state, 0, est_table_state_len);
+		shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_TABLE_STATE,
+					   pvs->table_state);
+	}
+
 	/* Prepare shared information */
 	shared = (PVShared *) shm_toc_allocate(pcxt->toc, est_shared_len);
 	MemSet(shared, 0, est_shared_len);
@@ -737,17 +796,26 @@ parallel_vacuum_propagate_shared_delay_params(void)
  * the number of indexes that support parallel vacuum.  This function also
  * sets will_parallel_vacuum to remember indexes that participate in parallel
  * vacuum.
+ *
+ * If parallel_table is true, the table AM may also want workers to process
+ * the table itself, which it decides from nrequested and the size of the
+ * table.  We request the larger of both numbers, and set *nworkers_table to
+ * the number of workers to use for the table.
  */
 static int
-parallel_vacuum_compute_workers(Relation *indrels, int nindexes, int nrequested,
-								bool *will_parallel_vacuum)
+parallel_vacuum_compute_workers(Relation rel, Relation *indrels, int nindexes,
+								int nrequested, bool parallel_table,
+								bool *will_parallel_vacuum,
+								int *nworkers_table)
 {
 	int			nindexes_parallel = 0;
 	int			nindexes_parallel_bulkdel = 0;
 	int			nindexes_parallel_cleanup = 0;
-	int			parallel_workers;
+	int			parallel_workers = 0;
 	int			max_workers;
 
+	*nworkers_table = 0;
+
 	max_workers = AmAutoVacuumWorkerProcess() ?
 		autovacuum_max_parallel_workers :
 		max_parallel_maintenance_workers;
@@ -787,16 +855,19 @@ parallel_vacuum_compute_workers(Relation *indrels, int nindexes, int nrequested,
 	/* The leader process takes one index */
 	nindexes_parallel--;
 
-	/* No index supports parallel vacuum */
-	if (nindexes_parallel <= 0)
-		return 0;
+	/* Compute the parallel degree, if any index supports parallel vacuum */
+	if (nindexes_parallel > 0)
+		parallel_workers = (nrequested > 0) ?
+			Min(nrequested, nindexes_parallel) : nindexes_parallel;
 
-	/* Compute the parallel degree */
-	parallel_workers = (nrequested > 0) ?
-		Min(nrequested, nindexes_parallel) : nindexes_parallel;
+	/* Let the table AM tell how many workers it can use for the table */
+	if (parallel_table)
+		*nworkers_table = table_parallel_vacuum_compute_workers(rel, nrequested);
+	parallel_workers = Max(parallel_workers, *nworkers_table);
 
 	/* Cap by GUC variable */
 	parallel_workers = Min(parallel_workers, max_workers);
+	*nworkers_table = Min(*nworkers_table, parallel_workers);
 
 	return parallel_workers;
 }
@@ -873,44 +944,8 @@ parallel_vacuum_process_all_indexes(ParallelVacuumState *pvs, int num_index_scan
 	/* Setup the shared cost-based vacuum delay and launch workers */
 	if (nworkers > 0)
 	{
-		/* Reinitialize parallel context to relaunch parallel workers */
-		if (num_index_scans > 0)
-			ReinitializeParallelDSM(pvs->pcxt);
-
-		/*
-		 * Set up shared cost balance and the number of active workers for
-		 * vacuum delay.  We need to do this before launching workers as
-		 * otherwise, they might not see the updated values for these
-		 * parameters.
-		 */
-		pg_atomic_write_u32(&(pvs->shared->cost_balance), VacuumCostBalance);
-		pg_atomic_write_u32(&(pvs->shared->active_nworkers), 0);
-
-		/*
-		 * The number of workers can vary between bulkdelete and cleanup
-		 * phase.
-		 */
-		ReinitializeParallelWorkers(pvs->pcxt, nworkers);
-
-		LaunchParallelWorkers(pvs->pcxt);
-
-		if (pvs->pcxt->nworkers_launched > 0)
-		{
-			/*
-			 * Reset the local cost values for leader backend as we have
-			 * already accumulated the remaining balance of heap.
-			 */
-			VacuumCostBalance = 0;
-			VacuumCostBalanceLocal = 0;
-
-			/* Enable shared cost balance for leader backend */
-			VacuumSharedCostBalance = &(pvs->shared->cost_balance);
-			VacuumActiveNWorkers = &(pvs->shared->active_nworkers);
-
-			/* Update the statistics, if we asked to */
-			if (wstats != NULL)
-				wstats->nlaunched += pvs->pcxt->nworkers_launched;
-		}
+		pvs->shared->process_table = false;
+		parallel_vacuum_launch_workers(pvs, nworkers, wstats);
 
 		if (vacuum)
 			ereport(pvs->shared->elevel,
@@ -935,18 +970,9 @@ parallel_vacuum_process_all_indexes(ParallelVacuumState *pvs, int num_index_scan
 	 */
 	parallel_vacuum_process_safe_indexes(pvs);
 
-	/*
-	 * Next, accumulate buffer and WAL usage.  (This must wait for the workers
-	 * to finish, or we might get incomplete data.)
-	 */
+	/* Wait for the workers and accumulate their buffer and WAL usage */
 	if (nworkers > 0)
-	{
-		/* Wait for all vacuum workers to finish */
-		WaitForParallelWorkersToFinish(pvs->pcxt);
-
-		for (int i = 0; i < pvs->pcxt->nworkers_launched; i++)
-			InstrAccumParallelQuery(&pvs->buffer_usage[i], &pvs->wal_usage[i]);
-	}
+		parallel_vacuum_finish_workers(pvs);
 
 	/*
 	 * Reset all index status back to initial (while checking that we have
@@ -962,6 +988,70 @@ parallel_vacuum_process_all_indexes(ParallelVacuumState *pvs, int num_index_scan
 
 		indstats->status = PARALLEL_INDVAC_STATUS_INITIAL;
 	}
+}
+
+/*
+ * Launch nworkers parallel workers, after setting up the shared cost-based
+ * vacuum delay.  The caller must have set up what the workers are to do.
+ *
+ * If wstats is not NULL, the parallel worker statistics are updated.
+ */
+static void
+parallel_vacuum_launch_workers(ParallelVacuumState *pvs, int nworkers,
+							   PVWorkerStats *wstats)
+{
+	Assert(nworkers > 0);
+
+	/* Reinitialize parallel context to relaunch parallel workers */
+	if (pvs->workers_launched)
+		ReinitializeParallelDSM(pvs->pcxt);
+
+	/*
+	 * Set up shared cost balance and the number of active workers for vacuum
+	 * delay.  We need to do this before launching workers as otherwise, they
+	 * might not see the updated values for these parameters.
+	 */
+	pg_atomic_write_u32(&(pvs->shared->cost_balance), VacuumCostBalance);
+	pg_atomic_write_u32(&(pvs->shared->active_nworkers), 0);
+
+	/* The number of workers can vary between phases */
+	ReinitializeParallelWorkers(pvs->pcxt, nworkers);
+
+	LaunchParallelWorkers(pvs->pcxt);
+	pvs->workers_launched = true;
+
+	if (pvs->pcxt->nworkers_launched > 0)
+	{
+		/*
+		 * Reset the local cost values for leader backend as we have already
+		 * accumulated the remaining balance of heap.
+		 */
+		VacuumCostBalance = 0;
+		VacuumCostBalanceLocal = 0;
+
+		/* Enable shared cost balance for leader backend */
+		VacuumSharedCostBalance = &(pvs->shared->cost_balance);
+		VacuumActiveNWorkers = &(pvs->shared->active_nworkers);
+
+		/* Update the statistics, if we asked to */
+		if (wstats != NULL)
+			wstats->nlaunched += pvs->pcxt->nworkers_launched;
+	}
+}
+
+/*
+ * Wait for the workers launched by parallel_vacuum_launch_workers() to
+ * finish, then accumulate their buffer and WAL usage.  (Doing that must wait
+ * for the workers to finish, or we might get incomplete data.)
+ */
+static void
+parallel_vacuum_finish_workers(ParallelVacuumState *pvs)
+{
+	/* Wait for all vacuum workers to finish */
+	WaitForParallelWorkersToFinish(pvs->pcxt);
+
+	for (int i = 0; i < pvs->pcxt->nworkers_launched; i++)
+		InstrAccumParallelQuery(&pvs->buffer_usage[i], &pvs->wal_usage[i]);
 
 	/*
 	 * Carry the shared balance value to heap scan and disable shared costing
@@ -974,6 +1064,66 @@ parallel_vacuum_process_all_indexes(ParallelVacuumState *pvs, int num_index_scan
 	}
 }
 
+/*
+ * Return the shared state of the table AM, and the number of workers that it
+ * may launch to process the table.  Returns NULL if the table is not to be
+ * processed in parallel.
+ */
+void *
+parallel_vacuum_get_table_state(ParallelVacuumState *pvs, int *nworkers_p)
+{
+	*nworkers_p = pvs->nworkers_table;
+	return pvs->table_state;
+}
+
+/*
+ * Launch parallel workers to process the table, running its table AM's
+ * parallel_vacuum_worker callback.  The leader is expected to take part in
+ * the work, then to call parallel_vacuum_table_end() to wait for the workers
+ * to finish.  Returns the number of workers launched.
+ *
+ * If wstats is not NULL, the parallel worker statistics are updated.
+ */
+int
+parallel_vacuum_table_begin(ParallelVacuumState *pvs, PVWorkerStats *wstats)
+{
+	Assert(!IsParallelWorker());
+	Assert(pvs->table_state != NULL);
+
+	/* Update the statistics, if we asked to */
+	if (wstats != NULL)
+		wstats->nplanned += pvs->nworkers_table;
+
+	pvs->shared->process_table = true;
+	parallel_vacuum_launch_workers(pvs, pvs->nworkers_table, wstats);
+
+	ereport(pvs->shared->elevel,
+			(errmsg(ngettext("launched %d parallel vacuum worker for table processing (planned: %d)",
+							 "launched %d parallel vacuum workers for table processing (planned: %d)",
+							 pvs->pcxt->nworkers_launched),
+					pvs->pcxt->nworkers_launched, pvs->nworkers_table)));
+
+	/* The leader takes part in the work like the workers do */
+	if (VacuumActiveNWorkers)
+		pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+
+	return pvs->pcxt->nworkers_launched;
+}
+
+/*
+ * Wait for the workers launched by parallel_vacuum_table_begin() to finish.
+ */
+void
+parallel_vacuum_table_end(ParallelVacuumState *pvs)
+{
+	Assert(!IsParallelWorker());
+
+	if (VacuumActiveNWorkers)
+		pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+
+	parallel_vacuum_finish_workers(pvs);
+}
+
 /*
  * Index vacuum/cleanup routine used by the leader process and parallel
  * vacuum worker processes to vacuum the indexes in parallel.
@@ -1190,8 +1340,9 @@ parallel_vacuum_index_is_parallel_safe(Relation indrel, int num_index_scans,
 /*
  * Perform work within a launched parallel process.
  *
- * Since parallel vacuum workers perform only index vacuum or index cleanup,
- * we don't need to report progress information.
+ * Parallel vacuum workers perform index vacuum or index cleanup, for which
+ * we don't need to report progress information, or process the table, in
+ * which case the table AM reports progress to the leader as it sees fit.
  */
 void
 parallel_vacuum_main(dsm_segment *seg, shm_toc *toc)
@@ -1238,7 +1389,6 @@ parallel_vacuum_main(dsm_segment *seg, shm_toc *toc)
 	 * matched to the leader's one.
 	 */
 	vac_open_indexes(rel, RowExclusiveLock, &nindexes, &indrels);
-	Assert(nindexes > 0);
 
 	/*
 	 * Apply the desired value of maintenance_work_mem within this process.
@@ -1307,8 +1457,23 @@ parallel_vacuum_main(dsm_segment *seg, shm_toc *toc)
 	/* Prepare to track buffer usage during parallel execution */
 	InstrStartParallelQuery();
 
-	/* Process indexes to perform vacuum/cleanup */
-	parallel_vacuum_process_safe_indexes(&pvs);
+	if (shared->process_table)
+	{
+		void	   *table_state;
+
+		table_state = shm_toc_lookup(toc, PARALLEL_VACUUM_KEY_TABLE_STATE,
+									 false);
+
+		/* Process the table, in the way its table AM decides */
+		pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+		table_parallel_vacuum_worker(rel, &pvs, table_state, pvs.bstrategy);
+		pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+	}
+	else
+	{
+		/* Process indexes to perform vacuum/cleanup */
+		parallel_vacuum_process_safe_indexes(&pvs);
+	}
 
 	/* Report buffer/WAL usage during parallel execution */
 	buffer_usage = shm_toc_lookup(toc, PARALLEL_VACUUM_KEY_BUFFER_USAGE, false);
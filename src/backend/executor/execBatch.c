@@ -0,0 +1,488 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.c
+ *	  Support routines for batch-at-a-time execution
+ *
+ * Most of the executor processes one tuple at a time: each tuple is
+ * fetched through ExecProcNode() and every expression is run through the
+ * expression interpreter separately for it.  For simple analytical queries
+ * that overhead dominates the actual work.  In batch mode a scan instead
+ * deforms up to EXEC_BATCH_SIZE tuples into per-column arrays, and
+ * evaluates its qual over the whole batch with tight, type-specialized
+ * loops.  The consumer (currently only nodeAgg.c) then processes the rows
+ * listed in the batch's selection vector.
+ *
+ * Only a small set of quals can be evaluated this way: comparisons between
+ * an integer or float column and a constant, and IS [NOT] NULL tests on a
+ * column.  Callers fall back to ordinary row mode whenever
+ * ExecInitBatchQual() refuses a qual.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "catalog/pg_type_d.h"
+#include "executor/execBatch.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/primnodes.h"
+#include "utils/float.h"
+#include "utils/fmgroids.h"
+
+/* GUC parameter */
+bool		enable_batch_execution = true;
+
+/* Column data types that batch quals know how to compare */
+typedef enum ExecBatchType
+{
+	BATCH_TYPE_INT2,
+	BATCH_TYPE_INT4,
+	BATCH_TYPE_INT8,
+	BATCH_TYPE_FLOAT4,
+	BATCH_TYPE_FLOAT8,
+} ExecBatchType;
+
+/*
+ * Outcomes of comparing a column value with the constant that make a
+ * comparison step succeed.  "<=" is BATCH_CMP_LT | BATCH_CMP_EQ, and so on.
+ */
+#define BATCH_CMP_LT	0x01
+#define BATCH_CMP_EQ	0x02
+#define BATCH_CMP_GT	0x04
+
+typedef enum ExecBatchStepKind
+{
+	BATCH_STEP_COMPARE,			/* column <op> constant */
+	BATCH_STEP_IS_NULL,			/* column IS NULL */
+	BATCH_STEP_IS_NOT_NULL,		/* column IS NOT NULL */
+} ExecBatchStepKind;
+
+/*
+ * One clause of a batch qual.  For comparisons, integer columns are compared
+ * as int64 and float columns as float8, which gives the same results as the
+ * same-type and cross-type comparison operators of the integer_ops and
+ * float_ops operator families.
+ */
+typedef struct ExecBatchQualStep
+{
+	ExecBatchStepKind kind;
+	AttrNumber	attnum;			/* input column */
+	ExecBatchType type;			/* type of the column */
+	int			cmpmask;		/* BATCH_CMP_* outcomes that pass */
+	int64		intval;			/* constant, for integer columns */
+	float8		floatval;		/* constant, for float columns */
+} ExecBatchQualStep;
+
+struct ExecBatchQual
+{
+	int			nsteps;
+	ExecBatchQualStep steps[FLEXIBLE_ARRAY_MEMBER];
+};
+
+#define BATCH_CMP_FUNCS(prefix, lefttype, righttype) \
+	{F_##prefix##LT, lefttype, righttype, BATCH_CMP_LT}, \
+	{F_##prefix##LE, lefttype, righttype, BATCH_CMP_LT | BATCH_CMP_EQ}, \
+	{F_##prefix##EQ, lefttype, righttype, BATCH_CMP_EQ}, \
+	{F_##prefix##NE, lefttype, righttype, BATCH_CMP_LT | BATCH_CMP_GT}, \
+	{F_##prefix##GE, lefttype, righttype, BATCH_CMP_GT | BATCH_CMP_EQ}, \
+	{F_##prefix##GT, lefttype, righttype, BATCH_CMP_GT}
+
+/* Comparison functions that can be evaluated by batch quals */
+static const struct
+{
+	Oid			funcid;
+	Oid			lefttype;
+	Oid			righttype;
+	int			cmpmask;
+}			batch_cmp_funcs[] =
+{
+	BATCH_CMP_FUNCS(INT2, INT2OID, INT2OID),
+	BATCH_CMP_FUNCS(INT24, INT2OID, INT4OID),
+	BATCH_CMP_FUNCS(INT28, INT2OID, INT8OID),
+	BATCH_CMP_FUNCS(INT4, INT4OID, INT4OID),
+	BATCH_CMP_FUNCS(INT42, INT4OID, INT2OID),
+	BATCH_CMP_FUNCS(INT48, INT4OID, INT8OID),
+	BATCH_CMP_FUNCS(INT8, INT8OID, INT8OID),
+	BATCH_CMP_FUNCS(INT82, INT8OID, INT2OID),
+	BATCH_CMP_FUNCS(INT84, INT8OID, INT4OID),
+	BATCH_CMP_FUNCS(FLOAT4, FLOAT4OID, FLOAT4OID),
+	BATCH_CMP_FUNCS(FLOAT48, FLOAT4OID, FLOAT8OID),
+	BATCH_CMP_FUNCS(FLOAT8, FLOAT8OID, FLOAT8OID),
+	BATCH_CMP_FUNCS(FLOAT84, FLOAT8OID, FLOAT4OID),
+};
+
+static bool batch_qual_var(Node *node, Index varno, Oid typid,
+						   AttrNumber *attnum);
+static bool batch_qual_step(Expr *clause, Index varno,
+							ExecBatchQualStep *step);
+
+
+/*
+ * Create a batch deforming the attributes in attnums.  All of them must be
+ * user attributes of pass-by-value types; it's the caller's responsibility
+ * to check that.
+ *
+ * The batch is allocated in CurrentMemoryContext.
+ */
+ExecBatch *
+ExecBatchCreate(Bitmapset *attnums)
+{
+	ExecBatch  *batch = palloc0_object(ExecBatch);
+	int			attnum = -1;
+	int			col = 0;
+
+	batch->ncols = bms_num_members(attnums);
+	batch->maxattnum = batch->ncols > 0 ? bms_prev_member(attnums, -1) : 0;
+	batch->attnums = palloc_array(AttrNumber, Max(batch->ncols, 1));
+	batch->colmap = palloc_array(int, batch->maxattnum + 1);
+	batch->values = palloc_array(Datum *, Max(batch->ncols, 1));
+	batch->isnull = palloc_array(bool *, Max(batch->ncols, 1));
+	batch->sel = palloc_array(int, EXEC_BATCH_SIZE);
+
+	for (int i = 0; i <= batch->maxattnum; i++)
+		batch->colmap[i] = -1;
+
+	while ((attnum = bms_next_member(attnums, attnum)) >= 0)
+	{
+		Assert(attnum > 0);
+
+		batch->attnums[col] = attnum;
+		batch->colmap[attnum] = col;
+		batch->values[col] = palloc_array(Datum, EXEC_BATCH_SIZE);
+		batch->isnull[col] = palloc_array(bool, EXEC_BATCH_SIZE);
+		col++;
+	}
+
+	return batch;
+}
+
+/*
+ * Reset the selection vector so that all rows of the batch are selected.
+ */
+void
+ExecBatchSelectAll(ExecBatch *batch)
+{
+	for (int i = 0; i < batch->nrows; i++)
+		batch->sel[i] = i;
+	batch->nselected = batch->nrows;
+}
+
+/*
+ * Is node a non-system column of relation varno with type typid?  If so,
+ * return its attribute number in *attnum.
+ */
+static bool
+batch_qual_var(Node *node, Index varno, Oid typid, AttrNumber *attnum)
+{
+	Var		   *var;
+
+	if (!IsA(node, Var))
+		return false;
+
+	var = (Var *) node;
+	if (var->varno != varno ||
+		var->varlevelsup != 0 ||
+		var->varattno <= 0 ||
+		var->varreturningtype != VAR_RETURNING_DEFAULT ||
+		(OidIsValid(typid) && var->vartype != typid))
+		return false;
+
+	*attnum = var->varattno;
+	return true;
+}
+
+/*
+ * Try to convert one qual clause into a batch qual step.
+ */
+static bool
+batch_qual_step(Expr *clause, Index varno, ExecBatchQualStep *step)
+{
+	if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+
+		if (ntest->argisrow ||
+			!batch_qual_var((Node *) ntest->arg, varno, InvalidOid,
+							&step->attnum))
+			return false;
+
+		step->kind = ntest->nulltesttype == IS_NULL ?
+			BATCH_STEP_IS_NULL : BATCH_STEP_IS_NOT_NULL;
+		return true;
+	}
+
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) clause;
+		Node	   *leftop;
+		Node	   *rightop;
+		Oid			vartype;
+		Oid			consttype;
+		Const	   *con;
+		int			i;
+
+		if (list_length(opexpr->args) != 2)
+			return false;
+
+		set_opfuncid(opexpr);
+		for (i = 0; i < lengthof(batch_cmp_funcs); i++)
+		{
+			if (batch_cmp_funcs[i].funcid == opexpr->opfuncid)
+				break;
+		}
+		if (i == lengthof(batch_cmp_funcs))
+			return false;
+
+		leftop = linitial(opexpr->args);
+		rightop = lsecond(opexpr->args);
+		step->kind = BATCH_STEP_COMPARE;
+		step->cmpmask = batch_cmp_funcs[i].cmpmask;
+
+		if (batch_qual_var(leftop, varno, batch_cmp_funcs[i].lefttype,
+						   &step->attnum))
+		{
+			con = (Const *) rightop;
+			vartype = batch_cmp_funcs[i].lefttype;
+			consttype = batch_cmp_funcs[i].righttype;
+		}
+		else if (batch_qual_var(rightop, varno, batch_cmp_funcs[i].righttype,
+								&step->attnum))
+		{
+			/* "const < var" is "var > const", so swap LT and GT */
+			con = (Const *) leftop;
+			vartype = batch_cmp_funcs[i].righttype;
+			consttype = batch_cmp_funcs[i].lefttype;
+			step->cmpmask = (step->cmpmask & BATCH_CMP_EQ) |
+				((step->cmpmask & BATCH_CMP_LT) ? BATCH_CMP_GT : 0) |
+				((step->cmpmask & BATCH_CMP_GT) ? BATCH_CMP_LT : 0);
+		}
+		else
+			return false;
+
+		/*
+		 * A NULL constant would make the clause NULL for every row; that's
+		 * rare enough not to bother with.
+		 */
+		if (!IsA(con, Const) ||
+			con->consttype != consttype ||
+			con->constisnull)
+			return false;
+
+		switch (vartype)
+		{
+			case INT2OID:
+				step->type = BATCH_TYPE_INT2;
+				break;
+			case INT4OID:
+				step->type = BATCH_TYPE_INT4;
+				break;
+			case INT8OID:
+				step->type = BATCH_TYPE_INT8;
+				break;
+			case FLOAT4OID:
+				step->type = BATCH_TYPE_FLOAT4;
+				break;
+			case FLOAT8OID:
+				step->type = BATCH_TYPE_FLOAT8;
+				break;
+			default:
+				elog(ERROR, "unexpected batch qual column type %u", vartype);
+		}
+
+		switch (consttype)
+		{
+			case INT2OID:
+				step->intval = DatumGetInt16(con->constvalue);
+				break;
+			case INT4OID:
+				step->intval = DatumGetInt32(con->constvalue);
+				break;
+			case INT8OID:
+				step->intval = DatumGetInt64(con->constvalue);
+				break;
+			case FLOAT4OID:
+				step->floatval = DatumGetFloat4(con->constvalue);
+				break;
+			case FLOAT8OID:
+				step->floatval = DatumGetFloat8(con->constvalue);
+				break;
+			default:
+				elog(ERROR, "unexpected batch qual constant type %u", consttype);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Prepare an implicitly-ANDed qual list for evaluation over batches of rows
+ * of relation varno.
+ *
+ * Returns NULL if any of the clauses can't be evaluated in batch mode.
+ * Otherwise, the attribute numbers of the columns referenced by the qual
+ * are added to *attnums.
+ */
+ExecBatchQual *
+ExecInitBatchQual(List *qual, Index varno, Bitmapset **attnums)
+{
+	ExecBatchQual *bqual;
+	ListCell   *lc;
+	int			i = 0;
+
+	bqual = palloc(offsetof(ExecBatchQual, steps) +
+				   Max(list_length(qual), 1) * sizeof(ExecBatchQualStep));
+	bqual->nsteps = list_length(qual);
+
+	foreach(lc, qual)
+	{
+		ExecBatchQualStep *step = &bqual->steps[i++];
+
+		if (!batch_qual_step((Expr *) lfirst(lc), varno, step))
+		{
+			pfree(bqual);
+			return NULL;
+		}
+	}
+
+	for (i = 0; i < bqual->nsteps; i++)
+		*attnums = bms_add_member(*attnums, bqual->steps[i].attnum);
+
+	return bqual;
+}
+
+/*
+ * Three-way comparison of a column value with a step's constant, following
+ * the semantics of the btree comparison functions (in particular, NaN sorts
+ * above all other float values and is equal to itself).
+ */
+static pg_attribute_always_inline int
+batch_compare(const ExecBatchQualStep *step, ExecBatchType type, Datum value)
+{
+	int64		ival;
+	float8		fval;
+
+	switch (type)
+	{
+		case BATCH_TYPE_INT2:
+			ival = DatumGetInt16(value);
+			return (ival > step->intval) - (ival < step->intval);
+		case BATCH_TYPE_INT4:
+			ival = DatumGetInt32(value);
+			return (ival > step->intval) - (ival < step->intval);
+		case BATCH_TYPE_INT8:
+			ival = DatumGetInt64(value);
+			return (ival > step->intval) - (ival < step->intval);
+		case BATCH_TYPE_FLOAT4:
+			fval = DatumGetFloat4(value);
+			return float8_gt(fval, step->floatval) -
+				float8_lt(fval, step->floatval);
+		case BATCH_TYPE_FLOAT8:
+			fval = DatumGetFloat8(value);
+			return float8_gt(fval, step->floatval) -
+				float8_lt(fval, step->floatval);
+	}
+
+	pg_unreachable();
+}
+
+/*
+ * Filter the selected rows of a batch by a comparison step.  This is
+ * inlined with a constant type, so that we get a specialized loop per type.
+ *
+ * The loop is written without data-dependent branches other than the NULL
+ * check, which lets the compiler produce reasonably tight code.
+ */
+static pg_attribute_always_inline int
+batch_filter_compare(const ExecBatchQualStep *step, ExecBatchType type,
+					 const Datum *values, const bool *isnull,
+					 int *sel, int nsel)
+{
+	int			nout = 0;
+
+	for (int i = 0; i < nsel; i++)
+	{
+		int			row = sel[i];
+		int			cmp;
+
+		if (isnull[row])
+			continue;
+
+		cmp = batch_compare(step, type, values[row]);
+		sel[nout] = row;
+		nout += (step->cmpmask >> (cmp + 1)) & 1;
+	}
+
+	return nout;
+}
+
+/*
+ * Evaluate a batch qual, removing the rows that don't satisfy it from the
+ * batch's selection vector.
+ */
+void
+ExecBatchQualFilter(ExecBatchQual *bqual, ExecBatch *batch)
+{
+	for (int i = 0; i < bqual->nsteps && batch->nselected > 0; i++)
+	{
+		const ExecBatchQualStep *step = &bqual->steps[i];
+		int			col = ExecBatchGetColumn(batch, step->attnum);
+		const Datum *values = batch->values[col];
+		const bool *isnull = batch->isnull[col];
+		int		   *sel = batch->sel;
+		int			nsel = batch->nselected;
+		int			nout = 0;
+
+		switch (step->kind)
+		{
+			case BATCH_STEP_IS_NULL:
+				for (int j = 0; j < nsel; j++)
+				{
+					sel[nout] = sel[j];
+					nout += isnull[sel[j]];
+				}
+				break;
+			case BATCH_STEP_IS_NOT_NULL:
+				for (int j = 0; j < nsel; j++)
+				{
+					sel[nout] = sel[j];
+					nout += !isnull[sel[j]];
+				}
+				break;
+			case BATCH_STEP_COMPARE:
+				switch (step->type)
+				{
+					case BATCH_TYPE_INT2:
+						nout = batch_filter_compare(step, BATCH_TYPE_INT2,
+													values, isnull, sel, nsel);
+						break;
+					case BATCH_TYPE_INT4:
+						nout = batch_filter_compare(step, BATCH_TYPE_INT4,
+													values, isnull, sel, nsel);
+						break;
+					case BATCH_TYPE_INT8:
+						nout = batch_filter_compare(step, BATCH_TYPE_INT8,
+													values, isnull, sel, nsel);
+						break;
+					case BATCH_TYPE_FLOAT4:
+						nout = batch_filter_compare(step, BATCH_TYPE_FLOAT4,
+													values, isnull, sel, nsel);
+						break;
+					case BATCH_TYPE_FLOAT8:
+						nout = batch_filter_compare(step, BATCH_TYPE_FLOAT8,
+													values, isnull, sel, nsel);
+						break;
+				}
+				break;
+		}
+
+		batch->nselected = nout;
+	}
+}
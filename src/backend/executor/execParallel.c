@@ -323,6 +323,8 @@ ExecParallelEstimate(PlanState *planstate, ExecParallelEstimateContext *e)
 			ExecHashEstimate((HashState *) planstate, e->pcxt);
 			break;
 		case T_SortState:
+			if (planstate->plan->parallel_aware)
+				ExecSortParallelEstimate((SortState *) planstate, e->pcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortEstimate((SortState *) planstate, e->pcxt);
 			break;
@@ -331,6 +333,8 @@ ExecParallelEstimate(PlanState *planstate, ExecParallelEstimateContext *e)
 			ExecIncrementalSortEstimate((IncrementalSortState *) planstate, e->pcxt);
 			break;
 		case T_AggState:
+			if (planstate->plan->parallel_aware)
+				ExecAggParallelEstimate((AggState *) planstate, e->pcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecAggEstimate((AggState *) planstate, e->pcxt);
 			break;
@@ -571,6 +575,9 @@ ExecParallelInitializeDSM(PlanState *planstate,
 			ExecHashInitializeDSM((HashState *) planstate, d->pcxt);
 			break;
 		case T_SortState:
+			if (planstate->plan->parallel_aware)
+				ExecSortParallelInitializeDSM((SortState *) planstate,
+											  d->pcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortInitializeDSM((SortState *) planstate, d->pcxt);
 			break;
@@ -579,6 +586,9 @@ ExecParallelInitializeDSM(PlanState *planstate,
 			ExecIncrementalSortInitializeDSM((IncrementalSortState *) planstate, d->pcxt);
 			break;
 		case T_AggState:
+			if (planstate->plan->parallel_aware)
+				ExecAggParallelInitializeDSM((AggState *) planstate,
+											 d->pcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecAggInitializeDSM((AggState *) planstate, d->pcxt);
 			break;
@@ -1071,9 +1081,18 @@ ExecParallelReInitializeDSM(PlanState *planstate,
 				ExecHashJoinReInitializeDSM((HashJoinState *) planstate,
 											pcxt);
 			break;
+		case T_AggState:
+			if (planstate->plan->parallel_aware)
+				ExecAggParallelReInitializeDSM((AggState *) planstate,
+											   pcxt);
+			break;
+		case T_SortState:
+			if (planstate->plan->parallel_aware)
+				ExecSortParallelReInitializeDSM((SortState *) planstate,
+												pcxt);
+			break;
 		case T_BitmapIndexScanState:
 		case T_HashState:
-		case T_SortState:
 		case T_IncrementalSortState:
 		case T_MemoizeState:
 			/* these nodes have DSM state, but no reinitialization is required */
@@ -1470,6 +1489,9 @@ ExecParallelInitializeWorker(PlanState *planstate, ParallelWorkerContext *pwcxt)
 			ExecHashInitializeWorker((HashState *) planstate, pwcxt);
 			break;
 		case T_SortState:
+			if (planstate->plan->parallel_aware)
+				ExecSortParallelInitializeWorker((SortState *) planstate,
+												 pwcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortInitializeWorker((SortState *) planstate, pwcxt);
 			break;
@@ -1479,6 +1501,9 @@ ExecParallelInitializeWorker(PlanState *planstate, ParallelWorkerContext *pwcxt)
 												pwcxt);
 			break;
 		case T_AggState:
+			if (planstate->plan->parallel_aware)
+				ExecAggParallelInitializeWorker((AggState *) planstate,
+												pwcxt);
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecAggInitializeWorker((AggState *) planstate, pwcxt);
 			break;
@@ -798,6 +798,9 @@ ExecShutdownNode_walker(PlanState *node, void *context)
 		case T_HashJoinState:
 			ExecShutdownHashJoin((HashJoinState *) node);
 			break;
+		case T_SortState:
+			ExecShutdownSort((SortState *) node);
+			break;
 		default:
 			break;
 	}
@@ -992,6 +992,37 @@ tts_buffer_heap_store_tuple(TupleTableSlot *slot, HeapTuple tuple,
 	}
 }
 
+/*
+ * slot_deform_uniform_attrs
+ *		Extract the first natts attributes of a tuple, which must all be
+ *		non-NULL byval attributes of width attlen stored without padding, as
+ *		described by TupleDesc's firstNonUniformAttr.
+ *
+ * Since there are no per-attribute branches, the compiler can vectorize
+ * these loops, and 8-byte values can just be copied into place.
+ */
+static pg_attribute_always_inline void
+slot_deform_uniform_attrs(const char *tp, int attlen, int natts,
+						  Datum *values, bool *isnull)
+{
+	memset(isnull, false, natts * sizeof(bool));
+
+	if (attlen == sizeof(int64))
+	{
+		StaticAssertStmt(sizeof(Datum) == sizeof(int64),
+						 "Datum must be 8 bytes wide");
+		memcpy(values, tp, natts * sizeof(Datum));
+	}
+	else
+	{
+		const int32 *src = (const int32 *) tp;
+
+		Assert(attlen == sizeof(int32));
+		for (int i = 0; i < natts; i++)
+			values[i] = Int32GetDatum(src[i]);
+	}
+}
+
 /*
  * slot_deform_heap_tuple
  *		Given a TupleTableSlot, extract data from the slot's physical tuple
@@ -1117,6 +1148,39 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 	/* Ensure we calculated tp correctly */
 	Assert(tp == (char *) tup + tup->t_hoff);
 
+	/*
+	 * We may be incrementally deforming the tuple, so set 'off' to the
+	 * previously cached value.  This may be 0, if the slot has just received
+	 * a new tuple.
+	 */
+	off = *offp;
+
+	/* We expect *offp to be set to 0 when attnum == 0 */
+	Assert(off == 0 || attnum > 0);
+
+	/*
+	 * When starting from the first attribute, extract the leading run of
+	 * equal width byval attributes, if any, in bulk.  This is only valid up
+	 * to the first NULL.
+	 */
+	if (attnum == 0 && tupleDesc->firstNonUniformAttr > 0)
+	{
+		int			nuniform = Min(tupleDesc->firstNonUniformAttr,
+								   firstNullAttr);
+
+		if (nuniform > 1)
+		{
+			int			attlen = cattrs[0].attlen;
+
+			slot_deform_uniform_attrs(tp, attlen, nuniform, values, isnull);
+			attnum = nuniform;
+			off = nuniform * attlen;
+
+			if (attnum == reqnatts)
+				goto done;
+		}
+	}
+
 	if (attnum < firstNonGuaranteedAttr)
 	{
 		int			attlen;
@@ -1141,18 +1205,6 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 		if (attnum == reqnatts)
 			goto done;
 	}
-	else
-	{
-		/*
-		 * We may be incrementally deforming the tuple, so set 'off' to the
-		 * previously cached value.  This may be 0, if the slot has just
-		 * received a new tuple.
-		 */
-		off = *offp;
-
-		/* We expect *offp to be set to 0 when attnum == 0 */
-		Assert(off == 0 || attnum > 0);
-	}
 
 	/* We can use attcacheoff up until the first NULL */
 	firstNonCacheOffsetAttr = Min(firstNonCacheOffsetAttr, firstNullAttr);
@@ -237,6 +237,35 @@
  *    to filter expressions having to be evaluated early, and allows to JIT
  *    the entire expression into one native function.
  *
+ *    Batch mode:
+ *
+ *    A plain aggregation (no GROUP BY or grouping sets) directly over a
+ *    sequential scan, whose aggregates are all simple count(), sum(),
+ *    avg(), min(), max() and similar over plain integer or float columns,
+ *    is executed in batch mode when enable_batch_execution is on.  The scan
+ *    then hands us batches of deformed columns, with its qual already
+ *    evaluated over the batch (see execBatch.c), and the transition states
+ *    are advanced by tight loops over each batch rather than by evaluating
+ *    the transition expression once per row.  Anything else runs through
+ *    the normal row-at-a-time code path.
+ *
+ *    Parallel HashAgg:
+ *
+ *    Normally, parallel aggregation is done in two steps: each participant
+ *    partially aggregates the rows it sees, and a Finalize Aggregate above
+ *    the Gather combines the partial states.  When there are many groups,
+ *    partial aggregation hardly reduces the number of rows and every group
+ *    ends up in the hash table of each participant.  A parallel-aware
+ *    hashed Agg node (a "Parallel HashAgg") instead divides the groups
+ *    among the participants.  First, each participant reads its share of
+ *    the input and writes every tuple to one of a number of shared batches,
+ *    chosen by the high bits of the tuple's hash value, much like Parallel
+ *    Hash Join partitions its input.  Once all participants are done, each
+ *    batch contains all the input tuples of its groups, so the participants
+ *    can claim batches one at a time and aggregate them fully, as if they
+ *    were batches spilled by a single process.  A batch that exceeds
+ *    hash_mem is spilled to the participant's own tapes as usual.
+ *
  * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -255,28 +284,37 @@
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "common/hashfn.h"
+#include "common/int.h"
+#include "executor/execBatch.h"
 #include "executor/execExpr.h"
 #include "executor/executor.h"
 #include "executor/instrument.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeSeqscan.h"
 #include "lib/hyperloglog.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/optimizer.h"
 #include "parser/parse_agg.h"
 #include "parser/parse_coerce.h"
+#include "port/atomics.h"
 #include "port/pg_bitutils.h"
+#include "storage/barrier.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/expandeddatum.h"
+#include "utils/float.h"
+#include "utils/fmgroids.h"
 #include "utils/injection_point.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/memutils_memorychunk.h"
+#include "utils/sharedtuplestore.h"
 #include "utils/syscache.h"
 #include "utils/tuplesort.h"
+#include "utils/wait_event.h"
 
 /*
  * Control how many partitions are created when spilling HashAgg to
@@ -321,6 +359,40 @@
  */
 #define CHUNKHDRSZ sizeof(MemoryChunk)
 
+/*
+ * In a Parallel HashAgg, every participant keeps a write buffer for each
+ * shared batch while partitioning: the chunk buffered by sharedtuplestore.c
+ * plus the BufFile's own buffer.  We also want a few batches per
+ * participant, so that the participants finish at about the same time even
+ * if some batches turn out bigger than others.
+ */
+#define PARALLEL_HASHAGG_WRITE_BUFFER_SIZE (5 * BLCKSZ)
+#define PARALLEL_HASHAGG_BATCHES_PER_PARTICIPANT 4
+
+/*
+ * The TOC key for the shared state of a Parallel HashAgg.  The plan node ID
+ * itself is already used for the shared instrumentation.
+ */
+#define PARALLEL_KEY_HASHAGG_OFFSET UINT64CONST(0xC000000000000000)
+
+/* Phases of ParallelAggState.barrier */
+#define PHA_PHASE_PARTITION		0
+#define PHA_PHASE_AGGREGATE		1
+
+/*
+ * Shared state of a Parallel HashAgg, followed by 'nbatch' SharedTuplestores,
+ * see ParallelAggBatch().
+ */
+typedef struct ParallelAggState
+{
+	Barrier		barrier;		/* synchronizes the end of partitioning */
+	pg_atomic_uint32 next_batch;	/* next batch to aggregate */
+	int			nbatch;			/* number of batches, a power of two */
+	int			nbatch_bits;	/* log2(nbatch) */
+	int			nparticipants;	/* number of potential participants */
+	SharedFileSet fileset;		/* space for the batch files */
+} ParallelAggState;
+
 /*
  * Represents partitioned spill data for a single hashtable. Contains the
  * necessary information to route tuples to the correct partition, and to
@@ -354,6 +426,8 @@ typedef struct HashAggBatch
 	int			setno;			/* grouping set */
 	int			used_bits;		/* number of bits of hash already used */
 	LogicalTape *input_tape;	/* input partition tape */
+	SharedTuplestoreAccessor *shared_tuples;	/* or shared batch, in a
+												 * Parallel HashAgg */
 	int64		input_tuples;	/* number of tuples in this batch */
 	double		input_card;		/* estimated group cardinality */
 } HashAggBatch;
@@ -419,8 +493,14 @@ static void initialize_hash_entry(AggState *aggstate,
 								  TupleHashEntry entry);
 static void lookup_hash_entries(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_batch(AggState *aggstate);
+static void agg_advance_batch(AggState *aggstate, AggStatePerGroup pergroup,
+							  ExecBatch *batch);
+static void agg_init_batch_mode(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
+static void agg_partition_parallel(AggState *aggstate);
 static bool agg_refill_hash_table(AggState *aggstate);
+static bool agg_claim_parallel_batch(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
 static void hash_agg_check_limits(AggState *aggstate);
@@ -436,10 +516,18 @@ static MinimalTuple hashagg_batch_read(HashAggBatch *batch, uint32 *hashp);
 static void hashagg_spill_init(HashAggSpill *spill, LogicalTapeSet *tapeset,
 							   int used_bits, double input_groups,
 							   double hashentrysize);
+static TupleTableSlot *hashagg_spill_slot(AggState *aggstate,
+										  TupleTableSlot *inputslot);
 static Size hashagg_spill_tuple(AggState *aggstate, HashAggSpill *spill,
 								TupleTableSlot *inputslot, uint32 hash);
 static void hashagg_spill_finish(AggState *aggstate, HashAggSpill *spill,
 								 int setno);
+static int	hash_choose_num_parallel_batches(AggState *aggstate,
+											 int nparticipants);
+static Size parallel_agg_state_size(int nbatch, int nparticipants);
+static SharedTuplestore *ParallelAggBatch(ParallelAggState *pstate, int batchno);
+static void parallel_agg_attach_batches(AggState *node, int participant,
+										bool initialize);
 static Datum GetAggInitVal(Datum textInitVal, Oid transtype);
 static void build_pertrans_for_aggref(AggStatePerTrans pertrans,
 									  AggState *aggstate, EState *estate,
@@ -1922,6 +2010,14 @@ hash_agg_enter_spill_mode(AggState *aggstate)
 
 		aggstate->hash_tapeset = LogicalTapeSetCreate(true, NULL, -1);
 
+		/*
+		 * A Parallel HashAgg first runs out of memory while processing a
+		 * shared batch, and agg_refill_hash_table() sets up the partitions
+		 * to spill to.
+		 */
+		if (aggstate->table_filled)
+			return;
+
 		aggstate->hash_spills = palloc_array(HashAggSpill, aggstate->num_hashes);
 
 		for (int setno = 0; setno < aggstate->num_hashes; setno++)
@@ -2258,12 +2354,23 @@ ExecAgg(PlanState *pstate)
 		{
 			case AGG_HASHED:
 				if (!node->table_filled)
-					agg_fill_hash_table(node);
+				{
+					if (node->parallel_state != NULL)
+						agg_partition_parallel(node);
+					else
+						agg_fill_hash_table(node);
+				}
 				pg_fallthrough;
 			case AGG_MIXED:
 				result = agg_retrieve_hash_table(node);
 				break;
 			case AGG_PLAIN:
+				if (node->batch_input != NULL)
+				{
+					result = agg_retrieve_batch(node);
+					break;
+				}
+				pg_fallthrough;
 			case AGG_SORTED:
 				result = agg_retrieve_direct(node);
 				break;
@@ -2622,6 +2729,458 @@ agg_retrieve_direct(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * ExecAgg for plain aggregation in batch mode
+ *
+ * This is the batch mode equivalent of the AGG_PLAIN case of
+ * agg_retrieve_direct(): aggregate all input and project a single row.
+ */
+static TupleTableSlot *
+agg_retrieve_batch(AggState *aggstate)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	AggStatePerGroup *pergroups = aggstate->pergroups;
+	ExecBatch  *batch;
+	TupleTableSlot *result;
+
+	Assert(aggstate->phase->aggstrategy == AGG_PLAIN);
+	Assert(aggstate->phase->numsets == 0);
+
+	ReScanExprContext(econtext);
+	ReScanExprContext(aggstate->aggcontexts[0]);
+
+	initialize_aggregates(aggstate, pergroups, 1);
+	select_current_set(aggstate, 0, false);
+
+	while ((batch = ExecSeqScanNextBatch(aggstate->batch_input)) != NULL)
+	{
+		if (batch->nselected > 0)
+			agg_advance_batch(aggstate, pergroups[0], batch);
+
+		/* release anything the transition functions leaked */
+		ResetExprContext(aggstate->tmpcontext);
+	}
+
+	aggstate->input_done = true;
+	aggstate->agg_done = true;
+
+	/*
+	 * There are no references to non-aggregated input columns in a plain
+	 * aggregation, so project with an empty outer tuple.
+	 */
+	ExecClearTuple(aggstate->ss.ss_ScanTupleSlot);
+	econtext->ecxt_outertuple = aggstate->ss.ss_ScanTupleSlot;
+	aggstate->projected_set = 0;
+
+	prepare_projection_slot(aggstate, econtext->ecxt_outertuple, 0);
+	finalize_aggregates(aggstate, aggstate->peragg, pergroups[0]);
+
+	/* the HAVING qual may reject the only row, leaving nothing to return */
+	result = project_aggregates(aggstate);
+
+	return result;
+}
+
+/*
+ * Fold the non-null values of the selected rows into a transition state
+ * whose transition function is strict and has no initial value, so that the
+ * first non-null input becomes the state (sum() of floats, min(), max()).
+ */
+#define AGG_BATCH_FOLD(ctype, getval, makedatum, combine) \
+	do { \
+		ctype		state = 0; \
+		bool		have_state = !pergroup->noTransValue; \
+		\
+		/* nothing to do if the transition function returned NULL */ \
+		if (have_state && pergroup->transValueIsNull) \
+			break; \
+		if (have_state) \
+			state = getval(pergroup->transValue); \
+		for (int i = 0; i < nsel; i++) \
+		{ \
+			ctype		val; \
+			\
+			if (isnull[sel[i]]) \
+				continue; \
+			val = getval(values[sel[i]]); \
+			if (have_state) \
+				state = combine(state, val); \
+			else \
+			{ \
+				state = val; \
+				have_state = true; \
+			} \
+		} \
+		if (have_state) \
+		{ \
+			pergroup->transValue = makedatum(state); \
+			pergroup->transValueIsNull = false; \
+			pergroup->noTransValue = false; \
+		} \
+	} while (0)
+
+#define AGG_BATCH_MIN(a, b)		((a) < (b) ? (a) : (b))
+#define AGG_BATCH_MAX(a, b)		((a) > (b) ? (a) : (b))
+#define AGG_BATCH_FLOAT4_MIN(a, b)	(float4_lt(a, b) ? (a) : (b))
+#define AGG_BATCH_FLOAT4_MAX(a, b)	(float4_gt(a, b) ? (a) : (b))
+#define AGG_BATCH_FLOAT8_MIN(a, b)	(float8_lt(a, b) ? (a) : (b))
+#define AGG_BATCH_FLOAT8_MAX(a, b)	(float8_gt(a, b) ? (a) : (b))
+
+/*
+ * Advance all transition states over the selected rows of a batch.
+ *
+ * Each case must produce exactly the same transition state as calling the
+ * transition function for each input row in turn would; see
+ * agg_init_batch_mode() for the functions each case stands in for.
+ */
+static void
+agg_advance_batch(AggState *aggstate, AggStatePerGroup pergroups,
+				  ExecBatch *batch)
+{
+	const int  *sel = batch->sel;
+	int			nsel = batch->nselected;
+
+	for (int transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+		AggStatePerGroup pergroup = &pergroups[transno];
+		const Datum *values = NULL;
+		const bool *isnull = NULL;
+
+		if (pertrans->batchcol >= 0)
+		{
+			values = batch->values[pertrans->batchcol];
+			isnull = batch->isnull[pertrans->batchcol];
+		}
+
+		switch (pertrans->batchtrans)
+		{
+			case AGG_BATCH_NONE:
+				elog(ERROR, "aggregate is not batch-capable");
+				break;
+			case AGG_BATCH_COUNT_STAR:
+			case AGG_BATCH_COUNT:
+				{
+					int64		count = DatumGetInt64(pergroup->transValue);
+					int64		nvalues = nsel;
+
+					Assert(!pergroup->transValueIsNull);
+
+					if (pertrans->batchtrans == AGG_BATCH_COUNT)
+					{
+						nvalues = 0;
+						for (int i = 0; i < nsel; i++)
+							nvalues += !isnull[sel[i]];
+					}
+
+					if (unlikely(pg_add_s64_overflow(count, nvalues, &count)))
+						ereport(ERROR,
+								(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+								 errmsg("bigint out of range")));
+					pergroup->transValue = Int64GetDatum(count);
+				}
+				break;
+			case AGG_BATCH_SUM_INT2:
+			case AGG_BATCH_SUM_INT4:
+				{
+					/* like int2_sum() and int4_sum(), this can't overflow */
+					int64		sum = 0;
+					bool		found = false;
+
+					for (int i = 0; i < nsel; i++)
+					{
+						int			row = sel[i];
+
+						if (isnull[row])
+							continue;
+						if (pertrans->batchtrans == AGG_BATCH_SUM_INT2)
+							sum += DatumGetInt16(values[row]);
+						else
+							sum += DatumGetInt32(values[row]);
+						found = true;
+					}
+
+					if (!found)
+						break;
+					if (!pergroup->transValueIsNull)
+						sum += DatumGetInt64(pergroup->transValue);
+					pergroup->transValue = Int64GetDatum(sum);
+					pergroup->transValueIsNull = false;
+				}
+				break;
+			case AGG_BATCH_SUM_FLOAT4:
+				AGG_BATCH_FOLD(float4, DatumGetFloat4, Float4GetDatum,
+							   float4_pl);
+				break;
+			case AGG_BATCH_SUM_FLOAT8:
+				AGG_BATCH_FOLD(float8, DatumGetFloat8, Float8GetDatum,
+							   float8_pl);
+				break;
+			case AGG_BATCH_MIN_INT2:
+				AGG_BATCH_FOLD(int16, DatumGetInt16, Int16GetDatum,
+							   AGG_BATCH_MIN);
+				break;
+			case AGG_BATCH_MIN_INT4:
+				AGG_BATCH_FOLD(int32, DatumGetInt32, Int32GetDatum,
+							   AGG_BATCH_MIN);
+				break;
+			case AGG_BATCH_MIN_INT8:
+				AGG_BATCH_FOLD(int64, DatumGetInt64, Int64GetDatum,
+							   AGG_BATCH_MIN);
+				break;
+			case AGG_BATCH_MIN_FLOAT4:
+				AGG_BATCH_FOLD(float4, DatumGetFloat4, Float4GetDatum,
+							   AGG_BATCH_FLOAT4_MIN);
+				break;
+			case AGG_BATCH_MIN_FLOAT8:
+				AGG_BATCH_FOLD(float8, DatumGetFloat8, Float8GetDatum,
+							   AGG_BATCH_FLOAT8_MIN);
+				break;
+			case AGG_BATCH_MAX_INT2:
+				AGG_BATCH_FOLD(int16, DatumGetInt16, Int16GetDatum,
+							   AGG_BATCH_MAX);
+				break;
+			case AGG_BATCH_MAX_INT4:
+				AGG_BATCH_FOLD(int32, DatumGetInt32, Int32GetDatum,
+							   AGG_BATCH_MAX);
+				break;
+			case AGG_BATCH_MAX_INT8:
+				AGG_BATCH_FOLD(int64, DatumGetInt64, Int64GetDatum,
+							   AGG_BATCH_MAX);
+				break;
+			case AGG_BATCH_MAX_FLOAT4:
+				AGG_BATCH_FOLD(float4, DatumGetFloat4, Float4GetDatum,
+							   AGG_BATCH_FLOAT4_MAX);
+				break;
+			case AGG_BATCH_MAX_FLOAT8:
+				AGG_BATCH_FOLD(float8, DatumGetFloat8, Float8GetDatum,
+							   AGG_BATCH_FLOAT8_MAX);
+				break;
+			case AGG_BATCH_TRANSFN:
+				{
+					FunctionCallInfo fcinfo = pertrans->transfn_fcinfo;
+					MemoryContext oldContext;
+
+					/*
+					 * This is the equivalent of ExecAggPlainTransByVal() and
+					 * ExecAggPlainTransByRef(), for a strict transition
+					 * function with an initial value.
+					 */
+					Assert(pertrans->transfn.fn_strict);
+					Assert(!pertrans->initValueIsNull);
+
+					/* set up aggstate->curpertrans for AggGetAggref() */
+					aggstate->curpertrans = pertrans;
+
+					oldContext = MemoryContextSwitchTo(aggstate->tmpcontext->ecxt_per_tuple_memory);
+
+					for (int i = 0; i < nsel; i++)
+					{
+						int			row = sel[i];
+						Datum		newVal;
+
+						if (isnull[row] || pergroup->transValueIsNull)
+							continue;
+
+						fcinfo->args[0].value = pergroup->transValue;
+						fcinfo->args[0].isnull = false;
+						fcinfo->args[1].value = values[row];
+						fcinfo->args[1].isnull = false;
+						fcinfo->isnull = false;
+
+						newVal = FunctionCallInvoke(fcinfo);
+
+						if (!pertrans->transtypeByVal &&
+							DatumGetPointer(newVal) != DatumGetPointer(pergroup->transValue))
+							newVal = ExecAggCopyTransValue(aggstate, pertrans,
+														   newVal, fcinfo->isnull,
+														   pergroup->transValue,
+														   pergroup->transValueIsNull);
+
+						pergroup->transValue = newVal;
+						pergroup->transValueIsNull = fcinfo->isnull;
+					}
+
+					MemoryContextSwitchTo(oldContext);
+				}
+				break;
+		}
+	}
+}
+
+/*
+ * Decide whether the Agg node can run in batch mode, and if so set it up.
+ *
+ * Batch mode is used for plain aggregation over a SeqScan that can produce
+ * batches, when every transition function is one that agg_advance_batch()
+ * knows how to handle and takes either no argument or a plain column of the
+ * scan.  Aggregates over numeric or int8 inputs have internal transition
+ * states and always use row mode.
+ */
+static void
+agg_init_batch_mode(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	PlanState  *outerstate = outerPlanState(aggstate);
+	Plan	   *outerplan = outerPlan(node);
+	Index		scanrelid;
+	Bitmapset  *attnums = NULL;
+	AttrNumber *transattnums;
+
+	if (!enable_batch_execution ||
+		node->aggstrategy != AGG_PLAIN ||
+		node->groupingSets != NIL ||
+		DO_AGGSPLIT_COMBINE(aggstate->aggsplit) ||
+		aggstate->numtrans == 0 ||
+		aggstate->ss.ps.state->es_epq_active != NULL ||
+		!IsA(outerstate, SeqScanState))
+		return;
+
+	scanrelid = ((Scan *) outerplan)->scanrelid;
+	transattnums = palloc0_array(AttrNumber, aggstate->numtrans);
+
+	for (int transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+		Aggref	   *aggref = pertrans->aggref;
+		AggBatchTrans batchtrans;
+
+		if (aggref->aggkind != AGGKIND_NORMAL ||
+			aggref->aggfilter != NULL ||
+			aggref->aggorder != NIL ||
+			aggref->aggdistinct != NIL)
+			goto fail;
+
+		switch (pertrans->transfn_oid)
+		{
+			case F_INT8INC:
+				batchtrans = AGG_BATCH_COUNT_STAR;
+				break;
+			case F_INT8INC_ANY:
+				batchtrans = AGG_BATCH_COUNT;
+				break;
+			case F_INT2_SUM:
+				batchtrans = AGG_BATCH_SUM_INT2;
+				break;
+			case F_INT4_SUM:
+				batchtrans = AGG_BATCH_SUM_INT4;
+				break;
+			case F_FLOAT4PL:
+				batchtrans = AGG_BATCH_SUM_FLOAT4;
+				break;
+			case F_FLOAT8PL:
+				batchtrans = AGG_BATCH_SUM_FLOAT8;
+				break;
+			case F_INT2SMALLER:
+				batchtrans = AGG_BATCH_MIN_INT2;
+				break;
+			case F_INT4SMALLER:
+				batchtrans = AGG_BATCH_MIN_INT4;
+				break;
+			case F_INT8SMALLER:
+				batchtrans = AGG_BATCH_MIN_INT8;
+				break;
+			case F_FLOAT4SMALLER:
+				batchtrans = AGG_BATCH_MIN_FLOAT4;
+				break;
+			case F_FLOAT8SMALLER:
+				batchtrans = AGG_BATCH_MIN_FLOAT8;
+				break;
+			case F_INT2LARGER:
+				batchtrans = AGG_BATCH_MAX_INT2;
+				break;
+			case F_INT4LARGER:
+				batchtrans = AGG_BATCH_MAX_INT4;
+				break;
+			case F_INT8LARGER:
+				batchtrans = AGG_BATCH_MAX_INT8;
+				break;
+			case F_FLOAT4LARGER:
+				batchtrans = AGG_BATCH_MAX_FLOAT4;
+				break;
+			case F_FLOAT8LARGER:
+				batchtrans = AGG_BATCH_MAX_FLOAT8;
+				break;
+			case F_INT2_AVG_ACCUM:
+			case F_INT4_AVG_ACCUM:
+			case F_FLOAT4_ACCUM:
+			case F_FLOAT8_ACCUM:
+				batchtrans = AGG_BATCH_TRANSFN;
+				break;
+			default:
+				goto fail;
+		}
+
+		/* count(*) is the only supported aggregate without arguments */
+		if (batchtrans == AGG_BATCH_COUNT_STAR)
+		{
+			if (pertrans->numTransInputs != 0)
+				goto fail;
+		}
+		else
+		{
+			TargetEntry *tle;
+			Var		   *var;
+			TargetEntry *scantle;
+			Var		   *scanvar;
+
+			if (pertrans->numTransInputs != 1)
+				goto fail;
+
+			/*
+			 * The argument must be an outer Var referencing a plain column
+			 * of the scanned relation.
+			 */
+			tle = linitial_node(TargetEntry, aggref->args);
+			if (!IsA(tle->expr, Var))
+				goto fail;
+			var = (Var *) tle->expr;
+			if (var->varno != OUTER_VAR ||
+				var->varattno <= 0 ||
+				var->varattno > list_length(outerplan->targetlist))
+				goto fail;
+			scantle = list_nth_node(TargetEntry, outerplan->targetlist,
+									var->varattno - 1);
+			if (!IsA(scantle->expr, Var))
+				goto fail;
+			scanvar = (Var *) scantle->expr;
+			if (scanvar->varno != scanrelid ||
+				scanvar->varlevelsup != 0 ||
+				scanvar->varattno <= 0 ||
+				scanvar->varreturningtype != VAR_RETURNING_DEFAULT)
+				goto fail;
+
+			transattnums[transno] = scanvar->varattno;
+			attnums = bms_add_member(attnums, scanvar->varattno);
+		}
+
+		pertrans->batchtrans = batchtrans;
+	}
+
+	if (!ExecSeqScanInitBatch((SeqScanState *) outerstate, attnums))
+		goto fail;
+
+	aggstate->batch_input = (SeqScanState *) outerstate;
+	for (int transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+
+		if (transattnums[transno] > 0)
+			pertrans->batchcol = ExecBatchGetColumn(aggstate->batch_input->batch,
+													transattnums[transno]);
+	}
+
+	pfree(transattnums);
+	bms_free(attnums);
+	return;
+
+fail:
+	for (int transno = 0; transno < aggstate->numtrans; transno++)
+		aggstate->pertrans[transno].batchtrans = AGG_BATCH_NONE;
+	pfree(transattnums);
+	bms_free(attnums);
+}
+
 /*
  * ExecAgg for hashed case: read input and build hash table
  */
@@ -2667,6 +3226,74 @@ agg_fill_hash_table(AggState *aggstate)
 						   &aggstate->perhash[0].hashiter);
 }
 
+/*
+ * ExecAgg for a Parallel HashAgg: read input and partition it
+ *
+ * Each participant writes the tuples it reads from the outer plan to the
+ * shared batches.  Once every participant attached to the barrier is done,
+ * the groups can be aggregated batch by batch by agg_refill_hash_table().
+ * A participant that arrives after partitioning has finished doesn't read
+ * the outer plan at all, since the others have exhausted it.
+ */
+static void
+agg_partition_parallel(AggState *aggstate)
+{
+	ParallelAggState *pstate = aggstate->parallel_state;
+	AggStatePerHash perhash = &aggstate->perhash[0];
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	int			shift = 32 - pstate->nbatch_bits;
+
+	Assert(aggstate->num_hashes == 1);
+
+	if (BarrierAttach(&pstate->barrier) == PHA_PHASE_PARTITION)
+	{
+		for (;;)
+		{
+			TupleTableSlot *outerslot;
+			TupleTableSlot *spillslot;
+			MinimalTuple tuple;
+			bool		shouldFree;
+			uint32		hash;
+
+			outerslot = fetch_input_tuple(aggstate);
+			if (TupIsNull(outerslot))
+				break;
+
+			tmpcontext->ecxt_outertuple = outerslot;
+
+			prepare_hash_slot(perhash, outerslot, perhash->hashslot);
+			hash = TupleHashTableHash(perhash->hashtable, perhash->hashslot);
+
+			spillslot = hashagg_spill_slot(aggstate, outerslot);
+			tuple = ExecFetchSlotMinimalTuple(spillslot, &shouldFree);
+			sts_puttuple(aggstate->parallel_batches[hash >> shift],
+						 &hash, tuple);
+			if (shouldFree)
+				pfree(tuple);
+
+			ResetExprContext(tmpcontext);
+		}
+
+		for (int i = 0; i < pstate->nbatch; i++)
+			sts_end_write(aggstate->parallel_batches[i]);
+
+		BarrierArriveAndWait(&pstate->barrier,
+							 WAIT_EVENT_HASH_AGG_PARTITION);
+	}
+
+	/* we won't wait again, so don't hold up anyone still partitioning */
+	BarrierDetach(&pstate->barrier);
+
+	/*
+	 * The hash table is still empty, so agg_retrieve_hash_table() will go
+	 * straight on to claim the first batch.
+	 */
+	aggstate->table_filled = true;
+	aggstate->hash_batches_used = 0;
+	select_current_set(aggstate, 0, true);
+	ResetTupleHashIterator(perhash->hashtable, &perhash->hashiter);
+}
+
 /*
  * If any data was spilled during hash aggregation, reset the hash table and
  * reprocess one batch of spilled data. After reprocessing a batch, the hash
@@ -2685,10 +3312,15 @@ agg_refill_hash_table(AggState *aggstate)
 	HashAggBatch *batch;
 	AggStatePerHash perhash;
 	HashAggSpill spill;
-	LogicalTapeSet *tapeset = aggstate->hash_tapeset;
 	bool		spill_initialized = false;
 
-	if (aggstate->hash_batches == NIL)
+	/*
+	 * In a Parallel HashAgg, we move on to the next shared batch only after
+	 * finishing the batches spilled from the current one.
+	 */
+	if (aggstate->hash_batches == NIL &&
+		(aggstate->parallel_state == NULL ||
+		 !agg_claim_parallel_batch(aggstate)))
 		return false;
 
 	/* hash_batches is a stack, with the top item at the end of the list */
@@ -2781,10 +3413,13 @@ agg_refill_hash_table(AggState *aggstate)
 			{
 				/*
 				 * Avoid initializing the spill until we actually need it so
-				 * that we don't assign tapes that will never be used.
+				 * that we don't assign tapes that will never be used.  In a
+				 * Parallel HashAgg, hash_agg_enter_spill_mode() may have
+				 * created the tape set only while processing this batch.
 				 */
 				spill_initialized = true;
-				hashagg_spill_init(&spill, tapeset, batch->used_bits,
+				hashagg_spill_init(&spill, aggstate->hash_tapeset,
+								   batch->used_bits,
 								   batch->input_card, aggstate->hashentrysize);
 			}
 			/* no memory for a new group, spill */
@@ -2800,7 +3435,10 @@ agg_refill_hash_table(AggState *aggstate)
 		ResetExprContext(aggstate->tmpcontext);
 	}
 
-	LogicalTapeClose(batch->input_tape);
+	if (batch->shared_tuples != NULL)
+		sts_end_parallel_scan(batch->shared_tuples);
+	else
+		LogicalTapeClose(batch->input_tape);
 
 	/* change back to phase 0 */
 	aggstate->current_phase = 0;
@@ -2826,6 +3464,35 @@ agg_refill_hash_table(AggState *aggstate)
 	return true;
 }
 
+/*
+ * Claim the next shared batch of a Parallel HashAgg, and push it onto
+ * hash_batches.  Returns false if all batches have been claimed already.
+ */
+static bool
+agg_claim_parallel_batch(AggState *aggstate)
+{
+	ParallelAggState *pstate = aggstate->parallel_state;
+	HashAggBatch *batch;
+	uint32		batchno;
+	double		input_card;
+
+	batchno = pg_atomic_fetch_add_u32(&pstate->next_batch, 1);
+	if (batchno >= pstate->nbatch)
+		return false;
+
+	/* we don't know the size of the batch, so assume an even split */
+	input_card = aggstate->perhash[0].aggnode->numGroups / pstate->nbatch;
+
+	batch = hashagg_batch_new(NULL, 0, 0, input_card, pstate->nbatch_bits);
+	batch->shared_tuples = aggstate->parallel_batches[batchno];
+	sts_begin_parallel_scan(batch->shared_tuples);
+
+	aggstate->hash_batches = lappend(aggstate->hash_batches, batch);
+	aggstate->hash_batches_used++;
+
+	return true;
+}
+
 /*
  * ExecAgg for hashed case: retrieving groups from hash table
  *
@@ -3019,6 +3686,38 @@ hashagg_spill_init(HashAggSpill *spill, LogicalTapeSet *tapeset, int used_bits,
 		initHyperLogLog(&spill->hll_card[i], HASHAGG_HLL_BIT_WIDTH);
 }
 
+/*
+ * hashagg_spill_slot
+ *
+ * Return a slot containing the attributes of inputslot that we actually need,
+ * with the rest set to NULL, so that only those get spilled.
+ */
+static TupleTableSlot *
+hashagg_spill_slot(AggState *aggstate, TupleTableSlot *inputslot)
+{
+	TupleTableSlot *spillslot;
+
+	if (aggstate->all_cols_needed)
+		return inputslot;
+
+	spillslot = aggstate->hash_spill_wslot;
+	slot_getsomeattrs(inputslot, aggstate->max_colno_needed);
+	ExecClearTuple(spillslot);
+	for (int i = 0; i < spillslot->tts_tupleDescriptor->natts; i++)
+	{
+		if (bms_is_member(i + 1, aggstate->colnos_needed))
+		{
+			spillslot->tts_values[i] = inputslot->tts_values[i];
+			spillslot->tts_isnull[i] = inputslot->tts_isnull[i];
+		}
+		else
+			spillslot->tts_isnull[i] = true;
+	}
+	ExecStoreVirtualTuple(spillslot);
+
+	return spillslot;
+}
+
 /*
  * hashagg_spill_tuple
  *
@@ -3039,25 +3738,7 @@ hashagg_spill_tuple(AggState *aggstate, HashAggSpill *spill,
 	Assert(spill->partitions != NULL);
 
 	/* spill only attributes that we actually need */
-	if (!aggstate->all_cols_needed)
-	{
-		spillslot = aggstate->hash_spill_wslot;
-		slot_getsomeattrs(inputslot, aggstate->max_colno_needed);
-		ExecClearTuple(spillslot);
-		for (int i = 0; i < spillslot->tts_tupleDescriptor->natts; i++)
-		{
-			if (bms_is_member(i + 1, aggstate->colnos_needed))
-			{
-				spillslot->tts_values[i] = inputslot->tts_values[i];
-				spillslot->tts_isnull[i] = inputslot->tts_isnull[i];
-			}
-			else
-				spillslot->tts_isnull[i] = true;
-		}
-		ExecStoreVirtualTuple(spillslot);
-	}
-	else
-		spillslot = inputslot;
+	spillslot = hashagg_spill_slot(aggstate, inputslot);
 
 	tuple = ExecFetchSlotMinimalTuple(spillslot, &shouldFree);
 
@@ -3123,6 +3804,17 @@ hashagg_batch_read(HashAggBatch *batch, uint32 *hashp)
 	size_t		nread;
 	uint32		hash;
 
+	/* a shared batch; the caller expects a palloc'd tuple */
+	if (batch->shared_tuples != NULL)
+	{
+		tuple = sts_parallel_scan_next(batch->shared_tuples, &hash);
+		if (tuple == NULL)
+			return NULL;
+		if (hashp != NULL)
+			*hashp = hash;
+		return heap_copy_minimal_tuple(tuple, 0);
+	}
+
 	nread = LogicalTapeRead(tape, &hash, sizeof(uint32));
 	if (nread == 0)
 		return NULL;
@@ -4114,6 +4806,11 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		phase->evaltrans_cache[0][0] = phase->evaltrans;
 	}
 
+	/*
+	 * Finally, see if we can consume the input a batch at a time.
+	 */
+	agg_init_batch_mode(aggstate);
+
 	return aggstate;
 }
 
@@ -4158,6 +4855,8 @@ build_pertrans_for_aggref(AggStatePerTrans pertrans,
 	pertrans->deserialfn_oid = aggdeserialfn;
 	pertrans->initValue = initValue;
 	pertrans->initValueIsNull = initValueIsNull;
+	pertrans->batchtrans = AGG_BATCH_NONE;
+	pertrans->batchcol = -1;
 
 	/* Count the "direct" arguments, if any */
 	numDirectArgs = list_length(aggref->aggdirectargs);
@@ -4486,9 +5185,11 @@ ExecReScanAgg(AggState *node)
 		 * does not have any parameter changes, and none of our own parameter
 		 * changes affect input expressions of the aggregated functions, then
 		 * we can just rescan the existing hash table; no need to build it
-		 * again.
+		 * again.  Not so in a Parallel HashAgg, whose hash table only ever
+		 * holds some of the groups.
 		 */
 		if (outerPlan->chgParam == NULL && !node->hash_ever_spilled &&
+			node->parallel_state == NULL &&
 			!bms_overlap(node->ss.ps.chgParam, aggnode->aggParams))
 		{
 			ResetTupleHashIterator(node->perhash[0].hashtable,
@@ -4851,3 +5552,199 @@ ExecAggRetrieveInstrumentation(AggState *node)
 	memcpy(si, node->shared_info, size);
 	node->shared_info = si;
 }
+
+/*
+ * Choose the number of shared batches for a Parallel HashAgg.  As in
+ * hash_choose_num_partitions(), we want enough batches for each one to fit
+ * in hash_mem, but not so many that the write buffers of the batch files
+ * take up more than 1/4 of hash_mem.  The number of batches is a power of
+ * two, so that they can be selected by the high bits of the hash value.
+ */
+static int
+hash_choose_num_parallel_batches(AggState *aggstate, int nparticipants)
+{
+	Size		hash_mem_limit = get_hash_memory_limit();
+	double		numGroups = aggstate->perhash[0].aggnode->numGroups;
+	double		batch_limit;
+	double		dbatches;
+
+	batch_limit = hash_mem_limit * 0.25 / PARALLEL_HASHAGG_WRITE_BUFFER_SIZE;
+
+	dbatches = 1 + HASHAGG_PARTITION_FACTOR * numGroups *
+		aggstate->hashentrysize / hash_mem_limit;
+	dbatches = Max(dbatches,
+				   nparticipants * PARALLEL_HASHAGG_BATCHES_PER_PARTICIPANT);
+
+	if (dbatches > batch_limit)
+		dbatches = batch_limit;
+	if (dbatches < HASHAGG_MIN_PARTITIONS)
+		dbatches = HASHAGG_MIN_PARTITIONS;
+	if (dbatches > HASHAGG_MAX_PARTITIONS)
+		dbatches = HASHAGG_MAX_PARTITIONS;
+
+	return pg_nextpower2_32((uint32) dbatches);
+}
+
+/*
+ * Size of the shared state of a Parallel HashAgg, including its batches.
+ */
+static Size
+parallel_agg_state_size(int nbatch, int nparticipants)
+{
+	return add_size(MAXALIGN(sizeof(ParallelAggState)),
+					mul_size(nbatch, MAXALIGN(sts_estimate(nparticipants))));
+}
+
+/*
+ * Return the SharedTuplestore holding batch 'batchno'.
+ */
+static SharedTuplestore *
+ParallelAggBatch(ParallelAggState *pstate, int batchno)
+{
+	char	   *batches = (char *) pstate + MAXALIGN(sizeof(ParallelAggState));
+
+	Assert(batchno >= 0 && batchno < pstate->nbatch);
+
+	return (SharedTuplestore *)
+		(batches + batchno * MAXALIGN(sts_estimate(pstate->nparticipants)));
+}
+
+/*
+ * Set up our accessors for the shared batches of a Parallel HashAgg,
+ * initializing the batches if 'initialize' is true.
+ */
+static void
+parallel_agg_attach_batches(AggState *node, int participant, bool initialize)
+{
+	ParallelAggState *pstate = node->parallel_state;
+	MemoryContext oldcontext;
+
+	oldcontext = MemoryContextSwitchTo(node->ss.ps.state->es_query_cxt);
+
+	if (node->parallel_batches != NULL)
+		pfree(node->parallel_batches);
+	node->parallel_batches = palloc_array(SharedTuplestoreAccessor *,
+										  pstate->nbatch);
+
+	for (int i = 0; i < pstate->nbatch; i++)
+	{
+		SharedTuplestore *sts = ParallelAggBatch(pstate, i);
+
+		if (initialize)
+		{
+			char		name[NAMEDATALEN];
+
+			snprintf(name, sizeof(name), "hashagg%d", i);
+			node->parallel_batches[i] =
+				sts_initialize(sts, pstate->nparticipants, participant,
+							   sizeof(uint32), SHARED_TUPLESTORE_SINGLE_PASS,
+							   &pstate->fileset, name);
+		}
+		else
+			node->parallel_batches[i] =
+				sts_attach(sts, participant, &pstate->fileset);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAggParallelEstimate
+ *
+ *		Estimate space required for the shared state of a Parallel
+ *		HashAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAggParallelEstimate(AggState *node, ParallelContext *pcxt)
+{
+	int			nparticipants = pcxt->nworkers + 1;
+	int			nbatch = hash_choose_num_parallel_batches(node, nparticipants);
+
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   parallel_agg_state_size(nbatch, nparticipants));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAggParallelInitializeDSM
+ *
+ *		Set up the shared state of a Parallel HashAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAggParallelInitializeDSM(AggState *node, ParallelContext *pcxt)
+{
+	ParallelAggState *pstate;
+	int			nparticipants = pcxt->nworkers + 1;
+	int			nbatch;
+
+	/*
+	 * Without a DSM segment there are no workers either, and the leader can
+	 * just aggregate its input the ordinary way.
+	 */
+	if (pcxt->seg == NULL)
+		return;
+
+	nbatch = hash_choose_num_parallel_batches(node, nparticipants);
+
+	pstate = shm_toc_allocate(pcxt->toc,
+							  parallel_agg_state_size(nbatch, nparticipants));
+	BarrierInit(&pstate->barrier, 0);
+	pg_atomic_init_u32(&pstate->next_batch, 0);
+	pstate->nbatch = nbatch;
+	pstate->nbatch_bits = pg_ceil_log2_32(nbatch);
+	pstate->nparticipants = nparticipants;
+	SharedFileSetInit(&pstate->fileset, pcxt->seg);
+	shm_toc_insert(pcxt->toc,
+				   node->ss.ps.plan->plan_node_id + PARALLEL_KEY_HASHAGG_OFFSET,
+				   pstate);
+
+	/* the leader is participant 0 */
+	node->parallel_state = pstate;
+	parallel_agg_attach_batches(node, 0, true);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAggParallelReInitializeDSM
+ *
+ *		Reset the shared state of a Parallel HashAgg before beginning a
+ *		fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAggParallelReInitializeDSM(AggState *node, ParallelContext *pcxt)
+{
+	ParallelAggState *pstate = node->parallel_state;
+
+	/* Nothing to do if we failed to create a DSM segment. */
+	if (pstate == NULL)
+		return;
+
+	/* Throw away the old batches, and start over with empty ones. */
+	SharedFileSetDeleteAll(&pstate->fileset);
+	BarrierInit(&pstate->barrier, 0);
+	pg_atomic_write_u32(&pstate->next_batch, 0);
+	parallel_agg_attach_batches(node, 0, true);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAggParallelInitializeWorker
+ *
+ *		Attach worker to the shared state of a Parallel HashAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAggParallelInitializeWorker(AggState *node, ParallelWorkerContext *pwcxt)
+{
+	ParallelAggState *pstate;
+
+	pstate = shm_toc_lookup(pwcxt->toc,
+							node->ss.ps.plan->plan_node_id +
+							PARALLEL_KEY_HASHAGG_OFFSET,
+							false);
+	SharedFileSetAttach(&pstate->fileset, pwcxt->seg);
+
+	node->parallel_state = pstate;
+	parallel_agg_attach_batches(node, ParallelWorkerNumber + 1, false);
+}
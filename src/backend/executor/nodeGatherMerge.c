@@ -18,11 +18,14 @@
 #include "executor/executor.h"
 #include "executor/execParallel.h"
 #include "executor/nodeGatherMerge.h"
+#include "executor/nodeSort.h"
 #include "executor/tqueue.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
 #include "optimizer/optimizer.h"
+#include "storage/latch.h"
 #include "utils/sortsupport.h"
+#include "utils/wait_event.h"
 
 /*
  * When we read tuples from workers, it's a good idea to read several at once
@@ -55,7 +58,10 @@ static MinimalTuple gm_readnext_tuple(GatherMergeState *gm_state, int nreader,
 									  bool nowait, bool *done);
 static void ExecShutdownGatherMergeWorkers(GatherMergeState *node);
 static void gather_merge_setup(GatherMergeState *gm_state);
+static void gather_merge_reset(GatherMergeState *gm_state);
 static void gather_merge_init(GatherMergeState *gm_state);
+static TupleTableSlot *gather_merge_concat_next(GatherMergeState *gm_state);
+static void gather_merge_wait(GatherMergeState *gm_state);
 static void gather_merge_clear_tuples(GatherMergeState *gm_state);
 static bool gather_merge_readnext(GatherMergeState *gm_state, int reader,
 								  bool nowait);
@@ -253,6 +259,16 @@ ExecGatherMerge(PlanState *pstate)
 		/* allow leader to participate if enabled or no choice */
 		if (parallel_leader_participation || node->nreaders == 0)
 			node->need_to_scan_locally = true;
+
+		/*
+		 * If a Parallel Sort below us merges its runs by key ranges, we can
+		 * concatenate the ranges rather than merge the participants' output.
+		 */
+		if (node->pei && IsA(outerPlanState(node), SortState))
+			node->gm_nranges =
+				ExecSortNumRanges(castNode(SortState, outerPlanState(node)));
+		else
+			node->gm_nranges = 0;
 		node->initialized = true;
 	}
 
@@ -267,7 +283,10 @@ ExecGatherMerge(PlanState *pstate)
 	 * Get next tuple, either from one of our workers, or by running the plan
 	 * ourselves.
 	 */
-	slot = gather_merge_getnext(node);
+	if (node->gm_nranges > 0)
+		slot = gather_merge_concat_next(node);
+	else
+		slot = gather_merge_getnext(node);
 	if (TupIsNull(slot))
 		return NULL;
 
@@ -433,17 +452,12 @@ gather_merge_setup(GatherMergeState *gm_state)
 }
 
 /*
- * Initialize the Gather Merge.
- *
- * Reset data structures to ensure they're empty.  Then pull at least one
- * tuple from leader + each worker (or set its "done" indicator), and set up
- * the heap.
+ * Reset the data structures of the Gather Merge to empty.
  */
 static void
-gather_merge_init(GatherMergeState *gm_state)
+gather_merge_reset(GatherMergeState *gm_state)
 {
 	int			nreaders = gm_state->nreaders;
-	bool		nowait = true;
 	int			i;
 
 	/* Assert that gather_merge_setup made enough space */
@@ -466,6 +480,23 @@ gather_merge_init(GatherMergeState *gm_state)
 
 	/* Reset binary heap to empty */
 	binaryheap_reset(gm_state->gm_heap);
+}
+
+/*
+ * Initialize the Gather Merge.
+ *
+ * Reset data structures to ensure they're empty.  Then pull at least one
+ * tuple from leader + each worker (or set its "done" indicator), and set up
+ * the heap.
+ */
+static void
+gather_merge_init(GatherMergeState *gm_state)
+{
+	int			nreaders = gm_state->nreaders;
+	bool		nowait = true;
+	int			i;
+
+	gather_merge_reset(gm_state);
 
 	/*
 	 * First, try to read a tuple from each worker (including leader) in
@@ -589,6 +620,168 @@ gather_merge_getnext(GatherMergeState *gm_state)
 	}
 }
 
+/*
+ * Read the next tuple for gather merge, when the Parallel Sort below us
+ * merges its runs by key ranges.
+ *
+ * Each participant of the sort claims the ranges one at a time, in key
+ * order, and returns the tuples of each range it claims in turn.  So rather
+ * than merging the participants' output, we can return the ranges one after
+ * another, reading each from the participant that claimed it.  All we need
+ * to know is where one range ends and the next begins in that participant's
+ * output, and the sort tells us that: it publishes the number of tuples of
+ * a range before returning any tuple of the next one.  A participant's
+ * tuples that belong to a later range wait in its slot or tuple buffer
+ * until we get there.
+ *
+ * Note that the ordinary merge in gather_merge_getnext() would give the
+ * right answer too, since each participant's output is still sorted; it
+ * just has to compare every tuple.
+ */
+static TupleTableSlot *
+gather_merge_concat_next(GatherMergeState *gm_state)
+{
+	SortState  *sortstate = castNode(SortState, outerPlanState(gm_state));
+
+	if (!gm_state->gm_initialized)
+	{
+		gather_merge_reset(gm_state);
+		gm_state->gm_range = 0;
+		gm_state->gm_range_owner = -1;
+		gm_state->gm_range_tuples = -1;
+		gm_state->gm_range_returned = 0;
+		gm_state->gm_returned = -1;
+		gm_state->gm_initialized = true;
+	}
+	else if (gm_state->gm_returned > 0)
+		ExecClearTuple(gm_state->gm_slots[gm_state->gm_returned]);
+	else if (gm_state->gm_returned == 0)
+		gm_state->gm_slots[0] = NULL;
+	gm_state->gm_returned = -1;
+
+	while (gm_state->gm_range < gm_state->gm_nranges)
+	{
+		int			owner;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* Move on to the next range once we've returned all of this one */
+		if (gm_state->gm_range_tuples < 0)
+			gm_state->gm_range_tuples =
+				ExecSortRangeTuples(sortstate, gm_state->gm_range);
+		if (gm_state->gm_range_tuples == gm_state->gm_range_returned)
+		{
+			gm_state->gm_range++;
+			gm_state->gm_range_owner = -1;
+			gm_state->gm_range_tuples = -1;
+			gm_state->gm_range_returned = 0;
+			continue;
+		}
+
+		/* Find out who is merging the range, if we don't know yet */
+		if (gm_state->gm_range_owner < 0)
+		{
+			gm_state->gm_range_owner =
+				ExecSortRangeOwner(sortstate, gm_state->gm_range);
+			if (gm_state->gm_range_owner < 0)
+			{
+				gather_merge_wait(gm_state);
+				continue;
+			}
+			Assert(gm_state->gm_range_owner <= gm_state->nreaders);
+		}
+		owner = gm_state->gm_range_owner;
+
+		if (TupIsNull(gm_state->gm_slots[owner]))
+		{
+			if (gather_merge_readnext(gm_state, owner, false))
+				continue;
+
+			/*
+			 * The owner is done, so it must have published the number of
+			 * tuples in the range by now, and we must have seen them all.
+			 * Anything else means it failed; let the error it reported take
+			 * precedence.
+			 */
+			gm_state->gm_range_tuples =
+				ExecSortRangeTuples(sortstate, gm_state->gm_range);
+			if (gm_state->gm_range_tuples != gm_state->gm_range_returned)
+			{
+				ExecShutdownGatherMergeWorkers(gm_state);
+				elog(ERROR, "participant %d returned " INT64_FORMAT " of " INT64_FORMAT " tuples in key range %d",
+					 owner, gm_state->gm_range_returned,
+					 gm_state->gm_range_tuples, gm_state->gm_range);
+			}
+			continue;
+		}
+
+		/*
+		 * The owner's next tuple might belong to a later range, in which case
+		 * the number of tuples in this one has been published before it.
+		 */
+		if (gm_state->gm_range_tuples < 0)
+		{
+			gm_state->gm_range_tuples =
+				ExecSortRangeTuples(sortstate, gm_state->gm_range);
+			if (gm_state->gm_range_tuples == gm_state->gm_range_returned)
+				continue;
+		}
+
+		gm_state->gm_range_returned++;
+		gm_state->gm_returned = owner;
+		return gm_state->gm_slots[owner];
+	}
+
+	/* All the ranges are done */
+	gather_merge_clear_tuples(gm_state);
+	return NULL;
+}
+
+/*
+ * Wait for a key range to be claimed, doing what we can meanwhile.
+ *
+ * If the leader takes part in the sort and has no tuple pending, it might be
+ * the one to claim the range, so run the plan.  Otherwise read whatever the
+ * workers have sent us, so that none of them is blocked on a full queue, and
+ * sleep until they send more.  The range is unclaimed only while all the
+ * participants are merging earlier ranges, or before they get to merging.
+ */
+static void
+gather_merge_wait(GatherMergeState *gm_state)
+{
+	bool		all_done = true;
+	int			i;
+
+	if (gm_state->need_to_scan_locally && gm_state->gm_slots[0] == NULL)
+	{
+		(void) gather_merge_readnext(gm_state, 0, false);
+		return;
+	}
+
+	for (i = 1; i <= gm_state->nreaders; i++)
+	{
+		if (gm_state->gm_tuple_buffers[i - 1].done)
+			continue;
+		all_done = false;
+		load_tuple_array(gm_state, i);
+	}
+
+	/*
+	 * If everyone is done without claiming the range, some worker must have
+	 * failed; let the error it reported take precedence.
+	 */
+	if (all_done)
+	{
+		ExecShutdownGatherMergeWorkers(gm_state);
+		elog(ERROR, "key range %d of parallel sort was not merged",
+			 gm_state->gm_range);
+	}
+
+	(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, 0,
+					 WAIT_EVENT_EXECUTE_GATHER);
+	ResetLatch(MyLatch);
+}
+
 /*
  * Read tuple(s) for given reader in nowait mode, and load into its tuple
  * array, until we have MAX_TUPLE_STORE of them or would have to block.
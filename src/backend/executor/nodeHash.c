@@ -35,6 +35,7 @@
 #include "executor/instrument.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "port/pg_bitutils.h"
 #include "utils/lsyscache.h"
@@ -80,6 +81,15 @@ static bool ExecParallelHashTuplePrealloc(HashJoinTable hashtable,
 										  size_t size);
 static void ExecParallelHashMergeCounters(HashJoinTable hashtable);
 static void ExecParallelHashCloseBatchAccessors(HashJoinTable hashtable);
+static void ExecHashSetBloomFilter(HashState *node, bloom_filter *filter);
+
+/*
+ * The Bloom filter is passed to the scans as a bytea, with the filter itself
+ * starting at a MAXALIGN'd offset so that it can be used in place.
+ */
+#define HashBloomFilterOffset	MAXALIGN(VARHDRSZ)
+#define DatumGetHashBloomFilter(d) \
+	((bloom_filter *) ((char *) DatumGetPointer(d) + HashBloomFilterOffset))
 
 
 /* ----------------------------------------------------------------
@@ -143,6 +153,7 @@ MultiExecPrivateHash(HashState *node)
 	TupleTableSlot *slot;
 	ExprContext *econtext;
 	double		nullTuples = 0;
+	bloom_filter *bloom = NULL;
 
 	/*
 	 * get state info from node
@@ -155,6 +166,14 @@ MultiExecPrivateHash(HashState *node)
 	 */
 	econtext = node->ps.ps_ExprContext;
 
+	/* Prepare to collect the hash values for the outer plan's Bloom filter */
+	if (((Hash *) node->ps.plan)->bloomParam >= 0)
+	{
+		ExecHashSetBloomFilter(node, NULL);
+		bloom = bloom_create((int64) Max(node->ps.plan->plan_rows, 1.0),
+							 work_mem, 0);
+	}
+
 	/*
 	 * Get all tuples from the node below the Hash node and insert the
 	 * potentially-matchable ones into the hash table (or temp files).  Tuples
@@ -184,6 +203,10 @@ MultiExecPrivateHash(HashState *node)
 			uint32		hashvalue = DatumGetUInt32(hashdatum);
 			int			bucketNumber;
 
+			if (bloom)
+				bloom_add_element(bloom, (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
+
 			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
 			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
 			{
@@ -220,6 +243,138 @@ MultiExecPrivateHash(HashState *node)
 
 	/* Report total number of tuples output (but not those discarded) */
 	hashtable->reportTuples = hashtable->totalTuples + nullTuples;
+
+	if (bloom)
+	{
+		ExecHashSetBloomFilter(node, bloom);
+		bloom_free(bloom);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecHashSetBloomFilter
+ *
+ *		Set the Bloom filter param of the Hash node to a copy of the given
+ *		filter, or to null if it's NULL.  Scans using the filter read the
+ *		param directly, or receive it from their Gather node.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecHashSetBloomFilter(HashState *node, bloom_filter *filter)
+{
+	EState	   *estate = node->ps.state;
+	ParamExecData *prm;
+
+	prm = &estate->es_param_exec_vals[((Hash *) node->ps.plan)->bloomParam];
+	prm->value = (Datum) 0;
+	prm->isnull = true;
+
+	if (node->bloom_value)
+	{
+		pfree(node->bloom_value);
+		node->bloom_value = NULL;
+	}
+
+	if (filter)
+	{
+		size_t		size = bloom_total_size(filter);
+
+		node->bloom_value = MemoryContextAlloc(estate->es_query_cxt,
+											   HashBloomFilterOffset + size);
+		SET_VARSIZE(node->bloom_value, HashBloomFilterOffset + size);
+		memcpy(DatumGetHashBloomFilter(PointerGetDatum(node->bloom_value)),
+			   filter, size);
+		prm->value = PointerGetDatum(node->bloom_value);
+		prm->isnull = false;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitHashBloomFilters
+ *
+ *		Initialize the run-time state of the given HashBloomFilters, for
+ *		a scan node
+ * ----------------------------------------------------------------
+ */
+List *
+ExecInitHashBloomFilters(List *filters, PlanState *parent)
+{
+	List	   *result = NIL;
+
+	foreach_node(HashBloomFilter, filter, filters)
+	{
+		HashBloomFilterState *fstate = palloc_object(HashBloomFilterState);
+		int			nkeys = list_length(filter->hashoperators);
+		Oid		   *outer_hashfuncid = palloc_array(Oid, nkeys);
+		Oid		   *inner_hashfuncid = palloc_array(Oid, nkeys);
+		bool	   *hash_strict = palloc_array(bool, nkeys);
+
+		/* Hash the keys the same way as the hash join's outer side does */
+		foreach_oid(hashop, filter->hashoperators)
+		{
+			int			i = foreach_current_index(hashop);
+
+			if (!get_op_hash_functions(hashop,
+									   &outer_hashfuncid[i],
+									   &inner_hashfuncid[i]))
+				elog(ERROR,
+					 "could not find hash function for hash operator %u",
+					 hashop);
+			hash_strict[i] = op_strict(hashop);
+		}
+
+		fstate->paramid = filter->paramid;
+		fstate->hash_expr = ExecBuildHash32Expr(NULL,
+												NULL,
+												outer_hashfuncid,
+												filter->hashcollations,
+												filter->hashkeys,
+												hash_strict,
+												parent,
+												0);
+		result = lappend(result, fstate);
+	}
+
+	return result;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecHashBloomFiltersPass
+ *
+ *		Check the scan tuple in econtext against the Bloom filters.  Returns
+ *		false if the tuple's keys are certainly absent from the hash table
+ *		of any of the filters' hash joins, so that the tuple can't join.
+ *		Filters that haven't been built yet pass every tuple.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecHashBloomFiltersPass(List *filters, ExprContext *econtext)
+{
+	foreach_ptr(HashBloomFilterState, fstate, filters)
+	{
+		ParamExecData *prm = &econtext->ecxt_param_exec_vals[fstate->paramid];
+		Datum		hashdatum;
+		bool		isnull;
+		uint32		hashvalue;
+
+		if (prm->isnull)
+			continue;
+
+		hashdatum = ExecEvalExprSwitchContext(fstate->hash_expr, econtext,
+											  &isnull);
+
+		/* a null join key never finds a match */
+		if (isnull)
+			return false;
+
+		hashvalue = DatumGetUInt32(hashdatum);
+		if (bloom_lacks_element(DatumGetHashBloomFilter(prm->value),
+								(unsigned char *) &hashvalue,
+								sizeof(hashvalue)))
+			return false;
+	}
+
+	return true;
 }
 
 /* ----------------------------------------------------------------
@@ -439,6 +594,15 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->null_tuple_store = NULL;
 	hashstate->keep_null_tuples = false;
 
+	/* scans below the join must not see a Bloom filter before we build it */
+	if (node->bloomParam >= 0)
+	{
+		ParamExecData *prm = &estate->es_param_exec_vals[node->bloomParam];
+
+		prm->value = (Datum) 0;
+		prm->isnull = true;
+	}
+
 	return hashstate;
 }
 
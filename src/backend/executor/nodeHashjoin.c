@@ -315,6 +315,14 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 					 */
 					node->hj_FirstOuterTupleSlot = NULL;
 				}
+				else if (((Hash *) hashNode->ps.plan)->bloomParam >= 0)
+				{
+					/*
+					 * The hash table provides a Bloom filter to the outer
+					 * plan, which should have it from the first tuple on.
+					 */
+					node->hj_FirstOuterTupleSlot = NULL;
+				}
 				else if (HJ_FILL_OUTER(node) ||
 						 (outerNode->plan->startup_cost < hashNode->ps.plan->total_cost &&
 						  !node->hj_OuterNotEmpty))
@@ -114,8 +114,9 @@ IndexNext(IndexScanState *node)
 								   node->iss_Instrument,
 								   node->iss_NumScanKeys,
 								   node->iss_NumOrderByKeys,
-								   ScanRelIsReadOnly(&node->ss) ?
-								   SO_HINT_REL_READ_ONLY : SO_NONE);
+								   SO_INDEX_PREFETCH |
+								   (ScanRelIsReadOnly(&node->ss) ?
+									SO_HINT_REL_READ_ONLY : SO_NONE));
 
 		node->iss_ScanDesc = scandesc;
 
@@ -1710,8 +1711,9 @@ ExecIndexScanInitializeDSM(IndexScanState *node,
 								 node->iss_NumScanKeys,
 								 node->iss_NumOrderByKeys,
 								 piscan,
-								 ScanRelIsReadOnly(&node->ss) ?
-								 SO_HINT_REL_READ_ONLY : SO_NONE);
+								 SO_INDEX_PREFETCH |
+								 (ScanRelIsReadOnly(&node->ss) ?
+								  SO_HINT_REL_READ_ONLY : SO_NONE));
 
 	/*
 	 * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -1758,8 +1760,9 @@ ExecIndexScanInitializeWorker(IndexScanState *node,
 								 node->iss_NumScanKeys,
 								 node->iss_NumOrderByKeys,
 								 piscan,
-								 ScanRelIsReadOnly(&node->ss) ?
-								 SO_HINT_REL_READ_ONLY : SO_NONE);
+								 SO_INDEX_PREFETCH |
+								 (ScanRelIsReadOnly(&node->ss) ?
+								  SO_HINT_REL_READ_ONLY : SO_NONE));
 
 	/*
 	 * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -17,14 +17,36 @@
  *		ExecNestLoop	 - process a nestloop join of two plans
  *		ExecInitNestLoop - initialize the join
  *		ExecEndNestLoop  - shut down the join
+ *
+ *	 NOTES
+ *		An adaptive nestloop (one whose plan has a hash_plan) starts out
+ *		like any other, but once the outer side has returned more than
+ *		adaptive_rows rows, it builds a hash table over the inner relation
+ *		using the Hash node in hash_plan and probes that for the rest of the
+ *		outer tuples, instead of rescanning the parameterized inner plan
+ *		each time.  The hash tuples are checked against hash_joinqual, which
+ *		includes the join clauses that the inner plan would have enforced.
+ *		If the inner relation doesn't fit in hash_mem after all, we just
+ *		carry on with the nested loop.
  */
 
 #include "postgres.h"
 
 #include "executor/execdebug.h"
+#include "executor/hashjoin.h"
 #include "executor/instrument.h"
+#include "executor/nodeHash.h"
 #include "executor/nodeNestloop.h"
 #include "miscadmin.h"
+#include "utils/lsyscache.h"
+
+
+static void ExecNestLoopSwitchToHash(NestLoopState *node);
+static void ExecNestLoopStartProbe(NestLoopState *node,
+								   ExprContext *econtext);
+static TupleTableSlot *ExecNestLoopScanHashBucket(NestLoopState *node);
+static void ExecInitNestLoopHash(NestLoopState *nlstate, NestLoop *node,
+								 EState *estate, int eflags);
 
 
 /* ----------------------------------------------------------------
@@ -121,6 +143,24 @@ ExecNestLoop(PlanState *pstate)
 			econtext->ecxt_outertuple = outerTupleSlot;
 			node->nl_NeedNewOuter = false;
 			node->nl_MatchedOuter = false;
+			node->nl_OuterRows += 1;
+
+			/*
+			 * If the outer side has returned more rows than an adaptive
+			 * nestloop is prepared to rescan the inner side for, switch to
+			 * hashing.  Once we have the hash table, there's no need to
+			 * rescan anything; just look up the outer tuple in it.
+			 */
+			if (nl->hash_plan != NULL && !node->nl_Hashing &&
+				!node->nl_HashTooBig &&
+				node->nl_OuterRows > nl->adaptive_rows)
+				ExecNestLoopSwitchToHash(node);
+
+			if (node->nl_Hashing)
+			{
+				ExecNestLoopStartProbe(node, econtext);
+				continue;
+			}
 
 			/*
 			 * fetch the values of any outer Vars that must be passed to the
@@ -157,7 +197,10 @@ ExecNestLoop(PlanState *pstate)
 		 */
 		ENL1_printf("getting new inner tuple");
 
-		innerTupleSlot = ExecProcNode(innerPlan);
+		if (node->nl_Hashing)
+			innerTupleSlot = ExecNestLoopScanHashBucket(node);
+		else
+			innerTupleSlot = ExecProcNode(innerPlan);
 		econtext->ecxt_innertuple = innerTupleSlot;
 
 		if (TupIsNull(innerTupleSlot))
@@ -207,11 +250,14 @@ ExecNestLoop(PlanState *pstate)
 		 * qualification.
 		 *
 		 * Only the joinquals determine MatchedOuter status, but all quals
-		 * must pass to actually return the tuple.
+		 * must pass to actually return the tuple.  When probing the hash
+		 * table, the tuple has only been matched on hash value, and the quals
+		 * enforced by the inner plan must be checked too.
 		 */
 		ENL1_printf("testing qualification");
 
-		if (ExecQual(joinqual, econtext))
+		if (ExecQual(node->nl_Hashing ? node->nl_HashJoinQual : joinqual,
+					 econtext))
 		{
 			node->nl_MatchedOuter = true;
 
@@ -255,6 +301,103 @@ ExecNestLoop(PlanState *pstate)
 	}
 }
 
+/*
+ * Build the hash table of an adaptive nestloop, and start using it unless it
+ * turned out to need more than one batch.
+ */
+static void
+ExecNestLoopSwitchToHash(NestLoopState *node)
+{
+	HashState  *hashNode = castNode(HashState, node->nl_HashPlanState);
+	HashJoinTable hashtable;
+
+	ENL1_printf("switching to hash table");
+
+	hashtable = ExecHashTableCreate(hashNode);
+	hashNode->hashtable = hashtable;
+	(void) MultiExecProcNode((PlanState *) hashNode);
+
+	/*
+	 * We're not prepared to batch the outer side, so if the inner relation
+	 * didn't fit in hash_mem, throw the table away and stick with the nested
+	 * loop for the rest of this scan.
+	 */
+	if (hashtable->nbatch > 1)
+	{
+		ExecHashTableDestroy(hashtable);
+		hashNode->hashtable = NULL;
+		node->nl_HashTooBig = true;
+		return;
+	}
+
+	node->nl_HashTable = hashtable;
+	node->nl_Hashing = true;
+	if (node->nl_SwitchedAt == 0)
+		node->nl_SwitchedAt = node->nl_OuterRows;
+}
+
+/*
+ * Compute the hash value of the new outer tuple, and find its bucket.
+ */
+static void
+ExecNestLoopStartProbe(NestLoopState *node, ExprContext *econtext)
+{
+	Datum		hashdatum;
+	bool		isnull;
+	int			batchno;
+
+	hashdatum = ExecEvalExprSwitchContext(node->nl_OuterHash, econtext,
+										  &isnull);
+	node->nl_CurTuple = NULL;
+
+	/* a null join key can't match anything */
+	if (isnull)
+	{
+		node->nl_CurBucketNo = -1;
+		return;
+	}
+
+	node->nl_CurHashValue = DatumGetUInt32(hashdatum);
+	ExecHashGetBucketAndBatch(node->nl_HashTable, node->nl_CurHashValue,
+							  &node->nl_CurBucketNo, &batchno);
+	Assert(batchno == 0);
+}
+
+/*
+ * Return the next tuple in the current outer tuple's bucket that has the
+ * same hash value, or NULL if there are no more.  This is a simplified
+ * ExecScanHashBucket(), as there's no skew table and only one batch.
+ */
+static TupleTableSlot *
+ExecNestLoopScanHashBucket(NestLoopState *node)
+{
+	HashJoinTuple hashTuple = node->nl_CurTuple;
+
+	if (node->nl_CurBucketNo < 0)
+		return NULL;
+
+	if (hashTuple != NULL)
+		hashTuple = hashTuple->next.unshared;
+	else
+		hashTuple = node->nl_HashTable->buckets.unshared[node->nl_CurBucketNo];
+
+	while (hashTuple != NULL)
+	{
+		if (hashTuple->hashvalue == node->nl_CurHashValue)
+		{
+			node->nl_CurTuple = hashTuple;
+			return ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
+										 node->nl_HashTupleSlot,
+										 false);
+		}
+		hashTuple = hashTuple->next.unshared;
+	}
+
+	/* no more matches; make sure we don't come back here */
+	node->nl_CurBucketNo = -1;
+	return NULL;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitNestLoop
  * ----------------------------------------------------------------
@@ -301,6 +444,16 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 		eflags &= ~EXEC_FLAG_REWIND;
 	innerPlanState(nlstate) = ExecInitNode(innerPlan(node), estate, eflags);
 
+	/*
+	 * In an adaptive nestloop, the inner tuples may come from the inner plan
+	 * or from the hash table, so expressions can't assume their slot type.
+	 */
+	if (node->hash_plan != NULL)
+	{
+		nlstate->js.ps.inneropsset = true;
+		nlstate->js.ps.inneropsfixed = false;
+	}
+
 	/*
 	 * Initialize result slot, type and projection.
 	 */
@@ -340,6 +493,9 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 				 (int) node->join.jointype);
 	}
 
+	if (node->hash_plan != NULL)
+		ExecInitNestLoopHash(nlstate, node, estate, eflags);
+
 	/*
 	 * finally, wipe the current outer tuple clean.
 	 */
@@ -352,6 +508,78 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 	return nlstate;
 }
 
+/*
+ * Set up the hash table machinery of an adaptive nestloop.  This follows
+ * ExecInitHashJoin().
+ */
+static void
+ExecInitNestLoopHash(NestLoopState *nlstate, NestLoop *node,
+					 EState *estate, int eflags)
+{
+	HashState  *hashstate;
+	Hash	   *hash = (Hash *) node->hash_plan;
+	Oid		   *outer_hashfuncid;
+	Oid		   *inner_hashfuncid;
+	bool	   *hash_strict;
+	ListCell   *lc;
+	int			nkeys;
+
+	hashstate = (HashState *) ExecInitNode(node->hash_plan, estate,
+										   eflags & ~EXEC_FLAG_REWIND);
+	nlstate->nl_HashPlanState = (PlanState *) hashstate;
+
+	/* Hash nodes don't return tuples, so borrow its slot, as hash joins do */
+	nlstate->nl_HashTupleSlot = hashstate->ps.ps_ResultTupleSlot;
+
+	nkeys = list_length(node->hash_operators);
+	outer_hashfuncid = palloc_array(Oid, nkeys);
+	inner_hashfuncid = palloc_array(Oid, nkeys);
+	hash_strict = palloc_array(bool, nkeys);
+
+	foreach(lc, node->hash_operators)
+	{
+		Oid			hashop = lfirst_oid(lc);
+		int			i = foreach_current_index(lc);
+
+		if (!get_op_hash_functions(hashop,
+								   &outer_hashfuncid[i],
+								   &inner_hashfuncid[i]))
+			elog(ERROR,
+				 "could not find hash function for hash operator %u",
+				 hashop);
+		hash_strict[i] = op_strict(hashop);
+	}
+
+	nlstate->nl_OuterHash =
+		ExecBuildHash32Expr(nlstate->js.ps.ps_ResultTupleDesc,
+							nlstate->js.ps.resultops,
+							outer_hashfuncid,
+							node->hash_collations,
+							node->hash_outerkeys,
+							hash_strict,
+							&nlstate->js.ps,
+							0);
+	hashstate->hash_expr =
+		ExecBuildHash32Expr(hashstate->ps.ps_ResultTupleDesc,
+							hashstate->ps.resultops,
+							inner_hashfuncid,
+							node->hash_collations,
+							hash->hashkeys,
+							hash_strict,
+							&hashstate->ps,
+							0);
+	/* inner tuples with null keys can't match, and aren't null-extended */
+	hashstate->keep_null_tuples = false;
+
+	nlstate->nl_HashJoinQual =
+		ExecInitQual(node->hash_joinqual, (PlanState *) nlstate);
+	nlstate->nl_CurBucketNo = -1;
+
+	pfree(outer_hashfuncid);
+	pfree(inner_hashfuncid);
+	pfree(hash_strict);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndNestLoop
  *
@@ -364,11 +592,22 @@ ExecEndNestLoop(NestLoopState *node)
 	NL1_printf("ExecEndNestLoop: %s\n",
 			   "ending node processing");
 
+	/*
+	 * Free hash table
+	 */
+	if (node->nl_HashTable)
+	{
+		ExecHashTableDestroy(node->nl_HashTable);
+		node->nl_HashTable = NULL;
+	}
+
 	/*
 	 * close down subplans
 	 */
 	ExecEndNode(outerPlanState(node));
 	ExecEndNode(innerPlanState(node));
+	if (node->nl_HashPlanState)
+		ExecEndNode(node->nl_HashPlanState);
 
 	NL1_printf("ExecEndNestLoop: %s\n",
 			   "node processing ended");
@@ -396,6 +635,34 @@ ExecReScanNestLoop(NestLoopState *node)
 	 * outer Vars are used as run-time keys...
 	 */
 
+	/*
+	 * An adaptive nestloop keeps its hash table, and goes on using it, unless
+	 * a parameter of the Hash node changed.  In that case, start over with a
+	 * nested loop; the Hash node will be rescanned if it's needed again.
+	 */
+	if (node->nl_HashPlanState != NULL)
+	{
+		PlanState  *hashPlan = node->nl_HashPlanState;
+
+		if (node->js.ps.chgParam != NULL)
+			UpdateChangedParamSet(hashPlan, node->js.ps.chgParam);
+
+		if (hashPlan->chgParam != NULL)
+		{
+			if (node->nl_HashTable)
+			{
+				ExecHashTableDestroy(node->nl_HashTable);
+				node->nl_HashTable = NULL;
+				((HashState *) hashPlan)->hashtable = NULL;
+			}
+			node->nl_Hashing = false;
+			node->nl_HashTooBig = false;
+		}
+		node->nl_OuterRows = 0;
+		node->nl_CurBucketNo = -1;
+		node->nl_CurTuple = NULL;
+	}
+
 	node->nl_NeedNewOuter = true;
 	node->nl_MatchedOuter = false;
 }
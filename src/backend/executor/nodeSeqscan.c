@@ -20,6 +20,9 @@
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
  *
+ *		ExecSeqScanInitBatch	prepares the node for batch mode
+ *		ExecSeqScanNextBatch	retrieve the next batch of tuples
+ *
  *		ExecSeqScanEstimate		estimates DSM space needed for parallel scan
  *		ExecSeqScanInitializeDSM initialize DSM for parallel scan
  *		ExecSeqScanReInitializeDSM reinitialize DSM for fresh parallel scan
@@ -29,10 +32,13 @@
 
 #include "access/relscan.h"
 #include "access/tableam.h"
+#include "executor/execBatch.h"
 #include "executor/execParallel.h"
 #include "executor/execScan.h"
 #include "executor/executor.h"
+#include "executor/nodeHash.h"
 #include "executor/nodeSeqscan.h"
+#include "miscadmin.h"
 #include "utils/rel.h"
 
 static TupleTableSlot *SeqNext(SeqScanState *node);
@@ -92,6 +98,30 @@ SeqNext(SeqScanState *node)
 	return NULL;
 }
 
+/*
+ * SeqNextWithBloomFilters -- like SeqNext, but skip tuples that can't pass
+ * the hash joins whose Bloom filters have been pushed down to the scan
+ */
+static TupleTableSlot *
+SeqNextWithBloomFilters(SeqScanState *node)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *slot;
+
+	while ((slot = SeqNext(node)) != NULL)
+	{
+		econtext->ecxt_scantuple = slot;
+		if (ExecHashBloomFiltersPass(node->bloomfilters, econtext))
+			return slot;
+
+		InstrCountFiltered2(node, 1);
+		ResetExprContext(econtext);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return NULL;
+}
+
 /*
  * SeqRecheck -- access method routine to recheck a tuple in EvalPlanQual
  */
@@ -197,6 +227,26 @@ ExecSeqScanWithQualProject(PlanState *pstate)
 							pstate->ps_ProjInfo);
 }
 
+/*
+ * Variant of ExecSeqScan() for when Bloom filters are to be applied.  The
+ * filters are only worth it for scans that discard many tuples, so there is
+ * no point in specializing on the presence of qual and projection.
+ */
+static TupleTableSlot *
+ExecSeqScanWithBloomFilters(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+
+	Assert(pstate->state->es_epq_active == NULL);
+
+	return ExecScanExtended(&node->ss,
+							(ExecScanAccessMtd) SeqNextWithBloomFilters,
+							(ExecScanRecheckMtd) SeqRecheck,
+							NULL,
+							pstate->qual,
+							pstate->ps_ProjInfo);
+}
+
 /*
  * Variant of ExecSeqScan for when EPQ evaluation is required.  We don't
  * bother adding variants of this for with/without qual and projection as
@@ -267,14 +317,20 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 */
 	scanstate->ss.ps.qual =
 		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
+	scanstate->bloomfilters =
+		ExecInitHashBloomFilters(node->bloomFilters, (PlanState *) scanstate);
 
 	/*
 	 * When EvalPlanQual() is not in use, assign ExecProcNode for this node
-	 * based on the presence of qual and projection. Each ExecSeqScan*()
-	 * variant is optimized for the specific combination of these conditions.
+	 * based on the presence of Bloom filters, qual and projection. Each
+	 * ExecSeqScan*() variant is optimized for the specific combination of
+	 * these conditions.  EvalPlanQual() rechecks don't apply Bloom filters,
+	 * which is fine since they are only an optimization.
 	 */
 	if (scanstate->ss.ps.state->es_epq_active != NULL)
 		scanstate->ss.ps.ExecProcNode = ExecSeqScanEPQ;
+	else if (scanstate->bloomfilters != NIL)
+		scanstate->ss.ps.ExecProcNode = ExecSeqScanWithBloomFilters;
 	else if (scanstate->ss.ps.qual == NULL)
 	{
 		if (scanstate->ss.ps.ps_ProjInfo == NULL)
@@ -357,6 +413,134 @@ ExecReScanSeqScan(SeqScanState *node)
 	ExecScanReScan((ScanState *) node);
 }
 
+/* ----------------------------------------------------------------
+ *						Batch Mode Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanInitBatch
+ *
+ *		Prepare the scan to return batches of tuples through
+ *		ExecSeqScanNextBatch(), with the attributes in attnums deformed
+ *		into the batch.  This is called by the parent node during its
+ *		initialization; once batch mode is chosen, the parent must not
+ *		also pull tuples through ExecProcNode().
+ *
+ *		Returns false, leaving the node unchanged, if the scan's qual
+ *		cannot be evaluated in batch mode or an attribute cannot be held
+ *		in a batch.  The node's projection, if any, is not applied in
+ *		batch mode; the caller must map its own references through the
+ *		scan's targetlist.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecSeqScanInitBatch(SeqScanState *node, Bitmapset *attnums)
+{
+	Scan	   *plan = (Scan *) node->ss.ps.plan;
+	TupleDesc	tupdesc = RelationGetDescr(node->ss.ss_currentRelation);
+	ExecBatchQual *batchqual = NULL;
+	int			attnum;
+
+	Assert(node->batch == NULL);
+
+	if (node->ss.ps.state->es_epq_active != NULL)
+		return false;
+
+	if (node->bloomfilters != NIL)
+		return false;
+
+	if (plan->plan.qual != NIL)
+	{
+		batchqual = ExecInitBatchQual(plan->plan.qual, plan->scanrelid,
+									  &attnums);
+		if (batchqual == NULL)
+			return false;
+	}
+
+	/*
+	 * Only pass-by-value columns can be kept in a batch, as the values of
+	 * pass-by-reference columns would point into buffers that may be
+	 * released before the batch is consumed.
+	 */
+	attnum = -1;
+	while ((attnum = bms_next_member(attnums, attnum)) >= 0)
+	{
+		Form_pg_attribute attr;
+
+		if (attnum <= 0 || attnum > tupdesc->natts)
+			return false;
+		attr = TupleDescAttr(tupdesc, attnum - 1);
+		if (attr->attisdropped || !attr->attbyval)
+			return false;
+	}
+
+	node->batch = ExecBatchCreate(attnums);
+	node->batchqual = batchqual;
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanNextBatch
+ *
+ *		Fetch up to EXEC_BATCH_SIZE tuples from the relation, deform
+ *		them into the node's batch and evaluate the qual over them.
+ *		The rows that passed the qual are listed in the batch's
+ *		selection vector, which may be empty.  Returns NULL at the
+ *		end of the scan.
+ * ----------------------------------------------------------------
+ */
+ExecBatch *
+ExecSeqScanNextBatch(SeqScanState *node)
+{
+	ExecBatch  *batch = node->batch;
+	int			nrows = 0;
+
+	Assert(batch != NULL);
+
+	/* we're bypassing ExecProcNode(), so provide our own instrumentation */
+	if (node->ss.ps.instrument)
+		InstrStartNode(node->ss.ps.instrument);
+
+	while (nrows < EXEC_BATCH_SIZE)
+	{
+		TupleTableSlot *slot;
+
+		CHECK_FOR_INTERRUPTS();
+
+		slot = SeqNext(node);
+		if (slot == NULL)
+			break;
+
+		if (batch->maxattnum > 0)
+			slot_getsomeattrs(slot, batch->maxattnum);
+
+		for (int col = 0; col < batch->ncols; col++)
+		{
+			AttrNumber	attnum = batch->attnums[col];
+
+			batch->values[col][nrows] = slot->tts_values[attnum - 1];
+			batch->isnull[col][nrows] = slot->tts_isnull[attnum - 1];
+		}
+		nrows++;
+	}
+
+	batch->nrows = nrows;
+	ExecBatchSelectAll(batch);
+
+	if (node->batchqual != NULL && nrows > 0)
+	{
+		ExecBatchQualFilter(node->batchqual, batch);
+		InstrCountFiltered1(node, nrows - batch->nselected);
+	}
+
+	if (node->ss.ps.instrument)
+		InstrStopNode(node->ss.ps.instrument, batch->nselected);
+
+	return nrows > 0 ? batch : NULL;
+}
+
 /* ----------------------------------------------------------------
  *						Parallel Scan Support
  * ----------------------------------------------------------------
@@ -19,7 +19,277 @@
 #include "executor/execdebug.h"
 #include "executor/nodeSort.h"
 #include "miscadmin.h"
+#include "optimizer/optimizer.h"
+#include "port/atomics.h"
+#include "storage/barrier.h"
 #include "utils/tuplesort.h"
+#include "utils/wait_event.h"
+
+/*
+ * The TOC key for the shared state of a Parallel Sort.  The plan node ID
+ * itself is already used for the shared instrumentation.
+ */
+#define PARALLEL_KEY_SORT_OFFSET UINT64CONST(0xB000000000000000)
+
+/* Phases of ParallelSortState.barrier */
+#define PS_PHASE_SORT			0
+#define PS_PHASE_MERGE			1
+
+/*
+ * When the merge is divided into key ranges, the participants claim the
+ * ranges in increasing order, so that each of them still returns its tuples
+ * in order.  For each range, they record who merged it and, once all its
+ * tuples have been returned, how many there were.  That lets Gather Merge
+ * concatenate the ranges instead of merging the participants' output.
+ */
+typedef struct ParallelSortRange
+{
+	pg_atomic_uint32 owner;		/* participant number + 1, or 0 */
+	pg_atomic_uint64 ntuples;	/* number of tuples, or PG_UINT64_MAX */
+} ParallelSortRange;
+
+/*
+ * Shared state of a Parallel Sort, followed by the Sharedsort of the
+ * tuplesort that the participants write their sorted runs to.
+ */
+typedef struct ParallelSortState
+{
+	Barrier		barrier;		/* synchronizes the end of run building */
+	bool		leader_merges;	/* does the leader merge the runs? */
+	pg_atomic_uint32 nruns;		/* number of runs written */
+	int			nranges;		/* number of key ranges, or 0 */
+	pg_atomic_uint32 next_range;	/* next key range to claim */
+	ParallelSortRange ranges[FLEXIBLE_ARRAY_MEMBER];
+} ParallelSortState;
+
+#define ParallelSortStateSize(nranges) \
+	MAXALIGN(offsetof(ParallelSortState, ranges) + \
+			 sizeof(ParallelSortRange) * (nranges))
+
+#define ParallelSortShared(pstate) \
+	((Sharedsort *) ((char *) (pstate) + \
+					 ParallelSortStateSize((pstate)->nranges)))
+
+
+/*
+ * Begin a tuplesort suitable for the input of the sort node.
+ */
+static Tuplesortstate *
+sort_begin(SortState *node, SortCoordinate coordinate, int tuplesortopts)
+{
+	Sort	   *plannode = (Sort *) node->ss.ps.plan;
+	TupleDesc	tupDesc = ExecGetResultType(outerPlanState(node));
+
+	if (node->datumSort)
+		return tuplesort_begin_datum(TupleDescAttr(tupDesc, 0)->atttypid,
+									 plannode->sortOperators[0],
+									 plannode->collations[0],
+									 plannode->nullsFirst[0],
+									 work_mem,
+									 coordinate,
+									 tuplesortopts);
+	else
+		return tuplesort_begin_heap(tupDesc,
+									plannode->numCols,
+									plannode->sortColIdx,
+									plannode->sortOperators,
+									plannode->collations,
+									plannode->nullsFirst,
+									work_mem,
+									coordinate,
+									tuplesortopts);
+}
+
+/*
+ * Scan the subplan and feed all the tuples to tuplesort using the
+ * appropriate method based on the type of sort we're doing.
+ */
+static void
+sort_load(SortState *node, Tuplesortstate *tuplesortstate)
+{
+	PlanState  *outerNode = outerPlanState(node);
+	TupleTableSlot *slot;
+
+	if (node->datumSort)
+	{
+		for (;;)
+		{
+			slot = ExecProcNode(outerNode);
+
+			if (TupIsNull(slot))
+				break;
+			slot_getsomeattrs(slot, 1);
+			tuplesort_putdatum(tuplesortstate,
+							   slot->tts_values[0],
+							   slot->tts_isnull[0]);
+		}
+	}
+	else
+	{
+		for (;;)
+		{
+			slot = ExecProcNode(outerNode);
+
+			if (TupIsNull(slot))
+				break;
+			tuplesort_puttupleslot(tuplesortstate, slot);
+		}
+	}
+}
+
+/*
+ * Size of the shared state of a Parallel Sort.
+ */
+static Size
+parallel_sort_size(SortState *node, int nparticipants)
+{
+	int			nranges = ((Sort *) node->ss.ps.plan)->numRanges;
+
+	if (nranges > 0)
+		return add_size(ParallelSortStateSize(nranges),
+						tuplesort_estimate_shared_ranged(nparticipants));
+	else
+		return add_size(ParallelSortStateSize(0),
+						tuplesort_estimate_shared(nparticipants));
+}
+
+/*
+ * Claim the next key range of a Parallel Sort whose merge is divided into
+ * ranges, and position the tuplesort at its first tuple.  Before that,
+ * publish the number of tuples returned from the previous range.  Returns
+ * false if there are no more ranges.
+ */
+static bool
+sort_next_range(SortState *node, Tuplesortstate *tuplesortstate)
+{
+	ParallelSortState *pstate = node->parallel_state;
+	int			participant = IsParallelWorker() ? ParallelWorkerNumber + 1 : 0;
+	uint32		range;
+
+	if (node->range >= 0)
+		pg_atomic_write_membarrier_u64(&pstate->ranges[node->range].ntuples,
+									   node->range_tuples);
+
+	range = pg_atomic_fetch_add_u32(&pstate->next_range, 1);
+	if (range >= pstate->nranges)
+	{
+		node->range = -1;
+		return false;
+	}
+	pg_atomic_write_membarrier_u32(&pstate->ranges[range].owner,
+								   participant + 1);
+
+	tuplesort_merge_range(tuplesortstate, range, pstate->nranges);
+	node->range = range;
+	node->range_tuples = 0;
+
+	return true;
+}
+
+/*
+ * Sort the input of a Parallel Sort.
+ *
+ * Each participant sorts the tuples it reads from the outer plan into a run
+ * of the shared tuplesort.  Once all of them have done so, the runs are
+ * merged.  If the merge is divided into key ranges, all participants take
+ * part in it.  Otherwise a single participant merges the runs: the leader if
+ * it takes part in the query, otherwise the last participant to finish its
+ * run.  Returns the merging tuplesort, or NULL in participants that return
+ * no tuples.
+ *
+ * A participant that arrives after the runs have been built doesn't read the
+ * outer plan at all, since the others have exhausted it.
+ */
+static Tuplesortstate *
+sort_parallel(SortState *node)
+{
+	ParallelSortState *pstate = node->parallel_state;
+	SortCoordinateData coordinate;
+	Tuplesortstate *tuplesortstate;
+	bool		merge;
+
+	coordinate.sharedsort = ParallelSortShared(pstate);
+
+	if (BarrierAttach(&pstate->barrier) == PS_PHASE_SORT)
+	{
+		coordinate.isWorker = true;
+		coordinate.nParticipants = -1;
+		tuplesortstate = sort_begin(node, &coordinate, TUPLESORT_NONE);
+		sort_load(node, tuplesortstate);
+		tuplesort_performsort(tuplesortstate);
+
+		/* report the statistics of building this participant's run */
+		if (node->shared_info && node->am_worker)
+		{
+			TuplesortInstrumentation *si;
+
+			Assert(ParallelWorkerNumber < node->shared_info->num_workers);
+			si = &node->shared_info->sinstrument[ParallelWorkerNumber];
+			tuplesort_get_stats(tuplesortstate, si);
+		}
+		else if (node->ss.ps.instrument)
+		{
+			if (!node->sinstrument)
+				node->sinstrument = palloc0_object(TuplesortInstrumentation);
+			tuplesort_get_stats(tuplesortstate, node->sinstrument);
+		}
+
+		tuplesort_end(tuplesortstate);
+		pg_atomic_fetch_add_u32(&pstate->nruns, 1);
+
+		if (pstate->nranges > 0)
+		{
+			BarrierArriveAndWait(&pstate->barrier, WAIT_EVENT_PARALLEL_SORT);
+			merge = true;
+		}
+		else if (!pstate->leader_merges)
+			merge = BarrierArriveAndDetachExceptLast(&pstate->barrier);
+		else if (IsParallelWorker())
+		{
+			BarrierArriveAndDetach(&pstate->barrier);
+			merge = false;
+		}
+		else
+		{
+			BarrierArriveAndWait(&pstate->barrier, WAIT_EVENT_PARALLEL_SORT);
+			merge = true;
+		}
+	}
+	else
+	{
+		merge = pstate->nranges > 0 ||
+			(pstate->leader_merges && !IsParallelWorker());
+		if (!merge)
+			BarrierDetach(&pstate->barrier);
+	}
+
+	if (!merge)
+		return NULL;
+
+	/* Every run has been written by now, so take them over and merge */
+	coordinate.isWorker = false;
+	coordinate.nParticipants = pg_atomic_read_u32(&pstate->nruns);
+	tuplesortstate = sort_begin(node, &coordinate, TUPLESORT_NONE);
+
+	if (pstate->nranges > 0)
+	{
+		BarrierDetach(&pstate->barrier);
+
+		node->range = -1;
+		if (!sort_next_range(node, tuplesortstate))
+		{
+			tuplesort_end(tuplesortstate);
+			return NULL;
+		}
+	}
+	else
+	{
+		tuplesort_performsort(tuplesortstate);
+		BarrierDetach(&pstate->barrier);
+	}
+
+	return tuplesortstate;
+}
 
 
 /* ----------------------------------------------------------------
@@ -74,11 +344,6 @@ ExecSort(PlanState *pstate)
 
 	if (!node->sort_Done)
 	{
-		Sort	   *plannode = (Sort *) node->ss.ps.plan;
-		PlanState  *outerNode;
-		TupleDesc	tupDesc;
-		int			tuplesortopts = TUPLESORT_NONE;
-
 		SO1_printf("ExecSort: %s\n",
 				   "sorting subplan");
 
@@ -88,77 +353,53 @@ ExecSort(PlanState *pstate)
 		 */
 		estate->es_direction = ForwardScanDirection;
 
-		/*
-		 * Initialize tuplesort module.
-		 */
-		SO1_printf("ExecSort: %s\n",
-				   "calling tuplesort_begin");
-
-		outerNode = outerPlanState(node);
-		tupDesc = ExecGetResultType(outerNode);
-
-		if (node->randomAccess)
-			tuplesortopts |= TUPLESORT_RANDOMACCESS;
-		if (node->bounded)
-			tuplesortopts |= TUPLESORT_ALLOWBOUNDED;
-
-		if (node->datumSort)
-			tuplesortstate = tuplesort_begin_datum(TupleDescAttr(tupDesc, 0)->atttypid,
-												   plannode->sortOperators[0],
-												   plannode->collations[0],
-												   plannode->nullsFirst[0],
-												   work_mem,
-												   NULL,
-												   tuplesortopts);
-		else
-			tuplesortstate = tuplesort_begin_heap(tupDesc,
-												  plannode->numCols,
-												  plannode->sortColIdx,
-												  plannode->sortOperators,
-												  plannode->collations,
-												  plannode->nullsFirst,
-												  work_mem,
-												  NULL,
-												  tuplesortopts);
-		if (node->bounded)
-			tuplesort_set_bound(tuplesortstate, node->bound);
-		node->tuplesortstate = tuplesortstate;
-
-		/*
-		 * Scan the subplan and feed all the tuples to tuplesort using the
-		 * appropriate method based on the type of sort we're doing.
-		 */
-		if (node->datumSort)
+		if (node->parallel_state)
 		{
-			for (;;)
-			{
-				slot = ExecProcNode(outerNode);
-
-				if (TupIsNull(slot))
-					break;
-				slot_getsomeattrs(slot, 1);
-				tuplesort_putdatum(tuplesortstate,
-								   slot->tts_values[0],
-								   slot->tts_isnull[0]);
-			}
+			/*
+			 * A Parallel Sort can't be bounded, and its result is only read
+			 * forward once.
+			 */
+			tuplesortstate = sort_parallel(node);
+			node->tuplesortstate = tuplesortstate;
 		}
 		else
 		{
-			for (;;)
+			int			tuplesortopts = TUPLESORT_NONE;
+
+			/*
+			 * Initialize tuplesort module.
+			 */
+			SO1_printf("ExecSort: %s\n",
+					   "calling tuplesort_begin");
+
+			if (node->randomAccess)
+				tuplesortopts |= TUPLESORT_RANDOMACCESS;
+			if (node->bounded)
+				tuplesortopts |= TUPLESORT_ALLOWBOUNDED;
+
+			tuplesortstate = sort_begin(node, NULL, tuplesortopts);
+			if (node->bounded)
+				tuplesort_set_bound(tuplesortstate, node->bound);
+			node->tuplesortstate = tuplesortstate;
+
+			sort_load(node, tuplesortstate);
+
+			/*
+			 * Complete the sort.
+			 */
+			tuplesort_performsort(tuplesortstate);
+
+			if (node->shared_info && node->am_worker)
 			{
-				slot = ExecProcNode(outerNode);
+				TuplesortInstrumentation *si;
 
-				if (TupIsNull(slot))
-					break;
-				tuplesort_puttupleslot(tuplesortstate, slot);
+				Assert(IsParallelWorker());
+				Assert(ParallelWorkerNumber < node->shared_info->num_workers);
+				si = &node->shared_info->sinstrument[ParallelWorkerNumber];
+				tuplesort_get_stats(tuplesortstate, si);
 			}
 		}
 
-		/*
-		 * Complete the sort.
-		 */
-		tuplesort_performsort(tuplesortstate);
-
 		/*
 		 * restore to user specified direction
 		 */
@@ -170,15 +411,6 @@ ExecSort(PlanState *pstate)
 		node->sort_Done = true;
 		node->bounded_Done = node->bounded;
 		node->bound_Done = node->bound;
-		if (node->shared_info && node->am_worker)
-		{
-			TuplesortInstrumentation *si;
-
-			Assert(IsParallelWorker());
-			Assert(ParallelWorkerNumber < node->shared_info->num_workers);
-			si = &node->shared_info->sinstrument[ParallelWorkerNumber];
-			tuplesort_get_stats(tuplesortstate, si);
-		}
 		SO1_printf("ExecSort: %s\n", "sorting done");
 	}
 
@@ -187,25 +419,40 @@ ExecSort(PlanState *pstate)
 
 	slot = node->ss.ps.ps_ResultTupleSlot;
 
-	/*
-	 * Fetch the next sorted item from the appropriate tuplesort function. For
-	 * datum sorts we must manage the slot ourselves and leave it clear when
-	 * tuplesort_getdatum returns false to indicate there are no more datums.
-	 * For tuple sorts, tuplesort_gettupleslot manages the slot for us and
-	 * empties the slot when it runs out of tuples.
-	 */
-	if (node->datumSort)
+	/* Not every participant of a Parallel Sort returns sorted tuples */
+	if (tuplesortstate == NULL)
+		return ExecClearTuple(slot);
+
+	for (;;)
 	{
-		ExecClearTuple(slot);
-		if (tuplesort_getdatum(tuplesortstate, ScanDirectionIsForward(dir),
-							   false, &(slot->tts_values[0]),
-							   &(slot->tts_isnull[0]), NULL))
-			ExecStoreVirtualTuple(slot);
+		/*
+		 * Fetch the next sorted item from the appropriate tuplesort function.
+		 * For datum sorts we must manage the slot ourselves and leave it
+		 * clear when tuplesort_getdatum returns false to indicate there are
+		 * no more datums.  For tuple sorts, tuplesort_gettupleslot manages
+		 * the slot for us and empties the slot when it runs out of tuples.
+		 */
+		if (node->datumSort)
+		{
+			ExecClearTuple(slot);
+			if (tuplesort_getdatum(tuplesortstate, ScanDirectionIsForward(dir),
+								   false, &(slot->tts_values[0]),
+								   &(slot->tts_isnull[0]), NULL))
+				ExecStoreVirtualTuple(slot);
+		}
+		else
+			(void) tuplesort_gettupleslot(tuplesortstate,
+										  ScanDirectionIsForward(dir),
+										  false, slot, NULL);
+
+		/* At the end of a key range, go on with the next one, if any */
+		if (!TupIsNull(slot) || node->range < 0 ||
+			!sort_next_range(node, tuplesortstate))
+			break;
 	}
-	else
-		(void) tuplesort_gettupleslot(tuplesortstate,
-									  ScanDirectionIsForward(dir),
-									  false, slot, NULL);
+
+	if (node->range >= 0 && !TupIsNull(slot))
+		node->range_tuples++;
 
 	return slot;
 }
@@ -246,6 +493,7 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	sortstate->bounded = false;
 	sortstate->sort_Done = false;
 	sortstate->tuplesortstate = NULL;
+	sortstate->range = -1;
 
 	/*
 	 * Miscellaneous initialization
@@ -377,18 +625,23 @@ ExecReScanSort(SortState *node)
 	/*
 	 * If subnode is to be rescanned then we forget previous sort results; we
 	 * have to re-read the subplan and re-sort.  Also must re-sort if the
-	 * bounded-sort parameters changed or we didn't select randomAccess.
+	 * bounded-sort parameters changed or we didn't select randomAccess, and
+	 * always in a Parallel Sort, whose input is divided anew between the
+	 * participants.
 	 *
 	 * Otherwise we can just rewind and rescan the sorted output.
 	 */
 	if (outerPlan->chgParam != NULL ||
 		node->bounded != node->bounded_Done ||
 		node->bound != node->bound_Done ||
-		!node->randomAccess)
+		!node->randomAccess ||
+		node->parallel_state != NULL)
 	{
 		node->sort_Done = false;
-		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		if (node->tuplesortstate != NULL)
+			tuplesort_end((Tuplesortstate *) node->tuplesortstate);
 		node->tuplesortstate = NULL;
+		node->range = -1;
 
 		/*
 		 * if chgParam of subnode is not null then plan will be re-scanned by
@@ -487,3 +740,198 @@ ExecSortRetrieveInstrumentation(SortState *node)
 	memcpy(si, node->shared_info, size);
 	node->shared_info = si;
 }
+
+/* ----------------------------------------------------------------
+ *		ExecSortParallelEstimate
+ *
+ *		Estimate space required for the shared state of a Parallel Sort.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortParallelEstimate(SortState *node, ParallelContext *pcxt)
+{
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   parallel_sort_size(node, pcxt->nworkers + 1));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortParallelInitializeDSM
+ *
+ *		Set up the shared state of a Parallel Sort.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortParallelInitializeDSM(SortState *node, ParallelContext *pcxt)
+{
+	Sort	   *plannode = (Sort *) node->ss.ps.plan;
+	ParallelSortState *pstate;
+	int			nparticipants = pcxt->nworkers + 1;
+	int			i;
+
+	/*
+	 * Without a DSM segment there are no workers either, and the leader can
+	 * just sort its input the ordinary way.
+	 */
+	if (pcxt->seg == NULL)
+		return;
+
+	pstate = shm_toc_allocate(pcxt->toc,
+							  parallel_sort_size(node, nparticipants));
+	BarrierInit(&pstate->barrier, 0);
+	pstate->leader_merges = parallel_leader_participation;
+	pg_atomic_init_u32(&pstate->nruns, 0);
+	pstate->nranges = plannode->numRanges;
+	pg_atomic_init_u32(&pstate->next_range, 0);
+	for (i = 0; i < pstate->nranges; i++)
+	{
+		pg_atomic_init_u32(&pstate->ranges[i].owner, 0);
+		pg_atomic_init_u64(&pstate->ranges[i].ntuples, PG_UINT64_MAX);
+	}
+	if (pstate->nranges > 0)
+		tuplesort_initialize_shared_ranged(ParallelSortShared(pstate),
+										   nparticipants, pcxt->seg);
+	else
+		tuplesort_initialize_shared(ParallelSortShared(pstate),
+									nparticipants, pcxt->seg);
+	shm_toc_insert(pcxt->toc,
+				   node->ss.ps.plan->plan_node_id + PARALLEL_KEY_SORT_OFFSET,
+				   pstate);
+
+	node->parallel_state = pstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortParallelReInitializeDSM
+ *
+ *		Reset the shared state of a Parallel Sort before beginning a
+ *		fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortParallelReInitializeDSM(SortState *node, ParallelContext *pcxt)
+{
+	ParallelSortState *pstate = node->parallel_state;
+	int			i;
+
+	/* Nothing to do if we failed to create a DSM segment. */
+	if (pstate == NULL)
+		return;
+
+	/* The leader's merge reads the runs we're about to throw away */
+	if (node->tuplesortstate != NULL)
+	{
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		node->tuplesortstate = NULL;
+	}
+
+	tuplesort_reinitialize_shared(ParallelSortShared(pstate));
+	BarrierInit(&pstate->barrier, 0);
+	pg_atomic_write_u32(&pstate->nruns, 0);
+	pg_atomic_write_u32(&pstate->next_range, 0);
+	for (i = 0; i < pstate->nranges; i++)
+	{
+		pg_atomic_write_u32(&pstate->ranges[i].owner, 0);
+		pg_atomic_write_u64(&pstate->ranges[i].ntuples, PG_UINT64_MAX);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortParallelInitializeWorker
+ *
+ *		Attach worker to the shared state of a Parallel Sort.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortParallelInitializeWorker(SortState *node, ParallelWorkerContext *pwcxt)
+{
+	ParallelSortState *pstate;
+
+	pstate = shm_toc_lookup(pwcxt->toc,
+							node->ss.ps.plan->plan_node_id +
+							PARALLEL_KEY_SORT_OFFSET,
+							false);
+	tuplesort_attach_shared(ParallelSortShared(pstate), pwcxt->seg);
+
+	node->parallel_state = pstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecShutdownSort
+ *
+ *		The tuplesort merging the runs of a Parallel Sort reads files that
+ *		go away with the DSM segment, so it must be ended here rather than
+ *		in ExecEndSort().  Save its statistics for EXPLAIN first.
+ * ----------------------------------------------------------------
+ */
+void
+ExecShutdownSort(SortState *node)
+{
+	if (node->parallel_state == NULL || node->tuplesortstate == NULL)
+		return;
+
+	if (node->ss.ps.instrument)
+	{
+		if (!node->sinstrument)
+			node->sinstrument = palloc0_object(TuplesortInstrumentation);
+		tuplesort_get_stats((Tuplesortstate *) node->tuplesortstate,
+							node->sinstrument);
+	}
+
+	tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortNumRanges
+ *
+ *		Return the number of key ranges that the merge of a Parallel Sort
+ *		is divided into, or 0 if it isn't.
+ * ----------------------------------------------------------------
+ */
+int
+ExecSortNumRanges(SortState *node)
+{
+	if (node->parallel_state == NULL)
+		return 0;
+	return node->parallel_state->nranges;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortRangeOwner
+ *
+ *		Return the participant of a Parallel Sort merging a key range: 0
+ *		for the leader, or ParallelWorkerNumber + 1 for a worker.  Returns
+ *		-1 if the range hasn't been claimed yet.
+ * ----------------------------------------------------------------
+ */
+int
+ExecSortRangeOwner(SortState *node, int range)
+{
+	ParallelSortState *pstate = node->parallel_state;
+
+	Assert(range >= 0 && range < pstate->nranges);
+
+	return (int) pg_atomic_read_membarrier_u32(&pstate->ranges[range].owner) - 1;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortRangeTuples
+ *
+ *		Return the number of tuples in a key range of a Parallel Sort, or
+ *		-1 if its owner hasn't returned all of them yet.  Since the owner
+ *		records the number before returning any tuple of a later range,
+ *		the tuples that follow that many are not part of the range.
+ * ----------------------------------------------------------------
+ */
+int64
+ExecSortRangeTuples(SortState *node, int range)
+{
+	ParallelSortState *pstate = node->parallel_state;
+	uint64		ntuples;
+
+	Assert(range >= 0 && range < pstate->nranges);
+
+	ntuples = pg_atomic_read_membarrier_u64(&pstate->ranges[range].ntuples);
+	return ntuples == PG_UINT64_MAX ? -1 : (int64) ntuples;
+}
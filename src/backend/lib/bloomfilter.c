@@ -192,6 +192,18 @@ bloom_prop_bits_set(bloom_filter *filter)
 	return bits_set / (double) filter->m;
 }
 
+/*
+ * Total size of the Bloom filter in bytes
+ *
+ * The filter is a single contiguous chunk of memory without any pointers, so
+ * callers can copy this many bytes to pass the filter to other processes.
+ */
+size_t
+bloom_total_size(bloom_filter *filter)
+{
+	return offsetof(bloom_filter, bitset) + filter->m / BITS_PER_BYTE;
+}
+
 /*
  * Which element in the sequence of powers of two is less than or equal to
  * target_bitset_bits?
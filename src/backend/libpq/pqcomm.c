@@ -139,6 +139,7 @@ static bool PqCommReadingMsg;	/* in the middle of reading a message */
 /* Internal functions */
 static void socket_comm_reset(void);
 static void socket_close(int code, Datum arg);
+static void pq_init_wait_set(pgsocket sock);
 static void socket_set_nonblocking(bool nonblocking);
 static int	socket_flush(void);
 static int	socket_flush_if_writable(void);
@@ -175,8 +176,6 @@ Port *
 pq_init(ClientSocket *client_sock)
 {
 	Port	   *port;
-	int			socket_pos PG_USED_FOR_ASSERTS_ONLY;
-	int			latch_pos PG_USED_FOR_ASSERTS_ONLY;
 
 	/* allocate the Port struct and copy the ClientSocket contents to it */
 	port = palloc0_object(Port);
@@ -305,9 +304,23 @@ pq_init(ClientSocket *client_sock)
 		elog(FATAL, "fcntl(F_SETFD) failed on socket: %m");
 #endif
 
+	pq_init_wait_set(port->sock);
+
+	return port;
+}
+
+/*
+ * Set up FeBeWaitSet for waiting on the given client socket.
+ */
+static void
+pq_init_wait_set(pgsocket sock)
+{
+	int			socket_pos PG_USED_FOR_ASSERTS_ONLY;
+	int			latch_pos PG_USED_FOR_ASSERTS_ONLY;
+
 	FeBeWaitSet = CreateWaitEventSet(NULL, FeBeWaitSetNEvents);
 	socket_pos = AddWaitEventToSet(FeBeWaitSet, WL_SOCKET_WRITEABLE,
-								   port->sock, NULL, NULL);
+								   sock, NULL, NULL);
 	latch_pos = AddWaitEventToSet(FeBeWaitSet, WL_LATCH_SET, PGINVALID_SOCKET,
 								  MyLatch, NULL);
 	AddWaitEventToSet(FeBeWaitSet, WL_POSTMASTER_DEATH, PGINVALID_SOCKET,
@@ -319,8 +332,30 @@ pq_init(ClientSocket *client_sock)
 	 */
 	Assert(socket_pos == FeBeWaitSetSocketPos);
 	Assert(latch_pos == FeBeWaitSetLatchPos);
+}
 
-	return port;
+/* --------------------------------
+ *		pq_switch_port - start talking to a different client
+ *
+ * Used by session pooling, to make the given Port the one that all further
+ * communication goes through.  Any unsent output or unread input of the
+ * previous client is discarded, so the caller should flush first unless that
+ * client has gone away.  The new client's socket must already be in
+ * nonblocking mode.
+ * --------------------------------
+ */
+void
+pq_switch_port(Port *port)
+{
+	Assert(!PqCommBusy && !PqCommReadingMsg);
+
+	PqSendPointer = PqSendStart = PqRecvPointer = PqRecvLength = 0;
+	ClientConnectionLost = 0;
+
+	FreeWaitEventSet(FeBeWaitSet);
+	pq_init_wait_set(port->sock);
+
+	MyProcPort = port;
 }
 
 /* --------------------------------
@@ -4931,6 +4931,11 @@ planstate_tree_walker_impl(PlanState *planstate,
 			if (PSWALK(((SubqueryScanState *) planstate)->subplan))
 				return true;
 			break;
+		case T_NestLoop:
+			if (((NestLoopState *) planstate)->nl_HashPlanState &&
+				PSWALK(((NestLoopState *) planstate)->nl_HashPlanState))
+				return true;
+			break;
 		case T_CustomScan:
 			foreach(lc, ((CustomScanState *) planstate)->custom_ps)
 			{
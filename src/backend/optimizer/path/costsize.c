@@ -156,14 +156,19 @@ bool		enable_material = true;
 bool		enable_memoize = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
+bool		enable_hashjoin_bloom_filter = false;
 bool		enable_gathermerge = true;
 bool		enable_partitionwise_join = false;
 bool		enable_partitionwise_aggregate = false;
+bool		enable_partitionwise_window = false;
 bool		enable_parallel_append = true;
 bool		enable_parallel_hash = true;
+bool		enable_parallel_hashagg = false;
+bool		enable_parallel_sort = false;
 bool		enable_partition_pruning = true;
 bool		enable_presorted_aggregate = true;
 bool		enable_async_append = true;
+bool		enable_adaptive_join = false;
 
 typedef struct
 {
@@ -499,23 +504,39 @@ cost_gather_merge(GatherMergePath *path, PlannerInfo *root,
 	/* Assumed cost per tuple comparison */
 	comparison_cost = 2.0 * cpu_operator_cost;
 
-	/* Heap creation cost */
-	startup_cost += comparison_cost * N * logN;
+	/*
+	 * Below a Parallel Sort, there is nothing left to merge.  Either just one
+	 * participant returns any tuples, and if that's the leader they don't go
+	 * through a tuple queue either, or the participants return key ranges
+	 * that are just concatenated, like Gather does.
+	 */
+	if (path->subpath->parallel_aware && IsA(path->subpath, SortPath))
+	{
+		startup_cost += parallel_setup_cost;
+		if (!parallel_leader_participation ||
+			((SortPath *) path->subpath)->numRanges > 0)
+			run_cost += parallel_tuple_cost * path->path.rows;
+	}
+	else
+	{
+		/* Heap creation cost */
+		startup_cost += comparison_cost * N * logN;
 
-	/* Per-tuple heap maintenance cost */
-	run_cost += path->path.rows * comparison_cost * logN;
+		/* Per-tuple heap maintenance cost */
+		run_cost += path->path.rows * comparison_cost * logN;
 
-	/* small cost for heap management, like cost_merge_append */
-	run_cost += cpu_operator_cost * path->path.rows;
+		/* small cost for heap management, like cost_merge_append */
+		run_cost += cpu_operator_cost * path->path.rows;
 
-	/*
-	 * Parallel setup and communication cost.  Since Gather Merge, unlike
-	 * Gather, requires us to block until a tuple is available from every
-	 * worker, we bump the IPC cost up a little bit as compared with Gather.
-	 * For lack of a better idea, charge an extra 5%.
-	 */
-	startup_cost += parallel_setup_cost;
-	run_cost += parallel_tuple_cost * path->path.rows * 1.05;
+		/*
+		 * Parallel setup and communication cost.  Since Gather Merge, unlike
+		 * Gather, requires us to block until a tuple is available from every
+		 * worker, we bump the IPC cost up a little bit as compared with
+		 * Gather.  For lack of a better idea, charge an extra 5%.
+		 */
+		startup_cost += parallel_setup_cost;
+		run_cost += parallel_tuple_cost * path->path.rows * 1.05;
+	}
 
 	path->path.disabled_nodes = path->subpath->disabled_nodes
 		+ ((rel->pgs_mask & PGS_GATHER_MERGE) != 0 ? 0 : 1);
@@ -2213,6 +2234,34 @@ cost_sort(Path *path, PlannerInfo *root,
 				   comparison_cost, sort_mem,
 				   limit_tuples);
 
+	/*
+	 * In a Parallel Sort, each participant sorts only its share of the input,
+	 * but it then has to write its run out to disk, even if it fit in memory,
+	 * and a single participant reads back the runs of all of them and merges
+	 * them.  If the merge is divided into key ranges, each participant merges
+	 * about its share of the tuples instead.
+	 */
+	if (path->parallel_aware)
+	{
+		double		input_bytes = relation_byte_size(tuples, width);
+		double		merge_tuples = tuples;
+		double		nruns = path->parallel_workers +
+			(parallel_leader_participation ? 1 : 0);
+
+		Assert(limit_tuples < 0);
+
+		if (castNode(SortPath, path)->numRanges == 0)
+			merge_tuples *= get_parallel_divisor(path);
+
+		if (input_bytes <= sort_mem * (int64) 1024)
+			startup_cost += ceil(input_bytes / BLCKSZ) * seq_page_cost;
+		run_cost += ceil(relation_byte_size(merge_tuples, width) / BLCKSZ) *
+			seq_page_cost;
+		if (nruns > 1)
+			run_cost += (comparison_cost + 2.0 * cpu_operator_cost) *
+				merge_tuples * LOG2(nruns);
+	}
+
 	startup_cost += input_cost;
 
 	/*
@@ -2805,6 +2854,17 @@ cost_agg(Path *path, PlannerInfo *root,
 		aggcosts = &dummy_aggcosts;
 	}
 
+	/*
+	 * In a Parallel HashAgg, each participant reads only its share of the
+	 * input, but every group is also aggregated by just one participant, so
+	 * each participant produces only its share of the groups.
+	 */
+	if (path->parallel_aware)
+	{
+		Assert(aggstrategy == AGG_HASHED);
+		numGroups = clamp_row_est(numGroups / get_parallel_divisor(path));
+	}
+
 	/*
 	 * The transCost.per_tuple component of aggcosts should be charged once
 	 * per input tuple, corresponding to the costs of evaluating the aggregate
@@ -2923,6 +2983,14 @@ cost_agg(Path *path, PlannerInfo *root,
 		 */
 		depth = ceil(log(nbatches) / log(num_partitions));
 
+		/*
+		 * A Parallel HashAgg first writes all of its input to the shared
+		 * batches and then reads it back, which is like one extra level of
+		 * recursion.
+		 */
+		if (path->parallel_aware)
+			depth++;
+
 		/*
 		 * Estimate number of pages read and written. For each level of
 		 * recursion, a tuple must be written and then later read.
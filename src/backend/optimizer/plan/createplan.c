@@ -19,11 +19,14 @@
 #include "access/sysattr.h"
 #include "access/transam.h"
 #include "catalog/pg_class.h"
+#include "catalog/pg_type.h"
+#include "executor/nodeHash.h"
 #include "foreign/fdwapi.h"
 #include "miscadmin.h"
 #include "nodes/extensible.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/appendinfo.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/optimizer.h"
@@ -71,6 +74,14 @@
 #define CP_LABEL_TLIST		0x0004	/* tlist must contain sortgrouprefs */
 #define CP_IGNORE_TLIST		0x0008	/* caller will replace tlist */
 
+/*
+ * A hash join only pushes a Bloom filter down to its outer side when it
+ * expects at least this many outer rows, no more than this fraction of which
+ * are expected to find a match.
+ */
+#define BLOOM_FILTER_MIN_OUTER_ROWS		1000.0
+#define BLOOM_FILTER_MAX_MATCH_FRACTION	0.5
+
 
 static Plan *create_plan_recurse(PlannerInfo *root, Path *best_path,
 								 int flags);
@@ -158,8 +169,17 @@ static CustomScan *create_customscan_plan(PlannerInfo *root,
 										  CustomPath *best_path,
 										  List *tlist, List *scan_clauses);
 static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path);
+static void make_nestloop_adaptive(PlannerInfo *root, NestPath *best_path,
+								   NestLoop *join_plan);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path);
+static void add_hashjoin_bloom_filter(PlannerInfo *root, HashPath *best_path,
+									  Hash *hash_plan, Plan *outer_plan,
+									  List *outer_hashkeys, List *hashoperators,
+									  List *hashcollations);
+static bool push_down_bloom_filter(PlannerInfo *root, Plan *plan,
+								   Index relid, List *hashkeys, int paramid,
+								   List *hashoperators, List *hashcollations);
 static Node *replace_nestloop_params(PlannerInfo *root, Node *expr);
 static Node *replace_nestloop_params_mutator(Node *node, PlannerInfo *root);
 static void fix_indexqual_references(PlannerInfo *root, IndexPath *index_path,
@@ -2039,6 +2059,7 @@ create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags)
 	plan = make_sort_from_pathkeys(subplan, best_path->path.pathkeys,
 								   IS_OTHER_REL(best_path->subpath->parent) ?
 								   best_path->path.parent->relids : NULL);
+	plan->numRanges = best_path->numRanges;
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
@@ -4332,9 +4353,213 @@ create_nestloop_plan(PlannerInfo *root,
 
 	copy_generic_path_info(&join_plan->join.plan, &best_path->jpath.path);
 
+	if (enable_adaptive_join)
+		make_nestloop_adaptive(root, best_path, join_plan);
+
 	return join_plan;
 }
 
+/*
+ * make_nestloop_adaptive
+ *	  Give a nestloop the means to switch to hashing at runtime.
+ *
+ * If the inner side of the nestloop is a parameterized scan that has to be
+ * redone for every outer row, and some of the join clauses are hashable, we
+ * also make a plan for an unparameterized scan of the inner relation with a
+ * Hash node on top.  The executor switches to probing that hash table if the
+ * outer side returns more rows than the threshold computed here, which
+ * limits the damage when the planner badly underestimated the outer side.
+ * If anything doesn't fit, the nestloop is left as it is.
+ */
+static void
+make_nestloop_adaptive(PlannerInfo *root, NestPath *best_path,
+					   NestLoop *join_plan)
+{
+	JoinPath   *jpath = &best_path->jpath;
+	Path	   *outer_path = jpath->outerjoinpath;
+	Path	   *inner_path = jpath->innerjoinpath;
+	RelOptInfo *inner_rel = inner_path->parent;
+	Relids		outerrelids = outer_path->parent->relids;
+	Relids		innerrelids = inner_rel->relids;
+	Plan	   *outer_plan = join_plan->join.plan.lefttree;
+	Plan	   *inner_plan = join_plan->join.plan.righttree;
+	Path	   *alt_path;
+	Plan	   *alt_plan;
+	Hash	   *hash_plan;
+	List	   *ppi_clauses;
+	List	   *restrictinfos;
+	List	   *hash_joinqual;
+	List	   *hash_outerkeys = NIL;
+	List	   *hash_innerkeys = NIL;
+	List	   *hash_operators = NIL;
+	List	   *hash_collations = NIL;
+	List	   *vars;
+	Cost		build_cost;
+	Cost		rescan_cost;
+	size_t		space_allowed;
+	int			numbuckets;
+	int			numbatches;
+	int			num_skew_mcvs;
+	ListCell   *lc;
+
+	/*
+	 * Only a plain relation parameterized by the outer side alone is worth
+	 * the trouble.  The nestloop itself mustn't be parameterized, else its
+	 * join clauses would contain nestloop Params.  Since the inner relation
+	 * is planned twice, stay away from anything but plain tables, and from
+	 * row-marked queries, to keep EvalPlanQual out of it.
+	 */
+	if (jpath->path.param_info != NULL ||
+		inner_path->param_info == NULL ||
+		!bms_is_subset(PATH_REQ_OUTER(inner_path), outerrelids) ||
+		inner_rel->reloptkind != RELOPT_BASEREL ||
+		inner_rel->rtekind != RTE_RELATION ||
+		!bms_is_empty(inner_rel->lateral_relids) ||
+		root->rowMarks != NIL)
+		return;
+
+	alt_path = inner_rel->cheapest_total_path;
+	if (alt_path == NULL || alt_path->param_info != NULL ||
+		(jpath->path.parallel_safe && !alt_path->parallel_safe))
+		return;
+
+	/*
+	 * Collect the hashable join clauses.  The inner path enforces its
+	 * ppi_clauses itself, so those act as join clauses too, even pushed-down
+	 * ones.  Of the nestloop's own clauses, pushed-down quals of an outer
+	 * join are applied after null-extension and can't be used.
+	 */
+	ppi_clauses = inner_path->param_info->ppi_clauses;
+	restrictinfos = list_concat_copy(ppi_clauses, jpath->joinrestrictinfo);
+	foreach(lc, restrictinfos)
+	{
+		RestrictInfo *rinfo = lfirst_node(RestrictInfo, lc);
+		OpExpr	   *clause = (OpExpr *) rinfo->clause;
+		Expr	   *outerkey;
+		Expr	   *innerkey;
+		Oid			opno;
+
+		if (rinfo->pseudoconstant || !rinfo->can_join ||
+			!OidIsValid(rinfo->hashjoinoperator))
+			continue;
+		if (foreach_current_index(lc) >= list_length(ppi_clauses) &&
+			IS_OUTER_JOIN(jpath->jointype) &&
+			RINFO_IS_PUSHED_DOWN(rinfo, jpath->path.parent->relids))
+			continue;
+
+		if (bms_is_subset(rinfo->left_relids, outerrelids) &&
+			bms_is_subset(rinfo->right_relids, innerrelids))
+		{
+			opno = clause->opno;
+			outerkey = linitial(clause->args);
+			innerkey = lsecond(clause->args);
+		}
+		else if (bms_is_subset(rinfo->left_relids, innerrelids) &&
+				 bms_is_subset(rinfo->right_relids, outerrelids))
+		{
+			opno = get_commutator(clause->opno);
+			if (!OidIsValid(opno))
+				continue;
+			outerkey = lsecond(clause->args);
+			innerkey = linitial(clause->args);
+		}
+		else
+			continue;
+
+		hash_operators = lappend_oid(hash_operators, opno);
+		hash_collations = lappend_oid(hash_collations, clause->inputcollid);
+		hash_outerkeys = lappend(hash_outerkeys, outerkey);
+		hash_innerkeys = lappend(hash_innerkeys, innerkey);
+	}
+	if (hash_operators == NIL)
+		return;
+
+	/*
+	 * Matches from the hash table must be checked against all the join
+	 * clauses, including the ones the inner path would have enforced.
+	 */
+	hash_joinqual =
+		list_concat(list_copy(join_plan->join.joinqual),
+					extract_actual_clauses(order_qual_clauses(root,
+															  ppi_clauses),
+										   false));
+
+	/*
+	 * Everything the hash mode evaluates must be available from the child
+	 * tlists.  That's normally the case, since join clause Vars are needed
+	 * at the join, but there's no need to rely on it.
+	 */
+	vars = pull_var_clause((Node *) list_make3(hash_outerkeys,
+											   hash_innerkeys,
+											   hash_joinqual),
+						   PVC_INCLUDE_PLACEHOLDERS);
+	foreach(lc, vars)
+	{
+		Node	   *node = (Node *) lfirst(lc);
+		Relids		varnos = pull_varnos(root, node);
+
+		if (bms_is_subset(varnos, innerrelids))
+		{
+			if (!tlist_member((Expr *) node, inner_plan->targetlist))
+				return;
+		}
+		else if (bms_is_subset(varnos, outerrelids))
+		{
+			if (!tlist_member((Expr *) node, outer_plan->targetlist))
+				return;
+		}
+		else
+			return;
+	}
+
+	/*
+	 * We don't want to batch the outer side, so give up unless the inner
+	 * relation is expected to fit in a single batch.
+	 */
+	ExecChooseHashTableSize(alt_path->rows, inner_plan->plan_width,
+							false, false, 0,
+							&space_allowed, &numbuckets, &numbatches,
+							&num_skew_mcvs);
+	if (numbatches > 1)
+		return;
+
+	/*
+	 * Switch once the rescans done so far have cost about as much as building
+	 * the hash table, but not before the outer side has returned more rows
+	 * than estimated; up to that point the planner's choice stands.
+	 */
+	build_cost = alt_path->total_cost +
+		(cpu_operator_cost * list_length(hash_operators) + cpu_tuple_cost) *
+		alt_path->rows;
+	rescan_cost = Max(inner_path->total_cost, cpu_tuple_cost);
+	join_plan->adaptive_rows = clamp_row_est(Max(outer_path->rows,
+												 build_cost / rescan_cost));
+
+	/*
+	 * Make the plan for the inner relation, and have it produce the same
+	 * tlist as the inner subplan, so that the join's expressions work with
+	 * either of them.
+	 */
+	alt_plan = create_plan_recurse(root, alt_path, CP_EXACT_TLIST);
+	alt_plan = change_plan_targetlist(alt_plan,
+									  copyObject(inner_plan->targetlist),
+									  inner_plan->parallel_safe);
+
+	hash_plan = make_hash(alt_plan,
+						  hash_innerkeys,
+						  InvalidOid,
+						  InvalidAttrNumber,
+						  false);
+	copy_plan_costsize(&hash_plan->plan, alt_plan);
+	hash_plan->plan.startup_cost = hash_plan->plan.total_cost;
+
+	join_plan->hash_plan = (Plan *) hash_plan;
+	join_plan->hash_outerkeys = hash_outerkeys;
+	join_plan->hash_operators = hash_operators;
+	join_plan->hash_collations = hash_collations;
+	join_plan->hash_joinqual = hash_joinqual;
+}
+
 static MergeJoin *
 create_mergejoin_plan(PlannerInfo *root,
 					  MergePath *best_path)
@@ -4689,6 +4914,149 @@ create_mergejoin_plan(PlannerInfo *root,
 	return join_plan;
 }
 
+/*
+ * add_hashjoin_bloom_filter
+ *	  Arrange for the Hash node to build a Bloom filter of its hash keys, and
+ *	  for the sequential scans on the outer side of the join to use it to
+ *	  discard rows that cannot have a join partner.
+ *
+ * This only pays off when most outer rows fail to join, so that the cost of
+ * probing the filter is repaid by not having to pass the rows up to the join
+ * and probe the hash table with them.  We don't try to push the filter past
+ * anything but Gather and Append nodes, nor into other kinds of scans.
+ */
+static void
+add_hashjoin_bloom_filter(PlannerInfo *root, HashPath *best_path,
+						  Hash *hash_plan, Plan *outer_plan,
+						  List *outer_hashkeys, List *hashoperators,
+						  List *hashcollations)
+{
+	Path	   *outer_path = best_path->jpath.outerjoinpath;
+	Relids		relids;
+	int			relid;
+	Param	   *param;
+
+	/*
+	 * Outer rows without a match must not be needed by the join.  For the
+	 * join types allowed here, the join's row estimate is an upper bound on
+	 * the number of outer rows that will find a match.
+	 */
+	if (best_path->jpath.jointype != JOIN_INNER &&
+		best_path->jpath.jointype != JOIN_SEMI &&
+		best_path->jpath.jointype != JOIN_RIGHT)
+		return;
+
+	/* A shared hash table would need a shared filter; not supported */
+	if (hash_plan->plan.parallel_aware)
+		return;
+
+	if (outer_path->rows < BLOOM_FILTER_MIN_OUTER_ROWS ||
+		best_path->jpath.path.rows >
+		outer_path->rows * BLOOM_FILTER_MAX_MATCH_FRACTION)
+		return;
+
+	/*
+	 * The outer hash keys must be computable from a single base relation
+	 * without the help of PlaceHolderVars or volatile functions.
+	 */
+	relids = pull_varnos(root, (Node *) outer_hashkeys);
+	if (!bms_get_singleton_member(relids, &relid))
+		return;
+	if (contain_volatile_functions((Node *) outer_hashkeys))
+		return;
+	foreach_ptr(Node, var, pull_var_clause((Node *) outer_hashkeys,
+										   PVC_INCLUDE_PLACEHOLDERS))
+	{
+		if (!IsA(var, Var))
+			return;
+	}
+
+	param = generate_new_exec_param(root, BYTEAOID, -1, InvalidOid);
+	if (push_down_bloom_filter(root, outer_plan, relid, outer_hashkeys,
+							   param->paramid, hashoperators, hashcollations))
+		hash_plan->bloomParam = param->paramid;
+}
+
+/*
+ * push_down_bloom_filter
+ *	  Attach a HashBloomFilter to the sequential scans of relation relid, or
+ *	  of its appendrel children, found in plan.
+ *
+ * Returns true if any scan will use the filter.  Gather nodes that lead to
+ * such a scan get the filter's param added to their initParam, so that it is
+ * passed on to the workers.
+ */
+static bool
+push_down_bloom_filter(PlannerInfo *root, Plan *plan, Index relid,
+					   List *hashkeys, int paramid, List *hashoperators,
+					   List *hashcollations)
+{
+	bool		result = false;
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+			{
+				SeqScan    *scan = (SeqScan *) plan;
+				Index		scanrelid = scan->scan.scanrelid;
+				HashBloomFilter *filter;
+
+				if (scanrelid != relid)
+				{
+					Index		parent_relid = scanrelid;
+
+					/* Is it a scan of a child of relid? */
+					while (root->append_rel_array &&
+						   root->append_rel_array[parent_relid] &&
+						   parent_relid != relid)
+						parent_relid =
+							root->append_rel_array[parent_relid]->parent_relid;
+					if (parent_relid != relid)
+						break;
+
+					hashkeys = (List *)
+						adjust_appendrel_attrs_multilevel(root,
+														  (Node *) hashkeys,
+														  find_base_rel(root, scanrelid),
+														  find_base_rel(root, relid));
+				}
+
+				filter = makeNode(HashBloomFilter);
+				filter->paramid = paramid;
+				filter->hashkeys = copyObject(hashkeys);
+				filter->hashoperators = hashoperators;
+				filter->hashcollations = hashcollations;
+				scan->bloomFilters = lappend(scan->bloomFilters, filter);
+				result = true;
+			}
+			break;
+		case T_Append:
+			foreach_ptr(Plan, subplan, ((Append *) plan)->appendplans)
+			{
+				if (push_down_bloom_filter(root, subplan, relid, hashkeys,
+										   paramid, hashoperators,
+										   hashcollations))
+					result = true;
+			}
+			break;
+		case T_Gather:
+			if (push_down_bloom_filter(root, plan->lefttree, relid, hashkeys,
+									   paramid, hashoperators,
+									   hashcollations))
+			{
+				Gather	   *gather = (Gather *) plan;
+
+				gather->initParam = bms_add_member(gather->initParam, paramid);
+				result = true;
+			}
+			break;
+		default:
+			break;
+	}
+
+	return result;
+}
+
 static HashJoin *
 create_hashjoin_plan(PlannerInfo *root,
 					 HashPath *best_path)
@@ -4845,6 +5213,11 @@ create_hashjoin_plan(PlannerInfo *root,
 		hash_plan->rows_total = best_path->inner_rows_total;
 	}
 
+	if (enable_hashjoin_bloom_filter)
+		add_hashjoin_bloom_filter(root, best_path, hash_plan, outer_plan,
+								  outer_hashkeys, hashoperators,
+								  hashcollations);
+
 	join_plan = make_hashjoin(tlist,
 							  joinclauses,
 							  otherclauses,
@@ -6000,6 +6373,7 @@ make_hash(Plan *lefttree,
 	node->skewTable = skewTable;
 	node->skewColumn = skewColumn;
 	node->skewInherit = skewInherit;
+	node->bloomParam = -1;
 
 	return node;
 }
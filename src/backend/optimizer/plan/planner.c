@@ -213,6 +213,15 @@ static void create_one_window_path(PlannerInfo *root,
 								   PathTarget *output_target,
 								   WindowFuncLists *wflists,
 								   List *activeWindows);
+static void create_partitionwise_window_paths(PlannerInfo *root,
+											  RelOptInfo *input_rel,
+											  RelOptInfo *window_rel,
+											  PathTarget *input_target,
+											  PathTarget *output_target,
+											  WindowFuncLists *wflists,
+											  List *activeWindows);
+static bool window_has_partkey(PlannerInfo *root, RelOptInfo *input_rel,
+							   List *activeWindows);
 static RelOptInfo *create_distinct_paths(PlannerInfo *root,
 										 RelOptInfo *input_rel,
 										 PathTarget *target);
@@ -3892,6 +3901,23 @@ standard_qp_callback(PlannerInfo *root, void *extra)
 		root->window_pathkeys = make_pathkeys_for_window(root,
 														 wc,
 														 tlist);
+
+		/*
+		 * Partitionwise window evaluation sorts each partition separately for
+		 * every window, which requires the sort keys' EquivalenceClasses to
+		 * have child members.  Those only get added for ECs that exist when
+		 * the child rels are built, so make sure the ECs for the upper
+		 * windows' sort keys exist already.
+		 */
+		if (enable_partitionwise_window)
+		{
+			ListCell   *lc;
+
+			for_each_from(lc, activeWindows, 1)
+				(void) make_pathkeys_for_window(root,
+												lfirst_node(WindowClause, lc),
+												tlist);
+		}
 	}
 	else
 		root->window_pathkeys = NIL;
@@ -4887,6 +4913,9 @@ create_window_paths(PlannerInfo *root,
 		is_parallel_safe(root, (Node *) activeWindows))
 		window_rel->consider_parallel = true;
 
+	/* Set target, which Append and Gather paths for this rel will use. */
+	window_rel->reltarget = output_target;
+
 	/*
 	 * If the input rel belongs to a single FDW, so does the window rel.
 	 */
@@ -4918,6 +4947,29 @@ create_window_paths(PlannerInfo *root,
 								   activeWindows);
 	}
 
+	/*
+	 * If the input is a partitioned scan/join relation and every window's
+	 * PARTITION BY includes the partition keys, each window partition lies
+	 * within a single table partition, so we can also compute the window
+	 * functions separately for each table partition and append the results.
+	 */
+	if (enable_partitionwise_window &&
+		IS_PARTITIONED_REL(input_rel) &&
+		!IS_UPPER_REL(input_rel) &&
+		window_has_partkey(root, input_rel, activeWindows))
+	{
+		create_partitionwise_window_paths(root, input_rel, window_rel,
+										  input_target, output_target,
+										  wflists, activeWindows);
+
+		/*
+		 * A Parallel Append over the per-partition paths lets the workers
+		 * each compute complete partitions; consider gathering its results.
+		 */
+		if (window_rel->partial_pathlist != NIL)
+			generate_useful_gather_paths(root, window_rel, true);
+	}
+
 	/*
 	 * If there is an FDW that's responsible for all baserels of the query,
 	 * let it consider adding ForeignPaths.
@@ -5109,6 +5161,164 @@ create_one_window_path(PlannerInfo *root,
 	add_path(window_rel, path);
 }
 
+/*
+ * create_partitionwise_window_paths
+ *
+ * Build window-function paths for each partition of input_rel and add Append
+ * paths over them to window_rel.  The caller must have checked that each
+ * window partition is contained in a single partition of input_rel.
+ *
+ * If window_rel is parallel-safe, add_paths_to_append_rel() also builds a
+ * Parallel Append over the per-partition paths, in which each partition's
+ * window functions are computed in full by a single participant.
+ */
+static void
+create_partitionwise_window_paths(PlannerInfo *root,
+								  RelOptInfo *input_rel,
+								  RelOptInfo *window_rel,
+								  PathTarget *input_target,
+								  PathTarget *output_target,
+								  WindowFuncLists *wflists,
+								  List *activeWindows)
+{
+	List	   *live_children = NIL;
+	List	   *all_window_pathkeys = NIL;
+	ListCell   *lc;
+	int			i;
+
+	/* Collect the sort keys that each partition must be able to compute */
+	foreach(lc, activeWindows)
+	{
+		WindowClause *wc = lfirst_node(WindowClause, lc);
+
+		all_window_pathkeys = list_concat(all_window_pathkeys,
+										  make_pathkeys_for_window(root, wc,
+																   root->processed_tlist));
+	}
+
+	i = -1;
+	while ((i = bms_next_member(input_rel->live_parts, i)) >= 0)
+	{
+		RelOptInfo *child_input_rel = input_rel->part_rels[i];
+		RelOptInfo *child_window_rel;
+		PathTarget *child_input_target;
+		PathTarget *child_output_target;
+		WindowFuncLists *child_wflists;
+		AppendRelInfo **appinfos;
+		int			nappinfos;
+
+		Assert(child_input_rel != NULL);
+
+		/* Dummy children can be ignored. */
+		if (IS_DUMMY_REL(child_input_rel))
+			continue;
+
+		/* Translate the targets and window functions for this child. */
+		appinfos = find_appinfos_by_relids(root, child_input_rel->relids,
+										   &nappinfos);
+
+		child_input_target = copy_pathtarget(input_target);
+		child_input_target->exprs = (List *)
+			adjust_appendrel_attrs(root,
+								   (Node *) input_target->exprs,
+								   nappinfos, appinfos);
+
+		child_output_target = copy_pathtarget(output_target);
+		child_output_target->exprs = (List *)
+			adjust_appendrel_attrs(root,
+								   (Node *) output_target->exprs,
+								   nappinfos, appinfos);
+
+		child_wflists = palloc_object(WindowFuncLists);
+		child_wflists->numWindowFuncs = wflists->numWindowFuncs;
+		child_wflists->maxWinRef = wflists->maxWinRef;
+		child_wflists->windowFuncs = palloc0_array(List *,
+												   wflists->maxWinRef + 1);
+		for (Index winref = 0; winref <= wflists->maxWinRef; winref++)
+			child_wflists->windowFuncs[winref] = (List *)
+				adjust_appendrel_attrs(root,
+									   (Node *) wflists->windowFuncs[winref],
+									   nappinfos, appinfos);
+
+		pfree(appinfos);
+
+		/*
+		 * The WindowAggs for this child need their input sorted by the
+		 * parent's window pathkeys, which is only possible if each sort key
+		 * has an EquivalenceClass member that the child can compute.  If not,
+		 * give up on partitionwise evaluation altogether.
+		 */
+		foreach(lc, all_window_pathkeys)
+		{
+			PathKey    *pathkey = lfirst_node(PathKey, lc);
+
+			if (find_computable_ec_member(root, pathkey->pk_eclass,
+										  child_input_target->exprs,
+										  child_input_rel->relids,
+										  false) == NULL)
+				return;
+		}
+
+		child_window_rel = fetch_upper_rel(root, UPPERREL_WINDOW,
+										   child_input_rel->relids);
+		child_window_rel->reloptkind = RELOPT_OTHER_UPPER_REL;
+		child_window_rel->reltarget = child_output_target;
+		child_window_rel->consider_parallel =
+			window_rel->consider_parallel && child_input_rel->consider_parallel;
+
+		/* Same choice of input paths as in create_window_paths() */
+		foreach(lc, child_input_rel->pathlist)
+		{
+			Path	   *path = (Path *) lfirst(lc);
+			int			presorted_keys;
+
+			if (path == child_input_rel->cheapest_total_path ||
+				pathkeys_count_contained_in(root->window_pathkeys,
+											path->pathkeys,
+											&presorted_keys) ||
+				presorted_keys > 0)
+				create_one_window_path(root,
+									   child_window_rel,
+									   path,
+									   child_input_target,
+									   child_output_target,
+									   child_wflists,
+									   activeWindows);
+		}
+
+		set_cheapest(child_window_rel);
+		live_children = lappend(live_children, child_window_rel);
+	}
+
+	if (live_children != NIL)
+		add_paths_to_append_rel(root, window_rel, live_children);
+}
+
+/*
+ * window_has_partkey
+ *
+ * Returns true if the PARTITION BY clause of every active window includes all
+ * the partition keys of input_rel, so that the rows of any one window
+ * partition all come from the same partition of input_rel.
+ */
+static bool
+window_has_partkey(PlannerInfo *root, RelOptInfo *input_rel,
+				   List *activeWindows)
+{
+	ListCell   *lc;
+
+	foreach(lc, activeWindows)
+	{
+		WindowClause *wc = lfirst_node(WindowClause, lc);
+
+		if (!group_by_has_partkey(input_rel, root->processed_tlist,
+								  wc->partitionClause))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * create_distinct_paths
  *
@@ -5807,6 +6017,54 @@ create_ordered_paths(PlannerInfo *root,
 
 			add_path(ordered_rel, sorted_path);
 		}
+
+		/*
+		 * Also consider a Parallel Sort of the cheapest partial path, in
+		 * which either a single participant merges the runs sorted by all of
+		 * them, or the participants merge separate key ranges of them.  In
+		 * the latter case we make a few ranges per participant, so that they
+		 * can even out differences in their speed and in the sizes of the
+		 * ranges.  It can't make use of a LIMIT.
+		 */
+		if (enable_parallel_sort && limit_tuples < 0 &&
+			!pathkeys_contained_in(root->sort_pathkeys,
+								   cheapest_partial_path->pathkeys))
+		{
+			int			numRanges[2];
+
+			numRanges[0] = 0;
+			numRanges[1] = (cheapest_partial_path->parallel_workers + 1) * 4;
+
+			for (int i = 0; i < lengthof(numRanges); i++)
+			{
+				Path	   *sorted_path;
+				double		total_groups;
+
+				sorted_path = (Path *) create_parallel_sort_path(root,
+																 ordered_rel,
+																 cheapest_partial_path,
+																 root->sort_pathkeys,
+																 numRanges[i]);
+				total_groups = compute_gather_rows(sorted_path);
+				sorted_path = (Path *)
+					create_gather_merge_path(root, ordered_rel,
+											 sorted_path,
+											 sorted_path->pathtarget,
+											 root->sort_pathkeys, NULL,
+											 &total_groups);
+
+				/*
+				 * If the pathtarget of the result path has different
+				 * expressions from the target to be applied, a projection
+				 * step is needed.
+				 */
+				if (!equal(sorted_path->pathtarget->exprs, target->exprs))
+					sorted_path = apply_projection_to_path(root, ordered_rel,
+														   sorted_path, target);
+
+				add_path(ordered_rel, sorted_path);
+			}
+		}
 	}
 
 	/*
@@ -7625,6 +7883,24 @@ add_paths_to_grouping_rel(PlannerInfo *root, RelOptInfo *input_rel,
 									 havingQual,
 									 agg_costs,
 									 dNumGroups));
+
+			/*
+			 * Consider a Parallel HashAgg over the cheapest partial input
+			 * path.  The participants divide the groups between themselves,
+			 * so this needs neither partial aggregation nor a Finalize
+			 * Aggregate step, and works for aggregates that can't be split.
+			 * gather_grouping_paths() will put a Gather on top.
+			 */
+			if (enable_parallel_hashagg && grouped_rel->consider_parallel &&
+				input_rel->partial_pathlist != NIL)
+				add_partial_path(grouped_rel, (Path *)
+								 create_parallel_hashagg_path(root, grouped_rel,
+															  linitial(input_rel->partial_pathlist),
+															  grouped_rel->reltarget,
+															  root->processed_groupClause,
+															  havingQual,
+															  agg_costs,
+															  dNumGroups));
 		}
 
 		/*
@@ -665,6 +665,12 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 				splan->scan.plan.qual =
 					fix_scan_list(root, splan->scan.plan.qual,
 								  rtoffset, NUM_EXEC_QUAL(plan));
+				foreach_node(HashBloomFilter, filter, splan->bloomFilters)
+				{
+					filter->hashkeys =
+						fix_scan_list(root, filter->hashkeys,
+									  rtoffset, NUM_EXEC_QUAL(plan));
+				}
 			}
 			break;
 		case T_SampleScan:
@@ -2466,6 +2472,31 @@ set_join_references(PlannerInfo *root, Join *join, int rtoffset)
 				  nlp->paramval->varno == OUTER_VAR))
 				elog(ERROR, "NestLoopParam was not reduced to a simple Var");
 		}
+
+		/*
+		 * An adaptive nestloop's hash quals are evaluated like joinqual.  The
+		 * Hash node's tlist matches the inner plan's, so inner_itlist serves
+		 * for it as well.
+		 */
+		if (nl->hash_plan)
+		{
+			nl->hash_outerkeys = (List *) fix_upper_expr(root,
+														 (Node *) nl->hash_outerkeys,
+														 outer_itlist,
+														 OUTER_VAR,
+														 rtoffset,
+														 NRM_EQUAL,
+														 NUM_EXEC_QUAL((Plan *) join));
+			nl->hash_joinqual = fix_join_expr(root,
+											  nl->hash_joinqual,
+											  outer_itlist,
+											  inner_itlist,
+											  (Index) 0,
+											  rtoffset,
+											  NRM_EQUAL,
+											  NUM_EXEC_QUAL((Plan *) join));
+			nl->hash_plan = set_plan_refs(root, nl->hash_plan, rtoffset);
+		}
 	}
 	else if (IsA(join, MergeJoin))
 	{
@@ -2670,14 +2701,19 @@ set_param_references(PlannerInfo *root, Plan *plan)
 
 		/*
 		 * Remember the list of all external initplan params that are used by
-		 * the children of Gather or Gather merge node.
+		 * the children of Gather or Gather merge node.  Keep any params that
+		 * createplan.c has already put there (hash join Bloom filters).
 		 */
 		if (IsA(plan, Gather))
 			((Gather *) plan)->initParam =
-				bms_intersect(plan->lefttree->extParam, initSetParam);
+				bms_add_members(((Gather *) plan)->initParam,
+								bms_intersect(plan->lefttree->extParam,
+											  initSetParam));
 		else
 			((GatherMerge *) plan)->initParam =
-				bms_intersect(plan->lefttree->extParam, initSetParam);
+				bms_add_members(((GatherMerge *) plan)->initParam,
+								bms_intersect(plan->lefttree->extParam,
+											  initSetParam));
 	}
 }
 
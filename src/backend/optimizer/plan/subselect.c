@@ -2662,6 +2662,13 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			break;
 
 		case T_SeqScan:
+			foreach_node(HashBloomFilter, filter,
+						 ((SeqScan *) plan)->bloomFilters)
+			{
+				finalize_primnode((Node *) filter->hashkeys, &context);
+				context.paramids = bms_add_member(context.paramids,
+												  filter->paramid);
+			}
 			context.paramids = bms_add_members(context.paramids, scan_params);
 			break;
 
@@ -2976,6 +2983,21 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 					nestloop_params = bms_add_member(nestloop_params,
 													 nlp->paramno);
 				}
+				/* the hash plan of an adaptive nestloop gets no nestParams */
+				if (((NestLoop *) plan)->hash_plan)
+				{
+					finalize_primnode((Node *) ((NestLoop *) plan)->hash_outerkeys,
+									  &context);
+					finalize_primnode((Node *) ((NestLoop *) plan)->hash_joinqual,
+									  &context);
+					context.paramids =
+						bms_add_members(context.paramids,
+										finalize_plan(root,
+													  ((NestLoop *) plan)->hash_plan,
+													  gather_param,
+													  valid_params,
+													  scan_params));
+				}
 			}
 			break;
 
@@ -2991,6 +3013,11 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 							  &context);
 			finalize_primnode((Node *) ((HashJoin *) plan)->hashclauses,
 							  &context);
+			/* outer child nodes are allowed to reference the Bloom filter */
+			locally_added_param = ((Hash *) plan->righttree)->bloomParam;
+			if (locally_added_param >= 0)
+				valid_params = bms_add_member(bms_copy(valid_params),
+											  locally_added_param);
 			break;
 
 		case T_Hash:
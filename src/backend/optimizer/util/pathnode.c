@@ -2933,6 +2933,57 @@ create_sort_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_parallel_sort_path
+ *	  Creates a pathnode that represents a Parallel Sort of a partial path,
+ *	  in which each participant sorts its share of the input into a shared
+ *	  run, and the runs are then merged.  The result is a partial path, to be
+ *	  put under a Gather Merge.
+ *
+ * If 'numRanges' is zero, a single participant merges all the runs.
+ * Otherwise the key space is divided into that many ranges, which the
+ * participants merge separately, and the Gather Merge just concatenates
+ * them.
+ *
+ * The other arguments are as for create_sort_path(), except that a Parallel
+ * Sort can't make use of a bound.
+ */
+SortPath *
+create_parallel_sort_path(PlannerInfo *root,
+						  RelOptInfo *rel,
+						  Path *subpath,
+						  List *pathkeys,
+						  int numRanges)
+{
+	SortPath   *pathnode = makeNode(SortPath);
+
+	Assert(subpath->parallel_safe && subpath->parallel_workers > 0);
+
+	pathnode->path.pathtype = T_Sort;
+	pathnode->path.parent = rel;
+	/* Sort doesn't project, so use source path's pathtarget */
+	pathnode->path.pathtarget = subpath->pathtarget;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.parallel_aware = true;
+	pathnode->path.parallel_safe = rel->consider_parallel;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = pathkeys;
+
+	pathnode->subpath = subpath;
+	pathnode->numRanges = numRanges;
+
+	/* cost_sort() takes care of the merge of the participants' runs */
+	cost_sort(&pathnode->path, root, pathkeys,
+			  subpath->disabled_nodes,
+			  subpath->total_cost,
+			  subpath->rows,
+			  subpath->pathtarget->width,
+			  0.0,
+			  work_mem, -1.0);
+
+	return pathnode;
+}
+
 /*
  * create_group_path
  *	  Creates a pathnode that represents performing grouping of presorted input
@@ -3120,6 +3171,65 @@ create_agg_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_parallel_hashagg_path
+ *	  Creates a pathnode that represents a Parallel HashAgg, that is, hashed
+ *	  aggregation of a partial path in which the participants divide the
+ *	  groups between themselves.  The result is a partial path that produces
+ *	  finalized groups, so it needs no Finalize Aggregate step on top.
+ *
+ * The arguments are as for create_agg_path(); 'numGroups' is the total
+ * number of groups produced by all participants together.
+ */
+AggPath *
+create_parallel_hashagg_path(PlannerInfo *root,
+							 RelOptInfo *rel,
+							 Path *subpath,
+							 PathTarget *target,
+							 List *groupClause,
+							 List *qual,
+							 const AggClauseCosts *aggcosts,
+							 double numGroups)
+{
+	AggPath    *pathnode = makeNode(AggPath);
+
+	Assert(subpath->parallel_safe && subpath->parallel_workers > 0);
+
+	pathnode->path.pathtype = T_Agg;
+	pathnode->path.parent = rel;
+	pathnode->path.pathtarget = target;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.parallel_aware = true;
+	pathnode->path.parallel_safe = rel->consider_parallel;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = NIL;	/* output is unordered */
+
+	pathnode->subpath = subpath;
+
+	pathnode->aggstrategy = AGG_HASHED;
+	pathnode->aggsplit = AGGSPLIT_SIMPLE;
+	pathnode->numGroups = numGroups;
+	pathnode->transitionSpace = aggcosts ? aggcosts->transitionSpace : 0;
+	pathnode->groupClause = groupClause;
+	pathnode->qual = qual;
+
+	/* cost_agg() takes care of dividing the groups among the participants */
+	cost_agg(&pathnode->path, root,
+			 AGG_HASHED, aggcosts,
+			 list_length(groupClause), numGroups,
+			 qual,
+			 subpath->disabled_nodes,
+			 subpath->startup_cost, subpath->total_cost,
+			 subpath->rows, subpath->pathtarget->width);
+
+	/* add tlist eval cost for each output row */
+	pathnode->path.startup_cost += target->cost.startup;
+	pathnode->path.total_cost += target->cost.startup +
+		target->cost.per_tuple * pathnode->path.rows;
+
+	return pathnode;
+}
+
 /*
  * create_groupingsets_path
  *	  Creates a pathnode that represents performing GROUPING SETS aggregation
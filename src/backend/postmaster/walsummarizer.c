@@ -1362,6 +1362,19 @@ SummarizeSmgrRecord(XLogReaderState *xlogreader, BlockRefTable *brtab)
 									   VISIBILITYMAP_FORKNUM,
 									   visibilitymap_truncation_length(xlrec->blkno));
 	}
+	else if (info == XLOG_SMGR_COMPRESS)
+	{
+		xl_smgr_compress *xlrec;
+
+		/*
+		 * Changing the compression of a fork discards its contents, as for
+		 * its creation.
+		 */
+		xlrec = (xl_smgr_compress *) XLogRecGetData(xlogreader);
+
+		BlockRefTableSetLimitBlock(brtab, &xlrec->rlocator,
+								   xlrec->forkNum, 0);
+	}
 }
 
 /*
@@ -0,0 +1,582 @@
+/*-------------------------------------------------------------------------
+ *
+ * write_stream.c
+ *	  Mechanism for writing out relation data with combining and AIO
+ *
+ * Code that populates a relation fork without going through the buffer
+ * manager, such as the bulk writer used by index builds and table rewrites,
+ * typically produces pages in ascending block number order.  Writing each
+ * page with its own synchronous smgrwrite() or smgrextend() call wastes
+ * storage bandwidth, because the writes are small and the backend sits idle
+ * while each of them is in progress.  This mechanism is the write-side
+ * counterpart of read_stream.c: pages handed to write_stream_write() that
+ * belong to consecutive blocks are combined into writes of up to
+ * io_combine_limit blocks, which are started with smgrstartwritev() and
+ * completed later, allowing up to effective_io_concurrency (or
+ * maintenance_io_concurrency) writes to be in progress at the same time.
+ *
+ * The stream takes ownership of the pages passed to it, and frees or reuses
+ * them once their write has completed.  write_stream_get_buf() returns
+ * memory of previously written pages for reuse, avoiding allocator churn.
+ *
+ * Writes past the current end of the fork first extend it with
+ * smgrzeroextend(), which fills any gap left by non-sequential writes with
+ * zeroes and typically just reserves the space for the written range.  Short
+ * writes past the end are an exception: smgrzeroextend() would write zeroes
+ * for them, so they extend the fork with their own pages instead.
+ *
+ * The writes are issued with skipFsync = true.  The caller is responsible
+ * for making the writes durable after write_stream_end(), e.g. with
+ * smgrregistersync() or smgrimmedsync(), as the bulk writer does.
+ *
+ * The pages live in backend-local memory, so with io_method=worker the
+ * writes are executed synchronously by the issuing backend.  They are still
+ * combined, though.
+ *
+ * Portions Copyright (c) 2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/aio/write_stream.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/catalog.h"
+#include "executor/instrument_node.h"
+#include "miscadmin.h"
+#include "storage/aio.h"
+#include "storage/bufmgr.h"
+#include "storage/smgr.h"
+#include "storage/write_stream.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/resowner.h"
+#include "utils/spccache.h"
+
+/*
+ * Writes past the end of the fork of at most this many blocks extend it with
+ * smgrextend(), rather than with smgrzeroextend() and an asynchronous write.
+ * This matches the cutoff below which mdzeroextend() writes zeroes instead
+ * of using fallocate(), which would make us write the blocks twice.
+ */
+#define WRITE_STREAM_MAX_EXTEND_BY_WRITE	8
+
+typedef struct InProgressWrite
+{
+	PgAioWaitRef io_wref;
+	PgAioReturn io_return;
+	BlockNumber blocknum;
+	int16		nblocks;
+	PGIOAlignedBlock **bufs;	/* io_combine_limit entries */
+} InProgressWrite;
+
+/*
+ * State for managing a stream of writes.
+ */
+struct WriteStream
+{
+	int16		max_ios;
+	int16		io_combine_limit;
+	int16		ios_in_progress;
+	int16		oldest_io_index;
+	int16		next_io_index;
+	bool		sync_mode;		/* max_ios = 0, write synchronously */
+
+	SMgrRelation smgr;
+	ForkNumber	forknum;
+
+	/* Size of the fork, including the extensions done by the stream */
+	BlockNumber nblocks;
+
+	/* The owner that ends the stream on error, if any */
+	ResourceOwner resowner;
+
+	/* Memory context for allocating new pages */
+	MemoryContext memcxt;
+
+	/* stream stats counters */
+	IOStats    *stats;
+
+	/* The write being built up, not yet started */
+	BlockNumber pending_blocknum;
+	int16		pending_nblocks;
+	int16		pending_limit;
+	PGIOAlignedBlock **pending_bufs;
+
+	/* Pages whose writes have completed, kept for reuse */
+	int16		nfree;
+	int16		max_free;
+	PGIOAlignedBlock **free_bufs;
+
+	/* Circular queue of in-progress writes */
+	InProgressWrite ios[FLEXIBLE_ARRAY_MEMBER];
+};
+
+static void ResOwnerReleaseWriteStream(Datum res);
+
+static const ResourceOwnerDesc write_stream_resowner_desc =
+{
+	.name = "WriteStream",
+	.release_phase = RESOURCE_RELEASE_BEFORE_LOCKS,
+	.release_priority = RELEASE_PRIO_FIRST,
+	.ReleaseResource = ResOwnerReleaseWriteStream,
+	.DebugPrint = NULL			/* default message is fine */
+};
+
+/*
+ * Update stream stats with the number of pages not yet written.
+ *
+ * Called once per page handed to write_stream_write().
+ */
+static inline void
+write_stream_count_write(WriteStream *stream)
+{
+	IOStats    *stats = stream->stats;
+	int			nblocks;
+
+	if (stats == NULL)
+		return;
+
+	nblocks = stream->pending_nblocks;
+	for (int i = 0; i < stream->ios_in_progress; i++)
+	{
+		int			index = stream->oldest_io_index + i;
+
+		if (index >= stream->max_ios)
+			index -= stream->max_ios;
+		nblocks += stream->ios[index].nblocks;
+	}
+
+	stats->write_count++;
+	stats->write_queued_sum += nblocks;
+	if (nblocks > stats->write_queued_max)
+		stats->write_queued_max = nblocks;
+}
+
+/*
+ * Update stream stats about size of I/O requests.
+ */
+static inline void
+write_stream_count_io(WriteStream *stream, int nblocks, int in_progress)
+{
+	IOStats    *stats = stream->stats;
+
+	if (stats == NULL)
+		return;
+
+	stats->io_count++;
+	stats->io_nblocks += nblocks;
+	stats->io_in_progress += in_progress;
+}
+
+/*
+ * Update stream stats about waits for I/O completion.
+ */
+static inline void
+write_stream_count_wait(WriteStream *stream)
+{
+	IOStats    *stats = stream->stats;
+
+	if (stats == NULL)
+		return;
+
+	stats->wait_count++;
+}
+
+/*
+ * Enable collection of stats into the provided IOStats.
+ */
+void
+write_stream_enable_stats(WriteStream *stream, IOStats *stats)
+{
+	stream->stats = stats;
+}
+
+/*
+ * Give a page whose write has completed back to the stream.
+ */
+static inline void
+write_stream_release_buf(WriteStream *stream, PGIOAlignedBlock *buf)
+{
+	if (stream->nfree < stream->max_free)
+		stream->free_bufs[stream->nfree++] = buf;
+	else
+		pfree(buf);
+}
+
+/*
+ * Wait for the oldest in-progress write to complete, and release its pages.
+ */
+static void
+write_stream_complete_write(WriteStream *stream)
+{
+	InProgressWrite *io = &stream->ios[stream->oldest_io_index];
+	PgAioReturn *aio_ret = &io->io_return;
+
+	Assert(stream->ios_in_progress > 0);
+
+	/* see WaitReadBuffers() for why we check before waiting */
+	if (aio_ret->result.status == PGAIO_RS_UNKNOWN &&
+		!pgaio_wref_check_done(&io->io_wref))
+	{
+		pgaio_wref_wait(&io->io_wref);
+		write_stream_count_wait(stream);
+	}
+
+	if (++stream->oldest_io_index == stream->max_ios)
+		stream->oldest_io_index = 0;
+	stream->ios_in_progress--;
+
+	Assert(aio_ret->result.status != PGAIO_RS_UNKNOWN);
+
+	if (aio_ret->result.status == PGAIO_RS_ERROR ||
+		aio_ret->result.status == PGAIO_RS_WARNING)
+		pgaio_result_report(aio_ret->result, &aio_ret->target_data,
+							aio_ret->result.status == PGAIO_RS_ERROR ?
+							ERROR : WARNING);
+	else if (aio_ret->result.status == PGAIO_RS_PARTIAL)
+	{
+		int			nwritten = aio_ret->result.result;
+
+		/*
+		 * Short writes are rare enough that it's not worth the trouble of
+		 * issuing another asynchronous write.
+		 */
+		pgaio_result_report(aio_ret->result, &aio_ret->target_data, DEBUG1);
+		Assert(nwritten > 0 && nwritten < io->nblocks);
+		smgrwritev(stream->smgr, stream->forknum, io->blocknum + nwritten,
+				   (const void **) &io->bufs[nwritten],
+				   io->nblocks - nwritten, true);
+	}
+
+	for (int i = 0; i < io->nblocks; i++)
+		write_stream_release_buf(stream, io->bufs[i]);
+}
+
+/*
+ * Start writing out the pending write.
+ */
+static void
+write_stream_start_pending_write(WriteStream *stream)
+{
+	BlockNumber blocknum = stream->pending_blocknum;
+	int16		nblocks = stream->pending_nblocks;
+	InProgressWrite *io;
+	PgAioHandle *ioh;
+
+	Assert(nblocks > 0);
+
+	/*
+	 * If the write goes beyond the current end of the fork, extend it first.
+	 * This also fills the gap between the old end and the start of the write,
+	 * if any, with zeroes.  The extension never overlaps any earlier write,
+	 * as those all ended below the old end of the fork.
+	 */
+	if (blocknum + nblocks > stream->nblocks)
+	{
+		/*
+		 * A short write that lies entirely past the end extends the fork
+		 * with its own pages, see WRITE_STREAM_MAX_EXTEND_BY_WRITE.  That's
+		 * synchronous, but only happens at the tail of the stream or after a
+		 * gap.
+		 */
+		if (blocknum >= stream->nblocks &&
+			nblocks <= WRITE_STREAM_MAX_EXTEND_BY_WRITE)
+		{
+			if (blocknum > stream->nblocks)
+				smgrzeroextend(stream->smgr, stream->forknum, stream->nblocks,
+							   blocknum - stream->nblocks, true);
+			for (int i = 0; i < nblocks; i++)
+				smgrextend(stream->smgr, stream->forknum, blocknum + i,
+						   stream->pending_bufs[i], true);
+			stream->nblocks = blocknum + nblocks;
+			write_stream_count_io(stream, nblocks, 0);
+
+			for (int i = 0; i < nblocks; i++)
+				write_stream_release_buf(stream, stream->pending_bufs[i]);
+			stream->pending_nblocks = 0;
+			return;
+		}
+
+		smgrzeroextend(stream->smgr, stream->forknum, stream->nblocks,
+					   blocknum + nblocks - stream->nblocks, true);
+		stream->nblocks = blocknum + nblocks;
+	}
+
+	if (stream->sync_mode)
+	{
+		smgrwritev(stream->smgr, stream->forknum, blocknum,
+				   (const void **) stream->pending_bufs, nblocks, true);
+		write_stream_count_io(stream, nblocks, 0);
+
+		for (int i = 0; i < nblocks; i++)
+			write_stream_release_buf(stream, stream->pending_bufs[i]);
+		stream->pending_nblocks = 0;
+		return;
+	}
+
+	/* Make room for another write, if we have to */
+	if (stream->ios_in_progress == stream->max_ios)
+		write_stream_complete_write(stream);
+
+	io = &stream->ios[stream->next_io_index];
+	io->blocknum = blocknum;
+	io->nblocks = nblocks;
+	memcpy(io->bufs, stream->pending_bufs, sizeof(PGIOAlignedBlock *) * nblocks);
+
+	ioh = pgaio_io_acquire(CurrentResourceOwner, &io->io_return);
+	pgaio_io_get_wref(ioh, &io->io_wref);
+
+	/* the pages are in backend-local memory */
+	pgaio_io_set_flag(ioh, PGAIO_HF_REFERENCES_LOCAL);
+
+	smgrstartwritev(ioh, stream->smgr, stream->forknum, blocknum,
+					(const void **) io->bufs, nblocks, true);
+
+	/* The write is now in progress and owns the pages */
+	if (++stream->next_io_index == stream->max_ios)
+		stream->next_io_index = 0;
+	stream->ios_in_progress++;
+	stream->pending_nblocks = 0;
+
+	write_stream_count_io(stream, nblocks, stream->ios_in_progress);
+}
+
+static WriteStream *
+write_stream_begin_impl(int flags,
+						Relation rel,
+						SMgrRelation smgr,
+						ForkNumber forknum)
+{
+	WriteStream *stream;
+	size_t		size;
+	int			max_ios;
+	int			max_free;
+	PGIOAlignedBlock **bufs;
+	Oid			tablespace_id;
+
+	/*
+	 * Decide how many writes we will allow to be in progress at the same
+	 * time, the same way read_stream.c does for reads.
+	 */
+	tablespace_id = smgr->smgr_rlocator.locator.spcOid;
+	if (!OidIsValid(MyDatabaseId) ||
+		(rel && IsCatalogRelation(rel)) ||
+		IsCatalogRelationOid(smgr->smgr_rlocator.locator.relNumber))
+	{
+		/*
+		 * Avoid circularity while trying to look up tablespace settings or
+		 * before spccache.c is ready.
+		 */
+		max_ios = effective_io_concurrency;
+	}
+	else if (flags & WRITE_STREAM_MAINTENANCE)
+		max_ios = get_tablespace_maintenance_io_concurrency(tablespace_id);
+	else
+		max_ios = get_tablespace_io_concurrency(tablespace_id);
+
+	/* Cap to keep the queue indexes well within int16 */
+	max_ios = Min(max_ios, PG_INT16_MAX / 2);
+
+	/* Keep one write's worth of completed pages around for reuse */
+	max_free = io_combine_limit;
+
+	/*
+	 * Allocate the object, the in-progress write queue and the arrays of
+	 * page pointers in one chunk.
+	 */
+	size = offsetof(WriteStream, ios);
+	size += sizeof(InProgressWrite) * Max(1, max_ios);
+	size += sizeof(PGIOAlignedBlock *) *
+		((Max(1, max_ios) + 1) * io_combine_limit + max_free);
+	stream = (WriteStream *) palloc0(size);
+
+	/*
+	 * Setting max_ios to zero disables asynchronous writes, but we still
+	 * combine them.
+	 */
+	if (max_ios == 0)
+	{
+		max_ios = 1;
+		stream->sync_mode = true;
+	}
+
+	/*
+	 * Capture stable values for these two GUC-derived numbers for the
+	 * lifetime of this stream, so we don't have to worry about the GUCs
+	 * changing underneath us beyond this point.
+	 */
+	stream->max_ios = max_ios;
+	stream->io_combine_limit = io_combine_limit;
+
+	bufs = (PGIOAlignedBlock **) &stream->ios[max_ios];
+	for (int i = 0; i < max_ios; i++)
+	{
+		stream->ios[i].bufs = bufs;
+		bufs += io_combine_limit;
+		pgaio_wref_clear(&stream->ios[i].io_wref);
+	}
+	stream->pending_bufs = bufs;
+	bufs += io_combine_limit;
+	stream->free_bufs = bufs;
+	stream->max_free = max_free;
+
+	stream->smgr = smgr;
+	stream->forknum = forknum;
+	stream->nblocks = smgrnblocks(smgr, forknum);
+	stream->memcxt = CurrentMemoryContext;
+
+	/*
+	 * On error, in-progress writes must be waited for before their pages are
+	 * freed along with the memory context holding them.
+	 */
+	stream->resowner = CurrentResourceOwner;
+	if (stream->resowner)
+	{
+		ResourceOwnerEnlarge(stream->resowner);
+		ResourceOwnerRemember(stream->resowner, PointerGetDatum(stream),
+							  &write_stream_resowner_desc);
+	}
+
+	return stream;
+}
+
+/*
+ * Create a new write stream for writing a relation fork.
+ */
+WriteStream *
+write_stream_begin_relation(int flags,
+							Relation rel,
+							ForkNumber forknum)
+{
+	return write_stream_begin_impl(flags,
+								   rel,
+								   RelationGetSmgr(rel),
+								   forknum);
+}
+
+/*
+ * Create a new write stream for writing a SMgr relation fork.
+ */
+WriteStream *
+write_stream_begin_smgr_relation(int flags,
+								 SMgrRelation smgr,
+								 ForkNumber forknum)
+{
+	return write_stream_begin_impl(flags,
+								   NULL,
+								   smgr,
+								   forknum);
+}
+
+/*
+ * Get a block-sized, I/O aligned buffer to fill with a page and pass to
+ * write_stream_write().  This reuses the memory of pages whose writes have
+ * completed, if available.
+ */
+PGIOAlignedBlock *
+write_stream_get_buf(WriteStream *stream)
+{
+	if (stream->nfree > 0)
+		return stream->free_bufs[--stream->nfree];
+
+	return MemoryContextAllocAligned(stream->memcxt, BLCKSZ,
+									 PG_IO_ALIGN_SIZE, 0);
+}
+
+/*
+ * Queue a write of 'buf' to block 'blocknum'.
+ *
+ * NB: this takes ownership of 'buf', which must have been allocated with
+ * write_stream_get_buf() or with the same alignment in a memory context that
+ * lives at least as long as the stream.  Its contents, including the
+ * checksum, must be final.
+ *
+ * Each block may be written only once while the stream is in use.
+ */
+void
+write_stream_write(WriteStream *stream, BlockNumber blocknum,
+				   PGIOAlignedBlock *buf)
+{
+	/* Start the pending write, if the page can't be added to it */
+	if (stream->pending_nblocks > 0 &&
+		stream->pending_blocknum + stream->pending_nblocks != blocknum)
+		write_stream_start_pending_write(stream);
+
+	if (stream->pending_nblocks == 0)
+	{
+		stream->pending_blocknum = blocknum;
+		stream->pending_limit = Min(stream->io_combine_limit,
+									smgrmaxcombine(stream->smgr,
+												   stream->forknum,
+												   blocknum));
+	}
+	stream->pending_bufs[stream->pending_nblocks++] = buf;
+
+	write_stream_count_write(stream);
+
+	/* Start the write as soon as it can't grow any further */
+	if (stream->pending_nblocks == stream->pending_limit)
+		write_stream_start_pending_write(stream);
+}
+
+/*
+ * Write out all pages queued so far, and wait for the writes to complete.
+ */
+void
+write_stream_flush(WriteStream *stream)
+{
+	if (stream->pending_nblocks > 0)
+		write_stream_start_pending_write(stream);
+
+	while (stream->ios_in_progress > 0)
+		write_stream_complete_write(stream);
+}
+
+/*
+ * Write out all pages queued so far, and release the stream.  The caller is
+ * responsible for fsyncing the relation fork, see the top of the file.
+ */
+void
+write_stream_end(WriteStream *stream)
+{
+	write_stream_flush(stream);
+
+	if (stream->resowner)
+		ResourceOwnerForget(stream->resowner, PointerGetDatum(stream),
+							&write_stream_resowner_desc);
+
+	for (int i = 0; i < stream->nfree; i++)
+		pfree(stream->free_bufs[i]);
+	pfree(stream);
+}
+
+/*
+ * Release callback for the stream's resource owner, which is only reached if
+ * write_stream_end() wasn't called, normally because of an error.
+ */
+static void
+ResOwnerReleaseWriteStream(Datum res)
+{
+	WriteStream *stream = (WriteStream *) DatumGetPointer(res);
+
+	/*
+	 * The in-progress writes reference pages that might be freed soon, so
+	 * wait for them to finish.  Their results don't matter anymore, the
+	 * relation being written is useless after an error anyway.
+	 */
+	while (stream->ios_in_progress > 0)
+	{
+		InProgressWrite *io = &stream->ios[stream->oldest_io_index];
+
+		if (pgaio_wref_valid(&io->io_wref))
+			pgaio_wref_wait(&io->io_wref);
+
+		if (++stream->oldest_io_index == stream->max_ios)
+			stream->oldest_io_index = 0;
+		stream->ios_in_progress--;
+	}
+	stream->resowner = NULL;
+}
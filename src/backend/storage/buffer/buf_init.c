@@ -14,9 +14,11 @@
  */
 #include "postgres.h"
 
+#include "port/pg_numa.h"
 #include "storage/aio.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/pg_shmem.h"
 #include "storage/proclist.h"
 #include "storage/shmem.h"
 #include "storage/subsystems.h"
@@ -26,10 +28,15 @@ char	   *BufferBlocks;
 ConditionVariableMinimallyPadded *BufferIOCVArray;
 WritebackContext BackendWritebackContext;
 CkptSortItem *CkptBufferIds;
+BufferNumaPlacement *BufferPlacement;
+
+/* number of NUMA nodes to partition the buffer blocks over, or 0 */
+static int	BufferNumaNodesRequested = 0;
 
 static void BufferManagerShmemRequest(void *arg);
 static void BufferManagerShmemInit(void *arg);
 static void BufferManagerShmemAttach(void *arg);
+static void BufferNumaPlacementInit(void);
 
 const ShmemCallbacks BufferManagerShmemCallbacks = {
 	.request_fn = BufferManagerShmemRequest,
@@ -108,6 +115,26 @@ BufferManagerShmemRequest(void *arg)
 					   .size = NBuffers * sizeof(CkptSortItem),
 					   .ptr = (void **) &CkptBufferIds,
 		);
+
+	/*
+	 * With shared_memory_numa = partition, the buffer blocks are split in one
+	 * range per NUMA node.  This is pointless if there is only one node.
+	 */
+	BufferNumaNodesRequested = 0;
+	if (shared_memory_numa == SHMEM_NUMA_PARTITION && pg_numa_init() != -1)
+	{
+		int			nodes = pg_numa_get_max_node() + 1;
+
+		if (nodes > 1 && nodes <= NBuffers)
+			BufferNumaNodesRequested = nodes;
+	}
+
+	ShmemRequestStruct(.name = "Buffer NUMA Placement",
+					   .size = add_size(offsetof(BufferNumaPlacement, firstBuffer),
+										mul_size(BufferNumaNodesRequested,
+												 sizeof(int))),
+					   .ptr = (void **) &BufferPlacement,
+		);
 }
 
 /*
@@ -119,6 +146,9 @@ BufferManagerShmemRequest(void *arg)
 static void
 BufferManagerShmemInit(void *arg)
 {
+	/* Place the buffer blocks on NUMA nodes before anything touches them */
+	BufferNumaPlacementInit();
+
 	/*
 	 * Initialize all the buffer headers.
 	 */
@@ -151,3 +181,58 @@ BufferManagerShmemAttach(void *arg)
 	WritebackContextInit(&BackendWritebackContext,
 						 &backend_flush_after);
 }
+
+/*
+ * Bind the buffer blocks to NUMA nodes, if requested.
+ *
+ * Each node gets about NBuffers / nodes consecutive buffers, split the same
+ * way as clock-sweep partitions aligned to NUMA nodes (see freelist.c), with
+ * the boundaries moved up to memory page boundaries.  A buffer belongs
+ * to the node its first byte is placed on.  The memory policy only applies to
+ * pages not touched yet, which is why this runs before the buffer headers are
+ * initialized.  The first and last pages may also hold the end of the
+ * preceding area and the start of the following one; binding those to a
+ * node instead of interleaving them is harmless.
+ */
+static void
+BufferNumaPlacementInit(void)
+{
+	int			nodes = BufferNumaNodesRequested;
+	Size		pagesize;
+	char	   *start;
+	char	   *end;
+
+	BufferPlacement->numaNodes = nodes;
+	if (nodes == 0)
+		return;
+
+	pagesize = pg_get_shmem_pagesize();
+	start = (char *) TYPEALIGN_DOWN(pagesize, BufferBlocks);
+	end = (char *) TYPEALIGN(pagesize, BufferBlocks + (Size) NBuffers * BLCKSZ);
+
+	for (int n = 0; n < nodes; n++)
+	{
+		char	   *next = end;
+
+		if (n == 0)
+			BufferPlacement->firstBuffer[n] = 0;
+		else
+			BufferPlacement->firstBuffer[n] =
+				(int) Min(NBuffers, (start - BufferBlocks + BLCKSZ - 1) / BLCKSZ);
+
+		if (n < nodes - 1)
+		{
+			int			boundary = (int) ((int64) NBuffers * (n + 1) / nodes);
+
+			next = (char *) TYPEALIGN(pagesize,
+									  BufferBlocks + (Size) boundary * BLCKSZ);
+			next = Min(next, end);
+		}
+
+		if (next > start)
+			pg_numa_bind_memory(start, next - start, n);
+		start = next;
+	}
+
+	elog(DEBUG1, "shared buffers partitioned over %d NUMA nodes", nodes);
+}
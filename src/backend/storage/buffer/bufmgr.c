@@ -51,6 +51,7 @@
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "pgstat.h"
+#include "port/pg_numa.h"
 #include "postmaster/bgwriter.h"
 #include "storage/aio.h"
 #include "storage/buf_internals.h"
@@ -94,6 +95,27 @@
  */
 #define BUF_DROP_FULL_SCAN_THRESHOLD		(uint64) (NBuffers / 32)
 
+/*
+ * State that BgBufferSync() keeps for each clock-sweep partition.  Buffer
+ * indexes are relative to the start of the partition.
+ */
+typedef struct BgSyncPartitionState
+{
+	/*
+	 * Information saved between calls so we can determine the strategy
+	 * point's advance rate and avoid scanning already-cleaned buffers.
+	 */
+	bool		saved_info_valid;
+	int			prev_strategy_buf_id;
+	uint32		prev_strategy_passes;
+	int			next_to_clean;
+	uint32		next_passes;
+
+	/* Moving averages of allocation rate and clean-buffer density */
+	float		smoothed_alloc;
+	float		smoothed_density;
+} BgSyncPartitionState;
+
 /*
  * This is separated out from PrivateRefCountEntry to allow for copying all
  * the data members via struct assignment.
@@ -172,6 +194,35 @@ typedef struct CkptTsStatus
 	int			index;
 } CkptTsStatus;
 
+/*
+ * An asynchronous write of one or more buffers holding consecutive blocks,
+ * issued by the checkpointer in CkptStartWrite().
+ */
+typedef struct CkptWrite
+{
+	PgAioWaitRef io_wref;
+	PgAioReturn io_return;
+
+	/* tag of the first buffer, the others follow consecutively */
+	BufferTag	tag;
+
+	int			nbuffers;
+	Buffer		buffers[MAX_IO_COMBINE_LIMIT];
+} CkptWrite;
+
+/*
+ * Ring buffer of the writes BufferSync() has in flight, at most
+ * checkpoint_io_concurrency of them.
+ */
+typedef struct CkptWriteQueue
+{
+	int			max_writes;
+	int			nwrites;
+	/* index of the oldest write in writes[] */
+	int			oldest;
+	CkptWrite  *writes;
+} CkptWriteQueue;
+
 /*
  * Type for array used to sort SMgrRelations
  *
@@ -224,6 +275,12 @@ int			checkpoint_flush_after = DEFAULT_CHECKPOINT_FLUSH_AFTER;
 int			bgwriter_flush_after = DEFAULT_BGWRITER_FLUSH_AFTER;
 int			backend_flush_after = DEFAULT_BACKEND_FLUSH_AFTER;
 
+/*
+ * How many asynchronous, possibly combined, writes the checkpointer may have
+ * in flight.  Zero means to write buffers out one at a time, synchronously.
+ */
+int			checkpoint_io_concurrency = DEFAULT_CHECKPOINT_IO_CONCURRENCY;
+
 /* local state for LockBufferForCleanup */
 static BufferDesc *PinCountWaitBuf = NULL;
 
@@ -270,6 +327,9 @@ static int	PrivateRefCountEntryLast = -1;
 
 static uint32 MaxProportionalPins;
 
+/* NUMA node this backend runs on, -1 if unknown, -2 if not looked up yet */
+static int	MyBufferNumaNode = -2;
+
 static void ReservePrivateRefCountEntry(void);
 static PrivateRefCountEntry *NewPrivateRefCountEntry(Buffer buffer);
 static PrivateRefCountEntry *GetPrivateRefCountEntry(Buffer buffer, bool do_move);
@@ -634,8 +694,16 @@ static void PinBuffer_Locked(BufferDesc *buf);
 static void UnpinBuffer(BufferDesc *buf);
 static void UnpinBufferNoOwner(BufferDesc *buf);
 static void BufferSync(int flags);
+static bool BgBufferSyncPartition(int partition,
+								  BgSyncPartitionState *state,
+								  int max_to_write, int *num_written,
+								  WritebackContext *wb_context);
 static int	SyncOneBuffer(int buf_id, bool skip_recently_used,
 						  WritebackContext *wb_context);
+static int	CkptStartWrite(CkptWriteQueue *queue, CkptSortItem *items,
+						   int nitems, WritebackContext *wb_context);
+static void CkptCompleteWrite(CkptWriteQueue *queue,
+							  WritebackContext *wb_context);
 static void WaitIO(BufferDesc *buf);
 static void AbortBufferIO(Buffer buffer);
 static void shared_buffer_write_error_callback(void *arg);
@@ -652,7 +720,8 @@ static void CheckReadBuffersOperation(ReadBuffersOperation *operation, bool is_c
 static pg_attribute_always_inline void TrackBufferHit(IOObject io_object,
 													  IOContext io_context,
 													  Relation rel, char persistence, SMgrRelation smgr,
-													  ForkNumber forknum, BlockNumber blocknum);
+													  ForkNumber forknum, BlockNumber blocknum,
+													  Buffer buffer);
 static Buffer GetVictimBuffer(BufferAccessStrategy strategy, IOContext io_context);
 static void FlushUnlockedBuffer(BufferDesc *buf, SMgrRelation reln,
 								IOObject io_object, IOContext io_context);
@@ -688,6 +757,8 @@ static void BufferLockDequeueSelf(BufferDesc *buf_hdr);
 static void BufferLockWakeup(BufferDesc *buf_hdr, bool wake_exclusive);
 static void BufferLockProcessRelease(BufferDesc *buf_hdr, BufferLockMode mode, uint64 lockstate);
 static inline uint64 BufferLockReleaseSub(BufferLockMode mode);
+static void BufferLockUnlockDisowned(BufferDesc *buf_hdr, BufferLockMode mode);
+static bool BufferLockWaitForAsyncWrite(BufferDesc *buf_hdr);
 
 
 /*
@@ -1252,7 +1323,8 @@ PinBufferForBlock(Relation rel,
 							 strategy, foundPtr, io_context);
 
 	if (*foundPtr)
-		TrackBufferHit(io_object, io_context, rel, persistence, smgr, forkNum, blockNum);
+		TrackBufferHit(io_object, io_context, rel, persistence, smgr, forkNum, blockNum,
+					   BufferDescriptorGetBuffer(bufHdr));
 
 	if (rel)
 	{
@@ -1682,7 +1754,7 @@ CheckReadBuffersOperation(ReadBuffersOperation *operation, bool is_complete)
 static pg_attribute_always_inline void
 TrackBufferHit(IOObject io_object, IOContext io_context,
 			   Relation rel, char persistence, SMgrRelation smgr,
-			   ForkNumber forknum, BlockNumber blocknum)
+			   ForkNumber forknum, BlockNumber blocknum, Buffer buffer)
 {
 	TRACE_POSTGRESQL_BUFFER_READ_DONE(forknum,
 									  blocknum,
@@ -1699,6 +1771,22 @@ TrackBufferHit(IOObject io_object, IOContext io_context,
 
 	pgstat_count_io_op(io_object, io_context, IOOP_HIT, 1, 0);
 
+	/*
+	 * If shared buffers are partitioned over NUMA nodes, also count the hits
+	 * on buffers placed on another node than the one we run on.  The node is
+	 * looked up once, as for the clock-sweep partition in freelist.c.
+	 */
+	if (unlikely(BufferPlacement->numaNodes > 0) &&
+		persistence != RELPERSISTENCE_TEMP)
+	{
+		if (MyBufferNumaNode == -2)
+			MyBufferNumaNode = pg_numa_get_current_node();
+
+		if (MyBufferNumaNode >= 0 &&
+			BufferGetNumaNode(buffer - 1) != MyBufferNumaNode)
+			pgstat_count_io_op(io_object, io_context, IOOP_REMOTE_HIT, 1, 0);
+	}
+
 	if (VacuumCostActive)
 		VacuumCostBalance += VacuumCostPageHit;
 
@@ -1862,7 +1950,7 @@ WaitReadBuffers(ReadBuffersOperation *operation)
 					TrackBufferHit(io_object, io_context,
 								   operation->rel, operation->persistence,
 								   operation->smgr, operation->forknum,
-								   blocknum);
+								   blocknum, buffer);
 				}
 
 				/*
@@ -2083,7 +2171,7 @@ AsyncReadBuffers(ReadBuffersOperation *operation, int *nblocks_progress)
 			TrackBufferHit(io_object, io_context,
 						   operation->rel, operation->persistence,
 						   operation->smgr, operation->forknum,
-						   blocknum);
+						   blocknum, buffers[nblocks_done]);
 			return false;
 		}
 
@@ -3572,6 +3660,7 @@ BufferSync(int flags)
 	int			i;
 	uint64		mask = BM_DIRTY;
 	WritebackContext wb_context;
+	CkptWriteQueue write_queue = {0};
 
 	/*
 	 * Unless this is a shutdown checkpoint or we have been explicitly told,
@@ -3736,6 +3825,17 @@ BufferSync(int flags)
 
 	binaryheap_build(ts_heap);
 
+	/*
+	 * Unless disabled, buffers are written out with asynchronous IO, combining
+	 * buffers holding consecutive blocks into one write.  The sort order of
+	 * CkptBufferIds makes such buffers neighbors in the array.
+	 */
+	if (checkpoint_io_concurrency > 0)
+	{
+		write_queue.max_writes = checkpoint_io_concurrency;
+		write_queue.writes = palloc_array(CkptWrite, write_queue.max_writes);
+	}
+
 	/*
 	 * Iterate through to-be-checkpointed buffers and write the ones (still)
 	 * marked with BM_CHECKPOINT_NEEDED. The writes are balanced between
@@ -3749,14 +3849,13 @@ BufferSync(int flags)
 		BufferDesc *bufHdr = NULL;
 		CkptTsStatus *ts_stat = (CkptTsStatus *)
 			DatumGetPointer(binaryheap_first(ts_heap));
+		int			nitems = 1;
 
 		buf_id = CkptBufferIds[ts_stat->index].buf_id;
 		Assert(buf_id != -1);
 
 		bufHdr = GetBufferDescriptor(buf_id);
 
-		num_processed++;
-
 		/*
 		 * We don't need to acquire the lock here, because we're only looking
 		 * at a single bit. It's possible that someone else writes the buffer
@@ -3771,7 +3870,26 @@ BufferSync(int flags)
 		 */
 		if (pg_atomic_read_u64(&bufHdr->state) & BM_CHECKPOINT_NEEDED)
 		{
-			if (SyncOneBuffer(buf_id, false, &wb_context) & BUF_WRITTEN)
+			if (write_queue.max_writes > 0)
+			{
+				int			nbuffers;
+
+				/*
+				 * The write may cover the following buffers of this
+				 * tablespace as well, consider those processed too.
+				 */
+				nbuffers = CkptStartWrite(&write_queue,
+										  &CkptBufferIds[ts_stat->index],
+										  ts_stat->num_to_scan - ts_stat->num_scanned,
+										  &wb_context);
+
+				for (i = 0; i < nbuffers; i++)
+					TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(CkptBufferIds[ts_stat->index + i].buf_id);
+				PendingCheckpointerStats.buffers_written += nbuffers;
+				num_written += nbuffers;
+				nitems = Max(nbuffers, 1);
+			}
+			else if (SyncOneBuffer(buf_id, false, &wb_context) & BUF_WRITTEN)
 			{
 				TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(buf_id);
 				PendingCheckpointerStats.buffers_written++;
@@ -3779,13 +3897,15 @@ BufferSync(int flags)
 			}
 		}
 
+		num_processed += nitems;
+
 		/*
 		 * Measure progress independent of actually having to flush the buffer
 		 * - otherwise writing become unbalanced.
 		 */
-		ts_stat->progress += ts_stat->progress_slice;
-		ts_stat->num_scanned++;
-		ts_stat->index++;
+		ts_stat->progress += ts_stat->progress_slice * nitems;
+		ts_stat->num_scanned += nitems;
+		ts_stat->index += nitems;
 
 		/* Have all the buffers from the tablespace been processed? */
 		if (ts_stat->num_scanned == ts_stat->num_to_scan)
@@ -3806,12 +3926,18 @@ BufferSync(int flags)
 		CheckpointWriteDelay(flags, (double) num_processed / num_to_scan);
 	}
 
+	/* Wait for the writes still in flight */
+	while (write_queue.nwrites > 0)
+		CkptCompleteWrite(&write_queue, &wb_context);
+
 	/*
 	 * Issue all pending flushes. Only checkpointer calls BufferSync(), so
 	 * IOContext will always be IOCONTEXT_NORMAL.
 	 */
 	IssuePendingWritebacks(&wb_context, IOCONTEXT_NORMAL);
 
+	if (write_queue.writes)
+		pfree(write_queue.writes);
 	pfree(per_ts_stat);
 	per_ts_stat = NULL;
 	binaryheap_free(ts_heap);
@@ -3825,38 +3951,349 @@ BufferSync(int flags)
 	TRACE_POSTGRESQL_BUFFER_SYNC_DONE(NBuffers, num_written, num_to_scan);
 }
 
+/*
+ * CkptStartWrite -- Start an asynchronous write for BufferSync().
+ *
+ * items points to the next entry of CkptBufferIds to process, followed by
+ * nitems - 1 further entries of the same tablespace.  The buffer of the first
+ * entry is written out if it's dirty.  Buffers of the following entries are
+ * included in the same write, as long as they hold the consecutive blocks,
+ * still need to be checkpointed and can be locked without waiting.
+ *
+ * Returns the number of buffers included in the write, which is zero if the
+ * first buffer did not need to be written.
+ *
+ * The content locks and pins of the buffers are handed over to the AIO
+ * subsystem when the write is staged, and are released by the completion
+ * callback, see shared_buffer_writev_complete().  Therefore we do not hold
+ * any locks between writes, and waiting for a lock below can't deadlock with
+ * our own writes in flight.
+ */
+static int
+CkptStartWrite(CkptWriteQueue *queue, CkptSortItem *items, int nitems,
+			   WritebackContext *wb_context)
+{
+	CkptWrite  *write;
+	BufferDesc *buf_hdr;
+	Buffer		buffer;
+	BufferTag	expected_tag;
+	SMgrRelation reln;
+	PgAioHandle *ioh;
+	const void *io_pages[MAX_IO_COMBINE_LIMIT];
+	XLogRecPtr	recptr = InvalidXLogRecPtr;
+	ErrorContextCallback errcallback;
+	instr_time	io_start;
+	uint64		buf_state;
+	int			max_nblocks;
+
+	Assert(nitems > 0);
+
+	/* Make room for the new write, if necessary */
+	if (queue->nwrites == queue->max_writes)
+		CkptCompleteWrite(queue, wb_context);
+
+	write = &queue->writes[(queue->oldest + queue->nwrites) % queue->max_writes];
+	write->nbuffers = 0;
+
+	/*
+	 * Get an IO handle before StartSharedBufferIO(), as pgaio_io_acquire()
+	 * might block, see AsyncReadBuffers().  If none is available right away,
+	 * complete our oldest write, which will free one up.
+	 */
+	ioh = pgaio_io_acquire_nb(CurrentResourceOwner, &write->io_return);
+	if (unlikely(!ioh))
+	{
+		if (queue->nwrites > 0)
+		{
+			CkptCompleteWrite(queue, wb_context);
+			write = &queue->writes[(queue->oldest + queue->nwrites) % queue->max_writes];
+			write->nbuffers = 0;
+		}
+		ioh = pgaio_io_acquire(CurrentResourceOwner, &write->io_return);
+	}
+
+	/*
+	 * Check whether the first buffer needs writing; see SyncOneBuffer() for
+	 * why that can be done without the content lock.
+	 */
+	buf_hdr = GetBufferDescriptor(items[0].buf_id);
+	buffer = BufferDescriptorGetBuffer(buf_hdr);
+
+	ReservePrivateRefCountEntry();
+	ResourceOwnerEnlarge(CurrentResourceOwner);
+
+	buf_state = LockBufHdr(buf_hdr);
+	if (!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY))
+	{
+		UnlockBufHdr(buf_hdr);
+		pgaio_io_release(ioh);
+		return 0;
+	}
+	PinBuffer_Locked(buf_hdr);
+
+	/* we don't hold any other content locks, so it's OK to wait */
+	BufferLockAcquire(buffer, buf_hdr, BUFFER_LOCK_SHARE_EXCLUSIVE);
+
+	if (StartSharedBufferIO(buf_hdr, false, true, NULL) == BUFFER_IO_ALREADY_DONE)
+	{
+		BufferLockUnlock(buffer, buf_hdr);
+		UnpinBuffer(buf_hdr);
+		pgaio_io_release(ioh);
+		return 0;
+	}
+
+	/* Setup error traceback support for ereport() */
+	errcallback.callback = shared_buffer_write_error_callback;
+	errcallback.arg = buf_hdr;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	write->tag = buf_hdr->tag;
+	write->buffers[write->nbuffers++] = buffer;
+	if (pg_atomic_read_u64(&buf_hdr->state) & BM_PERMANENT)
+		recptr = BufferGetLSN(buf_hdr);
+
+	reln = smgropen(BufTagGetRelFileLocator(&write->tag), INVALID_PROC_NUMBER);
+
+	max_nblocks = Min(nitems, io_combine_limit);
+	max_nblocks = Min(max_nblocks,
+					  smgrmaxcombine(reln, BufTagGetForkNum(&write->tag),
+									 write->tag.blockNum));
+
+	/*
+	 * Try to include the buffers for the following blocks.  As we already
+	 * hold a content lock, we must not wait for another one, lest we deadlock
+	 * with a backend locking buffers in a different order.  Same with waiting
+	 * for IO.
+	 */
+	expected_tag = write->tag;
+	while (write->nbuffers < max_nblocks)
+	{
+		CkptSortItem *item = &items[write->nbuffers];
+
+		expected_tag.blockNum++;
+
+		/* cheap checks first */
+		if (item->relNumber != BufTagGetRelNumber(&expected_tag) ||
+			item->forkNum != BufTagGetForkNum(&expected_tag) ||
+			item->blockNum != expected_tag.blockNum)
+			break;
+
+		buf_hdr = GetBufferDescriptor(item->buf_id);
+		buffer = BufferDescriptorGetBuffer(buf_hdr);
+
+		if (!(pg_atomic_read_u64(&buf_hdr->state) & BM_CHECKPOINT_NEEDED))
+			break;
+
+		ReservePrivateRefCountEntry();
+		ResourceOwnerEnlarge(CurrentResourceOwner);
+
+		/* the buffer might have been replaced since BufferSync() looked */
+		buf_state = LockBufHdr(buf_hdr);
+		if (!BufferTagsEqual(&buf_hdr->tag, &expected_tag) ||
+			!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY) ||
+			!(buf_state & BM_CHECKPOINT_NEEDED))
+		{
+			UnlockBufHdr(buf_hdr);
+			break;
+		}
+		PinBuffer_Locked(buf_hdr);
+
+		if (!BufferLockConditional(buffer, buf_hdr, BUFFER_LOCK_SHARE_EXCLUSIVE))
+		{
+			UnpinBuffer(buf_hdr);
+			break;
+		}
+
+		if (StartSharedBufferIO(buf_hdr, false, false, NULL) != BUFFER_IO_READY_FOR_IO)
+		{
+			BufferLockUnlock(buffer, buf_hdr);
+			UnpinBuffer(buf_hdr);
+			break;
+		}
+
+		write->buffers[write->nbuffers++] = buffer;
+		if (pg_atomic_read_u64(&buf_hdr->state) & BM_PERMANENT)
+			recptr = Max(recptr, BufferGetLSN(buf_hdr));
+	}
+
+	/*
+	 * Force XLOG flush up to the highest LSN of the buffers, see
+	 * FlushBuffer() for why that's only done for permanent buffers.
+	 */
+	if (XLogRecPtrIsValid(recptr))
+		XLogFlush(recptr);
+
+	for (int i = 0; i < write->nbuffers; i++)
+	{
+		buf_hdr = GetBufferDescriptor(write->buffers[i] - 1);
+		io_pages[i] = BufHdrGetBlock(buf_hdr);
+
+		/* Update page checksum if desired. */
+		PageSetChecksum((Page) io_pages[i], write->tag.blockNum + i);
+	}
+
+	pgaio_io_get_wref(ioh, &write->io_wref);
+	pgaio_io_set_handle_data_32(ioh, (uint32 *) write->buffers,
+								write->nbuffers);
+	pgaio_io_register_callbacks(ioh, PGAIO_HCB_SHARED_BUFFER_WRITEV, 0);
+
+	io_start = pgstat_prepare_io_time(track_io_timing);
+	smgrstartwritev(ioh, reln, BufTagGetForkNum(&write->tag),
+					write->tag.blockNum, io_pages, write->nbuffers, false);
+	pgstat_count_io_op_time(IOOBJECT_RELATION, IOCONTEXT_NORMAL, IOOP_WRITE,
+							io_start, 1, write->nbuffers * BLCKSZ);
+
+	pgBufferUsage.shared_blks_written += write->nbuffers;
+
+	/*
+	 * The AIO subsystem now owns the content locks and holds its own pins, so
+	 * we can release ours.
+	 */
+	for (int i = 0; i < write->nbuffers; i++)
+		UnpinBuffer(GetBufferDescriptor(write->buffers[i] - 1));
+
+	queue->nwrites++;
+
+	/* Pop the error context stack */
+	error_context_stack = errcallback.previous;
+
+	return write->nbuffers;
+}
+
+/*
+ * CkptCompleteWrite -- Wait for the oldest write started by CkptStartWrite().
+ *
+ * Raises an error if the write failed.  Buffers not covered by a partial
+ * write are written out synchronously.
+ */
+static void
+CkptCompleteWrite(CkptWriteQueue *queue, WritebackContext *wb_context)
+{
+	CkptWrite  *write = &queue->writes[queue->oldest];
+	PgAioReturn *aio_ret = &write->io_return;
+	int			nwritten;
+
+	Assert(queue->nwrites > 0);
+
+	queue->oldest = (queue->oldest + 1) % queue->max_writes;
+	queue->nwrites--;
+
+	/* see WaitReadBuffers() for why we check before waiting */
+	if (aio_ret->result.status == PGAIO_RS_UNKNOWN &&
+		!pgaio_wref_check_done(&write->io_wref))
+	{
+		instr_time	io_start = pgstat_prepare_io_time(track_io_timing);
+
+		pgaio_wref_wait(&write->io_wref);
+
+		/* the IO itself was already counted in CkptStartWrite() */
+		pgstat_count_io_op_time(IOOBJECT_RELATION, IOCONTEXT_NORMAL,
+								IOOP_WRITE, io_start, 0, 0);
+	}
+
+	Assert(aio_ret->result.status != PGAIO_RS_UNKNOWN);
+
+	if (aio_ret->result.status == PGAIO_RS_ERROR)
+		pgaio_result_report(aio_ret->result, &aio_ret->target_data, ERROR);
+
+	if (aio_ret->result.status == PGAIO_RS_PARTIAL)
+	{
+		pgaio_result_report(aio_ret->result, &aio_ret->target_data, DEBUG1);
+		nwritten = aio_ret->result.result;
+	}
+	else
+		nwritten = write->nbuffers;
+
+	Assert(nwritten > 0 && nwritten <= write->nbuffers);
+
+	for (int i = 0; i < nwritten; i++)
+	{
+		BufferTag	tag = write->tag;
+
+		tag.blockNum += i;
+		ScheduleBufferTagForWriteback(wb_context, IOCONTEXT_NORMAL, &tag);
+	}
+
+	/*
+	 * The remaining buffers are still dirty.  Write them out the simple way,
+	 * a short write is rare enough to not be worth more effort.
+	 */
+	for (int i = nwritten; i < write->nbuffers; i++)
+		SyncOneBuffer(write->buffers[i] - 1, false, wb_context);
+}
+
 /*
  * BgBufferSync -- Write out some dirty buffers in the pool.
  *
- * This is called periodically by the background writer process.
+ * This is called periodically by the background writer process.  Each
+ * clock-sweep partition is cleaned separately, ahead of its own clock hand,
+ * with bgwriter_lru_maxpages shared between them.
  *
  * Returns true if it's appropriate for the bgwriter process to go into
  * low-power hibernation mode.  (This happens if the strategy clock-sweep
- * has been "lapped" and no buffer allocations have occurred recently,
- * or if the bgwriter has been effectively disabled by setting
+ * has been "lapped" and no buffer allocations have occurred recently in all
+ * partitions, or if the bgwriter has been effectively disabled by setting
  * bgwriter_lru_maxpages to 0.)
  */
 bool
 BgBufferSync(WritebackContext *wb_context)
 {
-	/* info obtained from freelist.c */
-	int			strategy_buf_id;
-	uint32		strategy_passes;
-	uint32		recent_alloc;
+	static BgSyncPartitionState *sync_state = NULL;
+	static int	next_partition = 0;
+	int			npartitions = StrategyNumPartitions();
+	int			max_to_write = bgwriter_lru_maxpages;
+	bool		hibernate = true;
+
+	if (sync_state == NULL)
+	{
+		sync_state = MemoryContextAllocZero(TopMemoryContext,
+											sizeof(BgSyncPartitionState) * npartitions);
+		for (int i = 0; i < npartitions; i++)
+			sync_state[i].smoothed_density = 10.0;
+	}
 
 	/*
-	 * Information saved between calls so we can determine the strategy
-	 * point's advance rate and avoid scanning already-cleaned buffers.
+	 * Visit the partitions in a different order each time, so that no
+	 * partition is systematically starved of the write budget.  Each
+	 * partition may use its share of what the previous ones left over.
 	 */
-	static bool saved_info_valid = false;
-	static int	prev_strategy_buf_id;
-	static uint32 prev_strategy_passes;
-	static int	next_to_clean;
-	static uint32 next_passes;
+	for (int i = 0; i < npartitions; i++)
+	{
+		int			partition = (next_partition + i) % npartitions;
+		int			budget;
+		int			num_written = 0;
 
-	/* Moving averages of allocation rate and clean-buffer density */
-	static float smoothed_alloc = 0;
-	static float smoothed_density = 10.0;
+		budget = (max_to_write + (npartitions - i) - 1) / (npartitions - i);
+		if (!BgBufferSyncPartition(partition, &sync_state[partition],
+								   budget, &num_written, wb_context))
+			hibernate = false;
+		max_to_write -= num_written;
+	}
+	next_partition = (next_partition + 1) % npartitions;
+
+	return hibernate;
+}
+
+/*
+ * BgBufferSyncPartition -- Write out some dirty buffers in one clock-sweep
+ * partition, writing at most max_to_write buffers.
+ *
+ * The number of buffers written is returned in *num_written.  Returns true if
+ * it's appropriate to hibernate as far as this partition is concerned.
+ */
+static bool
+BgBufferSyncPartition(int partition, BgSyncPartitionState *state,
+					  int max_to_write, int *num_written,
+					  WritebackContext *wb_context)
+{
+	/* info obtained from freelist.c */
+	int			strategy_buf_id;
+	uint32		strategy_passes;
+	uint32		recent_alloc;
+	int			first_buffer;
+	int			nbuffers;
+	int			numa_node;
 
 	/* Potentially these could be tunables, but for now, not */
 	float		smoothing_samples = 16;
@@ -3873,7 +4310,6 @@ BgBufferSync(WritebackContext *wb_context)
 
 	/* Variables for the scanning loop proper */
 	int			num_to_scan;
-	int			num_written;
 	int			reusable_buffers;
 
 	/* Variables for final smoothed_density update */
@@ -3884,7 +4320,10 @@ BgBufferSync(WritebackContext *wb_context)
 	 * Find out where the clock-sweep currently is, and how many buffer
 	 * allocations have happened since our last call.
 	 */
-	strategy_buf_id = StrategySyncStart(&strategy_passes, &recent_alloc);
+	strategy_buf_id = StrategySyncStart(partition, &strategy_passes,
+										&recent_alloc);
+	StrategyGetPartitionInfo(partition, &first_buffer, &nbuffers, &numa_node,
+							 NULL, NULL);
 
 	/* Report buffer alloc counts to pgstat */
 	PendingBgWriterStats.buf_alloc += recent_alloc;
@@ -3896,7 +4335,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 */
 	if (bgwriter_lru_maxpages <= 0)
 	{
-		saved_info_valid = false;
+		state->saved_info_valid = false;
 		return true;
 	}
 
@@ -3908,34 +4347,34 @@ BgBufferSync(WritebackContext *wb_context)
 	 * weird-looking coding of xxx_passes comparisons are to avoid bogus
 	 * behavior when the passes counts wrap around.
 	 */
-	if (saved_info_valid)
+	if (state->saved_info_valid)
 	{
-		int32		passes_delta = strategy_passes - prev_strategy_passes;
+		int32		passes_delta = strategy_passes - state->prev_strategy_passes;
 
-		strategy_delta = strategy_buf_id - prev_strategy_buf_id;
-		strategy_delta += (long) passes_delta * NBuffers;
+		strategy_delta = strategy_buf_id - state->prev_strategy_buf_id;
+		strategy_delta += (long) passes_delta * nbuffers;
 
 		Assert(strategy_delta >= 0);
 
-		if ((int32) (next_passes - strategy_passes) > 0)
+		if ((int32) (state->next_passes - strategy_passes) > 0)
 		{
 			/* we're one pass ahead of the strategy point */
-			bufs_to_lap = strategy_buf_id - next_to_clean;
+			bufs_to_lap = strategy_buf_id - state->next_to_clean;
 #ifdef BGW_DEBUG
 			elog(DEBUG2, "bgwriter ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
-				 next_passes, next_to_clean,
+				 state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta, bufs_to_lap);
 #endif
 		}
-		else if (next_passes == strategy_passes &&
-				 next_to_clean >= strategy_buf_id)
+		else if (state->next_passes == strategy_passes &&
+				 state->next_to_clean >= strategy_buf_id)
 		{
 			/* on same pass, but ahead or at least not behind */
-			bufs_to_lap = NBuffers - (next_to_clean - strategy_buf_id);
+			bufs_to_lap = nbuffers - (state->next_to_clean - strategy_buf_id);
 #ifdef BGW_DEBUG
 			elog(DEBUG2, "bgwriter ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
-				 next_passes, next_to_clean,
+				 state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta, bufs_to_lap);
 #endif
@@ -3948,13 +4387,13 @@ BgBufferSync(WritebackContext *wb_context)
 			 */
 #ifdef BGW_DEBUG
 			elog(DEBUG2, "bgwriter behind: bgw %u-%u strategy %u-%u delta=%ld",
-				 next_passes, next_to_clean,
+				 state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta);
 #endif
-			next_to_clean = strategy_buf_id;
-			next_passes = strategy_passes;
-			bufs_to_lap = NBuffers;
+			state->next_to_clean = strategy_buf_id;
+			state->next_passes = strategy_passes;
+			bufs_to_lap = nbuffers;
 		}
 	}
 	else
@@ -3968,15 +4407,15 @@ BgBufferSync(WritebackContext *wb_context)
 			 strategy_passes, strategy_buf_id);
 #endif
 		strategy_delta = 0;
-		next_to_clean = strategy_buf_id;
-		next_passes = strategy_passes;
-		bufs_to_lap = NBuffers;
+		state->next_to_clean = strategy_buf_id;
+		state->next_passes = strategy_passes;
+		bufs_to_lap = nbuffers;
 	}
 
 	/* Update saved info for next time */
-	prev_strategy_buf_id = strategy_buf_id;
-	prev_strategy_passes = strategy_passes;
-	saved_info_valid = true;
+	state->prev_strategy_buf_id = strategy_buf_id;
+	state->prev_strategy_passes = strategy_passes;
+	state->saved_info_valid = true;
 
 	/*
 	 * Compute how many buffers had to be scanned for each new allocation, ie,
@@ -3987,7 +4426,7 @@ BgBufferSync(WritebackContext *wb_context)
 	if (strategy_delta > 0 && recent_alloc > 0)
 	{
 		scans_per_alloc = (float) strategy_delta / (float) recent_alloc;
-		smoothed_density += (scans_per_alloc - smoothed_density) /
+		state->smoothed_density += (scans_per_alloc - state->smoothed_density) /
 			smoothing_samples;
 	}
 
@@ -3996,22 +4435,22 @@ BgBufferSync(WritebackContext *wb_context)
 	 * strategy point and where we've scanned ahead to, based on the smoothed
 	 * density estimate.
 	 */
-	bufs_ahead = NBuffers - bufs_to_lap;
-	reusable_buffers_est = (float) bufs_ahead / smoothed_density;
+	bufs_ahead = nbuffers - bufs_to_lap;
+	reusable_buffers_est = (float) bufs_ahead / state->smoothed_density;
 
 	/*
 	 * Track a moving average of recent buffer allocations.  Here, rather than
 	 * a true average we want a fast-attack, slow-decline behavior: we
 	 * immediately follow any increase.
 	 */
-	if (smoothed_alloc <= (float) recent_alloc)
-		smoothed_alloc = recent_alloc;
+	if (state->smoothed_alloc <= (float) recent_alloc)
+		state->smoothed_alloc = recent_alloc;
 	else
-		smoothed_alloc += ((float) recent_alloc - smoothed_alloc) /
+		state->smoothed_alloc += ((float) recent_alloc - state->smoothed_alloc) /
 			smoothing_samples;
 
 	/* Scale the estimate by a GUC to allow more aggressive tuning. */
-	upcoming_alloc_est = (int) (smoothed_alloc * bgwriter_lru_multiplier);
+	upcoming_alloc_est = (int) (state->smoothed_alloc * bgwriter_lru_multiplier);
 
 	/*
 	 * If recent_alloc remains at zero for many cycles, smoothed_alloc will
@@ -4022,7 +4461,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 * syndrome.  It will pop back up as soon as recent_alloc increases.
 	 */
 	if (upcoming_alloc_est == 0)
-		smoothed_alloc = 0;
+		state->smoothed_alloc = 0;
 
 	/*
 	 * Even in cases where there's been little or no buffer allocation
@@ -4034,7 +4473,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 * the BGW will be called during the scan_whole_pool time; slice the
 	 * buffer pool into that many sections.
 	 */
-	min_scan_buffers = (int) (NBuffers / (scan_whole_pool_milliseconds / BgWriterDelay));
+	min_scan_buffers = (int) (nbuffers / (scan_whole_pool_milliseconds / BgWriterDelay));
 
 	if (upcoming_alloc_est < (min_scan_buffers + reusable_buffers_est))
 	{
@@ -4053,26 +4492,33 @@ BgBufferSync(WritebackContext *wb_context)
 	 */
 
 	num_to_scan = bufs_to_lap;
-	num_written = 0;
+	*num_written = 0;
 	reusable_buffers = reusable_buffers_est;
 
+	/*
+	 * If the other partitions used up all of bgwriter_lru_maxpages, don't
+	 * scan at all.
+	 */
+	if (max_to_write <= 0)
+		num_to_scan = 0;
+
 	/* Execute the LRU scan */
 	while (num_to_scan > 0 && reusable_buffers < upcoming_alloc_est)
 	{
-		int			sync_state = SyncOneBuffer(next_to_clean, true,
-											   wb_context);
+		int			sync_state = SyncOneBuffer(first_buffer + state->next_to_clean,
+											   true, wb_context);
 
-		if (++next_to_clean >= NBuffers)
+		if (++state->next_to_clean >= nbuffers)
 		{
-			next_to_clean = 0;
-			next_passes++;
+			state->next_to_clean = 0;
+			state->next_passes++;
 		}
 		num_to_scan--;
 
 		if (sync_state & BUF_WRITTEN)
 		{
 			reusable_buffers++;
-			if (++num_written >= bgwriter_lru_maxpages)
+			if (++(*num_written) >= max_to_write)
 			{
 				PendingBgWriterStats.maxwritten_clean++;
 				break;
@@ -4082,14 +4528,14 @@ BgBufferSync(WritebackContext *wb_context)
 			reusable_buffers++;
 	}
 
-	PendingBgWriterStats.buf_written_clean += num_written;
+	PendingBgWriterStats.buf_written_clean += *num_written;
 
 #ifdef BGW_DEBUG
 	elog(DEBUG1, "bgwriter: recent_alloc=%u smoothed=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
-		 recent_alloc, smoothed_alloc, strategy_delta, bufs_ahead,
-		 smoothed_density, reusable_buffers_est, upcoming_alloc_est,
+		 recent_alloc, state->smoothed_alloc, strategy_delta, bufs_ahead,
+		 state->smoothed_density, reusable_buffers_est, upcoming_alloc_est,
 		 bufs_to_lap - num_to_scan,
-		 num_written,
+		 *num_written,
 		 reusable_buffers - reusable_buffers_est);
 #endif
 
@@ -4106,13 +4552,13 @@ BgBufferSync(WritebackContext *wb_context)
 	if (new_strategy_delta > 0 && new_recent_alloc > 0)
 	{
 		scans_per_alloc = (float) new_strategy_delta / (float) new_recent_alloc;
-		smoothed_density += (scans_per_alloc - smoothed_density) /
+		state->smoothed_density += (scans_per_alloc - state->smoothed_density) /
 			smoothing_samples;
 
 #ifdef BGW_DEBUG
 		elog(DEBUG2, "bgwriter: cleaner density alloc=%u scan=%ld density=%.2f new smoothed=%.2f",
 			 new_recent_alloc, new_strategy_delta,
-			 scans_per_alloc, smoothed_density);
+			 scans_per_alloc, state->smoothed_density);
 #endif
 	}
 
@@ -5489,6 +5935,8 @@ CreateAndCopyRelationData(RelFileLocator src_rlocator,
 	 * registered for cleanup.
 	 */
 	RelationCreateStorage(dst_rlocator, relpersistence, false);
+	RelationSetStorageCompression(dst_rel, relpersistence,
+								  smgrgetcompression(src_rel, MAIN_FORKNUM));
 
 	/* copy main fork. */
 	RelationCopyStorageUsingBuffer(src_rlocator, dst_rlocator, MAIN_FORKNUM,
@@ -5943,6 +6391,15 @@ BufferLockAcquire(Buffer buffer, BufferDesc *buf_hdr, BufferLockMode mode)
 			break;
 		}
 
+		/*
+		 * If the lock is held on behalf of an asynchronous write, the IO's
+		 * completion callback releases it.  Wait for the IO rather than for
+		 * the lock, as the IO might otherwise not be completed until its
+		 * issuer gets around to waiting for it.
+		 */
+		if (BufferLockWaitForAsyncWrite(buf_hdr))
+			continue;
+
 		/*
 		 * Ok, at this point we couldn't grab the lock on the first try. We
 		 * cannot simply queue ourselves to the end of the list and wait to be
@@ -6283,6 +6740,62 @@ BufferLockDisown(Buffer buffer, BufferDesc *buf_hdr)
 	RESUME_INTERRUPTS();
 }
 
+/*
+ * Release a lock that was disowned with BufferLockDisown().
+ *
+ * This may be called in a different process than the one that acquired the
+ * lock, e.g. in the completion callback of an asynchronous write.
+ */
+static void
+BufferLockUnlockDisowned(BufferDesc *buf_hdr, BufferLockMode mode)
+{
+	uint64		oldstate;
+
+	oldstate = pg_atomic_sub_fetch_u64(&buf_hdr->state,
+									   BufferLockReleaseSub(mode));
+
+	BufferLockProcessRelease(buf_hdr, mode, oldstate);
+}
+
+/*
+ * Helper for BufferLockAcquire(): if the buffer is being written out with
+ * AIO, and the content lock thus is owned by the AIO subsystem, wait for the
+ * IO to complete.
+ *
+ * Returns true if we waited for IO.
+ */
+static bool
+BufferLockWaitForAsyncWrite(BufferDesc *buf_hdr)
+{
+	uint64		buf_state;
+	PgAioWaitRef iow;
+
+	/*
+	 * Only writes are performed while holding the content lock, and those
+	 * are only started on valid buffers.  Check without the spinlock first,
+	 * to keep the overhead for the common case of plain lock contention low.
+	 */
+	buf_state = pg_atomic_read_u64(&buf_hdr->state);
+	if ((buf_state & (BM_IO_IN_PROGRESS | BM_VALID)) !=
+		(BM_IO_IN_PROGRESS | BM_VALID))
+		return false;
+
+	/* see WaitIO() for why the wait reference is copied under the spinlock */
+	buf_state = LockBufHdr(buf_hdr);
+	iow = buf_hdr->io_wref;
+	UnlockBufHdr(buf_hdr);
+
+	if (!(buf_state & BM_IO_IN_PROGRESS) || !pgaio_wref_valid(&iow))
+		return false;
+
+	/* avoid waiting while holding staged IO, see StartSharedBufferIO() */
+	pgaio_submit_staged();
+
+	pgaio_wref_wait(&iow);
+
+	return true;
+}
+
 /*
  * Stop treating lock as held by current backend.
  *
@@ -8930,6 +9443,52 @@ shared_buffer_readv_complete_local(PgAioHandle *ioh, PgAioResult prior_result,
 	return prior_result;
 }
 
+static void
+shared_buffer_writev_stage(PgAioHandle *ioh, uint8 cb_data)
+{
+	buffer_stage_common(ioh, true, false);
+}
+
+/*
+ * Perform completion handling of a single AIO write of shared buffers. This
+ * write may cover multiple blocks / buffers.
+ *
+ * Releases the share-exclusive content locks and the pins that were handed
+ * over to the AIO subsystem by buffer_stage_common().  Buffers that were
+ * written out are marked clean.  If the write failed, the buffers are marked
+ * with BM_IO_ERROR.  Buffers not covered by a partial write stay dirty, the
+ * issuer of the write needs to write them out again.
+ */
+static PgAioResult
+shared_buffer_writev_complete(PgAioHandle *ioh, PgAioResult prior_result,
+							  uint8 cb_data)
+{
+	uint64	   *io_data;
+	uint8		handle_data_len;
+	bool		failed = prior_result.status == PGAIO_RS_ERROR;
+
+	io_data = pgaio_io_get_handle_data(ioh, &handle_data_len);
+	for (uint8 buf_off = 0; buf_off < handle_data_len; buf_off++)
+	{
+		Buffer		buffer = (Buffer) io_data[buf_off];
+		BufferDesc *buf_hdr = GetBufferDescriptor(buffer - 1);
+		bool		written = !failed && prior_result.result > buf_off;
+
+		Assert(BufferIsValid(buffer));
+
+		/*
+		 * Release the content lock before the pin, so that the buffer can't
+		 * be replaced while we still modify its lock state.
+		 */
+		BufferLockUnlockDisowned(buf_hdr, BUFFER_LOCK_SHARE_EXCLUSIVE);
+
+		TerminateBufferIO(buf_hdr, written, failed ? BM_IO_ERROR : 0,
+						  false, true);
+	}
+
+	return prior_result;
+}
+
 static void
 local_buffer_readv_stage(PgAioHandle *ioh, uint8 cb_data)
 {
@@ -8952,6 +9511,15 @@ const PgAioHandleCallbacks aio_shared_buffer_readv_cb = {
 	.report = buffer_readv_report,
 };
 
+/*
+ * Errors are reported by the smgr layer's callback, the buffer-level writev
+ * callback doesn't detect any errors of its own.
+ */
+const PgAioHandleCallbacks aio_shared_buffer_writev_cb = {
+	.stage = shared_buffer_writev_stage,
+	.complete_shared = shared_buffer_writev_complete,
+};
+
 /* readv callback is passed READ_BUFFERS_* flags as callback data */
 const PgAioHandleCallbacks aio_local_buffer_readv_cb = {
 	.stage = local_buffer_readv_stage,
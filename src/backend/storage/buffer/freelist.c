@@ -17,6 +17,7 @@
 
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "port/pg_numa.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/proc.h"
@@ -25,39 +26,100 @@
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
+/*
+ * Don't split the buffer pool into clock-sweep partitions smaller than this
+ * many buffers.  Tiny partitions would have every backend of the partition
+ * fighting over the same few buffers.
+ */
+#define MIN_CLOCK_SWEEP_PARTITION_SIZE	1024
+
+/* GUC variables */
+int			clock_sweep_partitions = 1;
+bool		clock_sweep_numa = false;
 
 /*
- * The shared freelist control information.
+ * State of one clock-sweep partition, a contiguous range of buffers with its
+ * own clock hand.  Backends run the clock sweep in their home partition, so
+ * that with several partitions they don't all hammer the same hand.
  */
-typedef struct
+typedef struct ClockSweepPartition
 {
-	/* Spinlock: protects the values below */
-	slock_t		buffer_strategy_lock;
+	/* Spinlock: protects completePasses and prevBufferAllocs */
+	slock_t		lock;
+
+	/* The range of buffers covered by this partition */
+	int			firstBuffer;
+	int			numBuffers;
+
+	/* NUMA node the partition is assigned to, or -1 */
+	int			numaNode;
 
 	/*
-	 * clock-sweep hand: index of next buffer to consider grabbing. Note that
-	 * this isn't a concrete buffer - we only ever increase the value. So, to
-	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 * clock-sweep hand: index of next buffer to consider grabbing, relative
+	 * to firstBuffer. Note that this isn't a concrete buffer - we only ever
+	 * increase the value. So, to get an actual buffer, it needs to be used
+	 * modulo numBuffers.
 	 */
 	pg_atomic_uint32 nextVictimBuffer;
 
 	/*
-	 * Statistics.  These counters should be wide enough that they can't
+	 * Statistics.  completePasses should be wide enough that it can't
 	 * overflow during a single bgwriter cycle.
 	 */
 	uint32		completePasses; /* Complete cycles of the clock-sweep */
-	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+	pg_atomic_uint64 numBufferAllocs;	/* Buffers allocated, ever */
+	uint64		prevBufferAllocs;	/* numBufferAllocs at StrategySyncStart */
+} ClockSweepPartition;
+
+/*
+ * Pad the partitions to a cache line, so that backends working in different
+ * partitions don't contend on the same cache line.
+ */
+typedef union ClockSweepPartitionPadded
+{
+	ClockSweepPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} ClockSweepPartitionPadded;
+
+StaticAssertDecl(sizeof(ClockSweepPartition) <= PG_CACHE_LINE_SIZE,
+				 "ClockSweepPartition doesn't fit in a cache line");
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects bgwprocno */
+	slock_t		buffer_strategy_lock;
 
 	/*
 	 * Bgworker process to be notified upon activity or -1 if none. See
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/*
+	 * Number of NUMA nodes the partitions are aligned to, or 0 if they are
+	 * not.  If they are, each node has partitionsPerNode consecutive
+	 * partitions.
+	 */
+	int			numaNodes;
+	int			partitionsPerNode;
+
+	int			numPartitions;
+	ClockSweepPartitionPadded partitions[FLEXIBLE_ARRAY_MEMBER];
 } BufferStrategyControl;
 
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
+/* The partition layout, as computed by StrategyCtlShmemRequest */
+static int	StrategyNumaNodes = 0;
+static int	StrategyNumPartitionsRequested = 1;
+
+/* This backend's home partition, or -1 if not chosen yet */
+static int	MyClockSweepPartition = -1;
+
 static void StrategyCtlShmemRequest(void *arg);
 static void StrategyCtlShmemInit(void *arg);
 
@@ -101,13 +163,49 @@ static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
 
 /*
- * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ * ClockSweepHomePartition - Helper routine for StrategyGetBuffer()
  *
- * Move the clock hand one buffer ahead of its current position and return the
- * id of the buffer now under the hand.
+ * Return the partition this backend runs the clock sweep in first.  Backends
+ * are spread over the partitions by their proc number.  If the partitions are
+ * aligned to NUMA nodes, only the partitions of the node the backend is
+ * running on are considered.
+ */
+static inline int
+ClockSweepHomePartition(void)
+{
+	if (unlikely(MyClockSweepPartition < 0))
+	{
+		int			first = 0;
+		int			nparts = StrategyControl->numPartitions;
+		uint32		spread;
+
+		if (StrategyControl->numaNodes > 0)
+		{
+			int			node = pg_numa_get_current_node();
+
+			if (node >= 0 && node < StrategyControl->numaNodes)
+			{
+				first = node * StrategyControl->partitionsPerNode;
+				nparts = StrategyControl->partitionsPerNode;
+			}
+		}
+
+		spread = (MyProcNumber != INVALID_PROC_NUMBER) ?
+			(uint32) MyProcNumber : (uint32) MyProcPid;
+		MyClockSweepPartition = first + spread % nparts;
+	}
+
+	return MyClockSweepPartition;
+}
+
+/*
+ * ClockSweepTick - Helper routine for ClockSweepPartitionGetBuffer()
+ *
+ * Move the partition's clock hand one buffer ahead of its current position
+ * and return the id of the buffer now under the hand.
  */
 static inline uint32
-ClockSweepTick(void)
+ClockSweepTick(ClockSweepPartition *part)
 {
 	uint32		victim;
 
@@ -117,14 +215,14 @@ ClockSweepTick(void)
 	 * apparent order.
 	 */
 	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+		pg_atomic_fetch_add_u32(&part->nextVictimBuffer, 1);
 
-	if (victim >= NBuffers)
+	if (victim >= part->numBuffers)
 	{
 		uint32		originalVictim = victim;
 
 		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		victim = victim % part->numBuffers;
 
 		/*
 		 * If we're the one that just caused a wraparound, force
@@ -150,19 +248,104 @@ ClockSweepTick(void)
 				 * could lead to an overflow of nextVictimBuffers, but that's
 				 * highly unlikely and wouldn't be particularly harmful.
 				 */
-				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+				SpinLockAcquire(&part->lock);
 
-				wrapped = expected % NBuffers;
+				wrapped = expected % part->numBuffers;
 
-				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+				success = pg_atomic_compare_exchange_u32(&part->nextVictimBuffer,
 														 &expected, wrapped);
 				if (success)
-					StrategyControl->completePasses++;
-				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+					part->completePasses++;
+				SpinLockRelease(&part->lock);
+			}
+		}
+	}
+	return part->firstBuffer + victim;
+}
+
+/*
+ * ClockSweepPartitionGetBuffer - Helper routine for StrategyGetBuffer()
+ *
+ * Use the "clock sweep" algorithm to find a free buffer in the given
+ * partition.  The buffer is pinned before returning, but not yet tracked.
+ * Returns NULL if all the buffers in the partition are pinned.
+ */
+static BufferDesc *
+ClockSweepPartitionGetBuffer(ClockSweepPartition *part, uint64 *buf_state)
+{
+	BufferDesc *buf;
+	int			trycounter;
+
+	trycounter = part->numBuffers;
+	for (;;)
+	{
+		uint64		old_buf_state;
+		uint64		local_buf_state;
+
+		buf = GetBufferDescriptor(ClockSweepTick(part));
+
+		/*
+		 * Check whether the buffer can be used and pin it if so. Do this
+		 * using a CAS loop, to avoid having to lock the buffer header.
+		 */
+		old_buf_state = pg_atomic_read_u64(&buf->state);
+		for (;;)
+		{
+			local_buf_state = old_buf_state;
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; decrement the usage_count (unless pinned) and keep
+			 * scanning.
+			 */
+
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
+			{
+				if (--trycounter == 0)
+				{
+					/*
+					 * We've scanned all the buffers of the partition without
+					 * making any state changes, so all the buffers are pinned
+					 * (or were when we looked at them).  Let the caller try
+					 * elsewhere.
+					 */
+					return NULL;
+				}
+				break;
+			}
+
+			/* See equivalent code in PinBuffer() */
+			if (unlikely(local_buf_state & BM_LOCKED))
+			{
+				old_buf_state = WaitBufHdrUnlocked(buf);
+				continue;
+			}
+
+			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
+			{
+				local_buf_state -= BUF_USAGECOUNT_ONE;
+
+				if (pg_atomic_compare_exchange_u64(&buf->state, &old_buf_state,
+												   local_buf_state))
+				{
+					trycounter = part->numBuffers;
+					break;
+				}
+			}
+			else
+			{
+				/* pin the buffer if the CAS succeeds */
+				local_buf_state += BUF_REFCOUNT_ONE;
+
+				if (pg_atomic_compare_exchange_u64(&buf->state, &old_buf_state,
+												   local_buf_state))
+				{
+					*buf_state = local_buf_state;
+					return buf;
+				}
 			}
 		}
 	}
-	return victim;
 }
 
 /*
@@ -185,7 +368,7 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint64 *buf_state, bool *from_r
 {
 	BufferDesc *buf;
 	int			bgwprocno;
-	int			trycounter;
+	int			partition;
 
 	*from_ring = false;
 
@@ -230,132 +413,145 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint64 *buf_state, bool *from_r
 	}
 
 	/*
-	 * We count buffer allocation requests so that the bgwriter can estimate
-	 * the rate of buffer consumption.  Note that buffers recycled by a
-	 * strategy object are intentionally not counted here.
+	 * Use the "clock sweep" algorithm to find a free buffer, starting in our
+	 * home partition.  Only if all of its buffers are pinned, move on to the
+	 * other partitions.
 	 */
-	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
-
-	/* Use the "clock sweep" algorithm to find a free buffer */
-	trycounter = NBuffers;
-	for (;;)
+	partition = ClockSweepHomePartition();
+	for (int i = 0;; i++)
 	{
-		uint64		old_buf_state;
-		uint64		local_buf_state;
-
-		buf = GetBufferDescriptor(ClockSweepTick());
+		ClockSweepPartition *part = &StrategyControl->partitions[partition].part;
 
-		/*
-		 * Check whether the buffer can be used and pin it if so. Do this
-		 * using a CAS loop, to avoid having to lock the buffer header.
-		 */
-		old_buf_state = pg_atomic_read_u64(&buf->state);
-		for (;;)
+		buf = ClockSweepPartitionGetBuffer(part, buf_state);
+		if (buf != NULL)
 		{
-			local_buf_state = old_buf_state;
-
 			/*
-			 * If the buffer is pinned or has a nonzero usage_count, we cannot
-			 * use it; decrement the usage_count (unless pinned) and keep
-			 * scanning.
+			 * We count buffer allocations per partition so that the bgwriter
+			 * can estimate the rate of buffer consumption in each of them.
+			 * Note that buffers recycled by a strategy object are
+			 * intentionally not counted here.
 			 */
+			pg_atomic_fetch_add_u64(&part->numBufferAllocs, 1);
+			break;
+		}
 
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
-			{
-				if (--trycounter == 0)
-				{
-					/*
-					 * We've scanned all the buffers without making any state
-					 * changes, so all the buffers are pinned (or were when we
-					 * looked at them). We could hope that someone will free
-					 * one eventually, but it's probably better to fail than
-					 * to risk getting stuck in an infinite loop.
-					 */
-					elog(ERROR, "no unpinned buffers available");
-				}
-				break;
-			}
-
-			/* See equivalent code in PinBuffer() */
-			if (unlikely(local_buf_state & BM_LOCKED))
-			{
-				old_buf_state = WaitBufHdrUnlocked(buf);
-				continue;
-			}
-
-			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-			{
-				local_buf_state -= BUF_USAGECOUNT_ONE;
+		if (i + 1 == StrategyControl->numPartitions)
+		{
+			/*
+			 * We've scanned all the buffers without making any state changes,
+			 * so all the buffers are pinned (or were when we looked at them).
+			 * We could hope that someone will free one eventually, but it's
+			 * probably better to fail than to risk getting stuck in an
+			 * infinite loop.
+			 */
+			elog(ERROR, "no unpinned buffers available");
+		}
 
-				if (pg_atomic_compare_exchange_u64(&buf->state, &old_buf_state,
-												   local_buf_state))
-				{
-					trycounter = NBuffers;
-					break;
-				}
-			}
-			else
-			{
-				/* pin the buffer if the CAS succeeds */
-				local_buf_state += BUF_REFCOUNT_ONE;
+		if (++partition == StrategyControl->numPartitions)
+			partition = 0;
+	}
 
-				if (pg_atomic_compare_exchange_u64(&buf->state, &old_buf_state,
-												   local_buf_state))
-				{
-					/* Found a usable buffer */
-					if (strategy != NULL)
-						AddBufferToRing(strategy, buf);
-					*buf_state = local_buf_state;
+	/* Found a usable buffer */
+	if (strategy != NULL)
+		AddBufferToRing(strategy, buf);
 
-					TrackNewBufferPin(BufferDescriptorGetBuffer(buf));
+	TrackNewBufferPin(BufferDescriptorGetBuffer(buf));
 
-					return buf;
-				}
-			}
-		}
-	}
+	return buf;
 }
 
 /*
- * StrategySyncStart -- tell BgBufferSync where to start syncing
+ * StrategySyncStart -- tell BgBufferSync where to start syncing a partition
  *
- * The result is the buffer index of the best buffer to sync first.
- * BgBufferSync() will proceed circularly around the buffer array from there.
+ * The result is the index of the best buffer to sync first, relative to the
+ * start of the clock-sweep partition.  BgBufferSync() will proceed circularly
+ * around the partition's buffers from there.
  *
  * In addition, we return the completed-pass count (which is effectively
- * the higher-order bits of nextVictimBuffer) and the count of recent buffer
- * allocs if non-NULL pointers are passed.  The alloc count is reset after
- * being read.
+ * the higher-order bits of nextVictimBuffer) and the count of buffer allocs
+ * since the last call if non-NULL pointers are passed.
  */
 int
-StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+StrategySyncStart(int partition, uint32 *complete_passes, uint32 *num_buf_alloc)
 {
+	ClockSweepPartition *part;
 	uint32		nextVictimBuffer;
 	int			result;
 
-	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
-	result = nextVictimBuffer % NBuffers;
+	Assert(partition >= 0 && partition < StrategyControl->numPartitions);
+	part = &StrategyControl->partitions[partition].part;
+
+	SpinLockAcquire(&part->lock);
+	nextVictimBuffer = pg_atomic_read_u32(&part->nextVictimBuffer);
+	result = nextVictimBuffer % part->numBuffers;
 
 	if (complete_passes)
 	{
-		*complete_passes = StrategyControl->completePasses;
+		*complete_passes = part->completePasses;
 
 		/*
 		 * Additionally add the number of wraparounds that happened before
 		 * completePasses could be incremented. C.f. ClockSweepTick().
 		 */
-		*complete_passes += nextVictimBuffer / NBuffers;
+		*complete_passes += nextVictimBuffer / part->numBuffers;
 	}
 
 	if (num_buf_alloc)
 	{
-		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+		uint64		allocs = pg_atomic_read_u64(&part->numBufferAllocs);
+
+		*num_buf_alloc = (uint32) (allocs - part->prevBufferAllocs);
+		part->prevBufferAllocs = allocs;
 	}
-	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+	SpinLockRelease(&part->lock);
 	return result;
 }
 
+/*
+ * StrategyNumPartitions -- number of clock-sweep partitions
+ */
+int
+StrategyNumPartitions(void)
+{
+	return StrategyControl->numPartitions;
+}
+
+/*
+ * StrategyGetPartitionInfo -- describe a clock-sweep partition
+ *
+ * Returns the range of buffers covered by the partition, and the NUMA node
+ * it is assigned to (-1 if none).  complete_passes and num_buf_alloc are the
+ * total counts since startup, and can be NULL if not needed.
+ */
+void
+StrategyGetPartitionInfo(int partition, int *first_buffer, int *num_buffers,
+						 int *numa_node, uint32 *complete_passes,
+						 uint64 *num_buf_alloc)
+{
+	ClockSweepPartition *part;
+
+	Assert(partition >= 0 && partition < StrategyControl->numPartitions);
+	part = &StrategyControl->partitions[partition].part;
+
+	*first_buffer = part->firstBuffer;
+	*num_buffers = part->numBuffers;
+	*numa_node = part->numaNode;
+
+	if (complete_passes)
+	{
+		uint32		nextVictimBuffer;
+
+		SpinLockAcquire(&part->lock);
+		nextVictimBuffer = pg_atomic_read_u32(&part->nextVictimBuffer);
+		*complete_passes = part->completePasses +
+			nextVictimBuffer / part->numBuffers;
+		SpinLockRelease(&part->lock);
+	}
+
+	if (num_buf_alloc)
+		*num_buf_alloc = pg_atomic_read_u64(&part->numBufferAllocs);
+}
+
 /*
  * StrategyNotifyBgWriter -- set or clear allocation notification latch
  *
@@ -385,8 +581,40 @@ StrategyNotifyBgWriter(int bgwprocno)
 static void
 StrategyCtlShmemRequest(void *arg)
 {
+	int			max_partitions;
+	int			nparts;
+
+	/*
+	 * Decide on the partition layout.  Don't create partitions smaller than
+	 * MIN_CLOCK_SWEEP_PARTITION_SIZE, but always have at least one.
+	 */
+	max_partitions = Max(1, NBuffers / MIN_CLOCK_SWEEP_PARTITION_SIZE);
+	nparts = Min(clock_sweep_partitions, max_partitions);
+
+	/*
+	 * If requested, give each NUMA node the same number of partitions, so
+	 * that backends can stay within the partitions of their node.
+	 */
+	StrategyNumaNodes = 0;
+	if (clock_sweep_numa && pg_numa_init() != -1)
+	{
+		int			nodes = pg_numa_get_max_node() + 1;
+
+		if (nodes > 1 && nodes <= max_partitions)
+		{
+			int			per_node = Max(1, nparts / nodes);
+
+			per_node = Min(per_node, max_partitions / nodes);
+			nparts = per_node * nodes;
+			StrategyNumaNodes = nodes;
+		}
+	}
+	StrategyNumPartitionsRequested = nparts;
+
 	ShmemRequestStruct(.name = "Buffer Strategy Status",
-					   .size = sizeof(BufferStrategyControl),
+					   .size = add_size(offsetof(BufferStrategyControl, partitions),
+										mul_size(nparts,
+												 sizeof(ClockSweepPartitionPadded))),
 					   .ptr = (void **) &StrategyControl
 		);
 }
@@ -397,17 +625,38 @@ StrategyCtlShmemRequest(void *arg)
 static void
 StrategyCtlShmemInit(void *arg)
 {
-	SpinLockInit(&StrategyControl->buffer_strategy_lock);
-
-	/* Initialize the clock-sweep pointer */
-	pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+	int			nparts = StrategyNumPartitionsRequested;
 
-	/* Clear statistics */
-	StrategyControl->completePasses = 0;
-	pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+	SpinLockInit(&StrategyControl->buffer_strategy_lock);
 
 	/* No pending notification */
 	StrategyControl->bgwprocno = -1;
+
+	StrategyControl->numPartitions = nparts;
+	StrategyControl->numaNodes = StrategyNumaNodes;
+	StrategyControl->partitionsPerNode =
+		StrategyNumaNodes > 0 ? nparts / StrategyNumaNodes : nparts;
+
+	/* Split the buffers into partitions of (almost) equal size */
+	for (int i = 0; i < nparts; i++)
+	{
+		ClockSweepPartition *part = &StrategyControl->partitions[i].part;
+
+		SpinLockInit(&part->lock);
+		part->firstBuffer = (int) ((int64) NBuffers * i / nparts);
+		part->numBuffers = (int) ((int64) NBuffers * (i + 1) / nparts) -
+			part->firstBuffer;
+		part->numaNode = StrategyNumaNodes > 0 ?
+			i / StrategyControl->partitionsPerNode : -1;
+
+		/* Initialize the clock-sweep pointer */
+		pg_atomic_init_u32(&part->nextVictimBuffer, 0);
+
+		/* Clear statistics */
+		part->completePasses = 0;
+		pg_atomic_init_u64(&part->numBufferAllocs, 0);
+		part->prevBufferAllocs = 0;
+	}
 }
 
 
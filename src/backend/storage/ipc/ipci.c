@@ -16,6 +16,7 @@
 
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/pg_numa.h"
 #include "storage/dsm.h"
 #include "storage/ipc.h"
 #include "storage/lock.h"
@@ -141,6 +142,17 @@ CreateSharedMemoryAndSemaphores(void)
 	Assert(strcmp("unknown",
 				  GetConfigOption("huge_pages_status", false, false)) != 0);
 
+	/*
+	 * If requested, spread the segment over all NUMA nodes, so that it does
+	 * not all end up on the node the postmaster runs on.  The memory policy
+	 * only applies to pages not touched yet, so this has to happen before
+	 * the shared memory areas are initialized.  With shared_memory_numa =
+	 * partition, the buffer manager binds the buffer blocks to their nodes
+	 * afterwards.
+	 */
+	if (shared_memory_numa != SHMEM_NUMA_OFF && pg_numa_init() != -1)
+		pg_numa_interleave_memory(seghdr, seghdr->totalsize);
+
 	/*
 	 * Set up shared memory allocation mechanism
 	 */
@@ -47,6 +47,7 @@
 
 #include <signal.h>
 
+#include "access/csnlog.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
 #include "access/twophase.h"
@@ -100,6 +101,9 @@ typedef struct ProcArrayStruct
 	/* oldest catalog xmin of any replication slot */
 	TransactionId replication_slot_catalog_xmin;
 
+	/* allocated size of recentCompletions, zero without csn_snapshots */
+	int			maxRecentCompletions;
+
 	/* indexes into allProcs[], has PROCARRAY_MAXPROCS entries */
 	int			pgprocnos[FLEXIBLE_ARRAY_MEMBER];
 } ProcArrayStruct;
@@ -299,6 +303,22 @@ static bool *KnownAssignedXidsValid;
 
 static TransactionId latestObservedXid = InvalidTransactionId;
 
+/*
+ * With csn_snapshots, the top-level transactions that completed most
+ * recently, in a circular buffer indexed by commit sequence number.  This is
+ * what allows GetCSNSnapshotXids() to find the transactions that were still
+ * running when a CSN-based snapshot was taken without looking at every XID
+ * between its xmin and xmax.  Protected by ProcArrayLock, like the CSNs
+ * themselves.
+ */
+typedef struct RecentCompletion
+{
+	uint64		csn;			/* commit sequence number of xid */
+	TransactionId xid;
+} RecentCompletion;
+
+static RecentCompletion *recentCompletions;
+
 /*
  * If we're in STANDBY_SNAPSHOT_PENDING state, standbySnapshotPendingXmin is
  * the highest xid that might still be running that we don't have in
@@ -381,6 +401,7 @@ static inline void ProcArrayEndTransactionInternal(PGPROC *proc, TransactionId l
 static void ProcArrayGroupClearXid(PGPROC *proc, TransactionId latestXid);
 static void MaintainLatestCompletedXid(TransactionId latestXid);
 static void MaintainLatestCompletedXidRecovery(TransactionId latestXid);
+static void MaintainCommitSeqNo(TransactionId xid);
 
 static inline FullTransactionId FullXidRelativeTo(FullTransactionId rel,
 												  TransactionId xid);
@@ -410,6 +431,13 @@ ProcArrayShmemRequest(void *arg)
 #define TOTAL_MAX_CACHED_SUBXIDS \
 	((PGPROC_MAX_CACHED_SUBXIDS + 1) * PROCARRAY_MAXPROCS)
 
+	/*
+	 * The buffer of recently completed transactions covers a few rounds of
+	 * every backend completing a transaction, which is plenty for the
+	 * snapshots of pg_export_snapshot() and pg_current_snapshot().
+	 */
+#define NUM_RECENT_COMPLETIONS	(32 * PROCARRAY_MAXPROCS)
+
 	if (EnableHotStandby)
 	{
 		ShmemRequestStruct(.name = "KnownAssignedXids",
@@ -423,6 +451,12 @@ ProcArrayShmemRequest(void *arg)
 			);
 	}
 
+	if (csn_snapshots)
+		ShmemRequestStruct(.name = "Recent Completions",
+						   .size = mul_size(sizeof(RecentCompletion), NUM_RECENT_COMPLETIONS),
+						   .ptr = (void **) &recentCompletions,
+			);
+
 	/* Register the ProcArray shared structure */
 	ShmemRequestStruct(.name = "Proc Array",
 					   .size = add_size(offsetof(ProcArrayStruct, pgprocnos),
@@ -446,7 +480,13 @@ ProcArrayShmemInit(void *arg)
 	procArray->lastOverflowedXid = InvalidTransactionId;
 	procArray->replication_slot_xmin = InvalidTransactionId;
 	procArray->replication_slot_catalog_xmin = InvalidTransactionId;
+	procArray->maxRecentCompletions = csn_snapshots ? NUM_RECENT_COMPLETIONS : 0;
+	if (csn_snapshots)
+		memset(recentCompletions, 0,
+			   sizeof(RecentCompletion) * NUM_RECENT_COMPLETIONS);
 	TransamVariables->xactCompletionCount = 1;
+	TransamVariables->oldestActiveXid = InvalidTransactionId;
+	TransamVariables->csnHorizonXid = InvalidTransactionId;
 
 	allProcs = ProcGlobal->allProcs;
 }
@@ -581,7 +621,9 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 
 	if (TransactionIdIsValid(latestXid))
 	{
-		Assert(TransactionIdIsValid(ProcGlobal->xids[myoff]));
+		TransactionId xid = ProcGlobal->xids[myoff];
+
+		Assert(TransactionIdIsValid(xid));
 
 		/* Advance global latestCompletedXid while holding the lock */
 		MaintainLatestCompletedXid(latestXid);
@@ -590,6 +632,9 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 		TransamVariables->xactCompletionCount++;
 
 		ProcGlobal->xids[myoff] = InvalidTransactionId;
+
+		if (csn_snapshots)
+			MaintainCommitSeqNo(xid);
 		ProcGlobal->subxidStates[myoff].overflowed = false;
 		ProcGlobal->subxidStates[myoff].count = 0;
 	}
@@ -725,6 +770,7 @@ static inline void
 ProcArrayEndTransactionInternal(PGPROC *proc, TransactionId latestXid)
 {
 	int			pgxactoff = proc->pgxactoff;
+	TransactionId xid = proc->xid;
 
 	/*
 	 * Note: we need exclusive lock here because we're going to change other
@@ -732,7 +778,7 @@ ProcArrayEndTransactionInternal(PGPROC *proc, TransactionId latestXid)
 	 */
 	Assert(LWLockHeldByMeInMode(ProcArrayLock, LW_EXCLUSIVE));
 	Assert(TransactionIdIsValid(ProcGlobal->xids[pgxactoff]));
-	Assert(ProcGlobal->xids[pgxactoff] == proc->xid);
+	Assert(ProcGlobal->xids[pgxactoff] == xid);
 
 	ProcGlobal->xids[pgxactoff] = InvalidTransactionId;
 	proc->xid = InvalidTransactionId;
@@ -766,6 +812,9 @@ ProcArrayEndTransactionInternal(PGPROC *proc, TransactionId latestXid)
 
 	/* Same with xactCompletionCount  */
 	TransamVariables->xactCompletionCount++;
+
+	if (csn_snapshots)
+		MaintainCommitSeqNo(xid);
 }
 
 /*
@@ -973,6 +1022,77 @@ MaintainLatestCompletedXid(TransactionId latestXid)
 		   FullTransactionIdIsNormal(TransamVariables->latestCompletedXid));
 }
 
+/*
+ * Record the commit sequence number of a top-level transaction that has just
+ * been removed from the proc array, and keep oldestActiveXid up to date.
+ *
+ * Must be called after advancing xactCompletionCount, without releasing
+ * ProcArrayLock in between: any snapshot whose CSN is at least the new count
+ * considers the transaction completed, so the pg_csn entry must be in place
+ * before such a snapshot can be taken.
+ */
+static void
+MaintainCommitSeqNo(TransactionId xid)
+{
+	ProcArrayStruct *arrayP = procArray;
+	TransactionId oldest = TransamVariables->oldestActiveXid;
+	TransactionId horizon = TransamVariables->csnHorizonXid;
+	TransactionId *other_xids = ProcGlobal->xids;
+	uint8	   *allStatusFlags = ProcGlobal->statusFlags;
+	uint64		csn = TransamVariables->xactCompletionCount;
+	RecentCompletion *slot;
+
+	Assert(LWLockHeldByMeInMode(ProcArrayLock, LW_EXCLUSIVE));
+
+	/* pg_csn isn't set up while bootstrapping */
+	if (IsBootstrapProcessingMode())
+		return;
+
+	CSNLogSetCommitSeqNo(xid, csn);
+
+	slot = &recentCompletions[csn % arrayP->maxRecentCompletions];
+	slot->csn = csn;
+	slot->xid = xid;
+
+	/*
+	 * Unless it was the oldest running transaction that ended, the lower
+	 * bound stays valid.  Otherwise recompute it; that costs a scan of the
+	 * proc array, but only about once per as many transactions as are
+	 * running concurrently.
+	 */
+	if (TransactionIdIsValid(oldest) && !TransactionIdEquals(xid, oldest))
+		return;
+
+	oldest = XidFromFullTransactionId(TransamVariables->latestCompletedXid);
+	TransactionIdAdvance(oldest);
+
+	for (int pgxactoff = 0; pgxactoff < arrayP->numProcs; pgxactoff++)
+	{
+		/* Fetch xid just once - see GetNewTransactionId */
+		TransactionId other = UINT32_ACCESS_ONCE(other_xids[pgxactoff]);
+
+		if (!TransactionIdIsNormal(other))
+			continue;
+
+		/* Same backends as GetSnapshotData() leaves out of snapshots */
+		if (allStatusFlags[pgxactoff] &
+			(PROC_IN_LOGICAL_DECODING | PROC_IN_VACUUM))
+			continue;
+
+		if (NormalTransactionIdPrecedes(other, oldest))
+			oldest = other;
+	}
+
+	/*
+	 * Transactions prepared before the last restart have no pg_csn entries;
+	 * fall back to scanning snapshots until they are all gone.
+	 */
+	if (TransactionIdPrecedes(oldest, horizon))
+		oldest = InvalidTransactionId;
+
+	TransamVariables->oldestActiveXid = oldest;
+}
+
 /*
  * Same as MaintainLatestCompletedXid, except for use during WAL replay.
  */
@@ -1436,6 +1556,21 @@ TransactionIdIsInProgress(TransactionId xid)
 		return true;
 	}
 
+	/*
+	 * With csn_snapshots, a top-level transaction that has a commit sequence
+	 * number is known to be completed.  Transactions without one still need
+	 * the scan below, as do subtransactions.
+	 */
+	if (csn_snapshots &&
+		TransactionIdIsValid(TransamVariables->csnHorizonXid) &&
+		!TransactionIdPrecedes(xid, TransamVariables->csnHorizonXid) &&
+		CSNLogGetCommitSeqNo(xid) != InvalidCommitSeqNo)
+	{
+		xc_by_known_xact_inc();
+		cachedXidIsNotInProgress = xid;
+		return false;
+	}
+
 	/*
 	 * If first time through, get workspace to remember main XIDs in. We
 	 * malloc it permanently to avoid repeated palloc/pfree overhead.
@@ -2196,8 +2331,36 @@ GetSnapshotData(Snapshot snapshot)
 		xmin = myxid;
 
 	snapshot->takenDuringRecovery = RecoveryInProgress();
+	snapshot->csn = InvalidCommitSeqNo;
+
+	if (csn_snapshots && !snapshot->takenDuringRecovery &&
+		TransactionIdIsValid(TransamVariables->oldestActiveXid))
+	{
+		TransactionId oldest = TransamVariables->oldestActiveXid;
+
+		/*
+		 * With CSN-based snapshots, there's no need to look at the other
+		 * backends at all.  The completion count identifies the set of
+		 * transactions that have completed so far, see XidInMVCCSnapshot(),
+		 * and oldestActiveXid stands in for the xmin we would have computed
+		 * from the proc array.  It's never above xmax.
+		 */
+		if (NormalTransactionIdPrecedes(oldest, xmin))
+			xmin = oldest;
+
+		/*
+		 * Being only a lower bound, it can be older than the xmin we already
+		 * advertise, if an earlier snapshot of this transaction was built the
+		 * regular way.  Everything older than that is known to have
+		 * completed, and pg_subtrans may already be truncated there.
+		 */
+		if (TransactionIdIsValid(MyProc->xmin) &&
+			TransactionIdPrecedes(xmin, TransactionXmin))
+			xmin = TransactionXmin;
 
-	if (!snapshot->takenDuringRecovery)
+		snapshot->csn = curXactCompletionCount;
+	}
+	else if (!snapshot->takenDuringRecovery)
 	{
 		int			numProcs = arrayP->numProcs;
 		TransactionId *xip = snapshot->xip;
@@ -2457,6 +2620,112 @@ GetSnapshotData(Snapshot snapshot)
 	return snapshot;
 }
 
+/*
+ * Add xid to the array being built by GetCSNSnapshotXids().
+ */
+static inline void
+AddCSNSnapshotXid(TransactionId *xip, int *count, TransactionId xid)
+{
+	if (*count >= procArray->maxProcs)
+		elog(ERROR, "too many running transactions in CSN-based snapshot");
+	xip[(*count)++] = xid;
+}
+
+/*
+ * GetCSNSnapshotXids -- list the XIDs a CSN-based snapshot considers running
+ *
+ * Stores the top-level XIDs, other than our own, of the transactions that
+ * were running when the snapshot was taken into xip[], which must have room
+ * for GetMaxSnapshotXidCount() entries, and returns their number.  This is
+ * for MaterializeSnapshot().
+ *
+ * Those transactions are either still running, and thus found in the proc
+ * array, or they completed after the snapshot was taken, and are found in
+ * the buffer of recent completions.  Only if that buffer no longer covers
+ * all of them do we have to look up the CSNs of all the XIDs between xmin
+ * and xmax.
+ */
+int
+GetCSNSnapshotXids(Snapshot snapshot, TransactionId *xip)
+{
+	ProcArrayStruct *arrayP = procArray;
+	TransactionId *other_xids = ProcGlobal->xids;
+	TransactionId myxid = MyProc->xid;
+	uint64		curcsn;
+	int			count = 0;
+
+	Assert(snapshot->csn != InvalidCommitSeqNo);
+
+	LWLockAcquire(ProcArrayLock, LW_SHARED);
+
+	for (int pgxactoff = 0; pgxactoff < arrayP->numProcs; pgxactoff++)
+	{
+		/* Fetch xid just once - see GetNewTransactionId */
+		TransactionId xid = UINT32_ACCESS_ONCE(other_xids[pgxactoff]);
+
+		/* Like GetSnapshotData(), leave out our own XID */
+		if (!TransactionIdIsNormal(xid) || TransactionIdEquals(xid, myxid))
+			continue;
+
+		/*
+		 * Transactions at or above xmax are running as far as the snapshot
+		 * is concerned without being listed, and none below xmin can be.
+		 */
+		if (TransactionIdPrecedes(xid, snapshot->xmin) ||
+			TransactionIdFollowsOrEquals(xid, snapshot->xmax))
+			continue;
+
+		AddCSNSnapshotXid(xip, &count, xid);
+	}
+
+	/*
+	 * Completions can't happen while we hold the lock, so every slot for a
+	 * CSN between the snapshot's and the current one is either in use for
+	 * it, or for no transaction at all, as with a PREPARE TRANSACTION.
+	 */
+	curcsn = TransamVariables->xactCompletionCount;
+
+	if (curcsn - snapshot->csn <= (uint64) arrayP->maxRecentCompletions)
+	{
+		for (uint64 csn = snapshot->csn + 1; csn <= curcsn; csn++)
+		{
+			RecentCompletion *slot;
+
+			slot = &recentCompletions[csn % arrayP->maxRecentCompletions];
+			if (slot->csn != csn ||
+				TransactionIdPrecedes(slot->xid, snapshot->xmin) ||
+				TransactionIdFollowsOrEquals(slot->xid, snapshot->xmax))
+				continue;
+
+			AddCSNSnapshotXid(xip, &count, slot->xid);
+		}
+
+		LWLockRelease(ProcArrayLock);
+		return count;
+	}
+
+	LWLockRelease(ProcArrayLock);
+
+	/*
+	 * The snapshot is too old for the buffer, so go through pg_csn.  Only
+	 * top-level transactions have entries.  The ones that completed after we
+	 * looked at the proc array have CSNs above curcsn, and we already have
+	 * them.
+	 */
+	for (TransactionId xid = snapshot->xmin;
+		 TransactionIdPrecedes(xid, snapshot->xmax);)
+	{
+		uint64		csn = CSNLogGetCommitSeqNo(xid);
+
+		if (csn > snapshot->csn && csn <= curcsn)
+			AddCSNSnapshotXid(xip, &count, xid);
+
+		TransactionIdAdvance(xid);
+	}
+
+	return count;
+}
+
 /*
  * ProcArrayInstallImportedXmin -- install imported xmin into MyProc->xmin
  *
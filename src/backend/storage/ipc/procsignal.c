@@ -231,6 +231,28 @@ ProcSignalInit(const uint8 *cancel_key, int cancel_key_len)
 	on_shmem_exit(CleanupProcSignalState, (Datum) 0);
 }
 
+/*
+ * ProcSignalSetCancelKey
+ *		Change the cancel key advertised for the current process
+ *
+ * Used by session pooling, where the key that a cancel request has to carry
+ * is that of the client session the backend is serving at the moment.
+ */
+void
+ProcSignalSetCancelKey(const uint8 *cancel_key, int cancel_key_len)
+{
+	ProcSignalSlot *slot = MyProcSignalSlot;
+
+	Assert(cancel_key_len >= 0 && cancel_key_len <= MAX_CANCEL_KEY_LENGTH);
+	Assert(slot != NULL);
+
+	SpinLockAcquire(&slot->pss_mutex);
+	if (cancel_key_len > 0)
+		memcpy(slot->pss_cancel_key, cancel_key, cancel_key_len);
+	slot->pss_cancel_key_len = cancel_key_len;
+	SpinLockRelease(&slot->pss_mutex);
+}
+
 /*
  * CleanupProcSignalState
  *		Remove current process from ProcSignal mechanism
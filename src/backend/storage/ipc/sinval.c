@@ -19,6 +19,8 @@
 #include "storage/latch.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 
 
 uint64		SharedInvalidMessageCounter;
@@ -46,7 +48,9 @@ volatile sig_atomic_t catchupInterruptPending = false;
 void
 SendSharedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
 {
+	SharedCatCacheInvalidate(msgs, n);
 	SIInsertDataEntries(msgs, n);
+	SharedPlanCacheInvalidate(msgs, n);
 }
 
 /*
@@ -193,6 +193,7 @@
 
 #include "postgres.h"
 
+#include "access/csnlog.h"
 #include "access/parallel.h"
 #include "access/slru.h"
 #include "access/transam.h"
@@ -3913,6 +3914,10 @@ XidIsConcurrent(TransactionId xid)
 	if (TransactionIdFollowsOrEquals(xid, snap->xmax))
 		return true;
 
+	/* A CSN-based snapshot has no xip array to search */
+	if (snap->csn != InvalidCommitSeqNo)
+		return XidInMVCCSnapshot(xid, snap);
+
 	return pg_lfind32(xid, snap->xip, snap->xcnt);
 }
 
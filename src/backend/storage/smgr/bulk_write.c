@@ -9,12 +9,13 @@
  * unless explicitly written to.  Do not mix operations through the regular
  * buffer manager and the bulk loading interface!
  *
- * We bypass the buffer manager to avoid the locking overhead, and call
- * smgrextend() directly.  A downside is that the pages will need to be
- * re-read into shared buffers on first use after the build finishes.  That's
- * usually a good tradeoff for large relations, and for small relations, the
- * overhead isn't very significant compared to creating the relation in the
- * first place.
+ * We bypass the buffer manager to avoid the locking overhead, and write the
+ * pages out through a write stream, which combines writes of consecutive
+ * blocks and performs them asynchronously.  A downside is that the pages
+ * will need to be re-read into shared buffers on first use after the build
+ * finishes.  That's usually a good tradeoff for large relations, and for
+ * small relations, the overhead isn't very significant compared to creating
+ * the relation in the first place.
  *
  * The pages are WAL-logged if needed.  To save on WAL header overhead, we
  * WAL-log several pages in one record.
@@ -38,16 +39,16 @@
 
 #include "access/xloginsert.h"
 #include "access/xlogrecord.h"
+#include "executor/instrument_node.h"
 #include "storage/bufpage.h"
 #include "storage/bulk_write.h"
 #include "storage/proc.h"
 #include "storage/smgr.h"
+#include "storage/write_stream.h"
 #include "utils/rel.h"
 
 #define MAX_PENDING_WRITES XLR_MAX_BLOCK_ID
 
-static const PGIOAlignedBlock zero_buffer = {0};	/* worth BLCKSZ */
-
 typedef struct PendingWrite
 {
 	BulkWriteBuffer buf;
@@ -69,13 +70,12 @@ struct BulkWriteState
 	int			npending;
 	PendingWrite pending_writes[MAX_PENDING_WRITES];
 
-	/* Current size of the relation */
-	BlockNumber relsize;
+	/* Stream performing the writes, after they have been WAL-logged */
+	WriteStream *stream;
+	IOStats		stats;
 
 	/* The RedoRecPtr at the time that the bulk operation started */
 	XLogRecPtr	start_RedoRecPtr;
-
-	MemoryContext memcxt;
 };
 
 static void smgr_bulk_flush(BulkWriteState *bulkstate);
@@ -107,15 +107,17 @@ smgr_bulk_start_smgr(SMgrRelation smgr, ForkNumber forknum, bool use_wal)
 	state->use_wal = use_wal;
 
 	state->npending = 0;
-	state->relsize = smgrnblocks(smgr, forknum);
-
-	state->start_RedoRecPtr = GetRedoRecPtr();
 
 	/*
-	 * Remember the memory context.  We will use it to allocate all the
-	 * buffers later.
+	 * The stream also allocates all the buffers later, in the current memory
+	 * context.
 	 */
-	state->memcxt = CurrentMemoryContext;
+	state->stream = write_stream_begin_smgr_relation(WRITE_STREAM_MAINTENANCE,
+													 smgr, forknum);
+	memset(&state->stats, 0, sizeof(IOStats));
+	write_stream_enable_stats(state->stream, &state->stats);
+
+	state->start_RedoRecPtr = GetRedoRecPtr();
 
 	return state;
 }
@@ -129,8 +131,20 @@ smgr_bulk_start_smgr(SMgrRelation smgr, ForkNumber forknum, bool use_wal)
 void
 smgr_bulk_finish(BulkWriteState *bulkstate)
 {
-	/* WAL-log and flush any remaining pages */
+	/* WAL-log and flush any remaining pages, and wait for the writes */
 	smgr_bulk_flush(bulkstate);
+	write_stream_end(bulkstate->stream);
+	bulkstate->stream = NULL;
+
+	if (bulkstate->stats.io_count > 0)
+		elog(DEBUG2, "bulk write of \"%s\": %" PRIu64 " pages in %" PRIu64 " writes, average queue depth %.2f (max %d), %" PRIu64 " waits",
+			 relpath(bulkstate->smgr->smgr_rlocator, bulkstate->forknum).str,
+			 bulkstate->stats.write_count,
+			 bulkstate->stats.io_count,
+			 bulkstate->stats.write_queued_sum * 1.0 /
+			 Max(1, bulkstate->stats.write_count),
+			 bulkstate->stats.write_queued_max,
+			 bulkstate->stats.wait_count);
 
 	/*
 	 * Fsync the relation, or register it for the next checkpoint, if
@@ -274,38 +288,19 @@ smgr_bulk_flush(BulkWriteState *bulkstate)
 					 npending, blknos, pages, page_std);
 	}
 
+	/*
+	 * Hand the pages over to the write stream, in block number order so that
+	 * it can combine them.  If we have to write pages nonsequentially, the
+	 * stream fills in the space with zeroes until we come back and overwrite.
+	 * The dummy pages aren't WAL-logged.
+	 */
 	for (int i = 0; i < npending; i++)
 	{
 		BlockNumber blkno = pending_writes[i].blkno;
-		Page		page = pending_writes[i].buf->data;
-
-		PageSetChecksum(page, blkno);
+		BulkWriteBuffer buf = pending_writes[i].buf;
 
-		if (blkno >= bulkstate->relsize)
-		{
-			/*
-			 * If we have to write pages nonsequentially, fill in the space
-			 * with zeroes until we come back and overwrite.  This is not
-			 * logically necessary on standard Unix filesystems (unwritten
-			 * space will read as zeroes anyway), but it should help to avoid
-			 * fragmentation.  The dummy pages aren't WAL-logged though.
-			 */
-			while (blkno > bulkstate->relsize)
-			{
-				/* don't set checksum for all-zero page */
-				smgrextend(bulkstate->smgr, bulkstate->forknum,
-						   bulkstate->relsize,
-						   &zero_buffer,
-						   true);
-				bulkstate->relsize++;
-			}
-
-			smgrextend(bulkstate->smgr, bulkstate->forknum, blkno, page, true);
-			bulkstate->relsize++;
-		}
-		else
-			smgrwrite(bulkstate->smgr, bulkstate->forknum, blkno, page, true);
-		pfree(page);
+		PageSetChecksum(buf->data, blkno);
+		write_stream_write(bulkstate->stream, blkno, buf);
 	}
 
 	bulkstate->npending = 0;
@@ -340,11 +335,11 @@ smgr_bulk_write(BulkWriteState *bulkstate, BlockNumber blocknum, BulkWriteBuffer
  * smgr_bulk_write(), it takes ownership and frees it when it's no longer
  * needed.
  *
- * This is currently implemented as a simple palloc, but could be implemented
- * using a ring buffer or larger chunks in the future, so don't rely on it.
+ * The memory of buffers that have already been written out is recycled, so
+ * don't hold on to a buffer after passing it to smgr_bulk_write().
  */
 BulkWriteBuffer
 smgr_bulk_get_buf(BulkWriteState *bulkstate)
 {
-	return MemoryContextAllocAligned(bulkstate->memcxt, BLCKSZ, PG_IO_ALIGN_SIZE, 0);
+	return write_stream_get_buf(bulkstate->stream);
 }
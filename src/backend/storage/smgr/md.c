@@ -35,10 +35,12 @@
 #include "storage/aio.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
+#include "storage/lwlock.h"
 #include "storage/md.h"
 #include "storage/relfilelocator.h"
 #include "storage/smgr.h"
 #include "storage/sync.h"
+#include "utils/injection_point.h"
 #include "utils/memutils.h"
 #include "utils/wait_event.h"
 
@@ -141,6 +143,27 @@ typedef struct MdPathStr
 	char		str[MD_PATH_STR_MAXLEN + 1];
 } MdPathStr;
 
+/*
+ * The address map of a compressed fork is handled like a segment with this
+ * number, which no actual segment can have, when registering sync requests
+ * and building its path.
+ */
+#define MD_PCMAP_SEGNO		InvalidBlockNumber
+
+StaticAssertDecl(sizeof(PAGE_COMPRESS_MAP_SUFFIX) <= sizeof((char) '.') + SEGMENT_CHARS + 1,
+				 "PAGE_COMPRESS_MAP_SUFFIX does not fit in MdPathStr");
+
+/* Is this fork, which must be open, stored compressed? */
+#define MD_FORK_IS_COMPRESSED(reln, forknum) \
+	((forknum) == MAIN_FORKNUM && (reln)->md_pcmap_vfd >= 0)
+
+/*
+ * cb_data flag of the AIO callbacks, set when mdstartreadv() or
+ * mdstartwritev() already transferred the data of a compressed fork, and the
+ * IO only serves to complete the handle.
+ */
+#define MD_CB_TRANSFERRED	0x01
+
 
 /* local routines */
 static void mdunlinkfork(RelFileLocatorBackend rlocator, ForkNumber forknum,
@@ -163,6 +186,22 @@ static MdfdVec *_mdfd_getseg(SMgrRelation reln, ForkNumber forknum,
 							 BlockNumber blkno, bool skipFsync, int behavior);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum,
 							  MdfdVec *seg);
+static File _mdpc_open(SMgrRelation reln, const char *path, File datafd);
+static bool _mdpc_fork(SMgrRelation reln, ForkNumber forknum, int behavior);
+static void _mdpc_read_header(SMgrRelation reln, PageCompressHeader *hdr);
+static void _mdpc_write_header(SMgrRelation reln, PageCompressHeader *hdr);
+static void _mdpc_readv(SMgrRelation reln, BlockNumber blocknum,
+						void **buffers, BlockNumber nblocks);
+static void _mdpc_write(SMgrRelation reln, BlockNumber blocknum,
+						const void *buffer, bool extend);
+static void _mdpc_zeroextend(SMgrRelation reln, BlockNumber blocknum,
+							 int nblocks);
+static void _mdpc_truncate(SMgrRelation reln, BlockNumber nblocks);
+static void _mdpc_register_dirty(SMgrRelation reln);
+static void _mdpc_start_io(PgAioHandle *ioh, SMgrRelation reln,
+						   ForkNumber forknum, BlockNumber blocknum,
+						   BlockNumber nblocks, void *buffer,
+						   bool skipFsync, bool is_write);
 
 static PgAioResult md_readv_complete(PgAioHandle *ioh, PgAioResult prior_result, uint8 cb_data);
 static void md_readv_report(PgAioResult result, const PgAioTargetData *td, int elevel);
@@ -172,6 +211,14 @@ const PgAioHandleCallbacks aio_md_readv_cb = {
 	.report = md_readv_report,
 };
 
+static PgAioResult md_writev_complete(PgAioHandle *ioh, PgAioResult prior_result, uint8 cb_data);
+static void md_writev_report(PgAioResult result, const PgAioTargetData *td, int elevel);
+
+const PgAioHandleCallbacks aio_md_writev_cb = {
+	.complete_shared = md_writev_complete,
+	.report = md_writev_report,
+};
+
 
 static inline int
 _mdfd_open_flags(void)
@@ -264,6 +311,18 @@ mdcreate(SMgrRelation reln, ForkNumber forknum, bool isRedo)
 		}
 	}
 
+	/*
+	 * A new main fork is not compressed.  In redo, the file may be left over
+	 * from before a crash, along with its address map, though.
+	 */
+	if (forknum == MAIN_FORKNUM)
+	{
+		reln->md_pcmap_vfd = -1;
+		reln->md_pc_method = PAGE_COMPRESSION_NONE;
+		if (isRedo && !SmgrIsTemp(reln))
+			fd = _mdpc_open(reln, path.str, fd);
+	}
+
 	_fdvec_resize(reln, forknum, 1);
 	mdfd = &reln->md_seg_fds[forknum][0];
 	mdfd->mdfd_vfd = fd;
@@ -380,6 +439,27 @@ mdunlinkfork(RelFileLocatorBackend rlocator, ForkNumber forknum, bool isRedo)
 
 	path = relpath(rlocator, forknum);
 
+	/*
+	 * The address map of a compressed fork is not needed to prevent the
+	 * relfilenumber from being recycled, so remove it right away.
+	 */
+	if (forknum == MAIN_FORKNUM && !RelFileLocatorBackendIsTemp(rlocator))
+	{
+		MdPathStr	mappath;
+
+		sprintf(mappath.str, "%s%s", path.str, PAGE_COMPRESS_MAP_SUFFIX);
+
+		if (do_truncate(mappath.str) == 0)
+		{
+			register_forget_request(rlocator, forknum, MD_PCMAP_SEGNO);
+
+			if (unlink(mappath.str) < 0 && errno != ENOENT)
+				ereport(WARNING,
+						(errcode_for_file_access(),
+						 errmsg("could not remove file \"%s\": %m", mappath.str)));
+		}
+	}
+
 	/*
 	 * Truncate and then unlink the first segment, or just register a request
 	 * to unlink it later, as described in the comments for mdunlink().
@@ -514,6 +594,14 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 						relpath(reln->smgr_rlocator, forknum).str,
 						InvalidBlockNumber)));
 
+	if (_mdpc_fork(reln, forknum, EXTENSION_CREATE))
+	{
+		_mdpc_write(reln, blocknum, buffer, true);
+		if (!skipFsync)
+			_mdpc_register_dirty(reln);
+		return;
+	}
+
 	v = _mdfd_getseg(reln, forknum, blocknum, skipFsync, EXTENSION_CREATE);
 
 	seekpos = (pgoff_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
@@ -576,6 +664,15 @@ mdzeroextend(SMgrRelation reln, ForkNumber forknum,
 						relpath(reln->smgr_rlocator, forknum).str,
 						InvalidBlockNumber)));
 
+	/* Zeroed pages of a compressed fork take no storage */
+	if (_mdpc_fork(reln, forknum, EXTENSION_CREATE))
+	{
+		_mdpc_zeroextend(reln, blocknum, nblocks);
+		if (!skipFsync)
+			_mdpc_register_dirty(reln);
+		return;
+	}
+
 	while (remblocks > 0)
 	{
 		BlockNumber segstartblock = curblocknum % ((BlockNumber) RELSEG_SIZE);
@@ -697,12 +794,17 @@ mdopenfork(SMgrRelation reln, ForkNumber forknum, int behavior)
 				 errmsg("could not open file \"%s\": %m", path.str)));
 	}
 
+	if (forknum == MAIN_FORKNUM && !SmgrIsTemp(reln))
+		fd = _mdpc_open(reln, path.str, fd);
+
 	_fdvec_resize(reln, forknum, 1);
 	mdfd = &reln->md_seg_fds[forknum][0];
 	mdfd->mdfd_vfd = fd;
 	mdfd->mdfd_segno = 0;
 
-	Assert(_mdnblocks(reln, forknum, mdfd) <= ((BlockNumber) RELSEG_SIZE));
+	/* the data file of a compressed fork is not limited to RELSEG_SIZE */
+	Assert(MD_FORK_IS_COMPRESSED(reln, forknum) ||
+		   _mdnblocks(reln, forknum, mdfd) <= ((BlockNumber) RELSEG_SIZE));
 
 	return mdfd;
 }
@@ -716,6 +818,8 @@ mdopen(SMgrRelation reln)
 	/* mark it not open */
 	for (int forknum = 0; forknum <= MAX_FORKNUM; forknum++)
 		reln->md_num_open_segs[forknum] = 0;
+	reln->md_pcmap_vfd = -1;
+	reln->md_pc_method = PAGE_COMPRESSION_NONE;
 }
 
 /*
@@ -730,6 +834,13 @@ mdclose(SMgrRelation reln, ForkNumber forknum)
 	if (nopensegs == 0)
 		return;
 
+	if (MD_FORK_IS_COMPRESSED(reln, forknum))
+	{
+		FileClose(reln->md_pcmap_vfd);
+		reln->md_pcmap_vfd = -1;
+		reln->md_pc_method = PAGE_COMPRESSION_NONE;
+	}
+
 	/* close segments starting from the end */
 	while (nopensegs > 0)
 	{
@@ -755,6 +866,14 @@ mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	if ((uint64) blocknum + nblocks > (uint64) MaxBlockNumber + 1)
 		return false;
 
+	/*
+	 * The location of the pages of a compressed fork is only known after
+	 * reading its address map, which isn't worth it just for a hint.
+	 */
+	if (_mdpc_fork(reln, forknum,
+				   InRecovery ? EXTENSION_RETURN_NULL : EXTENSION_FAIL))
+		return true;
+
 	while (nblocks > 0)
 	{
 		pgoff_t		seekpos;
@@ -859,6 +978,12 @@ void
 mdreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		void **buffers, BlockNumber nblocks)
 {
+	if (_mdpc_fork(reln, forknum, EXTENSION_FAIL))
+	{
+		_mdpc_readv(reln, blocknum, buffers, nblocks);
+		return;
+	}
+
 	while (nblocks > 0)
 	{
 		struct iovec iov[PG_IOV_MAX];
@@ -1005,6 +1130,19 @@ mdstartreadv(PgAioHandle *ioh,
 	int			iovcnt;
 	int			ret;
 
+	/*
+	 * Pages of a compressed fork have to be decompressed into the buffers,
+	 * so read them synchronously here.  The IO then only completes the
+	 * handle.
+	 */
+	if (_mdpc_fork(reln, forknum, EXTENSION_FAIL))
+	{
+		_mdpc_readv(reln, blocknum, buffers, nblocks);
+		_mdpc_start_io(ioh, reln, forknum, blocknum, nblocks, buffers[0],
+					   false, false);
+		return;
+	}
+
 	v = _mdfd_getseg(reln, forknum, blocknum, false,
 					 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
 
@@ -1076,6 +1214,15 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	Assert((uint64) blocknum + (uint64) nblocks <= (uint64) mdnblocks(reln, forknum));
 #endif
 
+	if (_mdpc_fork(reln, forknum, EXTENSION_FAIL))
+	{
+		for (BlockNumber i = 0; i < nblocks; i++)
+			_mdpc_write(reln, blocknum + i, buffers[i], false);
+		if (!skipFsync)
+			_mdpc_register_dirty(reln);
+		return;
+	}
+
 	while (nblocks > 0)
 	{
 		struct iovec iov[PG_IOV_MAX];
@@ -1165,6 +1312,97 @@ mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	}
 }
 
+/*
+ * mdstartwritev() -- Asynchronous version of mdwritev().
+ *
+ * In contrast to mdwritev(), the segment is registered for fsync before the
+ * write has been executed, see smgrstartwritev() for why that's OK.
+ */
+void
+mdstartwritev(PgAioHandle *ioh,
+			  SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+			  const void **buffers, BlockNumber nblocks, bool skipFsync)
+{
+	pgoff_t		seekpos;
+	MdfdVec    *v;
+	BlockNumber nblocks_this_segment;
+	struct iovec *iov;
+	int			iovcnt;
+	int			ret;
+
+	/* This assert is too expensive to have on normally ... */
+#ifdef CHECK_WRITE_VS_EXTEND
+	Assert((uint64) blocknum + (uint64) nblocks <= (uint64) mdnblocks(reln, forknum));
+#endif
+
+	/*
+	 * Pages of a compressed fork are written synchronously, as for reads, see
+	 * mdstartreadv().
+	 */
+	if (_mdpc_fork(reln, forknum, EXTENSION_FAIL))
+	{
+		for (BlockNumber i = 0; i < nblocks; i++)
+			_mdpc_write(reln, blocknum + i, buffers[i], false);
+		if (!skipFsync)
+			_mdpc_register_dirty(reln);
+		_mdpc_start_io(ioh, reln, forknum, blocknum, nblocks,
+					   unconstify(void *, buffers[0]), skipFsync, true);
+		return;
+	}
+
+	v = _mdfd_getseg(reln, forknum, blocknum, skipFsync,
+					 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+	seekpos = (pgoff_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+
+	Assert(seekpos < (pgoff_t) BLCKSZ * RELSEG_SIZE);
+
+	nblocks_this_segment =
+		Min(nblocks,
+			RELSEG_SIZE - (blocknum % ((BlockNumber) RELSEG_SIZE)));
+
+	if (nblocks_this_segment != nblocks)
+		elog(ERROR, "write crossing segment boundary");
+
+	iovcnt = pgaio_io_get_iovec(ioh, &iov);
+
+	Assert(nblocks <= iovcnt);
+
+	iovcnt = buffers_to_iovec(iov, (void **) buffers, nblocks_this_segment);
+
+	Assert(iovcnt <= nblocks_this_segment);
+
+	if (!(io_direct_flags & IO_DIRECT_DATA))
+		pgaio_io_set_flag(ioh, PGAIO_HF_BUFFERED);
+
+	pgaio_io_set_target_smgr(ioh,
+							 reln,
+							 forknum,
+							 blocknum,
+							 nblocks,
+							 skipFsync);
+	pgaio_io_register_callbacks(ioh, PGAIO_HCB_MD_WRITEV, 0);
+
+	if (!skipFsync && !SmgrIsTemp(reln))
+		register_dirty_segment(reln, forknum, v);
+
+	ret = FileStartWriteV(ioh, v->mdfd_vfd, iovcnt, seekpos, WAIT_EVENT_DATA_FILE_WRITE);
+	if (ret != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not start writing blocks %u..%u in file \"%s\": %m",
+						blocknum,
+						blocknum + nblocks_this_segment - 1,
+						FilePathName(v->mdfd_vfd))));
+
+	/*
+	 * The error checks corresponding to the post-write checks in mdwritev()
+	 * are in md_writev_complete().  Short writes are not retried here, they
+	 * are reported as a partial result and need to be re-issued by the
+	 * caller.
+	 */
+}
+
 
 /*
  * mdwriteback() -- Tell the kernel to write pages back to storage.
@@ -1178,6 +1416,10 @@ mdwriteback(SMgrRelation reln, ForkNumber forknum,
 {
 	Assert((io_direct_flags & IO_DIRECT_DATA) == 0);
 
+	/* Pages of compressed forks are not at predictable offsets; skip them */
+	if (_mdpc_fork(reln, forknum, EXTENSION_DONT_OPEN))
+		return;
+
 	/*
 	 * Issue flush requests in as few requests as possible; have to split at
 	 * segment boundaries though, since those are actually separate files.
@@ -1243,6 +1485,15 @@ mdnblocks(SMgrRelation reln, ForkNumber forknum)
 	/* mdopen has opened the first segment */
 	Assert(reln->md_num_open_segs[forknum] > 0);
 
+	/* The size of a compressed fork is kept in its address map */
+	if (MD_FORK_IS_COMPRESSED(reln, forknum))
+	{
+		PageCompressHeader hdr;
+
+		_mdpc_read_header(reln, &hdr);
+		return hdr.nblocks;
+	}
+
 	/*
 	 * Start from the last open segments, to avoid redundant seeks.  We have
 	 * previously verified that these segments are exactly RELSEG_SIZE long,
@@ -1318,6 +1569,12 @@ mdtruncate(SMgrRelation reln, ForkNumber forknum,
 	if (nblocks == curnblk)
 		return;					/* no work */
 
+	if (MD_FORK_IS_COMPRESSED(reln, forknum))
+	{
+		_mdpc_truncate(reln, nblocks);
+		return;
+	}
+
 	/*
 	 * Truncate segments, starting at the last one. Starting at the end makes
 	 * managing the memory for the fd array easier, should there be errors.
@@ -1425,6 +1682,9 @@ mdregistersync(SMgrRelation reln, ForkNumber forknum)
 
 		segno--;
 	}
+
+	if (MD_FORK_IS_COMPRESSED(reln, forknum))
+		_mdpc_register_dirty(reln);
 }
 
 /*
@@ -1489,6 +1749,118 @@ mdimmedsync(SMgrRelation reln, ForkNumber forknum)
 
 		segno--;
 	}
+
+	if (MD_FORK_IS_COMPRESSED(reln, forknum) &&
+		FileSync(reln->md_pcmap_vfd, WAIT_EVENT_DATA_FILE_IMMEDIATE_SYNC) < 0)
+		ereport(data_sync_elevel(ERROR),
+				(errcode_for_file_access(),
+				 errmsg("could not fsync file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd))));
+}
+
+/*
+ * mdsetcompression() -- Set the page compression method of a fork.
+ *
+ * Only the main fork of permanent relations can be compressed.  The fork
+ * must be empty, except in redo, where whatever it contains is left over from
+ * before a crash and will be rewritten by the following WAL records.
+ */
+void
+mdsetcompression(SMgrRelation reln, ForkNumber forknum,
+				 PageCompressionMethod method, bool isRedo)
+{
+	MdfdVec    *v;
+	MdPathStr	mappath;
+
+	Assert(forknum == MAIN_FORKNUM);
+	Assert(!SmgrIsTemp(reln));
+
+	CheckPageCompressionSupported(method);
+
+	v = mdopenfork(reln, forknum, EXTENSION_FAIL);
+
+	/*
+	 * In redo, the fork may have been set up and filled already before a
+	 * crash.  Its contents are then kept, as for mdcreate(): they may have
+	 * been synced at commit instead of WAL-logged.
+	 */
+	if (reln->md_pc_method == method)
+		return;
+
+	if (!isRedo && mdnblocks(reln, forknum) != 0)
+		elog(ERROR, "cannot change the page compression of non-empty file \"%s\"",
+			 FilePathName(v->mdfd_vfd));
+
+	if (FileTruncate(v->mdfd_vfd, 0, WAIT_EVENT_DATA_FILE_TRUNCATE) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not truncate file \"%s\": %m",
+						FilePathName(v->mdfd_vfd))));
+	register_dirty_segment(reln, forknum, v);
+
+	/* The fork is reopened below, to notice the change */
+	mdclose(reln, forknum);
+
+	mappath = _mdfd_segpath(reln, forknum, MD_PCMAP_SEGNO);
+
+	if (method == PAGE_COMPRESSION_NONE)
+	{
+		register_forget_request(reln->smgr_rlocator, forknum, MD_PCMAP_SEGNO);
+		if (unlink(mappath.str) < 0 && errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not remove file \"%s\": %m", mappath.str)));
+	}
+	else
+	{
+		PageCompressHeader hdr;
+		MdfdVec		map;
+		int			nbytes;
+
+		map.mdfd_vfd = PathNameOpenFile(mappath.str,
+										O_RDWR | O_CREAT | O_TRUNC | PG_BINARY);
+		if (map.mdfd_vfd < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not create file \"%s\": %m", mappath.str)));
+		map.mdfd_segno = MD_PCMAP_SEGNO;
+
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.magic = PAGE_COMPRESS_MAGIC;
+		hdr.version = PAGE_COMPRESS_VERSION;
+		hdr.method = method;
+		hdr.chunk_size = PC_CHUNK_SIZE;
+		hdr.nblocks = 0;
+
+		nbytes = FileWrite(map.mdfd_vfd, &hdr, sizeof(hdr), 0,
+						   WAIT_EVENT_DATA_FILE_WRITE);
+		if (nbytes != sizeof(hdr))
+		{
+			if (nbytes >= 0)
+				errno = ENOSPC;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write file \"%s\": %m", mappath.str)));
+		}
+
+		register_dirty_segment(reln, forknum, &map);
+		FileClose(map.mdfd_vfd);
+	}
+
+	mdopenfork(reln, forknum, EXTENSION_FAIL);
+	Assert(reln->md_pc_method == method);
+}
+
+/*
+ * mdgetcompression() -- Get the page compression method of a fork.
+ */
+PageCompressionMethod
+mdgetcompression(SMgrRelation reln, ForkNumber forknum)
+{
+	if (!_mdpc_fork(reln, forknum, EXTENSION_RETURN_NULL))
+		return PAGE_COMPRESSION_NONE;
+
+	return reln->md_pc_method;
 }
 
 int
@@ -1496,6 +1868,9 @@ mdfd(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, uint32 *off)
 {
 	MdfdVec    *v = mdopenfork(reln, forknum, EXTENSION_FAIL);
 
+	/* IOs on compressed forks are always executed synchronously */
+	Assert(!MD_FORK_IS_COMPRESSED(reln, forknum));
+
 	v = _mdfd_getseg(reln, forknum, blocknum, false,
 					 EXTENSION_FAIL);
 
@@ -1696,7 +2071,9 @@ _mdfd_segpath(SMgrRelation reln, ForkNumber forknum, BlockNumber segno)
 
 	path = relpath(reln->smgr_rlocator, forknum);
 
-	if (segno > 0)
+	if (segno == MD_PCMAP_SEGNO)
+		sprintf(fullpath.str, "%s%s", path.str, PAGE_COMPRESS_MAP_SUFFIX);
+	else if (segno > 0)
 		sprintf(fullpath.str, "%s.%u", path.str, segno);
 	else
 		strcpy(fullpath.str, path.str);
@@ -1896,71 +2273,639 @@ _mdnblocks(SMgrRelation reln, ForkNumber forknum, MdfdVec *seg)
 }
 
 /*
- * Sync a file to disk, given a file tag.  Write the path into an output
- * buffer so the caller can use it in error messages.
+ * Open the address map of a main fork, if it is compressed, and set up the
+ * page compression fields of reln accordingly.  datafd is the just opened
+ * data file, and the data file to use is returned.
  *
- * Return 0 on success, -1 on failure, with errno set.
+ * Pages of compressed forks are not read and written at aligned offsets, so
+ * their data file is reopened without direct I/O if that is in use.
  */
-int
-mdsyncfiletag(const FileTag *ftag, char *path)
+static File
+_mdpc_open(SMgrRelation reln, const char *path, File datafd)
 {
-	SMgrRelation reln = smgropen(ftag->rlocator, INVALID_PROC_NUMBER);
-	File		file;
-	instr_time	io_start;
-	bool		need_to_close;
-	int			result,
-				save_errno;
+	MdPathStr	mappath;
+	File		mapfd;
+	PageCompressHeader hdr;
+	int			nbytes;
 
-	/* See if we already have the file open, or need to open it. */
-	if (ftag->segno < reln->md_num_open_segs[ftag->forknum])
-	{
-		file = reln->md_seg_fds[ftag->forknum][ftag->segno].mdfd_vfd;
-		strlcpy(path, FilePathName(file), MAXPGPATH);
-		need_to_close = false;
-	}
-	else
+	reln->md_pcmap_vfd = -1;
+	reln->md_pc_method = PAGE_COMPRESSION_NONE;
+
+	sprintf(mappath.str, "%s%s", path, PAGE_COMPRESS_MAP_SUFFIX);
+
+	mapfd = PathNameOpenFile(mappath.str, O_RDWR | PG_BINARY);
+	if (mapfd < 0)
 	{
-		MdPathStr	p;
+		int			save_errno = errno;
 
-		p = _mdfd_segpath(reln, ftag->forknum, ftag->segno);
-		strlcpy(path, p.str, MD_PATH_STR_MAXLEN);
+		if (FILE_POSSIBLY_DELETED(save_errno))
+			return datafd;
 
-		file = PathNameOpenFile(path, _mdfd_open_flags());
-		if (file < 0)
-			return -1;
-		need_to_close = true;
+		FileClose(datafd);
+		errno = save_errno;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", mappath.str)));
 	}
 
-	io_start = pgstat_prepare_io_time(track_io_timing);
+	nbytes = FileRead(mapfd, &hdr, sizeof(hdr), 0, WAIT_EVENT_DATA_FILE_READ);
+	if (nbytes != sizeof(hdr) ||
+		hdr.magic != PAGE_COMPRESS_MAGIC ||
+		hdr.version != PAGE_COMPRESS_VERSION ||
+		hdr.chunk_size != PC_CHUNK_SIZE ||
+		hdr.method == PAGE_COMPRESSION_NONE ||
+		hdr.method > PAGE_COMPRESSION_ZSTD)
+	{
+		int			save_errno = errno;
 
-	/* Sync the file. */
-	result = FileSync(file, WAIT_EVENT_DATA_FILE_SYNC);
-	save_errno = errno;
+		FileClose(mapfd);
+		FileClose(datafd);
+		errno = save_errno;
+		if (nbytes < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m", mappath.str)));
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid page compression map header in file \"%s\"",
+						mappath.str)));
+	}
 
-	if (need_to_close)
-		FileClose(file);
+	if (io_direct_flags & IO_DIRECT_DATA)
+	{
+		FileClose(datafd);
+		datafd = PathNameOpenFile(path, O_RDWR | PG_BINARY);
+		if (datafd < 0)
+		{
+			int			save_errno = errno;
 
-	pgstat_count_io_op_time(IOOBJECT_RELATION, IOCONTEXT_NORMAL,
-							IOOP_FSYNC, io_start, 1, 0);
+			FileClose(mapfd);
+			errno = save_errno;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", path)));
+		}
+	}
 
-	errno = save_errno;
-	return result;
+	reln->md_pcmap_vfd = mapfd;
+	reln->md_pc_method = (PageCompressionMethod) hdr.method;
+
+	return datafd;
 }
 
 /*
- * Unlink a file, given a file tag.  Write the path into an output
- * buffer so the caller can use it in error messages.
- *
- * Return 0 on success, -1 on failure, with errno set.
+ * Is this fork stored compressed?  The fork is opened first if needed,
+ * according to "behavior", as for _mdfd_getseg().  If it does not exist,
+ * false is returned, for the caller's usual code path to deal with that.
  */
-int
-mdunlinkfiletag(const FileTag *ftag, char *path)
+static bool
+_mdpc_fork(SMgrRelation reln, ForkNumber forknum, int behavior)
 {
-	RelPathStr	p;
-
-	/* Compute the path. */
-	p = relpathperm(ftag->rlocator, MAIN_FORKNUM);
-	strlcpy(path, p.str, MAXPGPATH);
+	if (forknum != MAIN_FORKNUM || SmgrIsTemp(reln))
+		return false;
+
+	if (reln->md_num_open_segs[forknum] == 0)
+	{
+		if (behavior & EXTENSION_DONT_OPEN)
+			return false;
+		if (mdopenfork(reln, forknum, behavior) == NULL)
+			return false;
+	}
+
+	return MD_FORK_IS_COMPRESSED(reln, forknum);
+}
+
+static void
+_mdpc_read_header(SMgrRelation reln, PageCompressHeader *hdr)
+{
+	int			nbytes;
+
+	nbytes = FileRead(reln->md_pcmap_vfd, hdr, sizeof(*hdr), 0,
+					  WAIT_EVENT_DATA_FILE_READ);
+	if (nbytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd))));
+	if (nbytes != sizeof(*hdr) || hdr->magic != PAGE_COMPRESS_MAGIC)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid page compression map header in file \"%s\"",
+						FilePathName(reln->md_pcmap_vfd))));
+}
+
+static void
+_mdpc_write_header(SMgrRelation reln, PageCompressHeader *hdr)
+{
+	int			nbytes;
+
+	nbytes = FileWrite(reln->md_pcmap_vfd, hdr, sizeof(*hdr), 0,
+					   WAIT_EVENT_DATA_FILE_WRITE);
+	if (nbytes != sizeof(*hdr))
+	{
+		if (nbytes >= 0)
+			errno = ENOSPC;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd))));
+	}
+}
+
+/*
+ * Read the addresses of nblocks blocks from the address map.  Blocks past
+ * the end of the map have no storage, and get address zero.
+ */
+static void
+_mdpc_read_addrs(SMgrRelation reln, BlockNumber blocknum, int nblocks,
+				 PageCompressAddr *addrs)
+{
+	int			nbytes;
+
+	nbytes = FileRead(reln->md_pcmap_vfd, addrs,
+					  nblocks * sizeof(PageCompressAddr),
+					  PC_MAP_OFFSET(blocknum), WAIT_EVENT_DATA_FILE_READ);
+	if (nbytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd))));
+
+	memset((char *) addrs + nbytes, 0,
+		   nblocks * sizeof(PageCompressAddr) - nbytes);
+}
+
+static void
+_mdpc_write_addr(SMgrRelation reln, BlockNumber blocknum,
+				 PageCompressAddr addr)
+{
+	int			nbytes;
+
+	nbytes = FileWrite(reln->md_pcmap_vfd, &addr, sizeof(addr),
+					   PC_MAP_OFFSET(blocknum), WAIT_EVENT_DATA_FILE_WRITE);
+	if (nbytes != sizeof(addr))
+	{
+		if (nbytes >= 0)
+			errno = ENOSPC;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd)),
+				 errhint("Check free disk space.")));
+	}
+}
+
+/*
+ * Read exactly len bytes of the data file of a compressed fork, for the
+ * given block.
+ */
+static void
+_mdpc_read_data(MdfdVec *v, char *buffer, int len, pgoff_t offset,
+				BlockNumber blocknum)
+{
+	int			transferred = 0;
+
+	while (transferred < len)
+	{
+		int			nbytes;
+
+		nbytes = FileRead(v->mdfd_vfd, buffer + transferred, len - transferred,
+						  offset + transferred, WAIT_EVENT_DATA_FILE_READ);
+		if (nbytes < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read block %u in file \"%s\": %m",
+							blocknum, FilePathName(v->mdfd_vfd))));
+		if (nbytes == 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("could not read block %u in file \"%s\": read only %d of %d bytes",
+							blocknum, FilePathName(v->mdfd_vfd),
+							transferred, len)));
+		transferred += nbytes;
+	}
+}
+
+/*
+ * Read nblocks pages of a compressed fork into buffers.
+ */
+static void
+_mdpc_readv(SMgrRelation reln, BlockNumber blocknum, void **buffers,
+			BlockNumber nblocks)
+{
+	MdfdVec    *v = &reln->md_seg_fds[MAIN_FORKNUM][0];
+	PageCompressHeader hdr;
+	PageCompressAddr addrs[64];
+	PGAlignedBlock compressed;
+
+	/*
+	 * Blocks past EOF read as zeroes if zero_damaged_pages is on or we are
+	 * InRecovery, as for uncompressed forks, see mdreadv().
+	 */
+	_mdpc_read_header(reln, &hdr);
+	if ((uint64) blocknum + nblocks > hdr.nblocks &&
+		!(zero_damaged_pages || InRecovery))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not read blocks %u..%u in file \"%s\": file has only %u blocks",
+						blocknum, blocknum + nblocks - 1,
+						FilePathName(v->mdfd_vfd), hdr.nblocks)));
+
+	for (BlockNumber i = 0; i < nblocks; i++)
+	{
+		PageCompressAddr addr;
+		pgoff_t		offset;
+		char	   *buffer = buffers[i];
+
+		if (i % lengthof(addrs) == 0)
+			_mdpc_read_addrs(reln, blocknum + i,
+							 Min(nblocks - i, lengthof(addrs)), addrs);
+		addr = addrs[i % lengthof(addrs)];
+
+		TRACE_POSTGRESQL_SMGR_MD_READ_START(MAIN_FORKNUM, blocknum + i,
+											reln->smgr_rlocator.locator.spcOid,
+											reln->smgr_rlocator.locator.dbOid,
+											reln->smgr_rlocator.locator.relNumber,
+											reln->smgr_rlocator.backend);
+
+		offset = (pgoff_t) PageCompressAddrGetChunk(addr) * PC_CHUNK_SIZE;
+
+		if (addr == 0 || blocknum + i >= hdr.nblocks)
+			memset(buffer, 0, BLCKSZ);
+		else if (!PageCompressAddrIsCompressed(addr))
+			_mdpc_read_data(v, buffer, BLCKSZ, offset, blocknum + i);
+		else
+		{
+			int			size = PageCompressAddrGetSize(addr);
+
+			if (size > PC_MAX_COMPRESSED_SIZE)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("invalid address of block %u in file \"%s\"",
+								blocknum + i,
+								FilePathName(reln->md_pcmap_vfd))));
+
+			_mdpc_read_data(v, compressed.data, size, offset, blocknum + i);
+
+			if (!page_decompress(reln->md_pc_method, compressed.data, size,
+								 buffer))
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("could not decompress block %u in file \"%s\"",
+								blocknum + i, FilePathName(v->mdfd_vfd))));
+		}
+
+		TRACE_POSTGRESQL_SMGR_MD_READ_DONE(MAIN_FORKNUM, blocknum + i,
+										   reln->smgr_rlocator.locator.spcOid,
+										   reln->smgr_rlocator.locator.dbOid,
+										   reln->smgr_rlocator.locator.relNumber,
+										   reln->smgr_rlocator.backend,
+										   BLCKSZ, BLCKSZ);
+	}
+}
+
+/*
+ * Set the number of blocks of a compressed fork to at least nblocks.
+ */
+static void
+_mdpc_extend_to(SMgrRelation reln, BlockNumber nblocks)
+{
+	LWLock	   *lock = PageCompressLock(reln->smgr_rlocator.locator,
+										MAIN_FORKNUM);
+	PageCompressHeader hdr;
+
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+	_mdpc_read_header(reln, &hdr);
+	if (hdr.nblocks < nblocks)
+	{
+		hdr.nblocks = nblocks;
+		_mdpc_write_header(reln, &hdr);
+	}
+	LWLockRelease(lock);
+}
+
+/*
+ * Write a page of a compressed fork.  If extend is true, the block is past
+ * the current end of the fork, and the fork is extended to include it.
+ *
+ * A page is compressed into a run of chunks.  It is rewritten in place if it
+ * fits in the run allocated to it, or else gets a new run at the end of the
+ * data file, leaving the old one unused until the relation is rewritten.
+ * New runs of compressed pages have room for one more chunk, as pages tend
+ * to grow as rows are added to them.
+ *
+ * The data and the address map are written separately, so a crash in
+ * between, or a torn write of the run, leaves a page that can't be read
+ * back.  Unlike a torn uncompressed page, it isn't even usable as is.  Crash
+ * recovery repairs such pages from full-page images, which is why
+ * RelationSetStorageCompression() requires hint bit updates to be WAL-logged
+ * too: then every page written out since the last checkpoint has one.
+ */
+static void
+_mdpc_write(SMgrRelation reln, BlockNumber blocknum, const void *buffer,
+			bool extend)
+{
+	MdfdVec    *v = &reln->md_seg_fds[MAIN_FORKNUM][0];
+	PGAlignedBlock compressed;
+	PageCompressAddr addr = 0;
+	const char *data;
+	int			size;
+	int			nchunks;
+	int			allocated;
+	uint64		chunk;
+	int			nbytes;
+
+	/* past the end of the fork, any address is left over from a truncation */
+	if (!extend)
+		_mdpc_read_addrs(reln, blocknum, 1, &addr);
+
+	size = page_compress(reln->md_pc_method, buffer, compressed.data);
+	if (size < 0)
+	{
+		data = buffer;
+		size = 0;
+		nchunks = PC_CHUNKS_PER_BLOCK;
+	}
+	else
+	{
+		data = compressed.data;
+		nchunks = (size + PC_CHUNK_SIZE - 1) / PC_CHUNK_SIZE;
+	}
+
+	TRACE_POSTGRESQL_SMGR_MD_WRITE_START(MAIN_FORKNUM, blocknum,
+										 reln->smgr_rlocator.locator.spcOid,
+										 reln->smgr_rlocator.locator.dbOid,
+										 reln->smgr_rlocator.locator.relNumber,
+										 reln->smgr_rlocator.backend);
+
+	if (addr != 0 && nchunks <= PageCompressAddrGetAllocated(addr))
+	{
+		chunk = PageCompressAddrGetChunk(addr);
+		allocated = PageCompressAddrGetAllocated(addr);
+
+		/* no need to write the padding, the run exists already */
+		nbytes = FileWrite(v->mdfd_vfd, data,
+						   size > 0 ? size : BLCKSZ,
+						   (pgoff_t) chunk * PC_CHUNK_SIZE,
+						   WAIT_EVENT_DATA_FILE_WRITE);
+		if (nbytes != (size > 0 ? size : BLCKSZ))
+		{
+			if (nbytes >= 0)
+				errno = ENOSPC;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write block %u in file \"%s\": %m",
+							blocknum, FilePathName(v->mdfd_vfd)),
+					 errhint("Check free disk space.")));
+		}
+	}
+	else
+	{
+		LWLock	   *lock = PageCompressLock(reln->smgr_rlocator.locator,
+											MAIN_FORKNUM);
+		pgoff_t		len;
+
+		allocated = Min(nchunks + 1, PC_CHUNKS_PER_BLOCK);
+		if (data == compressed.data)
+			memset(compressed.data + size, 0,
+				   allocated * PC_CHUNK_SIZE - size);
+
+		/*
+		 * The run is allocated at the end of the data file, which is only
+		 * extended while holding the lock, so the whole run is written now.
+		 */
+		LWLockAcquire(lock, LW_EXCLUSIVE);
+
+		len = FileSize(v->mdfd_vfd);
+		if (len < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not seek to end of file \"%s\": %m",
+							FilePathName(v->mdfd_vfd))));
+		chunk = (len + PC_CHUNK_SIZE - 1) / PC_CHUNK_SIZE;
+
+		nbytes = FileWrite(v->mdfd_vfd, data, allocated * PC_CHUNK_SIZE,
+						   (pgoff_t) chunk * PC_CHUNK_SIZE,
+						   extend ? WAIT_EVENT_DATA_FILE_EXTEND :
+						   WAIT_EVENT_DATA_FILE_WRITE);
+		if (nbytes != allocated * PC_CHUNK_SIZE)
+		{
+			if (nbytes >= 0)
+				errno = ENOSPC;
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write block %u in file \"%s\": %m",
+							blocknum, FilePathName(v->mdfd_vfd)),
+					 errhint("Check free disk space.")));
+		}
+
+		LWLockRelease(lock);
+	}
+
+	TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(MAIN_FORKNUM, blocknum,
+										reln->smgr_rlocator.locator.spcOid,
+										reln->smgr_rlocator.locator.dbOid,
+										reln->smgr_rlocator.locator.relNumber,
+										reln->smgr_rlocator.backend,
+										BLCKSZ, BLCKSZ);
+
+	INJECTION_POINT("page-compression-before-map-write", NULL);
+
+	_mdpc_write_addr(reln, blocknum,
+					 MakePageCompressAddr(chunk, allocated, nchunks, size));
+
+	if (extend)
+		_mdpc_extend_to(reln, blocknum + 1);
+}
+
+/*
+ * Extend a compressed fork with nblocks pages of zeroes, which get no
+ * storage.
+ */
+static void
+_mdpc_zeroextend(SMgrRelation reln, BlockNumber blocknum, int nblocks)
+{
+	/* clear any addresses left over from a truncation */
+	if (FileZero(reln->md_pcmap_vfd, PC_MAP_OFFSET(blocknum),
+				 (pgoff_t) nblocks * sizeof(PageCompressAddr),
+				 WAIT_EVENT_DATA_FILE_EXTEND) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not extend file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd)),
+				 errhint("Check free disk space.")));
+
+	_mdpc_extend_to(reln, blocknum + nblocks);
+}
+
+/*
+ * Truncate a compressed fork to nblocks blocks.
+ *
+ * The addresses of the removed blocks are truncated away with the map, but
+ * the runs of their pages are only released if no block remains, as the
+ * data file has no free space tracking.
+ */
+static void
+_mdpc_truncate(SMgrRelation reln, BlockNumber nblocks)
+{
+	MdfdVec    *v = &reln->md_seg_fds[MAIN_FORKNUM][0];
+	LWLock	   *lock = PageCompressLock(reln->smgr_rlocator.locator,
+										MAIN_FORKNUM);
+	PageCompressHeader hdr;
+
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+
+	_mdpc_read_header(reln, &hdr);
+	hdr.nblocks = nblocks;
+	_mdpc_write_header(reln, &hdr);
+
+	if (FileTruncate(reln->md_pcmap_vfd, PC_MAP_OFFSET(nblocks),
+					 WAIT_EVENT_DATA_FILE_TRUNCATE) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not truncate file \"%s\": %m",
+						FilePathName(reln->md_pcmap_vfd))));
+
+	if (nblocks == 0 &&
+		FileTruncate(v->mdfd_vfd, 0, WAIT_EVENT_DATA_FILE_TRUNCATE) < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not truncate file \"%s\": %m",
+						FilePathName(v->mdfd_vfd))));
+
+	LWLockRelease(lock);
+
+	_mdpc_register_dirty(reln);
+}
+
+/*
+ * Mark the data file and the address map of a compressed fork as needing
+ * fsync.
+ */
+static void
+_mdpc_register_dirty(SMgrRelation reln)
+{
+	MdfdVec		map;
+
+	map.mdfd_vfd = reln->md_pcmap_vfd;
+	map.mdfd_segno = MD_PCMAP_SEGNO;
+
+	register_dirty_segment(reln, MAIN_FORKNUM,
+						   &reln->md_seg_fds[MAIN_FORKNUM][0]);
+	register_dirty_segment(reln, MAIN_FORKNUM, &map);
+}
+
+/*
+ * Start an IO on the data file of a compressed fork that transfers no data,
+ * to complete an AIO handle whose data was already transferred
+ * synchronously, see mdstartreadv().
+ */
+static void
+_mdpc_start_io(PgAioHandle *ioh, SMgrRelation reln, ForkNumber forknum,
+			   BlockNumber blocknum, BlockNumber nblocks, void *buffer,
+			   bool skipFsync, bool is_write)
+{
+	MdfdVec    *v = &reln->md_seg_fds[forknum][0];
+	struct iovec *iov;
+	int			ret;
+
+	pgaio_io_get_iovec(ioh, &iov);
+	iov[0].iov_base = buffer;
+	iov[0].iov_len = 0;
+
+	pgaio_io_set_flag(ioh, PGAIO_HF_SYNCHRONOUS);
+	pgaio_io_set_target_smgr(ioh, reln, forknum, blocknum, nblocks,
+							 skipFsync);
+
+	if (is_write)
+	{
+		pgaio_io_register_callbacks(ioh, PGAIO_HCB_MD_WRITEV,
+									MD_CB_TRANSFERRED);
+		ret = FileStartWriteV(ioh, v->mdfd_vfd, 1, 0,
+							  WAIT_EVENT_DATA_FILE_WRITE);
+	}
+	else
+	{
+		pgaio_io_register_callbacks(ioh, PGAIO_HCB_MD_READV,
+									MD_CB_TRANSFERRED);
+		ret = FileStartReadV(ioh, v->mdfd_vfd, 1, 0,
+							 WAIT_EVENT_DATA_FILE_READ);
+	}
+
+	if (ret != 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not start IO on blocks %u..%u in file \"%s\": %m",
+						blocknum, blocknum + nblocks - 1,
+						FilePathName(v->mdfd_vfd))));
+}
+
+/*
+ * Sync a file to disk, given a file tag.  Write the path into an output
+ * buffer so the caller can use it in error messages.
+ *
+ * Return 0 on success, -1 on failure, with errno set.
+ */
+int
+mdsyncfiletag(const FileTag *ftag, char *path)
+{
+	SMgrRelation reln = smgropen(ftag->rlocator, INVALID_PROC_NUMBER);
+	File		file;
+	instr_time	io_start;
+	bool		need_to_close;
+	int			result,
+				save_errno;
+
+	/* See if we already have the file open, or need to open it. */
+	if (ftag->segno < reln->md_num_open_segs[ftag->forknum])
+	{
+		file = reln->md_seg_fds[ftag->forknum][ftag->segno].mdfd_vfd;
+		strlcpy(path, FilePathName(file), MAXPGPATH);
+		need_to_close = false;
+	}
+	else
+	{
+		MdPathStr	p;
+
+		p = _mdfd_segpath(reln, ftag->forknum, ftag->segno);
+		strlcpy(path, p.str, MD_PATH_STR_MAXLEN);
+
+		file = PathNameOpenFile(path, _mdfd_open_flags());
+		if (file < 0)
+			return -1;
+		need_to_close = true;
+	}
+
+	io_start = pgstat_prepare_io_time(track_io_timing);
+
+	/* Sync the file. */
+	result = FileSync(file, WAIT_EVENT_DATA_FILE_SYNC);
+	save_errno = errno;
+
+	if (need_to_close)
+		FileClose(file);
+
+	pgstat_count_io_op_time(IOOBJECT_RELATION, IOCONTEXT_NORMAL,
+							IOOP_FSYNC, io_start, 1, 0);
+
+	errno = save_errno;
+	return result;
+}
+
+/*
+ * Unlink a file, given a file tag.  Write the path into an output
+ * buffer so the caller can use it in error messages.
+ *
+ * Return 0 on success, -1 on failure, with errno set.
+ */
+int
+mdunlinkfiletag(const FileTag *ftag, char *path)
+{
+	RelPathStr	p;
+
+	/* Compute the path. */
+	p = relpathperm(ftag->rlocator, MAIN_FORKNUM);
+	strlcpy(path, p.str, MAXPGPATH);
 
 	/* Try to unlink the file. */
 	return unlink(path);
@@ -2014,6 +2959,13 @@ md_readv_complete(PgAioHandle *ioh, PgAioResult prior_result, uint8 cb_data)
 		return result;
 	}
 
+	/* mdstartreadv() already read all the blocks */
+	if (cb_data & MD_CB_TRANSFERRED)
+	{
+		result.result = td->smgr.nblocks;
+		return result;
+	}
+
 	/*
 	 * As explained above smgrstartreadv(), the smgr API operates on the level
 	 * of blocks, rather than bytes. Convert.
@@ -2090,3 +3042,108 @@ md_readv_report(PgAioResult result, const PgAioTargetData *td, int elevel)
 					   td->smgr.nblocks * (size_t) BLCKSZ));
 	}
 }
+
+/*
+ * AIO completion callback for mdstartwritev().
+ */
+static PgAioResult
+md_writev_complete(PgAioHandle *ioh, PgAioResult prior_result, uint8 cb_data)
+{
+	PgAioTargetData *td = pgaio_io_get_target_data(ioh);
+	PgAioResult result = prior_result;
+
+	if (prior_result.result < 0)
+	{
+		result.status = PGAIO_RS_ERROR;
+		result.id = PGAIO_HCB_MD_WRITEV;
+		/* For "hard" errors, track the error number in error_data */
+		result.error_data = -prior_result.result;
+		result.result = 0;
+
+		/* see comment in md_readv_complete() */
+		pgaio_result_report(result, td, LOG_SERVER_ONLY);
+
+		return result;
+	}
+
+	/* mdstartwritev() already wrote all the blocks */
+	if (cb_data & MD_CB_TRANSFERRED)
+	{
+		result.result = td->smgr.nblocks;
+		return result;
+	}
+
+	/*
+	 * As explained above smgrstartwritev(), the smgr API operates on the
+	 * level of blocks, rather than bytes. Convert.
+	 */
+	result.result /= BLCKSZ;
+
+	Assert(result.result <= td->smgr.nblocks);
+
+	if (result.result == 0)
+	{
+		/* consider 0 blocks written a failure */
+		result.status = PGAIO_RS_ERROR;
+		result.id = PGAIO_HCB_MD_WRITEV;
+		result.error_data = 0;
+
+		/* see comment in md_readv_complete() */
+		pgaio_result_report(result, td, LOG_SERVER_ONLY);
+
+		return result;
+	}
+
+	if (result.status != PGAIO_RS_ERROR &&
+		result.result < td->smgr.nblocks)
+	{
+		/* partial writes should be retried at upper level */
+		result.status = PGAIO_RS_PARTIAL;
+		result.id = PGAIO_HCB_MD_WRITEV;
+	}
+
+	return result;
+}
+
+/*
+ * AIO error reporting callback for mdstartwritev().
+ */
+static void
+md_writev_report(PgAioResult result, const PgAioTargetData *td, int elevel)
+{
+	RelPathStr	path;
+
+	path = relpathbackend(td->smgr.rlocator,
+						  td->smgr.is_temp ? MyProcNumber : INVALID_PROC_NUMBER,
+						  td->smgr.forkNum);
+
+	if (result.error_data != 0)
+	{
+		/* for errcode_for_file_access() and %m */
+		errno = result.error_data;
+
+		ereport(elevel,
+				errcode_for_file_access(),
+				errmsg("could not write blocks %u..%u in file \"%s\": %m",
+					   td->smgr.blockNum,
+					   td->smgr.blockNum + td->smgr.nblocks - 1,
+					   path.str),
+				result.error_data == ENOSPC ?
+				errhint("Check free disk space.") : 0);
+	}
+	else
+	{
+		/*
+		 * NB: This will typically only be output in debug messages, while
+		 * retrying a partial IO.
+		 */
+		ereport(elevel,
+				errcode(ERRCODE_IO_ERROR),
+				errmsg("could not write blocks %u..%u in file \"%s\": wrote only %zu of %zu bytes",
+					   td->smgr.blockNum,
+					   td->smgr.blockNum + td->smgr.nblocks - 1,
+					   path.str,
+					   result.result * (size_t) BLCKSZ,
+					   td->smgr.nblocks * (size_t) BLCKSZ));
+	}
+}
@@ -0,0 +1,247 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.c
+ *	  Compression of the pages of compressed relation forks.
+ *
+ * md.c stores the main fork of relations with page compression enabled as
+ * runs of compressed chunks, see storage/pagecompress.h.  This file has the
+ * compression routines it uses, and the locks serializing changes to the
+ * address maps of compressed forks.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/smgr/pagecompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "common/hashfn.h"
+#include "common/pg_lzcompress.h"
+#include "storage/lwlock.h"
+#include "storage/pagecompress.h"
+#include "storage/shmem.h"
+#include "storage/subsystems.h"
+
+/*
+ * Number of locks protecting the address maps.  Forks are assigned a lock by
+ * hashing their locator, so unrelated forks may share one; that only matters
+ * while pages are allocated storage, which is short.
+ */
+#define NUM_PAGE_COMPRESS_LOCKS		128
+
+static LWLockPadded *PageCompressLocks;
+
+static void PageCompressShmemRequest(void *arg);
+static void PageCompressShmemInit(void *arg);
+
+const ShmemCallbacks PageCompressShmemCallbacks = {
+	.request_fn = PageCompressShmemRequest,
+	.init_fn = PageCompressShmemInit,
+};
+
+/*
+ * PageCompressShmemRequest --- register this module's shared memory
+ */
+static void
+PageCompressShmemRequest(void *arg)
+{
+	ShmemRequestStruct(.name = "Page Compression Locks",
+					   .size = mul_size(NUM_PAGE_COMPRESS_LOCKS,
+										sizeof(LWLockPadded)),
+					   .ptr = (void **) &PageCompressLocks,
+		);
+}
+
+/*
+ * PageCompressShmemInit --- initialize this module's shared memory
+ */
+static void
+PageCompressShmemInit(void *arg)
+{
+	for (int i = 0; i < NUM_PAGE_COMPRESS_LOCKS; i++)
+		LWLockInitialize(&PageCompressLocks[i].lock, LWTRANCHE_PAGE_COMPRESS);
+}
+
+/*
+ * Return the lock protecting the address map of a compressed fork.
+ */
+LWLock *
+PageCompressLock(RelFileLocator rlocator, ForkNumber forknum)
+{
+	uint32		hash;
+
+	hash = hash_bytes((const unsigned char *) &rlocator, sizeof(rlocator));
+	hash = hash_combine(hash, (uint32) forknum);
+
+	return &PageCompressLocks[hash % NUM_PAGE_COMPRESS_LOCKS].lock;
+}
+
+/*
+ * Return the name of a page compression method, as used by the
+ * page_compression storage parameter.
+ */
+const char *
+GetPageCompressionName(PageCompressionMethod method)
+{
+	switch (method)
+	{
+		case PAGE_COMPRESSION_NONE:
+			return "none";
+		case PAGE_COMPRESSION_PGLZ:
+			return "pglz";
+		case PAGE_COMPRESSION_LZ4:
+			return "lz4";
+		case PAGE_COMPRESSION_ZSTD:
+			return "zstd";
+	}
+
+	return "???";
+}
+
+/*
+ * Raise an error if this build cannot compress pages with the given method.
+ */
+void
+CheckPageCompressionSupported(PageCompressionMethod method)
+{
+	switch (method)
+	{
+		case PAGE_COMPRESSION_NONE:
+		case PAGE_COMPRESSION_PGLZ:
+			return;
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			return;
+#else
+			break;
+#endif
+		case PAGE_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			return;
+#else
+			break;
+#endif
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("page compression method %s not supported",
+					GetPageCompressionName(method)),
+			 errdetail("This functionality requires the server to be built with %s support.",
+					   GetPageCompressionName(method))));
+}
+
+/*
+ * Compress a page into dest, which must have room for BLCKSZ bytes.
+ *
+ * Returns the compressed size, or -1 if the page does not compress to at
+ * most PC_MAX_COMPRESSED_SIZE bytes, in which case it is to be stored as is.
+ */
+int
+page_compress(PageCompressionMethod method, const char *page, char *dest)
+{
+	int32		len = -1;
+
+	switch (method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			{
+				/* pglz may write a few bytes past the source length */
+				static char buf[PGLZ_MAX_OUTPUT(BLCKSZ)];
+
+				len = pglz_compress(page, BLCKSZ, buf, PGLZ_strategy_default);
+				if (len >= 0 && len <= PC_MAX_COMPRESSED_SIZE)
+					memcpy(dest, buf, len);
+				break;
+			}
+
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_compress_default(page, dest, BLCKSZ,
+									   PC_MAX_COMPRESSED_SIZE);
+			if (len <= 0)
+				len = -1;		/* does not fit */
+#else
+			CheckPageCompressionSupported(method);
+#endif
+			break;
+
+		case PAGE_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		ret;
+
+				ret = ZSTD_compress(dest, PC_MAX_COMPRESSED_SIZE, page, BLCKSZ,
+									ZSTD_CLEVEL_DEFAULT);
+				len = ZSTD_isError(ret) ? -1 : (int32) ret;
+			}
+#else
+			CheckPageCompressionSupported(method);
+#endif
+			break;
+
+		case PAGE_COMPRESSION_NONE:
+			elog(ERROR, "cannot compress a page without a compression method");
+			break;
+	}
+
+	if (len < 0 || len > PC_MAX_COMPRESSED_SIZE)
+		return -1;
+	return len;
+}
+
+/*
+ * Decompress slen bytes of compressed data into a page.
+ *
+ * Returns false if the data does not decompress to exactly BLCKSZ bytes.
+ */
+bool
+page_decompress(PageCompressionMethod method, const char *source, int slen,
+				char *page)
+{
+	int32		rawsize = -1;
+
+	switch (method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			rawsize = pglz_decompress(source, slen, page, BLCKSZ, true);
+			break;
+
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			rawsize = LZ4_decompress_safe(source, page, slen, BLCKSZ);
+#else
+			CheckPageCompressionSupported(method);
+#endif
+			break;
+
+		case PAGE_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		ret;
+
+				ret = ZSTD_decompress(page, BLCKSZ, source, slen);
+				rawsize = ZSTD_isError(ret) ? -1 : (int32) ret;
+			}
+#else
+			CheckPageCompressionSupported(method);
+#endif
+			break;
+
+		case PAGE_COMPRESSION_NONE:
+			break;
+	}
+
+	return rawsize == BLCKSZ;
+}
@@ -115,6 +115,11 @@ typedef struct f_smgr
 								BlockNumber blocknum,
 								const void **buffers, BlockNumber nblocks,
 								bool skipFsync);
+	void		(*smgr_startwritev) (PgAioHandle *ioh,
+									 SMgrRelation reln, ForkNumber forknum,
+									 BlockNumber blocknum,
+									 const void **buffers, BlockNumber nblocks,
+									 bool skipFsync);
 	void		(*smgr_writeback) (SMgrRelation reln, ForkNumber forknum,
 								   BlockNumber blocknum, BlockNumber nblocks);
 	BlockNumber (*smgr_nblocks) (SMgrRelation reln, ForkNumber forknum);
@@ -122,6 +127,11 @@ typedef struct f_smgr
 								  BlockNumber old_blocks, BlockNumber nblocks);
 	void		(*smgr_immedsync) (SMgrRelation reln, ForkNumber forknum);
 	void		(*smgr_registersync) (SMgrRelation reln, ForkNumber forknum);
+	void		(*smgr_setcompression) (SMgrRelation reln, ForkNumber forknum,
+										PageCompressionMethod method,
+										bool isRedo);
+	PageCompressionMethod (*smgr_getcompression) (SMgrRelation reln,
+												  ForkNumber forknum);
 	int			(*smgr_fd) (SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, uint32 *off);
 } f_smgr;
 
@@ -142,11 +152,14 @@ static const f_smgr smgrsw[] = {
 		.smgr_readv = mdreadv,
 		.smgr_startreadv = mdstartreadv,
 		.smgr_writev = mdwritev,
+		.smgr_startwritev = mdstartwritev,
 		.smgr_writeback = mdwriteback,
 		.smgr_nblocks = mdnblocks,
 		.smgr_truncate = mdtruncate,
 		.smgr_immedsync = mdimmedsync,
 		.smgr_registersync = mdregistersync,
+		.smgr_setcompression = mdsetcompression,
+		.smgr_getcompression = mdgetcompression,
 		.smgr_fd = mdfd,
 	}
 };
@@ -797,6 +810,39 @@ smgrwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	RESUME_INTERRUPTS();
 }
 
+/*
+ * smgrstartwritev() -- asynchronous version of smgrwritev()
+ *
+ * This starts an asynchronous writev IO using the IO handle `ioh`. Other than
+ * `ioh` all parameters are the same as smgrwritev().
+ *
+ * Like for smgrstartreadv(), completion callbacks above smgr will be passed
+ * the result as the number of successfully written blocks, and partial
+ * writes need to be handled by the caller re-issuing IO for the unwritten
+ * blocks.  Errors are reported the same way as for smgrstartreadv().
+ *
+ * Unless skipFsync is true, the request to fsync the written segment at the
+ * next checkpoint is registered when the IO is started, rather than when it
+ * has completed.  That's only correct if the caller prevents the fsync
+ * request from being processed before the write has completed.  The
+ * checkpointer satisfies that trivially, as it waits for its own writes
+ * before processing fsync requests; other callers need to pass
+ * skipFsync = true and make their own provisions.
+ *
+ * The caller must not modify the buffers until the IO has completed.
+ */
+void
+smgrstartwritev(PgAioHandle *ioh,
+				SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				const void **buffers, BlockNumber nblocks, bool skipFsync)
+{
+	HOLD_INTERRUPTS();
+	smgrsw[reln->smgr_which].smgr_startwritev(ioh,
+											  reln, forknum, blocknum,
+											  buffers, nblocks, skipFsync);
+	RESUME_INTERRUPTS();
+}
+
 /*
  * smgrwriteback() -- Trigger kernel writeback for the supplied range of
  *					   blocks.
@@ -978,6 +1024,36 @@ smgrimmedsync(SMgrRelation reln, ForkNumber forknum)
 	RESUME_INTERRUPTS();
 }
 
+/*
+ * smgrsetcompression() -- Make the specified fork store its pages compressed.
+ *
+ * The fork must exist and be empty, as its pages are not converted.  Passing
+ * PAGE_COMPRESSION_NONE makes it store them uncompressed again.  If isRedo is
+ * true, the fork may contain leftover data from before a crash, which is
+ * kept if the fork already uses the given method, and discarded otherwise.
+ *
+ * The caller is responsible for WAL-logging the change, see
+ * RelationSetStorageCompression().
+ */
+void
+smgrsetcompression(SMgrRelation reln, ForkNumber forknum,
+				   PageCompressionMethod method, bool isRedo)
+{
+	HOLD_INTERRUPTS();
+	smgrsw[reln->smgr_which].smgr_setcompression(reln, forknum, method, isRedo);
+	reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+	RESUME_INTERRUPTS();
+}
+
+/*
+ * smgrgetcompression() -- Return the page compression method of a fork.
+ */
+PageCompressionMethod
+smgrgetcompression(SMgrRelation reln, ForkNumber forknum)
+{
+	return smgrsw[reln->smgr_which].smgr_getcompression(reln, forknum);
+}
+
 /*
  * Return fd for the specified block number and update *off to the appropriate
  * position.
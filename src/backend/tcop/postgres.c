@@ -75,6 +75,7 @@
 #include "tcop/backend_startup.h"
 #include "tcop/fastpath.h"
 #include "tcop/pquery.h"
+#include "tcop/sessionpool.h"
 #include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/guc_hooks.h"
@@ -3457,6 +3458,18 @@ ProcessInterrupts(void)
 		LockErrorCleanup();
 		/* don't send to client, we already know the connection to be dead. */
 		whereToSendOutput = DestNone;
+
+		/*
+		 * A pool backend has other sessions to serve, so just abort the
+		 * query.  The session ends when we next try to read from the client.
+		 */
+		if (am_pool_backend)
+		{
+			ClientConnectionLost = false;
+			ereport(ERROR,
+					(errcode(ERRCODE_CONNECTION_FAILURE),
+					 errmsg("connection to client lost")));
+		}
 		ereport(FATAL,
 				(errcode(ERRCODE_CONNECTION_FAILURE),
 				 errmsg("connection to client lost")));
@@ -4399,6 +4412,16 @@ PostgresMain(const char *dbname, const char *username)
 	 */
 	BeginReportingGUCOptions();
 
+	/*
+	 * With session pooling, this client may be better served by another
+	 * backend.  If it has been handed over, we're done.
+	 */
+	if (SessionPoolStart())
+	{
+		whereToSendOutput = DestNone;
+		proc_exit(0);
+	}
+
 	/*
 	 * Also set up handler to log session end; we have to wait till now to be
 	 * sure Log_disconnections has its final value.
@@ -4726,8 +4749,11 @@ PostgresMain(const char *dbname, const char *username)
 				set_ps_display("idle");
 				pgstat_report_activity(STATE_IDLE, NULL);
 
-				/* Start the idle-session timer */
-				if (IdleSessionTimeout > 0)
+				/*
+				 * Start the idle-session timer.  A pool backend doesn't time
+				 * out its idle sessions, since the timer is per backend.
+				 */
+				if (IdleSessionTimeout > 0 && !am_pool_backend)
 				{
 					idle_session_timeout_enabled = true;
 					enable_timeout_after(IDLE_SESSION_TIMEOUT,
@@ -4782,6 +4808,18 @@ PostgresMain(const char *dbname, const char *username)
 		 */
 		DoingCommandRead = true;
 
+		/*
+		 * In a pool backend, this is where we can move on to another session
+		 * if the current one is idle.  The unnamed statement doesn't survive
+		 * that, since it isn't saved with the session.
+		 */
+		if (am_pool_backend && !ignore_till_sync &&
+			!IsTransactionOrTransactionBlock())
+		{
+			if (SessionPoolWaitForInput())
+				drop_unnamed_stmt();
+		}
+
 		/*
 		 * (3) read a command (loop blocks here)
 		 */
@@ -4826,6 +4864,8 @@ PostgresMain(const char *dbname, const char *username)
 		{
 			ConfigReloadPending = false;
 			ProcessConfigFile(PGC_SIGHUP);
+			if (am_pool_backend)
+				SessionPoolConfigReloaded();
 		}
 
 		/*
@@ -5075,6 +5115,22 @@ PostgresMain(const char *dbname, const char *username)
 
 			case PqMsg_Terminate:
 
+				/*
+				 * A pool backend only exits with its last session; otherwise
+				 * it goes on with the others.
+				 */
+				if (am_pool_backend)
+				{
+					drop_unnamed_stmt();
+					if (SessionPoolEndSession())
+					{
+						pgStatSessionEndCause = DISCONNECT_NORMAL;
+						ignore_till_sync = false;
+						send_ready_for_query = false;
+						break;
+					}
+				}
+
 				/*
 				 * Reset whereToSendOutput to prevent ereport from attempting
 				 * to send any more messages to client.
@@ -0,0 +1,1192 @@
+/*-------------------------------------------------------------------------
+ *
+ * sessionpool.c
+ *	  Built-in pooling of client sessions in shared backends.
+ *
+ * Normally every client connection gets a backend of its own, which stays
+ * around for as long as the connection does, even when it sits idle.  When
+ * session_pool_size is set, a backend that has finished authenticating its
+ * client and setting up the session doesn't necessarily go on to serve it.
+ * For each combination of database and authenticated user, the first
+ * session_pool_size backends become "pool backends".  Once there are that
+ * many, further backends hand their client connection over to the pool
+ * backend that has the fewest sessions, and exit.  A pool backend
+ * multiplexes all of its sessions: whenever the one it is serving is idle
+ * outside a transaction and another one has sent something, it switches to
+ * that one.
+ *
+ * The client socket is passed on over a Unix-domain socket that each pool
+ * backend listens on, in PG_SESSIONPOOL_DIR, together with everything needed
+ * to recreate the session: the Port contents, the GUC settings, the role
+ * identities and the cancel key.  Doing the hand-off in the backend, after
+ * authentication, means that the postmaster doesn't need to know anything
+ * about it, and that a pool backend never deals with a connection that is
+ * not yet authenticated.
+ *
+ * Switching sessions saves and restores the session state that a backend
+ * keeps in local memory: settings, role, prepared statements and sequence
+ * values.  State that other backends see as belonging to the backend, rather
+ * than to the session, can't be switched, so temporary tables, LISTEN,
+ * session-level advisory locks and holdable cursors are refused in pooled
+ * sessions; see PreventInPooledSession().  Clients that need them can
+ * connect with session_pooling turned off to get a dedicated backend.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/tcop/sessionpool.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "access/parallel.h"
+#include "access/xact.h"
+#include "commands/event_trigger.h"
+#include "commands/prepare.h"
+#include "commands/sequence.h"
+#include "libpq/libpq.h"
+#include "libpq/pqformat.h"
+#include "libpq/protocol.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "replication/walsender.h"
+#include "storage/fd.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/procsignal.h"
+#include "storage/shmem.h"
+#include "storage/subsystems.h"
+#include "storage/waiteventset.h"
+#include "tcop/sessionpool.h"
+#include "tcop/tcopprot.h"
+#include "utils/backend_status.h"
+#include "utils/guc.h"
+#include "utils/guc_hooks.h"
+#include "utils/memutils.h"
+#include "utils/wait_event.h"
+
+/*
+ * Shared registry of pool backends, indexed by proc number.  Protected by
+ * SessionPoolLock.
+ */
+typedef struct SessionPoolSlot
+{
+	pid_t		pid;			/* pool backend's PID, or 0 if unused */
+	Oid			dboid;			/* database it is connected to */
+	Oid			roleid;			/* authenticated user */
+	int			nsessions;		/* number of sessions it serves */
+	int			npending;		/* number of sessions on their way to it */
+} SessionPoolSlot;
+
+/*
+ * A session served by this backend.  While the session is not the current
+ * one, the state that it would otherwise have in backend-global variables is
+ * stashed away here.
+ */
+typedef struct PooledSession
+{
+	MemoryContext cxt;			/* holds this struct and what it points to */
+	Port	   *port;
+	uint8		cancel_key[MAX_CANCEL_KEY_LENGTH];
+	int			cancel_key_len;
+	char	   *conninfo;		/* serialized MyClientConnectionInfo */
+
+	/* saved state of a session that is not the current one */
+	char	   *gucstate;
+	Oid			session_user_id;
+	bool		session_user_is_superuser;
+	Oid			outer_user_id;
+	bool		role_is_superuser;
+	void	   *prepared_statements;
+	void	   *sequences;
+	bool		config_stale;	/* missed a configuration file reload */
+} PooledSession;
+
+/* GUC variables */
+int			session_pool_size = 0;
+bool		session_pooling = true;
+
+bool		am_pool_backend = false;
+
+static SessionPoolSlot *SessionPoolSlots = NULL;
+
+/* Local state of a pool backend */
+static List *pooled_sessions = NIL;
+static PooledSession *current_session = NULL;
+static PooledSession *closed_session = NULL;
+static pgsocket listen_sock = PGINVALID_SOCKET;
+static WaitEventSet *pool_wait_set = NULL;
+static WaitEvent *pool_events = NULL;
+static int	pool_nevents = 0;
+
+/* Positions of the fixed events in pool_wait_set */
+#define POOL_LATCH_POS		0
+#define POOL_LISTEN_POS		2
+
+static void SessionPoolShmemRequest(void *arg);
+static void SessionPoolShmemInit(void *arg);
+
+const ShmemCallbacks SessionPoolShmemCallbacks = {
+	.request_fn = SessionPoolShmemRequest,
+	.init_fn = SessionPoolShmemInit,
+};
+
+#ifndef WIN32
+static void session_pool_shmem_exit(int code, Datum arg);
+static void get_socket_path(pid_t pid, struct sockaddr_un *addr);
+static bool create_listen_socket(void);
+static PooledSession *new_session(void);
+static void build_payload(StringInfo buf);
+static pgsocket connect_pool_backend(pid_t pid);
+static bool send_session(pgsocket sock, StringInfo payload);
+static PooledSession *receive_session(pgsocket conn);
+static void accept_sessions(void);
+static void save_session(PooledSession *session);
+static void switch_session(PooledSession *session);
+static void build_wait_set(void);
+#endif
+
+static void
+SessionPoolShmemRequest(void *arg)
+{
+	if (session_pool_size <= 0)
+		return;
+
+	ShmemRequestStruct(.name = "Session Pool",
+					   .size = mul_size(MaxBackends, sizeof(SessionPoolSlot)),
+					   .ptr = (void **) &SessionPoolSlots,
+		);
+}
+
+static void
+SessionPoolShmemInit(void *arg)
+{
+	DIR		   *dir;
+	struct dirent *de;
+
+	if (SessionPoolSlots == NULL)
+		return;
+
+	MemSet(SessionPoolSlots, 0, mul_size(MaxBackends, sizeof(SessionPoolSlot)));
+
+	/*
+	 * This runs in the postmaster, at startup and after a crash, so it's a
+	 * good time to remove sockets left behind by earlier pool backends.
+	 */
+	if (MakePGDirectory(PG_SESSIONPOOL_DIR) < 0 && errno != EEXIST)
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not create directory \"%s\": %m",
+						PG_SESSIONPOOL_DIR)));
+
+	dir = AllocateDir(PG_SESSIONPOOL_DIR);
+	while ((de = ReadDirExtended(dir, PG_SESSIONPOOL_DIR, LOG)) != NULL)
+	{
+		char		path[MAXPGPATH];
+
+		if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+			continue;
+
+		snprintf(path, sizeof(path), "%s/%s", PG_SESSIONPOOL_DIR, de->d_name);
+		if (unlink(path) < 0)
+			ereport(LOG,
+					(errcode_for_file_access(),
+					 errmsg("could not remove file \"%s\": %m", path)));
+	}
+	FreeDir(dir);
+}
+
+/*
+ * GUC check_hook for session_pool_size
+ */
+bool
+check_session_pool_size(int *newval, void **extra, GucSource source)
+{
+#ifdef WIN32
+	if (*newval > 0)
+	{
+		GUC_check_errdetail("Session pooling is not supported on this platform.");
+		return false;
+	}
+#endif
+	return true;
+}
+
+/*
+ * Complain if the current session is a pooled one.  "feature" names what
+ * the caller is about to do, in plural form, e.g. "temporary tables".
+ */
+void
+PreventInPooledSession(const char *feature)
+{
+	if (am_pool_backend)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		/* translator: %s is the name of a feature, e.g. "temporary tables" */
+				 errmsg("%s cannot be used in a pooled session", feature),
+				 errdetail("Pooled sessions share their backend with other sessions."),
+				 errhint("Connect with \"%s\" turned off to get a dedicated backend.",
+						 "session_pooling")));
+}
+
+/*
+ * SessionPoolStart
+ *		Decide what to do with a newly established client session.
+ *
+ * Called by PostgresMain once the session is set up, before anything but
+ * the authentication exchange and the initial parameter values has been
+ * sent to the client.  Returns true if the client has been handed over to a
+ * pool backend, in which case the caller should just exit.  Otherwise, we
+ * keep serving the client ourselves, possibly as a new pool backend.
+ */
+bool
+SessionPoolStart(void)
+{
+#ifdef WIN32
+	return false;
+#else
+	Oid			roleid;
+	int			count = 0;
+	int			target = -1;
+	pid_t		target_pid = 0;
+	pgsocket	sock;
+	StringInfoData payload;
+
+	if (SessionPoolSlots == NULL || !session_pooling ||
+		whereToSendOutput != DestRemote || am_walsender ||
+		MyBackendType != B_BACKEND || MyProcNumber >= MaxBackends)
+		return false;
+
+	/* Encrypted connections can't be taken over by another process */
+	if (MyProcPort->ssl_in_use)
+		return false;
+#ifdef ENABLE_GSS
+	if (be_gssapi_get_auth(MyProcPort) || be_gssapi_get_enc(MyProcPort))
+		return false;
+#endif
+
+	/* Don't bother if the client has already started sending queries */
+	if (pq_buffer_remaining_data() > 0)
+		return false;
+
+	roleid = GetAuthenticatedUserId();
+
+	LWLockAcquire(SessionPoolLock, LW_EXCLUSIVE);
+
+	for (int i = 0; i < MaxBackends; i++)
+	{
+		SessionPoolSlot *slot = &SessionPoolSlots[i];
+
+		if (slot->pid == 0 || slot->dboid != MyDatabaseId ||
+			slot->roleid != roleid)
+			continue;
+
+		count++;
+		if (target < 0 ||
+			slot->nsessions + slot->npending <
+			SessionPoolSlots[target].nsessions + SessionPoolSlots[target].npending)
+			target = i;
+	}
+
+	if (count < session_pool_size)
+	{
+		SessionPoolSlot *slot = &SessionPoolSlots[MyProcNumber];
+
+		/* Become a pool backend, serving this session first */
+		if (!create_listen_socket())
+		{
+			LWLockRelease(SessionPoolLock);
+			return false;
+		}
+
+		slot->pid = MyProcPid;
+		slot->dboid = MyDatabaseId;
+		slot->roleid = roleid;
+		slot->nsessions = 1;
+		slot->npending = 0;
+		LWLockRelease(SessionPoolLock);
+
+		on_shmem_exit(session_pool_shmem_exit, 0);
+		am_pool_backend = true;
+
+		current_session = new_session();
+		current_session->port = MyProcPort;
+		memcpy(current_session->cancel_key, MyCancelKey, MyCancelKeyLength);
+		current_session->cancel_key_len = MyCancelKeyLength;
+		current_session->conninfo =
+			MemoryContextAlloc(current_session->cxt,
+							   EstimateClientConnectionInfoSpace());
+		SerializeClientConnectionInfo(EstimateClientConnectionInfoSpace(),
+									  current_session->conninfo);
+		pooled_sessions = lappend(pooled_sessions, current_session);
+
+		return false;
+	}
+
+	target_pid = SessionPoolSlots[target].pid;
+	LWLockRelease(SessionPoolLock);
+
+	/*
+	 * Send whatever the client has been sent so far, since none of it must
+	 * get lost, then pass the connection on.  If any of that doesn't work
+	 * out, we keep the client after all.
+	 */
+	if (pq_flush() != 0)
+		return false;
+
+	sock = connect_pool_backend(target_pid);
+	if (sock == PGINVALID_SOCKET)
+		return false;
+
+	/*
+	 * The pool backend accounts for every connection it accepts, whether or
+	 * not the session arrives in one piece, by decrementing npending.  It
+	 * can't get that far before it has received something from us, so
+	 * count the session as pending before sending anything.
+	 */
+	LWLockAcquire(SessionPoolLock, LW_EXCLUSIVE);
+	if (SessionPoolSlots[target].pid == target_pid)
+		SessionPoolSlots[target].npending++;
+	LWLockRelease(SessionPoolLock);
+
+	initStringInfo(&payload);
+	build_payload(&payload);
+	return send_session(sock, &payload);
+#endif
+}
+
+/*
+ * SessionPoolWaitForInput
+ *		Wait until one of our sessions has sent something, and make it the
+ *		current one.
+ *
+ * Called by PostgresMain in a pool backend before reading the next command,
+ * when the current session is idle outside a transaction.  Returns true if
+ * we switched to another session.
+ */
+bool
+SessionPoolWaitForInput(void)
+{
+#ifdef WIN32
+	return false;
+#else
+	bool		switched = false;
+
+	Assert(am_pool_backend);
+
+	/* Finish talking to the current client before listening to the others */
+	if (current_session != NULL)
+		pq_flush();
+
+	for (;;)
+	{
+		PooledSession *ready = NULL;
+		bool		accept_pending = false;
+		int			nevents;
+
+		/* Anything we have already read from the current client comes first */
+		if (current_session != NULL && pq_buffer_remaining_data() > 0)
+			return switched;
+
+		if (pool_wait_set == NULL)
+			build_wait_set();
+
+		nevents = WaitEventSetWait(pool_wait_set, -1, pool_events,
+								   pool_nevents, WAIT_EVENT_CLIENT_READ);
+
+		for (int i = 0; i < nevents; i++)
+		{
+			WaitEvent  *event = &pool_events[i];
+
+			if (event->events & WL_LATCH_SET)
+			{
+				ResetLatch(MyLatch);
+				ProcessClientReadInterrupt(true);
+			}
+			else if (event->pos == POOL_LISTEN_POS)
+				accept_pending = true;
+			else if (event->events & WL_SOCKET_READABLE)
+			{
+				PooledSession *session = (PooledSession *) event->user_data;
+
+				if (session == current_session)
+					return switched;
+				if (ready == NULL)
+					ready = session;
+			}
+		}
+
+		if (ready != NULL)
+		{
+			switch_session(ready);
+			return true;
+		}
+
+		if (accept_pending)
+		{
+			PooledSession *old = current_session;
+
+			accept_sessions();
+			if (current_session != old)
+				switched = true;
+		}
+	}
+#endif
+}
+
+/*
+ * SessionPoolEndSession
+ *		The client of the current session has gone away.
+ *
+ * Called by PostgresMain in a pool backend.  Returns true if the backend
+ * should carry on serving its other sessions, or false if it has none left
+ * and should exit.
+ */
+bool
+SessionPoolEndSession(void)
+{
+#ifdef WIN32
+	return false;
+#else
+	SessionPoolSlot *slot = &SessionPoolSlots[MyProcNumber];
+	bool		keep_going;
+
+	Assert(am_pool_backend && current_session != NULL);
+
+	/* Get rid of whatever the session leaves behind */
+	AbortOutOfAnyTransaction();
+	DropAllPreparedStatements();
+	ResetSequenceCaches();
+
+	LWLockAcquire(SessionPoolLock, LW_EXCLUSIVE);
+	slot->nsessions--;
+	keep_going = (slot->nsessions > 0 || slot->npending > 0);
+	if (!keep_going)
+		slot->pid = 0;
+	LWLockRelease(SessionPoolLock);
+
+	if (!keep_going)
+	{
+		/* Nobody can reach us anymore, so just clean up and exit */
+		closesocket(listen_sock);
+		listen_sock = PGINVALID_SOCKET;
+		return false;
+	}
+
+	/*
+	 * MyProcPort keeps pointing to the session's Port until we switch to
+	 * another session, so that can't go away just yet.
+	 */
+	pooled_sessions = list_delete_ptr(pooled_sessions, current_session);
+	closed_session = current_session;
+	current_session = NULL;
+	whereToSendOutput = DestNone;
+
+	if (pool_wait_set != NULL)
+	{
+		FreeWaitEventSet(pool_wait_set);
+		pool_wait_set = NULL;
+	}
+
+	return true;
+#endif
+}
+
+/*
+ * SessionPoolConfigReloaded
+ *		Note that the configuration file has been reloaded.
+ *
+ * The settings saved for the sessions we are not serving right now predate
+ * the reload, so they need to see it when they become current again.
+ */
+void
+SessionPoolConfigReloaded(void)
+{
+	foreach_ptr(PooledSession, session, pooled_sessions)
+	{
+		if (session != current_session)
+			session->config_stale = true;
+	}
+}
+
+/*
+ * SessionPoolCountSessions
+ *		Count the pooled sessions that don't have a backend of their own.
+ *
+ * A pool backend counts as a connection like any other backend, but the
+ * sessions it serves in addition to the first, and those on their way to
+ * it, don't occupy a PGPROC.  This counts those of the given database and
+ * authenticated user, or of all of them if InvalidOid is passed, for the
+ * caller to add to the number of backends when enforcing connection limits.
+ * Like those limits, the result is approximate: a session that is being
+ * handed over is also counted as its sending backend, until that exits.
+ */
+int
+SessionPoolCountSessions(Oid dboid, Oid roleid)
+{
+	int			count = 0;
+
+	if (SessionPoolSlots == NULL)
+		return 0;
+
+	LWLockAcquire(SessionPoolLock, LW_SHARED);
+	for (int i = 0; i < MaxBackends; i++)
+	{
+		SessionPoolSlot *slot = &SessionPoolSlots[i];
+
+		if (slot->pid == 0 ||
+			(OidIsValid(dboid) && slot->dboid != dboid) ||
+			(OidIsValid(roleid) && slot->roleid != roleid))
+			continue;
+
+		count += Max(slot->nsessions - 1, 0) + slot->npending;
+	}
+	LWLockRelease(SessionPoolLock);
+
+	return count;
+}
+
+#ifndef WIN32
+
+/*
+ * Deregister a pool backend at exit.
+ */
+static void
+session_pool_shmem_exit(int code, Datum arg)
+{
+	struct sockaddr_un addr;
+
+	LWLockAcquire(SessionPoolLock, LW_EXCLUSIVE);
+	SessionPoolSlots[MyProcNumber].pid = 0;
+	LWLockRelease(SessionPoolLock);
+
+	get_socket_path(MyProcPid, &addr);
+	(void) unlink(addr.sun_path);
+}
+
+/*
+ * Fill in the address of the hand-off socket of the given pool backend.
+ * It's relative to the data directory, which is our working directory.
+ */
+static void
+get_socket_path(pid_t pid, struct sockaddr_un *addr)
+{
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/%d",
+			 PG_SESSIONPOOL_DIR, (int) pid);
+}
+
+/*
+ * Create the socket on which a new pool backend accepts sessions.
+ */
+static bool
+create_listen_socket(void)
+{
+	struct sockaddr_un addr;
+	pgsocket	sock;
+
+	get_socket_path(MyProcPid, &addr);
+
+	/* A socket left behind by an earlier process with our PID is stale */
+	(void) unlink(addr.sun_path);
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock == PGINVALID_SOCKET)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not create session pool socket: %m")));
+		return false;
+	}
+
+	if (bind(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+		listen(sock, SOMAXCONN) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not listen on session pool socket \"%s\": %m",
+						addr.sun_path)));
+		closesocket(sock);
+		(void) unlink(addr.sun_path);
+		return false;
+	}
+
+	if (!pg_set_noblock(sock) || fcntl(sock, F_SETFD, FD_CLOEXEC) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not set up session pool socket \"%s\": %m",
+						addr.sun_path)));
+		closesocket(sock);
+		(void) unlink(addr.sun_path);
+		return false;
+	}
+
+	listen_sock = sock;
+	return true;
+}
+
+/*
+ * Allocate a PooledSession with a memory context of its own.
+ */
+static PooledSession *
+new_session(void)
+{
+	MemoryContext cxt;
+	PooledSession *session;
+
+	cxt = AllocSetContextCreate(TopMemoryContext,
+								"PooledSession",
+								ALLOCSET_SMALL_SIZES);
+	session = MemoryContextAllocZero(cxt, sizeof(PooledSession));
+	session->cxt = cxt;
+
+	return session;
+}
+
+static void
+send_string(StringInfo buf, const char *str)
+{
+	pq_sendbyte(buf, str != NULL);
+	if (str != NULL)
+		pq_sendbytes(buf, str, strlen(str) + 1);
+}
+
+static char *
+get_string(StringInfo msg)
+{
+	if (pq_getmsgbyte(msg) == 0)
+		return NULL;
+	return pstrdup(pq_getmsgrawstring(msg));
+}
+
+/*
+ * Describe the current session for a pool backend to take it over.
+ *
+ * The Port struct is copied as is, since the receiver runs the same
+ * executable; the strings it points to follow it, and receive_session()
+ * fixes up the pointers.
+ */
+static void
+build_payload(StringInfo buf)
+{
+	Port	   *port = MyProcPort;
+	Size		size;
+	uint32		len;
+
+	/* Room for the total length, filled in at the end */
+	pq_sendint32(buf, 0);
+
+	pq_sendbytes(buf, port, sizeof(Port));
+	send_string(buf, port->remote_host);
+	send_string(buf, port->remote_hostname);
+	send_string(buf, port->remote_port);
+	send_string(buf, port->database_name);
+	send_string(buf, port->user_name);
+	send_string(buf, port->cmdline_options);
+	send_string(buf, port->application_name);
+	pq_sendint32(buf, list_length(port->guc_options));
+	foreach_ptr(char, opt, port->guc_options)
+		send_string(buf, opt);
+
+	pq_sendint32(buf, MyCancelKeyLength);
+	pq_sendbytes(buf, MyCancelKey, MyCancelKeyLength);
+
+	pq_sendint32(buf, GetSessionUserId());
+	pq_sendbyte(buf, GetSessionUserIsSuperuser());
+	pq_sendint32(buf, GetCurrentRoleId());
+	pq_sendbyte(buf, current_role_is_superuser);
+
+	size = EstimateClientConnectionInfoSpace();
+	enlargeStringInfo(buf, size + sizeof(int32));
+	pq_sendint32(buf, size);
+	SerializeClientConnectionInfo(size, buf->data + buf->len);
+	buf->len += size;
+
+	size = EstimateGUCSessionStateSpace();
+	enlargeStringInfo(buf, size + sizeof(int32));
+	pq_sendint32(buf, size);
+	SerializeGUCSessionState(size, buf->data + buf->len);
+	buf->len += size;
+
+	len = buf->len;
+	memcpy(buf->data, &len, sizeof(len));
+}
+
+/*
+ * Connect to the hand-off socket of the given pool backend.
+ *
+ * Returns PGINVALID_SOCKET if that failed; the problem has been logged.
+ */
+static pgsocket
+connect_pool_backend(pid_t pid)
+{
+	struct sockaddr_un addr;
+	pgsocket	sock;
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock == PGINVALID_SOCKET)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not create socket for session hand-off: %m")));
+		return PGINVALID_SOCKET;
+	}
+
+	get_socket_path(pid, &addr);
+	if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not connect to session pool socket \"%s\": %m",
+						addr.sun_path)));
+		closesocket(sock);
+		return PGINVALID_SOCKET;
+	}
+
+	return sock;
+}
+
+/*
+ * Pass the client connection and the payload to a pool backend, over a
+ * socket connected to it by connect_pool_backend(), and close that.
+ *
+ * Returns false if that failed.  The client socket may still have reached
+ * the pool backend, but that will discard it without using it unless it has
+ * received the whole payload.
+ */
+static bool
+send_session(pgsocket sock, StringInfo payload)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr hdr;
+		char		data[CMSG_SPACE(sizeof(int))];
+	}			cmsgbuf;
+	struct cmsghdr *cmsg;
+	int			offset;
+
+	/* The client socket travels with the first part of the payload */
+	memset(&msg, 0, sizeof(msg));
+	memset(&cmsgbuf, 0, sizeof(cmsgbuf));
+	iov.iov_base = payload->data;
+	iov.iov_len = payload->len;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsgbuf.data;
+	msg.msg_controllen = sizeof(cmsgbuf.data);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &MyProcPort->sock, sizeof(int));
+
+	offset = 0;
+	while (offset < payload->len)
+	{
+		ssize_t		rc;
+
+		if (offset == 0)
+			rc = sendmsg(sock, &msg, 0);
+		else
+			rc = send(sock, payload->data + offset, payload->len - offset, 0);
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not send session to session pool: %m")));
+			closesocket(sock);
+			return false;
+		}
+		offset += rc;
+	}
+
+	closesocket(sock);
+	return true;
+}
+
+/*
+ * Read all of len bytes from a blocking socket.
+ */
+static bool
+recv_all(pgsocket sock, char *buf, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t		rc = recv(sock, buf, len, 0);
+
+		if (rc < 0 && errno == EINTR)
+			continue;
+		if (rc <= 0)
+			return false;
+		buf += rc;
+		len -= rc;
+	}
+	return true;
+}
+
+/*
+ * Receive a session from a backend that has connected to our listen socket.
+ *
+ * Returns NULL if that didn't work; the problem has been logged.
+ */
+static PooledSession *
+receive_session(pgsocket conn)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		struct cmsghdr hdr;
+		char		data[CMSG_SPACE(sizeof(int))];
+	}			cmsgbuf;
+	struct cmsghdr *cmsg;
+	uint32		len;
+	int			client_sock = -1;
+	ssize_t		rc;
+	char	   *data;
+	StringInfoData buf;
+	PooledSession *session;
+	MemoryContext oldcxt;
+	Port	   *port;
+	int			n;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = &len;
+	iov.iov_len = sizeof(len);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsgbuf.data;
+	msg.msg_controllen = sizeof(cmsgbuf.data);
+
+	do
+	{
+		rc = recvmsg(conn, &msg, 0);
+	} while (rc < 0 && errno == EINTR);
+
+	for (cmsg = CMSG_FIRSTHDR(&msg); rc > 0 && cmsg != NULL;
+		 cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+			memcpy(&client_sock, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	if (client_sock < 0 || rc < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not receive session from session pool socket: %m")));
+		return NULL;
+	}
+
+	/* The rest of the length word may follow separately */
+	if (rc < sizeof(len) &&
+		!recv_all(conn, ((char *) &len) + rc, sizeof(len) - rc))
+		len = 0;
+
+	data = NULL;
+	if (len > sizeof(len))
+	{
+		data = palloc(len);
+		if (!recv_all(conn, data + sizeof(len), len - sizeof(len)))
+		{
+			pfree(data);
+			data = NULL;
+		}
+	}
+
+	if (data == NULL ||
+		fcntl(client_sock, F_SETFD, FD_CLOEXEC) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not receive session from session pool socket: %m")));
+		close(client_sock);
+		if (data)
+			pfree(data);
+		return NULL;
+	}
+
+	initReadOnlyStringInfo(&buf, data, len);
+	buf.cursor = sizeof(len);
+
+	session = new_session();
+	oldcxt = MemoryContextSwitchTo(session->cxt);
+
+	port = palloc(sizeof(Port));
+	pq_copymsgbytes(&buf, port, sizeof(Port));
+	port->sock = client_sock;
+	port->remote_host = get_string(&buf);
+	port->remote_hostname = get_string(&buf);
+	port->remote_port = get_string(&buf);
+	port->database_name = get_string(&buf);
+	port->user_name = get_string(&buf);
+	port->cmdline_options = get_string(&buf);
+	port->application_name = get_string(&buf);
+	port->guc_options = NIL;
+	n = pq_getmsgint(&buf, 4);
+	for (int i = 0; i < n; i++)
+		port->guc_options = lappend(port->guc_options, get_string(&buf));
+
+	/* These are only used for authentication, or for encrypted connections */
+	port->hba = NULL;
+	port->gss = NULL;
+	port->ssl = NULL;
+	port->peer = NULL;
+	port->peer_cn = NULL;
+	port->peer_dn = NULL;
+	port->raw_buf = NULL;
+	port->raw_buf_consumed = port->raw_buf_remaining = 0;
+	session->port = port;
+
+	session->cancel_key_len = pq_getmsgint(&buf, 4);
+	if (session->cancel_key_len > MAX_CANCEL_KEY_LENGTH)
+		elog(ERROR, "invalid cancel key length in session hand-off");
+	pq_copymsgbytes(&buf, session->cancel_key, session->cancel_key_len);
+
+	session->session_user_id = pq_getmsgint(&buf, 4);
+	session->session_user_is_superuser = pq_getmsgbyte(&buf);
+	session->outer_user_id = pq_getmsgint(&buf, 4);
+	session->role_is_superuser = pq_getmsgbyte(&buf);
+
+	n = pq_getmsgint(&buf, 4);
+	session->conninfo = palloc(n);
+	pq_copymsgbytes(&buf, session->conninfo, n);
+
+	n = pq_getmsgint(&buf, 4);
+	session->gucstate = palloc(n);
+	pq_copymsgbytes(&buf, session->gucstate, n);
+
+	pq_getmsgend(&buf);
+
+	MemoryContextSwitchTo(oldcxt);
+	pfree(data);
+
+	return session;
+}
+
+/*
+ * Accept the sessions that other backends are handing over to us.
+ *
+ * Each new session becomes the current one long enough to tell the client
+ * that it is ready for queries.
+ */
+static void
+accept_sessions(void)
+{
+	SessionPoolSlot *slot = &SessionPoolSlots[MyProcNumber];
+
+	for (;;)
+	{
+		pgsocket	conn;
+		PooledSession *session;
+		StringInfoData buf;
+
+		conn = accept(listen_sock, NULL, NULL);
+		if (conn == PGINVALID_SOCKET)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				ereport(LOG,
+						(errcode_for_socket_access(),
+						 errmsg("could not accept session: %m")));
+			return;
+		}
+
+		/* The sender writes everything right away, so we can block */
+		if (!pg_set_block(conn))
+		{
+			ereport(LOG,
+					(errcode_for_socket_access(),
+					 errmsg("could not accept session: %m")));
+			closesocket(conn);
+			continue;
+		}
+
+		session = receive_session(conn);
+		closesocket(conn);
+
+		/*
+		 * The sender counted the session as pending before sending anything,
+		 * and leaves it to us to undo that, even if it fails.
+		 */
+		LWLockAcquire(SessionPoolLock, LW_EXCLUSIVE);
+		slot->npending--;
+		if (session != NULL)
+			slot->nsessions++;
+		LWLockRelease(SessionPoolLock);
+
+		if (session == NULL)
+			continue;
+
+		pooled_sessions = lappend(pooled_sessions, session);
+		if (pool_wait_set != NULL)
+		{
+			FreeWaitEventSet(pool_wait_set);
+			pool_wait_set = NULL;
+		}
+
+		switch_session(session);
+
+		/* Tell the client how to cancel its queries, and that we're ready */
+		pq_beginmessage(&buf, PqMsg_BackendKeyData);
+		pq_sendint32(&buf, (int32) MyProcPid);
+		pq_sendbytes(&buf, MyCancelKey, MyCancelKeyLength);
+		pq_endmessage(&buf);
+
+		EventTriggerOnLogin();
+
+		ReportChangedGUCOptions();
+		ReadyForQuery(DestRemote);
+	}
+}
+
+/*
+ * Stash away the state of the current session.
+ */
+static void
+save_session(PooledSession *session)
+{
+	Size		size;
+
+	if (session->gucstate)
+		pfree(session->gucstate);
+	size = EstimateGUCSessionStateSpace();
+	session->gucstate = MemoryContextAlloc(session->cxt, size);
+	SerializeGUCSessionState(size, session->gucstate);
+
+	session->session_user_id = GetSessionUserId();
+	session->session_user_is_superuser = GetSessionUserIsSuperuser();
+	session->outer_user_id = GetCurrentRoleId();
+	session->role_is_superuser = current_role_is_superuser;
+
+	session->prepared_statements = SavePreparedStatements();
+	session->sequences = SaveSequenceState();
+	session->config_stale = false;
+}
+
+/*
+ * Make the given session the current one.
+ *
+ * The current session, if any, must be idle outside a transaction.
+ */
+static void
+switch_session(PooledSession *session)
+{
+	MemoryContext oldcxt = CurrentMemoryContext;
+
+	Assert(!IsTransactionOrTransactionBlock());
+
+	if (session == current_session)
+		return;
+
+	if (current_session != NULL)
+		save_session(current_session);
+
+	pq_switch_port(session->port);
+	whereToSendOutput = DestRemote;
+	FrontendProtocol = session->port->proto;
+	memcpy(MyCancelKey, session->cancel_key, session->cancel_key_len);
+	MyCancelKeyLength = session->cancel_key_len;
+	ProcSignalSetCancelKey(MyCancelKey, MyCancelKeyLength);
+	current_session = session;
+
+	/* Now the Port of a closed session can go away */
+	if (closed_session != NULL)
+	{
+		closesocket(closed_session->port->sock);
+		MemoryContextDelete(closed_session->cxt);
+		closed_session = NULL;
+	}
+
+	if (MyClientConnectionInfo.authn_id)
+		pfree(unconstify(char *, MyClientConnectionInfo.authn_id));
+	RestoreClientConnectionInfo(session->conninfo);
+
+	RestorePreparedStatements(session->prepared_statements);
+	session->prepared_statements = NULL;
+	RestoreSequenceState(session->sequences);
+	session->sequences = NULL;
+
+	/*
+	 * Restore the settings the same way a parallel worker copies its
+	 * leader's: set up the role identities first, then trust them rather
+	 * than checking them against the catalogs again.  The role might have
+	 * lost some privileges since the session adopted it, but that doesn't
+	 * matter to a session in a dedicated backend either.
+	 */
+	SetSessionAuthorization(session->session_user_id,
+							session->session_user_is_superuser);
+	SetCurrentRoleId(session->outer_user_id, session->role_is_superuser);
+
+	StartTransactionCommand();
+	InitializingParallelWorker = true;
+	PG_TRY();
+	{
+		RestoreGUCState(session->gucstate);
+	}
+	PG_FINALLY();
+	{
+		InitializingParallelWorker = false;
+	}
+	PG_END_TRY();
+	CommitTransactionCommand();
+
+	if (session->config_stale)
+	{
+		ProcessConfigFile(PGC_SIGHUP);
+		session->config_stale = false;
+	}
+
+	pgstat_report_client();
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Set up pool_wait_set to wait for all of our sessions, new sessions, and
+ * our latch.
+ */
+static void
+build_wait_set(void)
+{
+	int			nevents = list_length(pooled_sessions) + 3;
+	int			pos PG_USED_FOR_ASSERTS_ONLY;
+
+	pool_wait_set = CreateWaitEventSet(NULL, nevents);
+
+	if (pool_events)
+		pfree(pool_events);
+	pool_events = MemoryContextAlloc(TopMemoryContext,
+									 sizeof(WaitEvent) * nevents);
+	pool_nevents = nevents;
+
+	pos = AddWaitEventToSet(pool_wait_set, WL_LATCH_SET, PGINVALID_SOCKET,
+							MyLatch, NULL);
+	Assert(pos == POOL_LATCH_POS);
+	AddWaitEventToSet(pool_wait_set, WL_EXIT_ON_PM_DEATH, PGINVALID_SOCKET,
+					  NULL, NULL);
+	pos = AddWaitEventToSet(pool_wait_set, WL_SOCKET_ACCEPT, listen_sock,
+							NULL, NULL);
+	Assert(pos == POOL_LISTEN_POS);
+
+	foreach_ptr(PooledSession, session, pooled_sessions)
+		AddWaitEventToSet(pool_wait_set, WL_SOCKET_READABLE,
+						  session->port->sock, NULL, session);
+}
+
+#endif							/* !WIN32 */
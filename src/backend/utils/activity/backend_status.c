@@ -750,6 +750,40 @@ pgstat_report_appname(const char *appname)
 	PGSTAT_END_WRITE_ACTIVITY(beentry);
 }
 
+/* ----------
+ * pgstat_report_client() -
+ *
+ *	Called by session pooling when the backend starts serving another client
+ *	session, to update our client address and session user.
+ * ----------
+ */
+void
+pgstat_report_client(void)
+{
+	volatile PgBackendStatus *beentry = MyBEEntry;
+
+	if (!beentry || !MyProcPort)
+		return;
+
+	/*
+	 * Update my status entry, following the protocol of bumping
+	 * st_changecount before and after.  We use a volatile pointer here to
+	 * ensure the compiler doesn't try to get cute.
+	 */
+	PGSTAT_BEGIN_WRITE_ACTIVITY(beentry);
+
+	memcpy(unvolatize(SockAddr *, &beentry->st_clientaddr), &MyProcPort->raddr,
+		   sizeof(beentry->st_clientaddr));
+	if (MyProcPort->remote_hostname)
+		strlcpy(beentry->st_clienthostname, MyProcPort->remote_hostname,
+				NAMEDATALEN);
+	else
+		beentry->st_clienthostname[0] = '\0';
+	beentry->st_userid = GetSessionUserId();
+
+	PGSTAT_END_WRITE_ACTIVITY(beentry);
+}
+
 /*
  * Report current transaction start timestamp as the specified value.
  * Zero means there is no active transaction.
@@ -489,12 +489,14 @@ pgstat_tracks_io_op(BackendType bktype, IOObject io_object,
 	 * Some BackendTypes will not do certain IOOps.
 	 */
 	if (bktype == B_BG_WRITER &&
-		(io_op == IOOP_READ || io_op == IOOP_EVICT || io_op == IOOP_HIT))
+		(io_op == IOOP_READ || io_op == IOOP_EVICT || io_op == IOOP_HIT ||
+		 io_op == IOOP_REMOTE_HIT))
 		return false;
 
 	if (bktype == B_CHECKPOINTER &&
 		((io_object != IOOBJECT_WAL && io_op == IOOP_READ) ||
-		 (io_op == IOOP_EVICT || io_op == IOOP_HIT)))
+		 (io_op == IOOP_EVICT || io_op == IOOP_HIT ||
+		  io_op == IOOP_REMOTE_HIT)))
 		return false;
 
 	if ((bktype == B_AUTOVAC_LAUNCHER || bktype == B_BG_WRITER ||
@@ -518,6 +520,13 @@ pgstat_tracks_io_op(BackendType bktype, IOObject io_object,
 		(io_op == IOOP_FSYNC || io_op == IOOP_WRITEBACK))
 		return false;
 
+	/*
+	 * Remote hits are hits on shared buffers placed on another NUMA node than
+	 * the backend's, which local buffers never are.
+	 */
+	if (io_object == IOOBJECT_TEMP_RELATION && io_op == IOOP_REMOTE_HIT)
+		return false;
+
 	/*
 	 * Some IOOps are not valid in certain IOContexts and some IOOps are only
 	 * valid in certain contexts.
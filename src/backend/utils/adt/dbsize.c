@@ -357,6 +357,21 @@ calculate_relation_size(RelFileLocator *rfn, ProcNumber backend, ForkNumber fork
 		totalsize += fst.st_size;
 	}
 
+	/* Include the address map of a compressed main fork */
+	if (forknum == MAIN_FORKNUM)
+	{
+		struct stat fst;
+
+		snprintf(pathname, MAXPGPATH, "%s%s",
+				 relationpath.str, PAGE_COMPRESS_MAP_SUFFIX);
+		if (stat(pathname, &fst) == 0)
+			totalsize += fst.st_size;
+		else if (errno != ENOENT)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not stat file \"%s\": %m", pathname)));
+	}
+
 	return totalsize;
 }
 
@@ -1359,6 +1359,7 @@ typedef enum io_stat_col
 	IO_COL_EXTEND_BYTES,
 	IO_COL_EXTEND_TIME,
 	IO_COL_HITS,
+	IO_COL_REMOTE_HITS,
 	IO_COL_EVICTIONS,
 	IO_COL_REUSES,
 	IO_COL_FSYNCS,
@@ -1384,6 +1385,8 @@ pgstat_get_io_op_index(IOOp io_op)
 			return IO_COL_FSYNCS;
 		case IOOP_HIT:
 			return IO_COL_HITS;
+		case IOOP_REMOTE_HIT:
+			return IO_COL_REMOTE_HITS;
 		case IOOP_READ:
 			return IO_COL_READS;
 		case IOOP_REUSE:
@@ -1416,6 +1419,7 @@ pgstat_get_io_byte_index(IOOp io_op)
 		case IOOP_EVICT:
 		case IOOP_FSYNC:
 		case IOOP_HIT:
+		case IOOP_REMOTE_HIT:
 		case IOOP_REUSE:
 		case IOOP_WRITEBACK:
 			return IO_COL_INVALID;
@@ -1446,6 +1450,7 @@ pgstat_get_io_time_index(IOOp io_op)
 			return IO_COL_FSYNC_TIME;
 		case IOOP_EVICT:
 		case IOOP_HIT:
+		case IOOP_REMOTE_HIT:
 		case IOOP_REUSE:
 			return IO_COL_INVALID;
 	}
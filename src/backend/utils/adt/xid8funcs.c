@@ -26,6 +26,7 @@
 
 #include "postgres.h"
 
+#include "access/csnlog.h"
 #include "access/transam.h"
 #include "access/xact.h"
 #include "funcapi.h"
@@ -380,6 +381,10 @@ pg_current_snapshot(PG_FUNCTION_ARGS)
 	if (cur == NULL)
 		elog(ERROR, "no active snapshot set");
 
+	/* A CSN-based snapshot doesn't list the running transactions */
+	if (cur->csn != InvalidCommitSeqNo)
+		cur = MaterializeSnapshot(cur);
+
 	/* allocate */
 	nxip = cur->xcnt;
 	snap = palloc(PG_SNAPSHOT_SIZE(nxip));
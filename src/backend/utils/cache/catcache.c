@@ -39,6 +39,8 @@
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/resowner.h"
+#include "utils/sharedcatcache.h"
+#include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
 /*
@@ -114,6 +116,10 @@ static void CatalogCacheInitializeCache(CatCache *cache);
 static CatCTup *CatalogCacheCreateEntry(CatCache *cache, HeapTuple ntp,
 										Datum *arguments,
 										uint32 hashValue, Index hashIndex);
+static bool SharedCatCacheUsable(CatCache *cache);
+static CatCTup *SearchCatCacheShared(CatCache *cache, int nkeys, Oid dbid,
+									 uint32 hashValue, Index hashIndex,
+									 Datum *arguments);
 
 static void ReleaseCatCacheWithOwner(HeapTuple tuple, ResourceOwner resowner);
 static void ReleaseCatCacheListWithOwner(CatCList *list, ResourceOwner resowner);
@@ -1544,6 +1550,9 @@ SearchCatCacheMiss(CatCache *cache,
 	CatCTup    *ct;
 	bool		stale;
 	Datum		arguments[CATCACHE_MAXKEYS];
+	bool		use_shared;
+	Oid			shared_dbid = InvalidOid;
+	uint64		shared_stamp = 0;
 
 	/* Initialize local parameter array */
 	arguments[0] = v1;
@@ -1551,6 +1560,37 @@ SearchCatCacheMiss(CatCache *cache,
 	arguments[2] = v3;
 	arguments[3] = v4;
 
+	/*
+	 * If another backend has already fetched the tuple, we may find it in
+	 * the shared catalog cache.  Otherwise, remember the tuple's generation
+	 * there before scanning, so that we can publish what we find, and make
+	 * sure the scan uses a snapshot taken after that point (see
+	 * sharedcatcache.c).
+	 */
+	use_shared = SharedCatCacheUsable(cache);
+	if (use_shared)
+	{
+		shared_dbid = cache->cc_relisshared ? InvalidOid : MyDatabaseId;
+
+		ct = SearchCatCacheShared(cache, nkeys, shared_dbid,
+								  hashValue, hashIndex, arguments);
+		if (ct != NULL)
+		{
+			ResourceOwnerEnlarge(CurrentResourceOwner);
+			ct->refcount++;
+			ResourceOwnerRememberCatCacheRef(CurrentResourceOwner, &ct->tuple);
+
+			CACHE_elog(DEBUG2, "SearchCatCache(%s): found in shared cache",
+					   cache->cc_relname);
+
+			return &ct->tuple;
+		}
+
+		shared_stamp = SharedCatCacheGetStamp(shared_dbid, cache->id,
+											  hashValue);
+		InvalidateCatalogSnapshot();
+	}
+
 	/*
 	 * Tuple was not found in cache, so we have to try to retrieve it directly
 	 * from the relation.  If found, we will add it to the cache; if not
@@ -1652,6 +1692,10 @@ SearchCatCacheMiss(CatCache *cache,
 		return NULL;
 	}
 
+	if (use_shared && !ct->dead)
+		SharedCatCacheInsert(shared_dbid, cache->id, hashValue, &ct->tuple,
+							 shared_stamp);
+
 	CACHE_elog(DEBUG2, "SearchCatCache(%s): Contains %d/%d tuples",
 			   cache->cc_relname, cache->cc_ntup, CacheHdr->ch_ntup);
 	CACHE_elog(DEBUG2, "SearchCatCache(%s): put in bucket %d",
@@ -1664,6 +1708,60 @@ SearchCatCacheMiss(CatCache *cache,
 	return &ct->tuple;
 }
 
+/*
+ * Can this catcache miss be satisfied from, and its result be published to,
+ * the shared catalog cache?
+ *
+ * The shared catalog cache only holds committed catalog rows.  A transaction
+ * that has modified the catalogs must see its own changes, and logical
+ * decoding looks at the catalogs as of some point in the past, so neither
+ * can use it.
+ */
+static bool
+SharedCatCacheUsable(CatCache *cache)
+{
+	if (!SharedCatCacheIsEnabled() || IsBootstrapProcessingMode())
+		return false;
+	if (!cache->cc_relisshared && !OidIsValid(MyDatabaseId))
+		return false;
+	if (HistoricSnapshotActive())
+		return false;
+	if (TransactionHasPendingInvalidations())
+		return false;
+	return true;
+}
+
+/*
+ * Look for the tuple in the shared catalog cache, and if it's there, enter
+ * it in the local cache.  Returns the new entry with zero refcount, or NULL.
+ */
+static CatCTup *
+SearchCatCacheShared(CatCache *cache, int nkeys, Oid dbid,
+					 uint32 hashValue, Index hashIndex, Datum *arguments)
+{
+	HeapTuple	ntp;
+	CatCTup    *ct;
+
+	ntp = SharedCatCacheLookup(dbid, cache->id, hashValue);
+	if (ntp == NULL)
+		return NULL;
+
+	ct = CatalogCacheCreateEntry(cache, ntp, NULL, hashValue, hashIndex);
+	heap_freetuple(ntp);
+	if (ct == NULL)
+		return NULL;
+
+	/*
+	 * The shared cache is keyed by hash value only, so it might have handed
+	 * us a different tuple.  That one is still valid, so just leave it in
+	 * the local cache and let the caller scan the catalog for ours.
+	 */
+	if (!CatalogCacheCompareTuple(cache, nkeys, ct->keys, arguments))
+		return NULL;
+
+	return ct;
+}
+
 /*
  *	ReleaseCatCache
  *
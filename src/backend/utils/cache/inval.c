@@ -995,6 +995,19 @@ PostPrepare_Inval(void)
 	AtEOXact_Inval(false);
 }
 
+/*
+ * TransactionHasPendingInvalidations
+ *		Has the current transaction queued any invalidation messages?
+ *
+ * If so, it may have modified catalog rows in ways that other sessions
+ * cannot see yet.
+ */
+bool
+TransactionHasPendingInvalidations(void)
+{
+	return transInvalInfo != NULL || inplaceInvalInfo != NULL;
+}
+
 /*
  * xactGetCommittedInvalidationMessages() is called by
  * RecordTransactionCommit() to collect invalidation messages to add to the
@@ -67,10 +67,12 @@
 #include "storage/lmgr.h"
 #include "tcop/pquery.h"
 #include "tcop/utility.h"
+#include "utils/guc_tables.h"
 #include "utils/inval.h"
 #include "utils/memutils.h"
 #include "utils/resowner.h"
 #include "utils/rls.h"
+#include "utils/sharedplancache.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
 
@@ -98,6 +100,13 @@ static CachedPlan *BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 								   ParamListInfo boundParams, QueryEnvironment *queryEnv);
 static bool choose_custom_plan(CachedPlanSource *plansource,
 							   ParamListInfo boundParams);
+static bool SharedPlanCacheUsable(CachedPlanSource *plansource,
+								  QueryEnvironment *queryEnv);
+static StringInfo SharedPlanCacheKey(CachedPlanSource *plansource);
+static bool SharedPlanDependencies(CachedPlanSource *plansource, List *plist,
+								   List **relationOids, List **invalItems);
+static bool SharedPlanContainsExtensibleNodes(Plan *plan);
+static bool SharedPlanListContainsExtensibleNodes(List *list);
 static double cached_plan_cost(CachedPlan *plan, bool include_planner);
 static Query *QueryListGetPrimaryStmt(List *stmts);
 static void AcquireExecutorLocks(List *stmt_list, bool acquire);
@@ -1037,12 +1046,16 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 				ParamListInfo boundParams, QueryEnvironment *queryEnv)
 {
 	CachedPlan *plan;
-	List	   *plist;
+	List	   *plist = NIL;
 	bool		snapshot_set;
 	bool		is_transient;
 	MemoryContext plan_context;
 	MemoryContext oldcxt = CurrentMemoryContext;
 	ListCell   *lc;
+	StringInfo	shared_key = NULL;
+	uint64		shared_stamp = 0;
+	List	   *relationOids;
+	List	   *invalItems;
 
 	/*
 	 * Normally the querytree should be valid already, but if it's not,
@@ -1061,39 +1074,93 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 		qlist = RevalidateCachedQuery(plansource, queryEnv);
 
 	/*
-	 * If we don't already have a copy of the querytree list that can be
-	 * scribbled on by the planner, make one.  For a one-shot plan, we assume
-	 * it's okay to scribble on the original query_list.
+	 * A generic plan may already have been made by another backend and put
+	 * in the shared plan cache.  If not, read the sequence stamp that our
+	 * plan will carry there, and then catch up with invalidations, so that
+	 * we plan with catalog state at least as new as the stamp says.  If
+	 * that turns out to invalidate the query tree, carry on planning as we
+	 * would have anyway, but don't publish the result.
 	 */
-	if (qlist == NIL)
+	if (boundParams == NULL && SharedPlanCacheUsable(plansource, queryEnv))
 	{
-		if (!plansource->is_oneshot)
-			qlist = copyObject(plansource->query_list);
+		shared_key = SharedPlanCacheKey(plansource);
+		plist = SharedPlanCacheLookup(shared_key->data, shared_key->len,
+									  &shared_stamp);
+
+		/*
+		 * A shared plan can mention relations the query tree doesn't, such
+		 * as partitions, which the planner would have locked for us.  Lock
+		 * them, and make sure the plan didn't go stale while we waited.
+		 */
+		if (plist != NIL)
+		{
+			AcquireExecutorLocks(plist, true);
+			if (!plansource->is_valid ||
+				!SharedPlanDependencies(plansource, plist,
+										&relationOids, &invalItems) ||
+				!SharedPlanCacheIsCurrent(relationOids, invalItems,
+										  shared_stamp))
+			{
+				AcquireExecutorLocks(plist, false);
+				plist = NIL;
+			}
+		}
+
+		if (plist == NIL)
+		{
+			shared_stamp = SharedPlanCacheGetStamp();
+			AcceptInvalidationMessages();
+			if (!plansource->is_valid)
+				shared_key = NULL;
+		}
 		else
-			qlist = plansource->query_list;
+			shared_key = NULL;
 	}
 
-	/*
-	 * If a snapshot is already set (the normal case), we can just use that
-	 * for planning.  But if it isn't, and we need one, install one.
-	 */
-	snapshot_set = false;
-	if (!ActiveSnapshotSet() &&
-		BuildingPlanRequiresSnapshot(plansource))
+	if (plist == NIL)
 	{
-		PushActiveSnapshot(GetTransactionSnapshot());
-		snapshot_set = true;
-	}
+		/*
+		 * If we don't already have a copy of the querytree list that can be
+		 * scribbled on by the planner, make one.  For a one-shot plan, we
+		 * assume it's okay to scribble on the original query_list.
+		 */
+		if (qlist == NIL)
+		{
+			if (!plansource->is_oneshot)
+				qlist = copyObject(plansource->query_list);
+			else
+				qlist = plansource->query_list;
+		}
 
-	/*
-	 * Generate the plan.
-	 */
-	plist = pg_plan_queries(qlist, plansource->query_string,
-							plansource->cursor_options, boundParams);
+		/*
+		 * If a snapshot is already set (the normal case), we can just use
+		 * that for planning.  But if it isn't, and we need one, install one.
+		 */
+		snapshot_set = false;
+		if (!ActiveSnapshotSet() &&
+			BuildingPlanRequiresSnapshot(plansource))
+		{
+			PushActiveSnapshot(GetTransactionSnapshot());
+			snapshot_set = true;
+		}
 
-	/* Release snapshot if we got one */
-	if (snapshot_set)
-		PopActiveSnapshot();
+		/*
+		 * Generate the plan.
+		 */
+		plist = pg_plan_queries(qlist, plansource->query_string,
+								plansource->cursor_options, boundParams);
+
+		/* Release snapshot if we got one */
+		if (snapshot_set)
+			PopActiveSnapshot();
+
+		/* Let other backends use the plan, if it's a generic one */
+		if (shared_key != NULL &&
+			SharedPlanDependencies(plansource, plist,
+								   &relationOids, &invalItems))
+			SharedPlanCacheInsert(shared_key->data, shared_key->len, plist,
+								  relationOids, invalItems, shared_stamp);
+	}
 
 	/*
 	 * Normally we make a dedicated memory context for the CachedPlan and its
@@ -1166,6 +1233,196 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 	return plan;
 }
 
+/*
+ * SharedPlanCacheUsable: can we share the generic plan of this plansource
+ * with other backends?
+ *
+ * A transaction that has changed the catalogs must plan with its own view
+ * of them, so it can neither use nor publish shared plans.
+ */
+static bool
+SharedPlanCacheUsable(CachedPlanSource *plansource, QueryEnvironment *queryEnv)
+{
+	if (!SharedPlanCacheIsEnabled())
+		return false;
+	if (plansource->is_oneshot || queryEnv != NULL)
+		return false;
+	if (!plansource->is_valid || !StmtPlanRequiresRevalidation(plansource))
+		return false;
+	if (TransactionHasPendingInvalidations())
+		return false;
+	return true;
+}
+
+/*
+ * SharedPlanCacheKey: build the shared plan cache key for a plansource.
+ *
+ * Two backends can share a generic plan if they have the same analyzed and
+ * rewritten query tree, which already pins down the query text, the objects
+ * that names in it were resolved to, parameter types and row security
+ * policies.  On top of that, planning can depend on the current role, the
+ * search path (when inlining SQL functions), the cursor options and the
+ * planner-related settings, that is, those that EXPLAIN (SETTINGS) shows.
+ */
+static StringInfo
+SharedPlanCacheKey(CachedPlanSource *plansource)
+{
+	StringInfo	key = makeStringInfo();
+	struct config_generic **gucs;
+	int			ngucs;
+	List	   *search_path;
+
+	appendStringInfo(key, "%u %u %d",
+					 MyDatabaseId, GetUserId(), plansource->cursor_options);
+
+	search_path = fetch_search_path(true);
+	foreach_oid(nspid, search_path)
+		appendStringInfo(key, " %u", nspid);
+	list_free(search_path);
+
+	gucs = get_explain_guc_options(&ngucs);
+	for (int i = 0; i < ngucs; i++)
+		appendStringInfo(key, " %s=%s", gucs[i]->name,
+						 ShowGUCOption(gucs[i], false));
+	pfree(gucs);
+
+	appendStringInfoChar(key, ' ');
+	appendStringInfoString(key, nodeToString(plansource->query_list));
+
+	return key;
+}
+
+/*
+ * SharedPlanDependencies: collect the invalidation dependencies of a
+ * generic plan for the shared plan cache, that is, those of the query tree
+ * and of each PlannedStmt, as the invalidation callbacks below check them.
+ *
+ * Returns false if the plan can't be shared.
+ */
+static bool
+SharedPlanDependencies(CachedPlanSource *plansource, List *plist,
+					   List **relationOids, List **invalItems)
+{
+	*relationOids = plansource->relationOids;
+	*invalItems = plansource->invalItems;
+
+	foreach_node(PlannedStmt, plannedstmt, plist)
+	{
+		/*
+		 * Utility statements are never shared, and neither are transient
+		 * plans, whose validity depends on our TransactionXmin.  Extension
+		 * state needn't be serializable.  Nor can other backends read custom
+		 * scans or other extensible nodes unless they happen to have loaded
+		 * the library that provides them.
+		 */
+		if (plannedstmt->commandType == CMD_UTILITY ||
+			plannedstmt->transientPlan ||
+			plannedstmt->extension_state != NIL ||
+			SharedPlanContainsExtensibleNodes(plannedstmt->planTree))
+			return false;
+
+		foreach_ptr(Plan, subplan, plannedstmt->subplans)
+		{
+			if (SharedPlanContainsExtensibleNodes(subplan))
+				return false;
+		}
+
+		*relationOids = list_concat_copy(*relationOids,
+										 plannedstmt->relationOids);
+		*invalItems = list_concat_copy(*invalItems, plannedstmt->invalItems);
+	}
+
+	return true;
+}
+
+/*
+ * SharedPlanContainsExtensibleNodes: does the plan tree contain nodes that
+ * only the library providing them knows how to read back?
+ *
+ * That's CustomScan nodes, and ExtensibleNodes in the private lists of
+ * ForeignScan nodes.
+ */
+static bool
+SharedPlanContainsExtensibleNodes(Plan *plan)
+{
+	if (plan == NULL)
+		return false;
+
+	check_stack_depth();
+
+	switch (nodeTag(plan))
+	{
+		case T_CustomScan:
+			return true;
+		case T_ForeignScan:
+			{
+				ForeignScan *fscan = (ForeignScan *) plan;
+
+				if (SharedPlanListContainsExtensibleNodes(fscan->fdw_private))
+					return true;
+			}
+			break;
+		case T_Append:
+			foreach_ptr(Plan, child, ((Append *) plan)->appendplans)
+			{
+				if (SharedPlanContainsExtensibleNodes(child))
+					return true;
+			}
+			break;
+		case T_MergeAppend:
+			foreach_ptr(Plan, child, ((MergeAppend *) plan)->mergeplans)
+			{
+				if (SharedPlanContainsExtensibleNodes(child))
+					return true;
+			}
+			break;
+		case T_BitmapAnd:
+			foreach_ptr(Plan, child, ((BitmapAnd *) plan)->bitmapplans)
+			{
+				if (SharedPlanContainsExtensibleNodes(child))
+					return true;
+			}
+			break;
+		case T_BitmapOr:
+			foreach_ptr(Plan, child, ((BitmapOr *) plan)->bitmapplans)
+			{
+				if (SharedPlanContainsExtensibleNodes(child))
+					return true;
+			}
+			break;
+		case T_SubqueryScan:
+			if (SharedPlanContainsExtensibleNodes(((SubqueryScan *) plan)->subplan))
+				return true;
+			break;
+		default:
+			break;
+	}
+
+	return SharedPlanContainsExtensibleNodes(plan->lefttree) ||
+		SharedPlanContainsExtensibleNodes(plan->righttree);
+}
+
+/*
+ * SharedPlanListContainsExtensibleNodes: does a private list of a plan
+ * node, or one of the lists nested in it, contain an ExtensibleNode?
+ */
+static bool
+SharedPlanListContainsExtensibleNodes(List *list)
+{
+	foreach_ptr(Node, node, list)
+	{
+		if (node == NULL)
+			continue;
+		if (IsA(node, ExtensibleNode))
+			return true;
+		if (IsA(node, List) &&
+			SharedPlanListContainsExtensibleNodes((List *) node))
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * choose_custom_plan: choose whether to use custom or generic plan
  *
@@ -0,0 +1,402 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.c
+ *	  Cross-backend catalog tuple cache in dynamic shared memory.
+ *
+ * Every backend keeps its own catalog cache (see catcache.c), so a freshly
+ * started backend has to fetch each catalog tuple it needs with an index
+ * scan, even if hundreds of other backends have already looked up the very
+ * same tuple.  When shared_catcache_size is set, positive catcache entries
+ * are also stored in a dshash table in a DSA area, and a catcache miss
+ * consults that table before scanning the catalog.  A tuple found there is
+ * still copied into the local catcache, so this saves catalog scans, not
+ * per-backend memory.  The DSA area is capped at shared_catcache_size; when
+ * it fills up we throw away stale entries, or everything if there are none,
+ * and start over.
+ *
+ * Entries are keyed by (database, cache ID, hash value), which is exactly
+ * what a catcache invalidation message identifies.  Rather than finding and
+ * removing entries when an invalidation is sent, we keep an array of
+ * generation counters in the main shared memory segment, indexed by a hash
+ * of the same key.  Sending an invalidation message increments the matching
+ * counter, and an entry is valid only as long as the generation it was
+ * stamped with is still current.  That keeps SharedCatCacheInvalidate()
+ * allocation- and lock-free, which matters because it's called from within
+ * the critical section of inplace updates.
+ *
+ * To avoid caching a tuple version that an invalidation has already made
+ * obsolete, the inserter reads the generation before it takes the catalog
+ * snapshot for its scan, and SharedCatCacheInsert() refuses to store the
+ * tuple if the generation has moved since.  Invalidations are sent only
+ * after the modifying transaction has become visible, so any version that
+ * a fresher snapshot could miss is rejected one way or the other.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedcatcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "common/hashfn.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/subsystems.h"
+#include "utils/memutils.h"
+#include "utils/sharedcatcache.h"
+
+/* Number of generation counters; must be a power of 2 */
+#define SHARED_CATCACHE_GENERATIONS	4096
+
+typedef struct SharedCatCacheCtlData
+{
+	dsa_handle	dsah;
+	dshash_table_handle dshh;
+	pg_atomic_uint64 generations[SHARED_CATCACHE_GENERATIONS];
+} SharedCatCacheCtlData;
+
+typedef struct SharedCatCacheKey
+{
+	Oid			dbid;			/* InvalidOid for shared catalogs */
+	int			cacheid;
+	uint32		hashValue;
+} SharedCatCacheKey;
+
+typedef struct SharedCatCacheEntry
+{
+	SharedCatCacheKey key;		/* hash key --- must be first */
+	uint64		generation;		/* generation the tuple was stamped with */
+	ItemPointerData t_self;
+	Oid			t_tableOid;
+	uint32		t_len;
+	dsa_pointer data;			/* tuple header and data, t_len bytes */
+} SharedCatCacheEntry;
+
+int			shared_catcache_size = 0;
+
+static SharedCatCacheCtlData *SharedCatCacheCtl = NULL;
+
+static dsa_area *shared_catcache_dsa = NULL;
+static dshash_table *shared_catcache_table = NULL;
+
+static const dshash_parameters shared_catcache_params = {
+	sizeof(SharedCatCacheKey),
+	sizeof(SharedCatCacheEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	dshash_memcpy,
+	LWTRANCHE_SHARED_CATCACHE_HASH
+};
+
+static void SharedCatCacheShmemRequest(void *arg);
+static void SharedCatCacheShmemInit(void *arg);
+
+const ShmemCallbacks SharedCatCacheShmemCallbacks = {
+	.request_fn = SharedCatCacheShmemRequest,
+	.init_fn = SharedCatCacheShmemInit,
+};
+
+static void
+SharedCatCacheShmemRequest(void *arg)
+{
+	if (shared_catcache_size <= 0)
+		return;
+
+	ShmemRequestStruct(.name = "Shared Catalog Cache",
+					   .size = sizeof(SharedCatCacheCtlData),
+					   .ptr = (void **) &SharedCatCacheCtl,
+		);
+}
+
+static void
+SharedCatCacheShmemInit(void *arg)
+{
+	if (SharedCatCacheCtl == NULL)
+		return;
+
+	SharedCatCacheCtl->dsah = DSA_HANDLE_INVALID;
+	SharedCatCacheCtl->dshh = DSHASH_HANDLE_INVALID;
+	for (int i = 0; i < SHARED_CATCACHE_GENERATIONS; i++)
+		pg_atomic_init_u64(&SharedCatCacheCtl->generations[i], 0);
+}
+
+/*
+ * Is the shared catalog cache available in this process?
+ */
+bool
+SharedCatCacheIsEnabled(void)
+{
+	return SharedCatCacheCtl != NULL && IsUnderPostmaster;
+}
+
+/*
+ * Initialize or attach to the dshash table holding the cached tuples, if
+ * not already done.
+ */
+static void
+shared_catcache_attach(void)
+{
+	MemoryContext oldcontext;
+
+	/* Quick exit if we already did this. */
+	if (shared_catcache_table)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	/* Use a lock to ensure only one process creates the table. */
+	LWLockAcquire(SharedCatCacheLock, LW_EXCLUSIVE);
+
+	if (SharedCatCacheCtl->dshh == DSHASH_HANDLE_INVALID)
+	{
+		shared_catcache_dsa = dsa_create(LWTRANCHE_SHARED_CATCACHE_DSA);
+		dsa_set_size_limit(shared_catcache_dsa,
+						   (size_t) shared_catcache_size * 1024 * 1024);
+		dsa_pin(shared_catcache_dsa);
+		dsa_pin_mapping(shared_catcache_dsa);
+		shared_catcache_table = dshash_create(shared_catcache_dsa,
+											  &shared_catcache_params, NULL);
+
+		/* Store handles in shared memory for other backends to use. */
+		SharedCatCacheCtl->dsah = dsa_get_handle(shared_catcache_dsa);
+		SharedCatCacheCtl->dshh =
+			dshash_get_hash_table_handle(shared_catcache_table);
+	}
+	else
+	{
+		shared_catcache_dsa = dsa_attach(SharedCatCacheCtl->dsah);
+		dsa_pin_mapping(shared_catcache_dsa);
+		shared_catcache_table = dshash_attach(shared_catcache_dsa,
+											  &shared_catcache_params,
+											  SharedCatCacheCtl->dshh, NULL);
+	}
+
+	LWLockRelease(SharedCatCacheLock);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Return the generation counter covering the given key.
+ */
+static inline pg_atomic_uint64 *
+shared_catcache_generation(Oid dbid, int cacheid, uint32 hashValue)
+{
+	uint32		h;
+
+	h = hash_combine(hashValue, murmurhash32((uint32) cacheid));
+	h = hash_combine(h, murmurhash32((uint32) dbid));
+
+	return &SharedCatCacheCtl->generations[h & (SHARED_CATCACHE_GENERATIONS - 1)];
+}
+
+/*
+ * Read the current generation for a key.  A caller that is about to scan
+ * the catalog and then store the result with SharedCatCacheInsert() must
+ * call this before taking the snapshot used for the scan.
+ */
+uint64
+SharedCatCacheGetStamp(Oid dbid, int cacheid, uint32 hashValue)
+{
+	Assert(SharedCatCacheCtl != NULL);
+
+	return pg_atomic_read_u64(shared_catcache_generation(dbid, cacheid,
+														 hashValue));
+}
+
+/*
+ * Look up a tuple in the shared catalog cache.
+ *
+ * Returns a palloc'd copy of the cached tuple, or NULL if there is no valid
+ * entry for the key.  Different tuples can have the same hash value, so the
+ * caller must check that the keys of the returned tuple match its search.
+ */
+HeapTuple
+SharedCatCacheLookup(Oid dbid, int cacheid, uint32 hashValue)
+{
+	SharedCatCacheKey key;
+	SharedCatCacheEntry *entry;
+	HeapTuple	tuple = NULL;
+
+	Assert(SharedCatCacheCtl != NULL);
+
+	shared_catcache_attach();
+
+	memset(&key, 0, sizeof(key));
+	key.dbid = dbid;
+	key.cacheid = cacheid;
+	key.hashValue = hashValue;
+
+	entry = dshash_find(shared_catcache_table, &key, false);
+	if (entry == NULL)
+		return NULL;
+
+	if (entry->generation ==
+		pg_atomic_read_u64(shared_catcache_generation(dbid, cacheid,
+													  hashValue)))
+	{
+		tuple = (HeapTuple) palloc(HEAPTUPLESIZE + entry->t_len);
+		tuple->t_len = entry->t_len;
+		tuple->t_self = entry->t_self;
+		tuple->t_tableOid = entry->t_tableOid;
+		tuple->t_data = (HeapTupleHeader) ((char *) tuple + HEAPTUPLESIZE);
+		memcpy(tuple->t_data, dsa_get_address(shared_catcache_dsa, entry->data),
+			   entry->t_len);
+	}
+
+	dshash_release_lock(shared_catcache_table, entry);
+
+	return tuple;
+}
+
+/*
+ * Make room in the shared catalog cache by removing every entry that has
+ * been invalidated.  If there are none, remove all entries.
+ */
+static void
+shared_catcache_evict(void)
+{
+	dshash_seq_status status;
+	SharedCatCacheEntry *entry;
+	bool		freed = false;
+
+	for (int pass = 0; pass < 2 && !freed; pass++)
+	{
+		dshash_seq_init(&status, shared_catcache_table, true);
+		while ((entry = dshash_seq_next(&status)) != NULL)
+		{
+			SharedCatCacheKey *key = &entry->key;
+			pg_atomic_uint64 *generation;
+
+			generation = shared_catcache_generation(key->dbid, key->cacheid,
+													key->hashValue);
+			if (pass == 0 && entry->generation == pg_atomic_read_u64(generation))
+				continue;
+
+			dsa_free(shared_catcache_dsa, entry->data);
+			dshash_delete_current(&status);
+			freed = true;
+		}
+		dshash_seq_term(&status);
+	}
+}
+
+/*
+ * Store a tuple in the shared catalog cache, replacing any previous entry
+ * with the same key.  'stamp' is the generation the caller read with
+ * SharedCatCacheGetStamp() before it fetched the tuple; if an invalidation
+ * has arrived in the meantime, the tuple might be stale and we don't store
+ * it.  Running out of space is not an error, the tuple is just not cached.
+ */
+void
+SharedCatCacheInsert(Oid dbid, int cacheid, uint32 hashValue,
+					 HeapTuple tuple, uint64 stamp)
+{
+	pg_atomic_uint64 *generation;
+	SharedCatCacheKey key;
+	SharedCatCacheEntry *entry = NULL;
+	dsa_pointer data = InvalidDsaPointer;
+	bool		found;
+
+	Assert(SharedCatCacheCtl != NULL);
+
+	generation = shared_catcache_generation(dbid, cacheid, hashValue);
+	if (pg_atomic_read_u64(generation) != stamp)
+		return;
+
+	shared_catcache_attach();
+
+	memset(&key, 0, sizeof(key));
+	key.dbid = dbid;
+	key.cacheid = cacheid;
+	key.hashValue = hashValue;
+
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		if (attempt > 0)
+			shared_catcache_evict();
+
+		if (!DsaPointerIsValid(data))
+			data = dsa_allocate_extended(shared_catcache_dsa, tuple->t_len,
+										 DSA_ALLOC_NO_OOM);
+		if (!DsaPointerIsValid(data))
+			continue;
+
+		entry = dshash_find_or_insert_extended(shared_catcache_table, &key,
+											   &found, DSHASH_INSERT_NO_OOM);
+		if (entry != NULL)
+			break;
+	}
+
+	if (entry == NULL)
+	{
+		if (DsaPointerIsValid(data))
+			dsa_free(shared_catcache_dsa, data);
+		return;
+	}
+
+	if (found)
+		dsa_free(shared_catcache_dsa, entry->data);
+
+	memcpy(dsa_get_address(shared_catcache_dsa, data), tuple->t_data,
+		   tuple->t_len);
+	entry->generation = stamp;
+	entry->t_self = tuple->t_self;
+	entry->t_tableOid = tuple->t_tableOid;
+	entry->t_len = tuple->t_len;
+	entry->data = data;
+
+	dshash_release_lock(shared_catcache_table, entry);
+}
+
+/*
+ * Invalidate the shared catalog cache entries affected by a batch of
+ * invalidation messages that is about to be sent to all backends.
+ *
+ * This must not allocate memory or take locks, see file header comment.
+ */
+void
+SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	if (SharedCatCacheCtl == NULL)
+		return;
+
+	for (int i = 0; i < n; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+
+		if (msg->id >= 0)
+		{
+			pg_atomic_uint64 *generation;
+
+			generation = shared_catcache_generation(msg->cc.dbId, msg->cc.id,
+													msg->cc.hashValue);
+			pg_atomic_fetch_add_u64(generation, 1);
+		}
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+		{
+			SharedCatCacheInvalidateAll();
+			break;
+		}
+	}
+}
+
+/*
+ * Invalidate all entries in the shared catalog cache.
+ */
+void
+SharedCatCacheInvalidateAll(void)
+{
+	if (SharedCatCacheCtl == NULL)
+		return;
+
+	for (int i = 0; i < SHARED_CATCACHE_GENERATIONS; i++)
+		pg_atomic_fetch_add_u64(&SharedCatCacheCtl->generations[i], 1);
+}
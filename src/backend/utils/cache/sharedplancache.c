@@ -0,0 +1,526 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.c
+ *	  Cross-backend cache of generic plans in dynamic shared memory.
+ *
+ * Generic plans of prepared statements are normally kept in each backend's
+ * own plan cache (see plancache.c), so with many sessions running the same
+ * statements, every one of them plans every statement at least once.  When
+ * shared_plan_cache_size is set, generic plans are also serialized with
+ * nodeToString() into a dshash table in a DSA area, and a backend about to
+ * build a generic plan looks there first.  plancache.c decides what the
+ * lookup key is; this module just treats it as an opaque string.  The DSA
+ * area is capped at shared_plan_cache_size; when it fills up we throw away
+ * invalidated plans, or everything if there are none.
+ *
+ * A cached plan must be invalidated whenever one of the local plan caches
+ * would invalidate it, that is, as PlanCacheRelCallback(),
+ * PlanCacheObjectCallback() and PlanCacheSysCallback() do.  Those callbacks
+ * run in every backend that receives the invalidation messages, so instead
+ * of hooking into them we apply the same rules once, when the messages are
+ * sent.  Each dependency of a plan (a relation, or a PlanInvalItem) hashes
+ * to one of an array of slots, and sending an invalidation message for it
+ * stores a new value of a global sequence counter into its slot.  A plan is
+ * stamped with the sequence value read before it was planned, and is valid
+ * as long as none of its slots, nor the slot for "everything", has been
+ * advanced past the stamp.  The counters are advanced after the messages
+ * have been queued, so a backend that reads the sequence counter and then
+ * accepts invalidation messages is guaranteed to have seen every message
+ * that its stamp covers.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/cache/sharedplancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/catalog.h"
+#include "common/hashfn.h"
+#include "lib/dshash.h"
+#include "miscadmin.h"
+#include "nodes/plannodes.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/subsystems.h"
+#include "utils/memutils.h"
+#include "utils/sharedplancache.h"
+#include "utils/syscache.h"
+
+/* Number of dependency slots; must be a power of 2 no larger than 65536 */
+#define SHARED_PLAN_CACHE_SLOTS	4096
+
+/* Pseudo cache ID used to compute the slots of relations */
+#define SHARED_PLAN_CACHE_REL	(-1)
+
+typedef struct SharedPlanCacheCtlData
+{
+	dsa_handle	dsah;
+	dshash_table_handle dshh;
+	pg_atomic_uint64 sequence;	/* last value handed out */
+	pg_atomic_uint64 all;		/* last invalidation of everything */
+	pg_atomic_uint64 slots[SHARED_PLAN_CACHE_SLOTS];
+} SharedPlanCacheCtlData;
+
+typedef struct SharedPlanCacheEntry
+{
+	uint32		keyhash;		/* hash key --- must be first */
+	uint64		stamp;			/* sequence value read before planning */
+	int			keylen;
+	int			planlen;		/* length of plan string, excluding NUL */
+	int			nslots;
+	dsa_pointer data;			/* slot numbers, key, plan string */
+} SharedPlanCacheEntry;
+
+int			shared_plan_cache_size = 0;
+
+static SharedPlanCacheCtlData *SharedPlanCacheCtl = NULL;
+
+static dsa_area *shared_plan_cache_dsa = NULL;
+static dshash_table *shared_plan_cache_table = NULL;
+
+static const dshash_parameters shared_plan_cache_params = {
+	sizeof(uint32),
+	sizeof(SharedPlanCacheEntry),
+	dshash_memcmp,
+	dshash_memhash,
+	dshash_memcpy,
+	LWTRANCHE_SHARED_PLAN_CACHE_HASH
+};
+
+static void SharedPlanCacheShmemRequest(void *arg);
+static void SharedPlanCacheShmemInit(void *arg);
+
+const ShmemCallbacks SharedPlanCacheShmemCallbacks = {
+	.request_fn = SharedPlanCacheShmemRequest,
+	.init_fn = SharedPlanCacheShmemInit,
+};
+
+static void
+SharedPlanCacheShmemRequest(void *arg)
+{
+	if (shared_plan_cache_size <= 0)
+		return;
+
+	ShmemRequestStruct(.name = "Shared Plan Cache",
+					   .size = sizeof(SharedPlanCacheCtlData),
+					   .ptr = (void **) &SharedPlanCacheCtl,
+		);
+}
+
+static void
+SharedPlanCacheShmemInit(void *arg)
+{
+	if (SharedPlanCacheCtl == NULL)
+		return;
+
+	SharedPlanCacheCtl->dsah = DSA_HANDLE_INVALID;
+	SharedPlanCacheCtl->dshh = DSHASH_HANDLE_INVALID;
+	pg_atomic_init_u64(&SharedPlanCacheCtl->sequence, 0);
+	pg_atomic_init_u64(&SharedPlanCacheCtl->all, 0);
+	for (int i = 0; i < SHARED_PLAN_CACHE_SLOTS; i++)
+		pg_atomic_init_u64(&SharedPlanCacheCtl->slots[i], 0);
+}
+
+/*
+ * Is the shared plan cache available in this process?
+ */
+bool
+SharedPlanCacheIsEnabled(void)
+{
+	return SharedPlanCacheCtl != NULL && IsUnderPostmaster;
+}
+
+/*
+ * Initialize or attach to the dshash table holding the cached plans, if
+ * not already done.
+ */
+static void
+shared_plan_cache_attach(void)
+{
+	MemoryContext oldcontext;
+
+	/* Quick exit if we already did this. */
+	if (shared_plan_cache_table)
+		return;
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	/* Use a lock to ensure only one process creates the table. */
+	LWLockAcquire(SharedPlanCacheLock, LW_EXCLUSIVE);
+
+	if (SharedPlanCacheCtl->dshh == DSHASH_HANDLE_INVALID)
+	{
+		shared_plan_cache_dsa = dsa_create(LWTRANCHE_SHARED_PLAN_CACHE_DSA);
+		dsa_set_size_limit(shared_plan_cache_dsa,
+						   (size_t) shared_plan_cache_size * 1024 * 1024);
+		dsa_pin(shared_plan_cache_dsa);
+		dsa_pin_mapping(shared_plan_cache_dsa);
+		shared_plan_cache_table = dshash_create(shared_plan_cache_dsa,
+												&shared_plan_cache_params,
+												NULL);
+
+		/* Store handles in shared memory for other backends to use. */
+		SharedPlanCacheCtl->dsah = dsa_get_handle(shared_plan_cache_dsa);
+		SharedPlanCacheCtl->dshh =
+			dshash_get_hash_table_handle(shared_plan_cache_table);
+	}
+	else
+	{
+		shared_plan_cache_dsa = dsa_attach(SharedPlanCacheCtl->dsah);
+		dsa_pin_mapping(shared_plan_cache_dsa);
+		shared_plan_cache_table = dshash_attach(shared_plan_cache_dsa,
+												&shared_plan_cache_params,
+												SharedPlanCacheCtl->dshh,
+												NULL);
+	}
+
+	LWLockRelease(SharedPlanCacheLock);
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Return the slot number covering a dependency.
+ */
+static inline uint16
+shared_plan_cache_slot(Oid dbid, int cacheid, uint32 hashValue)
+{
+	uint32		h;
+
+	h = hash_combine(hashValue, murmurhash32((uint32) cacheid));
+	h = hash_combine(h, murmurhash32((uint32) dbid));
+
+	return (uint16) (h & (SHARED_PLAN_CACHE_SLOTS - 1));
+}
+
+/*
+ * Record an invalidation of everything covered by 'slot', or of everything
+ * if 'slot' is NULL.
+ */
+static void
+shared_plan_cache_advance(pg_atomic_uint64 *slot)
+{
+	uint64		seq;
+
+	seq = pg_atomic_add_fetch_u64(&SharedPlanCacheCtl->sequence, 1);
+	pg_atomic_monotonic_advance_u64(slot ? slot : &SharedPlanCacheCtl->all,
+									seq);
+}
+
+/*
+ * Has anything covered by the given slots been invalidated after 'stamp'?
+ */
+static bool
+shared_plan_cache_is_stale(uint64 stamp, const uint16 *slots, int nslots)
+{
+	if (pg_atomic_read_u64(&SharedPlanCacheCtl->all) > stamp)
+		return true;
+	for (int i = 0; i < nslots; i++)
+	{
+		if (pg_atomic_read_u64(&SharedPlanCacheCtl->slots[slots[i]]) > stamp)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Read the current sequence value.  A caller that is about to build a plan
+ * and then store it with SharedPlanCacheInsert() must call this before
+ * accepting invalidation messages and planning.
+ */
+uint64
+SharedPlanCacheGetStamp(void)
+{
+	Assert(SharedPlanCacheCtl != NULL);
+
+	return pg_atomic_read_u64(&SharedPlanCacheCtl->sequence);
+}
+
+/*
+ * Look up a plan in the shared plan cache.
+ *
+ * Returns the list of PlannedStmts, freshly read into the current memory
+ * context, or NIL if there is no valid plan for the key.  *stamp is set to
+ * the stamp of the plan, for use with SharedPlanCacheIsCurrent().
+ */
+List *
+SharedPlanCacheLookup(const char *key, int keylen, uint64 *stamp)
+{
+	uint32		keyhash;
+	SharedPlanCacheEntry *entry;
+	char	   *planstr = NULL;
+
+	Assert(SharedPlanCacheCtl != NULL);
+
+	shared_plan_cache_attach();
+
+	keyhash = hash_bytes((const unsigned char *) key, keylen);
+
+	entry = dshash_find(shared_plan_cache_table, &keyhash, false);
+	if (entry == NULL)
+		return NIL;
+
+	if (entry->keylen == keylen)
+	{
+		char	   *data = dsa_get_address(shared_plan_cache_dsa, entry->data);
+		uint16	   *slots = (uint16 *) data;
+		char	   *entrykey = data + entry->nslots * sizeof(uint16);
+
+		if (memcmp(entrykey, key, keylen) == 0 &&
+			!shared_plan_cache_is_stale(entry->stamp, slots, entry->nslots))
+		{
+			planstr = palloc(entry->planlen + 1);
+			memcpy(planstr, entrykey + keylen, entry->planlen + 1);
+			*stamp = entry->stamp;
+		}
+	}
+
+	dshash_release_lock(shared_plan_cache_table, entry);
+
+	if (planstr == NULL)
+		return NIL;
+
+	return (List *) stringToNode(planstr);
+}
+
+/*
+ * Compute the slots covering the given plan dependencies.
+ */
+static uint16 *
+shared_plan_cache_slots(List *relationOids, List *invalItems, int *nslots)
+{
+	uint16	   *slots;
+	int			n = 0;
+
+	slots = palloc_array(uint16, list_length(relationOids) +
+						 list_length(invalItems) + 1);
+	foreach_oid(relid, relationOids)
+	{
+		/* relcache invalidations for shared catalogs carry no database */
+		Oid			dbid = IsSharedRelation(relid) ? InvalidOid : MyDatabaseId;
+
+		slots[n++] = shared_plan_cache_slot(dbid, SHARED_PLAN_CACHE_REL, relid);
+	}
+	foreach_node(PlanInvalItem, item, invalItems)
+		slots[n++] = shared_plan_cache_slot(MyDatabaseId, item->cacheId,
+											item->hashValue);
+
+	*nslots = n;
+	return slots;
+}
+
+/*
+ * Is a plan with the given dependencies and stamp still valid?
+ *
+ * A caller that got a plan from SharedPlanCacheLookup() must check this
+ * after locking the relations the plan uses.
+ */
+bool
+SharedPlanCacheIsCurrent(List *relationOids, List *invalItems, uint64 stamp)
+{
+	uint16	   *slots;
+	int			nslots;
+	bool		result;
+
+	Assert(SharedPlanCacheCtl != NULL);
+
+	slots = shared_plan_cache_slots(relationOids, invalItems, &nslots);
+	result = !shared_plan_cache_is_stale(stamp, slots, nslots);
+	pfree(slots);
+
+	return result;
+}
+
+/*
+ * Make room in the shared plan cache by removing every plan that has been
+ * invalidated.  If there are none, remove all plans.
+ */
+static void
+shared_plan_cache_evict(void)
+{
+	dshash_seq_status status;
+	SharedPlanCacheEntry *entry;
+	bool		freed = false;
+
+	for (int pass = 0; pass < 2 && !freed; pass++)
+	{
+		dshash_seq_init(&status, shared_plan_cache_table, true);
+		while ((entry = dshash_seq_next(&status)) != NULL)
+		{
+			uint16	   *slots;
+
+			slots = dsa_get_address(shared_plan_cache_dsa, entry->data);
+			if (pass == 0 &&
+				!shared_plan_cache_is_stale(entry->stamp, slots,
+											entry->nslots))
+				continue;
+
+			dsa_free(shared_plan_cache_dsa, entry->data);
+			dshash_delete_current(&status);
+			freed = true;
+		}
+		dshash_seq_term(&status);
+	}
+}
+
+/*
+ * Store a generic plan in the shared plan cache, replacing any previous plan
+ * with the same key hash.
+ *
+ * relationOids and invalItems are the dependencies of the plan and of the
+ * query tree it was made from, in the form plancache.c tracks them.  'stamp'
+ * is the value the caller got from SharedPlanCacheGetStamp() before
+ * planning; if any of the dependencies has been invalidated since, the
+ * plan might be stale and we don't store it.  Running out of space is not
+ * an error, the plan is just not cached.
+ */
+void
+SharedPlanCacheInsert(const char *key, int keylen, List *stmt_list,
+					  List *relationOids, List *invalItems, uint64 stamp)
+{
+	uint32		keyhash;
+	char	   *planstr;
+	int			planlen;
+	uint16	   *slots;
+	int			nslots;
+	Size		size;
+	SharedPlanCacheEntry *entry = NULL;
+	dsa_pointer data = InvalidDsaPointer;
+	bool		found;
+	char	   *p;
+
+	Assert(SharedPlanCacheCtl != NULL);
+
+	slots = shared_plan_cache_slots(relationOids, invalItems, &nslots);
+	if (shared_plan_cache_is_stale(stamp, slots, nslots))
+	{
+		pfree(slots);
+		return;
+	}
+
+	planstr = nodeToString(stmt_list);
+	planlen = strlen(planstr);
+	size = nslots * sizeof(uint16) + keylen + planlen + 1;
+
+	shared_plan_cache_attach();
+
+	keyhash = hash_bytes((const unsigned char *) key, keylen);
+
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		if (attempt > 0)
+			shared_plan_cache_evict();
+
+		if (!DsaPointerIsValid(data))
+			data = dsa_allocate_extended(shared_plan_cache_dsa, size,
+										 DSA_ALLOC_NO_OOM);
+		if (!DsaPointerIsValid(data))
+			continue;
+
+		entry = dshash_find_or_insert_extended(shared_plan_cache_table,
+											   &keyhash, &found,
+											   DSHASH_INSERT_NO_OOM);
+		if (entry != NULL)
+			break;
+	}
+
+	if (entry != NULL)
+	{
+		if (found)
+			dsa_free(shared_plan_cache_dsa, entry->data);
+
+		p = dsa_get_address(shared_plan_cache_dsa, data);
+		memcpy(p, slots, nslots * sizeof(uint16));
+		p += nslots * sizeof(uint16);
+		memcpy(p, key, keylen);
+		p += keylen;
+		memcpy(p, planstr, planlen + 1);
+
+		entry->stamp = stamp;
+		entry->keylen = keylen;
+		entry->planlen = planlen;
+		entry->nslots = nslots;
+		entry->data = data;
+
+		dshash_release_lock(shared_plan_cache_table, entry);
+	}
+	else if (DsaPointerIsValid(data))
+		dsa_free(shared_plan_cache_dsa, data);
+
+	pfree(planstr);
+	pfree(slots);
+}
+
+/*
+ * Invalidate the shared plan cache entries affected by a batch of
+ * invalidation messages that has just been sent to all backends.  The rules
+ * must match those of the plancache.c invalidation callbacks.
+ *
+ * This must not allocate memory or take locks, since it's called from
+ * within the critical section of inplace updates.
+ */
+void
+SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	if (SharedPlanCacheCtl == NULL)
+		return;
+
+	for (int i = 0; i < n; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+		uint16		slot;
+
+		if (msg->id >= 0)
+		{
+			switch (msg->cc.id)
+			{
+				case PROCOID:
+				case TYPEOID:
+					slot = shared_plan_cache_slot(msg->cc.dbId, msg->cc.id,
+												  msg->cc.hashValue);
+					shared_plan_cache_advance(&SharedPlanCacheCtl->slots[slot]);
+					break;
+				case NAMESPACEOID:
+				case OPEROID:
+				case AMOPOPID:
+				case FOREIGNSERVEROID:
+				case FOREIGNDATAWRAPPEROID:
+					shared_plan_cache_advance(NULL);
+					break;
+				default:
+					break;
+			}
+		}
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+			shared_plan_cache_advance(NULL);
+		else if (msg->id == SHAREDINVALRELCACHE_ID)
+		{
+			if (!OidIsValid(msg->rc.relId))
+				shared_plan_cache_advance(NULL);
+			else
+			{
+				slot = shared_plan_cache_slot(msg->rc.dbId,
+											  SHARED_PLAN_CACHE_REL,
+											  msg->rc.relId);
+				shared_plan_cache_advance(&SharedPlanCacheCtl->slots[slot]);
+			}
+		}
+	}
+}
+
+/*
+ * Invalidate all plans in the shared plan cache.
+ */
+void
+SharedPlanCacheInvalidateAll(void)
+{
+	if (SharedPlanCacheCtl == NULL)
+		return;
+
+	shared_plan_cache_advance(NULL);
+}
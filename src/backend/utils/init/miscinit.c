@@ -48,6 +48,7 @@
 #include "storage/pmsignal.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
+#include "tcop/sessionpool.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
@@ -819,11 +820,16 @@ InitializeSessionUserId(const char *rolename, Oid roleid,
 		 * ideally one should succeed and one fail.  Getting that to work
 		 * exactly seems more trouble than it is worth, however; instead we
 		 * just document that the connection limit is approximate.
+		 *
+		 * Sessions served by pool backends count as well, even though they
+		 * don't have a backend of their own.
 		 */
 		if (rform->rolconnlimit >= 0 &&
 			AmRegularBackendProcess() &&
 			!is_superuser &&
-			CountUserBackends(roleid) > rform->rolconnlimit)
+			CountUserBackends(roleid) +
+			SessionPoolCountSessions(InvalidOid, roleid) >
+			rform->rolconnlimit)
 			ereport(FATAL,
 					(errcode(ERRCODE_TOO_MANY_CONNECTIONS),
 					 errmsg("too many connections for role \"%s\"",
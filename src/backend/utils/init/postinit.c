@@ -57,6 +57,7 @@
 #include "storage/smgr.h"
 #include "storage/sync.h"
 #include "tcop/backend_startup.h"
+#include "tcop/sessionpool.h"
 #include "tcop/tcopprot.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -403,11 +404,16 @@ CheckMyDatabase(const char *name, bool am_superuser, bool override_allow_connect
 		 * ideally one should succeed and one fail.  Getting that to work
 		 * exactly seems more trouble than it is worth, however; instead we
 		 * just document that the connection limit is approximate.
+		 *
+		 * Sessions served by pool backends count as well, even though they
+		 * don't have a backend of their own.
 		 */
 		if (dbform->datconnlimit >= 0 &&
 			AmRegularBackendProcess() &&
 			!am_superuser &&
-			CountDBConnections(MyDatabaseId) > dbform->datconnlimit)
+			CountDBConnections(MyDatabaseId) +
+			SessionPoolCountSessions(MyDatabaseId, InvalidOid) >
+			dbform->datconnlimit)
 			ereport(FATAL,
 					(errcode(ERRCODE_TOO_MANY_CONNECTIONS),
 					 errmsg("too many connections for database \"%s\"",
@@ -729,6 +735,7 @@ InitPostgres(const char *in_dbname, Oid dboid,
 	char	   *fullpath;
 	char		dbname[NAMEDATALEN];
 	int			nfree = 0;
+	int			npooled = 0;
 
 	elog(DEBUG3, "InitPostgres");
 
@@ -981,11 +988,23 @@ InitPostgres(const char *in_dbname, Oid dboid,
 	 * Note: At this point, the new backend has already claimed a proc struct,
 	 * so we must check whether the number of free slots is strictly less than
 	 * the reserved connection limits.
+	 *
+	 * Sessions served by pool backends don't have a proc struct of their own,
+	 * but they count against max_connections all the same, so they take up
+	 * free slots here.
 	 */
+	if (AmRegularBackendProcess())
+		npooled = SessionPoolCountSessions(InvalidOid, InvalidOid);
+	if (npooled > 0 && !HaveNFreeProcs(npooled, &nfree))
+		ereport(FATAL,
+				(errcode(ERRCODE_TOO_MANY_CONNECTIONS),
+				 errmsg("sorry, too many clients already")));
 	if (AmRegularBackendProcess() && !am_superuser &&
 		(SuperuserReservedConnections + ReservedConnections) > 0 &&
-		!HaveNFreeProcs(SuperuserReservedConnections + ReservedConnections, &nfree))
+		!HaveNFreeProcs(SuperuserReservedConnections + ReservedConnections +
+						npooled, &nfree))
 	{
+		nfree -= npooled;
 		if (nfree < SuperuserReservedConnections)
 			ereport(FATAL,
 					(errcode(ERRCODE_TOO_MANY_CONNECTIONS),
@@ -5876,6 +5876,81 @@ EstimateGUCStateSpace(void)
 	return size;
 }
 
+/*
+ * session_reset_value:
+ * For EstimateGUCSessionStateSpace and SerializeGUCSessionState, decide
+ * whether the reset value of the given GUC variable needs to be dumped ahead
+ * of its current value, and if so, return it in text form.
+ *
+ * That's the case for variables that the session has SET, when the value
+ * that RESET would go back to is not the built-in default.  The result may
+ * point into buf, which must be large enough for a number.
+ */
+static const char *
+session_reset_value(struct config_generic *gconf, char *buf, size_t bufsize)
+{
+	if (can_skip_gucvar(gconf) ||
+		gconf->source <= PGC_S_OVERRIDE ||
+		gconf->reset_source == PGC_S_DEFAULT)
+		return NULL;
+
+	switch (gconf->vartype)
+	{
+		case PGC_BOOL:
+			return gconf->_bool.reset_val ? "true" : "false";
+
+		case PGC_INT:
+			snprintf(buf, bufsize, "%d", gconf->_int.reset_val);
+			return buf;
+
+		case PGC_REAL:
+			snprintf(buf, bufsize, "%.*e",
+					 REALTYPE_PRECISION, gconf->_real.reset_val);
+			return buf;
+
+		case PGC_STRING:
+			/* NULL becomes empty string, see estimate_variable_size() */
+			return gconf->_string.reset_val ? gconf->_string.reset_val : "";
+
+		case PGC_ENUM:
+			return config_enum_lookup_by_value(gconf, gconf->_enum.reset_val);
+	}
+
+	return NULL;
+}
+
+/*
+ * EstimateGUCSessionStateSpace:
+ * Returns the size needed to store the GUC state for the current process
+ * with SerializeGUCSessionState
+ */
+Size
+EstimateGUCSessionStateSpace(void)
+{
+	Size		size = EstimateGUCStateSpace();
+	dlist_iter	iter;
+
+	dlist_foreach(iter, &guc_nondef_list)
+	{
+		struct config_generic *gconf = dlist_container(struct config_generic,
+													   nondef_link, iter.cur);
+		char		buf[64];
+		const char *reset_value;
+
+		reset_value = session_reset_value(gconf, buf, sizeof(buf));
+		if (reset_value == NULL)
+			continue;
+
+		/* Name, value and empty sourcefile, with their zero bytes */
+		size = add_size(size, strlen(gconf->name) + strlen(reset_value) + 3);
+		size = add_size(size, sizeof(gconf->reset_source));
+		size = add_size(size, sizeof(gconf->reset_scontext));
+		size = add_size(size, sizeof(gconf->reset_srole));
+	}
+
+	return size;
+}
+
 /*
  * do_serialize:
  * Copies the formatted string into the destination.  Moves ahead the
@@ -6031,6 +6106,58 @@ SerializeGUCState(Size maxsize, char *start_address)
 	memcpy(start_address, &actual_size, sizeof(actual_size));
 }
 
+/*
+ * SerializeGUCSessionState:
+ * Like SerializeGUCState, but also dumps the reset values of variables that
+ * have been changed with SET, so that RestoreGUCState can bring back the
+ * whole state of a session rather than just its active values.
+ *
+ * This is for session pooling, which moves a session's settings out of a
+ * backend and back in again.  An entry for the reset value is dumped just
+ * before the one for the current value, so restoring the first makes it the
+ * reset value as well as the active one, and restoring the second then
+ * overrides just the active value.
+ */
+void
+SerializeGUCSessionState(Size maxsize, char *start_address)
+{
+	char	   *curptr;
+	Size		actual_size;
+	Size		bytes_left;
+	dlist_iter	iter;
+
+	Assert(maxsize > sizeof(actual_size));
+	curptr = start_address + sizeof(actual_size);
+	bytes_left = maxsize - sizeof(actual_size);
+
+	dlist_foreach(iter, &guc_nondef_list)
+	{
+		struct config_generic *gconf = dlist_container(struct config_generic,
+													   nondef_link, iter.cur);
+		char		buf[64];
+		const char *reset_value;
+
+		reset_value = session_reset_value(gconf, buf, sizeof(buf));
+		if (reset_value != NULL)
+		{
+			do_serialize(&curptr, &bytes_left, "%s", gconf->name);
+			do_serialize(&curptr, &bytes_left, "%s", reset_value);
+			do_serialize(&curptr, &bytes_left, "%s", "");
+			do_serialize_binary(&curptr, &bytes_left, &gconf->reset_source,
+								sizeof(gconf->reset_source));
+			do_serialize_binary(&curptr, &bytes_left, &gconf->reset_scontext,
+								sizeof(gconf->reset_scontext));
+			do_serialize_binary(&curptr, &bytes_left, &gconf->reset_srole,
+								sizeof(gconf->reset_srole));
+		}
+
+		serialize_variable(&curptr, &bytes_left, gconf);
+	}
+
+	actual_size = maxsize - bytes_left - sizeof(actual_size);
+	memcpy(start_address, &actual_size, sizeof(actual_size));
+}
+
 /*
  * read_gucstate:
  * Actually it does not read anything, just returns the srcptr. But it does
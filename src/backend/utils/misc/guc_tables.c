@@ -30,6 +30,7 @@
 #endif
 
 #include "access/commit_ts.h"
+#include "access/csnlog.h"
 #include "access/gin.h"
 #include "access/slru.h"
 #include "access/toast_compression.h"
@@ -50,6 +51,7 @@
 #include "commands/vacuum.h"
 #include "common/file_utils.h"
 #include "common/scram-common.h"
+#include "executor/execBatch.h"
 #include "jit/jit.h"
 #include "libpq/auth.h"
 #include "libpq/libpq.h"
@@ -89,6 +91,7 @@
 #include "storage/procnumber.h"
 #include "storage/standby.h"
 #include "tcop/backend_startup.h"
+#include "tcop/sessionpool.h"
 #include "tcop/tcopprot.h"
 #include "portability/instr_time.h"
 #include "tsearch/ts_cache.h"
@@ -103,6 +106,8 @@
 #include "utils/plancache.h"
 #include "utils/ps_status.h"
 #include "utils/rls.h"
+#include "utils/sharedcatcache.h"
+#include "utils/sharedplancache.h"
 #include "utils/xml.h"
 
 #ifdef TRACE_SYNCSCAN
@@ -374,6 +379,16 @@ static const struct config_enum_entry huge_pages_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry shared_memory_numa_options[] = {
+	{"off", SHMEM_NUMA_OFF, false},
+	{"interleave", SHMEM_NUMA_INTERLEAVE, false},
+	{"partition", SHMEM_NUMA_PARTITION, false},
+	{"false", SHMEM_NUMA_OFF, true},
+	{"no", SHMEM_NUMA_OFF, true},
+	{"0", SHMEM_NUMA_OFF, true},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry timing_clock_source_options[] = {
 	{"auto", TIMING_CLOCK_SOURCE_AUTO, false},
 	{"system", TIMING_CLOCK_SOURCE_SYSTEM, false},
@@ -608,6 +623,7 @@ static int	ssl_renegotiation_limit;
 int			huge_pages = HUGE_PAGES_TRY;
 int			huge_page_size;
 int			huge_pages_status = HUGE_PAGES_UNKNOWN;
+int			shared_memory_numa = SHMEM_NUMA_OFF;
 
 /*
  * These variables are all dummies that don't do anything, except in some
@@ -1045,6 +1045,25 @@ LogicalTapeFreeze(LogicalTape *lt, TapeShare *share)
 	}
 }
 
+/*
+ * Prepare a tape imported from a worker for nondestructive reads.
+ *
+ * Like a frozen tape, it can then be rewound and read several times, and
+ * seeked to positions that the worker obtained with LogicalTapeTell() while
+ * writing it.  This is used by leaders that read only parts of the workers'
+ * runs, see tuplesort_merge_range().
+ */
+void
+LogicalTapeFreezeImported(LogicalTape *lt)
+{
+	Assert(lt->writing && !lt->dirty);
+	Assert(lt->buffer == NULL);
+
+	lt->writing = false;
+	lt->frozen = true;
+	lt->buffer_size = BLCKSZ;
+}
+
 /*
  * Backspace the tape a given number of bytes.  (We also support a more
  * general seek interface, see below.)
@@ -1141,10 +1160,15 @@ LogicalTapeSeek(LogicalTape *lt, int64 blocknum, int offset)
 
 	if (blocknum != lt->curBlockNumber)
 	{
-		ltsReadBlock(lt->tapeSet, blocknum, lt->buffer);
+		/* Apply worker offset, needed for leader tapesets */
+		ltsReadBlock(lt->tapeSet, lt->offsetBlockNumber + blocknum,
+					 lt->buffer);
 		lt->curBlockNumber = blocknum;
-		lt->nbytes = TapeBlockPayloadSize;
-		lt->nextBlockNumber = TapeBlockGetTrailer(lt->buffer)->next;
+		if (TapeBlockIsLast(lt->buffer))
+			lt->nextBlockNumber = -1L;
+		else
+			lt->nextBlockNumber = TapeBlockGetTrailer(lt->buffer)->next;
+		lt->nbytes = TapeBlockGetNBytes(lt->buffer);
 	}
 
 	if (offset > lt->nbytes)
@@ -1155,8 +1179,9 @@ LogicalTapeSeek(LogicalTape *lt, int64 blocknum, int offset)
 /*
  * Obtain current position in a form suitable for a later LogicalTapeSeek.
  *
- * NOTE: it'd be OK to do this during write phase with intention of using
- * the position for a seek after freezing.  Not clear if anyone needs that.
+ * NOTE: it's OK to do this during write phase with intention of using the
+ * position for a seek after freezing.  Parallel sort workers do that to
+ * index the runs they hand over to the leader.
  */
 void
 LogicalTapeTell(LogicalTape *lt, int64 *blocknum, int *offset)
@@ -177,6 +177,44 @@ typedef enum
 #define TAPE_BUFFER_OVERHEAD		BLCKSZ
 #define MERGE_BUFFER_SIZE			(BLCKSZ * 32)
 
+/*
+ * Number of entries in the sparse index that each worker keeps of its run,
+ * when the leader is going to merge key ranges.  The leader uses the keys of
+ * all of them as the sample that the range boundaries are chosen from.
+ */
+#define RANGE_INDEX_ENTRIES		256
+
+/*
+ * Sparse index of the run that a worker hands over to the leader: the tape
+ * positions of tuples spaced evenly through the run.  See
+ * tuplesort_merge_range().
+ */
+typedef struct TapeIndexEntry
+{
+	int64		blocknum;
+	int			offset;
+} TapeIndexEntry;
+
+typedef struct TapeIndex
+{
+	int			nentries;
+	TapeIndexEntry entries[FLEXIBLE_ARRAY_MEMBER];
+} TapeIndex;
+
+#define TapeIndexSize(nentries) \
+	MAXALIGN(offsetof(TapeIndex, entries) + sizeof(TapeIndexEntry) * (nentries))
+
+/*
+ * A worker's run, as seen by a leader merging key ranges: its sparse index,
+ * with the sort key of each indexed tuple.
+ */
+typedef struct RangeMergeRun
+{
+	int			nentries;
+	TapeIndexEntry *entries;
+	SortTuple  *keys;
+} RangeMergeRun;
+
 
 /*
  * Private state of a Tuplesort operation.
@@ -319,6 +357,31 @@ struct Tuplesortstate
 	Sharedsort *shared;
 	int			nParticipants;
 
+	/*
+	 * In a worker whose leader is going to merge key ranges, runIndex is the
+	 * sparse index of the run being written: the position of every
+	 * runIndexStride'th tuple.  When it fills up, every other entry is
+	 * dropped and the stride doubled.  runTuples counts the tuples written to
+	 * the run so far.
+	 */
+	TapeIndexEntry *runIndex;
+	int			runIndexCount;
+	int64		runIndexStride;
+	int64		runTuples;
+
+	/*
+	 * In a leader merging key ranges, the indexed runs, the nranges - 1
+	 * boundaries of the ranges chosen from their keys (or none if the runs
+	 * were too short to have any indexed tuples, in which case the last range
+	 * holds all tuples), and the upper bound of the range being merged, or
+	 * NULL if it is unbounded.
+	 */
+	RangeMergeRun *rangeRuns;
+	SortTuple  *splitters;
+	int			nsplitters;
+	int			nranges;
+	SortTuple  *rangeHi;
+
 	/*
 	 * Additional state for managing "abbreviated key" sortsupport routines
 	 * (which currently may be used by all cases except the hash index case).
@@ -360,13 +423,24 @@ struct Sharedsort
 	/* Size of tapes flexible array */
 	int			nTapes;
 
+	/* Number of entries in each worker's run index, or 0 if not wanted */
+	int			indexSize;
+
 	/*
 	 * Tapes array used by workers to report back information needed by the
 	 * leader to concatenate all worker tapes into one for merging
 	 */
 	TapeShare	tapes[FLEXIBLE_ARRAY_MEMBER];
+
+	/* The TapeIndex of each tape follows, if indexSize > 0 */
 };
 
+#define SharedsortIndex(shared, tape) \
+	((TapeIndex *) ((char *) (shared) + \
+					MAXALIGN(offsetof(Sharedsort, tapes) + \
+							 sizeof(TapeShare) * (shared)->nTapes) + \
+					TapeIndexSize((shared)->indexSize) * (tape)))
+
 /*
  * Is the given tuple allocated from the slab memory arena?
  */
@@ -472,7 +546,12 @@ static void markrunend(LogicalTape *tape);
 static int	worker_get_identifier(Tuplesortstate *state);
 static void worker_freeze_result_tape(Tuplesortstate *state);
 static void worker_nomergeruns(Tuplesortstate *state);
+static void worker_index_newrun(Tuplesortstate *state);
+static void worker_index_tuple(Tuplesortstate *state);
 static void leader_takeover_tapes(Tuplesortstate *state);
+static void range_merge_init(Tuplesortstate *state, int nranges);
+static void range_merge_seek(Tuplesortstate *state, int tapenum,
+							 SortTuple *lo);
 static void free_sort_tuple(Tuplesortstate *state, SortTuple *stup);
 static void tuplesort_free(Tuplesortstate *state);
 static void tuplesort_updatemax(Tuplesortstate *state);
@@ -627,6 +706,9 @@ tuplesort_begin_common(int workMem, SortCoordinate coordinate, int sortopt)
 		state->shared = coordinate->sharedsort;
 		state->worker = worker_get_identifier(state);
 		state->nParticipants = -1;
+		if (state->shared->indexSize > 0)
+			state->runIndex = palloc_array(TapeIndexEntry,
+										   state->shared->indexSize);
 	}
 	else
 	{
@@ -1356,6 +1438,102 @@ tuplesort_performsort(Tuplesortstate *state)
 	MemoryContextSwitchTo(oldcontext);
 }
 
+/*
+ * tuplesort_merge_range - merge one key range of the workers' runs
+ *
+ * This is an alternative to tuplesort_performsort() in a leader, when the
+ * shared state was set up with tuplesort_initialize_shared_ranged().  The
+ * keys of the tuples that the workers indexed in their runs are used to
+ * divide the key space into nranges ranges of about the same number of
+ * tuples.  Afterwards, the tuplesort returns the tuples of range number
+ * 'range' only, in order.  Several leader tuplesorts can do so for different
+ * ranges at the same time, and since they all choose the same boundaries,
+ * they return every tuple exactly once between them.
+ *
+ * Once all the tuples of a range have been read, this can be called again
+ * for a later range, with the same nranges.
+ */
+void
+tuplesort_merge_range(Tuplesortstate *state, int range, int nranges)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(state->base.sortcontext);
+	SortTuple  *lo;
+	int			tapenum;
+
+	Assert(LEADER(state));
+	Assert(range >= 0 && range < nranges);
+
+	if (state->rangeRuns == NULL)
+	{
+		leader_takeover_tapes(state);
+		range_merge_init(state, nranges);
+	}
+	Assert(state->nranges == nranges);
+	Assert(state->memtupcount == 0);
+
+	if (state->lastReturnedTuple)
+	{
+		RELEASE_SLAB_SLOT(state, state->lastReturnedTuple);
+		state->lastReturnedTuple = NULL;
+	}
+
+	state->status = TSS_FINALMERGE;
+	state->nInputRuns = 0;
+
+	/*
+	 * Range number r holds the tuples above boundary r - 1, up to and
+	 * including boundary r.
+	 */
+	if (state->nsplitters == 0)
+	{
+		/* Everything is in the last range */
+		if (range < nranges - 1)
+		{
+			MemoryContextSwitchTo(oldcontext);
+			return;
+		}
+		lo = NULL;
+		state->rangeHi = NULL;
+	}
+	else
+	{
+		lo = range > 0 ? &state->splitters[range - 1] : NULL;
+		state->rangeHi = range < nranges - 1 ? &state->splitters[range] : NULL;
+	}
+
+	if (trace_sort)
+		elog(LOG, "leader starting merge of key range %d of %d: %s",
+			 range + 1, nranges, pg_rusage_show(&state->ru_start));
+
+	/*
+	 * Position each run at the first tuple of the range, and fill the merge
+	 * heap with those tuples.
+	 */
+	for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
+	{
+		LogicalTape *tape = state->inputTapes[tapenum];
+		SortTuple	tup;
+		bool		found;
+
+		range_merge_seek(state, tapenum, lo);
+		while ((found = mergereadnext(state, tape, &tup)) &&
+			   lo != NULL && COMPARETUP(state, &tup, lo) <= 0)
+		{
+			if (tup.tuple)
+				RELEASE_SLAB_SLOT(state, tup.tuple);
+		}
+
+		if (found)
+		{
+			tup.srctape = tapenum;
+			tuplesort_heap_insert(state, &tup);
+			state->nInputRuns++;
+		}
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
 /*
  * Internal routine to fetch the next tuple in either forward or back
  * direction into *stup.  Returns false if no more tuples.
@@ -1580,9 +1758,11 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 
 					/*
 					 * Close the tape.  It'd go away at the end of the sort
-					 * anyway, but better to release the memory early.
+					 * anyway, but better to release the memory early.  When
+					 * merging key ranges, we may need it for the next range.
 					 */
-					LogicalTapeClose(srcTape);
+					if (state->rangeRuns == NULL)
+						LogicalTapeClose(srcTape);
 					return true;
 				}
 				newtup.srctape = srcTapeIndex;
@@ -2107,6 +2287,9 @@ mergeonerun(Tuplesortstate *state)
 
 	Assert(state->slabAllocatorUsed);
 
+	if (state->runIndex)
+		worker_index_newrun(state);
+
 	/*
 	 * Execute merge by repeatedly extracting lowest tuple in heap, writing it
 	 * out, and replacing it with next tuple from same tape (if there is
@@ -2119,6 +2302,8 @@ mergeonerun(Tuplesortstate *state)
 		/* write the tuple to destTape */
 		srcTapeIndex = state->memtuples[0].srctape;
 		srcTape = state->inputTapes[srcTapeIndex];
+		if (state->runIndex)
+			worker_index_tuple(state);
 		WRITETUP(state, state->destTape, &state->memtuples[0]);
 
 		/* recycle the slot of the tuple we just wrote out, for the next read */
@@ -2179,7 +2364,8 @@ beginmerge(Tuplesortstate *state)
 /*
  * mergereadnext - read next tuple from one merge input tape
  *
- * Returns false on EOF.
+ * Returns false on EOF.  When merging a key range, a tuple beyond its upper
+ * bound counts as EOF, too.
  */
 static bool
 mergereadnext(Tuplesortstate *state, LogicalTape *srcTape, SortTuple *stup)
@@ -2191,6 +2377,13 @@ mergereadnext(Tuplesortstate *state, LogicalTape *srcTape, SortTuple *stup)
 		return false;
 	READTUP(state, stup, srcTape, tuplen);
 
+	if (state->rangeHi && COMPARETUP(state, stup, state->rangeHi) > 0)
+	{
+		if (stup->tuple)
+			RELEASE_SLAB_SLOT(state, stup->tuple);
+		return false;
+	}
+
 	return true;
 }
 
@@ -2241,6 +2434,8 @@ dumptuples(Tuplesortstate *state, bool alltuples)
 		selectnewtape(state);
 
 	state->currentRun++;
+	if (state->runIndex)
+		worker_index_newrun(state);
 
 	if (trace_sort)
 		elog(LOG, "worker %d starting quicksort of run %d: %s",
@@ -2263,6 +2458,8 @@ dumptuples(Tuplesortstate *state, bool alltuples)
 	{
 		SortTuple  *stup = &state->memtuples[i];
 
+		if (state->runIndex)
+			worker_index_tuple(state);
 		WRITETUP(state, state->destTape, stup);
 	}
 
@@ -3197,9 +3394,10 @@ tuplesort_readtup_alloc(Tuplesortstate *state, Size tuplen)
 
 	/*
 	 * We pre-allocate enough slots in the slab arena that we should never run
-	 * out.
+	 * out.  (The keys of a range merge's runs are read before the arena is
+	 * set up, though; see range_merge_init().)
 	 */
-	Assert(state->slabFreeHead);
+	Assert(state->slabFreeHead || !state->slabAllocatorUsed);
 
 	if (tuplen > SLAB_SLOT_SIZE || !state->slabFreeHead)
 		return MemoryContextAlloc(state->base.sortcontext, tuplen);
@@ -3257,12 +3455,46 @@ tuplesort_initialize_shared(Sharedsort *shared, int nWorkers, dsm_segment *seg)
 	shared->workersFinished = 0;
 	SharedFileSetInit(&shared->fileset, seg);
 	shared->nTapes = nWorkers;
+	shared->indexSize = 0;
 	for (i = 0; i < nWorkers; i++)
 	{
 		shared->tapes[i].firstblocknumber = 0L;
 	}
 }
 
+/*
+ * tuplesort_estimate_shared_ranged - estimate shared memory allocation for
+ * a sort whose leader merges key ranges
+ *
+ * Like tuplesort_estimate_shared(), but leaves room for the workers to index
+ * their runs for tuplesort_merge_range().
+ */
+Size
+tuplesort_estimate_shared_ranged(int nWorkers)
+{
+	return add_size(tuplesort_estimate_shared(nWorkers),
+					mul_size(TapeIndexSize(RANGE_INDEX_ENTRIES), nWorkers));
+}
+
+/*
+ * tuplesort_initialize_shared_ranged - initialize shared tuplesort state for
+ * a sort whose leader merges key ranges
+ *
+ * Used instead of tuplesort_initialize_shared(), with the size returned by
+ * tuplesort_estimate_shared_ranged().
+ */
+void
+tuplesort_initialize_shared_ranged(Sharedsort *shared, int nWorkers,
+								   dsm_segment *seg)
+{
+	int			i;
+
+	tuplesort_initialize_shared(shared, nWorkers, seg);
+	shared->indexSize = RANGE_INDEX_ENTRIES;
+	for (i = 0; i < nWorkers; i++)
+		SharedsortIndex(shared, i)->nentries = 0;
+}
+
 /*
  * tuplesort_attach_shared - attach to shared tuplesort state
  *
@@ -3275,6 +3507,29 @@ tuplesort_attach_shared(Sharedsort *shared, dsm_segment *seg)
 	SharedFileSetAttach(&shared->fileset, seg);
 }
 
+/*
+ * tuplesort_reinitialize_shared - reset shared tuplesort state for reuse
+ *
+ * Must be called from leader process, once all tuplesortstates using the
+ * shared state have been ended, to throw away the runs written so far and
+ * let a new set of workers start over.
+ */
+void
+tuplesort_reinitialize_shared(Sharedsort *shared)
+{
+	int			i;
+
+	SharedFileSetDeleteAll(&shared->fileset);
+	shared->currentWorker = 0;
+	shared->workersFinished = 0;
+	for (i = 0; i < shared->nTapes; i++)
+	{
+		shared->tapes[i].firstblocknumber = 0L;
+		if (shared->indexSize > 0)
+			SharedsortIndex(shared, i)->nentries = 0;
+	}
+}
+
 /*
  * worker_get_identifier - Assign and return ordinal identifier for worker
  *
@@ -3341,6 +3596,16 @@ worker_freeze_result_tape(Tuplesortstate *state)
 	 */
 	LogicalTapeFreeze(state->result_tape, &output);
 
+	/* Hand over the index of the run, if the leader wants one */
+	if (state->runIndex)
+	{
+		TapeIndex  *index = SharedsortIndex(shared, state->worker);
+
+		index->nentries = state->runIndexCount;
+		memcpy(index->entries, state->runIndex,
+			   state->runIndexCount * sizeof(TapeIndexEntry));
+	}
+
 	/* Store properties of output tape, and update finished worker count */
 	SpinLockAcquire(&shared->mutex);
 	shared->tapes[state->worker] = output;
@@ -3365,6 +3630,56 @@ worker_nomergeruns(Tuplesortstate *state)
 	worker_freeze_result_tape(state);
 }
 
+/*
+ * worker_index_newrun - start the index of a new run
+ *
+ * Only the index of the final run is handed over to the leader, but we don't
+ * know which run that is until it has been written.
+ */
+static void
+worker_index_newrun(Tuplesortstate *state)
+{
+	Assert(WORKER(state));
+
+	state->runIndexCount = 0;
+	state->runIndexStride = 1;
+	state->runTuples = 0;
+}
+
+/*
+ * worker_index_tuple - index the tuple about to be written to the run
+ *
+ * The first tuple of a run is never indexed, since its position is simply
+ * the start of the tape.
+ */
+static void
+worker_index_tuple(Tuplesortstate *state)
+{
+	int			indexSize = state->shared->indexSize;
+
+	if (state->runTuples > 0 && state->runTuples % state->runIndexStride == 0)
+	{
+		if (state->runIndexCount == indexSize)
+		{
+			int			i;
+
+			/* Keep the entries for multiples of the doubled stride */
+			for (i = 0; 2 * i + 1 < indexSize; i++)
+				state->runIndex[i] = state->runIndex[2 * i + 1];
+			state->runIndexCount = i;
+			state->runIndexStride *= 2;
+		}
+
+		if (state->runTuples % state->runIndexStride == 0)
+		{
+			TapeIndexEntry *entry = &state->runIndex[state->runIndexCount++];
+
+			LogicalTapeTell(state->destTape, &entry->blocknum, &entry->offset);
+		}
+	}
+	state->runTuples++;
+}
+
 /*
  * leader_takeover_tapes - create tapeset for leader from worker tapes
  *
@@ -3432,6 +3747,159 @@ leader_takeover_tapes(Tuplesortstate *state)
 	state->status = TSS_BUILDRUNS;
 }
 
+/*
+ * range_merge_init - prepare a leader to merge key ranges
+ *
+ * Read the keys of the tuples that the workers indexed in their runs, and
+ * choose the range boundaries at evenly spaced positions among them.
+ */
+static void
+range_merge_init(Tuplesortstate *state, int nranges)
+{
+	Sharedsort *shared = state->shared;
+	SortTuple  *samples;
+	int			nsamples;
+	int			tapenum;
+	int			i;
+
+	Assert(shared->indexSize > 0);
+	Assert(nranges > 0);
+
+	/* As in mergeruns(), abbreviated keys are not stored in the runs */
+	if (state->base.sortKeys != NULL && state->base.sortKeys->abbrev_converter != NULL)
+	{
+		state->base.sortKeys->abbrev_converter = NULL;
+		state->base.sortKeys->comparator = state->base.sortKeys->abbrev_full_comparator;
+
+		/* Not strictly necessary, but be tidy */
+		state->base.sortKeys->abbrev_abort = NULL;
+		state->base.sortKeys->abbrev_full_comparator = NULL;
+	}
+
+	FREEMEM(state, GetMemoryChunkSpace(state->memtuples));
+	pfree(state->memtuples);
+	state->memtuples = NULL;
+
+	/*
+	 * The runs are read from every range's starting point, so they must not
+	 * be consumed as we go.
+	 */
+	state->inputTapes = state->outputTapes;
+	state->nInputTapes = state->nOutputTapes;
+	state->outputTapes = NULL;
+	state->nOutputTapes = 0;
+	state->nOutputRuns = 0;
+	for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
+		LogicalTapeFreezeImported(state->inputTapes[tapenum]);
+
+	/*
+	 * Read the key of each indexed tuple.  The slab allocator isn't set up
+	 * yet, so they are palloc'd and stay put until the end of the sort.
+	 */
+	state->rangeRuns = palloc_array(RangeMergeRun, state->nInputTapes);
+	nsamples = 0;
+	for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
+	{
+		RangeMergeRun *run = &state->rangeRuns[tapenum];
+		TapeIndex  *index = SharedsortIndex(shared, tapenum);
+		LogicalTape *tape = state->inputTapes[tapenum];
+
+		run->nentries = index->nentries;
+		run->entries = palloc_array(TapeIndexEntry, Max(run->nentries, 1));
+		memcpy(run->entries, index->entries,
+			   run->nentries * sizeof(TapeIndexEntry));
+		run->keys = palloc_array(SortTuple, Max(run->nentries, 1));
+
+		for (i = 0; i < run->nentries; i++)
+		{
+			LogicalTapeSeek(tape, run->entries[i].blocknum,
+							run->entries[i].offset);
+			READTUP(state, &run->keys[i], tape, getlen(tape, false));
+		}
+		nsamples += run->nentries;
+	}
+
+	/* Choose the boundaries from all the keys, in sorted order */
+	state->nranges = nranges;
+	state->nsplitters = 0;
+	if (nsamples > 0 && nranges > 1)
+	{
+		samples = palloc_array(SortTuple, nsamples);
+		nsamples = 0;
+		for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
+		{
+			RangeMergeRun *run = &state->rangeRuns[tapenum];
+
+			memcpy(&samples[nsamples], run->keys,
+				   run->nentries * sizeof(SortTuple));
+			nsamples += run->nentries;
+		}
+		qsort_tuple(samples, nsamples, state->base.comparetup, state);
+
+		state->nsplitters = nranges - 1;
+		state->splitters = palloc_array(SortTuple, state->nsplitters);
+		for (i = 0; i < state->nsplitters; i++)
+			state->splitters[i] = samples[(int64) (i + 1) * nsamples / nranges];
+		pfree(samples);
+	}
+
+	/*
+	 * Set up the slab allocator and the merge heap, as in mergeruns().  We
+	 * read a single block at a time from each run; there's little to gain
+	 * from larger buffers when the runs are read only in part.
+	 */
+	if (state->base.tuples)
+		init_slab_allocator(state, state->nInputTapes + 1);
+	else
+		init_slab_allocator(state, 0);
+
+	state->memtupsize = state->nInputTapes;
+	state->memtuples = (SortTuple *) MemoryContextAlloc(state->base.maincontext,
+														state->nInputTapes * sizeof(SortTuple));
+	USEMEM(state, GetMemoryChunkSpace(state->memtuples));
+
+	if (trace_sort)
+		elog(LOG, "leader chose %d boundaries of %d key ranges among %d sampled keys: %s",
+			 state->nsplitters, nranges, nsamples,
+			 pg_rusage_show(&state->ru_start));
+}
+
+/*
+ * range_merge_seek - position a run for reading the tuples above 'lo'
+ *
+ * Seek to the last indexed tuple that is not above 'lo', or rewind to the
+ * start of the run if there is no such tuple or no lower bound.  The caller
+ * skips the tuples not above 'lo' from there.
+ */
+static void
+range_merge_seek(Tuplesortstate *state, int tapenum, SortTuple *lo)
+{
+	RangeMergeRun *run = &state->rangeRuns[tapenum];
+	LogicalTape *tape = state->inputTapes[tapenum];
+	int			low = 0;
+	int			high = run->nentries;
+
+	if (lo != NULL)
+	{
+		/* binary search for the first indexed tuple above 'lo' */
+		while (low < high)
+		{
+			int			mid = low + (high - low) / 2;
+
+			if (COMPARETUP(state, &run->keys[mid], lo) <= 0)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+	}
+
+	if (lo == NULL || low == 0)
+		LogicalTapeRewindForRead(tape, BLCKSZ);
+	else
+		LogicalTapeSeek(tape, run->entries[low - 1].blocknum,
+						run->entries[low - 1].offset);
+}
+
 /*
  * Convenience routine to free a tuple previously loaded into sort memory
  */
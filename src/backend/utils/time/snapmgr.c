@@ -107,6 +107,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "access/csnlog.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
 #include "access/xact.h"
@@ -255,6 +256,7 @@ typedef struct SerializedSnapshotData
 	uint32		xcnt;
 	int32		subxcnt;
 	bool		suboverflowed;
+	uint64		csn;
 	bool		takenDuringRecovery;
 	CommandId	curcid;
 } SerializedSnapshotData;
@@ -545,6 +547,7 @@ SetTransactionSnapshot(Snapshot sourcesnap, VirtualTransactionId *sourcevxid,
 		memcpy(CurrentSnapshot->subxip, sourcesnap->subxip,
 			   sourcesnap->subxcnt * sizeof(TransactionId));
 	CurrentSnapshot->suboverflowed = sourcesnap->suboverflowed;
+	CurrentSnapshot->csn = sourcesnap->csn;
 	CurrentSnapshot->takenDuringRecovery = sourcesnap->takenDuringRecovery;
 	/* NB: curcid should NOT be copied, it's a local matter */
 
@@ -656,6 +659,53 @@ CopySnapshot(Snapshot snapshot)
 	return newsnap;
 }
 
+/*
+ * MaterializeSnapshot
+ *		Copy a CSN-based snapshot into the regular form, with the XIDs of
+ *		the transactions it considers running listed in xip[].
+ *
+ * This is for the places that hand snapshots to the outside world.  The
+ * XIDs come from the proc array and its record of recently completed
+ * transactions, see GetCSNSnapshotXids().  The result is palloc'd in
+ * TopTransactionContext like with CopySnapshot.
+ */
+Snapshot
+MaterializeSnapshot(Snapshot snapshot)
+{
+	Snapshot	newsnap;
+	TransactionId *xip;
+	uint32		xcnt;
+
+	Assert(snapshot->csn != InvalidCommitSeqNo);
+
+	xip = palloc_array(TransactionId, GetMaxSnapshotXidCount());
+	xcnt = GetCSNSnapshotXids(snapshot, xip);
+
+	newsnap = (Snapshot) MemoryContextAlloc(TopTransactionContext,
+											sizeof(SnapshotData) +
+											xcnt * sizeof(TransactionId));
+	memcpy(newsnap, snapshot, sizeof(SnapshotData));
+
+	newsnap->regd_count = 0;
+	newsnap->active_count = 0;
+	newsnap->copied = true;
+	newsnap->snapXactCompletionCount = 0;
+	newsnap->csn = InvalidCommitSeqNo;
+
+	newsnap->xip = (TransactionId *) (newsnap + 1);
+	newsnap->xcnt = xcnt;
+	if (xcnt > 0)
+		memcpy(newsnap->xip, xip, xcnt * sizeof(TransactionId));
+	pfree(xip);
+
+	/* Subtransactions are left to pg_subtrans */
+	newsnap->subxip = NULL;
+	newsnap->subxcnt = 0;
+	newsnap->suboverflowed = true;
+
+	return newsnap;
+}
+
 /*
  * FreeSnapshot
  *		Free the memory associated with a snapshot.
@@ -1174,9 +1224,13 @@ ExportSnapshot(Snapshot snapshot)
 	 * Copy the snapshot into TopTransactionContext, add it to the
 	 * exportedSnapshots list, and mark it pseudo-registered.  We do this to
 	 * ensure that the snapshot's xmin is honored for the rest of the
-	 * transaction.
+	 * transaction.  A CSN-based snapshot is turned into the regular form,
+	 * which is what the file format can express.
 	 */
-	snapshot = CopySnapshot(snapshot);
+	if (snapshot->csn != InvalidCommitSeqNo)
+		snapshot = MaterializeSnapshot(snapshot);
+	else
+		snapshot = CopySnapshot(snapshot);
 
 	oldcxt = MemoryContextSwitchTo(TopTransactionContext);
 	esnap = palloc_object(ExportedSnapshot);
@@ -1745,6 +1799,7 @@ SerializeSnapshot(Snapshot snapshot, char *start_address)
 	serialized_snapshot.xcnt = snapshot->xcnt;
 	serialized_snapshot.subxcnt = snapshot->subxcnt;
 	serialized_snapshot.suboverflowed = snapshot->suboverflowed;
+	serialized_snapshot.csn = snapshot->csn;
 	serialized_snapshot.takenDuringRecovery = snapshot->takenDuringRecovery;
 	serialized_snapshot.curcid = snapshot->curcid;
 
@@ -1817,6 +1872,7 @@ RestoreSnapshot(char *start_address)
 	snapshot->subxip = NULL;
 	snapshot->subxcnt = serialized_snapshot.subxcnt;
 	snapshot->suboverflowed = serialized_snapshot.suboverflowed;
+	snapshot->csn = serialized_snapshot.csn;
 	snapshot->takenDuringRecovery = serialized_snapshot.takenDuringRecovery;
 	snapshot->curcid = serialized_snapshot.curcid;
 	snapshot->snapXactCompletionCount = 0;
@@ -1883,6 +1939,28 @@ XidInMVCCSnapshot(TransactionId xid, Snapshot snapshot)
 	if (TransactionIdFollowsOrEquals(xid, snapshot->xmax))
 		return true;
 
+	/*
+	 * A CSN-based snapshot has no xip arrays; instead, look up when the
+	 * transaction completed.  Subtransactions have no entries of their own,
+	 * so go by their top-level transaction, as for an overflowed snapshot.
+	 */
+	if (snapshot->csn != InvalidCommitSeqNo)
+	{
+		uint64		csn = CSNLogGetCommitSeqNo(xid);
+
+		if (csn == InvalidCommitSeqNo)
+		{
+			TransactionId topxid = SubTransGetTopmostTransaction(xid);
+
+			if (TransactionIdPrecedes(topxid, snapshot->xmin))
+				return false;
+			if (!TransactionIdEquals(topxid, xid))
+				csn = CSNLogGetCommitSeqNo(topxid);
+		}
+
+		return csn == InvalidCommitSeqNo || csn > snapshot->csn;
+	}
+
 	/*
 	 * Snapshot information is stored slightly differently in snapshots taken
 	 * during recovery.
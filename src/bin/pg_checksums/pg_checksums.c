@@ -31,6 +31,7 @@
 #include "storage/bufpage.h"
 #include "storage/checksum.h"
 #include "storage/checksum_impl.h"
+#include "storage/pagecompress.h"
 
 
 static int64 files_scanned = 0;
@@ -172,6 +173,26 @@ skipfile(const char *fn)
 	return false;
 }
 
+/*
+ * Is this file the address map or the data file of a compressed relation
+ * fork?  See storage/pagecompress.h.
+ */
+static bool
+is_compressed_file(const char *fn)
+{
+	size_t		len = strlen(fn);
+	size_t		suffixlen = strlen(PAGE_COMPRESS_MAP_SUFFIX);
+	char		mapfn[MAXPGPATH];
+	struct stat st;
+
+	if (len > suffixlen &&
+		strcmp(fn + len - suffixlen, PAGE_COMPRESS_MAP_SUFFIX) == 0)
+		return true;
+
+	snprintf(mapfn, sizeof(mapfn), "%s%s", fn, PAGE_COMPRESS_MAP_SUFFIX);
+	return lstat(mapfn, &st) == 0;
+}
+
 static void
 scan_file(const char *fn, int segmentno)
 {
@@ -346,6 +367,23 @@ scan_directory(const char *basedir, const char *subdir, bool sizeonly)
 			if (skipfile(de->d_name))
 				continue;
 
+			/*
+			 * The pages of compressed relation forks cannot be checked or
+			 * updated in place, so skip their address maps and data files.
+			 * Checksums cannot be enabled with such forks around, as their
+			 * pages would fail verification once read back.
+			 */
+			if (is_compressed_file(fn))
+			{
+				if (mode == PG_MODE_ENABLE)
+				{
+					pg_log_error("cannot enable checksums with compressed relation file \"%s\"", fn);
+					pg_log_error_hint("Rewrite the relation without the page_compression storage parameter first.");
+					exit(1);
+				}
+				continue;
+			}
+
 			/*
 			 * Cut off at the segment boundary (".") to get the segment number
 			 * in order to mix it into the checksum. Then also cut off at the
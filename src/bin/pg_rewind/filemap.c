@@ -31,6 +31,7 @@
 #include "common/file_utils.h"
 #include "common/hashfn_unstable.h"
 #include "common/string.h"
+#include "storage/pagecompress.h"
 #include "datapagemap.h"
 #include "filemap.h"
 #include "pg_rewind.h"
@@ -129,6 +130,9 @@ static const char *const excludeDirContents[] =
 	 */
 	"pg_replslot",				/* defined as PG_REPLSLOT_DIR */
 
+	/* Contents zeroed on startup, see StartupCSNLog(). */
+	"pg_csn",
+
 	/* Contents removed on startup, see dsm_cleanup_for_mmap(). */
 	"pg_dynshmem",				/* defined as PG_DYNSHMEM_DIR */
 
@@ -141,6 +145,9 @@ static const char *const excludeDirContents[] =
 	 */
 	"pg_serial",
 
+	/* Contents removed on startup, see SessionPoolShmemInit(). */
+	"pg_sessionpool",				/* defined as PG_SESSIONPOOL_DIR */
+
 	/* Contents removed on startup, see DeleteAllExportedSnapshotFiles(). */
 	"pg_snapshots",
 
@@ -742,6 +749,23 @@ decide_wal_file_action(const char *fname, XLogSegNo last_common_segno,
 	return FILE_ACTION_COPY;
 }
 
+/*
+ * Is this relation data file the data file of a compressed fork, in either
+ * system?  See storage/pagecompress.h.
+ */
+static bool
+is_compressed_rel_file(file_entry_t *entry)
+{
+	char		mappath[MAXPGPATH];
+	file_entry_t *map;
+
+	snprintf(mappath, sizeof(mappath), "%s%s",
+			 entry->path, PAGE_COMPRESS_MAP_SUFFIX);
+	map = lookup_filehash_entry(mappath);
+
+	return map != NULL && (map->source_exists || map->target_exists);
+}
+
 /*
  * Decide what action to perform to a file.
  */
@@ -870,6 +894,19 @@ decide_file_action(file_entry_t *entry, XLogSegNo last_common_segno)
 				 */
 				return FILE_ACTION_COPY;
 			}
+			else if (is_compressed_rel_file(entry))
+			{
+				/*
+				 * The data file of a compressed fork does not hold pages at
+				 * block boundaries, so the blocks modified in the target
+				 * cannot be copied individually.  Copy it in toto, along with
+				 * its address map.
+				 */
+				pg_free(entry->target_pages_to_overwrite.bitmap);
+				entry->target_pages_to_overwrite.bitmap = NULL;
+				entry->target_pages_to_overwrite.bitmapsize = 0;
+				return FILE_ACTION_COPY;
+			}
 			else
 			{
 				/*
@@ -16,6 +16,7 @@
 #include "common/int.h"
 #include "common/logging.h"
 #include "pg_upgrade.h"
+#include "storage/pagecompress.h"
 
 static void transfer_single_new_db(FileNameMap *maps, int size, char *old_tablespace, char *new_tablespace);
 static void transfer_relfile(FileNameMap *map, const char *type_suffix, bool vm_must_add_frozenbit);
@@ -528,10 +529,13 @@ transfer_single_new_db(FileNameMap *maps, int size,
 			transfer_relfile(&maps[mapnum], "", vm_must_add_frozenbit);
 
 			/*
-			 * Copy/link any fsm and vm files, if they exist
+			 * Copy/link any fsm and vm files, and the address map of a
+			 * compressed primary file, if they exist
 			 */
 			transfer_relfile(&maps[mapnum], "_fsm", vm_must_add_frozenbit);
 			transfer_relfile(&maps[mapnum], "_vm", vm_must_add_frozenbit);
+			transfer_relfile(&maps[mapnum], PAGE_COMPRESS_MAP_SUFFIX,
+							 vm_must_add_frozenbit);
 		}
 	}
 }
@@ -580,7 +584,7 @@ transfer_relfile(FileNameMap *map, const char *type_suffix, bool vm_must_add_fro
 				 type_suffix,
 				 extent_suffix);
 
-		/* Is it an extent, fsm, or vm file? */
+		/* Is it an extent, fsm, vm, or address map file? */
 		if (type_suffix[0] != '\0' || segno != 0)
 		{
 			/* Did file open fail? */
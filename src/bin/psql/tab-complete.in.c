@@ -1444,6 +1444,7 @@ static const char *const table_storage_parameters[] = {
 	"fillfactor",
 	"log_autovacuum_min_duration",
 	"log_autoanalyze_min_duration",
+	"page_compression",
 	"parallel_workers",
 	"toast.autovacuum_enabled",
 	"toast.autovacuum_freeze_max_age",
@@ -2534,17 +2535,19 @@ match_previous_words(int pattern_id,
 	/* ALTER INDEX <foo> SET|RESET ( */
 	else if (Matches("ALTER", "INDEX", MatchAny, "RESET", "("))
 		COMPLETE_WITH("fillfactor",
-					  "deduplicate_items",	/* BTREE */
+					  "deduplicate_items", "page_compression",	/* BTREE */
 					  "fastupdate", "gin_pending_list_limit",	/* GIN */
 					  "buffering",	/* GiST */
-					  "pages_per_range", "autosummarize"	/* BRIN */
+					  "pages_per_range", "autosummarize",	/* BRIN */
+					  "max_pages_per_range"
 			);
 	else if (Matches("ALTER", "INDEX", MatchAny, "SET", "("))
 		COMPLETE_WITH("fillfactor =",
-					  "deduplicate_items =",	/* BTREE */
+					  "deduplicate_items =", "page_compression =",	/* BTREE */
 					  "fastupdate =", "gin_pending_list_limit =",	/* GIN */
 					  "buffering =",	/* GiST */
-					  "pages_per_range =", "autosummarize ="	/* BRIN */
+					  "pages_per_range =", "autosummarize =",	/* BRIN */
+					  "max_pages_per_range ="
 			);
 	else if (Matches("ALTER", "INDEX", MatchAny, "NO", "DEPENDS"))
 		COMPLETE_WITH("ON EXTENSION");
@@ -5511,9 +5514,10 @@ match_previous_words(int pattern_id,
 			COMPLETE_WITH("FULL", "FREEZE", "ANALYZE", "VERBOSE",
 						  "DISABLE_PAGE_SKIPPING", "SKIP_LOCKED",
 						  "INDEX_CLEANUP", "PROCESS_MAIN", "PROCESS_TOAST",
-						  "TRUNCATE", "PARALLEL", "SKIP_DATABASE_STATS",
-						  "ONLY_DATABASE_STATS", "BUFFER_USAGE_LIMIT");
-		else if (TailMatches("FULL|FREEZE|ANALYZE|VERBOSE|DISABLE_PAGE_SKIPPING|SKIP_LOCKED|PROCESS_MAIN|PROCESS_TOAST|TRUNCATE|SKIP_DATABASE_STATS|ONLY_DATABASE_STATS"))
+						  "TRUNCATE", "PARALLEL", "PARALLEL_HEAP",
+						  "SKIP_DATABASE_STATS", "ONLY_DATABASE_STATS",
+						  "BUFFER_USAGE_LIMIT");
+		else if (TailMatches("FULL|FREEZE|ANALYZE|VERBOSE|DISABLE_PAGE_SKIPPING|SKIP_LOCKED|PROCESS_MAIN|PROCESS_TOAST|TRUNCATE|PARALLEL_HEAP|SKIP_DATABASE_STATS|ONLY_DATABASE_STATS"))
 			COMPLETE_WITH("ON", "OFF");
 		else if (TailMatches("INDEX_CLEANUP"))
 			COMPLETE_WITH("AUTO", "ON", "OFF");
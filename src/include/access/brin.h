@@ -24,6 +24,7 @@ typedef struct BrinOptions
 	int32		vl_len_;		/* varlena header (do not touch directly!) */
 	BlockNumber pagesPerRange;
 	bool		autosummarize;
+	int			maxPagesPerRange;	/* 0 if ranges are never merged */
 } BrinOptions;
 
 
@@ -50,6 +51,11 @@ typedef struct BrinStatsData
 	 (relation)->rd_options ? \
 	 ((BrinOptions *) (relation)->rd_options)->autosummarize : \
 	  false)
+#define BrinGetMaxPagesPerRange(relation) \
+	(AssertMacro(relation->rd_rel->relkind == RELKIND_INDEX && \
+				 relation->rd_rel->relam == BRIN_AM_OID), \
+	 (relation)->rd_options ? \
+	 ((BrinOptions *) (relation)->rd_options)->maxPagesPerRange : 0)
 
 
 extern void brinGetStats(Relation index, BrinStatsData *stats);
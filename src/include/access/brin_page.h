@@ -93,4 +93,18 @@ typedef struct RevmapContents
 #define REVMAP_PAGE_MAXITEMS \
 	(REVMAP_CONTENT_SIZE / sizeof(ItemPointerData))
 
+/*
+ * A page range can be merged into the range preceding it (see
+ * max_pages_per_range).  The revmap item of a merged range does not point to
+ * a summary tuple of its own: it holds the metapage block number, which
+ * never contains index tuples, and as offset the number of ranges back to
+ * the first range of the merged range, whose item points to the summary
+ * tuple of the whole.  Both items are always on the same revmap page.
+ */
+#define RevmapItemIsMerged(iptr) \
+	(ItemPointerIsValid(iptr) && \
+	 ItemPointerGetBlockNumberNoCheck(iptr) == BRIN_METAPAGE_BLKNO)
+#define RevmapItemGetMergedDistance(iptr) \
+	ItemPointerGetOffsetNumberNoCheck(iptr)
+
 #endif							/* BRIN_PAGE_H */
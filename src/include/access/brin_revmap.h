@@ -37,5 +37,12 @@ extern BrinTuple *brinGetTupleForHeapBlock(BrinRevmap *revmap,
 										   BlockNumber heapBlk, Buffer *buf, OffsetNumber *off,
 										   Size *size, int mode);
 extern bool brinRevmapDesummarizeRange(Relation idxrel, BlockNumber heapBlk);
+extern void brinRevmapDetachMergedRanges(Buffer buf, BlockNumber pagesPerRange,
+										 BlockNumber heapBlk);
+extern bool brinRevmapCanMergeRanges(BrinRevmap *revmap, BlockNumber heapBlk,
+									 BlockNumber headBlk);
+extern bool brinRevmapMergeRange(BrinRevmap *revmap, BlockNumber heapBlk,
+								 BlockNumber headBlk, BrinTuple *origtup,
+								 Size origsz);
 
 #endif							/* BRIN_REVMAP_H */
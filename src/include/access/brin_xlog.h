@@ -34,6 +34,7 @@
 #define XLOG_BRIN_SAMEPAGE_UPDATE	0x30
 #define XLOG_BRIN_REVMAP_EXTEND		0x40
 #define XLOG_BRIN_DESUMMARIZE		0x50
+#define XLOG_BRIN_MERGE				0x60
 
 #define XLOG_BRIN_OPMASK			0x70
 /*
@@ -128,7 +129,7 @@ typedef struct xl_brin_revmap_extend
  * This is what we need to know about a range de-summarization
  *
  * Backup block 0: revmap page
- * Backup block 1: regular page
+ * Backup block 1: regular page, unless the range was merged into another one
  */
 typedef struct xl_brin_desummarize
 {
@@ -142,6 +143,26 @@ typedef struct xl_brin_desummarize
 #define SizeOfBrinDesummarize	(offsetof(xl_brin_desummarize, regOffset) + \
 								 sizeof(OffsetNumber))
 
+/*
+ * This is what we need to know about merging a range into a preceding one
+ *
+ * Backup block 0: revmap page
+ * Backup block 1: regular page
+ */
+typedef struct xl_brin_merge
+{
+	BlockNumber pagesPerRange;
+	/* page number location to point to the range merged into */
+	BlockNumber heapBlk;
+	/* first page of the range merged into */
+	BlockNumber headBlk;
+	/* offset of item to delete in regular index page */
+	OffsetNumber regOffset;
+} xl_brin_merge;
+
+#define SizeOfBrinMerge	(offsetof(xl_brin_merge, regOffset) + \
+						 sizeof(OffsetNumber))
+
 
 extern void brin_redo(XLogReaderState *record);
 extern void brin_desc(StringInfo buf, XLogReaderState *record);
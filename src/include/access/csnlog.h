@@ -0,0 +1,32 @@
+/*
+ * csnlog.h
+ *
+ * Commit sequence number log, for CSN-based snapshots
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/csnlog.h
+ */
+#ifndef CSNLOG_H
+#define CSNLOG_H
+
+/*
+ * A commit sequence number is the value TransamVariables->xactCompletionCount
+ * had right after a transaction completed.  Zero means that the transaction
+ * hasn't completed yet, or that it completed before the log was started.
+ */
+#define InvalidCommitSeqNo		((uint64) 0)
+
+/* GUC variable */
+extern PGDLLIMPORT bool csn_snapshots;
+
+extern void CSNLogSetCommitSeqNo(TransactionId xid, uint64 csn);
+extern uint64 CSNLogGetCommitSeqNo(TransactionId xid);
+
+extern void StartupCSNLog(TransactionId oldestActiveXID);
+extern void CheckPointCSNLog(void);
+extern void ExtendCSNLog(TransactionId newestXact);
+extern void TruncateCSNLog(TransactionId oldestXact);
+
+#endif							/* CSNLOG_H */
@@ -24,7 +24,9 @@
 #include "common/hashfn.h"
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm.h"
 #include "storage/lockdefs.h"
+#include "storage/shm_toc.h"
 #include "utils/hsearch.h"
 #include "utils/relcache.h"
 
@@ -456,6 +458,11 @@ extern void _h_spooldestroy(HSpool *hspool);
 extern void _h_spool(HSpool *hspool, const ItemPointerData *self,
 					 const Datum *values, const bool *isnull);
 extern void _h_indexbuild(HSpool *hspool, Relation heapRel);
+extern HSpool *_h_parallel_spool(Relation heap, Relation index,
+								 uint32 num_buckets, bool isconcurrent,
+								 int request, double *reltuples,
+								 double *indtuples);
+extern void _hash_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 
 /* hashutil.c */
 extern bool _hash_checkqual(IndexScanDesc scan, IndexTuple itup);
@@ -46,6 +46,7 @@
 
 typedef struct BulkInsertStateData *BulkInsertState;
 typedef struct GlobalVisState GlobalVisState;
+typedef struct ParallelVacuumState ParallelVacuumState;
 typedef struct TupleTableSlot TupleTableSlot;
 typedef struct VacuumCutoffs VacuumCutoffs;
 typedef struct VacuumParams VacuumParams;
@@ -130,6 +131,16 @@ typedef struct IndexFetchHeapData
 
 	/* Current heap block's corresponding page in the visibility map */
 	Buffer		xs_vmbuffer;
+
+	/*
+	 * Read stream for the heap blocks of the TIDs in xs_base.batch, if any.
+	 * xs_stream_blk is the block most recently returned by the stream's
+	 * callback, and xs_stream_paused is set when the callback ran out of
+	 * TIDs and paused the stream.
+	 */
+	ReadStream *xs_stream;
+	BlockNumber xs_stream_blk;
+	bool		xs_stream_paused;
 } IndexFetchHeapData;
 
 /* Result codes for HeapTupleSatisfiesVacuum */
@@ -467,6 +478,13 @@ extern void log_heap_prune_and_freeze(Relation relation, Buffer buffer,
 /* in heap/vacuumlazy.c */
 extern void heap_vacuum_rel(Relation rel,
 							const VacuumParams *params, BufferAccessStrategy bstrategy);
+extern int	heap_parallel_vacuum_compute_workers(Relation rel,
+												 int nworkers_requested);
+extern Size heap_parallel_vacuum_estimate(Relation rel, int nworkers);
+extern void heap_parallel_vacuum_worker(Relation rel,
+										ParallelVacuumState *pvs,
+										void *state,
+										BufferAccessStrategy bstrategy);
 #ifdef USE_ASSERT_CHECKING
 extern bool heap_page_is_all_visible(Relation rel, Buffer buf,
 									 GlobalVisState *vistest,
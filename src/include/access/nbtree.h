@@ -23,6 +23,7 @@
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
 #include "storage/dsm.h"
+#include "storage/pagecompress.h"
 #include "storage/shm_toc.h"
 #include "utils/skipsupport.h"
 
@@ -1122,6 +1123,7 @@ typedef struct BTOptions
 	int			fillfactor;		/* page fill factor in percent (0..100) */
 	float8		vacuum_cleanup_index_scale_factor;	/* deprecated */
 	bool		deduplicate_items;	/* Try to deduplicate items? */
+	PageCompressionMethod page_compression; /* compression of new storage */
 } BTOptions;
 
 #define BTGetFillFactor(relation) \
@@ -1137,6 +1139,12 @@ typedef struct BTOptions
 				 relation->rd_rel->relam == BTREE_AM_OID), \
 	((relation)->rd_options ? \
 	 ((BTOptions *) (relation)->rd_options)->deduplicate_items : true))
+#define BTGetPageCompression(relation) \
+	(AssertMacro(relation->rd_rel->relkind == RELKIND_INDEX && \
+				 relation->rd_rel->relam == BTREE_AM_OID), \
+	((relation)->rd_options ? \
+	 ((BTOptions *) (relation)->rd_options)->page_compression : \
+	 PAGE_COMPRESSION_NONE))
 
 /*
  * Constant definition for progress reporting.  Phase numbers must match
@@ -1161,6 +1169,8 @@ extern IndexScanDesc btbeginscan(Relation rel, int nkeys, int norderbys);
 extern Size btestimateparallelscan(Relation rel, int nkeys, int norderbys);
 extern void btinitparallelscan(void *target);
 extern bool btgettuple(IndexScanDesc scan, ScanDirection dir);
+extern int	btgetbatch(IndexScanDesc scan, ScanDirection dir,
+					   ItemPointer tids, int maxtids);
 extern int64 btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm);
 extern void btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 					 ScanKey orderbys, int norderbys);
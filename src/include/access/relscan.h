@@ -16,6 +16,7 @@
 
 #include "access/htup_details.h"
 #include "access/itup.h"
+#include "access/sdir.h"
 #include "nodes/tidbitmap.h"
 #include "port/atomics.h"
 #include "storage/relfilelocator.h"
@@ -120,6 +121,27 @@ typedef struct ParallelBlockTableScanWorkerData
 } ParallelBlockTableScanWorkerData;
 typedef struct ParallelBlockTableScanWorkerData *ParallelBlockTableScanWorker;
 
+/* maximum number of TIDs in an IndexScanBatch */
+#define INDEX_SCAN_BATCH_MAX_TIDS	512
+
+/*
+ * Batch of heap TIDs that an amgettuple-based scan is going to return, as
+ * reported by the index AM's amgetbatch callback.  tids[0] is the TID that
+ * amgettuple returned when the batch was fetched, and the rest are the ones
+ * it will return next, in order.  The table AM may read ahead through the
+ * batch to start reading the blocks it'll need before it needs them.
+ */
+typedef struct IndexScanBatchData
+{
+	ScanDirection dir;			/* scan direction of the batch */
+	int			ntids;			/* number of valid tids[] */
+	int			nreturned;		/* # of tids[] returned by amgettuple */
+	int			nread;			/* # of tids[] read ahead by the table AM */
+	ItemPointerData tids[INDEX_SCAN_BATCH_MAX_TIDS];
+} IndexScanBatchData;
+
+typedef struct IndexScanBatchData *IndexScanBatch;
+
 /*
  * Base class for fetches from a table via an index. This is the base-class
  * for such scans, which needs to be embedded in the respective struct for
@@ -134,6 +156,15 @@ typedef struct IndexFetchTableData
 	 * permitted.
 	 */
 	uint32		flags;
+
+	/*
+	 * TIDs that the index scan will ask for next, or NULL.  Only set up when
+	 * the caller requested SO_INDEX_PREFETCH and the index AM supports
+	 * amgetbatch.  The caller promises to fetch every TID returned by the
+	 * index scan, in order, so the table AM can rely on the batch to predict
+	 * its future fetches.
+	 */
+	IndexScanBatch batch;
 } IndexFetchTableData;
 
 struct IndexScanInstrumentation;
@@ -186,6 +217,7 @@ typedef struct IndexScanDescData
 	bool		xs_heap_continue;	/* T if must keep walking, potential
 									 * further results */
 	IndexFetchTableData *xs_heapfetch;
+	IndexScanBatch xs_batch;	/* upcoming TIDs, if reading ahead */
 
 	bool		xs_recheck;		/* T means scan keys must be rechecked */
 
@@ -17,6 +17,8 @@
 #include "access/amapi.h"
 #include "access/xlogreader.h"
 #include "lib/stringinfo.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
 
 
 /* SPGiST opclass support function numbers */
@@ -196,6 +198,7 @@ extern bytea *spgoptions(Datum reloptions, bool validate);
 extern IndexBuildResult *spgbuild(Relation heap, Relation index,
 								  struct IndexInfo *indexInfo);
 extern void spgbuildempty(Relation index);
+extern void _spg_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 extern bool spginsert(Relation index, Datum *values, bool *isnull,
 					  ItemPointer ht_ctid, Relation heapRel,
 					  IndexUniqueCheck checkUnique,
@@ -36,6 +36,7 @@ extern PGDLLIMPORT bool synchronize_seqscans;
 /* forward references in this file */
 typedef struct BulkInsertStateData BulkInsertStateData;
 typedef struct IndexInfo IndexInfo;
+typedef struct ParallelVacuumState ParallelVacuumState;
 typedef struct SampleScanState SampleScanState;
 typedef struct ScanKeyData ScanKeyData;
 typedef struct ValidateIndexState ValidateIndexState;
@@ -72,6 +73,9 @@ typedef enum ScanOptions
 
 	/* collect scan instrumentation */
 	SO_SCAN_INSTRUMENT = 1 << 11,
+
+	/* read ahead the table blocks an index scan is going to fetch */
+	SO_INDEX_PREFETCH = 1 << 12,
 }			ScanOptions;
 
 /*
@@ -455,12 +459,18 @@ typedef struct TableAmRoutine
 	 * behavior. See scan_begin() for more information on passing these.
 	 *
 	 * Tuples for an index scan can then be fetched via index_fetch_tuple.
+	 *
+	 * The callback must initialize the returned struct's batch field to
+	 * NULL.  If SO_INDEX_PREFETCH was given, the caller may set it afterwards
+	 * to point to the TIDs it is going to fetch next, which the AM may use to
+	 * read ahead.
 	 */
 	struct IndexFetchTableData *(*index_fetch_begin) (Relation rel, uint32 flags);
 
 	/*
 	 * Reset index fetch. Typically this will release cross index fetch
-	 * resources held in IndexFetchTableData.
+	 * resources held in IndexFetchTableData.  Any read-ahead based on the
+	 * batch has to be forgotten, as the batch is going to be refilled.
 	 */
 	void		(*index_fetch_reset) (struct IndexFetchTableData *data);
 
@@ -692,6 +702,28 @@ typedef struct TableAmRoutine
 									const VacuumParams *params,
 									BufferAccessStrategy bstrategy);
 
+	/*
+	 * Callbacks for processing the table itself in parallel during VACUUM
+	 * with the PARALLEL_HEAP option, on top of its indexes.  These are
+	 * optional: the tables of an AM that doesn't provide them only get their
+	 * indexes vacuumed in parallel.  See vacuumparallel.c.
+	 *
+	 * parallel_vacuum_compute_workers returns the number of parallel workers
+	 * worth launching for the table, given the number requested by the user
+	 * (0 if the AM is to decide).  parallel_vacuum_estimate returns the size
+	 * of the state shared between the participants of a parallel vacuum with
+	 * nworkers workers, which is zeroed and placed in the DSM segment of the
+	 * parallel vacuum.  parallel_vacuum_worker is run by each worker launched
+	 * with parallel_vacuum_table_begin().
+	 */
+	int			(*parallel_vacuum_compute_workers) (Relation rel,
+													int nworkers_requested);
+	Size		(*parallel_vacuum_estimate) (Relation rel, int nworkers);
+	void		(*parallel_vacuum_worker) (Relation rel,
+										   ParallelVacuumState *pvs,
+										   void *state,
+										   BufferAccessStrategy bstrategy);
+
 	/*
 	 * Prepare to analyze block `blockno` of `scan`. The scan has been started
 	 * with table_beginscan_analyze().  See also
@@ -1780,6 +1812,41 @@ table_relation_vacuum(Relation rel, const VacuumParams *params,
 	rel->rd_tableam->relation_vacuum(rel, params, bstrategy);
 }
 
+/*
+ * Return the number of parallel workers to use to process the table itself
+ * during VACUUM, or 0 if the table AM does not support that.
+ */
+static inline int
+table_parallel_vacuum_compute_workers(Relation rel, int nworkers_requested)
+{
+	/* optional callback */
+	if (rel->rd_tableam->parallel_vacuum_compute_workers == NULL)
+		return 0;
+
+	return rel->rd_tableam->parallel_vacuum_compute_workers(rel,
+															 nworkers_requested);
+}
+
+/*
+ * Estimate the size of the state the table AM shares between the
+ * participants of a parallel vacuum.
+ */
+static inline Size
+table_parallel_vacuum_estimate(Relation rel, int nworkers)
+{
+	return rel->rd_tableam->parallel_vacuum_estimate(rel, nworkers);
+}
+
+/*
+ * Process the table in a parallel vacuum worker.
+ */
+static inline void
+table_parallel_vacuum_worker(Relation rel, ParallelVacuumState *pvs,
+							 void *state, BufferAccessStrategy bstrategy)
+{
+	rel->rd_tableam->parallel_vacuum_worker(rel, pvs, state, bstrategy);
+}
+
 /*
  * Prepare to analyze the next block in the read stream. The scan needs to
  * have been  started with table_beginscan_analyze().  Note that this routine
@@ -243,10 +243,27 @@ typedef struct TransamVariablesData
 	 * modified the database) that completed in some form since the start of
 	 * the server. This currently is solely used to check whether
 	 * GetSnapshotData() needs to recompute the contents of the snapshot, or
-	 * not. There are likely other users of this.  Always above 1.
+	 * not. It also serves as the commit sequence number for CSN-based
+	 * snapshots, see csnlog.c.  Always above 1.
 	 */
 	uint64		xactCompletionCount;
 
+	/*
+	 * With csn_snapshots, a lower bound on the XIDs of all running
+	 * transactions other than lazy VACUUMs, for use as the xmin of CSN-based
+	 * snapshots.  Maintained when transactions end; InvalidTransactionId
+	 * until the first one does after startup, and for as long as a
+	 * transaction older than csnHorizonXid is still running.
+	 */
+	TransactionId oldestActiveXid;
+
+	/*
+	 * Oldest XID whose completion is recorded in pg_csn, i.e. nextXid as of
+	 * StartupCSNLog().  Transactions that were prepared before the restart
+	 * have no entries, so CSN-based snapshots can't be used while they run.
+	 */
+	TransactionId csnHorizonXid;
+
 	/*
 	 * These fields are protected by XactTruncationLock
 	 */
@@ -142,6 +142,12 @@ typedef struct CompactAttribute
  * including this allows various tuple deforming routines to forego any checks
  * for !attbyval.
  *
+ * firstNonUniformAttr stores the index into the compact_attrs array for the
+ * first attribute after a leading run of byval attributes which all have the
+ * same attlen, 4 or 8, and are stored back to back without any alignment
+ * padding.  Tuple deforming can extract such a run in bulk.  This is 0 when
+ * the TupleDesc doesn't start with at least 2 such attributes.
+ *
  * Once a TupleDesc has been populated, before it is used for any purpose,
  * TupleDescFinalize() must be called on it.
  */
@@ -156,6 +162,9 @@ typedef struct TupleDescData
 	int			firstNonGuaranteedAttr; /* index of the first nullable,
 										 * missing, dropped, or !attbyval
 										 * compact_attrs element. */
+	int			firstNonUniformAttr;	/* index of first compact_attrs
+										 * element after the leading run of
+										 * equal width byval attributes */
 	TupleConstr *constr;		/* constraints, or NULL if none */
 	/* compact_attrs[N] is the compact metadata of Attribute Number N+1 */
 	CompactAttribute compact_attrs[FLEXIBLE_ARRAY_MEMBER];
@@ -17,6 +17,7 @@
 #include "catalog/pg_type_d.h"	/* for TYPALIGN macros */
 #include "port/pg_bitutils.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "varatt.h"
 
 /*
@@ -43,6 +44,57 @@ static inline void
 populate_isnull_array(const uint8 *bits, int natts, bool *isnull)
 {
 	int			nbytes = (natts + 7) >> 3;
+	int			i = 0;
+
+#ifndef USE_NO_SIMD
+
+	/*
+	 * With SIMD available, expand 4 bitmap bytes into 32 booleans at a time.
+	 * We replicate each bitmap byte into 8 consecutive lanes by repeatedly
+	 * interleaving the vector with itself, then test a different bit in each
+	 * lane.  Lanes whose bit is 0 are NULL.
+	 */
+	if (nbytes >= 4)
+	{
+		static const uint8 bitsel[sizeof(Vector8)] = {
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+		};
+		Vector8		sel;
+		Vector8		zero = vector8_broadcast(0);
+		Vector8		one = vector8_broadcast(1);
+
+		StaticAssertDecl(sizeof(Vector8) == 16,
+						 "populate_isnull_array assumes 16-byte vectors");
+
+		vector8_load(&sel, bitsel);
+
+		for (; i + 4 <= nbytes; i += 4, isnull += 32)
+		{
+			uint8		chunk[sizeof(Vector8)] = {0};
+			Vector8		v;
+			Vector8		lo;
+			Vector8		hi;
+
+			memcpy(chunk, &bits[i], 4);
+			vector8_load(&v, chunk);
+
+			/* b0 b1 b2 b3 -> b0 x 4, b1 x 4, b2 x 4, b3 x 4 */
+			v = vector8_interleave_low(v, v);
+			v = vector8_interleave_low(v, v);
+
+			/* -> b0 x 8, b1 x 8 and b2 x 8, b3 x 8 */
+			lo = vector8_interleave_low(v, v);
+			hi = vector8_interleave_high(v, v);
+
+			lo = vector8_and(vector8_eq(vector8_and(lo, sel), zero), one);
+			hi = vector8_and(vector8_eq(vector8_and(hi, sel), zero), one);
+
+			vector8_store((uint8 *) isnull, lo);
+			vector8_store((uint8 *) isnull + sizeof(Vector8), hi);
+		}
+	}
+#endif							/* ! USE_NO_SIMD */
 
 	/*
 	 * Multiplying the inverted NULL bitmap byte by this value results in the
@@ -57,7 +109,8 @@ populate_isnull_array(const uint8 *bits, int natts, bool *isnull)
 	 */
 #define SPREAD_BITS_MULTIPLIER_32 0x204081U
 
-	for (int i = 0; i < nbytes; i++, isnull += 8)
+	/* Process any remaining bytes 8 elements at a time */
+	for (; i < nbytes; i++, isnull += 8)
 	{
 		uint64		isnull_8;
 		uint8		nullbyte = ~bits[i];
@@ -261,8 +314,30 @@ first_null_attr(const uint8 *bits, int natts)
 	}
 #endif
 
+	bytenum = 0;
+
+#ifndef USE_NO_SIMD
+
+	/*
+	 * Skip over leading runs of non-NULL attributes a vector at a time.  We
+	 * must not look at bytes beyond nattByte, as these may be past the end of
+	 * the bitmap.
+	 */
+	for (; bytenum + (int) sizeof(Vector8) <= nattByte;
+		 bytenum += sizeof(Vector8))
+	{
+		Vector8		chunk;
+
+		vector8_load(&chunk, &bits[bytenum]);
+
+		/* break if there's any byte that isn't 0xFF */
+		if (vector8_has_le(chunk, 0xFE))
+			break;
+	}
+#endif							/* ! USE_NO_SIMD */
+
 	/* Process all bytes up to just before the byte for the natts attribute */
-	for (bytenum = 0; bytenum < nattByte; bytenum++)
+	for (; bytenum < nattByte; bytenum++)
 	{
 		/* break if there's any NULL attrs (a 0 bit) */
 		if (bits[bytenum] != 0xFF)
@@ -57,6 +57,6 @@
  */
 
 /*							yyyymmddN */
-#define CATALOG_VERSION_NO	202606091
+#define CATALOG_VERSION_NO	202610181
 
 #endif
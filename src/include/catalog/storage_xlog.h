@@ -29,6 +29,7 @@
 /* XLOG gives us high 4 bits */
 #define XLOG_SMGR_CREATE	0x10
 #define XLOG_SMGR_TRUNCATE	0x20
+#define XLOG_SMGR_COMPRESS	0x30
 
 typedef struct xl_smgr_create
 {
@@ -50,7 +51,16 @@ typedef struct xl_smgr_truncate
 	int			flags;
 } xl_smgr_truncate;
 
+typedef struct xl_smgr_compress
+{
+	RelFileLocator rlocator;
+	ForkNumber	forkNum;
+	int			method;			/* PageCompressionMethod */
+} xl_smgr_compress;
+
 extern void log_smgrcreate(const RelFileLocator *rlocator, ForkNumber forkNum);
+extern void log_smgrcompress(const RelFileLocator *rlocator, ForkNumber forkNum,
+							 int method);
 
 extern void smgr_redo(XLogReaderState *record);
 extern void smgr_desc(StringInfo buf, XLogReaderState *record);
@@ -58,5 +58,7 @@ extern TupleDesc FetchPreparedStatementResultDesc(PreparedStatement *stmt);
 extern List *FetchPreparedStatementTargetList(PreparedStatement *stmt);
 
 extern void DropAllPreparedStatements(void);
+extern void *SavePreparedStatements(void);
+extern void RestorePreparedStatements(void *saved);
 
 #endif							/* PREPARE_H */
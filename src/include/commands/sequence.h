@@ -49,5 +49,7 @@ extern void DeleteSequenceTuple(Oid relid);
 extern void ResetSequence(Oid seq_relid);
 extern void SetSequence(Oid relid, int64 next, bool iscalled);
 extern void ResetSequenceCaches(void);
+extern void *SaveSequenceState(void);
+extern void RestoreSequenceState(void *saved);
 
 #endif							/* SEQUENCE_H */
@@ -187,6 +187,7 @@ typedef struct VacAttrStats
 #define VACOPT_DISABLE_PAGE_SKIPPING 0x100	/* don't skip any pages */
 #define VACOPT_SKIP_DATABASE_STATS 0x200	/* skip vac_update_datfrozenxid() */
 #define VACOPT_ONLY_DATABASE_STATS 0x400	/* only vac_update_datfrozenxid() */
+#define VACOPT_PARALLEL_HEAP 0x800	/* process the heap in parallel too */
 
 /*
  * Values used by index_cleanup and truncate params.
@@ -313,12 +314,14 @@ typedef struct PVWorkerStats
 
 /*
  * PVWorkerUsage stores information about total number of launched and
- * planned workers during parallel vacuum (both for index vacuum and cleanup).
+ * planned workers during parallel vacuum (for index vacuum and cleanup, and
+ * for processing the table itself).
  */
 typedef struct PVWorkerUsage
 {
 	PVWorkerStats vacuum;
 	PVWorkerStats cleanup;
+	PVWorkerStats table;
 } PVWorkerUsage;
 
 /* GUC parameters */
@@ -407,6 +410,7 @@ extern void VacuumUpdateCosts(void);
 /* in commands/vacuumparallel.c */
 extern ParallelVacuumState *parallel_vacuum_init(Relation rel, Relation *indrels,
 												 int nindexes, int nrequested_workers,
+												 bool parallel_table,
 												 int vac_work_mem, int elevel,
 												 BufferAccessStrategy bstrategy);
 extern void parallel_vacuum_end(ParallelVacuumState *pvs, IndexBulkDeleteResult **istats);
@@ -422,6 +426,11 @@ extern void parallel_vacuum_cleanup_all_indexes(ParallelVacuumState *pvs,
 												int num_index_scans,
 												bool estimated_count,
 												PVWorkerStats *wstats);
+extern void *parallel_vacuum_get_table_state(ParallelVacuumState *pvs,
+											 int *nworkers_p);
+extern int	parallel_vacuum_table_begin(ParallelVacuumState *pvs,
+										PVWorkerStats *wstats);
+extern void parallel_vacuum_table_end(ParallelVacuumState *pvs);
 extern void parallel_vacuum_update_shared_delay_params(void);
 extern void parallel_vacuum_propagate_shared_delay_params(void);
 extern void parallel_vacuum_main(dsm_segment *seg, shm_toc *toc);
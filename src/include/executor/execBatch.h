@@ -0,0 +1,67 @@
+/*-------------------------------------------------------------------------
+ * execBatch.h
+ *		Support for batch-at-a-time execution
+ *
+ * A batch holds up to EXEC_BATCH_SIZE input rows, deformed into one array
+ * of values and one array of null flags per needed column.  A selection
+ * vector lists the rows of the batch that survived qual evaluation.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/include/executor/execBatch.h
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef EXECBATCH_H
+#define EXECBATCH_H
+
+#include "access/attnum.h"
+#include "nodes/bitmapset.h"
+#include "nodes/pg_list.h"
+
+/* Number of rows processed at a time in batch mode */
+#define EXEC_BATCH_SIZE		1024
+
+typedef struct ExecBatch
+{
+	int			ncols;			/* number of deformed columns */
+	AttrNumber	maxattnum;		/* highest attribute number deformed */
+	AttrNumber *attnums;		/* attribute number of each column */
+	int		   *colmap;			/* column index by attnum, or -1 */
+
+	Datum	  **values;			/* values[col][row] */
+	bool	  **isnull;			/* isnull[col][row] */
+
+	int			nrows;			/* number of rows in the batch */
+	int			nselected;		/* number of entries in sel */
+	int		   *sel;			/* rows that passed the qual, in order */
+} ExecBatch;
+
+/* opaque, private to execBatch.c */
+typedef struct ExecBatchQual ExecBatchQual;
+
+/* GUC */
+extern PGDLLIMPORT bool enable_batch_execution;
+
+extern ExecBatch *ExecBatchCreate(Bitmapset *attnums);
+extern void ExecBatchSelectAll(ExecBatch *batch);
+extern ExecBatchQual *ExecInitBatchQual(List *qual, Index varno,
+										Bitmapset **attnums);
+extern void ExecBatchQualFilter(ExecBatchQual *bqual, ExecBatch *batch);
+
+/*
+ * Return the batch column holding attribute attnum, which must have been
+ * included when the batch was created.
+ */
+static inline int
+ExecBatchGetColumn(ExecBatch *batch, AttrNumber attnum)
+{
+	Assert(attnum > 0 && attnum <= batch->maxattnum);
+	Assert(batch->colmap[attnum] >= 0);
+
+	return batch->colmap[attnum];
+}
+
+#endif							/* EXECBATCH_H */
@@ -49,7 +49,7 @@ typedef struct SharedAggInfo
 
 
 /* ---------------------
- *	Instrumentation information about read streams and I/O
+ *	Instrumentation information about read and write streams and I/O
  * ---------------------
  */
 typedef struct IOStats
@@ -66,13 +66,22 @@ typedef struct IOStats
 	/* maximum possible look-ahead distance (max_pinned_buffers) */
 	int16		distance_capacity;
 
-	/* number of waits for a read (for the I/O) */
+	/* number of waits for a read or write (for the I/O) */
 	uint64		wait_count;
 
 	/* I/O stats */
 	uint64		io_count;		/* number of I/Os */
 	uint64		io_nblocks;		/* sum of blocks for all I/Os */
 	uint64		io_in_progress; /* sum of in-progress I/Os */
+
+	/* number of pages handed to a write stream (for averaging queue depth) */
+	uint64		write_count;
+
+	/* sum of pages not yet written, sampled at each page handed over */
+	uint64		write_queued_sum;
+
+	/* maximum number of pages not yet written */
+	int32		write_queued_max;
 } IOStats;
 
 typedef struct TableScanInstrumentation
@@ -94,6 +103,10 @@ AccumulateIOStats(IOStats *dst, IOStats *src)
 	dst->io_count += src->io_count;
 	dst->io_nblocks += src->io_nblocks;
 	dst->io_in_progress += src->io_in_progress;
+	dst->write_count += src->write_count;
+	dst->write_queued_sum += src->write_queued_sum;
+	if (src->write_queued_max > dst->write_queued_max)
+		dst->write_queued_max = src->write_queued_max;
 }
 
 
@@ -18,6 +18,34 @@
 #include "nodes/execnodes.h"
 
 
+/*
+ * How a transition state is advanced in batch mode, see agg_advance_batch().
+ * Most transition functions that can be used in batch mode are implemented
+ * inline; AGG_BATCH_TRANSFN calls the transition function directly for each
+ * input row, which still avoids the expression evaluation overhead.
+ */
+typedef enum AggBatchTrans
+{
+	AGG_BATCH_NONE = 0,			/* not batch-capable */
+	AGG_BATCH_COUNT_STAR,		/* count(*) */
+	AGG_BATCH_COUNT,			/* count(any) */
+	AGG_BATCH_SUM_INT2,			/* sum(int2) */
+	AGG_BATCH_SUM_INT4,			/* sum(int4) */
+	AGG_BATCH_SUM_FLOAT4,		/* sum(float4) */
+	AGG_BATCH_SUM_FLOAT8,		/* sum(float8) */
+	AGG_BATCH_MIN_INT2,			/* min(int2) */
+	AGG_BATCH_MIN_INT4,			/* min(int4) */
+	AGG_BATCH_MIN_INT8,			/* min(int8) */
+	AGG_BATCH_MIN_FLOAT4,		/* min(float4) */
+	AGG_BATCH_MIN_FLOAT8,		/* min(float8) */
+	AGG_BATCH_MAX_INT2,			/* max(int2) */
+	AGG_BATCH_MAX_INT4,			/* max(int4) */
+	AGG_BATCH_MAX_INT8,			/* max(int8) */
+	AGG_BATCH_MAX_FLOAT4,		/* max(float4) */
+	AGG_BATCH_MAX_FLOAT8,		/* max(float8) */
+	AGG_BATCH_TRANSFN,			/* avg(), stddev() etc. on int2/int4/float */
+} AggBatchTrans;
+
 /*
  * AggStatePerTransData - per aggregate state value information
  *
@@ -173,6 +201,13 @@ typedef struct AggStatePerTransData
 	FunctionCallInfo serialfn_fcinfo;
 
 	FunctionCallInfo deserialfn_fcinfo;
+
+	/*
+	 * Batch mode support: how the transition state is advanced, and the
+	 * batch column holding the aggregated input (-1 if none).
+	 */
+	AggBatchTrans batchtrans;
+	int			batchcol;
 } AggStatePerTransData;
 
 /*
@@ -337,5 +372,11 @@ extern void ExecAggEstimate(AggState *node, ParallelContext *pcxt);
 extern void ExecAggInitializeDSM(AggState *node, ParallelContext *pcxt);
 extern void ExecAggInitializeWorker(AggState *node, ParallelWorkerContext *pwcxt);
 extern void ExecAggRetrieveInstrumentation(AggState *node);
+extern void ExecAggParallelEstimate(AggState *node, ParallelContext *pcxt);
+extern void ExecAggParallelInitializeDSM(AggState *node, ParallelContext *pcxt);
+extern void ExecAggParallelReInitializeDSM(AggState *node,
+										   ParallelContext *pcxt);
+extern void ExecAggParallelInitializeWorker(AggState *node,
+											ParallelWorkerContext *pwcxt);
 
 #endif							/* NODEAGG_H */
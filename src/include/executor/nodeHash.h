@@ -72,5 +72,7 @@ extern void ExecHashRetrieveInstrumentation(HashState *node);
 extern void ExecShutdownHash(HashState *node);
 extern void ExecHashAccumInstrumentation(HashInstrumentation *instrument,
 										 HashJoinTable hashtable);
+extern List *ExecInitHashBloomFilters(List *filters, PlanState *parent);
+extern bool ExecHashBloomFiltersPass(List *filters, ExprContext *econtext);
 
 #endif							/* NODEHASH_H */
@@ -22,6 +22,7 @@ extern void ExecEndSort(SortState *node);
 extern void ExecSortMarkPos(SortState *node);
 extern void ExecSortRestrPos(SortState *node);
 extern void ExecReScanSort(SortState *node);
+extern void ExecShutdownSort(SortState *node);
 
 /* parallel instrumentation support */
 extern void ExecSortEstimate(SortState *node, ParallelContext *pcxt);
@@ -29,4 +30,16 @@ extern void ExecSortInitializeDSM(SortState *node, ParallelContext *pcxt);
 extern void ExecSortInitializeWorker(SortState *node, ParallelWorkerContext *pwcxt);
 extern void ExecSortRetrieveInstrumentation(SortState *node);
 
+/* parallel sort support */
+extern void ExecSortParallelEstimate(SortState *node, ParallelContext *pcxt);
+extern void ExecSortParallelInitializeDSM(SortState *node,
+										  ParallelContext *pcxt);
+extern void ExecSortParallelReInitializeDSM(SortState *node,
+											ParallelContext *pcxt);
+extern void ExecSortParallelInitializeWorker(SortState *node,
+											 ParallelWorkerContext *pwcxt);
+extern int	ExecSortNumRanges(SortState *node);
+extern int	ExecSortRangeOwner(SortState *node, int range);
+extern int64 ExecSortRangeTuples(SortState *node, int range);
+
 #endif							/* NODESORT_H */
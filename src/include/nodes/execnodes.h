@@ -1663,6 +1663,19 @@ typedef struct ScanState
 	TupleTableSlot *ss_ScanTupleSlot;
 } ScanState;
 
+/* ----------------
+ *	 HashBloomFilterState information
+ *
+ *		Run-time state of a HashBloomFilter applied by a scan.  The filter
+ *		itself is the value of the PARAM_EXEC param, set by the Hash node.
+ * ----------------
+ */
+typedef struct HashBloomFilterState
+{
+	int			paramid;		/* ID of PARAM_EXEC param holding the filter */
+	ExprState  *hash_expr;		/* ExprState to get hash value of scan tuple */
+} HashBloomFilterState;
+
 /* ----------------
  *	 SeqScanState information
  * ----------------
@@ -1672,6 +1685,9 @@ typedef struct SeqScanState
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
 	struct SharedSeqScanInstrumentation *sinstrument;
+	struct ExecBatch *batch;	/* batch of deformed tuples, in batch mode */
+	struct ExecBatchQual *batchqual;	/* qual compiled for batches, or NULL */
+	List	   *bloomfilters;	/* list of HashBloomFilterState */
 } SeqScanState;
 
 /* ----------------
@@ -2154,6 +2170,21 @@ typedef struct JoinState
  *		NeedNewOuter	   true if need new outer tuple on next call
  *		MatchedOuter	   true if found a join match for current outer tuple
  *		NullInnerTupleSlot prepared null tuple for left outer joins
+ *
+ *	 The remaining fields are used only by adaptive nestloops:
+ *
+ *		HashPlanState	   the Hash node to switch to
+ *		HashTable		   hash table built by it, or NULL
+ *		OuterHash		   ExprState for hashing the outer tuple
+ *		HashJoinQual	   ExprState for all the join quals
+ *		HashTupleSlot	   slot for inner tuples fetched from the table
+ *		Hashing			   true if probing the hash table
+ *		HashTooBig		   true if the hash table didn't fit in memory
+ *		CurHashValue	   hash value of the current outer tuple
+ *		CurBucketNo		   its bucket, or -1 if it has a null key
+ *		CurTuple		   last hash table tuple returned, or NULL
+ *		OuterRows		   outer rows fetched in this scan
+ *		SwitchedAt		   outer row count at which we first switched
  * ----------------
  */
 typedef struct NestLoopState
@@ -2162,6 +2193,18 @@ typedef struct NestLoopState
 	bool		nl_NeedNewOuter;
 	bool		nl_MatchedOuter;
 	TupleTableSlot *nl_NullInnerTupleSlot;
+	PlanState  *nl_HashPlanState;
+	struct HashJoinTableData *nl_HashTable;
+	ExprState  *nl_OuterHash;
+	ExprState  *nl_HashJoinQual;
+	TupleTableSlot *nl_HashTupleSlot;
+	bool		nl_Hashing;
+	bool		nl_HashTooBig;
+	uint32		nl_CurHashValue;
+	int			nl_CurBucketNo;
+	struct HashJoinTupleData *nl_CurTuple;
+	double		nl_OuterRows;
+	double		nl_SwitchedAt;
 } NestLoopState;
 
 /* ----------------
@@ -2365,6 +2408,10 @@ typedef struct SortState
 	bool		am_worker;		/* are we a worker? */
 	bool		datumSort;		/* Datum sort instead of tuple sort? */
 	SharedSortInfo *shared_info;	/* one entry per worker */
+	struct ParallelSortState *parallel_state;	/* shared state, or NULL */
+	TuplesortInstrumentation *sinstrument;	/* stats saved at shutdown */
+	int			range;			/* key range being merged, or -1 */
+	int64		range_tuples;	/* tuples returned from it so far */
 } SortState;
 
 typedef enum
@@ -2503,6 +2550,12 @@ typedef struct AggState
 	AggStatePerGroup *all_pergroups;	/* array of first ->pergroups, than
 										 * ->hash_pergroup */
 	SharedAggInfo *shared_info; /* one entry per worker */
+	SeqScanState *batch_input;	/* outer SeqScan supplying batches, if in
+								 * batch mode */
+	/* these fields are used in a Parallel HashAgg: */
+	struct ParallelAggState *parallel_state;	/* shared state, or NULL */
+	struct SharedTuplestoreAccessor **parallel_batches; /* accessor for each
+														 * shared batch */
 } AggState;
 
 /* ----------------
@@ -2683,6 +2736,13 @@ typedef struct GatherMergeState
 	struct TupleQueueReader **reader;	/* array with nreaders active entries */
 	struct GMReaderTupleBuffer *gm_tuple_buffers;	/* nreaders tuple buffers */
 	struct binaryheap *gm_heap; /* binary heap of slot indices */
+	/* key ranges of a Parallel Sort, see gather_merge_concat_next(): */
+	int			gm_nranges;		/* number of key ranges, or 0 */
+	int			gm_range;		/* key range being returned */
+	int			gm_range_owner; /* slot index of its owner, or -1 */
+	int64		gm_range_tuples;	/* its number of tuples, or -1 */
+	int64		gm_range_returned;	/* tuples returned from it so far */
+	int			gm_returned;	/* slot index returned last, or -1 */
 } GatherMergeState;
 
 /* ----------------
@@ -2718,6 +2778,9 @@ typedef struct HashState
 
 	/* Parallel hash state. */
 	struct ParallelHashJoinState *parallel_state;
+
+	/* Bloom filter passed to the outer side of the join, or NULL */
+	bytea	   *bloom_value;
 } HashState;
 
 /* ----------------
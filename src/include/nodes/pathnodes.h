@@ -2536,6 +2536,7 @@ typedef struct SortPath
 {
 	Path		path;
 	Path	   *subpath;		/* path representing input source */
+	int			numRanges;		/* key ranges of a Parallel Sort, or 0 */
 } SortPath;
 
 /*
@@ -551,6 +551,8 @@ typedef struct Scan
 typedef struct SeqScan
 {
 	Scan		scan;
+	/* list of HashBloomFilters to apply to scanned tuples */
+	List	   *bloomFilters;
 } SeqScan;
 
 /* ----------------
@@ -1001,6 +1003,15 @@ typedef struct Join
  * Vars, but perhaps someday that'd be worth relaxing.  (Note: during plan
  * creation, the paramval can actually be a PlaceHolderVar expression; but it
  * must be a Var with varno OUTER_VAR by the time it gets to the executor.)
+ *
+ * If hash_plan isn't NULL, the join is adaptive: once more than
+ * adaptive_rows outer rows have been fetched, the executor builds a hash
+ * table from hash_plan (a Hash node over an unparameterized scan of the
+ * inner relation, producing the same tlist as the righttree) and probes it
+ * with hash_outerkeys instead of rescanning the inner subplan.  Since the
+ * inner subplan may enforce some of the join clauses itself, hash_joinqual
+ * holds all of them, to be checked against each candidate from the hash
+ * table in place of joinqual.
  * ----------------
  */
 typedef struct NestLoop
@@ -1008,6 +1019,17 @@ typedef struct NestLoop
 	Join		join;
 	/* list of NestLoopParam nodes */
 	List	   *nestParams;
+	/* Hash node to switch to, or NULL if not adaptive */
+	Plan	   *hash_plan;
+	/* outer expressions to probe the hash table with */
+	List	   *hash_outerkeys;
+	/* per-key hash operators and collations */
+	List	   *hash_operators;
+	List	   *hash_collations;
+	/* join quals to check after a hash table match */
+	List	   *hash_joinqual;
+	/* switch to hashing after this many outer rows */
+	Cardinality adaptive_rows;
 } NestLoop;
 
 typedef struct NestLoopParam
@@ -1158,6 +1180,9 @@ typedef struct Sort
 
 	/* NULLS FIRST/LAST directions */
 	bool	   *nullsFirst pg_node_attr(array_size(numCols));
+
+	/* number of key ranges merged separately in a Parallel Sort, or 0 */
+	int			numRanges;
 } Sort;
 
 /* ----------------
@@ -1437,6 +1462,8 @@ typedef struct Hash
 	/* all other info is in the parent HashJoin node */
 	/* estimate total rows if parallel_aware */
 	Cardinality rows_total;
+	/* PARAM_EXEC param to pass a Bloom filter of the hash keys in, or -1 */
+	int			bloomParam;
 } Hash;
 
 /* ----------------
@@ -1626,6 +1653,34 @@ typedef struct PlanRowMark
 } PlanRowMark;
 
 
+/*
+ * HashBloomFilter -
+ *	   a Bloom filter built by a Hash node, applied by a scan below the
+ *	   outer side of the hash join
+ *
+ * The Hash node stores the filter in PARAM_EXEC param paramid once it has
+ * built its hash table; the scan then skips tuples whose hashed keys are
+ * certainly not in the hash table.  hashkeys are the outer hash keys of the
+ * join, translated to reference the scanned relation, and hashoperators and
+ * hashcollations are the corresponding entries of the join's hash clauses.
+ * While the param is null, the scan returns all tuples.
+ */
+typedef struct HashBloomFilter
+{
+	pg_node_attr(no_equal, no_query_jumble)
+
+	NodeTag		type;
+	/* ID of PARAM_EXEC param holding the filter */
+	int			paramid;
+	/* expressions to hash for each scanned tuple */
+	List	   *hashkeys;
+	/* operators of the join's hash clauses */
+	List	   *hashoperators;
+	/* collations of the join's hash clauses */
+	List	   *hashcollations;
+} HashBloomFilter;
+
+
 /*
  * Node types to represent partition pruning information.
  */
@@ -242,6 +242,11 @@ extern SortPath *create_sort_path(PlannerInfo *root,
 								  Path *subpath,
 								  List *pathkeys,
 								  double limit_tuples);
+extern SortPath *create_parallel_sort_path(PlannerInfo *root,
+										   RelOptInfo *rel,
+										   Path *subpath,
+										   List *pathkeys,
+										   int numRanges);
 extern IncrementalSortPath *create_incremental_sort_path(PlannerInfo *root,
 														 RelOptInfo *rel,
 														 Path *subpath,
@@ -269,6 +274,14 @@ extern AggPath *create_agg_path(PlannerInfo *root,
 								List *qual,
 								const AggClauseCosts *aggcosts,
 								double numGroups);
+extern AggPath *create_parallel_hashagg_path(PlannerInfo *root,
+											 RelOptInfo *rel,
+											 Path *subpath,
+											 PathTarget *target,
+											 List *groupClause,
+											 List *qual,
+											 const AggClauseCosts *aggcosts,
+											 double numGroups);
 extern GroupingSetsPath *create_groupingsets_path(PlannerInfo *root,
 												  RelOptInfo *rel,
 												  Path *subpath,
@@ -218,7 +218,7 @@ typedef struct PgStat_TableXactStatus
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BCBC
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BCBD
 
 typedef struct PgStat_ArchiverStats
 {
@@ -311,6 +311,7 @@ typedef enum IOOp
 	IOOP_EVICT,
 	IOOP_FSYNC,
 	IOOP_HIT,
+	IOOP_REMOTE_HIT,
 	IOOP_REUSE,
 	IOOP_WRITEBACK,
 
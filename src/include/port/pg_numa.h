@@ -17,6 +17,9 @@
 extern PGDLLIMPORT int pg_numa_init(void);
 extern PGDLLIMPORT int pg_numa_query_pages(int pid, unsigned long count, void **pages, int *status);
 extern PGDLLIMPORT int pg_numa_get_max_node(void);
+extern PGDLLIMPORT int pg_numa_get_current_node(void);
+extern PGDLLIMPORT void pg_numa_interleave_memory(void *ptr, Size size);
+extern PGDLLIMPORT void pg_numa_bind_memory(void *ptr, Size size, int node);
 
 #ifdef USE_LIBNUMA
 
@@ -409,14 +409,43 @@ typedef struct WritebackContext
 	PendingWriteback pending_writebacks[WRITEBACK_MAX_PENDING_FLUSHES];
 } WritebackContext;
 
+/*
+ * Placement of the buffer blocks on NUMA nodes, with shared_memory_numa =
+ * partition.  The blocks are split in one contiguous range per node, node n
+ * holding the buffers from firstBuffer[n] up to the first buffer of node
+ * n + 1.  numaNodes is 0 if shared buffers are not partitioned.
+ */
+typedef struct BufferNumaPlacement
+{
+	int			numaNodes;
+	int			firstBuffer[FLEXIBLE_ARRAY_MEMBER];
+} BufferNumaPlacement;
+
 /* in buf_init.c */
 extern PGDLLIMPORT BufferDescPadded *BufferDescriptors;
 extern PGDLLIMPORT ConditionVariableMinimallyPadded *BufferIOCVArray;
 extern PGDLLIMPORT WritebackContext BackendWritebackContext;
+extern PGDLLIMPORT BufferNumaPlacement *BufferPlacement;
 
 /* in localbuf.c */
 extern PGDLLIMPORT BufferDesc *LocalBufferDescriptors;
 
+/*
+ * Return the NUMA node the block of a shared buffer is placed on, or -1 if
+ * shared buffers are not partitioned over NUMA nodes.
+ */
+static inline int
+BufferGetNumaNode(int buf_id)
+{
+	int			node = BufferPlacement->numaNodes - 1;
+
+	/* nodes are few, and node 0 starts at the first buffer */
+	while (node > 0 && buf_id < BufferPlacement->firstBuffer[node])
+		node--;
+
+	return node;
+}
+
 
 static inline BufferDesc *
 GetBufferDescriptor(uint32 id)
@@ -584,7 +613,13 @@ extern BufferDesc *StrategyGetBuffer(BufferAccessStrategy strategy,
 extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 								 BufferDesc *buf, bool from_ring);
 
-extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
+extern int	StrategySyncStart(int partition, uint32 *complete_passes,
+							  uint32 *num_buf_alloc);
+extern int	StrategyNumPartitions(void);
+extern void StrategyGetPartitionInfo(int partition, int *first_buffer,
+									 int *num_buffers, int *numa_node,
+									 uint32 *complete_passes,
+									 uint64 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
 
 /* buf_table.c */
@@ -89,6 +89,9 @@ PG_LWLOCK(54, WaitLSN)
 PG_LWLOCK(55, LogicalDecodingControl)
 PG_LWLOCK(56, DataChecksumsWorker)
 PG_LWLOCK(57, AioWorkerControl)
+PG_LWLOCK(58, SharedCatCache)
+PG_LWLOCK(59, SharedPlanCache)
+PG_LWLOCK(60, SessionPool)
 
 /*
  * There also exist several built-in LWLock tranches.  As with the predefined
@@ -140,3 +143,10 @@ PG_LWLOCKTRANCHE(XACT_SLRU, XactSLRU)
 PG_LWLOCKTRANCHE(PARALLEL_VACUUM_DSA, ParallelVacuumDSA)
 PG_LWLOCKTRANCHE(AIO_URING_COMPLETION, AioUringCompletion)
 PG_LWLOCKTRANCHE(SHMEM_INDEX, ShmemIndex)
+PG_LWLOCKTRANCHE(SHARED_CATCACHE_DSA, SharedCatCacheDSA)
+PG_LWLOCKTRANCHE(SHARED_CATCACHE_HASH, SharedCatCacheHash)
+PG_LWLOCKTRANCHE(SHARED_PLAN_CACHE_DSA, SharedPlanCacheDSA)
+PG_LWLOCKTRANCHE(SHARED_PLAN_CACHE_HASH, SharedPlanCacheHash)
+PG_LWLOCKTRANCHE(CSNLOG_BUFFER, CSNLogBuffer)
+PG_LWLOCKTRANCHE(CSNLOG_SLRU, CSNLogSLRU)
+PG_LWLOCKTRANCHE(PAGE_COMPRESS, PageCompress)
@@ -0,0 +1,121 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.h
+ *	  On-disk format and compression routines for compressed relation forks.
+ *
+ * A relation whose page_compression storage parameter is set gets its main
+ * fork stored compressed by md.c.  Such a fork consists of two files: a data
+ * file, named like the first segment of an uncompressed fork, which holds
+ * the compressed pages, and an address map, with PAGE_COMPRESS_MAP_SUFFIX
+ * appended to that name, which records where each page is stored.  The data
+ * file of a compressed fork is never split in segments.
+ *
+ * The data file is divided in chunks of PC_CHUNK_SIZE bytes.  Each page is
+ * stored in a run of consecutive chunks: compressed if that saves at least
+ * one chunk, as is otherwise.  The map starts with a PageCompressHeader,
+ * followed by one PageCompressAddr per block.  An address of zero means
+ * that no storage was allocated to the block yet, which reads as a page of
+ * zeroes.
+ *
+ * This header is included by frontend programs that need to recognize
+ * compressed forks, so it must not depend on backend-only definitions.
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/pagecompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PAGECOMPRESS_H
+#define PAGECOMPRESS_H
+
+#include "common/relpath.h"
+#include "storage/block.h"
+#include "storage/relfilelocator.h"
+
+/*
+ * Page compression methods.  These are stored in the address map and in WAL,
+ * so the values cannot be changed.
+ */
+typedef enum PageCompressionMethod
+{
+	PAGE_COMPRESSION_NONE = 0,
+	PAGE_COMPRESSION_PGLZ = 1,
+	PAGE_COMPRESSION_LZ4 = 2,
+	PAGE_COMPRESSION_ZSTD = 3,
+} PageCompressionMethod;
+
+#define PAGE_COMPRESS_MAP_SUFFIX	".pcmap"
+
+#define PAGE_COMPRESS_MAGIC			0x50434D50	/* "PCMP" */
+#define PAGE_COMPRESS_VERSION		1
+
+/* Each page is stored in at most PC_CHUNKS_PER_BLOCK chunks */
+#define PC_CHUNKS_PER_BLOCK			8
+#define PC_CHUNK_SIZE				(BLCKSZ / PC_CHUNKS_PER_BLOCK)
+
+/* Compressed pages must fit in one chunk less than an uncompressed one */
+#define PC_MAX_COMPRESSED_SIZE		(BLCKSZ - PC_CHUNK_SIZE)
+
+/*
+ * Header of an address map.  Its size is fixed at PC_MAP_HEADER_SIZE bytes,
+ * leaving room for future fields.
+ */
+typedef struct PageCompressHeader
+{
+	uint32		magic;			/* PAGE_COMPRESS_MAGIC */
+	uint16		version;		/* PAGE_COMPRESS_VERSION */
+	uint16		method;			/* PageCompressionMethod */
+	uint32		chunk_size;		/* PC_CHUNK_SIZE of the server */
+	BlockNumber nblocks;		/* number of blocks of the fork */
+} PageCompressHeader;
+
+#define PC_MAP_HEADER_SIZE			64
+
+StaticAssertDecl(sizeof(PageCompressHeader) <= PC_MAP_HEADER_SIZE,
+				 "PageCompressHeader does not fit in the map header");
+
+/* Offset in the address map of the address of a block */
+#define PC_MAP_OFFSET(blkno) \
+	((pgoff_t) PC_MAP_HEADER_SIZE + (pgoff_t) (blkno) * sizeof(PageCompressAddr))
+
+/*
+ * Address of a page in the data file.  From the most to the least
+ * significant bits, it holds the first chunk of the run allocated to the
+ * page (40 bits), the number of chunks allocated (4 bits), the number of
+ * chunks in use (4 bits) and the compressed size of the page in bytes (16
+ * bits).  A page that uses PC_CHUNKS_PER_BLOCK chunks is stored
+ * uncompressed, and its size is not meaningful.
+ */
+typedef uint64 PageCompressAddr;
+
+#define PageCompressAddrGetChunk(addr)		((uint64) (addr) >> 24)
+#define PageCompressAddrGetAllocated(addr)	((int) (((addr) >> 20) & 0x0F))
+#define PageCompressAddrGetNChunks(addr)	((int) (((addr) >> 16) & 0x0F))
+#define PageCompressAddrGetSize(addr)		((int) ((addr) & 0xFFFF))
+#define PageCompressAddrIsCompressed(addr) \
+	(PageCompressAddrGetNChunks(addr) < PC_CHUNKS_PER_BLOCK)
+
+#define MakePageCompressAddr(chunk, allocated, nchunks, size) \
+	(((uint64) (chunk) << 24) | \
+	 ((uint64) (allocated) << 20) | \
+	 ((uint64) (nchunks) << 16) | \
+	 (uint64) (size))
+
+#ifndef FRONTEND
+
+struct LWLock;
+
+extern const char *GetPageCompressionName(PageCompressionMethod method);
+extern void CheckPageCompressionSupported(PageCompressionMethod method);
+extern int	page_compress(PageCompressionMethod method, const char *page,
+						  char *dest);
+extern bool page_decompress(PageCompressionMethod method, const char *source,
+							int slen, char *page);
+extern struct LWLock *PageCompressLock(RelFileLocator rlocator,
+									   ForkNumber forknum);
+
+#endif							/* !FRONTEND */
+
+#endif							/* PAGECOMPRESS_H */
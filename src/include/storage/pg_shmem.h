@@ -46,6 +46,7 @@ extern PGDLLIMPORT int shared_memory_type;
 extern PGDLLIMPORT int huge_pages;
 extern PGDLLIMPORT int huge_page_size;
 extern PGDLLIMPORT int huge_pages_status;
+extern PGDLLIMPORT int shared_memory_numa;
 
 /* Possible values for huge_pages and huge_pages_status */
 typedef enum
@@ -64,6 +65,14 @@ typedef enum
 	SHMEM_TYPE_MMAP,
 }			PGShmemType;
 
+/* Possible values for shared_memory_numa */
+typedef enum
+{
+	SHMEM_NUMA_OFF,
+	SHMEM_NUMA_INTERLEAVE,
+	SHMEM_NUMA_PARTITION,
+}			PGShmemNumaType;
+
 #ifndef WIN32
 extern PGDLLIMPORT unsigned long UsedShmemSegID;
 #else
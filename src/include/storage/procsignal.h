@@ -70,6 +70,7 @@ typedef enum
  * prototypes for functions in procsignal.c
  */
 extern void ProcSignalInit(const uint8 *cancel_key, int cancel_key_len);
+extern void ProcSignalSetCancelKey(const uint8 *cancel_key, int cancel_key_len);
 extern int	SendProcSignal(pid_t pid, ProcSignalReason reason,
 						   ProcNumber procNumber);
 extern void SendCancelRequest(int backendPID, const uint8 *cancel_key, int cancel_key_len);
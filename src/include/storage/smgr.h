@@ -17,6 +17,7 @@
 #include "lib/ilist.h"
 #include "storage/aio_types.h"
 #include "storage/block.h"
+#include "storage/pagecompress.h"
 #include "storage/relfilelocator.h"
 
 /*
@@ -61,6 +62,14 @@ typedef struct SMgrRelationData
 	int			md_num_open_segs[MAX_FORKNUM + 1];
 	struct _MdfdVec *md_seg_fds[MAX_FORKNUM + 1];
 
+	/*
+	 * for md.c; if the main fork is compressed, the fd of its address map
+	 * and its compression method, else -1 and PAGE_COMPRESSION_NONE.  Only
+	 * valid while the main fork is open.
+	 */
+	int			md_pcmap_vfd;
+	PageCompressionMethod md_pc_method;
+
 	/*
 	 * Pinning support.  If unpinned (ie. pincount == 0), 'node' is a list
 	 * link in list of all unpinned SMgrRelations.
@@ -108,6 +117,11 @@ extern void smgrwritev(SMgrRelation reln, ForkNumber forknum,
 					   BlockNumber blocknum,
 					   const void **buffers, BlockNumber nblocks,
 					   bool skipFsync);
+extern void smgrstartwritev(PgAioHandle *ioh,
+							SMgrRelation reln, ForkNumber forknum,
+							BlockNumber blocknum,
+							const void **buffers, BlockNumber nblocks,
+							bool skipFsync);
 extern void smgrwriteback(SMgrRelation reln, ForkNumber forknum,
 						  BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber smgrnblocks(SMgrRelation reln, ForkNumber forknum);
@@ -117,6 +131,10 @@ extern void smgrtruncate(SMgrRelation reln, ForkNumber *forknum, int nforks,
 						 BlockNumber *nblocks);
 extern void smgrimmedsync(SMgrRelation reln, ForkNumber forknum);
 extern void smgrregistersync(SMgrRelation reln, ForkNumber forknum);
+extern void smgrsetcompression(SMgrRelation reln, ForkNumber forknum,
+							   PageCompressionMethod method, bool isRedo);
+extern PageCompressionMethod smgrgetcompression(SMgrRelation reln,
+												ForkNumber forknum);
 extern void AtEOXact_SMgr(void);
 extern bool ProcessBarrierSmgrRelease(void);
 
@@ -0,0 +1,48 @@
+/*-------------------------------------------------------------------------
+ *
+ * write_stream.h
+ *	  Mechanism for writing out relation data with combining and AIO
+ *
+ *
+ * Portions Copyright (c) 2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/write_stream.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef WRITE_STREAM_H
+#define WRITE_STREAM_H
+
+#include "storage/smgr.h"
+#include "utils/relcache.h"
+
+/* Default tuning, reasonable for many users. */
+#define WRITE_STREAM_DEFAULT 0x00
+
+/*
+ * I/O streams that are performing maintenance work on behalf of potentially
+ * many users, and thus should be governed by maintenance_io_concurrency
+ * instead of effective_io_concurrency.  For example, CREATE INDEX.
+ */
+#define WRITE_STREAM_MAINTENANCE 0x01
+
+struct WriteStream;
+typedef struct WriteStream WriteStream;
+struct IOStats;
+
+extern WriteStream *write_stream_begin_relation(int flags,
+												Relation rel,
+												ForkNumber forknum);
+extern WriteStream *write_stream_begin_smgr_relation(int flags,
+													 SMgrRelation smgr,
+													 ForkNumber forknum);
+extern PGIOAlignedBlock *write_stream_get_buf(WriteStream *stream);
+extern void write_stream_write(WriteStream *stream, BlockNumber blocknum,
+							   PGIOAlignedBlock *buf);
+extern void write_stream_flush(WriteStream *stream);
+extern void write_stream_end(WriteStream *stream);
+extern void write_stream_enable_stats(WriteStream *stream,
+									  struct IOStats *stats);
+
+#endif							/* WRITE_STREAM_H */
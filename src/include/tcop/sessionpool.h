@@ -0,0 +1,34 @@
+/*-------------------------------------------------------------------------
+ *
+ * sessionpool.h
+ *	  Built-in pooling of client sessions in shared backends.
+ *
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/tcop/sessionpool.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+/* Directory, relative to the data directory, for the hand-off sockets */
+#define PG_SESSIONPOOL_DIR		"pg_sessionpool"
+
+/* GUCs */
+extern PGDLLIMPORT int session_pool_size;
+extern PGDLLIMPORT bool session_pooling;
+
+/* true if this backend serves pooled sessions */
+extern PGDLLIMPORT bool am_pool_backend;
+
+extern bool SessionPoolStart(void);
+extern bool SessionPoolWaitForInput(void);
+extern bool SessionPoolEndSession(void);
+extern void SessionPoolConfigReloaded(void);
+extern int	SessionPoolCountSessions(Oid dboid, Oid roleid);
+extern void PreventInPooledSession(const char *feature);
+
+#endif							/* SESSIONPOOL_H */
@@ -483,6 +483,8 @@ extern void read_nondefault_variables(void);
 /* GUC serialization */
 extern Size EstimateGUCStateSpace(void);
 extern void SerializeGUCState(Size maxsize, char *start_address);
+extern Size EstimateGUCSessionStateSpace(void);
+extern void SerializeGUCSessionState(Size maxsize, char *start_address);
 extern void RestoreGUCState(void *gucstate);
 
 /* Functions exported by guc_funcs.c */
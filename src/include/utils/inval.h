@@ -57,6 +57,8 @@ extern void AtEOSubXact_Inval(bool isCommit);
 
 extern void PostPrepare_Inval(void);
 
+extern bool TransactionHasPendingInvalidations(void);
+
 extern void CommandEndInvalidationMessages(void);
 
 extern void CacheInvalidateHeapTuple(Relation relation,
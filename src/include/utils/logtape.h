@@ -69,6 +69,7 @@ extern size_t LogicalTapeRead(LogicalTape *lt, void *ptr, size_t size);
 extern void LogicalTapeWrite(LogicalTape *lt, const void *ptr, size_t size);
 extern void LogicalTapeRewindForRead(LogicalTape *lt, size_t buffer_size);
 extern void LogicalTapeFreeze(LogicalTape *lt, TapeShare *share);
+extern void LogicalTapeFreezeImported(LogicalTape *lt);
 extern size_t LogicalTapeBackspace(LogicalTape *lt, size_t size);
 extern void LogicalTapeSeek(LogicalTape *lt, int64 blocknum, int offset);
 extern void LogicalTapeTell(LogicalTape *lt, int64 *blocknum, int *offset);
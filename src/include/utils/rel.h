@@ -356,6 +356,7 @@ typedef struct StdRdOptions
 	 * to freeze. 0 if disabled, -1 if unspecified.
 	 */
 	double		vacuum_max_eager_freeze_failure_rate;
+	PageCompressionMethod page_compression; /* compression of new storage */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR			10
@@ -411,6 +412,16 @@ typedef struct StdRdOptions
 	((relation)->rd_options ? \
 	 ((StdRdOptions *) (relation)->rd_options)->parallel_workers : (defaultpw))
 
+/*
+ * RelationGetPageCompression
+ *		Returns the relation's page_compression reloption setting.
+ *		Note multiple eval of argument!
+ */
+#define RelationGetPageCompression(relation) \
+	((relation)->rd_options ? \
+	 ((StdRdOptions *) (relation)->rd_options)->page_compression : \
+	 PAGE_COMPRESSION_NONE)
+
 /* ViewOptions->check_option values */
 typedef enum ViewOptCheckOption
 {
@@ -0,0 +1,32 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedcatcache.h
+ *	  Cross-backend catalog tuple cache in dynamic shared memory.
+ *
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedcatcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDCATCACHE_H
+#define SHAREDCATCACHE_H
+
+#include "access/htup.h"
+#include "storage/sinval.h"
+
+/* GUC variable, in megabytes; zero disables the shared catalog cache */
+extern PGDLLIMPORT int shared_catcache_size;
+
+extern bool SharedCatCacheIsEnabled(void);
+extern uint64 SharedCatCacheGetStamp(Oid dbid, int cacheid, uint32 hashValue);
+extern HeapTuple SharedCatCacheLookup(Oid dbid, int cacheid, uint32 hashValue);
+extern void SharedCatCacheInsert(Oid dbid, int cacheid, uint32 hashValue,
+								 HeapTuple tuple, uint64 stamp);
+extern void SharedCatCacheInvalidate(const SharedInvalidationMessage *msgs,
+									 int n);
+extern void SharedCatCacheInvalidateAll(void);
+
+#endif							/* SHAREDCATCACHE_H */
@@ -0,0 +1,36 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedplancache.h
+ *	  Cross-backend cache of generic plans in dynamic shared memory.
+ *
+ *
+ * Portions Copyright (c) 1996-2026, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/utils/sharedplancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDPLANCACHE_H
+#define SHAREDPLANCACHE_H
+
+#include "nodes/pg_list.h"
+#include "storage/sinval.h"
+
+/* GUC variable, in megabytes; zero disables the shared plan cache */
+extern PGDLLIMPORT int shared_plan_cache_size;
+
+extern bool SharedPlanCacheIsEnabled(void);
+extern uint64 SharedPlanCacheGetStamp(void);
+extern List *SharedPlanCacheLookup(const char *key, int keylen,
+								   uint64 *stamp);
+extern bool SharedPlanCacheIsCurrent(List *relationOids, List *invalItems,
+									 uint64 stamp);
+extern void SharedPlanCacheInsert(const char *key, int keylen,
+								  List *stmt_list, List *relationOids,
+								  List *invalItems, uint64 stamp);
+extern void SharedPlanCacheInvalidate(const SharedInvalidationMessage *msgs,
+									  int n);
+extern void SharedPlanCacheInvalidateAll(void);
+
+#endif							/* SHAREDPLANCACHE_H */
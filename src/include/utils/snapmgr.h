@@ -108,6 +108,7 @@ extern bool ThereAreNoPriorRegisteredSnapshots(void);
 extern bool HaveRegisteredOrActiveSnapshot(void);
 
 extern char *ExportSnapshot(Snapshot snapshot);
+extern Snapshot MaterializeSnapshot(Snapshot snapshot);
 
 /*
  * These live in procarray.c because they're intimately linked to the
@@ -177,6 +177,14 @@ typedef struct SnapshotData
 	int32		subxcnt;		/* # of xact ids in subxip[] */
 	bool		suboverflowed;	/* has the subxip array overflowed? */
 
+	/*
+	 * For CSN-based MVCC snapshots (see csn_snapshots), the commit sequence
+	 * number as of the snapshot: transactions between xmin and xmax are
+	 * visible if they completed with a CSN not above this one, and xip[] and
+	 * subxip[] are empty.  Zero for snapshots built the regular way.
+	 */
+	uint64		csn;
+
 	bool		takenDuringRecovery;	/* recovery-shaped snapshot? */
 	bool		copied;			/* false if it's a static snapshot */
 
@@ -323,6 +323,13 @@ typedef struct
  * Tuplesortstate, since the leader process has nothing else to do before
  * workers finish.
  *
+ * The final output can also be divided between several leader tuplesorts,
+ * each merging a range of the key space, possibly in different processes.
+ * That requires using tuplesort_estimate_shared_ranged() and
+ * tuplesort_initialize_shared_ranged() in steps 1 and 2, so that workers
+ * index their runs, and calling tuplesort_merge_range() instead of
+ * tuplesort_performsort() in step 8.
+ *
  * Note that only a very small amount of memory will be allocated prior to
  * the leader state first consuming input, and that workers will free the
  * vast majority of their memory upon returning from tuplesort_performsort().
@@ -348,6 +355,8 @@ extern void tuplesort_puttuple_common(Tuplesortstate *state,
 									  SortTuple *tuple, bool useAbbrev,
 									  Size tuplen);
 extern void tuplesort_performsort(Tuplesortstate *state);
+extern void tuplesort_merge_range(Tuplesortstate *state, int range,
+								  int nranges);
 extern bool tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 									  SortTuple *stup);
 extern bool tuplesort_skiptuples(Tuplesortstate *state, int64 ntuples,
@@ -365,7 +374,11 @@ extern int	tuplesort_merge_order(int64 allowedMem);
 extern Size tuplesort_estimate_shared(int nWorkers);
 extern void tuplesort_initialize_shared(Sharedsort *shared, int nWorkers,
 										dsm_segment *seg);
+extern Size tuplesort_estimate_shared_ranged(int nWorkers);
+extern void tuplesort_initialize_shared_ranged(Sharedsort *shared, int nWorkers,
+											   dsm_segment *seg);
 extern void tuplesort_attach_shared(Sharedsort *shared, dsm_segment *seg);
+extern void tuplesort_reinitialize_shared(Sharedsort *shared);
 
 /*
  * These routines may only be called if TUPLESORT_RANDOMACCESS was specified
@@ -29,6 +29,7 @@
 
 #include <numa.h>
 #include <numaif.h>
+#include <sched.h>
 
 /*
  * numa_move_pages() chunk size, has to be <= 16 to work around a kernel bug
@@ -118,6 +119,44 @@ pg_numa_get_max_node(void)
 	return numa_max_node();
 }
 
+/*
+ * Return the NUMA node of the CPU the calling process currently runs on, or
+ * -1 if it can't be determined.
+ */
+int
+pg_numa_get_current_node(void)
+{
+	int			cpu = sched_getcpu();
+
+	if (cpu < 0)
+		return -1;
+
+	return numa_node_of_cpu(cpu);
+}
+
+/*
+ * Set the memory policy of a range of memory to interleave its pages over
+ * all NUMA nodes.  This only affects pages that are not allocated yet, so it
+ * has to be done before the memory is first touched.  ptr must be aligned to
+ * the memory page size.
+ */
+void
+pg_numa_interleave_memory(void *ptr, Size size)
+{
+	numa_interleave_memory(ptr, size, numa_all_nodes_ptr);
+}
+
+/*
+ * Set the memory policy of a range of memory to allocate its pages on the
+ * given NUMA node.  As for pg_numa_interleave_memory(), this has to be done
+ * before the memory is first touched.
+ */
+void
+pg_numa_bind_memory(void *ptr, Size size, int node)
+{
+	numa_tonode_memory(ptr, size, node);
+}
+
 #else
 
 /* Empty wrappers */
@@ -140,4 +179,20 @@ pg_numa_get_max_node(void)
 	return 0;
 }
 
+int
+pg_numa_get_current_node(void)
+{
+	return -1;
+}
+
+void
+pg_numa_interleave_memory(void *ptr, Size size)
+{
+}
+
+void
+pg_numa_bind_memory(void *ptr, Size size, int node)
+{
+}
+
 #endif
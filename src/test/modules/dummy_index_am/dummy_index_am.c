@@ -334,6 +334,7 @@ dihandler(PG_FUNCTION_ARGS)
 		.ambeginscan = dibeginscan,
 		.amrescan = direscan,
 		.amgettuple = NULL,
+		.amgetbatch = NULL,
 		.amgetbitmap = NULL,
 		.amendscan = diendscan,
 		.ammarkpos = NULL,
@@ -842,6 +842,32 @@ SELECT invalidate_rel_block('tbl_ok', 1);
 	$psql->quit();
 }
 
+# Verify that the checkpointer's asynchronous, combined writes make it to
+# disk. After an immediate shutdown, no WAL needs to be replayed for the
+# table, so its contents have to have been written by the checkpoint.
+sub test_checkpoint_write
+{
+	my $io_method = shift;
+	my $node = shift;
+
+	$node->safe_psql(
+		'postgres', qq(
+CREATE TABLE tbl_ckpt(data int not null) WITH (AUTOVACUUM_ENABLED = false);
+INSERT INTO tbl_ckpt SELECT generate_series(1, 50000);
+CHECKPOINT;
+));
+
+	$node->stop('immediate');
+	$node->start();
+
+	is( $node->safe_psql(
+			'postgres', 'SELECT count(*), sum(data) FROM tbl_ckpt'),
+		'50000|1250025000',
+		"$io_method: table contents written by checkpoint");
+
+	$node->safe_psql('postgres', 'DROP TABLE tbl_ckpt');
+}
+
 # Verify that we handle a relation getting removed (due to a rollback or a
 # DROP TABLE) while IO is ongoing for that table.
 sub test_invalidate
@@ -1878,6 +1904,7 @@ CHECKPOINT;
 	test_ignore_checksum($io_method, $node);
 	test_checksum_createdb($io_method, $node);
 	test_read_buffers($io_method, $node);
+	test_checkpoint_write($io_method, $node);
 
 	# generic injection tests
   SKIP:
@@ -0,0 +1,280 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+use FindBin;
+use lib $FindBin::RealBin;
+
+use TestAio;
+
+
+my $node = PostgreSQL::Test::Cluster->new('test');
+$node->init();
+
+TestAio::configure($node);
+
+$node->append_conf(
+	'postgresql.conf', qq(
+max_connections=8
+io_method=worker
+));
+
+$node->start();
+$node->safe_psql('postgres', qq(CREATE EXTENSION test_aio;));
+$node->stop();
+
+
+foreach my $method (TestAio::supported_io_methods())
+{
+	$node->adjust_conf('postgresql.conf', 'io_method', $method);
+	$node->start();
+	test_io_method($method, $node);
+	$node->stop();
+}
+
+done_testing();
+
+
+# Return the contents of a relation written by write_stream_for_blocks(), as
+# a comma separated list of the recorded block numbers, with "-" for pages of
+# zeroes.
+sub written_blocks
+{
+	my $node = shift;
+	my $table = shift;
+
+	return $node->safe_psql(
+		'postgres', qq/SELECT string_agg(coalesce(tag::text, '-'), ','
+		   ORDER BY blocknum) FROM read_written_blocks('$table');/);
+}
+
+# Expected result of written_blocks() after writing the given blocks.
+sub expected_blocks
+{
+	my %written = map { $_ => 1 } @_;
+	my $nblocks = 0;
+
+	foreach my $blkno (@_)
+	{
+		$nblocks = $blkno + 1 if $blkno + 1 > $nblocks;
+	}
+
+	return join(',', map { $written{$_} ? $_ : '-' } (0 .. $nblocks - 1));
+}
+
+
+sub test_combining
+{
+	my $io_method = shift;
+	my $node = shift;
+
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_combine(k int);/);
+
+	# Writes are started when a block doesn't follow the pending ones or
+	# io_combine_limit is reached, leaving gaps filled with zeroes.
+	is( $node->safe_psql(
+			'postgres', qq/SET io_combine_limit = 2;
+			SELECT write_count, io_count, io_nblocks
+			FROM write_stream_for_blocks('ws_combine',
+			   ARRAY[5, 6, 7, 0, 1, 2, 9]);/),
+		'7|5|7',
+		"$io_method: stream combines consecutive blocks only");
+	is( written_blocks($node, 'ws_combine'),
+		expected_blocks(5, 6, 7, 0, 1, 2, 9),
+		"$io_method: stream wrote blocks out of order and with gaps");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_combine;/);
+}
+
+
+sub test_large_writes
+{
+	my $io_method = shift;
+	my $node = shift;
+
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_large(k int);/);
+
+	# Runs of more than 8 blocks past the end of the fork are written
+	# asynchronously after zero-extending the fork, shorter ones extend the
+	# fork synchronously.
+	is( $node->safe_psql(
+			'postgres', qq/SET io_combine_limit = 16;
+			SELECT write_count, io_count, io_nblocks
+			FROM write_stream_for_blocks('ws_large',
+			   ARRAY(SELECT generate_series(0, 39)) ||
+			   ARRAY(SELECT generate_series(100, 119)));/),
+		'60|5|60',
+		"$io_method: stream combines long runs of blocks");
+	is( written_blocks($node, 'ws_large'),
+		expected_blocks(0 .. 39, 100 .. 119),
+		"$io_method: stream wrote long runs of blocks");
+
+	# Overwrite some of the blocks, which doesn't extend the fork anymore.
+	$node->safe_psql(
+		'postgres', qq/SET io_combine_limit = 16;
+		SELECT FROM write_stream_for_blocks('ws_large',
+		   ARRAY(SELECT generate_series(40, 59)));/);
+	is( written_blocks($node, 'ws_large'),
+		expected_blocks(0 .. 59, 100 .. 119),
+		"$io_method: stream overwrote existing blocks");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_large;/);
+}
+
+
+sub test_abort
+{
+	my $io_method = shift;
+	my $node = shift;
+
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_abort(k int);/);
+
+	# Raise an error while writes are in progress.  The resource owner has to
+	# wait for them, and then the subtransaction can be rolled back.
+	my ($ret, $stdout, $stderr) = $node->psql(
+		'postgres', qq/SET io_combine_limit = 16;
+		BEGIN;
+		SAVEPOINT s;
+		SELECT write_stream_for_blocks('ws_abort',
+		   ARRAY(SELECT generate_series(0, 63)), error_at => 40);
+		ROLLBACK TO s;
+		SELECT count(*) FROM read_written_blocks('ws_abort');
+		COMMIT;/,
+		on_error_stop => 0);
+	like(
+		$stderr,
+		qr/ERROR:  stopping write stream after 40 pages/,
+		"$io_method: error raised with writes in progress");
+	unlike($stderr, qr/WARNING/,
+		"$io_method: no resources leaked by aborted stream");
+	is($stdout, '32', "$io_method: started writes extended the fork");
+	is( written_blocks($node, 'ws_abort'),
+		expected_blocks(0 .. 31),
+		"$io_method: started writes completed");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_abort;/);
+}
+
+
+sub test_inject
+{
+	my $io_method = shift;
+	my $node = shift;
+	my ($ret, $stdout, $stderr, $log_location);
+
+	###
+	# Test short writes, which the stream completes synchronously.
+	###
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_partial(k int);/);
+	$log_location = -s $node->logfile;
+
+	$node->safe_psql(
+		'postgres', qq/SET io_combine_limit = 16;
+		SELECT inj_io_short_read_attach(
+		   current_setting('block_size')::int,
+		   pid=>pg_backend_pid(),
+		   relfilenode=>pg_relation_filenode('ws_partial'));
+		SELECT FROM write_stream_for_blocks('ws_partial',
+		   ARRAY(SELECT generate_series(0, 31)));
+		SELECT inj_io_short_read_detach();/);
+	ok( $node->log_contains(
+			qr/could not write blocks 0\.\.15 in file "[^"]+": wrote only \d+ of \d+ bytes/,
+			$log_location),
+		"$io_method: short write was injected");
+	is( written_blocks($node, 'ws_partial'),
+		expected_blocks(0 .. 31),
+		"$io_method: stream completed short writes");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_partial;/);
+
+	###
+	# Test a failing write, which raises an error while another write is
+	# still in progress.
+	###
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_error(k int);/);
+
+	($ret, $stdout, $stderr) = $node->psql(
+		'postgres', qq/SET io_combine_limit = 16;
+		SELECT inj_io_short_read_attach(-errno_from_string('EIO'),
+		   pid=>pg_backend_pid(),
+		   relfilenode=>pg_relation_filenode('ws_error'));
+		SELECT write_stream_for_blocks('ws_error',
+		   ARRAY(SELECT generate_series(0, 31)));
+		SELECT inj_io_short_read_detach();
+		SELECT 'still alive';/,
+		on_error_stop => 0);
+	like(
+		$stderr,
+		qr/ERROR:  could not write blocks 0\.\.15 in file "[^"]+": Input\/output error/,
+		"$io_method: failed write raised an error");
+	unlike($stderr, qr/WARNING/,
+		"$io_method: no resources leaked by failed stream");
+	like($stdout, qr/still alive/,
+		"$io_method: session usable after failed write");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_error;/);
+
+	###
+	# Test a write whose completion is delayed.  The stream has to wait for
+	# it before ending, and all writes must be complete afterwards.
+	###
+	$node->safe_psql('postgres', qq/CREATE TABLE ws_wait(k int);/);
+
+	my $psql = $node->background_psql('postgres', on_error_stop => 0);
+	my $pid = $psql->query_safe(qq/SELECT pg_backend_pid();/);
+
+	$psql->query_safe(
+		qq/SELECT inj_io_completion_wait(pid=>pg_backend_pid(),
+		   relfilenode=>pg_relation_filenode('ws_wait'), blockno=>0);/);
+
+	$psql->{stdin} .= qq/SET io_combine_limit = 16;
+		SELECT write_count, io_count FROM write_stream_for_blocks('ws_wait',
+		   ARRAY(SELECT generate_series(0, 47)));\n/;
+	$psql->{run}->pump_nb();
+
+	$node->poll_query_until(
+		'postgres',
+		qq/SELECT wait_event IN ('completion_wait', 'AioIoCompletion')
+		   FROM pg_stat_activity WHERE pid = $pid;/,
+		't');
+
+	$node->safe_psql('postgres', qq/SELECT inj_io_completion_continue()/);
+
+	pump_until($psql->{run}, $psql->{timeout}, \$psql->{stdout}, qr/48\|3/);
+	$psql->{stdout} = '';
+	ok(1, "$io_method: stream waited for delayed write");
+
+	$psql->quit();
+
+	is( written_blocks($node, 'ws_wait'),
+		expected_blocks(0 .. 47),
+		"$io_method: stream completed delayed write");
+
+	$node->safe_psql('postgres', qq/DROP TABLE ws_wait;/);
+}
+
+
+sub test_io_method
+{
+	my $io_method = shift;
+	my $node = shift;
+
+	is($node->safe_psql('postgres', 'SHOW io_method'),
+		$io_method, "$io_method: io_method set correctly");
+
+	test_combining($io_method, $node);
+	test_large_writes($io_method, $node);
+	test_abort($io_method, $node);
+
+  SKIP:
+	{
+		skip 'Injection points not supported by this build', 1
+		  unless $ENV{enable_injection_points} eq 'yes';
+		test_inject($io_method, $node);
+	}
+}
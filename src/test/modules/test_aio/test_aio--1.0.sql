@@ -64,6 +64,15 @@ CREATE FUNCTION read_stream_for_blocks(rel regclass, blocks int4[], OUT blockoff
 RETURNS SETOF record STRICT
 AS 'MODULE_PATHNAME' LANGUAGE C;
 
+CREATE FUNCTION write_stream_for_blocks(rel regclass, blocks int4[], error_at int4 DEFAULT NULL,
+    OUT write_count int8, OUT io_count int8, OUT io_nblocks int8, OUT wait_count int8)
+RETURNS record
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION read_written_blocks(rel regclass, OUT blocknum int4, OUT tag int4)
+RETURNS SETOF record STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
 
 /*
  * Handle related functions
@@ -18,8 +18,10 @@
 
 #include "postgres.h"
 
+#include "access/htup_details.h"
 #include "access/relation.h"
 #include "catalog/pg_type.h"
+#include "executor/instrument_node.h"
 #include "fmgr.h"
 #include "funcapi.h"
 #include "storage/aio.h"
@@ -32,6 +34,7 @@
 #include "storage/proc.h"
 #include "storage/procnumber.h"
 #include "storage/read_stream.h"
+#include "storage/write_stream.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/injection_point.h"
@@ -915,6 +918,126 @@ read_stream_for_blocks(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Write pages to the given blocks of a relation's main fork through a write
+ * stream, bypassing shared buffers.  Each page records its block number in
+ * its special space, see read_written_blocks().  If error_at is not NULL, an
+ * error is raised before handing over the page at that offset of the array,
+ * leaving it to the resource owner to clean up the stream.
+ */
+PG_FUNCTION_INFO_V1(write_stream_for_blocks);
+Datum
+write_stream_for_blocks(PG_FUNCTION_ARGS)
+{
+	Oid			relid;
+	ArrayType  *blocksarray;
+	int			error_at = PG_ARGISNULL(2) ? -1 : PG_GETARG_INT32(2);
+	TupleDesc	tupdesc;
+	Datum		values[4];
+	bool		nulls[4] = {0};
+	int			nblocks;
+	uint32	   *blocks;
+	Relation	rel;
+	WriteStream *stream;
+	IOStats		stats = {0};
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1))
+		elog(ERROR, "relation and blocks must not be NULL");
+	relid = PG_GETARG_OID(0);
+	blocksarray = PG_GETARG_ARRAYTYPE_P(1);
+
+	if (ARR_NDIM(blocksarray) != 1 ||
+		ARR_HASNULL(blocksarray) ||
+		ARR_ELEMTYPE(blocksarray) != INT4OID)
+		elog(ERROR, "expected 1 dimensional int4 array");
+
+	nblocks = ARR_DIMS(blocksarray)[0];
+	blocks = (uint32 *) ARR_DATA_PTR(blocksarray);
+
+	rel = relation_open(relid, AccessExclusiveLock);
+
+	stream = write_stream_begin_relation(WRITE_STREAM_DEFAULT, rel,
+										 MAIN_FORKNUM);
+	write_stream_enable_stats(stream, &stats);
+
+	for (int i = 0; i < nblocks; i++)
+	{
+		PGIOAlignedBlock *buf;
+
+		if (i == error_at)
+			elog(ERROR, "stopping write stream after %d pages", i);
+
+		buf = write_stream_get_buf(stream);
+		PageInit(buf->data, BLCKSZ, sizeof(uint32));
+		*(uint32 *) PageGetSpecialPointer(buf->data) = blocks[i];
+		PageSetChecksum(buf->data, blocks[i]);
+
+		write_stream_write(stream, blocks[i], buf);
+	}
+
+	/* wait for the writes separately, to exercise that too */
+	write_stream_flush(stream);
+	write_stream_end(stream);
+
+	relation_close(rel, NoLock);
+
+	values[0] = Int64GetDatum(stats.write_count);
+	values[1] = Int64GetDatum(stats.io_count);
+	values[2] = Int64GetDatum(stats.io_nblocks);
+	values[3] = Int64GetDatum(stats.wait_count);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+/*
+ * Read all blocks of a relation's main fork directly from storage, returning
+ * the block number recorded by write_stream_for_blocks(), or NULL for pages
+ * of zeroes.
+ */
+PG_FUNCTION_INFO_V1(read_written_blocks);
+Datum
+read_written_blocks(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	PGIOAlignedBlock page;
+	Relation	rel;
+	SMgrRelation smgr;
+	BlockNumber nblocks;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	rel = relation_open(relid, AccessShareLock);
+	smgr = RelationGetSmgr(rel);
+	nblocks = smgrnblocks(smgr, MAIN_FORKNUM);
+
+	for (BlockNumber blkno = 0; blkno < nblocks; blkno++)
+	{
+		Datum		values[2] = {0};
+		bool		nulls[2] = {0};
+
+		smgrread(smgr, MAIN_FORKNUM, blkno, page.data);
+
+		if (!PageIsVerified(page.data, blkno, PIV_LOG_WARNING, NULL))
+			elog(ERROR, "invalid page in block %u", blkno);
+
+		values[0] = UInt32GetDatum(blkno);
+		if (PageIsNew(page.data))
+			nulls[1] = true;
+		else
+			values[1] = UInt32GetDatum(*(uint32 *) PageGetSpecialPointer(page.data));
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	relation_close(rel, NoLock);
+
+	return (Datum) 0;
+}
+
 
 PG_FUNCTION_INFO_V1(handle_get);
 Datum
@@ -1119,9 +1242,13 @@ inj_io_short_read_hook(const char *name, const void *private_data, void *arg)
 		 * contents would look valid and we might miss a bug.
 		 *
 		 * To avoid that, iterate through the IOV and zero out the "failed"
-		 * portion of the IO.
+		 * portion of the IO.  The IOV of a write holds the data being
+		 * written, which is written again after a short write, so it must be
+		 * left alone.
 		 */
-		for (int i = 0; i < ioh->op_data.read.iov_length; i++)
+		for (int i = 0;
+			 ioh->op == PGAIO_OP_READV && i < ioh->op_data.read.iov_length;
+			 i++)
 		{
 			if (processed + iov[i].iov_len <= new_result)
 				processed += iov[i].iov_len;
@@ -0,0 +1,99 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test that the shared catalog cache gets invalidated when the catalogs
+# change, both for sessions that already have the entries in their local
+# caches and for sessions started afterwards.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init();
+$node->append_conf('postgresql.conf', 'shared_catcache_size = 1MB');
+$node->start;
+
+$node->safe_psql(
+	'postgres', q[
+    CREATE TABLE sct (a int);
+    INSERT INTO sct VALUES (1);
+    CREATE FUNCTION scfunc() RETURNS text AS $$ SELECT 'v1' $$ LANGUAGE SQL;
+]);
+
+my $session = $node->background_psql('postgres');
+
+# Populate the shared cache, then read the entries back from new sessions.
+is($session->query_safe('SELECT scfunc()'), 'v1', 'first lookup');
+is($node->safe_psql('postgres', 'SELECT scfunc()'),
+	'v1', 'lookup in a new session');
+
+# A transaction that changes the function must see its own change, while
+# everyone else keeps seeing the committed definition.
+my $session2 = $node->background_psql('postgres');
+$session2->query_safe(
+	q[
+    BEGIN;
+    CREATE OR REPLACE FUNCTION scfunc() RETURNS text AS $$ SELECT 'v2' $$ LANGUAGE SQL;
+]);
+is($session2->query_safe('SELECT scfunc()'),
+	'v2', 'uncommitted change is visible to its own transaction');
+is($node->safe_psql('postgres', 'SELECT scfunc()'),
+	'v1', 'uncommitted change is not visible to new sessions');
+$session2->query_safe('COMMIT');
+
+is($session->query_safe('SELECT scfunc()'),
+	'v2', 'committed change is visible to an existing session');
+is($node->safe_psql('postgres', 'SELECT scfunc()'),
+	'v2', 'committed change is visible to a new session');
+
+# Same for a change that doesn't involve the session running the test.
+$node->safe_psql('postgres', 'ALTER TABLE sct ADD COLUMN b int DEFAULT 42');
+is($node->safe_psql('postgres', 'SELECT a, b FROM sct'),
+	'1|42', 'new column is visible to a new session');
+is($session->query_safe('SELECT a, b FROM sct'),
+	'1|42', 'new column is visible to an existing session');
+
+# Fill the shared cache well past its size limit, so that entries have to
+# be evicted, and check that lookups still return the right answers.
+$node->safe_psql(
+	'postgres', q[
+    DO $$
+    BEGIN
+      FOR i IN 1..2000 LOOP
+        EXECUTE format('CREATE FUNCTION scfill%s() RETURNS int AS $f$ SELECT %s /* %s */ $f$ LANGUAGE SQL',
+                       i, i, repeat('x', 1000));
+      END LOOP;
+    END $$;
+]);
+my $sum_query = q[
+    DO $$
+    DECLARE
+      s bigint := 0;
+      r int;
+    BEGIN
+      FOR i IN 1..2000 LOOP
+        EXECUTE format('SELECT scfill%s()', i) INTO r;
+        s := s + r;
+      END LOOP;
+      RAISE NOTICE 'sum %', s;
+    END $$;
+];
+my $stderr;
+$node->psql('postgres', $sum_query, stderr => \$stderr);
+like($stderr, qr/sum 2001000/, 'lookups with a full shared cache');
+$node->psql('postgres', $sum_query, stderr => \$stderr);
+like($stderr, qr/sum 2001000/, 'lookups after eviction');
+
+$node->safe_psql('postgres',
+	q[CREATE OR REPLACE FUNCTION scfill7() RETURNS int AS $$ SELECT 0 $$ LANGUAGE SQL]);
+$node->psql('postgres', $sum_query, stderr => \$stderr);
+like($stderr, qr/sum 2000993/, 'lookups after replacing a function');
+
+$session->quit;
+$session2->quit;
+$node->stop;
+
+done_testing();
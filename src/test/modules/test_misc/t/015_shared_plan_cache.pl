@@ -0,0 +1,108 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test that generic plans taken from the shared plan cache give the right
+# results, and that they get invalidated when the objects they depend on
+# change.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init();
+$node->append_conf(
+	'postgresql.conf', qq[
+shared_plan_cache_size = 1MB
+plan_cache_mode = force_generic_plan
+]);
+$node->start;
+
+$node->safe_psql(
+	'postgres', q[
+    CREATE TABLE spc (a int, b text);
+    INSERT INTO spc SELECT i, 'row ' || i FROM generate_series(1, 10000) i;
+    ANALYZE spc;
+    CREATE FUNCTION spcfunc(int) RETURNS int AS $$ SELECT $1 * 2 $$ LANGUAGE SQL;
+    CREATE ROLE spc_reader;
+    GRANT SELECT ON spc TO spc_reader;
+    ALTER TABLE spc ENABLE ROW LEVEL SECURITY;
+    CREATE POLICY spc_policy ON spc TO spc_reader USING (a % 2 = 0);
+]);
+
+my $prepare = q[
+    PREPARE q(int) AS SELECT b, spcfunc(a) FROM spc WHERE a = $1;
+];
+
+# Make the plan in one session, then use it in others.
+is($node->safe_psql('postgres', $prepare . 'EXECUTE q(42)'),
+	'row 42|84', 'first execution');
+is($node->safe_psql('postgres', $prepare . 'EXECUTE q(43)'),
+	'row 43|86', 'execution in a second session');
+like(
+	$node->safe_psql('postgres', $prepare . 'EXPLAIN (COSTS OFF) EXECUTE q(1)'),
+	qr/Seq Scan on spc/,
+	'sequential scan without an index');
+
+# A different role must not get the plan without the row security policy.
+is( $node->safe_psql(
+		'postgres',
+		'SET ROLE spc_reader;' . $prepare . 'EXECUTE q(43); EXECUTE q(44)'),
+	'row 44|88',
+	'row security policy is applied to another role');
+
+# Creating an index invalidates the plan.
+$node->safe_psql('postgres', 'CREATE INDEX spc_a_idx ON spc (a)');
+like(
+	$node->safe_psql('postgres', $prepare . 'EXPLAIN (COSTS OFF) EXECUTE q(1)'),
+	qr/Index Scan using spc_a_idx/,
+	'plan is remade after creating an index');
+
+# So does replacing a function that the plan has inlined.
+$node->safe_psql('postgres',
+	q[CREATE OR REPLACE FUNCTION spcfunc(int) RETURNS int AS $$ SELECT $1 * 3 $$ LANGUAGE SQL]
+);
+is($node->safe_psql('postgres', $prepare . 'EXECUTE q(42)'),
+	'row 42|126', 'plan is remade after replacing a function');
+
+# Planner settings are part of the key.
+like(
+	$node->safe_psql(
+		'postgres',
+		'SET enable_indexscan = off; SET enable_bitmapscan = off;'
+		  . $prepare
+		  . 'EXPLAIN (COSTS OFF) EXECUTE q(1)'),
+	qr/Seq Scan on spc/,
+	'planner settings are respected');
+
+# Plans with custom scans are not shared, since other backends can't read
+# them back unless they have loaded the library that provides the scan.  A
+# backend that only opened the partitioned table hasn't loaded the library
+# of the table access method of its partition.
+$node->safe_psql(
+	'postgres', q[
+    CREATE EXTENSION columnar;
+    CREATE TABLE spc_part (a int, b text) PARTITION BY RANGE (a);
+    CREATE TABLE spc_part_1 PARTITION OF spc_part
+      FOR VALUES FROM (1) TO (10001) USING columnar;
+    INSERT INTO spc_part SELECT i, 'row ' || i FROM generate_series(1, 10000) i;
+    ANALYZE spc_part;
+]);
+
+my $prepare_part = q[
+    PREPARE qp(int) AS SELECT count(*) FROM spc_part WHERE a > $1;
+];
+
+like(
+	$node->safe_psql(
+		'postgres', $prepare_part . 'EXPLAIN (COSTS OFF) EXECUTE qp(1)'),
+	qr/Custom Scan \(ColumnarScan\) on spc_part_1/,
+	'generic plan with a custom scan');
+is($node->safe_psql('postgres', $prepare_part . 'EXECUTE qp(5000)'),
+	'5000', 'plan with a custom scan is made again in another session');
+
+$node->stop;
+
+done_testing();
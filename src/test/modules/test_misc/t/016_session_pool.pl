@@ -0,0 +1,104 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test that sessions sharing a pool backend keep their own settings and
+# prepared statements, that features tied to the backend are refused in
+# them, that the pool backend outlives the sessions that come and go, and
+# that pooled sessions count against connection limits.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use PostgreSQL::Test::BackgroundPsql;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init();
+$node->append_conf('postgresql.conf', 'session_pool_size = 1');
+$node->start;
+
+my $psql1 = $node->background_psql('postgres');
+my $psql2 = $node->background_psql('postgres');
+
+my $pid1 = $psql1->query_safe('SELECT pg_backend_pid()');
+my $pid2 = $psql2->query_safe('SELECT pg_backend_pid()');
+is($pid1, $pid2, 'second session is served by the pool backend');
+
+# Settings and prepared statements belong to the session.
+$psql1->query_safe(q[SET work_mem = '1234kB']);
+$psql1->query_safe(q[PREPARE q AS SELECT 'from session 1']);
+$psql2->query_safe(q[PREPARE q AS SELECT 'from session 2']);
+
+is($psql2->query_safe('SHOW work_mem'), '4MB', 'setting is not shared');
+is($psql1->query_safe('SHOW work_mem'), '1234kB', 'setting is kept');
+is($psql1->query_safe('EXECUTE q'), 'from session 1',
+	'prepared statement of the first session');
+is($psql2->query_safe('EXECUTE q'), 'from session 2',
+	'prepared statement of the second session');
+
+# Transactions are not interleaved: while the first session is inside a
+# transaction, the pool backend doesn't serve the second one, so check what
+# the transaction has done from a dedicated backend.
+my $dedicated = $node->connstr('postgres') . ' options=-csession_pooling=off';
+$psql1->query_safe('CREATE TABLE pooled (a int)');
+$psql1->query_safe('BEGIN');
+$psql1->query_safe('INSERT INTO pooled VALUES (1)');
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*) FROM pooled',
+		connstr => $dedicated),
+	'0',
+	'uncommitted row of a pooled session is not visible to others');
+$psql1->query_safe('COMMIT');
+is($psql2->query_safe('SELECT count(*) FROM pooled'),
+	'1', 'committed row is visible to the other session');
+
+# Temporary tables are tied to the backend.
+my $stderr;
+$node->psql(
+	'postgres', 'CREATE TEMP TABLE pooled_temp (a int)',
+	stderr => \$stderr);
+like(
+	$stderr,
+	qr/temporary tables cannot be used in a pooled session/,
+	'temporary tables are refused in a pooled session');
+
+# They work in a dedicated backend.
+my $dedicated_pid = $node->safe_psql('postgres',
+	'CREATE TEMP TABLE pooled_temp (a int); SELECT pg_backend_pid()',
+	connstr => $dedicated);
+isnt($dedicated_pid, $pid1,
+	'dedicated backend with session_pooling turned off');
+
+# The pool backend goes on serving the other session when one ends.
+$psql1->quit;
+is($psql2->query_safe('SELECT pg_backend_pid()'),
+	$pid1, 'pool backend survives the end of a session');
+is($psql2->query_safe('SHOW work_mem'), '4MB',
+	'remaining session keeps its settings');
+$psql2->quit;
+
+# Pooled sessions count against connection limits, although they don't have
+# a backend of their own.
+$node->safe_psql('postgres',
+	'CREATE ROLE pooled_user LOGIN CONNECTION LIMIT 2');
+my $user_connstr = $node->connstr('postgres') . ' user=pooled_user';
+my $user1 = $node->background_psql('postgres', connstr => $user_connstr);
+my $user2 = $node->background_psql('postgres', connstr => $user_connstr);
+is( $user2->query_safe('SELECT pg_backend_pid()'),
+	$user1->query_safe('SELECT pg_backend_pid()'),
+	'sessions of the role share a pool backend');
+$node->psql(
+	'postgres', 'SELECT 1',
+	connstr => $user_connstr,
+	stderr => \$stderr);
+like(
+	$stderr,
+	qr/too many connections for role "pooled_user"/,
+	'pooled sessions count against the connection limit of the role');
+$user1->quit;
+$user2->quit;
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,133 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test visibility with snapshots based on commit sequence numbers, including
+# subtransactions and the places that turn such snapshots into lists of
+# running transactions.
+
+use strict;
+use warnings FATAL => 'all';
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use PostgreSQL::Test::BackgroundPsql;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init();
+$node->append_conf(
+	'postgresql.conf', qq(
+csn_snapshots = on
+# Keep autoanalyze's transactions out of the listed snapshots
+autovacuum = off
+));
+$node->start;
+
+$node->safe_psql('postgres', 'CREATE TABLE csn (a int)');
+
+my $writer = $node->background_psql('postgres');
+my $reader = $node->background_psql('postgres');
+
+# Get the first transaction end out of the way, so that CSN-based snapshots
+# are in use from here on.
+$node->safe_psql('postgres', 'INSERT INTO csn VALUES (0)');
+
+# Uncommitted rows, including ones from subtransactions, are invisible.
+$writer->query_safe('BEGIN');
+$writer->query_safe('INSERT INTO csn VALUES (1)');
+$writer->query_safe('SAVEPOINT s1');
+$writer->query_safe('INSERT INTO csn VALUES (2)');
+$writer->query_safe('RELEASE s1');
+$writer->query_safe('SAVEPOINT s2');
+$writer->query_safe('INSERT INTO csn VALUES (3)');
+$writer->query_safe('ROLLBACK TO s2');
+my $writer_xid = $writer->query_safe('SELECT pg_current_xact_id()');
+
+is($reader->query_safe('SELECT array_agg(a ORDER BY a) FROM csn'),
+	'{0}', 'rows of a running transaction are invisible');
+
+# The running transaction shows up in exported and current snapshots.
+$reader->query_safe('BEGIN ISOLATION LEVEL REPEATABLE READ');
+my $snapshot_name = $reader->query_safe('SELECT pg_export_snapshot()');
+like(
+	$reader->query_safe('SELECT pg_current_snapshot()'),
+	qr/\b$writer_xid\b/,
+	'running transaction is listed in the current snapshot');
+
+$writer->query_safe('COMMIT');
+
+is($reader->query_safe('SELECT array_agg(a ORDER BY a) FROM csn'),
+	'{0}', 'commit after the snapshot was taken is not visible');
+is($node->safe_psql('postgres', 'SELECT array_agg(a ORDER BY a) FROM csn'),
+	'{0,1,2}', 'commit is visible to a new snapshot');
+
+is( $node->safe_psql(
+		'postgres', qq[
+		BEGIN ISOLATION LEVEL REPEATABLE READ;
+		SET TRANSACTION SNAPSHOT '$snapshot_name';
+		SELECT array_agg(a ORDER BY a) FROM csn;
+		COMMIT;]),
+	'{0}',
+	'imported snapshot does not see the later commit');
+
+$reader->query_safe('COMMIT');
+is($reader->query_safe('SELECT array_agg(a ORDER BY a) FROM csn'),
+	'{0,1,2}', 'commit is visible after the transaction ends');
+
+# Snapshots handed to parallel workers.
+$node->safe_psql('postgres',
+	'INSERT INTO csn SELECT 10 FROM generate_series(1, 100000)');
+$writer->query_safe('BEGIN');
+$writer->query_safe('DELETE FROM csn WHERE a = 10');
+is( $node->safe_psql(
+		'postgres', q[
+		SET parallel_setup_cost = 0;
+		SET parallel_tuple_cost = 0;
+		SET min_parallel_table_scan_size = 0;
+		SET debug_parallel_query = on;
+		SELECT count(*) FROM csn WHERE a = 10;]),
+	'100000',
+	'parallel workers do not see an uncommitted delete');
+$writer->query_safe('ROLLBACK');
+
+# Listing the running transactions must not depend on how many XIDs were
+# assigned since the oldest running transaction started.
+my $consume_xids = q[
+	DO $$
+	BEGIN
+		FOR i IN 1..5000 LOOP
+			PERFORM pg_current_xact_id();
+			COMMIT;
+		END LOOP;
+	END $$;];
+
+$writer->query_safe('BEGIN');
+my $old_xid = $writer->query_safe('SELECT pg_current_xact_id()');
+$node->safe_psql('postgres', $consume_xids);
+my $list_xids =
+  q[SELECT string_agg(x::text, ',') FROM pg_snapshot_xip(pg_current_snapshot()) x];
+is($node->safe_psql('postgres', $list_xids),
+	$old_xid, 'old transaction is the only one listed in the current snapshot');
+
+# Transactions that complete after the snapshot was taken are listed too,
+# both from the buffer of recent completions and, once that has wrapped
+# around, from pg_csn.
+$reader->query_safe('BEGIN ISOLATION LEVEL REPEATABLE READ');
+$reader->query_safe('SELECT count(*) FROM csn');
+$writer->query_safe('COMMIT');
+is($reader->query_safe($list_xids),
+	$old_xid, 'transaction that completed after the snapshot is listed');
+$node->safe_psql('postgres', $consume_xids);
+is($reader->query_safe($list_xids),
+	$old_xid, 'transaction that completed long after the snapshot is listed');
+$reader->query_safe('COMMIT');
+
+# The log starts over after a restart.
+$writer->quit;
+$reader->quit;
+$node->restart;
+is($node->safe_psql('postgres', 'SELECT count(*) FROM csn WHERE a < 10'),
+	'3', 'rows are visible after a restart');
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,32 @@
+CREATE EXTENSION test_nbtree_search;
+
+-- integer keys, each present once
+CREATE TABLE nbtree_search_int4 (k int4);
+INSERT INTO nbtree_search_int4 SELECT generate_series(1, 20000);
+CREATE INDEX nbtree_search_int4_idx ON nbtree_search_int4 (k);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_int4_idx', 1000, 1, 20000);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_int4_idx', 1000, 20001, 30000);
+
+-- descending smallint keys, each present three times, and NULLs
+CREATE TABLE nbtree_search_int2 (k int2);
+INSERT INTO nbtree_search_int2 SELECT i % 5000 FROM generate_series(0, 14999) i;
+INSERT INTO nbtree_search_int2 SELECT NULL FROM generate_series(1, 1000);
+CREATE INDEX nbtree_search_int2_idx ON nbtree_search_int2 (k DESC);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_int2_idx', 1000, 0, 4999, 42);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_int2_idx', 1, 0, 100000);
+
+-- bigint keys that do not fit in 32 bits
+CREATE TABLE nbtree_search_int8 (k int8);
+INSERT INTO nbtree_search_int8
+  SELECT (1::int8 << 40) + i FROM generate_series(1, 20000) i;
+CREATE INDEX nbtree_search_int8_idx ON nbtree_search_int8 (k);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_int8_idx', 1000,
+  (1::int8 << 40) + 1, (1::int8 << 40) + 20000);
+
+-- unsupported indexes
+CREATE INDEX nbtree_search_text_idx ON nbtree_search_int4 ((k::text));
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_text_idx', 1, 1, 1);
+CREATE INDEX nbtree_search_hash_idx ON nbtree_search_int4 USING hash (k);
+SELECT nfound FROM nbtree_point_lookups('nbtree_search_hash_idx', 1, 1, 1);
+
+DROP TABLE nbtree_search_int2, nbtree_search_int4, nbtree_search_int8;
@@ -0,0 +1,15 @@
+/* src/test/modules/test_nbtree_search/test_nbtree_search--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_nbtree_search" to load this file. \quit
+
+CREATE FUNCTION nbtree_point_lookups(index regclass,
+	nlookups int8,
+	minkey int8,
+	maxkey int8,
+	seed int8 DEFAULT 0,
+	OUT nfound int8,
+	OUT elapsed_ms float8,
+	OUT lookups_per_sec float8)
+	RETURNS record
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
@@ -0,0 +1,177 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_nbtree_search.c
+ *		Measure the throughput of point lookups in B-tree indexes.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_nbtree_search/test_nbtree_search.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/htup_details.h"
+#include "access/nbtree.h"
+#include "access/relscan.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "catalog/pg_am_d.h"
+#include "catalog/pg_type_d.h"
+#include "common/pg_prng.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(nbtree_point_lookups);
+
+/*
+ * Convert a lookup key to a Datum of the type of the index column, or raise
+ * an error if it does not fit.
+ */
+static Datum
+key_to_datum(Oid typid, int64 key)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			if (key < PG_INT16_MIN || key > PG_INT16_MAX)
+				break;
+			return Int16GetDatum((int16) key);
+		case INT4OID:
+			if (key < PG_INT32_MIN || key > PG_INT32_MAX)
+				break;
+			return Int32GetDatum((int32) key);
+		case INT8OID:
+			return Int64GetDatum(key);
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+			 errmsg("key " INT64_FORMAT " is out of range for type %s",
+					key, format_type_be(typid))));
+	return (Datum) 0;			/* keep compiler quiet */
+}
+
+/*
+ * nbtree_point_lookups(index, nlookups, minkey, maxkey, seed)
+ *
+ * Search a B-tree index whose first column is an integer for "nlookups"
+ * random keys between minkey and maxkey, and report how many index entries
+ * were found and how long the lookups took.  Only the index is read, so this
+ * measures the cost of descending the tree and of searching its pages.
+ */
+Datum
+nbtree_point_lookups(PG_FUNCTION_ARGS)
+{
+	Oid			indexoid = PG_GETARG_OID(0);
+	int64		nlookups = PG_GETARG_INT64(1);
+	int64		minkey = PG_GETARG_INT64(2);
+	int64		maxkey = PG_GETARG_INT64(3);
+	int64		seed = PG_GETARG_INT64(4);
+	TupleDesc	tupdesc;
+	Relation	index;
+	Relation	heap;
+	Oid			typid;
+	Oid			eqop;
+	RegProcedure eqproc;
+	Snapshot	snapshot;
+	IndexScanDesc scan;
+	pg_prng_state prng;
+	instr_time	start_time;
+	instr_time	duration;
+	int64		nfound = 0;
+	double		elapsed_ms;
+	Datum		values[3];
+	bool		nulls[3] = {0};
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (nlookups < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of lookups must not be negative")));
+	if (minkey > maxkey)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("minimum key must not be greater than maximum key")));
+
+	index = index_open(indexoid, AccessShareLock);
+
+	if (index->rd_rel->relam != BTREE_AM_OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a btree index",
+						RelationGetRelationName(index))));
+
+	typid = index->rd_opcintype[0];
+	if (typid != INT2OID && typid != INT4OID && typid != INT8OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("first column of index \"%s\" must be of type smallint, integer or bigint",
+						RelationGetRelationName(index))));
+
+	/* check the range of the keys up front */
+	(void) key_to_datum(typid, minkey);
+	(void) key_to_datum(typid, maxkey);
+
+	eqop = get_opfamily_member(index->rd_opfamily[0], typid, typid,
+							   BTEqualStrategyNumber);
+	if (!OidIsValid(eqop))
+		elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+			 BTEqualStrategyNumber, typid, typid, index->rd_opfamily[0]);
+	eqproc = get_opcode(eqop);
+
+	heap = table_open(index->rd_index->indrelid, AccessShareLock);
+	snapshot = RegisterSnapshot(GetTransactionSnapshot());
+	scan = index_beginscan(heap, index, snapshot, NULL, 1, 0, SO_NONE);
+
+	pg_prng_seed(&prng, (uint64) seed);
+
+	INSTR_TIME_SET_CURRENT(start_time);
+
+	for (int64 i = 0; i < nlookups; i++)
+	{
+		ScanKeyData skey;
+		int64		key;
+
+		CHECK_FOR_INTERRUPTS();
+
+		key = pg_prng_int64_range(&prng, minkey, maxkey);
+		ScanKeyInit(&skey, 1, BTEqualStrategyNumber, eqproc,
+					key_to_datum(typid, key));
+
+		index_rescan(scan, &skey, 1, NULL, 0);
+		while (index_getnext_tid(scan, ForwardScanDirection) != NULL)
+			nfound++;
+	}
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, start_time);
+
+	index_endscan(scan);
+	UnregisterSnapshot(snapshot);
+	table_close(heap, AccessShareLock);
+	index_close(index, AccessShareLock);
+
+	elapsed_ms = INSTR_TIME_GET_MILLISEC(duration);
+
+	values[0] = Int64GetDatum(nfound);
+	values[1] = Float8GetDatum(elapsed_ms);
+	if (elapsed_ms > 0)
+		values[2] = Float8GetDatum(nlookups * 1000.0 / elapsed_ms);
+	else
+		nulls[2] = true;
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -0,0 +1,79 @@
+CREATE EXTENSION test_tuple_deform;
+
+--
+-- test_tuple_deform() raises an error if the different ways of deforming
+-- the tuples of a table disagree, otherwise it returns the number of tuples
+-- checked.
+--
+
+-- Leading run of 8-byte attributes, all NOT NULL
+CREATE TABLE deform_int8 (a int8 NOT NULL, b int8 NOT NULL, c float8 NOT NULL,
+						  d timestamp NOT NULL, e text);
+INSERT INTO deform_int8
+  SELECT g, -g, g / 3.0, '2000-01-01'::timestamp + g * interval '1 hour',
+		 CASE WHEN g % 3 = 0 THEN NULL ELSE repeat('x', g % 10) END
+  FROM generate_series(1, 1000) g;
+SELECT test_tuple_deform('deform_int8');
+
+-- Leading run of 4-byte attributes, nullable, including negative values
+CREATE TABLE deform_int4 (a int4, b int4, c float4, d date, e int4, f int2);
+INSERT INTO deform_int4
+  SELECT CASE WHEN g % 7 = 0 THEN NULL ELSE -g END, g * 1000, g / 7.0,
+		 '2000-01-01'::date + g,
+		 CASE WHEN g % 5 = 0 THEN NULL ELSE g END, g % 100
+  FROM generate_series(1, 1000) g;
+SELECT test_tuple_deform('deform_int4');
+
+-- Alignment padding ends the uniform run after the first attribute
+CREATE TABLE deform_mixed (a int4 NOT NULL, b int8 NOT NULL, c int4, d text,
+						   e int8);
+INSERT INTO deform_mixed
+  SELECT g, g * 10, CASE WHEN g % 2 = 0 THEN NULL ELSE g END, g::text, g
+  FROM generate_series(1, 1000) g;
+SELECT test_tuple_deform('deform_mixed');
+
+-- Wide tables with NULLs at varying positions of a long null bitmap
+DO $$
+BEGIN
+  EXECUTE 'CREATE TABLE deform_wide (' ||
+	(SELECT string_agg(format('c%s int4', i), ', ' ORDER BY i)
+	 FROM generate_series(1, 300) i) || ')';
+  EXECUTE 'INSERT INTO deform_wide SELECT ' ||
+	(SELECT string_agg(format('CASE WHEN g = %s OR (g > 300 AND (g + %s) %% 53 = 0) THEN NULL ELSE g * %s END',
+							  i, i, i), ', ' ORDER BY i)
+	 FROM generate_series(1, 300) i) ||
+	' FROM generate_series(1, 400) g';
+  EXECUTE 'CREATE TABLE deform_wide8 (' ||
+	(SELECT string_agg(format('c%s int8', i), ', ' ORDER BY i)
+	 FROM generate_series(1, 200) i) || ')';
+  EXECUTE 'INSERT INTO deform_wide8 SELECT ' ||
+	(SELECT string_agg(format('CASE WHEN g = %s THEN NULL ELSE g * %s END',
+							  i, i), ', ' ORDER BY i)
+	 FROM generate_series(1, 200) i) ||
+	' FROM generate_series(1, 250) g';
+END
+$$;
+SELECT test_tuple_deform('deform_wide');
+SELECT test_tuple_deform('deform_wide8');
+
+-- Attributes missing from older tuples, and dropped attributes
+CREATE TABLE deform_alter (a int8 NOT NULL, b int8 NOT NULL, c int8);
+INSERT INTO deform_alter SELECT g, g, g FROM generate_series(1, 100) g;
+ALTER TABLE deform_alter ADD COLUMN d int8 NOT NULL DEFAULT 42;
+ALTER TABLE deform_alter ADD COLUMN e text DEFAULT 'missing';
+INSERT INTO deform_alter SELECT g, g, NULL, g, g::text
+  FROM generate_series(101, 200) g;
+SELECT test_tuple_deform('deform_alter');
+ALTER TABLE deform_alter DROP COLUMN b;
+SELECT test_tuple_deform('deform_alter');
+
+--
+-- The benchmark's timings vary, so just check that each method runs.
+--
+SELECT bench_tuple_deform('deform_int8', m, 2) >= 0 AS ok
+  FROM unnest(ARRAY['slot', 'heap_deform_tuple', 'naive']) m;
+SELECT bench_tuple_deform('deform_int8', 'simd', 1);
+SELECT bench_tuple_deform('deform_int8', 'slot', 0);
+
+DROP TABLE deform_int8, deform_int4, deform_mixed, deform_wide, deform_wide8,
+  deform_alter;
@@ -0,0 +1,13 @@
+/* src/test/modules/test_tuple_deform/test_tuple_deform--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_tuple_deform" to load this file. \quit
+
+CREATE FUNCTION test_tuple_deform(rel regclass)
+	RETURNS pg_catalog.int8
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+
+CREATE FUNCTION bench_tuple_deform(rel regclass, method text,
+								   loops int4 DEFAULT 10)
+	RETURNS pg_catalog.float8
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
@@ -0,0 +1,275 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_tuple_deform.c
+ *		Test correctness and measure the speed of tuple deforming.
+ *
+ * test_tuple_deform() deforms every tuple of a relation through a heap
+ * tuple slot, both in one go and one attribute at a time, and checks that
+ * the result matches heap_deform_tuple() and a naive reference loop.
+ *
+ * bench_tuple_deform() is a microbenchmark: it loads all the tuples of a
+ * relation into memory and then deforms them repeatedly with the chosen
+ * method, returning the elapsed time in milliseconds.
+ *
+ * Copyright (c) 2026, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_tuple_deform/test_tuple_deform.c
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+PG_MODULE_MAGIC;
+
+typedef enum DeformMethod
+{
+	DEFORM_SLOT,				/* slot_getallattrs() on a heap tuple slot */
+	DEFORM_HEAP,				/* heap_deform_tuple() */
+	DEFORM_NAIVE,				/* one attribute at a time, no shortcuts */
+} DeformMethod;
+
+/*
+ * Read all visible tuples of 'rel' into memory.
+ */
+static HeapTuple *
+fetch_tuples(Relation rel, int *ntuples)
+{
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	HeapTuple  *tuples;
+	int			maxtuples = 1024;
+	int			n = 0;
+
+	tuples = palloc_array(HeapTuple, maxtuples);
+	slot = table_slot_create(rel, NULL);
+	scan = table_beginscan(rel, GetActiveSnapshot(), 0, NULL, SO_NONE);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		if (n == maxtuples)
+		{
+			maxtuples *= 2;
+			tuples = repalloc_array(tuples, HeapTuple, maxtuples);
+		}
+		tuples[n++] = ExecCopySlotHeapTuple(slot);
+	}
+
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	*ntuples = n;
+	return tuples;
+}
+
+/*
+ * Deform 'tuple' the way it was done before the bulk and SIMD paths existed:
+ * test each attribute's null bit separately and fetch it at an offset
+ * computed from the previous attribute.  Attributes that the tuple doesn't
+ * have are set to NULL.
+ */
+static void
+deform_naive(HeapTuple tuple, TupleDesc tupdesc, Datum *values, bool *isnull)
+{
+	HeapTupleHeader tup = tuple->t_data;
+	bool		hasnulls = HeapTupleHasNulls(tuple);
+	int			natts = Min(HeapTupleHeaderGetNatts(tup), tupdesc->natts);
+	char	   *tp = (char *) tup + tup->t_hoff;
+	uint32		off = 0;
+	int			attnum;
+
+	for (attnum = 0; attnum < natts; attnum++)
+	{
+		CompactAttribute *cattr = TupleDescCompactAttr(tupdesc, attnum);
+
+		if (hasnulls && att_isnull(attnum, tup->t_bits))
+		{
+			values[attnum] = (Datum) 0;
+			isnull[attnum] = true;
+			continue;
+		}
+
+		isnull[attnum] = false;
+		values[attnum] = align_fetch_then_add(tp, &off, cattr->attbyval,
+											  cattr->attlen,
+											  cattr->attalignby);
+	}
+
+	for (; attnum < tupdesc->natts; attnum++)
+	{
+		values[attnum] = (Datum) 0;
+		isnull[attnum] = true;
+	}
+}
+
+/*
+ * Raise an error if the first natts values/isnull pairs differ.
+ */
+static void
+compare_deformed(TupleDesc tupdesc, int natts, const char *what,
+				 Datum *values1, bool *isnull1,
+				 Datum *values2, bool *isnull2)
+{
+	for (int i = 0; i < natts; i++)
+	{
+		CompactAttribute *cattr = TupleDescCompactAttr(tupdesc, i);
+
+		if (isnull1[i] != isnull2[i])
+			elog(ERROR, "%s: null flag mismatch for attribute %d", what, i + 1);
+		if (!isnull1[i] &&
+			!datumIsEqual(values1[i], values2[i], cattr->attbyval,
+						  cattr->attlen))
+			elog(ERROR, "%s: value mismatch for attribute %d", what, i + 1);
+	}
+}
+
+PG_FUNCTION_INFO_V1(test_tuple_deform);
+Datum
+test_tuple_deform(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	Relation	rel;
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	HeapTuple  *tuples;
+	int			ntuples;
+	Datum	   *values;
+	bool	   *isnull;
+	Datum	   *ref_values;
+	bool	   *ref_isnull;
+
+	rel = table_open(relid, AccessShareLock);
+	tupdesc = RelationGetDescr(rel);
+	tuples = fetch_tuples(rel, &ntuples);
+
+	slot = MakeTupleTableSlot(tupdesc, &TTSOpsHeapTuple,
+							  TTS_FLAG_OBEYS_NOT_NULL_CONSTRAINTS);
+	values = palloc_array(Datum, tupdesc->natts);
+	isnull = palloc_array(bool, tupdesc->natts);
+	ref_values = palloc_array(Datum, tupdesc->natts);
+	ref_isnull = palloc_array(bool, tupdesc->natts);
+
+	for (int i = 0; i < ntuples; i++)
+	{
+		HeapTuple	tuple = tuples[i];
+		int			natts = Min(HeapTupleHeaderGetNatts(tuple->t_data),
+								tupdesc->natts);
+
+		heap_deform_tuple(tuple, tupdesc, ref_values, ref_isnull);
+
+		/* All attributes at once */
+		ExecStoreHeapTuple(tuple, slot, false);
+		slot_getallattrs(slot);
+		compare_deformed(tupdesc, tupdesc->natts, "slot_getallattrs",
+						 slot->tts_values, slot->tts_isnull,
+						 ref_values, ref_isnull);
+
+		/* Incrementally, one attribute at a time */
+		ExecStoreHeapTuple(tuple, slot, false);
+		for (int attnum = 1; attnum <= tupdesc->natts; attnum++)
+			slot_getsomeattrs(slot, attnum);
+		compare_deformed(tupdesc, tupdesc->natts, "slot_getsomeattrs",
+						 slot->tts_values, slot->tts_isnull,
+						 ref_values, ref_isnull);
+
+		/* The naive loop doesn't know about missing attributes */
+		deform_naive(tuple, tupdesc, values, isnull);
+		compare_deformed(tupdesc, natts, "naive deform",
+						 values, isnull, ref_values, ref_isnull);
+	}
+
+	ExecDropSingleTupleTableSlot(slot);
+	table_close(rel, AccessShareLock);
+
+	PG_RETURN_INT64(ntuples);
+}
+
+PG_FUNCTION_INFO_V1(bench_tuple_deform);
+Datum
+bench_tuple_deform(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	char	   *methodstr = text_to_cstring(PG_GETARG_TEXT_PP(1));
+	int32		loops = PG_GETARG_INT32(2);
+	DeformMethod method;
+	Relation	rel;
+	TupleDesc	tupdesc;
+	TupleTableSlot *slot;
+	HeapTuple  *tuples;
+	int			ntuples;
+	Datum	   *values;
+	bool	   *isnull;
+	instr_time	start_time;
+	instr_time	elapsed;
+
+	if (strcmp(methodstr, "slot") == 0)
+		method = DEFORM_SLOT;
+	else if (strcmp(methodstr, "heap_deform_tuple") == 0)
+		method = DEFORM_HEAP;
+	else if (strcmp(methodstr, "naive") == 0)
+		method = DEFORM_NAIVE;
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unrecognized deform method \"%s\"", methodstr),
+				 errhint("Valid methods are \"slot\", \"heap_deform_tuple\" and \"naive\".")));
+
+	if (loops <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of loops must be positive")));
+
+	rel = table_open(relid, AccessShareLock);
+	tupdesc = RelationGetDescr(rel);
+	tuples = fetch_tuples(rel, &ntuples);
+
+	slot = MakeTupleTableSlot(tupdesc, &TTSOpsHeapTuple,
+							  TTS_FLAG_OBEYS_NOT_NULL_CONSTRAINTS);
+	values = palloc_array(Datum, tupdesc->natts);
+	isnull = palloc_array(bool, tupdesc->natts);
+
+	INSTR_TIME_SET_CURRENT(start_time);
+
+	for (int loop = 0; loop < loops; loop++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		for (int i = 0; i < ntuples; i++)
+		{
+			switch (method)
+			{
+				case DEFORM_SLOT:
+					ExecStoreHeapTuple(tuples[i], slot, false);
+					slot_getallattrs(slot);
+					break;
+				case DEFORM_HEAP:
+					heap_deform_tuple(tuples[i], tupdesc, values, isnull);
+					break;
+				case DEFORM_NAIVE:
+					deform_naive(tuples[i], tupdesc, values, isnull);
+					break;
+			}
+		}
+	}
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start_time);
+
+	ExecDropSingleTupleTableSlot(slot);
+	table_close(rel, AccessShareLock);
+
+	PG_RETURN_FLOAT8(INSTR_TIME_GET_MILLISEC(elapsed));
+}
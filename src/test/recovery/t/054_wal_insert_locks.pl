@@ -0,0 +1,119 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test WAL insertion with non-default numbers of WAL insertion locks.
+#
+# Concurrent inserters hand the start of the previous record over to each
+# other, see ReserveXLogInsertLocation().  Generate WAL with many concurrent
+# sessions, then check that the prev-links of all records are correct, by
+# reading the WAL back with pg_waldump, and by replaying it on a standby and
+# after a crash.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+foreach my $locks (1, 64)
+{
+	my $primary = PostgreSQL::Test::Cluster->new("primary_$locks");
+
+	# Small segments make the WAL switches done by the workload cheap
+	$primary->init(allows_streaming => 1, extra => ['--wal-segsize=1']);
+	$primary->append_conf(
+		'postgresql.conf', qq(
+wal_insert_locks = $locks
+max_connections = 30
+wal_keep_size = 256MB
+));
+	$primary->start;
+
+	is($primary->safe_psql('postgres', 'SHOW wal_insert_locks'),
+		$locks, "wal_insert_locks is $locks");
+
+	$primary->safe_psql('postgres',
+		'CREATE TABLE test (id serial PRIMARY KEY, payload text)');
+
+	$primary->backup('backup');
+	my $standby = PostgreSQL::Test::Cluster->new("standby_$locks");
+	$standby->init_from_backup($primary, 'backup', has_streaming => 1);
+	$standby->start;
+
+	my $start_lsn =
+	  $primary->safe_psql('postgres', 'SELECT pg_current_wal_insert_lsn()');
+
+	# Mix records of different sizes, with the occasional WAL switch, which
+	# reserves WAL differently.
+	my %scripts = (
+		"054_insert_$locks\@100" => q{
+INSERT INTO test (payload)
+  SELECT repeat('x', (random() * 500)::int)
+  FROM generate_series(1, 1 + (random() * 3)::int);
+},
+		"054_update_$locks\@100" => q{
+\set id random(1, 1000)
+UPDATE test SET payload = payload || 'y' WHERE id = :id;
+},
+		"054_switch_$locks\@1" => q{
+SELECT pg_switch_wal();
+});
+
+	$primary->pgbench(
+		'--no-vacuum --client=24 --jobs=4 --transactions=400',
+		0,
+		[qr{processed: 9600/9600}],
+		[qr{^$}],
+		"concurrent WAL insertions with $locks WAL insertion locks",
+		\%scripts);
+
+	my $end_lsn = $primary->safe_psql('postgres', 'SELECT pg_switch_wal()');
+
+	command_ok(
+		[
+			'pg_waldump', '--quiet',
+			'--path' => $primary->data_dir . '/pg_wal',
+			'--start' => $start_lsn,
+			'--end' => $end_lsn,
+		],
+		"pg_waldump reads WAL inserted with $locks WAL insertion locks");
+
+	my $count = $primary->safe_psql('postgres', 'SELECT count(*) FROM test');
+
+	$primary->wait_for_catchup($standby);
+	is($standby->safe_psql('postgres', 'SELECT count(*) FROM test'),
+		$count, "standby replayed WAL inserted with $locks locks");
+
+	# Crash, and insert some more WAL after crash recovery, which continues
+	# from the prev-link of the last replayed record.
+	$primary->stop('immediate');
+	$primary->start;
+
+	is($primary->safe_psql('postgres', 'SELECT count(*) FROM test'),
+		$count, "crash recovery replayed WAL inserted with $locks locks");
+
+	$primary->pgbench(
+		'--no-vacuum --client=8 --transactions=100',
+		0,
+		[qr{processed: 800/800}],
+		[qr{^$}],
+		"concurrent WAL insertions after crash recovery with $locks locks",
+		{
+			"054_insert_after_crash_$locks" =>
+			  q{INSERT INTO test (payload) VALUES (repeat('z', 100));}
+		});
+
+	$end_lsn = $primary->safe_psql('postgres', 'SELECT pg_switch_wal()');
+
+	command_ok(
+		[
+			'pg_waldump', '--quiet',
+			'--path' => $primary->data_dir . '/pg_wal',
+			'--start' => $start_lsn,
+			'--end' => $end_lsn,
+		],
+		"pg_waldump reads WAL across crash recovery with $locks locks");
+
+	$standby->stop;
+	$primary->stop;
+}
+
+done_testing();
@@ -0,0 +1,94 @@
+# Copyright (c) 2026, PostgreSQL Global Development Group
+
+# Test crash recovery of compressed relations.
+#
+# A compressed page is written to the data file first, and its address to
+# the address map after that.  Crash between the two writes of a page that
+# only had hint bits set, and check that crash recovery restores the page
+# from the full-page image that WAL-logging the hint bits produced.
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+if ($ENV{enable_injection_points} ne 'yes')
+{
+	plan skip_all => 'Injection points not supported by this build';
+}
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init(no_data_checksums => 1);
+$node->append_conf(
+	'postgresql.conf', q[
+autovacuum = off
+bgwriter_lru_maxpages = 0
+wal_log_hints = off
+]);
+$node->start;
+
+if (!$node->check_extension('injection_points'))
+{
+	plan skip_all => 'Extension injection_points not installed';
+}
+
+# Without checksums, hint bit updates have to be WAL-logged explicitly.
+my ($ret, $stdout, $stderr) = $node->psql('postgres',
+	'CREATE TABLE pc_test (i int, t text) WITH (page_compression = pglz)');
+like(
+	$stderr,
+	qr/page compression requires data checksums or "wal_log_hints" to be enabled/,
+	'page compression is rejected without WAL-logged hint bits');
+
+$node->append_conf('postgresql.conf', 'wal_log_hints = on');
+$node->restart;
+
+$node->safe_psql('postgres', 'CREATE EXTENSION injection_points');
+$node->safe_psql(
+	'postgres', q[
+	CREATE TABLE pc_test (i int, t text) WITH (page_compression = pglz);
+	INSERT INTO pc_test
+	  SELECT g, repeat(md5(g::text), 10) FROM generate_series(1, 2000) g;
+	CHECKPOINT;]);
+
+my $expected = $node->safe_psql('postgres',
+	'SELECT count(*), sum(i), sum(length(t)) FROM pc_test');
+
+# The scan above set hint bits, which changes the compressed images of the
+# pages without changing their contents otherwise.  Make the checkpointer
+# stop after writing the first of them, before updating the address map,
+# and crash there.
+$node->safe_psql('postgres',
+	"SELECT injection_points_attach('page-compression-before-map-write', 'wait')"
+);
+
+my $checkpoint = $node->background_psql('postgres', on_error_stop => 0);
+$checkpoint->query_until(
+	qr/starting_checkpoint/, q(
+	\echo starting_checkpoint
+	CHECKPOINT;
+));
+
+$node->wait_for_event('checkpointer', 'page-compression-before-map-write');
+
+$node->stop('immediate');
+$checkpoint->quit;
+$node->start;
+
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(i), sum(length(t)) FROM pc_test'),
+	$expected,
+	'compressed pages are intact after crash between data and map writes');
+
+# Write the pages recovery restored, and read them back from disk.
+$node->safe_psql('postgres', 'CHECKPOINT');
+$node->restart;
+
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(i), sum(length(t)) FROM pc_test'),
+	$expected,
+	'compressed pages are intact after rewriting them');
+
+$node->stop;
+
+done_testing();
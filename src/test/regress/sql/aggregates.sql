@@ -1798,3 +1798,59 @@ drop table agg_hash_1;
 drop table agg_hash_2;
 drop table agg_hash_3;
 drop table agg_hash_4;
+
+--
+-- Test batch-at-a-time execution of plain aggregates over a seqscan
+--
+create temp table batch_agg (i2 int2, i4 int4, i8 int8, f4 float4, f8 float8, t text);
+insert into batch_agg
+  select g % 100, g, g * 10000000000, g / 4.0, g / 2.0, g::text
+  from generate_series(1, 3000) g;
+insert into batch_agg values (null, null, null, null, null, null);
+insert into batch_agg values (0, 0, 0, 'NaN', 'NaN', 'NaN');
+
+select count(*), count(i4), sum(i2), sum(i4), min(i8), max(i8) from batch_agg;
+select count(*), sum(i2), sum(i4), avg(i4), min(i8), max(i8)
+  from batch_agg where i4 > 1000 and i2 < 50;
+select count(f4), min(f4), max(f8), sum(i4) from batch_agg where 5 = i2;
+select count(*) from batch_agg where i4 is null;
+select count(*) from batch_agg where f8 is not null and f8 > 1400;
+select count(*), sum(i4), max(f8) from batch_agg where i4 < 0;
+select count(*) from batch_agg where i4 < 0 having count(*) > 0;
+-- these can't use batch mode
+select count(*), sum(i8) from batch_agg where t like '2%';
+select count(*), sum(i4 + 1) from batch_agg where i4 > 2000;
+
+-- Compare batch mode results to row mode results
+
+create temp table batch_agg_on as
+select count(f8) as c1, sum(f4) as c2, sum(f8) as c3, avg(f4) as c4,
+       avg(f8) as c5, stddev(f8) as c6, min(f4) as c7, max(f4) as c8,
+       min(f8) as c9, max(f8) as c10, avg(i2) as c11, avg(i4) as c12
+  from batch_agg where f8 >= 10
+union all
+select count(f8), sum(f4), sum(f8), avg(f4), avg(f8), stddev(f8),
+       min(f4), max(f4), min(f8), max(f8), avg(i2), avg(i4)
+  from batch_agg where f8 < 1000 and i2 <> 7;
+
+set enable_batch_execution = off;
+
+create temp table batch_agg_off as
+select count(f8) as c1, sum(f4) as c2, sum(f8) as c3, avg(f4) as c4,
+       avg(f8) as c5, stddev(f8) as c6, min(f4) as c7, max(f4) as c8,
+       min(f8) as c9, max(f8) as c10, avg(i2) as c11, avg(i4) as c12
+  from batch_agg where f8 >= 10
+union all
+select count(f8), sum(f4), sum(f8), avg(f4), avg(f8), stddev(f8),
+       min(f4), max(f4), min(f8), max(f8), avg(i2), avg(i4)
+  from batch_agg where f8 < 1000 and i2 <> 7;
+
+reset enable_batch_execution;
+
+(select * from batch_agg_on except select * from batch_agg_off)
+  union all
+(select * from batch_agg_off except select * from batch_agg_on);
+
+drop table batch_agg_on;
+drop table batch_agg_off;
+drop table batch_agg;
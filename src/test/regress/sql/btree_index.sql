@@ -438,3 +438,91 @@ CREATE TABLE btree_part (id int4) PARTITION BY RANGE (id);
 CREATE INDEX btree_part_idx ON btree_part(id);
 ALTER INDEX btree_part_idx ALTER COLUMN id SET (n_distinct=100);
 DROP TABLE btree_part;
+
+-- Test index scans reading ahead in the table, including changes of scan
+-- direction and leaf page boundaries
+CREATE TABLE btree_prefetch (id int4, filler text);
+INSERT INTO btree_prefetch
+  SELECT (i * 7919) % 5000, repeat('x', 100) FROM generate_series(0, 4999) i;
+CREATE INDEX btree_prefetch_idx ON btree_prefetch (id);
+VACUUM ANALYZE btree_prefetch;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_indexonlyscan = off;
+SELECT count(*), sum(id) FROM btree_prefetch WHERE id BETWEEN 100 AND 3999;
+BEGIN;
+DECLARE c SCROLL CURSOR FOR
+  SELECT id FROM btree_prefetch WHERE id >= 1000 ORDER BY id;
+FETCH FORWARD 3 FROM c;
+FETCH BACKWARD 2 FROM c;
+MOVE FORWARD 1500 IN c;
+FETCH BACKWARD 3 FROM c;
+FETCH FORWARD 2 FROM c;
+COMMIT;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_indexonlyscan;
+DROP TABLE btree_prefetch;
+
+-- Test binary searches on composite keys, which skip the key attributes
+-- that both ends of the search range are known to be equal to.  Insert in
+-- an order that makes most insertions land in the middle of leaf pages, so
+-- that they reuse the bounds saved by the uniqueness check, and split pages
+-- with pivot tuples truncated to one or two attributes.
+CREATE TABLE btree_prefix (a int4, b int4, c int4);
+CREATE UNIQUE INDEX btree_prefix_idx ON btree_prefix (a, b, c);
+INSERT INTO btree_prefix
+  SELECT j % 10, j / 10 % 100, j
+  FROM (SELECT (i * 7919) % 30011 AS j FROM generate_series(0, 30010) i) s;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_indexonlyscan = off;
+EXPLAIN (COSTS OFF)
+SELECT c FROM btree_prefix WHERE a = 3 AND b = 42;
+SELECT count(*), min(c), max(c) FROM btree_prefix WHERE a = 3 AND b = 42;
+SELECT count(*), sum(c) FROM btree_prefix
+  WHERE a = 3 AND b BETWEEN 40 AND 59 AND c > 15000;
+SELECT a, b, c FROM btree_prefix WHERE a = 7 AND b > 97
+  ORDER BY a, b, c LIMIT 3;
+SELECT a, b, c FROM btree_prefix WHERE (a, b) < (5, 0)
+  ORDER BY a DESC, b DESC, c DESC LIMIT 3;
+-- Every key is found again, both by the uniqueness check and by a scan
+INSERT INTO btree_prefix VALUES (4, 71, 12714);
+WITH ins AS (
+  INSERT INTO btree_prefix SELECT * FROM btree_prefix
+  ON CONFLICT DO NOTHING RETURNING *)
+SELECT count(*) FROM ins;
+
+-- The same with descending columns and NULLs, sorted first and last
+CREATE TABLE btree_prefix_desc (a int4, b int4, c int4);
+CREATE UNIQUE INDEX btree_prefix_desc_idx
+  ON btree_prefix_desc (a DESC NULLS LAST, b NULLS FIRST, c DESC);
+INSERT INTO btree_prefix_desc
+  SELECT nullif(j % 11, 10), nullif(j / 11 % 50, 0), j
+  FROM (SELECT (i * 7919) % 30011 AS j FROM generate_series(0, 30010) i) s;
+SELECT count(*), min(c), max(c) FROM btree_prefix_desc WHERE a = 4 AND b = 17;
+SELECT count(*), min(c), max(c) FROM btree_prefix_desc
+  WHERE a IS NULL AND b = 17;
+SELECT count(*), min(c), max(c) FROM btree_prefix_desc
+  WHERE a = 4 AND b IS NULL;
+SELECT count(*), min(c), max(c) FROM btree_prefix_desc
+  WHERE a IS NULL AND b IS NULL;
+SELECT count(*), min(c), max(c) FROM btree_prefix_desc
+  WHERE a > 8 AND b >= 49;
+SELECT a, b, c FROM btree_prefix_desc WHERE a = 6
+  ORDER BY a DESC NULLS LAST, b NULLS FIRST, c DESC LIMIT 3;
+EXPLAIN (COSTS OFF)
+SELECT a, b, c FROM btree_prefix_desc WHERE a <= 1
+  ORDER BY a NULLS FIRST, b DESC NULLS LAST, c LIMIT 3;
+SELECT a, b, c FROM btree_prefix_desc WHERE a <= 1
+  ORDER BY a NULLS FIRST, b DESC NULLS LAST, c LIMIT 3;
+INSERT INTO btree_prefix_desc VALUES (9, 5, 12714);
+-- Keys with NULLs never conflict
+WITH ins AS (
+  INSERT INTO btree_prefix_desc SELECT * FROM btree_prefix_desc
+  ON CONFLICT DO NOTHING RETURNING *)
+SELECT count(*) FROM ins;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_indexonlyscan;
+DROP TABLE btree_prefix, btree_prefix_desc;
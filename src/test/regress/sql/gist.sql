@@ -180,6 +180,31 @@ reset enable_indexonlyscan;
 
 drop table gist_tbl;
 
+-- test a parallel sorted build, and check that a full scan of the index, in
+-- order of distance, returns the rows that a sequential scan does
+create table gist_parallel_tbl with (parallel_workers = 2) as
+  select point(i % 100, i / 100) as p from generate_series(0, 9999) as i;
+create temp table gist_parallel_expected as
+  select p[0] as x, p[1] as y from gist_parallel_tbl;
+begin;
+set local client_min_messages = debug1;
+set local max_parallel_maintenance_workers = 2;
+create index gist_parallel_idx on gist_parallel_tbl using gist (p);
+commit;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+with found as materialized (
+  select p[0] as x, p[1] as y from gist_parallel_tbl
+  order by p <-> point(0, 0))
+select (select count(*) from found) as found,
+       (select count(*) from
+          (table found except all table gist_parallel_expected) s) as extra,
+       (select count(*) from
+          (table gist_parallel_expected except all table found) s) as missing;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table gist_parallel_tbl, gist_parallel_expected;
+
 -- test an unlogged table, mostly to get coverage of gistbuildempty
 create unlogged table gist_tbl (b box);
 create index gist_tbl_box_index on gist_tbl using gist (b);
@@ -351,3 +351,25 @@ CREATE INDEX hash_f8_index2 ON hash_f8_heap USING hash (random float8_ops)
 	WITH (fillfactor=9);
 CREATE INDEX hash_f8_index2 ON hash_f8_heap USING hash (random float8_ops)
 	WITH (fillfactor=101);
+
+-- Test parallel build.  Every key must lead to the rows that a sequential
+-- scan counted before the index existed.
+CREATE TABLE hash_parallel_heap (x int) WITH (parallel_workers = 2);
+INSERT INTO hash_parallel_heap SELECT i % 1000 FROM generate_series(1, 10000) i;
+CREATE TEMP TABLE hash_parallel_expected AS
+  SELECT x, count(*) AS n FROM hash_parallel_heap GROUP BY x;
+BEGIN;
+SET LOCAL client_min_messages = debug1;
+SET LOCAL max_parallel_maintenance_workers = 2;
+CREATE INDEX hash_parallel_idx ON hash_parallel_heap USING hash (x);
+COMMIT;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM hash_parallel_heap WHERE x = 42;
+SELECT count(*) FROM hash_parallel_expected e
+  WHERE (SELECT count(*) FROM hash_parallel_heap h WHERE h.x = e.x) <> e.n;
+SELECT count(*) FROM hash_parallel_heap WHERE x = 1000;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE hash_parallel_heap, hash_parallel_expected;
@@ -3891,3 +3891,109 @@ SELECT COUNT(*) FROM onek t1 LEFT JOIN tenk1 t2
     ON (t2.thousand = t1.tenthous OR t2.thousand = t1.thousand);
 SELECT COUNT(*) FROM onek t1 LEFT JOIN tenk1 t2
     ON (t2.thousand = t1.tenthous OR t2.thousand = t1.thousand);
+
+--
+-- Test adaptive nested loops, which switch to a hash table once the outer
+-- side returns more rows than the planner expected
+--
+
+create function adaptive_rows(n int) returns setof int
+language plpgsql rows 5 as
+$$ begin return query select generate_series(1, n); end $$;
+
+-- The switch point and row counts depend on the cost model, so hide numbers
+create function explain_adaptive(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off, buffers off) %s',
+            query)
+    loop
+        ln := regexp_replace(ln, '\m\d+(\.\d+)?', 'N', 'g');
+        return next ln;
+    end loop;
+end;
+$$;
+
+set enable_adaptive_join = on;
+set enable_memoize = off;
+
+select explain_adaptive('
+select count(*), sum(t.hundred) from adaptive_rows(1000) r
+  join tenk1 t on t.unique1 = r');
+select count(*), sum(t.hundred) from adaptive_rows(1000) r
+  join tenk1 t on t.unique1 = r;
+
+-- check that unmatched outer rows are handled after the switch
+select count(*), count(t.unique1) from adaptive_rows(12000) r
+  left join tenk1 t on t.unique1 = r;
+select count(*) from adaptive_rows(12000) r
+  where not exists (select 1 from tenk1 t where t.unique1 = r);
+
+reset enable_adaptive_join;
+reset enable_memoize;
+drop function explain_adaptive(text);
+drop function adaptive_rows(int);
+
+--
+-- Test Bloom filters passed down from hash joins to the scans on their
+-- outer side
+--
+
+-- The row counts depend on the false positive rate, so hide numbers
+create function explain_bloom(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off, buffers off) %s',
+            query)
+    loop
+        ln := regexp_replace(ln, '\m\d+(\.\d+)?', 'N', 'g');
+        return next ln;
+    end loop;
+end;
+$$;
+
+set enable_hashjoin_bloom_filter = on;
+set enable_nestloop = off;
+set enable_mergejoin = off;
+set enable_indexscan = off;
+set enable_bitmapscan = off;
+
+select explain_bloom('
+select count(*), sum(t.hundred) from tenk1 t
+  join int4_tbl i on t.unique1 = i.f1');
+select count(*), sum(t.hundred) from tenk1 t
+  join int4_tbl i on t.unique1 = i.f1;
+
+-- the filter is passed on to parallel workers through Gather
+create temp table bloom_keys as select * from generate_series(1, 10) k;
+analyze bloom_keys;
+set parallel_setup_cost = 0;
+set parallel_tuple_cost = 0;
+set min_parallel_table_scan_size = 0;
+set max_parallel_workers_per_gather = 2;
+
+explain (costs off)
+select count(*), sum(t.unique1) from tenk1 t
+  join bloom_keys b on t.unique1 = b.k;
+select count(*), sum(t.unique1) from tenk1 t
+  join bloom_keys b on t.unique1 = b.k;
+
+reset parallel_setup_cost;
+reset parallel_tuple_cost;
+reset min_parallel_table_scan_size;
+reset max_parallel_workers_per_gather;
+reset enable_hashjoin_bloom_filter;
+reset enable_nestloop;
+reset enable_mergejoin;
+reset enable_indexscan;
+reset enable_bitmapscan;
+drop table bloom_keys;
+drop function explain_bloom(text);
@@ -0,0 +1,76 @@
+--
+-- PARTITION_WINDOW
+-- Test partitionwise evaluation of window functions on partitioned tables
+--
+-- Note: to ensure plan stability, it's a good idea to make the partitions of
+-- any one partitioned table in this test all have different numbers of rows.
+--
+
+-- Enable partitionwise window evaluation, which by default is disabled.
+SET enable_partitionwise_window TO true;
+-- Disable parallel plans.
+SET max_parallel_workers_per_gather TO 0;
+-- Disable incremental sort, which can influence selected plans due to fuzz factor.
+SET enable_incremental_sort TO off;
+
+CREATE TABLE pwin_tab (a int, b int, c int) PARTITION BY LIST (a);
+CREATE TABLE pwin_tab_p1 PARTITION OF pwin_tab FOR VALUES IN (0, 1, 2, 3);
+CREATE TABLE pwin_tab_p2 PARTITION OF pwin_tab FOR VALUES IN (4, 5, 6);
+CREATE TABLE pwin_tab_p3 PARTITION OF pwin_tab FOR VALUES IN (7, 8);
+INSERT INTO pwin_tab SELECT i % 9, i % 7, i FROM generate_series(0, 2699) i;
+ANALYZE pwin_tab;
+
+-- PARTITION BY includes the partition key; each partition is done separately.
+EXPLAIN (COSTS OFF)
+SELECT a, c, row_number() OVER (PARTITION BY a ORDER BY c) FROM pwin_tab;
+
+-- PARTITION BY doesn't include the partition key; no partitionwise plan.
+EXPLAIN (COSTS OFF)
+SELECT b, c, row_number() OVER (PARTITION BY b ORDER BY c) FROM pwin_tab;
+
+-- Check the results of several windows, all partitioned by the partition key
+-- but sorted differently.
+SELECT a, count(*), sum(rn), sum(rk), sum(s)
+FROM (SELECT a, row_number() OVER (PARTITION BY a ORDER BY c) AS rn,
+			 rank() OVER (PARTITION BY a, b ORDER BY c) AS rk,
+			 sum(c) OVER (PARTITION BY a ORDER BY b, c) AS s
+	  FROM pwin_tab) ss
+GROUP BY a ORDER BY a;
+SET enable_partitionwise_window TO false;
+SELECT a, count(*), sum(rn), sum(rk), sum(s)
+FROM (SELECT a, row_number() OVER (PARTITION BY a ORDER BY c) AS rn,
+			 rank() OVER (PARTITION BY a, b ORDER BY c) AS rk,
+			 sum(c) OVER (PARTITION BY a ORDER BY b, c) AS s
+	  FROM pwin_tab) ss
+GROUP BY a ORDER BY a;
+SET enable_partitionwise_window TO true;
+
+-- A run condition on a window function is checked within each partition.
+SELECT a, c, rn
+FROM (SELECT a, c, row_number() OVER (PARTITION BY a ORDER BY c DESC) AS rn
+	  FROM pwin_tab) ss
+WHERE rn <= 2 ORDER BY a, rn;
+
+-- Parallel plans can compute the partitions in different workers.
+SET max_parallel_workers_per_gather TO 2;
+SET parallel_setup_cost TO 0;
+SET parallel_tuple_cost TO 0;
+SET enable_gathermerge TO off;
+
+EXPLAIN (COSTS OFF)
+SELECT a, c, row_number() OVER (PARTITION BY a ORDER BY c) FROM pwin_tab;
+SELECT a, count(*), sum(rn), sum(rk), sum(s)
+FROM (SELECT a, row_number() OVER (PARTITION BY a ORDER BY c) AS rn,
+			 rank() OVER (PARTITION BY a, b ORDER BY c) AS rk,
+			 sum(c) OVER (PARTITION BY a ORDER BY b, c) AS s
+	  FROM pwin_tab) ss
+GROUP BY a ORDER BY a;
+
+RESET enable_gathermerge;
+RESET parallel_tuple_cost;
+RESET parallel_setup_cost;
+RESET max_parallel_workers_per_gather;
+RESET enable_incremental_sort;
+RESET enable_partitionwise_window;
+
+DROP TABLE pwin_tab;
@@ -148,3 +148,26 @@ SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test_idx'::regclass;
 CREATE INDEX reloptions_test_idx3 ON reloptions_test (s);
 ALTER INDEX reloptions_test_idx3 SET (fillfactor=40);
 SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test_idx3'::regclass;
+
+--
+-- Page compression
+--
+
+CREATE TABLE reloptions_compress (i int, t text) WITH (page_compression = pglz);
+INSERT INTO reloptions_compress
+	SELECT g, repeat('x', 100) FROM generate_series(1, 2000) g;
+CREATE INDEX reloptions_compress_idx ON reloptions_compress (i)
+	WITH (page_compression = pglz);
+SET enable_seqscan = off;
+SELECT count(*), sum(i) FROM reloptions_compress WHERE i > 1000;
+RESET enable_seqscan;
+
+-- Rewrites keep the pages compressed
+VACUUM FULL reloptions_compress;
+SELECT count(*), sum(i), min(t) = repeat('x', 100) FROM reloptions_compress;
+TRUNCATE reloptions_compress;
+SELECT count(*) FROM reloptions_compress;
+DROP TABLE reloptions_compress;
+
+-- Fail with an unknown method
+CREATE TABLE reloptions_test2(i INT) WITH (page_compression = snappy);
@@ -344,6 +344,72 @@ reset enable_material;
 
 reset enable_hashagg;
 
+-- test parallel hash aggregation, with an aggregate that can't be split
+-- into partial and final steps
+create function sp_slow_add(int8, int4) returns int8 as
+  $$begin return $1 + $2; end$$ language plpgsql parallel safe cost 1000;
+create aggregate sp_slow_sum(int4) (sfunc = sp_slow_add, stype = int8,
+  initcond = '0', parallel = safe);
+set enable_parallel_hashagg = on;
+
+explain (costs off)
+   select ten, sp_slow_sum(unique1) from tenk1 group by ten;
+
+select ten, sp_slow_sum(unique1) from tenk1 group by ten order by ten;
+
+-- with many groups and little memory, each batch spills
+set work_mem = '64kB';
+select count(*), sum(s) from
+  (select unique1, sp_slow_sum(ten) as s from tenk1 group by unique1) ss;
+reset work_mem;
+
+reset enable_parallel_hashagg;
+drop aggregate sp_slow_sum(int4);
+drop function sp_slow_add(int8, int4);
+
+-- test parallel sort; pretend that writing out the runs is cheap, so that
+-- it pays off with a table this small.  With tuples free to send through
+-- the queues, the participants merge separate key ranges of the runs.
+set enable_parallel_sort = on;
+set seq_page_cost = 0;
+explain (costs off)
+   select ten, unique1 from tenk1 order by ten, unique1;
+select count(*),
+       count(*) filter (where (ten, unique1) <= (pten, punique1)) as out_of_order
+  from (select ten, unique1,
+               lag(ten) over () as pten, lag(unique1) over () as punique1
+          from (select ten, unique1 from tenk1
+                order by ten, unique1 offset 0) s) ss;
+
+-- with the key ranges merged by the workers only, and spilled to disk
+set parallel_leader_participation = off;
+set work_mem = '64kB';
+explain (costs off)
+   select ten, unique1 from tenk1 order by ten, unique1;
+select count(*),
+       count(*) filter (where (ten, unique1) <= (pten, punique1)) as out_of_order
+  from (select ten, unique1,
+               lag(ten) over () as pten, lag(unique1) over () as punique1
+          from (select ten, unique1 from tenk1
+                order by ten, unique1 offset 0) s) ss;
+
+reset work_mem;
+reset parallel_leader_participation;
+-- with the runs merged by the leader, sparing the queues
+set parallel_tuple_cost = 0.1;
+explain (costs off)
+   select ten, unique1 from tenk1 order by ten, unique1;
+select count(*),
+       count(*) filter (where (ten, unique1) <= (pten, punique1)) as out_of_order
+  from (select ten, unique1,
+               lag(ten) over () as pten, lag(unique1) over () as punique1
+          from (select ten, unique1 from tenk1
+                order by ten, unique1 offset 0) s) ss;
+
+set parallel_tuple_cost = 0;
+reset seq_page_cost;
+reset enable_parallel_sort;
+
 -- check parallelized int8 aggregate (bug #14897)
 explain (costs off)
 select avg(unique1::int8) from tenk1;
@@ -81,6 +81,29 @@ explain (costs off)
 select * from spgist_domain_tbl where f1 = 'fo';
 select * from spgist_domain_tbl where f1 = 'fo';
 
+-- test a parallel build, in which the participants insert into the tree
+-- concurrently, and check that each row is in the index exactly once
+create table spgist_parallel_tbl with (parallel_workers = 2) as
+  select point(i % 100, i / 100) as p from generate_series(0, 9999) as i;
+begin;
+set local client_min_messages = debug1;
+set local max_parallel_maintenance_workers = 2;
+create index spgist_parallel_idx on spgist_parallel_tbl using spgist (p);
+commit;
+-- later insertions find their way into the tree that the build left
+insert into spgist_parallel_tbl
+  select point(i % 100 + 0.5, i / 100) from generate_series(0, 999) as i;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*), count(distinct (p[0], p[1])) from spgist_parallel_tbl
+  where p <@ box(point(-1, -1), point(100, 100));
+select count(*) from spgist_parallel_tbl
+  where p <@ box(point(10, 10), point(19, 19));
+select count(*) from spgist_parallel_tbl where p ~= point(42.5, 7);
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table spgist_parallel_tbl;
+
 -- test an unlogged table, mostly to get coverage of spgistbuildempty
 create unlogged table spgist_unlogged_tbl(id serial, b box);
 create index spgist_unlogged_idx on spgist_unlogged_tbl using spgist (b);
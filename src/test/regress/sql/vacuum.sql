@@ -132,6 +132,7 @@ VACUUM (PARALLEL 0) pvactst; -- disable parallel vacuum
 VACUUM (PARALLEL -1) pvactst; -- error
 VACUUM (PARALLEL 2, INDEX_CLEANUP FALSE) pvactst;
 VACUUM (PARALLEL 2, FULL TRUE) pvactst; -- error, cannot use both PARALLEL and FULL
+VACUUM (PARALLEL_HEAP, FULL TRUE) pvactst; -- error, cannot use both PARALLEL_HEAP and FULL
 VACUUM (PARALLEL) pvactst; -- error, cannot use PARALLEL option without parallel degree
 
 -- Test parallel vacuum using the minimum maintenance_work_mem with and without
@@ -140,6 +141,7 @@ SET maintenance_work_mem TO 64;
 VACUUM (PARALLEL 2) pvactst2;
 DELETE FROM pvactst2 WHERE i < 1000;
 VACUUM (PARALLEL 2) pvactst2;
+VACUUM (PARALLEL 2, PARALLEL_HEAP) pvactst2; -- heap too small for workers
 RESET maintenance_work_mem;
 
 -- Test different combinations of parallel and full options for temporary tables